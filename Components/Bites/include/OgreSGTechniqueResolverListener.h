@@ -51,6 +51,8 @@ public:
         It will be called whenever the material manager won't find appropriate technique
         that satisfy the target scheme name. If the scheme name is out target RT Shader System
         scheme name we will try to create shader generated technique for it.
+        If rend is a SubEntity of a mesh with quantised positions, the transform stage
+        is set up to decode them, see Ogre::Mesh::_quantisePositions.
     */
     Ogre::Technique* handleSchemeNotFound(unsigned short schemeIndex,
                                           const Ogre::String& schemeName,
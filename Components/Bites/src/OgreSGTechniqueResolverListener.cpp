@@ -1,6 +1,10 @@
 #include "OgreSGTechniqueResolverListener.h"
 
 #include "OgreTechnique.h"
+#include "OgreEntity.h"
+#include "OgreSubEntity.h"
+#include "OgreSubMesh.h"
+#include "OgreMesh.h"
 
 namespace OgreBites {
 
@@ -28,6 +32,39 @@ Ogre::Technique *SGTechniqueResolverListener::handleSchemeNotFound(unsigned shor
     }
     // Case technique registration succeeded.
 
+    // Decode quantised positions in the vertex shader. This is decided by the first renderable
+    // using the material, so quantised and float meshes should not share materials
+    auto subEntity = dynamic_cast<const Ogre::SubEntity*>(rend);
+    if (subEntity && !subEntity->getSubMesh()->parent->getQuantisationBounds().isNull())
+    {
+        auto srcTech = originalMaterial->getTechnique(0);
+        for (auto *t : originalMaterial->getTechniques())
+        {
+            if (t->getSchemeName() == Ogre::MaterialManager::DEFAULT_SCHEME_NAME)
+            {
+                srcTech = t;
+                break;
+            }
+        }
+
+        for (unsigned short i = 0; i < srcTech->getNumPasses(); ++i)
+        {
+            auto renderState = mShaderGenerator->getRenderState(schemeName, *originalMaterial, i);
+            Ogre::RTShader::SubRenderState* transform = NULL;
+            for (auto *srs : renderState->getSubRenderStates())
+            {
+                if (srs->getType() == Ogre::RTShader::SRS_TRANSFORM)
+                    transform = srs;
+            }
+            if (!transform)
+            {
+                transform = mShaderGenerator->createSubRenderState(Ogre::RTShader::SRS_TRANSFORM);
+                renderState->addTemplateSubRenderState(transform);
+            }
+            transform->setParameter("dequantise", "true");
+        }
+    }
+
     // Force creating the shaders for the generated technique.
     mShaderGenerator->validateMaterial(schemeName, *originalMaterial);
 
@@ -73,6 +73,98 @@ _OgreBulletExport btCapsuleShape* createCapsuleCollider(const MovableObject* mo)
 /// create capsule collider using ogre provided data
 _OgreBulletExport btCylinderShape* createCylinderCollider(const MovableObject* mo);
 
+/** Collision shapes shared by the entities of the same Mesh, ColliderType and scale.
+
+    Creating the shape of a triangle mesh or of a convex hull reads the vertex and index buffers
+    back and, for triangle meshes, builds a bounding volume hierarchy (BVH). The cache does it
+    once per Mesh, and the triangle meshes of other scales share the unscaled BVH.
+    CollisionWorld gets the shapes of its objects from its cache.
+@par
+    The BVH of a triangle mesh can be saved and loaded back, so it needs not to be built at
+    load time, and the meshes of a level can be cooked beforehand, in parallel.
+@note
+    Entities with a skeleton get a new shape of their current pose, which is not shared.
+*/
+class _OgreBulletExport CollisionShapeCache
+{
+public:
+    CollisionShapeCache() {}
+    ~CollisionShapeCache();
+
+    /** Gets the shape of the entity, creating it if needed, with one more reference.
+    @param ent an entity attached to a SceneNode, whose scale the shape has
+    @param ct the collider type
+    */
+    btCollisionShape* acquire(Entity* ent, ColliderType ct);
+    /** Releases a shape got from acquire.
+        Shared shapes stay in the cache once unused, until clearUnused.
+    */
+    void release(btCollisionShape* shape);
+    /// Deletes the shapes which are not used anymore
+    void clearUnused();
+    /// Number of shapes in the cache, used or not
+    size_t getShapeCount() const { return mShapes.size(); }
+
+    /** Creates the unscaled shapes of the meshes beforehand.
+
+        The buffers of the meshes are read on the calling thread, then the shapes of the
+        different meshes are cooked in parallel on the WorkQueue.
+    @param meshes the meshes, which must not have a skeleton
+    @param ct the collider type, only CT_TRIMESH and CT_HULL shapes are cooked
+    */
+    void prepare(const std::vector<MeshPtr>& meshes, ColliderType ct);
+
+    /// Saves the BVH of the CT_TRIMESH shape of the mesh, creating the shape if needed
+    void saveBvh(const MeshPtr& mesh, const DataStreamPtr& stream);
+    /** Creates the CT_TRIMESH shape of the mesh with a BVH saved by saveBvh, rather than
+        building it. Does nothing if the shape exists already.
+    @return false, with a warning in the log, if the BVH was saved for other triangles or
+        with another precision of Bullet
+    */
+    bool loadBvh(const MeshPtr& mesh, const DataStreamPtr& stream);
+
+private:
+    struct Key
+    {
+        const Mesh* mesh;
+        ColliderType type;
+        Vector3 scale;
+
+        bool operator<(const Key& other) const;
+    };
+    struct AlignedFree
+    {
+        void operator()(void* ptr) const { btAlignedFree(ptr); }
+    };
+    struct Shape
+    {
+        /// Keeps the mesh of the key alive
+        MeshPtr mesh;
+        /// Loaded BVH, which the shape does not own
+        std::unique_ptr<void, AlignedFree> bvhData;
+        std::unique_ptr<btTriangleMesh> triangles;
+        std::unique_ptr<btCollisionShape> shape;
+        /// Hash of the triangles of triangle meshes, to check a loaded BVH
+        uint32 trianglesHash;
+        /// Unscaled triangle mesh a scaled one uses
+        Shape* base;
+        size_t refCount;
+
+        Shape() : trianglesHash(0), base(NULL), refCount(0) {}
+    };
+
+    std::map<Key, Shape> mShapes;
+    std::map<const btCollisionShape*, Key> mKeys;
+    /// Shapes of the entities with a skeleton, deleted once released
+    std::set<btCollisionShape*> mUnsharedShapes;
+
+    /** Gets the shape with the key, creating it if needed.
+    @param mo the object whose bounds primitive shapes use
+    */
+    Shape& getShape(const MeshPtr& mesh, const MovableObject* mo, const Key& key);
+    Shape& addShape(const Key& key, Shape&& shape);
+};
+
 struct _OgreBulletExport CollisionListener
 {
     virtual ~CollisionListener() {}
@@ -102,11 +194,21 @@ protected:
     std::unique_ptr<btBroadphaseInterface> mBroadphase;
 
     btCollisionWorld* mBtWorld;
+    std::shared_ptr<CollisionShapeCache> mShapeCache;
 
 public:
-    CollisionWorld(btCollisionWorld* btWorld) : mBtWorld(btWorld) {}
+    CollisionWorld(btCollisionWorld* btWorld) : mBtWorld(btWorld), mShapeCache(std::make_shared<CollisionShapeCache>())
+    {
+    }
     virtual ~CollisionWorld();
 
+    /// Cache of the shapes of the objects added to the world
+    CollisionShapeCache& getShapeCache() { return *mShapeCache; }
+    /** Shares the cache of the shapes with other worlds.
+        The objects added before keep using the previous cache.
+    */
+    void setShapeCache(const std::shared_ptr<CollisionShapeCache>& cache) { mShapeCache = cache; }
+
     btCollisionObject* addCollisionObject(Entity* ent, ColliderType ct, int group = 1, int mask = -1);
 
     void rayTest(const Ray& ray, RayResultCallback* callback, float maxDist = 1000);
@@ -4,6 +4,8 @@
 // SPDX-License-Identifier: MIT
 
 #include "OgreBullet.h"
+#include "OgreStreamSerialiser.h"
+#include "OgreWorkQueue.h"
 
 namespace Ogre
 {
@@ -129,9 +131,13 @@ public:
     Real getRadius();
     Vector3 getSize();
 
+    btTriangleMesh* createTriangles();
     btBvhTriangleMeshShape* createTrimesh();
     btConvexHullShape* createConvex();
 
+    /// Hash of the vertices and indices
+    uint32 getTrianglesHash();
+
     void addEntity(const Entity* entity, const Affine3& transform = Affine3::IDENTITY);
     void addMesh(const MeshPtr& mesh, const Affine3& transform = Affine3::IDENTITY);
 
@@ -168,13 +174,18 @@ class CollisionObject
 protected:
     btCollisionObject* mBtBody;
     btCollisionWorld* mBtWorld;
+    std::shared_ptr<CollisionShapeCache> mShapeCache;
 
 public:
-    CollisionObject(btCollisionObject* btBody, btCollisionWorld* btWorld) : mBtBody(btBody), mBtWorld(btWorld) {}
+    CollisionObject(btCollisionObject* btBody, btCollisionWorld* btWorld,
+                    const std::shared_ptr<CollisionShapeCache>& shapeCache)
+        : mBtBody(btBody), mBtWorld(btWorld), mShapeCache(shapeCache)
+    {
+    }
     virtual ~CollisionObject()
     {
         mBtWorld->removeCollisionObject(mBtBody);
-        delete mBtBody->getCollisionShape();
+        mShapeCache->release(mBtBody->getCollisionShape());
         delete mBtBody;
     }
 };
@@ -249,7 +260,7 @@ btRigidBody* DynamicsWorld::addRigidBody(float mass, Entity* ent, ColliderType c
     OgreAssert(node, "entity must be attached");
     RigidBodyState* state = new RigidBodyState(node);
 
-    btCollisionShape* cs = getCollisionShape(ent, ct);
+    btCollisionShape* cs = mShapeCache->acquire(ent, ct);
 
     btVector3 inertia(0, 0, 0);
     if (mass != 0) // mass = 0 -> static
@@ -260,7 +271,7 @@ btRigidBody* DynamicsWorld::addRigidBody(float mass, Entity* ent, ColliderType c
     rb->setUserPointer(new EntityCollisionListener{ent, listener});
 
     // transfer ownership to node
-    auto objWrapper = std::make_shared<RigidBody>(rb, mBtWorld);
+    auto objWrapper = std::make_shared<RigidBody>(rb, mBtWorld, mShapeCache);
     node->getUserObjectBindings().setUserAny("BtCollisionObject", objWrapper);
 
     return rb;
@@ -271,14 +282,14 @@ btCollisionObject* CollisionWorld::addCollisionObject(Entity* ent, ColliderType
     auto node = ent->getParentSceneNode();
     OgreAssert(node, "entity must be attached");
 
-    btCollisionShape* cs = getCollisionShape(ent, ct);
+    btCollisionShape* cs = mShapeCache->acquire(ent, ct);
 
     auto co = new btCollisionObject();
     co->setCollisionShape(cs);
     mBtWorld->addCollisionObject(co, group, mask);
 
     // transfer ownership to node
-    auto objWrapper = std::make_shared<CollisionObject>(co, mBtWorld);
+    auto objWrapper = std::make_shared<CollisionObject>(co, mBtWorld, mShapeCache);
     node->getUserObjectBindings().setUserAny("BtCollisionObject", objWrapper);
 
     return co;
@@ -540,7 +551,7 @@ btConvexHullShape* VertexIndexToShape::createConvex()
     return shape;
 }
 //------------------------------------------------------------------------------------------------
-btBvhTriangleMeshShape* VertexIndexToShape::createTrimesh()
+btTriangleMesh* VertexIndexToShape::createTriangles()
 {
     assert(mVertexCount && (mIndexCount >= 6) && ("Mesh must have some vertices and at least 6 indices (2 triangles)"));
 
@@ -577,14 +588,25 @@ btBvhTriangleMeshShape* VertexIndexToShape::createTrimesh()
         trimesh->addTriangle(vertexPos[0], vertexPos[1], vertexPos[2]);
     }
 
+    return trimesh;
+}
+//------------------------------------------------------------------------------------------------
+btBvhTriangleMeshShape* VertexIndexToShape::createTrimesh()
+{
     const bool useQuantizedAABB = true;
-    btBvhTriangleMeshShape* shape = new btBvhTriangleMeshShape(trimesh, useQuantizedAABB);
+    btBvhTriangleMeshShape* shape = new btBvhTriangleMeshShape(createTriangles(), useQuantizedAABB);
 
     shape->setLocalScaling(convert(mScale));
 
     return shape;
 }
 //------------------------------------------------------------------------------------------------
+uint32 VertexIndexToShape::getTrianglesHash()
+{
+    uint32 hash = FastHash((const char*)mVertexBuffer, sizeof(Vector3) * mVertexCount);
+    return FastHash((const char*)mIndexBuffer, sizeof(unsigned int) * mIndexCount, hash);
+}
+//------------------------------------------------------------------------------------------------
 VertexIndexToShape::~VertexIndexToShape()
 {
     delete[] mVertexBuffer;
@@ -696,6 +718,314 @@ void VertexIndexToShape::addMesh(const MeshPtr& mesh, const Affine3& transform)
     }
 }
 
+/*
+ * =============================================================================================
+ * CollisionShapeCache
+ * =============================================================================================
+ */
+
+static const uint32 BVH_CHUNK_ID = StreamSerialiser::makeIdentifier("BTBV"); // Bullet BVH
+static const uint16 BVH_CHUNK_VERSION = 1;
+
+/// Creates the unscaled shape of the triangles, safe on any thread
+static void cookShape(btCollisionShape*& shape, std::unique_ptr<btTriangleMesh>& triangles,
+                      VertexIndexToShape& data, ColliderType ct)
+{
+    if (ct == CT_TRIMESH)
+    {
+        const bool useQuantizedAABB = true;
+        triangles.reset(data.createTriangles());
+        shape = new btBvhTriangleMeshShape(triangles.get(), useQuantizedAABB);
+    }
+    else
+    {
+        shape = data.createConvex();
+    }
+}
+//------------------------------------------------------------------------------------------------
+bool CollisionShapeCache::Key::operator<(const Key& other) const
+{
+    if (mesh != other.mesh)
+        return mesh < other.mesh;
+    if (type != other.type)
+        return type < other.type;
+    // Vector3::operator< is not an ordering
+    return std::lexicographical_compare(scale.ptr(), scale.ptr() + 3, other.scale.ptr(), other.scale.ptr() + 3);
+}
+//------------------------------------------------------------------------------------------------
+CollisionShapeCache::~CollisionShapeCache()
+{
+    for (auto shape : mUnsharedShapes)
+        delete shape;
+}
+//------------------------------------------------------------------------------------------------
+btCollisionShape* CollisionShapeCache::acquire(Entity* ent, ColliderType ct)
+{
+    auto node = ent->getParentSceneNode();
+    OgreAssert(node, "entity must be attached");
+
+    if (ent->hasSkeleton())
+    {
+        // the shape of the current pose
+        btCollisionShape* cs = getCollisionShape(ent, ct);
+        mUnsharedShapes.insert(cs);
+        return cs;
+    }
+
+    Shape& shape = getShape(ent->getMesh(), ent, {ent->getMesh().get(), ct, node->getScale()});
+    shape.refCount++;
+    return shape.shape.get();
+}
+//------------------------------------------------------------------------------------------------
+void CollisionShapeCache::release(btCollisionShape* shape)
+{
+    if (mUnsharedShapes.erase(shape))
+    {
+        if (shape->getShapeType() == TRIANGLE_MESH_SHAPE_PROXYTYPE)
+            delete static_cast<btBvhTriangleMeshShape*>(shape)->getMeshInterface();
+        delete shape;
+        return;
+    }
+
+    auto key = mKeys.find(shape);
+    OgreAssert(key != mKeys.end(), "shape not acquired from this cache");
+    Shape& s = mShapes.at(key->second);
+    OgreAssert(s.refCount > 0, "shape released more often than acquired");
+    s.refCount--;
+}
+//------------------------------------------------------------------------------------------------
+void CollisionShapeCache::clearUnused()
+{
+    // deleting scaled triangle meshes releases the unscaled ones, so repeat until none is unused
+    bool erased = true;
+    while (erased)
+    {
+        erased = false;
+        for (auto it = mShapes.begin(); it != mShapes.end();)
+        {
+            if (it->second.refCount)
+            {
+                ++it;
+                continue;
+            }
+            if (it->second.base)
+                it->second.base->refCount--;
+            mKeys.erase(it->second.shape.get());
+            it = mShapes.erase(it);
+            erased = true;
+        }
+    }
+}
+//------------------------------------------------------------------------------------------------
+CollisionShapeCache::Shape& CollisionShapeCache::addShape(const Key& key, Shape&& shape)
+{
+    mKeys[shape.shape.get()] = key;
+    return mShapes.emplace(key, std::move(shape)).first->second;
+}
+//------------------------------------------------------------------------------------------------
+CollisionShapeCache::Shape& CollisionShapeCache::getShape(const MeshPtr& mesh, const MovableObject* mo,
+                                                          const Key& key)
+{
+    auto it = mShapes.find(key);
+    if (it != mShapes.end())
+        return it->second;
+
+    Shape shape;
+    shape.mesh = mesh;
+    switch (key.type)
+    {
+    case CT_BOX:
+        shape.shape.reset(createBoxCollider(mo));
+        break;
+    case CT_SPHERE:
+        shape.shape.reset(createSphereCollider(mo));
+        break;
+    case CT_CYLINDER:
+        shape.shape.reset(createCylinderCollider(mo));
+        break;
+    case CT_CAPSULE:
+        shape.shape.reset(createCapsuleCollider(mo));
+        break;
+    case CT_TRIMESH:
+    case CT_HULL:
+        if (key.scale == Vector3::UNIT_SCALE)
+        {
+            VertexIndexToShape data;
+            data.addMesh(mesh);
+            btCollisionShape* cs;
+            cookShape(cs, shape.triangles, data, key.type);
+            shape.shape.reset(cs);
+            shape.trianglesHash = data.getTrianglesHash();
+        }
+        else if (key.type == CT_TRIMESH)
+        {
+            // share the BVH of the unscaled triangles
+            Shape& base = getShape(mesh, mo, {key.mesh, key.type, Vector3::UNIT_SCALE});
+            shape.shape.reset(new btScaledBvhTriangleMeshShape(
+                static_cast<btBvhTriangleMeshShape*>(base.shape.get()), convert(key.scale)));
+            shape.base = &base;
+            base.refCount++;
+        }
+        else
+        {
+            // copy the points of the unscaled hull, rather than reading the buffers again
+            auto hull = static_cast<const btConvexHullShape*>(
+                getShape(mesh, mo, {key.mesh, key.type, Vector3::UNIT_SCALE}).shape.get());
+            auto scaled = new btConvexHullShape((const btScalar*)hull->getUnscaledPoints(), hull->getNumPoints(),
+                                                sizeof(btVector3));
+            scaled->setLocalScaling(convert(key.scale));
+            shape.shape.reset(scaled);
+        }
+        break;
+    }
+
+    return addShape(key, std::move(shape));
+}
+//------------------------------------------------------------------------------------------------
+void CollisionShapeCache::prepare(const std::vector<MeshPtr>& meshes, ColliderType ct)
+{
+    if (ct != CT_TRIMESH && ct != CT_HULL)
+        return;
+
+    struct Job
+    {
+        Key key;
+        Shape shape;
+        std::unique_ptr<VertexIndexToShape> data;
+        btCollisionShape* cookedShape;
+    };
+
+    // the buffers are read on this thread, once per mesh
+    std::vector<Job> jobs;
+    std::set<const Mesh*> queued;
+    for (const MeshPtr& mesh : meshes)
+    {
+        Key key = {mesh.get(), ct, Vector3::UNIT_SCALE};
+        if (mShapes.count(key) || !queued.insert(mesh.get()).second)
+            continue;
+
+        jobs.emplace_back();
+        Job& job = jobs.back();
+        job.key = key;
+        job.shape.mesh = mesh;
+        job.data.reset(new VertexIndexToShape());
+        job.data->addMesh(mesh);
+        job.shape.trianglesHash = job.data->getTrianglesHash();
+        job.cookedShape = NULL;
+    }
+
+    auto cook = [&jobs](size_t first, size_t last)
+    {
+        for (size_t i = first; i < last; ++i)
+            cookShape(jobs[i].cookedShape, jobs[i].shape.triangles, *jobs[i].data, jobs[i].key.type);
+    };
+    if (Root* root = Root::getSingletonPtr())
+        root->getWorkQueue()->parallelFor(0, jobs.size(), cook);
+    else
+        cook(0, jobs.size());
+
+    for (Job& job : jobs)
+    {
+        job.shape.shape.reset(job.cookedShape);
+        addShape(job.key, std::move(job.shape));
+    }
+}
+//------------------------------------------------------------------------------------------------
+void CollisionShapeCache::saveBvh(const MeshPtr& mesh, const DataStreamPtr& stream)
+{
+    if (!stream->isWriteable())
+    {
+        OGRE_EXCEPT(Exception::ERR_CANNOT_WRITE_TO_FILE, "Unable to write to stream " + stream->getName(),
+                    "CollisionShapeCache::saveBvh");
+    }
+
+    Shape& shape = getShape(mesh, NULL, {mesh.get(), CT_TRIMESH, Vector3::UNIT_SCALE});
+    const btOptimizedBvh* bvh = static_cast<btBvhTriangleMeshShape*>(shape.shape.get())->getOptimizedBvh();
+
+    uint32 size = bvh->calculateSerializeBufferSize();
+    std::unique_ptr<void, AlignedFree> buffer(btAlignedAlloc(size, 16));
+    bvh->serializeInPlace(buffer.get(), size, false);
+
+    StreamSerialiser serialiser(stream);
+    serialiser.writeChunkBegin(BVH_CHUNK_ID, BVH_CHUNK_VERSION);
+    uint32 scalarSize = sizeof(btScalar);
+    serialiser.write(&shape.trianglesHash);
+    serialiser.write(&scalarSize);
+    serialiser.write(&size);
+    serialiser.writeData(buffer.get(), 1, size);
+    serialiser.writeChunkEnd(BVH_CHUNK_ID);
+}
+//------------------------------------------------------------------------------------------------
+bool CollisionShapeCache::loadBvh(const MeshPtr& mesh, const DataStreamPtr& stream)
+{
+    Key key = {mesh.get(), CT_TRIMESH, Vector3::UNIT_SCALE};
+    if (mShapes.count(key))
+        return true;
+
+    StreamSerialiser serialiser(stream);
+    const StreamSerialiser::Chunk* chunk;
+    try
+    {
+        chunk = serialiser.readChunkBegin();
+    }
+    catch (const InvalidStateException& e)
+    {
+        LogManager::getSingleton().logWarning("Could not load BVH of " + mesh->getName() + ": " +
+                                              e.getDescription());
+        return false;
+    }
+
+    if (chunk->id != BVH_CHUNK_ID || chunk->version != BVH_CHUNK_VERSION)
+    {
+        LogManager::getSingleton().logWarning("Invalid BVH " + stream->getName());
+        serialiser.readChunkEnd(chunk->id);
+        return false;
+    }
+
+    VertexIndexToShape data;
+    data.addMesh(mesh);
+
+    uint32 hash = 0, scalarSize = 0, size = 0;
+    serialiser.read(&hash);
+    serialiser.read(&scalarSize);
+    serialiser.read(&size);
+    if (hash != data.getTrianglesHash() || scalarSize != sizeof(btScalar))
+    {
+        LogManager::getSingleton().logWarning("BVH " + stream->getName() + " does not match the mesh " +
+                                              mesh->getName());
+        serialiser.readChunkEnd(BVH_CHUNK_ID);
+        return false;
+    }
+
+    Shape shape;
+    shape.mesh = mesh;
+    shape.trianglesHash = hash;
+    shape.bvhData.reset(btAlignedAlloc(size, 16));
+    serialiser.readData(shape.bvhData.get(), 1, size);
+    serialiser.readChunkEnd(BVH_CHUNK_ID);
+
+#if OGRE_ENDIAN == OGRE_ENDIAN_BIG
+    const bool swapEndian = serialiser.getEndian() == StreamSerialiser::ENDIAN_LITTLE;
+#else
+    const bool swapEndian = serialiser.getEndian() == StreamSerialiser::ENDIAN_BIG;
+#endif
+    btOptimizedBvh* bvh = btOptimizedBvh::deSerializeInPlace(shape.bvhData.get(), size, swapEndian);
+    if (!bvh)
+    {
+        LogManager::getSingleton().logWarning("Corrupted BVH " + stream->getName());
+        return false;
+    }
+
+    const bool useQuantizedAABB = true;
+    shape.triangles.reset(data.createTriangles());
+    auto trimesh = new btBvhTriangleMeshShape(shape.triangles.get(), useQuantizedAABB, false);
+    trimesh->setOptimizedBvh(bvh);
+    shape.shape.reset(trimesh);
+
+    addShape(key, std::move(shape));
+    return true;
+}
+
 /*
  * =============================================================================================
  * BtDebugDrawer
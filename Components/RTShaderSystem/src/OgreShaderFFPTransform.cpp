@@ -83,6 +83,17 @@ bool FFPTransform::createCpuSubPrograms(ProgramSet* programSet)
         !GpuProgramManager::getSingleton().isSyntaxSupported("glsl300es"))
         mInstancingTexCoordIndex = 0;
 
+    if(mDequantise)
+    {
+        // q * halfSize + centre, the bounds are set per object
+        mPositionScale = vsProgram->resolveParameter(GCT_FLOAT3, -1, GPV_PER_OBJECT, "posQuantScale");
+        mPositionOffset = vsProgram->resolveParameter(GCT_FLOAT3, -1, GPV_PER_OBJECT, "posQuantOffset");
+
+        auto preStage = vsEntry->getStage(FFP_VS_PRE_PROCESS);
+        preStage.mul(In(positionIn).xyz(), mPositionScale, Out(positionIn).xyz());
+        preStage.add(In(positionIn).xyz(), mPositionOffset, Out(positionIn).xyz());
+    }
+
     auto stage = vsEntry->getStage(FFP_VS_TRANSFORM);
     if(mInstancingTexCoordIndex)
     {
@@ -130,6 +141,7 @@ void FFPTransform::copyFrom(const SubRenderState& rhs)
     const FFPTransform& rhsTransform = static_cast<const FFPTransform&>(rhs);
     mSetPointSize = rhsTransform.mSetPointSize;
     mInstancingTexCoordIndex = rhsTransform.mInstancingTexCoordIndex;
+    mDequantise = rhsTransform.mDequantise;
 }
 
 bool FFPTransform::setParameter(const String& name, const String& value)
@@ -138,9 +150,36 @@ bool FFPTransform::setParameter(const String& name, const String& value)
     {
         return StringConverter::parse(value, mInstancingTexCoordIndex);
     }
+    if (name == "dequantise")
+    {
+        return StringConverter::parse(value, mDequantise);
+    }
     return false;
 }
 
+//-----------------------------------------------------------------------
+void FFPTransform::updateGpuProgramsParams(Renderable* rend, const Pass* pass, const AutoParamDataSource* source,
+                                           const LightList* pLightList)
+{
+    if (!mDequantise)
+        return;
+
+    // identity for meshes sharing the material, that are not quantised
+    Vector3 scale = Vector3::UNIT_SCALE, offset = Vector3::ZERO;
+    if (auto subEntity = dynamic_cast<SubEntity*>(rend))
+    {
+        const AxisAlignedBox& bounds = subEntity->getSubMesh()->parent->getQuantisationBounds();
+        if (!bounds.isNull())
+        {
+            scale = bounds.getHalfSize();
+            offset = bounds.getCenter();
+        }
+    }
+
+    mPositionScale->setGpuParameter(scale);
+    mPositionOffset->setGpuParameter(offset);
+}
+
 //-----------------------------------------------------------------------
 const String& FFPTransformFactory::getType() const
 {
@@ -156,6 +195,13 @@ SubRenderState* FFPTransformFactory::createInstance(ScriptCompiler* compiler,
         if(prop->values.size() > 0)
         {
             auto it = prop->values.begin();
+            if((*it)->getString() == "dequantise")
+            {
+                auto ret = createOrRetrieveInstance(translator);
+                ret->setParameter("dequantise", "true");
+                return ret;
+            }
+
             if((*it)->getString() != "instanced")
                 return NULL;
 
@@ -178,7 +224,7 @@ void FFPTransformFactory::writeInstance(MaterialSerializer* ser, SubRenderState*
                                        Pass* srcPass, Pass* dstPass)
 {
     ser->writeAttribute(4, "transform_stage");
-    ser->writeValue("ffp");
+    ser->writeValue(static_cast<FFPTransform*>(subRenderState)->mDequantise ? "dequantise" : "ffp");
 }
 
 //-----------------------------------------------------------------------
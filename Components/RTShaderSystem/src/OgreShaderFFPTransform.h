@@ -45,9 +45,13 @@ namespace RTShader {
 /** Transform sub render state implementation of the Fixed Function Pipeline.
 @see http://msdn.microsoft.com/en-us/library/bb206269.aspx
 Derives from SubRenderState class.
+
+With the "dequantise" parameter, positions quantised by Mesh::_quantisePositions are decoded
+before the transform, using the quantisation bounds of the rendered SubEntity.
 */
 class FFPTransform : public SubRenderState
 {
+    friend class FFPTransformFactory;
 
 // Interface.
 public:
@@ -76,11 +80,20 @@ public:
 
     bool setParameter(const String& name, const String& value) override;
 
+    /**
+    @see SubRenderState::updateGpuProgramsParams.
+    */
+    void updateGpuProgramsParams(Renderable* rend, const Pass* pass, const AutoParamDataSource* source,
+                                 const LightList* pLightList) override;
+
     static String Type;
 protected:
     int mInstancingTexCoordIndex = 0;
     bool mSetPointSize;
     bool mDoLightCalculations;
+    bool mDequantise = false;
+    UniformParameterPtr mPositionScale;
+    UniformParameterPtr mPositionOffset;
 };
 
 
@@ -92,6 +92,8 @@ THE SOFTWARE.
 #include "OgrePatchMesh.h"
 #include "OgrePatchSurface.h"
 #include "OgreProfiler.h"
+#include "OgreProfileTrace.h"
+#include "OgreEngineStatistics.h"
 #include "OgreRectangle2D.h"
 #include "OgreRenderQueueListener.h"
 #include "OgreRenderObjectListener.h"
@@ -116,6 +118,7 @@ THE SOFTWARE.
 #include "OgreSkeletonManager.h"
 #include "OgreSkeletonSerializer.h"
 #include "OgreStaticGeometry.h"
+#include "OgreStaticGeometrySerializer.h"
 #include "OgreString.h"
 #include "OgreStringConverter.h"
 #include "OgreStringVector.h"
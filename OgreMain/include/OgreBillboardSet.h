@@ -243,6 +243,15 @@ namespace Ogre {
 
         void genPointVertices(const Billboard& pBillboard);
 
+        /** Internal method for generating the vertex data of a range of billboards.
+
+            Range provides operator[] returning a Billboard; Axes generates the axes
+            of each billboard or holds the ones common to all of them.
+        */
+        template <typename Axes, typename Range> void genQuadVerticesBatch(const Axes& axes, const Range& billboards);
+        /// Dispatches to the genQuadVerticesBatch specialised for the current billboard type
+        template <typename Range> void injectBillboardsImpl(const Range& billboards);
+
         /** Internal method generates vertex offsets.
 
             Takes in parametric offsets as generated from getParametericOffsets, width and height values
@@ -517,6 +526,13 @@ namespace Ogre {
         void beginBillboards(size_t numBillboards = 0);
         /** Define a billboard. */
         void injectBillboard(const Billboard& bb);
+        /** Define a range of billboards.
+
+            Same as calling injectBillboard for each of them, but the vertices are
+            generated by a kernel specialised for the billboard type, which avoids
+            the per billboard branching and writes the corners using SIMD where available.
+        */
+        void injectBillboards(const Billboard* billboards, size_t count);
         /** Finish defining billboards. */
         void endBillboards(void);
         /** Set the bounds of the BillboardSet.
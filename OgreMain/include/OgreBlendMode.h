@@ -297,6 +297,16 @@ namespace Ogre {
         {
         }
 
+        bool operator==(const ColourBlendState& rhs) const
+        {
+            return writeR == rhs.writeR && writeG == rhs.writeG && writeB == rhs.writeB &&
+                   writeA == rhs.writeA && sourceFactor == rhs.sourceFactor &&
+                   destFactor == rhs.destFactor && sourceFactorAlpha == rhs.sourceFactorAlpha &&
+                   destFactorAlpha == rhs.destFactorAlpha && operation == rhs.operation &&
+                   alphaOperation == rhs.alphaOperation;
+        }
+        bool operator!=(const ColourBlendState& rhs) const { return !(*this == rhs); }
+
         /// can we simply overwrite the existing pixels or do we have to blend
         bool blendingEnabled() const
         {
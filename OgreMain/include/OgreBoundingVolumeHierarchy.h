@@ -0,0 +1,201 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef __BoundingVolumeHierarchy_H__
+#define __BoundingVolumeHierarchy_H__
+
+#include "OgrePrerequisites.h"
+#include "OgreVector.h"
+#include "OgrePlaneBoundedVolume.h"
+#include "OgreRayPacket.h"
+#include "OgreHeaderPrefix.h"
+
+#include <functional>
+
+namespace Ogre {
+
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup Scene
+    *  @{
+    */
+    /** Dynamic bounding volume hierarchy of the MovableObjects of a SceneManager.
+
+        The default SceneQuery implementations use it to find the objects they need to
+        test, rather than testing every object of the scene. Each leaf holds one object,
+        with the world bounding box of the object merged with its world bounding sphere,
+        so it bounds whatever a query tests.
+    @par
+        The objects are inserted, refitted and removed as their bounds change, which is
+        cheap but lets the quality of the tree degrade as the objects move. Once the
+        internal nodes grew enough, the tree is rebuilt with the surface area heuristic,
+        on the WorkQueue when possible, and swapped in on the main thread.
+    @par
+        Objects with infinite bounds are kept out of the tree and returned by every search.
+    @note
+        The SceneManager maintains the hierarchy once a default query used it, see
+        SceneManager::_getSceneQueryBVH. It must only be updated from the main thread.
+    */
+    class _OgreExport BoundingVolumeHierarchy : public SceneMgtAlloc
+    {
+    public:
+        /// Values of MovableObject::_getSceneQueryLeaf which are not leaves
+        enum
+        {
+            /// Not in a SceneManager collection, so never found by the queries
+            NOT_TRACKED = -1,
+            /// Tracked, but not in the hierarchy
+            NO_LEAF = -2,
+            /// In the list of objects with infinite bounds
+            INFINITE_LEAF = -3
+        };
+
+        typedef std::vector<MovableObject*> ObjectList;
+        typedef std::vector<std::pair<MovableObject*, MovableObject*> > ObjectPairList;
+        /// Called with an object and the rays of the packet which hit its bounds
+        typedef std::function<void(MovableObject*, RayPacket::Mask)> RayPacketVisitor;
+
+        BoundingVolumeHierarchy();
+        ~BoundingVolumeHierarchy();
+
+        /** Inserts the object, or refits its leaf to the given bounds.
+        @param obj a tracked object, see MovableObject::_getSceneQueryLeaf
+        @param bounds world bounds of the object, including anything the queries test
+        */
+        void update(MovableObject* obj, const AxisAlignedBox& bounds);
+        /// Removes the object, which stays tracked
+        void remove(MovableObject* obj);
+
+        /** Rebuilds the tree with the surface area heuristic when the updates made it
+            grow by half since the last build.
+        @param inBackground build on the WorkQueue, if it accepts requests, and swap the
+            new tree in from WorkQueue::processMainThreadTasks
+        */
+        void rebuildIfNeeded(bool inBackground = true);
+        /// Rebuilds the tree with the surface area heuristic right away
+        void rebuild(void);
+        /// Whether a rebuild is running on the WorkQueue
+        bool isRebuilding(void) const { return mRebuildJob != nullptr; }
+
+        /// Number of objects in the hierarchy
+        size_t getObjectCount(void) const { return mTree.leafCount + mInfiniteObjects.size(); }
+        /** Cost of the tree in the surface area heuristic, that is the sum of the areas
+            of the internal nodes relative to the root one. Lower is better.
+        */
+        Real getCost(void) const;
+
+        /// Appends the objects whose bounds the ray hits
+        void findObjects(const Ray& ray, ObjectList& result) const;
+        /// Appends the objects whose bounds intersect the sphere
+        void findObjects(const Sphere& sphere, ObjectList& result) const;
+        /// Appends the objects whose bounds intersect the box
+        void findObjects(const AxisAlignedBox& box, ObjectList& result) const;
+        /// Appends the objects whose bounds intersect any of the volumes
+        void findObjects(const PlaneBoundedVolumeList& volumes, ObjectList& result) const;
+        /// Appends every pair of objects whose bounds intersect, each pair once
+        void findPairs(ObjectPairList& result) const;
+        /** Visits the objects whose bounds the rays of the packet hit within their maximal
+            distances.
+
+            The subtrees nearer to the rays are visited first, so a visitor lowering the
+            maximal distances to the hits it found skips most of the tree. May be called
+            from several threads at once.
+        */
+        void findObjects(RayPacket& packet, const RayPacketVisitor& visitor) const;
+
+    private:
+        struct Node
+        {
+            Vector3 min, max;
+            int32 parent;
+            /// Both negative for leaves
+            int32 children[2];
+            /// Null for internal and free nodes
+            MovableObject* object;
+
+            bool isLeaf() const { return children[0] < 0; }
+        };
+
+        /// Nodes with the operations that keep the boxes of the ancestors fitted
+        struct Tree
+        {
+            std::vector<Node> nodes;
+            int32 root;
+            int32 freeList;
+            size_t leafCount;
+            /// Sum of the surface areas of the internal nodes
+            double internalArea;
+
+            Tree() : root(-1), freeList(-1), leafCount(0), internalArea(0) {}
+
+            int32 allocateNode(void);
+            void freeNode(int32 index);
+            void insertLeaf(int32 leaf);
+            void removeLeaf(int32 leaf);
+            /// Refits the boxes of the node and its ancestors to their children
+            void refitAncestors(int32 index);
+        };
+
+        struct BuildItem
+        {
+            Vector3 min, max, centre;
+            MovableObject* object;
+        };
+
+        struct RebuildJob;
+
+        Tree mTree;
+        ObjectList mInfiniteObjects;
+        /// Internal area above which the tree gets rebuilt
+        double mRebuildArea;
+        SharedPtr<RebuildJob> mRebuildJob;
+
+        void insert(MovableObject* obj, const Vector3& min, const Vector3& max);
+        void removeFromTree(MovableObject* obj);
+        void removeFromInfinite(MovableObject* obj);
+        void gatherBuildItems(std::vector<BuildItem>& items) const;
+        void cancelRebuild(void);
+        /** Replaces the tree with one built from items gathered earlier, bringing it up
+            to date with the changes the job recorded since then.
+        */
+        void swapTree(Tree& tree, const RebuildJob* job);
+
+        /// Builds a tree with the nodes in depth first order, from any thread
+        static void buildTree(std::vector<BuildItem>& items, Tree& tree);
+
+        template <typename Overlaps>
+        void collectObjects(const Overlaps& overlaps, ObjectList& result) const;
+    };
+    /** @} */
+    /** @} */
+
+}
+
+#include "OgreHeaderSuffix.h"
+
+#endif
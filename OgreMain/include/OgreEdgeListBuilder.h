@@ -191,6 +191,13 @@ namespace Ogre {
         void addIndexData(const IndexData* indexData, size_t vertexSet = 0, 
             RenderOperation::OperationType opType = RenderOperation::OT_TRIANGLE_LIST);
 
+        /** Reads the vertex positions and the indexes from the hardware buffers.
+
+            This is done by build, unless it was called before. A buffer must not be locked by
+            several threads at once, so call this first to run build on a worker thread.
+        */
+        void readBuffers(void);
+
         /** Builds the edge information based on the information built up so far.
 
             The caller takes responsibility for deleting the returned structure.
@@ -221,16 +228,19 @@ namespace Ogre {
             RenderOperation::OperationType opType;  /// The operation type used to render this geometry
         };
         friend struct geometryLess;
-        /** Comparator for unique vertex list */
-        struct vectorLess {
-            bool operator()(const Vector3f& a, const Vector3f& b) const
-            {
-                if (a[0] < b[0]) return true;
-                if (a[0] > b[0]) return false;
-                if (a[1] < b[1]) return true;
-                if (a[1] > b[1]) return false;
-                return a[2] < b[2];
-            }
+        /** Entry of the edge table. The edges created for a pair of shared vertices, which
+            still wait for a triangle on the opposite side, are kept in a list.
+        */
+        struct EdgeSlot {
+            uint32 sharedVertIndex[2]; /// The key, ~0 for unused slots
+            uint32 first;              /// First waiting edge in mPendingEdges, ~0 if there is none
+            uint32 last;               /// Last waiting edge in mPendingEdges
+        };
+        /** An edge waiting for a triangle on the opposite side */
+        struct PendingEdge {
+            uint32 vertexSet;
+            uint32 edgeIndex;
+            uint32 next;               /// The next edge with the same key, ~0 if there is none
         };
 
         typedef std::vector<const VertexData*> VertexDataList;
@@ -241,16 +251,27 @@ namespace Ogre {
         VertexDataList mVertexDataList;
         CommonVertexList mVertices;
         EdgeData* mEdgeData;
-        /// Map for identifying common vertices
-        typedef std::map<Vector3f, size_t, vectorLess> CommonVertexMap;
-        CommonVertexMap mCommonVertexMap;
-        /** Edge map, used to connect edges. Note we allow many triangles on an edge,
+        /// Positions of each vertex set, as read from the vertex buffers
+        std::vector<std::vector<Vector3f> > mPositions;
+        /// Indexes of each index set, as read from the index buffers
+        std::vector<std::vector<uint32> > mIndexes;
+        /// Open addressing table of indexes into mVertices, for identifying common vertices
+        std::vector<uint32> mVertexTable;
+        /** Open addressing table, used to connect edges. Note we allow many triangles on an edge,
         after connected an existing edge, we will remove it and never used again.
         */
-        typedef std::multimap< std::pair<uint32, uint32>, std::pair<uint32, uint32> > EdgeMap;
-        EdgeMap mEdgeMap;
+        std::vector<EdgeSlot> mEdgeTable;
+        std::vector<PendingEdge> mPendingEdges;
+        /// Number of used slots in mEdgeTable
+        size_t mNumEdgeKeys;
+        /// Number of edges waiting in mPendingEdges
+        size_t mNumPendingEdges;
 
         void buildTrianglesEdges(const Geometry &geometry);
+        /// Finds the slot of the edge table holding the key, or the unused slot to store it in
+        EdgeSlot& findEdgeSlot(uint32 sharedVertIndex0, uint32 sharedVertIndex1);
+        /// Rehashes the edge table, dropping the keys without waiting edges
+        void growEdgeTable();
 
         /// Finds an existing common vertex, or inserts a new one
         uint32 findOrCreateCommonVertex(const Vector3f& vec, uint32 vertexSet,
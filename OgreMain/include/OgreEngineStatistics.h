@@ -0,0 +1,188 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef __EngineStatistics_H__
+#define __EngineStatistics_H__
+
+#include "OgrePrerequisites.h"
+#include "OgreHeaderPrefix.h"
+
+#include <atomic>
+#include <deque>
+#include <iosfwd>
+
+namespace Ogre {
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup General
+    *  @{
+    */
+    /** Counters of what the engine did, sampled once per frame
+
+        Each thread adds to its own counters without locking, so the engine keeps them
+        updated in every build. While the statistics are disabled, counting costs an atomic
+        load. Root samples the counters at the end of every frame, which sums the threads
+        and keeps the values of the frame in a history, for the API or a CSV / JSON dump.
+    @par
+        The builtin counters are
+        - visible_objects: objects added to the render queues
+        - culled_objects: objects of the visited scene nodes rejected by MovableObject::isVisible
+        - culled_nodes: scene nodes outside of the frustum, whose subtrees are skipped
+        - set_pass: calls to SceneManager::_setPass
+        - auto_param_uploads: GPU program parameters bound after updating their auto constants
+        - buffer_lock_bytes: bytes locked through HardwareBuffer::lock
+        - shader_cache_misses: microcode cache lookups which did not find the program
+        - resource_loads: calls to Resource::load which loaded the resource
+        - resource_load_us: time spent loading these, in microseconds
+        - workqueue_tasks: tasks run by the DefaultWorkQueue workers
+        - workqueue_latency_us: time these waited in the queue, in microseconds
+        - program_changes: GPU programs bound or unbound by SceneManager::_setPass
+        - texture_changes: texture units whose texture _setPass changed
+        - blend_changes: calls to _setPass changing the ColourBlendState
+    @par
+        Timers are counters of microseconds, see ScopedTimer.
+    */
+    class _OgreExport EngineStatistics
+    {
+    public:
+        typedef uint32 CounterId;
+
+        enum BuiltinCounter : CounterId
+        {
+            SC_VISIBLE_OBJECTS,
+            SC_CULLED_OBJECTS,
+            SC_CULLED_NODES,
+            SC_SET_PASS,
+            SC_AUTO_PARAM_UPLOADS,
+            SC_BUFFER_LOCK_BYTES,
+            SC_SHADER_CACHE_MISSES,
+            SC_RESOURCE_LOADS,
+            SC_RESOURCE_LOAD_TIME,
+            SC_WORKQUEUE_TASKS,
+            SC_WORKQUEUE_LATENCY,
+            SC_PROGRAM_CHANGES,
+            SC_TEXTURE_CHANGES,
+            SC_BLEND_CHANGES,
+            SC_BUILTIN_COUNT
+        };
+
+        /// Maximal number of counters, builtin ones included
+        enum { MAX_COUNTERS = 64 };
+
+        /// Values of the counters during one frame
+        struct Sample
+        {
+            /// Frame number, see Root::getNextFrameNumber
+            unsigned long frame;
+            /// Microseconds since the previous sample
+            uint64 duration;
+            /// Indexed by CounterId, the counters registered later are missing
+            std::vector<uint64> values;
+        };
+        typedef std::deque<Sample> SampleList;
+
+        /// Starts or stops counting on all threads
+        static void setEnabled(bool enabled);
+        static bool isEnabled(void) { return msEnabled.load(std::memory_order_relaxed); }
+
+        /** Returns the id of the counter, registering it first if needed. Locks.
+
+            The names should be usable as CSV column names and JSON keys.
+        */
+        static CounterId registerCounter(const String& name);
+        /// Number of counters registered, builtin ones included
+        static size_t getCounterCount(void);
+        static const String& getCounterName(CounterId id);
+
+        /// Adds to the counter of the calling thread
+        static void add(CounterId id, uint64 value = 1)
+        {
+            if (isEnabled())
+                _add(id, value);
+        }
+        /// Adds to the counter of the calling thread, even if the statistics are disabled
+        static void _add(CounterId id, uint64 value);
+
+        /// Steady clock time, in microseconds
+        static uint64 getMicroseconds(void);
+
+        /** Samples the counters as the values of the frame, called by Root
+
+            Does nothing while disabled.
+        */
+        static void _sampleFrame(unsigned long frame);
+
+        /// Value of the counter during the last sampled frame
+        static uint64 getFrameValue(CounterId id);
+        /// Value of the counter over all sampled frames
+        static uint64 getTotalValue(CounterId id);
+
+        /// Sets how many frames the history keeps, at least one. Default 300.
+        static void setHistorySize(size_t frames);
+        /// Copy of the sampled frames, oldest first
+        static SampleList getHistory(void);
+        /// Drops the history and resets the totals
+        static void reset(void);
+
+        /// Writes the history as CSV, one line per frame
+        static void writeCSV(std::ostream& os);
+        /// Writes the totals and the history as JSON
+        static void writeJSON(std::ostream& os);
+        /// Writes the history to a CSV file
+        static void exportCSV(const String& filename);
+        /// Writes the totals and the history to a JSON file
+        static void exportJSON(const String& filename);
+
+        /// Adds its lifetime in microseconds to a counter
+        class ScopedTimer
+        {
+        public:
+            explicit ScopedTimer(CounterId id) : mId(id), mStart(isEnabled() ? getMicroseconds() : 0) {}
+            /// Adds nothing if the statistics were disabled when it started
+            ~ScopedTimer()
+            {
+                if (mStart)
+                    _add(mId, getMicroseconds() - mStart);
+            }
+
+        private:
+            CounterId mId;
+            uint64 mStart;
+        };
+
+    private:
+        static std::atomic<bool> msEnabled;
+    };
+    /** @} */
+    /** @} */
+
+}
+
+#include "OgreHeaderSuffix.h"
+
+#endif
@@ -31,6 +31,7 @@ THE SOFTWARE.
 // Precompiler options
 #include "OgrePrerequisites.h"
 #include "OgreException.h"
+#include "OgreEngineStatistics.h"
 
 namespace Ogre {
 
@@ -217,7 +218,7 @@ namespace Ogre {
                 if (mShadowBuffer)
                 {
                     // we have to assume a read / write lock so we use the shadow buffer
-                    // and tag for sync on unlock()
+                    // and tag for sync on unlock(). It counts the locked bytes itself.
                     mShadowUpdated = (options != HBL_READ_ONLY);
 
                     ret = mShadowBuffer->lock(offset, length, options);
@@ -227,6 +228,7 @@ namespace Ogre {
                     mIsLocked = true;
                     // Lock the real buffer if there is no shadow buffer 
                     ret = lockImpl(offset, length, options);
+                    EngineStatistics::add(EngineStatistics::SC_BUFFER_LOCK_BYTES, length);
                 }
                 mLockStart = offset;
                 mLockSize = length;
@@ -426,7 +426,13 @@ namespace Ogre {
         {
             FILTER_NEAREST,
             FILTER_LINEAR,
-            FILTER_BILINEAR = FILTER_LINEAR
+            FILTER_BILINEAR = FILTER_LINEAR,
+            /// averages the covered source pixels
+            FILTER_BOX,
+            /// windowed sinc, sharper than box with little ringing
+            FILTER_KAISER,
+            /// windowed sinc with 3 lobes, sharpest but may ring at hard edges
+            FILTER_LANCZOS
         };
         /** Scale a 1D, 2D or 3D image volume. 
             @param  src         PixelBox containing the source pointer, dimensions and format
@@ -439,6 +445,38 @@ namespace Ogre {
         
         /** Resize a 2D image, applying the appropriate filter. */
         void resize(ushort width, ushort height, Filter filter = FILTER_BILINEAR);
+
+        /** Generate the complete mipmap chain from the top level of each face
+
+            Any existing mipmaps are replaced. The box, Kaiser and Lanczos filters are computed
+            in floating point on the worker threads of the Root WorkQueue, if there is one.
+            FILTER_LINEAR is treated as FILTER_BOX.
+            @param gammaCorrected the colour channels are sRGB encoded and filtered in linear space
+            @param filter which filter to use for reducing a level
+            @note compressed formats are not supported
+        */
+        void generateMipmaps(bool gammaCorrected = false, Filter filter = FILTER_BOX);
+
+        /// Speed versus quality trade off of the block compression
+        enum CompressionQuality
+        {
+            /// end points from the principal axis only
+            COMPRESS_FAST,
+            /// adds a least squares refinement of the end points
+            COMPRESS_NORMAL,
+            /// refines the end points further and searches more encoding modes
+            COMPRESS_BEST
+        };
+
+        /** Compress all faces and mipmaps to a block compressed format
+
+            The blocks are encoded on the worker threads of the Root WorkQueue, if there is one.
+            @param format one of PF_DXT1, PF_DXT3, PF_DXT5, PF_BC4_UNORM, PF_BC5_UNORM, PF_BC7_UNORM,
+            PF_ETC1_RGB8, PF_ETC2_RGB8 and PF_ETC2_RGBA8
+            @param quality the speed versus quality trade off
+            @note the image must not be compressed already
+        */
+        void compress(PixelFormat format, CompressionQuality quality = COMPRESS_NORMAL);
         
         /// Static function to calculate size in bytes from the number of mipmaps, faces and the dimensions
         static size_t calculateSize(uint32 mipmaps, uint32 faces, uint32 width, uint32 height, uint32 depth, PixelFormat format);
@@ -44,7 +44,58 @@ namespace Ogre {
     */
     class _OgreExport ImageCodec : public Codec
     {
+    public:
+        /** Receives the image decoded by decodeBands
+
+            The levels are delivered in order, starting at the top level, each one as a sequence
+            of bands of rows from top to bottom.
+        */
+        class _OgreExport BandListener
+        {
+        public:
+            virtual ~BandListener() {}
+            /** Called once the header is read, before any band
+            @param width, height the size of the top level
+            @param format the format the bands will have
+            @param numMipmaps the number of mipmaps stored after the top level
+            @return false to stop decoding without reading any pixel data
+            */
+            virtual bool imageHeaderDecoded(uint32 width, uint32 height, PixelFormat format,
+                                            uint32 numMipmaps) = 0;
+            /** Called for each band
+            @param mip the level the band belongs to
+            @param top the first row of the band in the level
+            @param band the pixels of the band, only valid during the call
+            */
+            virtual void bandDecoded(uint32 mip, uint32 top, const PixelBox& band) = 0;
+        };
+
+        /** Decodes a 2D image band by band instead of all at once
+
+            This keeps the memory needed for decoding at the size of a band, which matters for
+            very large images that are uploaded to the GPU right away, see Texture.
+        @param input Stream containing the encoded data
+        @param listener receives the header and the bands
+        @param maxBandSize the maximal size of a band in bytes. A band contains at least one row
+            of pixels, or of blocks for compressed formats.
+        @return false if the codec or this particular image does not support decoding in bands,
+            or the listener rejected the header. The stream is left at an undefined position then.
+        */
+        virtual bool decodeBands(const DataStreamPtr& input, BandListener* listener, size_t maxBandSize) const
+        {
+            return false;
+        }
+
     protected:
+        /** Reads a level stored as consecutive rows and passes it to the listener in bands
+        @param input the stream, positioned at the start of the level
+        @param listener receives the bands
+        @param mip, width, height, format the level to read
+        @param maxBandSize see decodeBands
+        */
+        static void readBands(const DataStreamPtr& input, BandListener* listener, uint32 mip, uint32 width,
+                              uint32 height, PixelFormat format, size_t maxBandSize);
+
         static void flipEndian(void* pData, size_t size, size_t count)
         {
 #if OGRE_ENDIAN == OGRE_ENDIAN_BIG
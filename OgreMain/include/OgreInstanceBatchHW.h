@@ -54,8 +54,25 @@ namespace Ogre
      */
     class _OgreExport InstanceBatchHW : public InstanceBatch
     {
+        /// Data of the instances visible from a camera, valid until the end of the frame
+        struct VisibleInstances
+        {
+            const Camera    *camera;
+            unsigned long   frameNumber;
+            Vector4         planes[6];
+            size_t          numPlanes;
+            size_t          numInstances;
+            std::vector<float> data;
+        };
+        typedef std::vector<VisibleInstances> VisibleInstancesVec;
+
         bool    mKeepStatic;
 
+        /// Culling results of the cameras rendered this frame
+        VisibleInstancesVec mVisibleInstances;
+        /// Index of the entry whose data is currently in the vertex buffer
+        size_t  mUploadedInstances;
+
         void setupVertices( const SubMesh* baseSubMesh ) override;
         void setupIndices( const SubMesh* baseSubMesh ) override;
 
@@ -63,6 +80,18 @@ namespace Ogre
 
         size_t updateVertexBuffer( Camera *currentCamera );
 
+        /** Culls the instances against the planes and writes the data of the visible ones
+        @param camera Pass null to skip culling
+        @return The number of visible instances
+        */
+        size_t fillVisibleInstances( const Camera *camera, const Vector4 *planes, size_t numPlanes,
+                                     float *pDest ) const;
+
+        /// Returns the index of the entry for the camera, or -1 if there is none yet
+        size_t findVisibleInstances( const Camera *camera, const Vector4 *planes, size_t numPlanes ) const;
+        /// Culls the instances into a new entry for the camera and returns its index
+        size_t prepareVisibleInstances( const Camera *camera, const Vector4 *planes, size_t numPlanes );
+
     public:
         InstanceBatchHW( InstanceManager *creator, MeshPtr &meshReference, const MaterialPtr &material,
                             size_t instancesPerBatch, const Mesh::IndexMap *indexToBoneMap,
@@ -96,6 +125,16 @@ namespace Ogre
         /** Overloaded to avoid updating skeletons (which we don't support), check visibility on a
             per unit basis and finally updated the vertex buffer */
         void _updateRenderQueue( RenderQueue* queue ) override;
+
+        /** Culls the instances against the camera and keeps the data of the visible ones until
+            the end of the frame, unless it is already there.
+
+            The instance spheres are tested in bulk, see OptimisedUtil::calculateSphereVisibility.
+            This is safe to call concurrently for different batches, once the scene graph and the
+            derived data of the camera have been updated.
+            @see InstanceManager::setParallelCulling
+        */
+        void _prepareVisibleInstances( const Camera *camera );
     };
 }
 
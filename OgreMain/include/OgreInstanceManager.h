@@ -115,6 +115,7 @@ namespace Ogre
 
         size_t                  mMaxLookupTableInstances;
         unsigned char           mNumCustomParams;       //Number of custom params per instance.
+        bool                    mParallelCulling;
 
         /** Finds a batch with at least one free instanced entity we can use.
             If none found, creates one.
@@ -280,6 +281,26 @@ namespace Ogre
         /** @copydoc InstanceBatch::setStaticAndUpdate */
         void setBatchesAsStaticAndUpdate( bool bStatic );
 
+        /** Sets whether the instances of all batches are culled at once, in parallel.
+
+            Only affects HWInstancingBasic, which culls on a per instance basis. When enabled,
+            the first batch rendered with a camera culls the instances of all batches of this
+            manager that are in the camera frustum, spreading the batches over the threads of
+            the WorkQueue. Otherwise each batch culls its instances when it is rendered.
+        @par
+            In both cases the result is kept per camera until the end of the frame, so
+            rendering the same camera again (e.g. in several compositor passes) does not
+            cull again.
+        @param parallel Whether to cull in parallel. Default: false
+        */
+        void setParallelCulling( bool parallel ) { mParallelCulling = parallel; }
+        bool getParallelCulling() const { return mParallelCulling; }
+
+        /** Called by the batches to cull their instances against the camera in parallel
+            @see setParallelCulling
+        */
+        void _prepareVisibleInstances( Camera *camera );
+
         /** Called by an InstanceBatch when it requests their bounds to be updated for proper culling
         @param dirtyBatch The batch which is dirty, usually same as caller.
         */
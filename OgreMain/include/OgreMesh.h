@@ -138,6 +138,8 @@ namespace Ogre {
         AxisAlignedBox mAABB;
         /// Local bounding sphere radius (centered on object).
         Real mBoundRadius;
+        /// Box the positions are quantised to, null if they are not quantised
+        AxisAlignedBox mQuantisationBounds;
         /// Largest bounding radius of any bone in the skeleton (centered on each bone, only considering verts weighted to the bone)
         Real mBoneBoundingRadius;
 
@@ -416,6 +418,22 @@ namespace Ogre {
         a shadow copy in the memory. Reading back the buffer from video memory is very slow!
         */
         void _calcBoundsFromVertexBuffer(VertexData* vertexData, AxisAlignedBox& outAABB, Real& outRadius, bool updateOnly = false);
+
+        /** Quantises the positions of all vertex data to 16 bit, relative to their exact bounds.
+
+            The positions are stored as #VET_SHORT4_NORM in [-1, 1], see VertexData::quantisePositions.
+            They must be decoded by the vertex shader, using getQuantisationBounds. The RTSS does this,
+            if RTShader::FFPTransform is configured to. Meshes with a skeleton, poses or vertex animation
+            are not supported, neither is anything that reads back the positions on the CPU, like
+            stencil shadows, StaticGeometry and instancing.
+        */
+        void _quantisePositions();
+
+        /** The box the positions are quantised to, or a null box if they are stored as floats
+
+            A quantised position q decodes to `getCenter() + getHalfSize() * q`.
+        */
+        const AxisAlignedBox& getQuantisationBounds() const { return mQuantisationBounds; }
         /** Sets the name of the skeleton this Mesh uses for animation.
 
             Meshes can optionally be assigned a skeleton which can be used to animate
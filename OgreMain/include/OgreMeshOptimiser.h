@@ -0,0 +1,153 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef __MeshOptimiser_H__
+#define __MeshOptimiser_H__
+
+#include "OgrePrerequisites.h"
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre {
+
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup Resources
+    *  @{
+    */
+    /** Reorders the triangles and vertices of a Mesh for faster rendering.
+
+        The pass works on each vertex data of the mesh, that is the shared vertex data and the
+        dedicated vertex data of the SubMeshes, and runs in three stages:
+        - the triangles of every index data, including the generated LOD levels, are reordered
+          for the post transform vertex cache, using the linear time Tipsify algorithm
+        - the reordered triangles are split into clusters, which are sorted so that the
+          clusters facing away from the centre of the mesh are drawn first, to reduce overdraw
+        - the vertices are sorted in the order they are first referenced and all the index
+          buffers are remapped, to improve the locality of the vertex fetches
+    @par
+        The bone assignments, poses and morph keyframes are remapped along with the vertices
+        and edge lists are rebuilt, if they were built. Manual LOD levels are separate meshes
+        and have to be optimised on their own.
+    @note the vertex and index buffers are read back, so they must be readable
+    */
+    class _OgreExport MeshOptimiser
+    {
+    public:
+        /// Result of simulating a FIFO post transform vertex cache
+        struct Statistics
+        {
+            /// Number of triangles drawn
+            size_t triangles;
+            /// Number of distinct vertices referenced by the triangles
+            size_t vertices;
+            /// Number of vertices transformed, that is the number of cache misses
+            size_t transformedVertices;
+
+            Statistics() : triangles(0), vertices(0), transformedVertices(0) {}
+
+            /// average cache miss ratio, transformed vertices per triangle (0.5 - 3.0)
+            float getACMR() const { return triangles ? float(transformedVertices) / triangles : 0; }
+            /// average transform to vertex ratio, transformed vertices per vertex (1.0 - 6.0)
+            float getATVR() const { return vertices ? float(transformedVertices) / vertices : 0; }
+        };
+
+        MeshOptimiser();
+
+        /// Sets the size of the simulated FIFO vertex cache, defaults to 16
+        void setCacheSize(uint32 size) { mCacheSize = size; }
+        uint32 getCacheSize() const { return mCacheSize; }
+
+        /// Sets whether the triangles are reordered for the vertex cache, defaults to true
+        void setOptimiseVertexCache(bool enable) { mOptimiseVertexCache = enable; }
+        bool getOptimiseVertexCache() const { return mOptimiseVertexCache; }
+
+        /** Sets how much the ACMR may grow, to allow sorting the triangles by their overdraw.
+
+            A threshold of 1.05 allows 5% more cache misses. Thresholds below 1 disable the stage.
+            Only positions of type VET_FLOAT3 are supported. Defaults to 1.05.
+        */
+        void setOverdrawThreshold(float threshold) { mOverdrawThreshold = threshold; }
+        float getOverdrawThreshold() const { return mOverdrawThreshold; }
+
+        /// Sets whether the vertices are sorted by their first use, defaults to true
+        void setOptimiseVertexFetch(bool enable) { mOptimiseVertexFetch = enable; }
+        bool getOptimiseVertexFetch() const { return mOptimiseVertexFetch; }
+
+        /// Simulates the vertex cache over the triangle lists of all LOD levels of the mesh
+        Statistics analyse(const Mesh* mesh) const;
+
+        /// Runs the enabled stages on the mesh
+        void optimise(Mesh* mesh) const;
+
+        /** Simulates a FIFO vertex cache over a triangle list.
+        @param indexes the triangle list
+        @param indexCount the number of indexes
+        @param cacheSize the number of vertices held by the cache
+        */
+        static Statistics analyseVertexCache(const uint32* indexes, size_t indexCount,
+                                             uint32 cacheSize = 16);
+
+        /** Reorders a triangle list for a FIFO vertex cache, in linear time.
+        @param indexes the triangle list, which is reordered in place
+        @param indexCount the number of indexes
+        @param cacheSize the number of vertices held by the cache
+        */
+        static void optimiseVertexCache(uint32* indexes, size_t indexCount, uint32 cacheSize = 16);
+
+        /** Sorts the clusters of a cache optimised triangle list by their overdraw.
+        @param indexes the triangle list, which is reordered in place
+        @param indexCount the number of indexes
+        @param positions the vertex positions, indexed by the triangle list
+        @param threshold how much the ACMR may grow, see setOverdrawThreshold
+        @param cacheSize the number of vertices held by the cache
+        */
+        static void optimiseOverdraw(uint32* indexes, size_t indexCount, const Vector3f* positions,
+                                     float threshold = 1.05f, uint32 cacheSize = 16);
+
+        /** Builds the vertex order for the vertex fetch optimisation.
+        @param indexes the triangle lists, concatenated
+        @param indexCount the number of indexes
+        @param vertexCount the number of vertices
+        @param remap receives the new index of each vertex. Vertices which are not referenced
+            are moved to the end, keeping their order.
+        */
+        static void buildVertexFetchRemap(const uint32* indexes, size_t indexCount,
+                                          size_t vertexCount, std::vector<uint32>& remap);
+    private:
+        uint32 mCacheSize;
+        float mOverdrawThreshold;
+        bool mOptimiseVertexCache;
+        bool mOptimiseVertexFetch;
+    };
+    /** @} */
+    /** @} */
+}
+
+#include "OgreHeaderSuffix.h"
+
+#endif
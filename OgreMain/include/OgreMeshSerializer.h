@@ -143,12 +143,24 @@ namespace Ogre {
         void setListener(MeshSerializerListener *listener);
         /// Returns the current listener
         MeshSerializerListener *getListener();
+
+        /** Sets whether the vertex and index buffers are compressed on export.
+
+            The buffers are compressed losslessly, by delta coding the vertices and indexes and
+            storing the deltas with as few bits as possible. This works best on meshes optimised
+            with MeshOptimiser. They are decompressed in parallel on import. Only the latest
+            format version supports this, and older versions of OGRE can not read such files.
+            Defaults to false.
+        */
+        void setCompressGeometry(bool compress) { mCompressGeometry = compress; }
+        bool getCompressGeometry() const { return mCompressGeometry; }
         
     private:
         typedef std::vector<MeshVersionData*> MeshVersionDataList;
         MeshVersionDataList mVersionData;
 
         MeshSerializerListener *mListener;
+        bool mCompressGeometry;
 
     };
 
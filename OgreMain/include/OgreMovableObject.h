@@ -152,6 +152,8 @@ namespace Ogre {
         mutable ulong mLightListUpdated;
         /// the light mask defined for this movable. This will be taken into consideration when deciding which light should affect this movable
         uint32 mLightMask;
+        /// Leaf in the hierarchy of the default scene queries of the SceneManager, see BoundingVolumeHierarchy
+        int32 mSceneQueryLeaf;
 
         // Static members
         /// Default query flags
@@ -179,6 +181,11 @@ namespace Ogre {
         virtual void _notifyManager(SceneManager* man) { mManager = man; }
         /** Get the manager of this object, if any (internal use only) */
         SceneManager* _getManager(void) const { return mManager; }
+        /** Get the leaf of this object in the hierarchy of the default scene queries,
+            or one of the BoundingVolumeHierarchy values which are not leaves (internal use only) */
+        int32 _getSceneQueryLeaf(void) const { return mSceneQueryLeaf; }
+        /** Set the leaf of this object in the hierarchy of the default scene queries (internal use only) */
+        void _setSceneQueryLeaf(int32 leaf) { mSceneQueryLeaf = leaf; }
 
         /** Notifies the movable object that hardware resources were lost
 
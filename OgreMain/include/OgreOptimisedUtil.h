@@ -72,6 +72,16 @@ namespace Ogre {
         */
         static OptimisedUtil* getImplementation(void) { return msImplementation; }
 
+        typedef std::pair<const char*, OptimisedUtil*> NamedImplementation;
+        typedef std::vector<NamedImplementation> NamedImplementationList;
+        /** Gets all the implementations the CPU can run, with their names.
+
+            The general one comes first, the others follow in order of preference.
+            Meant for comparing the implementations against each other in tests
+            and benchmarks, the engine only uses getImplementation.
+        */
+        static NamedImplementationList getSupportedImplementations(void);
+
         /** Performs software vertex skinning.
         @param srcPosPtr Pointer to source position buffer.
         @param destPosPtr Pointer to destination position buffer.
@@ -204,6 +214,25 @@ namespace Ogre {
             const float* srcPositions,
             float* destPositions,
             size_t numVertices) = 0;
+
+        /** Calculate the visibility of spheres against a set of planes, e.g. the
+            ones of a frustum.
+        @param planes The planes, with the normal in x/y/z and the distance
+            from origin in w, like Plane. No alignment requirements.
+        @param numPlanes Number of planes to test against.
+        @param spheres An array of spheres, with the centre in x/y/z and the
+            radius in w. Must be aligned to SIMD alignment.
+        @param visibilities An array of flags to store the results, the flag is
+            false if the corresponding sphere is completely on the negative side
+            of any of the planes, true otherwise. No alignment requirements.
+        @param numSpheres Number of spheres to test.
+        */
+        virtual void calculateSphereVisibility(
+            const Vector4* planes,
+            size_t numPlanes,
+            const Vector4* spheres,
+            char* visibilities,
+            size_t numSpheres) = 0;
     };
 
     /** Returns raw offsetted of the given pointer.
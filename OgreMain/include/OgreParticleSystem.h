@@ -266,6 +266,25 @@ namespace Ogre {
         */
         void _update(Real timeElapsed);
 
+        /** Performs the part of @ref _update that must run on the main thread.
+
+            Checks whether the system needs updating at all and configures the
+            renderer and the emitted emitters if not done already.
+        @param timeElapsed The time since the last frame, scaled by the speed factor on return
+        @return false if the system should not be updated this frame
+        */
+        bool _prepareUpdate(Real& timeElapsed);
+
+        /** Performs the part of @ref _update that only touches this system.
+
+            This expires, affects, moves and emits particles and recalculates the bounds.
+            It is safe to call this concurrently for different systems after @ref _prepareUpdate,
+            as long as the affectors and emitters in use do not share state.
+        @param timeElapsed The scaled time as returned by @ref _prepareUpdate
+        @return true if the bounds changed and the parent node must be notified
+        */
+        bool _updateParticles(Real timeElapsed);
+
         /** Returns all active particles in this system.
 
             This method is designed to be used by people providing new ParticleAffector subclasses,
@@ -678,6 +697,11 @@ namespace Ogre {
         /// Optional origin of this particle system (eg script name)
         String mOrigin;
 
+        /// Requested emissions per emitter, kept around to avoid reallocation
+        std::vector<unsigned> mEmissionRequests;
+        /// Requested emissions per active emitted emitter
+        std::vector<unsigned> mEmittedEmissionRequests;
+
         /// Default iteration interval
         static Real msDefaultIterationInterval;
         /// Default nonvisible update timeout
@@ -699,6 +723,11 @@ namespace Ogre {
         /** Applies the effects of affectors. */
         void _triggerAffectors(Real timeElapsed);
 
+        /** Recalculate the bounds without notifying the parent node.
+        @return true if the bounds were recalculated
+        */
+        bool calculateBounds(void);
+
         /** Sort the particles in the system **/
         void _sortParticles(Camera* cam);
 
@@ -96,6 +96,11 @@ namespace Ogre {
         // Factory instance
         ParticleSystemFactory* mFactory;
 
+        /// Whether updates are collected and processed in parallel
+        bool mParallelUpdate;
+        /// Systems waiting for their update, with the elapsed time
+        std::vector<std::pair<ParticleSystem*, Real>> mQueuedUpdates;
+
         /// Internal implementation of createSystem
         ParticleSystem* createSystemImpl(const String& name, size_t quota, 
             const String& resourceGroup);
@@ -313,6 +318,32 @@ namespace Ogre {
                 mSystemTemplates.begin(), mSystemTemplates.end());
         } 
 
+        /** Sets whether all particle systems are updated in parallel.
+
+            By default each system is updated on the main thread by its own Controller.
+            If enabled, these updates are only collected and then processed all at once on the
+            worker threads of the @ref WorkQueue, before the scene graph is updated and culled.
+            Sorting and filling the hardware buffers still happens on the render thread.
+        @par
+            Each system is still updated in its usual order, so emission and emitted emitters
+            behave as before. However, custom emitters and affectors must not share mutable
+            state between systems and Math::UnitRandom must be thread-safe; see
+            Math::SetRandomValueProvider.
+        */
+        void setParallelUpdate(bool enable) { mParallelUpdate = enable; }
+        /// Gets whether all particle systems are updated in parallel
+        bool getParallelUpdate() const { return mParallelUpdate; }
+
+        /// Queue an update for processing by @ref _processQueuedUpdates (internal use)
+        void _queueUpdate(ParticleSystem* sys, Real timeElapsed);
+        /// Remove any queued update of the given system (internal use)
+        void _cancelUpdate(ParticleSystem* sys);
+        /** Process all queued updates in parallel (internal use)
+
+            Called by SceneManager after updating the controllers.
+        */
+        void _processQueuedUpdates();
+
         /** Get an instance of ParticleSystemFactory (internal use). */
         ParticleSystemFactory* _getFactory(void) { return mFactory; }
         
@@ -646,6 +646,8 @@ namespace Ogre {
             @param  dst         PixelBox containing the destination pixels, pitches and format
             @remarks The source and destination boxes must have the same
             dimensions. In case the source and destination format match, a plain copy is done.
+            Converting to the block compressed formats supported by Image::compress encodes
+            the pixels, other compressed formats can only be copied.
         */
         static void bulkPixelConversion(const PixelBox &src, const PixelBox &dst);
 
@@ -99,6 +99,7 @@ namespace Ogre {
     class BillboardChain;
     class BillboardSet;
     class Bone;
+    class BoundingVolumeHierarchy;
     class Camera;
     class Codec;
     class ColourValue;
@@ -140,6 +141,7 @@ namespace Ogre {
     class HardwareVertexBuffer;
     class HardwarePixelBuffer;
     class HighLevelGpuProgram;
+    class ImageCodec;
     class IndexData;
     class InstanceBatch;
     class InstanceBatchHW;
@@ -198,6 +200,7 @@ namespace Ogre {
     class Quaternion;
     class Radian;
     class Ray;
+    class RayPacket;
     class RaySceneQuery;
     class RaySceneQueryListener;
     class Renderable;
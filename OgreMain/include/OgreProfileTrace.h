@@ -0,0 +1,146 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef __ProfileTrace_H__
+#define __ProfileTrace_H__
+
+#include "OgrePrerequisites.h"
+#include "OgreHeaderPrefix.h"
+
+#include <atomic>
+#include <iosfwd>
+
+/** Records the enclosing scope in the ProfileTrace of the calling thread
+
+    The name is interned on the first call only, so it must not change between calls.
+*/
+#define OgreTraceScope( name ) \
+    static const Ogre::ProfileTrace::NameId OGRE_TOKEN_PASTE(_OgreTraceName, __LINE__) = \
+        Ogre::ProfileTrace::intern( (name) ); \
+    Ogre::ProfileTrace::Scope OGRE_TOKEN_PASTE(_OgreTraceScope, __LINE__) ( OGRE_TOKEN_PASTE(_OgreTraceName, __LINE__) )
+
+namespace Ogre {
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup General
+    *  @{
+    */
+    /** Records when scopes begin and end on every thread, for export as a Chrome trace
+
+        Each thread records into its own ring buffer without locking, which overwrites the
+        oldest events of the thread once it is full. While the trace is disabled, recording
+        an event costs an atomic load, so the instrumentation is compiled into every build,
+        unlike the one of the Profiler. Names are interned to ids, see OgreTraceScope.
+    @par
+        The export pairs the begin and end events of each thread into complete events, which
+        chrome://tracing and https://ui.perfetto.dev display as one track per thread. Scopes
+        still open, or whose begin event was overwritten, are left out.
+    @note
+        In builds with OGRE_PROFILING, the profiles given to the Profiler go to the trace
+        as well, whether the Profiler is enabled or not.
+    */
+    class _OgreExport ProfileTrace
+    {
+    public:
+        typedef uint32 NameId;
+
+        /// Starts or stops recording on all threads
+        static void setEnabled(bool enabled);
+        static bool isEnabled(void) { return msEnabled.load(std::memory_order_relaxed); }
+
+        /** Sets how many events each thread keeps, rounded up to a power of two
+
+            Only affects the threads which did not record anything yet. Default 65536.
+        */
+        static void setThreadBufferSize(size_t events);
+
+        /// Returns the id of the name, registering it first if needed. Locks.
+        static NameId intern(const String& name);
+        /// Names the calling thread in the exported trace
+        static void setThreadName(const String& name);
+
+        /// Records the beginning of a scope on the calling thread
+        static void begin(NameId name)
+        {
+            if (isEnabled())
+                record(name);
+        }
+        /// Records the end of a scope on the calling thread
+        static void end(NameId name)
+        {
+            if (isEnabled())
+                record(name | END_FLAG);
+        }
+
+        /** Drops the events recorded so far
+
+            Must not be called while other threads record events.
+        */
+        static void clear(void);
+
+        /// Writes the events recorded so far as Chrome trace JSON
+        static void writeChromeTrace(std::ostream& os);
+        /// Writes the events recorded so far to a Chrome trace JSON file
+        static void exportChromeTrace(const String& filename);
+
+        /// Records its lifetime, see OgreTraceScope
+        class Scope
+        {
+        public:
+            explicit Scope(NameId name) : mName(name), mRecorded(isEnabled())
+            {
+                if (mRecorded)
+                    record(name);
+            }
+            /// Ends the scope even if the trace got disabled meanwhile
+            ~Scope()
+            {
+                if (mRecorded)
+                    record(mName | END_FLAG);
+            }
+
+        private:
+            NameId mName;
+            bool mRecorded;
+        };
+
+    private:
+        enum : uint32 { END_FLAG = 0x80000000 };
+
+        static std::atomic<bool> msEnabled;
+
+        static void record(uint32 event);
+    };
+    /** @} */
+    /** @} */
+
+}
+
+#include "OgreHeaderSuffix.h"
+
+#endif
@@ -0,0 +1,103 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef __RayPacket_H__
+#define __RayPacket_H__
+
+#include "OgrePrerequisites.h"
+#include "OgreRay.h"
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre {
+
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup Math
+    *  @{
+    */
+    /** A few rays tested together against boxes, one per SIMD lane.
+
+        The scene managers use it to answer RaySceneQuery::executeBatch, testing the
+        bounds of their spatial structures against all the rays of the packet at once.
+    @par
+        Each ray has a maximal distance, which a traversal looking for the nearest hits
+        lowers as it finds them, so the boxes further along are not hit anymore.
+    @note
+        The box tests are conservative: a ray grazing a box may hit it even though
+        Ray::intersects would not, so the hits must be confirmed with it.
+    */
+    class _OgreExport RayPacket
+    {
+    public:
+        /// Maximal number of rays of a packet
+        enum { WIDTH = 4 };
+        /// Bit i is set for the ray i
+        typedef uint32 Mask;
+
+        /** Loads the rays, which must outlive the packet.
+        @param rays the rays to test
+        @param count number of rays, at most WIDTH
+        */
+        RayPacket(const Ray* rays, size_t count);
+
+        /// Number of rays
+        size_t size(void) const { return mCount; }
+        /// Mask of all the rays
+        Mask getMask(void) const { return (Mask(1) << mCount) - 1; }
+        const Ray& getRay(size_t i) const { return mRays[i]; }
+
+        /// The boxes further than this along the ray are not hit, infinite by default
+        Real getMaxDistance(size_t i) const { return mMaxDistance[i]; }
+        void setMaxDistance(size_t i, Real distance) { mMaxDistance[i] = distance; }
+
+        /** Tests the rays against the box.
+        @param min,max corners of the box
+        @param nearest if not NULL, receives the smallest distance at which a ray enters the
+            box, only valid if some rays hit it
+        @return the rays hitting the box within their maximal distance
+        */
+        Mask intersects(const Vector3& min, const Vector3& max, Real* nearest = NULL) const;
+        /// @overload
+        Mask intersects(const AxisAlignedBox& box, Real* nearest = NULL) const;
+
+    private:
+        const Ray* mRays;
+        size_t mCount;
+        /// Origins and inverse directions per component, the unused lanes never hit
+        Real mOrigin[3][WIDTH];
+        Real mInvDirection[3][WIDTH];
+        Real mMaxDistance[WIDTH];
+    };
+    /** @} */
+    /** @} */
+
+}
+
+#include "OgreHeaderSuffix.h"
+
+#endif
@@ -118,7 +118,13 @@ namespace Ogre {
             /** Sort ascending camera distance 
                 Note value overlaps with descending since both use same sort
             */
-            OM_SORT_ASCENDING = 6
+            OM_SORT_ASCENDING = 6,
+            /** Sort by a 64 bit key packing, from the most significant bits, the pass
+                index, the GPU programs, the textures, the pass, the vertex declaration
+                and the camera distance, ascending. Consecutive renderables of the same
+                pass are visited as a group.
+            */
+            OM_SORT_KEY = 8
         };
 
     private:
@@ -145,6 +151,15 @@ namespace Ogre {
          vectors only ever increase in size, so even if we do clear() the memory stays
          allocated, ie fast */
         typedef std::vector<RenderablePass> RenderablePassList;
+        /// RenderablePass with its sort key, see OM_SORT_KEY
+        struct KeyedRenderablePass
+        {
+            uint64 key;
+            RenderablePass rp;
+
+            KeyedRenderablePass(const RenderablePass& _rp) : key(0), rp(_rp) {}
+        };
+        typedef std::vector<KeyedRenderablePass> KeyedRenderablePassList;
         /** Map of pass to renderable lists, this is a grouping by pass. */
         typedef std::map<Pass*, RenderableList, PassGroupLess> PassGroupRenderableMap;
 
@@ -155,6 +170,10 @@ namespace Ogre {
         PassGroupRenderableMap mGrouped;
         /// Sorted descending (can iterate backwards to get ascending)
         RenderablePassList mSortedDescending;
+        /// Sorted by key
+        KeyedRenderablePassList mSortedByKey;
+        /// Renderables of consecutive items with the same pass, while visiting mSortedByKey
+        mutable RenderableList mPassRun;
 
         /// Internal visitor implementation
         void acceptVisitorGrouped(QueuedRenderableVisitor* visitor) const;
@@ -162,6 +181,8 @@ namespace Ogre {
         void acceptVisitorDescending(QueuedRenderableVisitor* visitor) const;
         /// Internal visitor implementation
         void acceptVisitorAscending(QueuedRenderableVisitor* visitor) const;
+        /// Internal visitor implementation
+        void acceptVisitorSortKey(QueuedRenderableVisitor* visitor) const;
 
     public:
         QueuedRenderableCollection();
@@ -227,8 +248,9 @@ namespace Ogre {
     @par
         This class can order solid renderables by a number of criteria; 
         it can optimise them into groups based on pass to reduce render 
-        state changes, or can sort them by ascending or descending view 
-        depth. Transparent objects are always ordered by descending depth.
+        state changes, sort them by ascending or descending view depth, or
+        by sort keys combining both. Transparent objects are always ordered
+        by descending depth.
     @par
         To iterate over items in the collections held by this object 
         you should retrieve the collection in use (e.g. solids, solids with
@@ -50,6 +50,8 @@ Torus Knot Software Ltd.
 #include "OgreHeaderPrefix.h"
 #include "OgreNameGenerator.h"
 
+#include <functional>
+
 namespace Ogre {
     /** \addtogroup Core
     *  @{
@@ -724,6 +726,11 @@ namespace Ogre {
         bool mDisplayNodes;
         std::unique_ptr<DebugDrawer> mDebugDrawer;
 
+        /// Hierarchy of the MovableObjects, for the default scene queries
+        std::unique_ptr<BoundingVolumeHierarchy> mSceneQueryBVH;
+        /// Stops searching an extracted object in the default scene queries
+        void untrackMovableObject(MovableObject* m);
+
         /// Storage of animations, lookup by name
         AnimationList mAnimationsList;
         OGRE_MUTEX(mAnimationsListMutex);
@@ -999,6 +1006,8 @@ namespace Ogre {
 
         /// Whether to use camera-relative rendering
         bool mCameraRelativeRendering;
+        /// Whether the solids are sorted by QueuedRenderableCollection::OM_SORT_KEY
+        bool mSolidsSortedByKey;
 
         /// Last light sets
         uint32 mLastLightHash;
@@ -1013,6 +1022,12 @@ namespace Ogre {
         void bindGpuProgram(GpuProgram* prog);
         void updateGpuProgramParameters(const Pass* p);
 
+        /// State set by the last _setPass, to count its changes in EngineStatistics
+        std::array<const GpuProgram*, GPT_COUNT> mLastPassPrograms;
+        std::vector<const Texture*> mLastPassTextures;
+        ColourBlendState mLastPassBlendState;
+        void countPassStateChanges(const Pass* pass);
+
         /// Set of registered LOD listeners
         typedef std::set<LodListener*> LodListenerSet;
         LodListenerSet mLodListeners;
@@ -1176,6 +1191,20 @@ namespace Ogre {
         */
         bool getCameraRelativeRendering() const { return mCameraRelativeRendering; }
 
+        /** Set whether to sort the solids by keys packing their GPU programs, textures,
+            pass, vertex declaration and camera distance, rather than grouping them by pass.
+
+            The sort keys minimise the state changes of the render system over all the
+            passes, while rendering the solids roughly front to back. The change of the
+            grouping pays off when many passes share their programs or textures, which
+            the "program_changes" and "texture_changes" EngineStatistics counters show.
+        @see QueuedRenderableCollection::OM_SORT_KEY
+        */
+        void setSolidsSortedByKey(bool sorted) { mSolidsSortedByKey = sorted; }
+
+        /// Get whether to sort the solids by keys
+        bool getSolidsSortedByKey() const { return mSolidsSortedByKey; }
+
         /** Returns a specialised MapIterator over all cameras in the scene.
         @deprecated use getCameras()
         */
@@ -2522,6 +2551,20 @@ namespace Ogre {
 
         /** Destroys a scene query of any type. */
         void destroyQuery(SceneQuery* query);
+
+        /** Gets the hierarchy of the MovableObjects used by the default scene queries.
+
+            It is created on first use, from the current bounds of the objects, and is
+            then kept up to date as their bounds are updated. SceneManager subclasses
+            implementing their own queries never create it.
+        */
+        BoundingVolumeHierarchy* _getSceneQueryBVH(void);
+        /** Internal method, called when the world bounds of the object were derived,
+            which refits it in the hierarchy of the default scene queries, if there is one. */
+        void _notifyMovableObjectBoundsUpdated(MovableObject* obj);
+        /** Internal method, called when the object was detached, which removes it from
+            the hierarchy of the default scene queries, if there is one. */
+        void _notifyMovableObjectDetached(MovableObject* obj);
         /// @}
 
         /// @name Generic Shadows Config
@@ -3385,6 +3428,22 @@ namespace Ogre {
         ~DefaultRaySceneQuery();
 
         void execute(RaySceneQueryListener* listener) override;
+        void executeBatch(const Ray* rays, size_t count, RaySceneQueryResultEntry* results,
+                          bool parallel = false) override;
+
+    protected:
+        /// Finds the nearest hits of the rays of a packet, from any thread
+        typedef std::function<void(RayPacket& packet, RaySceneQueryResultEntry* results)> PacketCaster;
+
+        /// Splits the rays in packets, and casts them on the WorkQueue if parallel
+        void castPackets(const Ray* rays, size_t count, RaySceneQueryResultEntry* results, bool parallel,
+                         const PacketCaster& cast) const;
+        /** Tests the rays of the packet against the world bounding box of the object,
+            keeping their nearest hits and lowering their maximal distances to them.
+        @param rays the rays to test, hitting the bounds of the object
+        @return the rays hitting the object
+        */
+        uint32 hitObject(RayPacket& packet, uint32 rays, MovableObject* obj, RaySceneQueryResultEntry* results) const;
     };
     /** Default implementation of SphereSceneQuery. */
     class _OgreExport DefaultSphereSceneQuery : public SphereSceneQuery
@@ -294,6 +294,11 @@ namespace Ogre {
     {
     protected:
         Ray mRay;
+
+        /** Whether a hit of the movable at the given distance replaces the nearest hit
+            found so far, as ranked by executeBatch.
+        */
+        static bool isNearerHit(MovableObject* movable, Real distance, const RaySceneQueryResultEntry& nearest);
     private:
         bool mSortByDistance;
         ushort mMaxResults;
@@ -349,6 +354,23 @@ namespace Ogre {
         */
         virtual void execute(RaySceneQueryListener* listener) = 0;
 
+        /** Finds the nearest hit of each of the given rays.
+
+            This answers many rays much faster than setting and executing the query for
+            each of them: the default and octree scene managers test packets of rays
+            against their bounding volumes at once. The query and type masks of this
+            query apply, while its ray, sorting and last results are left untouched.
+        @param rays the rays to cast
+        @param count number of rays
+        @param results receives the nearest hit of each ray, with a NULL movable and
+            world fragment if it hits nothing. Among hits at the same distance, the
+            movable type then name which sort first wins.
+        @param parallel split the rays across the threads of the WorkQueue, if the scene
+            manager supports it
+        */
+        virtual void executeBatch(const Ray* rays, size_t count, RaySceneQueryResultEntry* results,
+                                  bool parallel = false);
+
         /** Gets the results of the last query that was run using this object, provided
             the query was executed using the collection-returning version of execute. 
         */
@@ -36,6 +36,8 @@ THE SOFTWARE.
 
 namespace Ogre {
 
+    class StaticGeometrySerializer;
+
     /** \addtogroup Core
     *  @{
     */
@@ -177,6 +179,8 @@ namespace Ogre {
             Vector3 scale;
         };
         typedef std::vector<QueuedGeometry*> QueuedGeometryList;
+        /// Copies of the source buffer contents, so worker threads do not have to lock them
+        typedef std::map<const HardwareBuffer*, std::vector<uchar>> SourceBufferMap;
         
         // forward declarations
         class LODBucket;
@@ -189,6 +193,7 @@ namespace Ogre {
         */
         class _OgreExport GeometryBucket :  public Renderable,  public BatchedGeometryAlloc
         {
+            friend class StaticGeometrySerializer;
             /// Geometry which has been queued up pre-build (not for deallocation)
             QueuedGeometryList mQueuedGeometry;
             /// Pointer to parent bucket
@@ -201,6 +206,8 @@ namespace Ogre {
             IndexData* mIndexData;
             /// Maximum vertex indexable
             size_t mMaxVertexIndex;
+            /// Construct without geometry, which is set up by the StaticGeometrySerializer
+            GeometryBucket(MaterialBucket* parent);
         public:
             GeometryBucket(MaterialBucket* parent, const VertexData* vData, const IndexData* iData);
             virtual ~GeometryBucket();
@@ -224,6 +231,14 @@ namespace Ogre {
             bool assign(QueuedGeometry* qsm);
             /// Build
             void build(bool stencilShadows);
+            /** Merge the queued geometry into system memory buffers.
+
+                Does not access the HardwareBufferManager, so it can run on a worker thread.
+            @param srcBuffers copies to read from instead of the original source buffers
+            */
+            void _fillBuffers(bool stencilShadows, const SourceBufferMap& srcBuffers);
+            /// Move the merged geometry to hardware buffers, must run on the main thread
+            void _uploadBuffers(bool stencilShadows);
             /// Dump contents for diagnostics
             _OgreExport friend std::ostream& operator<<(std::ostream& o, const GeometryBucket& b);
         };
@@ -231,6 +246,7 @@ namespace Ogre {
             Material (and implicitly the same LOD). */
         class _OgreExport MaterialBucket : public BatchedGeometryAlloc
         {
+            friend class StaticGeometrySerializer;
         public:
             /// list of Geometry Buckets in this region
             typedef std::vector<GeometryBucket*> GeometryBucketList;
@@ -258,6 +274,10 @@ namespace Ogre {
             void assign(QueuedGeometry* qsm);
             /// Build
             void build(bool stencilShadows);
+            /// @copydoc GeometryBucket::_fillBuffers
+            void _fillBuffers(bool stencilShadows, const SourceBufferMap& srcBuffers);
+            /// Load the material and create the hardware buffers, must run on the main thread
+            void _uploadBuffers(bool stencilShadows);
             /// Add children to the render queue
             void addRenderables(RenderQueue* queue, uint8 group, 
                 Real lodValue);
@@ -284,6 +304,7 @@ namespace Ogre {
         */
         class _OgreExport LODBucket : public BatchedGeometryAlloc
         {
+            friend class StaticGeometrySerializer;
         public:
             /// Lookup of Material Buckets in this region
             typedef std::map<String, MaterialBucket*> MaterialBucketMap;
@@ -316,6 +337,12 @@ namespace Ogre {
             void assign(QueuedSubMesh* qsm, ushort atLod);
             /// Build
             void build(bool stencilShadows);
+            /// Merge the geometry and build the edge list, can run on a worker thread
+            void _fillBuffers(bool stencilShadows, const SourceBufferMap& srcBuffers);
+            /// Build the edge list for stencil shadows from the merged geometry
+            void _buildEdgeList();
+            /// @copydoc MaterialBucket::_uploadBuffers
+            void _uploadBuffers(bool stencilShadows);
             /// Add children to the render queue
             void addRenderables(RenderQueue* queue, uint8 group, 
                 Real lodValue);
@@ -346,6 +373,8 @@ namespace Ogre {
         {
             friend class MaterialBucket;
             friend class GeometryBucket;
+            friend class StaticGeometry;
+            friend class StaticGeometrySerializer;
         public:
             /// list of LOD Buckets in this region
             typedef std::vector<LODBucket*> LODBucketList;
@@ -378,6 +407,13 @@ namespace Ogre {
             Camera *mCamera;
             /// Cached squared view depth value to avoid recalculation by GeometryBucket
             Real mSquaredViewDepth;
+            /// Location of the region geometry in the stream, if the region is streamed
+            size_t mStreamOffset;
+            size_t mStreamLength;
+            /// Whether a streamed region waits for being loaded or unloaded
+            bool mStreamRequestPending;
+            /// Last frame in which the region was within the streaming distance
+            unsigned long mLastStreamFrame;
 
         public:
             Region(StaticGeometry* parent, const String& name, SceneManager* mgr, 
@@ -389,6 +425,18 @@ namespace Ogre {
             void assign(QueuedSubMesh* qmesh);
             /// Build this region
             void build(bool stencilShadows);
+            /// Create the LOD buckets and assign the queued meshes to them
+            void _assignLods();
+            /// @copydoc LODBucket::_fillBuffers
+            void _fillBuffers(bool stencilShadows, const SourceBufferMap& srcBuffers);
+            /// Create the hardware buffers and attach this region to the scene, must run on the main thread
+            void _uploadBuffers(bool stencilShadows);
+            /// Whether the region geometry is loaded from a stream on demand
+            bool isStreamed(void) const { return mStreamLength > 0; }
+            /// Whether the region geometry is currently available
+            bool isLoaded(void) const { return !mLodBucketList.empty(); }
+            /// Discard the geometry of a streamed region, it is loaded again when needed
+            void _unloadGeometry();
             /// Get the region ID of this region
             uint32 getID(void) const { return mRegionID; }
             /// Get the centre point of the region
@@ -430,7 +478,27 @@ namespace Ogre {
             and region 1023 ends at mOrigin + (mRegionDimensions.x * 512).
         */
         typedef std::map<uint32, Region*> RegionMap;
+
+        /** Listener which gets notified about the progress of build()
+        */
+        class _OgreExport Listener
+        {
+        public:
+            virtual ~Listener() {}
+            /** Called after the geometry of a region has been merged.
+            @note When building in parallel, this is called from the worker threads.
+            @param geom the StaticGeometry being built
+            @param numPrepared the number of regions merged so far
+            @param numRegions the total number of regions
+            */
+            virtual void regionPrepared(StaticGeometry* geom, size_t numPrepared, size_t numRegions) {}
+            /// Called on the main thread, once all regions were added to the scene
+            virtual void buildFinished(StaticGeometry* geom) {}
+        };
     private:
+        friend class StaticGeometrySerializer;
+        struct BuildJob;
+        struct StreamSource;
         // General state & settings
         SceneManager* mOwner;
         String mName;
@@ -463,6 +531,31 @@ namespace Ogre {
         /// Map of regions
         RegionMap mRegionMap;
 
+        Listener* mListener;
+        bool mParallelBuild;
+        /// State of the build currently in progress
+        SharedPtr<BuildJob> mBuildJob;
+
+        Real mStreamingDistance;
+        /// Where streamed regions are loaded from
+        SharedPtr<StreamSource> mStreamSource;
+
+        /// create a new, empty region
+        Region* createRegion(uint32 index, const Vector3& centre);
+        /// queue loading or unloading a streamed region
+        void requestRegionStreaming(Region* region, bool load);
+        /// keep the stream to load regions from on demand
+        void setStreamSource(const DataStreamPtr& stream, const SharedPtr<StaticGeometrySerializer>& serializer);
+
+        /// allocate the queued meshes to regions and set up the build state
+        SharedPtr<BuildJob> startBuild(bool parallel);
+        /// merge the geometry of a single region and report the progress
+        void prepareRegion(BuildJob& job, Region* region);
+        /// merge the geometry of all regions on the worker threads
+        void prepareRegions(BuildJob& job);
+        /// wait for a background build to finish merging and discard it
+        void cancelBuild();
+
         /** Virtual method for getting a region most suitable for the
             passed in bounds. Can be overridden by subclasses.
         */
@@ -593,6 +686,50 @@ namespace Ogre {
         */
         virtual void build(void);
 
+        /** Build the geometry asynchronously.
+
+            Like build(), but merges the geometry of the regions on the worker threads
+            of the WorkQueue, while the calling thread continues. The hardware buffers
+            are created on the main thread by WorkQueue::processMainThreadTasks, one
+            region per task, and the regions are added to the scene as they are done.
+            Listener::buildFinished is called once all regions are in place.
+        @note
+            Meshes and materials referenced by the queued entities must stay alive until
+            the build finished. Calling destroy() or reset() cancels the build.
+        */
+        void buildInBackground(void);
+
+        /// Whether a build started by buildInBackground() is still in progress
+        bool isBuilding(void) const { return mBuildJob != nullptr; }
+
+        /** Sets whether build() merges the geometry of the regions in parallel.
+
+            The regions are then processed concurrently on the worker threads of the
+            WorkQueue and the hardware buffers are only created once all regions are
+            done. This needs a system memory copy of the source geometry and of the
+            merged geometry. The default is false.
+        */
+        void setParallelBuild(bool parallel) { mParallelBuild = parallel; }
+        /// Returns whether build() merges the geometry of the regions in parallel
+        bool getParallelBuild() const { return mParallelBuild; }
+
+        /** Sets the distance within which streamed regions are loaded.
+
+            Regions imported with StaticGeometrySerializer::importStaticGeometry and
+            streaming enabled are loaded in the background once a camera sees them
+            within this distance, and are unloaded again when no camera did so for
+            a couple of frames. The default is 0, which means that regions are loaded
+            as soon as they are seen.
+        */
+        void setStreamingDistance(Real dist) { mStreamingDistance = dist; }
+        /// Gets the distance within which streamed regions are loaded
+        Real getStreamingDistance(void) const { return mStreamingDistance; }
+
+        /// Sets a listener to be notified about the build progress
+        void setListener(Listener* listener) { mListener = listener; }
+        /// Gets the current build listener
+        Listener* getListener() const { return mListener; }
+
         /** Destroys all the built geometry state (reverse of build). 
 
             You can call build() again after this and it will pick up all the
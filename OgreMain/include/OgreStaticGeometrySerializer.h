@@ -0,0 +1,169 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef __StaticGeometrySerializer_H__
+#define __StaticGeometrySerializer_H__
+
+#include "OgrePrerequisites.h"
+#include "OgreSerializer.h"
+#include "OgreStaticGeometry.h"
+#include "OgreHardwareVertexBuffer.h"
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre {
+
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup Scene
+    *  @{
+    */
+/** Definition of the binary StaticGeometry file format
+
+    Like .mesh files, the file is arranged into chunks of
+        unsigned short CHUNK_ID        : one of the following chunk ids identifying the chunk
+        unsigned long  LENGTH          : length of the chunk in bytes, including this header
+        void*          DATA            : the data, which may contain other sub-chunks (various data types)
+*/
+    enum StaticGeometryChunkID {
+        SG_SETTINGS                 = 0x1100,
+            // Vector3 regionDimensions
+            // Vector3 origin
+            // float renderingDistance
+            // bool castShadows
+        SG_REGION                   = 0x2000,
+        // Repeating section, one per region
+            // unsigned int regionID
+            // Vector3 centre
+            // Vector3 boundsMin
+            // Vector3 boundsMax
+            // float boundingRadius
+            // char* lodStrategy
+            // unsigned short numLodValues
+            // float* lodValues
+            SG_LOD                  = 0x2100,
+            // Repeating section, one per LOD level
+                // unsigned short lod
+                // float lodValue
+                SG_MATERIAL         = 0x2110,
+                // Repeating section, one per material
+                    // char* materialName
+                    // char* materialGroup
+                    SG_GEOMETRY     = 0x2120,
+                    // Repeating section, one per batch
+                        // unsigned int vertexCount
+                        // bool indexes32Bit
+                        // unsigned int indexCount
+                        // unsigned int* / unsigned short* faceVertexIndices
+                        SG_GEOMETRY_VERTEX_ELEMENT = 0x2121,
+                        // Repeating section, see MeshFileFormat
+                            // unsigned short source
+                            // unsigned short type
+                            // unsigned short semantic
+                            // unsigned short offset
+                            // unsigned short index
+                        SG_GEOMETRY_VERTEX_BUFFER = 0x2122,
+                        // Repeating section
+                            // unsigned short bindIndex
+                            // unsigned short vertexSize
+                            // raw buffer data
+    };
+
+    /** Class for serialising built StaticGeometry to and from a binary file.
+
+        This allows baking the regions of a StaticGeometry offline, so the geometry does not
+        have to be merged on every launch. The file contains the merged vertex and index buffers
+        of every region along with the LOD values and the names of the materials used.
+    @par
+        When importing, the regions can either be loaded right away, or only the region headers
+        are read and the geometry of each region is streamed in on demand, see
+        StaticGeometry::setStreamingDistance.
+    */
+    class _OgreExport StaticGeometrySerializer : public Serializer
+    {
+    public:
+        StaticGeometrySerializer();
+
+        /** Exports the built regions of a StaticGeometry to the file specified.
+        @note the vertex and index buffers are read back, so they must be readable
+        @param geom The StaticGeometry to export, must be built
+        @param filename The destination filename
+        @param endianMode The endian mode to write in
+        */
+        void exportStaticGeometry(const StaticGeometry* geom, const String& filename,
+                                  Endian endianMode = ENDIAN_NATIVE);
+
+        /// @overload
+        void exportStaticGeometry(const StaticGeometry* geom, const DataStreamPtr& stream,
+                                  Endian endianMode = ENDIAN_NATIVE);
+
+        /** Imports the regions into a StaticGeometry.
+
+            Any existing regions of dest are destroyed and its settings are replaced by the ones
+            stored in the file. The referenced materials must be declared by then.
+        @param stream The stream holding the data, positioned at the start
+        @param dest The StaticGeometry to receive the regions
+        @param streamRegions If true, only the region headers are read and the stream is kept
+            to load the region geometry on demand. It must be seekable then.
+        */
+        void importStaticGeometry(const DataStreamPtr& stream, StaticGeometry* dest,
+                                  bool streamRegions = false);
+
+        /** Imports the geometry of a single region, which was skipped while streaming.
+        @param stream The stream positioned at the first SG_LOD chunk of the region
+        @param region The region to receive the geometry
+        */
+        void importRegion(const DataStreamPtr& stream, StaticGeometry::Region* region);
+
+    private:
+        void writeSettings(const StaticGeometry* geom);
+        void writeRegion(const StaticGeometry::Region* region);
+        void writeLod(StaticGeometry::LODBucket* lod);
+        void writeMaterial(StaticGeometry::MaterialBucket* mat);
+        void writeGeometry(const StaticGeometry::GeometryBucket* geom);
+
+        void readSettings(const DataStreamPtr& stream, StaticGeometry* dest);
+        StaticGeometry::Region* readRegionHeader(const DataStreamPtr& stream, StaticGeometry* dest);
+        void readLod(const DataStreamPtr& stream, StaticGeometry::Region* region);
+        void readMaterial(const DataStreamPtr& stream, StaticGeometry::LODBucket* lod);
+        void readGeometry(const DataStreamPtr& stream, StaticGeometry::MaterialBucket* mat);
+
+        size_t calcRegionSize(const StaticGeometry::Region* region);
+        size_t calcLodSize(StaticGeometry::LODBucket* lod);
+        size_t calcMaterialSize(StaticGeometry::MaterialBucket* mat);
+        size_t calcGeometrySize(const StaticGeometry::GeometryBucket* geom);
+
+        void flipVertexData(void* pData, size_t vertexCount, size_t vertexSize,
+                            const VertexDeclaration::VertexElementList& elems);
+    };
+    /** @} */
+    /** @} */
+}
+
+#include "OgreHeaderSuffix.h"
+
+#endif
@@ -197,28 +197,70 @@ namespace Ogre
             Vector3 binormal;
             // Which way the tangent space is oriented (+1 / -1) (set on first time found)
             int parity;
-            // What index the opposite parity vertex copy is at (0 if not created yet)
-            size_t oppositeParityIndex;
 
-            VertexInfo() : tangent(Vector3::ZERO), binormal(Vector3::ZERO), 
-                parity(0), oppositeParityIndex(0) {}
+            VertexInfo() : tangent(Vector3::ZERO), binormal(Vector3::ZERO), parity(0) {}
         };
         typedef std::vector<VertexInfo> VertexInfoArray;
         VertexInfoArray mVertexArray;
 
+        /// Tangent space of a face, calculated before adding it to the vertices
+        struct FaceInfo
+        {
+            Vector3 tsU;
+            Vector3 tsV;
+            Vector3 norm;
+            /// Weight of the face at each of its vertices
+            Real angleWeight[3];
+            /// Vertex indexes, with the winding of strips made consistent
+            uint32 vertInd[3];
+            int parity;
+            /// false for faces without UV area, which are skipped
+            bool valid;
+        };
+        /// A vertex split off while adding the faces to a vertex
+        struct SplitVertex
+        {
+            Vector3 tangent;
+            Vector3 binormal;
+            int parity;
+            /// Whether the split was caused by mirroring
+            bool mirrored;
+            /// Position in mVertexArray, assigned once all vertices are done
+            size_t index;
+        };
+
+        // working memory, kept between builds
+        std::vector<FaceInfo> mFaces;
+        /// First face of each index set, followed by the total number of faces
+        std::vector<size_t> mFaceStart;
+        /// First entry in mCorners of each vertex, followed by the total number of entries
+        std::vector<uint32> mCornerStart;
+        std::vector<uint32> mCornerCursor;
+        /// Faces referencing each vertex as face * 3 + corner, in face order
+        std::vector<uint32> mCorners;
+        /// For each entry in mCorners, the split vertex the face was added to, if any
+        std::vector<uint32> mCornerSplits;
+        /// Split vertices of each block of vertices
+        std::vector<std::vector<SplitVertex> > mBlockSplits;
+
         void extendBuffers(VertexSplits& splits);
         void insertTangents(Result& res,
             VertexElementSemantic targetSemantic, 
             unsigned short sourceTexCoordSet, unsigned short index);
 
         void populateVertexArray(unsigned short sourceTexCoordSet);
+        void readFaces();
         void processFaces(Result& result);
         /// Calculate face tangent space, U and V are weighted by UV area, N is normalised
         void calculateFaceTangentSpace(const size_t* vertInd, Vector3& tsU, Vector3& tsV, Vector3& tsN);
         Real calculateAngleWeight(size_t v0, size_t v1, size_t v2);
         int calculateParity(const Vector3& u, const Vector3& v, const Vector3& n);
-        void addFaceTangentSpaceToVertices(size_t indexSet, size_t faceIndex, size_t *localVertInd, 
-            const Vector3& faceTsU, const Vector3& faceTsV, const Vector3& faceNorm, Result& result);
+        void calculateFaces(size_t first, size_t last);
+        void buildCorners();
+        /// Add the faces to the vertices of a block, in face order
+        void addFacesToVertices(size_t block);
+        /// Number the split vertices in face order and record them in the result
+        void resolveSplits(Result& result);
         void normaliseVertices();
         void remapIndexes(Result& res);
         template <typename T>
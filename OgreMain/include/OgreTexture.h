@@ -532,7 +532,17 @@ namespace Ogre {
         typedef std::vector<Image> LoadedImages;
         LoadedImages mLoadedImages;
 
+        /// the image that loadImpl decodes and uploads in bands, instead of mLoadedImages
+        DataStreamPtr mBandStream;
+        ImageCodec* mBandCodec;
+
         void readImage(LoadedImages& imgs, const String& name, const String& ext, bool haveNPOT);
+        /// check whether the image can be loaded in bands and keep its stream for loadImpl
+        bool prepareBands(const String& ext, bool haveNPOT);
+        /// upload the image in bands, or all at once if that turns out to be impossible
+        void loadBands();
+        /// set the size and format from the source image and create the texture
+        void createForImage(uint32 width, uint32 height, uint32 depth, PixelFormat format, uint32 imageMips);
         void freeInternalResources(void);
     };
     /** @} */
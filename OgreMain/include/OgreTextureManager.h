@@ -400,6 +400,19 @@ namespace Ogre {
             return mDefaultNumMipmaps;
         }
 
+        /** Sets the size of the bands that large images are uploaded in
+
+            Textures, whose top level is larger than this, are decoded band by band and each band is
+            uploaded right away, if the codec supports it (see ImageCodec::decodeBands). This limits
+            the memory needed for loading to the size of a band, instead of the whole image.
+            @note with hardware generated mipmaps, the mipmaps are updated after each band
+            @param size the size in bytes, 0 disables loading in bands. The default is 16 MiB.
+        */
+        void setStreamingBandSize(size_t size) { mStreamingBandSize = size; }
+
+        /// @copydoc setStreamingBandSize
+        size_t getStreamingBandSize() const { return mStreamingBandSize; }
+
         /// Internal method to create a warning texture (bound when a texture unit is blank)
         const TexturePtr& _getWarningTexture();
 
@@ -418,6 +431,7 @@ namespace Ogre {
         ushort mPreferredIntegerBitDepth;
         ushort mPreferredFloatBitDepth;
         uint32 mDefaultNumMipmaps;
+        size_t mStreamingBandSize;
         TexturePtr mWarningTexture;
         SamplerPtr mDefaultSampler;
         std::map<String, SamplerPtr> mNamedSamplers;
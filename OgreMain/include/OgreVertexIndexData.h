@@ -152,12 +152,22 @@ namespace Ogre {
             - #VET_INT_10_10_10_2_NORM to #VET_FLOAT3 or #VET_FLOAT4
             - #VET_HALF3 to #VET_HALF4, VET_[U]SHORT3 to VET_[U]SHORT4
             - #VET_FLOAT3 to #VET_HALF3
+            - #VET_FLOAT2 to #VET_HALF2
             @param semantic The semantic of the element to convert
             @param dstType The type to convert to
             @param index Optional index for multi-input semantics like texture coordinates
         */
         void convertVertexElement(VertexElementSemantic semantic, VertexElementType dstType, uint16 index = 0);
 
+        /** Quantise the #VET_FLOAT3 positions to #VET_SHORT4_NORM, relative to the given bounds
+
+            The positions are mapped from the bounds to [-1, 1], so the original position is
+            `bounds.getCenter() + bounds.getHalfSize() * p`. The fourth component is 1.
+            Decoding is left to the vertex shader, see RTShader::FFPTransform.
+            @param bounds The box enclosing all positions
+        */
+        void quantisePositions(const AxisAlignedBox& bounds);
+
         /** Additional shadow volume vertex buffer storage. 
 
             This additional buffer is only used where we have prepared this VertexData for
@@ -273,6 +283,7 @@ namespace Ogre {
             Can only be used for index data which consists of triangle lists.
             It would in fact be pointless to use it on triangle strips or fans
             in any case.
+        @see MeshOptimiser::optimiseVertexCache
         */
         void optimiseVertexCacheTriList(void);
     
@@ -159,6 +159,20 @@ namespace Ogre
 
         /** Add a new task to the queue */
         virtual void addTask(std::function<void()> task) = 0;
+
+        /** Process a range of items on the worker threads and wait for completion.
+
+            The range [begin, end) is split into chunks of at most grainSize items,
+            which are handed to the worker threads via @ref addTask. The calling thread
+            processes chunks as well, so this also makes progress if the queue is paused,
+            not started yet or called from inside a task.
+            The first exception thrown by fn is re-thrown on the calling thread.
+        @param begin,end the range of item indices to process
+        @param fn called with a sub-range [first, last) of item indices
+        @param grainSize the maximal number of items per chunk
+        */
+        void parallelFor(size_t begin, size_t end, const std::function<void(size_t, size_t)>& fn,
+                         size_t grainSize = 1);
         
         /** Set whether to pause further processing of any requests. 
         If true, any further requests will simply be queued and not processed until
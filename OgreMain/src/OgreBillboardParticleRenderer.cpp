@@ -199,14 +199,17 @@ namespace Ogre {
 
         // Update billboard set geometry
         mBillboardSet->beginBillboards(currentParticles.size());
-        Billboard bb;
+        mBillboards.resize(currentParticles.size());
 
-        for (Particle* p : currentParticles)
+        bool ownDirection = mBillboardSet->getBillboardType() == BBT_ORIENTED_SELF ||
+                            mBillboardSet->getBillboardType() == BBT_PERPENDICULAR_SELF;
+        for (size_t i = 0; i < currentParticles.size(); ++i)
         {
+            const Particle* p = currentParticles[i];
+            Billboard& bb = mBillboards[i];
             bb.mPosition = p->mPosition;
 
-            if (mBillboardSet->getBillboardType() == BBT_ORIENTED_SELF ||
-                mBillboardSet->getBillboardType() == BBT_PERPENDICULAR_SELF)
+            if (ownDirection)
             {
                 // Normalise direction vector
                 bb.mDirection = p->mDirection;
@@ -222,8 +225,8 @@ namespace Ogre {
                 bb.mWidth = p->mWidth;
                 bb.mHeight = p->mHeight;
             }
-            mBillboardSet->injectBillboard(bb);
         }
+        mBillboardSet->injectBillboards(mBillboards.data(), mBillboards.size());
 
         mBillboardSet->endBillboards();
 
@@ -29,10 +29,18 @@ THE SOFTWARE.
 
 #include "OgreBillboardSet.h"
 #include "OgreBillboard.h"
+#include "OgrePlatformInformation.h"
 
 #include <algorithm>
 #include <memory>
 
+#if (__OGRE_HAVE_SSE && OGRE_ARCH_TYPE == OGRE_ARCHITECTURE_64) || __OGRE_HAVE_NEON
+#define OGRE_BILLBOARD_SIMD 1
+#include "OgreSIMDHelper.h"
+#else
+#define OGRE_BILLBOARD_SIMD 0
+#endif
+
 namespace Ogre {
     //-----------------------------------------------------------------------
     BillboardSet::BillboardSet() :
@@ -384,6 +392,285 @@ namespace Ogre {
         }
     }
     //-----------------------------------------------------------------------
+    namespace
+    {
+        /// Offsets of the left-top, right-top, left-bottom and right-bottom corners
+        struct CornerOffsets
+        {
+#if OGRE_BILLBOARD_SIMD
+            __m128 v[4];
+
+            static __m128 load(const Vector3& v) { return _mm_setr_ps(v.x, v.y, v.z, 0.0f); }
+
+            void set(const Vector3* offsets)
+            {
+                for (int i = 0; i < 4; ++i)
+                    v[i] = load(offsets[i]);
+            }
+
+            /// Same as BillboardSet::genVertOffsets
+            void set(Real left, Real right, Real top, Real bottom, Real width, Real height,
+                     const Vector3& x, const Vector3& y)
+            {
+                __m128 vx = load(x);
+                __m128 vy = load(y);
+                __m128 leftOff = _mm_mul_ps(vx, _mm_set1_ps(left * width));
+                __m128 rightOff = _mm_mul_ps(vx, _mm_set1_ps(right * width));
+                __m128 topOff = _mm_mul_ps(vy, _mm_set1_ps(top * height));
+                __m128 bottomOff = _mm_mul_ps(vy, _mm_set1_ps(bottom * height));
+                v[0] = _mm_add_ps(leftOff, topOff);
+                v[1] = _mm_add_ps(rightOff, topOff);
+                v[2] = _mm_add_ps(leftOff, bottomOff);
+                v[3] = _mm_add_ps(rightOff, bottomOff);
+            }
+
+            /// Write position, colour and texcoords of all corners
+            float* writeQuad(float* dst, const Vector3& pos, RGBA colour, const float* uv) const
+            {
+                __m128 p = load(pos);
+                for (int i = 0; i < 4; ++i)
+                {
+                    // the 4th lane is overwritten by the colour
+                    _mm_storeu_ps(dst, _mm_add_ps(p, v[i]));
+                    memcpy(dst + 3, &colour, sizeof(RGBA));
+                    dst[4] = uv[i * 2];
+                    dst[5] = uv[i * 2 + 1];
+                    dst += 6;
+                }
+                return dst;
+            }
+#else
+            Vector3 v[4];
+
+            void set(const Vector3* offsets) { std::copy(offsets, offsets + 4, v); }
+
+            void set(Real left, Real right, Real top, Real bottom, Real width, Real height,
+                     const Vector3& x, const Vector3& y)
+            {
+                Vector3 leftOff = x * (left * width);
+                Vector3 rightOff = x * (right * width);
+                Vector3 topOff = y * (top * height);
+                Vector3 bottomOff = y * (bottom * height);
+                v[0] = leftOff + topOff;
+                v[1] = rightOff + topOff;
+                v[2] = leftOff + bottomOff;
+                v[3] = rightOff + bottomOff;
+            }
+
+            float* writeQuad(float* dst, const Vector3& pos, RGBA colour, const float* uv) const
+            {
+                for (int i = 0; i < 4; ++i)
+                {
+                    *dst++ = v[i].x + pos.x;
+                    *dst++ = v[i].y + pos.y;
+                    *dst++ = v[i].z + pos.z;
+                    memcpy(dst++, &colour, sizeof(RGBA));
+                    *dst++ = uv[i * 2];
+                    *dst++ = uv[i * 2 + 1];
+                }
+                return dst;
+            }
+#endif
+        };
+
+        // The axes generators below match BillboardSet::genBillboardAxes for the respective type
+
+        /// Axes shared by all billboards, as computed in beginBillboards
+        struct CommonAxes
+        {
+            enum { PER_BILLBOARD = false };
+            Vector3 x, y;
+            void operator()(const Billboard&, Vector3& outX, Vector3& outY) const
+            {
+                outX = x;
+                outY = y;
+            }
+        };
+
+        /// BBT_POINT with accurate facing
+        struct AccuratePointAxes
+        {
+            enum { PER_BILLBOARD = true };
+            Vector3 camPos, camUp;
+            void operator()(const Billboard& bb, Vector3& x, Vector3& y) const
+            {
+                Vector3 camDir = bb.mPosition - camPos;
+                camDir.normalise();
+                x = camDir.crossProduct(camUp);
+                x.normalise();
+                y = x.crossProduct(camDir);
+            }
+        };
+
+        /// BBT_ORIENTED_COMMON with accurate facing
+        struct AccurateOrientedCommonAxes
+        {
+            enum { PER_BILLBOARD = true };
+            Vector3 camPos, commonDir;
+            void operator()(const Billboard& bb, Vector3& x, Vector3& y) const
+            {
+                Vector3 camDir = bb.mPosition - camPos;
+                camDir.normalise();
+                y = commonDir;
+                x = camDir.crossProduct(y);
+                x.normalise();
+            }
+        };
+
+        /// BBT_ORIENTED_SELF
+        template <bool accurateFacing> struct OrientedSelfAxes
+        {
+            enum { PER_BILLBOARD = true };
+            Vector3 camPos, camDir;
+            void operator()(const Billboard& bb, Vector3& x, Vector3& y) const
+            {
+                Vector3 dir = camDir;
+                if (accurateFacing)
+                {
+                    dir = bb.mPosition - camPos;
+                    dir.normalise();
+                }
+                y = bb.mDirection;
+                x = dir.crossProduct(y);
+                x.normalise();
+            }
+        };
+
+        /// BBT_PERPENDICULAR_SELF
+        struct PerpendicularSelfAxes
+        {
+            enum { PER_BILLBOARD = true };
+            Vector3 commonUp;
+            void operator()(const Billboard& bb, Vector3& x, Vector3& y) const
+            {
+                x = commonUp.crossProduct(bb.mDirection);
+                x.normalise();
+                y = bb.mDirection.crossProduct(x);
+            }
+        };
+
+        struct BillboardArray
+        {
+            const Billboard* data;
+            size_t count;
+            const Billboard& operator[](size_t i) const { return data[i]; }
+            size_t size() const { return count; }
+        };
+
+        struct BillboardPointerArray
+        {
+            Billboard* const* data;
+            size_t count;
+            const Billboard& operator[](size_t i) const { return *data[i]; }
+            size_t size() const { return count; }
+        };
+    }
+    //-----------------------------------------------------------------------
+    void BillboardSet::injectBillboards(const Billboard* billboards, size_t count)
+    {
+        injectBillboardsImpl(BillboardArray{billboards, count});
+    }
+    //-----------------------------------------------------------------------
+    template <typename Range> void BillboardSet::injectBillboardsImpl(const Range& billboards)
+    {
+        if (mPointRendering)
+        {
+            for (size_t i = 0; i < billboards.size(); ++i)
+                injectBillboard(billboards[i]);
+            return;
+        }
+
+        switch (mBillboardType)
+        {
+        case BBT_ORIENTED_SELF:
+            if (mAccurateFacing)
+                genQuadVerticesBatch(OrientedSelfAxes<true>{mCamPos, mCamDir}, billboards);
+            else
+                genQuadVerticesBatch(OrientedSelfAxes<false>{mCamPos, mCamDir}, billboards);
+            break;
+        case BBT_PERPENDICULAR_SELF:
+            genQuadVerticesBatch(PerpendicularSelfAxes{mCommonUpVector}, billboards);
+            break;
+        case BBT_POINT:
+            if (mAccurateFacing)
+            {
+                genQuadVerticesBatch(AccuratePointAxes{mCamPos, mCamQ * Vector3::UNIT_Y}, billboards);
+                break;
+            }
+            genQuadVerticesBatch(CommonAxes{mCamX, mCamY}, billboards);
+            break;
+        case BBT_ORIENTED_COMMON:
+            if (mAccurateFacing)
+            {
+                genQuadVerticesBatch(AccurateOrientedCommonAxes{mCamPos, mCommonDirection}, billboards);
+                break;
+            }
+            genQuadVerticesBatch(CommonAxes{mCamX, mCamY}, billboards);
+            break;
+        case BBT_PERPENDICULAR_COMMON:
+            genQuadVerticesBatch(CommonAxes{mCamX, mCamY}, billboards);
+            break;
+        }
+    }
+    //-----------------------------------------------------------------------
+    template <typename Axes, typename Range>
+    void BillboardSet::genQuadVerticesBatch(const Axes& axes, const Range& billboards)
+    {
+        Matrix4 xworld;
+        if (mCullIndividual)
+            getWorldTransforms(&xworld);
+
+        CornerOffsets defaultOffsets;
+        if (!Axes::PER_BILLBOARD)
+            defaultOffsets.set(mVOffset);
+
+        CornerOffsets offsets;
+        Vector3 x, y;
+        float* dst = mLockPtr;
+
+        for (size_t i = 0; i < billboards.size() && mNumVisibleBillboards < mPoolSize; ++i)
+        {
+            const Billboard& bb = billboards[i];
+            Real width = bb.mOwnDimensions ? bb.mWidth : mDefaultWidth;
+            Real height = bb.mOwnDimensions ? bb.mHeight : mDefaultHeight;
+
+            // same as billboardVisible, without fetching the world transform each time
+            if (mCullIndividual &&
+                !mCurrentCamera->isVisible(Sphere(xworld * bb.mPosition, std::max(width, height))))
+                continue;
+
+            mNumVisibleBillboards++;
+
+            if (bb.mRotation != Radian(0))
+            {
+                // rare enough to not bother with a dedicated kernel
+                Vector3 vOffset[4];
+                axes(bb, x, y);
+                genVertOffsets(mLeftOff, mRightOff, mTopOff, mBottomOff, width, height, x, y, vOffset);
+                mLockPtr = dst;
+                genQuadVertices(vOffset, bb);
+                dst = mLockPtr;
+                continue;
+            }
+
+            assert(bb.mUseTexcoordRect || bb.mTexcoordIndex < mTextureCoords.size());
+            const FloatRect& r = bb.mUseTexcoordRect ? bb.mTexcoordRect : mTextureCoords[bb.mTexcoordIndex];
+            const float uv[8] = {r.left, r.top, r.right, r.top, r.left, r.bottom, r.right, r.bottom};
+
+            if (!Axes::PER_BILLBOARD && !bb.mOwnDimensions)
+            {
+                dst = defaultOffsets.writeQuad(dst, bb.mPosition, bb.mColour, uv);
+                continue;
+            }
+
+            axes(bb, x, y);
+            offsets.set(mLeftOff, mRightOff, mTopOff, mBottomOff, width, height, x, y);
+            dst = offsets.writeQuad(dst, bb.mPosition, bb.mColour, uv);
+        }
+
+        mLockPtr = dst;
+    }
+    //-----------------------------------------------------------------------
     void BillboardSet::endBillboards(void)
     {
         mMainBuf->unlock();
@@ -446,11 +733,7 @@ namespace Ogre {
             }
 
             beginBillboards(mActiveBillboards);
-            auto iend = mBillboardPool.begin() + mActiveBillboards;
-            for (auto it = mBillboardPool.begin(); it != iend; ++it)
-            {
-                injectBillboard(*(*it));
-            }
+            injectBillboardsImpl(BillboardPointerArray{mBillboardPool.data(), mActiveBillboards});
             endBillboards();
             mBillboardDataChanged = false;
         }
@@ -0,0 +1,952 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "OgreStableHeaders.h"
+#include "OgreBlockCompressor.h"
+#include "OgreWorkQueue.h"
+#include "OgrePlatformInformation.h"
+#include "OgreSIMDHelper.h"
+
+#include <limits>
+
+namespace Ogre {
+namespace {
+    typedef Image::CompressionQuality Quality;
+
+    /// a 4x4 block of pixels in row major order, stored channel by channel in 0..255
+    struct Block
+    {
+        alignas(16) float c[4][16];
+    };
+
+    /// number of least squares endpoint refinements per quality level
+    int getRefinements(Quality q)
+    {
+        return q == Image::COMPRESS_FAST ? 0 : (q == Image::COMPRESS_NORMAL ? 1 : 4);
+    }
+
+    /** find the closest palette entry for each pixel
+        @return the weighted squared error of the block */
+    float fitIndices(const Block& blk, const float (*palette)[4], int numEntries, const float* weights,
+                     uint8* indices)
+    {
+        float error = 0;
+#if __OGRE_HAVE_SSE || __OGRE_HAVE_NEON
+        for (int i = 0; i < 16; i += 4)
+        {
+            __m128 best = _mm_set1_ps(std::numeric_limits<float>::max());
+            __m128 bestIdx = _mm_setzero_ps();
+            for (int p = 0; p < numEntries; p++)
+            {
+                __m128 dist = _mm_setzero_ps();
+                for (int c = 0; c < 4; c++)
+                {
+                    if (weights[c] == 0)
+                        continue;
+                    __m128 d = _mm_sub_ps(_mm_load_ps(blk.c[c] + i), _mm_set1_ps(palette[p][c]));
+                    dist = _mm_add_ps(dist, _mm_mul_ps(_mm_mul_ps(d, d), _mm_set1_ps(weights[c])));
+                }
+                __m128 closer = _mm_cmplt_ps(dist, best);
+                best = _mm_min_ps(dist, best);
+                bestIdx = _mm_or_ps(_mm_and_ps(closer, _mm_set1_ps(float(p))), _mm_andnot_ps(closer, bestIdx));
+            }
+
+            alignas(16) float idx[4], err[4];
+            _mm_store_ps(idx, bestIdx);
+            _mm_store_ps(err, best);
+            for (int k = 0; k < 4; k++)
+            {
+                indices[i + k] = uint8(idx[k]);
+                error += err[k];
+            }
+        }
+#else
+        for (int i = 0; i < 16; i++)
+        {
+            float best = std::numeric_limits<float>::max();
+            for (int p = 0; p < numEntries; p++)
+            {
+                float dist = 0;
+                for (int c = 0; c < 4; c++)
+                {
+                    float d = blk.c[c][i] - palette[p][c];
+                    dist += d * d * weights[c];
+                }
+                if (dist < best)
+                {
+                    best = dist;
+                    indices[i] = uint8(p);
+                }
+            }
+            error += best;
+        }
+#endif
+        return error;
+    }
+
+    /// end points of the line through the pixels in mask, along their principal axis
+    void fitLine(const Block& blk, int numChannels, uint16 mask, float* e0, float* e1)
+    {
+        float mean[4] = {0, 0, 0, 0};
+        int count = 0;
+        for (int i = 0; i < 16; i++)
+        {
+            if (!(mask & (1 << i)))
+                continue;
+            for (int c = 0; c < numChannels; c++)
+                mean[c] += blk.c[c][i];
+            count++;
+        }
+        for (int c = 0; c < numChannels; c++)
+            mean[c] /= std::max(count, 1);
+
+        float cov[4][4] = {};
+        for (int i = 0; i < 16; i++)
+        {
+            if (!(mask & (1 << i)))
+                continue;
+            for (int a = 0; a < numChannels; a++)
+                for (int b = a; b < numChannels; b++)
+                    cov[a][b] += (blk.c[a][i] - mean[a]) * (blk.c[b][i] - mean[b]);
+        }
+        for (int a = 0; a < numChannels; a++)
+            for (int b = 0; b < a; b++)
+                cov[a][b] = cov[b][a];
+
+        // power iteration, starting at the channel with the largest variance
+        float axis[4] = {0, 0, 0, 0};
+        int maxChannel = 0;
+        for (int c = 1; c < numChannels; c++)
+            if (cov[c][c] > cov[maxChannel][maxChannel])
+                maxChannel = c;
+        axis[maxChannel] = 1;
+        for (int iter = 0; iter < 8; iter++)
+        {
+            float next[4] = {0, 0, 0, 0};
+            float len = 0;
+            for (int a = 0; a < numChannels; a++)
+            {
+                for (int b = 0; b < numChannels; b++)
+                    next[a] += cov[a][b] * axis[b];
+                len = std::max(len, std::abs(next[a]));
+            }
+            if (len == 0)
+                break;
+            for (int c = 0; c < numChannels; c++)
+                axis[c] = next[c] / len;
+        }
+
+        float len = 0;
+        for (int c = 0; c < numChannels; c++)
+            len += axis[c] * axis[c];
+        len = std::sqrt(len);
+        for (int c = 0; c < numChannels; c++)
+            axis[c] /= len;
+
+        // extent of the pixels along the axis
+        float tmin = 0, tmax = 0;
+        for (int i = 0; i < 16; i++)
+        {
+            if (!(mask & (1 << i)))
+                continue;
+            float t = 0;
+            for (int c = 0; c < numChannels; c++)
+                t += (blk.c[c][i] - mean[c]) * axis[c];
+            tmin = std::min(tmin, t);
+            tmax = std::max(tmax, t);
+        }
+
+        for (int c = 0; c < numChannels; c++)
+        {
+            e0[c] = Math::Clamp(mean[c] + axis[c] * tmin, 0.0f, 255.0f);
+            e1[c] = Math::Clamp(mean[c] + axis[c] * tmax, 0.0f, 255.0f);
+        }
+    }
+
+    /// move the end points towards each other, as the extreme pixels are rarely hit exactly
+    void insetLine(int numChannels, float* e0, float* e1)
+    {
+        for (int c = 0; c < numChannels; c++)
+        {
+            float inset = (e1[c] - e0[c]) / 16;
+            e0[c] += inset;
+            e1[c] -= inset;
+        }
+    }
+
+    /** least squares end points for the chosen indices
+        @param levels the position of each palette entry between e0 and e1
+        @return false if the indices do not define a line */
+    bool refineLine(const Block& blk, int numChannels, uint16 mask, const uint8* indices, const float* levels,
+                    float* e0, float* e1)
+    {
+        float aa = 0, ab = 0, bb = 0;
+        float x0[4] = {0, 0, 0, 0}, x1[4] = {0, 0, 0, 0};
+        for (int i = 0; i < 16; i++)
+        {
+            if (!(mask & (1 << i)))
+                continue;
+            float w = levels[indices[i]];
+            aa += (1 - w) * (1 - w);
+            ab += (1 - w) * w;
+            bb += w * w;
+            for (int c = 0; c < numChannels; c++)
+            {
+                x0[c] += (1 - w) * blk.c[c][i];
+                x1[c] += w * blk.c[c][i];
+            }
+        }
+
+        float det = aa * bb - ab * ab;
+        if (std::abs(det) < 1e-6f)
+            return false;
+
+        for (int c = 0; c < numChannels; c++)
+        {
+            e0[c] = Math::Clamp((bb * x0[c] - ab * x1[c]) / det, 0.0f, 255.0f);
+            e1[c] = Math::Clamp((aa * x1[c] - ab * x0[c]) / det, 0.0f, 255.0f);
+        }
+        return true;
+    }
+
+    //-----------------------------------------------------------------------
+    // BC1 colour blocks, also used by DXT3 and DXT5
+    uint16 packRGB565(const float* c)
+    {
+        return uint16((int(c[0] * 31 / 255 + 0.5f) << 11) | (int(c[1] * 63 / 255 + 0.5f) << 5) |
+                      int(c[2] * 31 / 255 + 0.5f));
+    }
+
+    void unpackRGB565(uint16 v, float* c)
+    {
+        int r = (v >> 11) & 31, g = (v >> 5) & 63, b = v & 31;
+        c[0] = float((r << 3) | (r >> 2));
+        c[1] = float((g << 2) | (g >> 4));
+        c[2] = float((b << 3) | (b >> 2));
+        c[3] = 0;
+    }
+
+    void writeColourBlock(uint16 c0, uint16 c1, const uint8* indices, uint8* out)
+    {
+        out[0] = uint8(c0 & 0xFF);
+        out[1] = uint8(c0 >> 8);
+        out[2] = uint8(c1 & 0xFF);
+        out[3] = uint8(c1 >> 8);
+        for (int y = 0; y < 4; y++)
+            out[4 + y] = uint8(indices[y * 4] | (indices[y * 4 + 1] << 2) | (indices[y * 4 + 2] << 4) |
+                               (indices[y * 4 + 3] << 6));
+    }
+
+    /** @param punchThrough encode pixels with alpha < 128 as transparent black, only valid for DXT1 */
+    void encodeColourBlock(const Block& blk, bool punchThrough, Quality quality, uint8* out)
+    {
+        const float weights[4] = {1, 1, 1, 0};
+
+        uint16 opaque = 0xFFFF;
+        if (punchThrough)
+        {
+            for (int i = 0; i < 16; i++)
+                if (blk.c[3][i] < 128)
+                    opaque &= ~(1 << i);
+        }
+
+        float palette[4][4];
+        uint8 indices[16];
+        float e0[3], e1[3];
+
+        if (opaque != 0xFFFF)
+        {
+            // three colour mode, the fourth entry is transparent black
+            fitLine(blk, 3, opaque, e0, e1);
+            uint16 c0 = packRGB565(e0), c1 = packRGB565(e1);
+            if (c0 > c1)
+                std::swap(c0, c1);
+            unpackRGB565(c0, palette[0]);
+            unpackRGB565(c1, palette[1]);
+            for (int c = 0; c < 3; c++)
+                palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+            fitIndices(blk, palette, 3, weights, indices);
+            for (int i = 0; i < 16; i++)
+                if (!(opaque & (1 << i)))
+                    indices[i] = 3;
+            writeColourBlock(c0, c1, indices, out);
+            return;
+        }
+
+        // four colour mode, position of each palette entry between c0 and c1
+        const float levels[4] = {0, 1, 1.0f / 3, 2.0f / 3};
+
+        fitLine(blk, 3, 0xFFFF, e0, e1);
+        if (quality != Image::COMPRESS_FAST)
+            insetLine(3, e0, e1);
+
+        uint16 bestC0 = 0, bestC1 = 0;
+        uint8 bestIndices[16];
+        float bestError = std::numeric_limits<float>::max();
+        for (int iter = 0; iter <= getRefinements(quality); iter++)
+        {
+            uint16 c0 = packRGB565(e0), c1 = packRGB565(e1);
+            unpackRGB565(c0, palette[0]);
+            unpackRGB565(c1, palette[1]);
+            for (int c = 0; c < 3; c++)
+            {
+                palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+                palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+            }
+            float error = fitIndices(blk, palette, 4, weights, indices);
+            if (error < bestError)
+            {
+                bestError = error;
+                bestC0 = c0;
+                bestC1 = c1;
+                memcpy(bestIndices, indices, 16);
+            }
+            if (error == 0 || !refineLine(blk, 3, 0xFFFF, indices, levels, e0, e1))
+                break;
+        }
+
+        // four colour mode requires c0 > c1
+        if (bestC0 < bestC1)
+        {
+            std::swap(bestC0, bestC1);
+            for (uint8& idx : bestIndices)
+                idx ^= 1;
+        }
+        else if (bestC0 == bestC1)
+        {
+            // all entries are the same, avoid the transparent one of the three colour mode
+            memset(bestIndices, 0, 16);
+        }
+        writeColourBlock(bestC0, bestC1, bestIndices, out);
+    }
+
+    //-----------------------------------------------------------------------
+    // BC4 single channel blocks, also used by DXT5 and BC5
+    void buildAlphaPalette(int a0, int a1, float (*palette)[4])
+    {
+        palette[0][0] = float(a0);
+        palette[1][0] = float(a1);
+        if (a0 > a1)
+        {
+            for (int k = 2; k < 8; k++)
+                palette[k][0] = float(((8 - k) * a0 + (k - 1) * a1) / 7);
+        }
+        else
+        {
+            for (int k = 2; k < 6; k++)
+                palette[k][0] = float(((6 - k) * a0 + (k - 1) * a1) / 5);
+            palette[6][0] = 0;
+            palette[7][0] = 255;
+        }
+    }
+
+    void encodeAlphaBlock(const float* values, Quality quality, uint8* out)
+    {
+        const float weights[4] = {1, 0, 0, 0};
+        // position of each palette entry between a0 and a1 in the eight value mode
+        const float levels[8] = {0, 1, 1.0f / 7, 2.0f / 7, 3.0f / 7, 4.0f / 7, 5.0f / 7, 6.0f / 7};
+
+        Block blk;
+        memcpy(blk.c[0], values, sizeof(blk.c[0]));
+
+        float vmin = 255, vmax = 0, innerMin = 255, innerMax = 0;
+        for (int i = 0; i < 16; i++)
+        {
+            vmin = std::min(vmin, values[i]);
+            vmax = std::max(vmax, values[i]);
+            if (values[i] > 0 && values[i] < 255)
+            {
+                innerMin = std::min(innerMin, values[i]);
+                innerMax = std::max(innerMax, values[i]);
+            }
+        }
+
+        float palette[8][4] = {};
+        uint8 indices[16];
+        int bestA0 = int(vmax + 0.5f), bestA1 = int(vmin + 0.5f);
+        uint8 bestIndices[16] = {};
+
+        if (bestA0 != bestA1)
+        {
+            float e0 = float(bestA0), e1 = float(bestA1);
+            float bestError = std::numeric_limits<float>::max();
+            for (int iter = 0; iter <= getRefinements(quality); iter++)
+            {
+                int a0 = int(e0 + 0.5f), a1 = int(e1 + 0.5f);
+                if (a0 <= a1)
+                    break;
+                buildAlphaPalette(a0, a1, palette);
+                float error = fitIndices(blk, palette, 8, weights, indices);
+                if (error < bestError)
+                {
+                    bestError = error;
+                    bestA0 = a0;
+                    bestA1 = a1;
+                    memcpy(bestIndices, indices, 16);
+                }
+                if (error == 0 || !refineLine(blk, 1, 0xFFFF, indices, levels, &e0, &e1))
+                    break;
+            }
+
+            // six value mode, in case the block contains the extremes
+            if (quality == Image::COMPRESS_BEST && (vmin == 0 || vmax == 255))
+            {
+                int a0 = innerMin <= innerMax ? int(innerMin + 0.5f) : 0;
+                int a1 = innerMin <= innerMax ? int(innerMax + 0.5f) : 0;
+                buildAlphaPalette(a0, a1, palette);
+                float error = fitIndices(blk, palette, 8, weights, indices);
+                if (error < bestError)
+                {
+                    bestA0 = a0;
+                    bestA1 = a1;
+                    memcpy(bestIndices, indices, 16);
+                }
+            }
+        }
+
+        out[0] = uint8(bestA0);
+        out[1] = uint8(bestA1);
+        uint64 bits = 0;
+        for (int i = 0; i < 16; i++)
+            bits |= uint64(bestIndices[i]) << (3 * i);
+        for (int i = 0; i < 6; i++)
+            out[2 + i] = uint8(bits >> (8 * i));
+    }
+
+    void encodeChannelBlock(const Block& blk, int channel, Quality quality, uint8* out)
+    {
+        encodeAlphaBlock(blk.c[channel], quality, out);
+    }
+
+    void encodeExplicitAlphaBlock(const Block& blk, uint8* out)
+    {
+        for (int i = 0; i < 16; i += 2)
+            out[i / 2] = uint8(int(blk.c[3][i] * 15 / 255 + 0.5f) | (int(blk.c[3][i + 1] * 15 / 255 + 0.5f) << 4));
+    }
+
+    //-----------------------------------------------------------------------
+    // BC7, mode 6: one RGBA subset with 7 bit end points, a p-bit per end point and 4 bit indices
+    const int BC7_WEIGHTS[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+    struct BitWriter
+    {
+        uint8* data;
+        int pos;
+        void write(uint32 value, int bits)
+        {
+            for (int i = 0; i < bits; i++, pos++)
+                if (value & (1 << i))
+                    data[pos / 8] |= uint8(1 << (pos % 8));
+        }
+    };
+
+    /// quantise an end point with the given p-bit, returning the squared error
+    float quantiseBC7(const float* e, int pbit, int* q)
+    {
+        float error = 0;
+        for (int c = 0; c < 4; c++)
+        {
+            q[c] = Math::Clamp(int((e[c] - pbit) / 2 + 0.5f), 0, 127);
+            float d = float((q[c] << 1) | pbit) - e[c];
+            error += d * d;
+        }
+        return error;
+    }
+
+    void encodeBC7Block(const Block& blk, Quality quality, uint8* out)
+    {
+        const float weights[4] = {1, 1, 1, 1};
+        float levels[16];
+        for (int i = 0; i < 16; i++)
+            levels[i] = BC7_WEIGHTS[i] / 64.0f;
+
+        // no inset here, with 16 levels the extreme pixels are close to the end points anyway
+        float e[2][4];
+        fitLine(blk, 4, 0xFFFF, e[0], e[1]);
+
+        float palette[16][4];
+        uint8 indices[16], bestIndices[16];
+        int bestQ[2][4] = {}, bestP[2] = {};
+        float bestError = std::numeric_limits<float>::max();
+
+        for (int iter = 0; iter <= getRefinements(quality); iter++)
+        {
+            int q[2][4], p[2];
+            float error = std::numeric_limits<float>::max();
+            // the best quality tries all p-bit combinations, otherwise the closest one is used
+            for (int pbits = 0; pbits < 4; pbits++)
+            {
+                int tq[2][4], tp[2] = {pbits & 1, pbits >> 1};
+                if (quality != Image::COMPRESS_BEST)
+                {
+                    for (int k = 0; k < 2; k++)
+                    {
+                        int q0[4], q1[4];
+                        tp[k] = quantiseBC7(e[k], 0, q0) <= quantiseBC7(e[k], 1, q1) ? 0 : 1;
+                    }
+                }
+                quantiseBC7(e[0], tp[0], tq[0]);
+                quantiseBC7(e[1], tp[1], tq[1]);
+
+                for (int i = 0; i < 16; i++)
+                {
+                    for (int c = 0; c < 4; c++)
+                    {
+                        int d0 = (tq[0][c] << 1) | tp[0], d1 = (tq[1][c] << 1) | tp[1];
+                        palette[i][c] = float(((64 - BC7_WEIGHTS[i]) * d0 + BC7_WEIGHTS[i] * d1 + 32) >> 6);
+                    }
+                }
+                uint8 tindices[16];
+                float terror = fitIndices(blk, palette, 16, weights, tindices);
+                if (terror < error)
+                {
+                    error = terror;
+                    memcpy(q, tq, sizeof(q));
+                    memcpy(p, tp, sizeof(p));
+                    memcpy(indices, tindices, 16);
+                }
+                if (quality != Image::COMPRESS_BEST)
+                    break;
+            }
+
+            if (error < bestError)
+            {
+                bestError = error;
+                memcpy(bestQ, q, sizeof(q));
+                memcpy(bestP, p, sizeof(p));
+                memcpy(bestIndices, indices, 16);
+            }
+            if (error == 0 || !refineLine(blk, 4, 0xFFFF, indices, levels, e[0], e[1]))
+                break;
+        }
+
+        // the most significant bit of the first index is implicitly 0
+        if (bestIndices[0] & 8)
+        {
+            std::swap(bestQ[0], bestQ[1]);
+            std::swap(bestP[0], bestP[1]);
+            for (uint8& idx : bestIndices)
+                idx = 15 - idx;
+        }
+
+        memset(out, 0, 16);
+        BitWriter bw = {out, 0};
+        bw.write(1 << 6, 7);
+        for (int c = 0; c < 4; c++)
+        {
+            bw.write(bestQ[0][c], 7);
+            bw.write(bestQ[1][c], 7);
+        }
+        bw.write(bestP[0], 1);
+        bw.write(bestP[1], 1);
+        bw.write(bestIndices[0], 3);
+        for (int i = 1; i < 16; i++)
+            bw.write(bestIndices[i], 4);
+    }
+
+    //-----------------------------------------------------------------------
+    // ETC1 compatible blocks, in individual or differential mode
+    const int ETC_MODIFIERS[8][4] = {{2, 8, -2, -8},       {5, 17, -5, -17},     {9, 29, -9, -29},
+                                     {13, 42, -13, -42},   {18, 60, -18, -60},   {24, 80, -24, -80},
+                                     {33, 106, -33, -106}, {47, 183, -47, -183}};
+
+    /// pixel indices of the two sub blocks, left/right if not flipped, top/bottom otherwise
+    void getETCSubBlock(bool flip, int sub, int* pixels)
+    {
+        int n = 0;
+        for (int y = 0; y < 4; y++)
+            for (int x = 0; x < 4; x++)
+                if ((flip ? y / 2 : x / 2) == sub)
+                    pixels[n++] = y * 4 + x;
+    }
+
+    /// best modifier table and pixel modifiers for a sub block with the given base colour
+    int fitETCSubBlock(const Block& blk, const int* pixels, const int* base, int* table, uint8* mods)
+    {
+        int bestError = std::numeric_limits<int>::max();
+        for (int t = 0; t < 8; t++)
+        {
+            int error = 0;
+            uint8 tmods[8];
+            for (int i = 0; i < 8; i++)
+            {
+                int best = std::numeric_limits<int>::max();
+                for (int m = 0; m < 4; m++)
+                {
+                    int dist = 0;
+                    for (int c = 0; c < 3; c++)
+                    {
+                        int d = Math::Clamp(base[c] + ETC_MODIFIERS[t][m], 0, 255) - int(blk.c[c][pixels[i]]);
+                        dist += d * d;
+                    }
+                    if (dist < best)
+                    {
+                        best = dist;
+                        tmods[i] = uint8(m);
+                    }
+                }
+                error += best;
+            }
+            if (error < bestError)
+            {
+                bestError = error;
+                *table = t;
+                memcpy(mods, tmods, 8);
+            }
+        }
+        return bestError;
+    }
+
+    struct ETCBlock
+    {
+        bool flip, differential;
+        int q[2][3]; // quantised base colours
+        int table[2];
+        uint8 mods[2][8];
+        int error;
+    };
+
+    int expandETC(int q, bool differential)
+    {
+        return differential ? (q << 3) | (q >> 2) : q * 17;
+    }
+
+    /// evaluate the quantised base colours, with an optional brightness search
+    void fitETCBlock(const Block& blk, const int (*pixels)[8], ETCBlock& blk2, Quality quality)
+    {
+        int maxQ = blk2.differential ? 31 : 15;
+        int range = quality == Image::COMPRESS_BEST ? 1 : 0;
+        blk2.error = 0;
+        int centre[2][3];
+        memcpy(centre, blk2.q, sizeof(centre));
+        for (int sub = 0; sub < 2; sub++)
+        {
+            // the first differential colour stays put, so the second one stays in reach
+            int r = blk2.differential && sub == 0 ? 0 : range;
+            int bestError = std::numeric_limits<int>::max();
+            for (int d = -r; d <= r; d++)
+            {
+                int q[3], base[3];
+                for (int c = 0; c < 3; c++)
+                {
+                    q[c] = Math::Clamp(centre[sub][c] + d, 0, maxQ);
+                    base[c] = expandETC(q[c], blk2.differential);
+                }
+                if (blk2.differential && sub == 1)
+                {
+                    bool valid = true;
+                    for (int c = 0; c < 3; c++)
+                        valid &= q[c] - blk2.q[0][c] >= -4 && q[c] - blk2.q[0][c] <= 3;
+                    if (!valid)
+                        continue;
+                }
+                int table;
+                uint8 mods[8];
+                int error = fitETCSubBlock(blk, pixels[sub], base, &table, mods);
+                if (error < bestError)
+                {
+                    bestError = error;
+                    memcpy(blk2.q[sub], q, sizeof(q));
+                    blk2.table[sub] = table;
+                    memcpy(blk2.mods[sub], mods, 8);
+                }
+            }
+            blk2.error += bestError;
+        }
+    }
+
+    void encodeETCBlock(const Block& blk, Quality quality, uint8* out)
+    {
+        ETCBlock best;
+        best.error = std::numeric_limits<int>::max();
+
+        for (int flip = 0; flip < 2; flip++)
+        {
+            int pixels[2][8];
+            float avg[2][3] = {};
+            for (int sub = 0; sub < 2; sub++)
+            {
+                getETCSubBlock(flip != 0, sub, pixels[sub]);
+                for (int i = 0; i < 8; i++)
+                    for (int c = 0; c < 3; c++)
+                        avg[sub][c] += blk.c[c][pixels[sub][i]] / 8;
+            }
+
+            ETCBlock cand;
+            cand.flip = flip != 0;
+
+            // differential mode, if the base colours are close enough
+            cand.differential = true;
+            bool valid = true;
+            for (int sub = 0; sub < 2; sub++)
+                for (int c = 0; c < 3; c++)
+                    cand.q[sub][c] = int(avg[sub][c] * 31 / 255 + 0.5f);
+            for (int c = 0; c < 3; c++)
+                valid &= cand.q[1][c] - cand.q[0][c] >= -4 && cand.q[1][c] - cand.q[0][c] <= 3;
+            if (valid)
+            {
+                fitETCBlock(blk, pixels, cand, quality);
+                if (cand.error < best.error)
+                    best = cand;
+            }
+
+            if (!valid || quality != Image::COMPRESS_FAST)
+            {
+                cand.differential = false;
+                for (int sub = 0; sub < 2; sub++)
+                    for (int c = 0; c < 3; c++)
+                        cand.q[sub][c] = int(avg[sub][c] * 15 / 255 + 0.5f);
+                fitETCBlock(blk, pixels, cand, quality);
+                if (cand.error < best.error)
+                    best = cand;
+            }
+        }
+
+        uint32 high = 0;
+        if (best.differential)
+        {
+            for (int c = 0; c < 3; c++)
+                high |= uint32((best.q[0][c] << 3) | ((best.q[1][c] - best.q[0][c]) & 7)) << (24 - 8 * c);
+        }
+        else
+        {
+            for (int c = 0; c < 3; c++)
+                high |= uint32((best.q[0][c] << 4) | best.q[1][c]) << (24 - 8 * c);
+        }
+        high |= uint32(best.table[0]) << 5 | uint32(best.table[1]) << 2;
+        high |= uint32(best.differential) << 1 | uint32(best.flip);
+
+        // pixels are stored column by column, the modifier index is msb * 2 + lsb
+        uint32 low = 0;
+        for (int sub = 0; sub < 2; sub++)
+        {
+            int pixels[8];
+            getETCSubBlock(best.flip, sub, pixels);
+            for (int i = 0; i < 8; i++)
+            {
+                int x = pixels[i] % 4, y = pixels[i] / 4;
+                int bit = x * 4 + y;
+                low |= uint32(best.mods[sub][i] >> 1) << (16 + bit);
+                low |= uint32(best.mods[sub][i] & 1) << bit;
+            }
+        }
+
+        for (int i = 0; i < 4; i++)
+        {
+            out[i] = uint8(high >> (24 - 8 * i));
+            out[4 + i] = uint8(low >> (24 - 8 * i));
+        }
+    }
+
+    //-----------------------------------------------------------------------
+    // EAC alpha blocks of ETC2_RGBA8
+    const int EAC_MODIFIERS[16][8] = {
+        {-3, -6, -9, -15, 2, 5, 8, 14}, {-3, -7, -10, -13, 2, 6, 9, 12}, {-2, -5, -8, -13, 1, 4, 7, 12},
+        {-2, -4, -6, -13, 1, 3, 5, 12}, {-3, -6, -8, -12, 2, 5, 7, 11},  {-3, -7, -9, -11, 2, 6, 8, 10},
+        {-4, -7, -8, -11, 3, 6, 7, 10}, {-3, -5, -8, -11, 2, 4, 7, 10},  {-2, -6, -8, -10, 1, 5, 7, 9},
+        {-2, -5, -8, -10, 1, 4, 7, 9},  {-2, -4, -8, -10, 1, 3, 7, 9},   {-2, -5, -7, -10, 1, 4, 6, 9},
+        {-3, -4, -7, -10, 2, 3, 6, 9},  {-1, -2, -3, -10, 0, 1, 2, 9},   {-4, -6, -8, -9, 3, 5, 7, 8},
+        {-3, -5, -7, -9, 2, 4, 6, 8}};
+
+    void encodeEACBlock(const Block& blk, Quality quality, uint8* out)
+    {
+        int vmin = 255, vmax = 0;
+        for (int i = 0; i < 16; i++)
+        {
+            vmin = std::min(vmin, int(blk.c[3][i]));
+            vmax = std::max(vmax, int(blk.c[3][i]));
+        }
+
+        int range = quality == Image::COMPRESS_FAST ? 0 : 1;
+        int bestError = std::numeric_limits<int>::max();
+        int bestBase = 0, bestMul = 1, bestTable = 0;
+        uint8 bestIndices[16] = {};
+
+        for (int t = 0; t < 16; t++)
+        {
+            const int* mods = EAC_MODIFIERS[t];
+            int spread = mods[7] - mods[3];
+            int mul = Math::Clamp(int(float(vmax - vmin) / spread + 0.5f), 1, 15);
+            for (int m = std::max(1, mul - range); m <= std::min(15, mul + range); m++)
+            {
+                int base = Math::Clamp(int((vmin + vmax - (mods[7] + mods[3]) * m) / 2.0f + 0.5f), 0, 255);
+                for (int b = std::max(0, base - range); b <= std::min(255, base + range); b++)
+                {
+                    int error = 0;
+                    uint8 indices[16];
+                    for (int i = 0; i < 16 && error < bestError; i++)
+                    {
+                        int best = std::numeric_limits<int>::max();
+                        for (int k = 0; k < 8; k++)
+                        {
+                            int d = Math::Clamp(b + mods[k] * m, 0, 255) - int(blk.c[3][i]);
+                            if (d * d < best)
+                            {
+                                best = d * d;
+                                indices[i] = uint8(k);
+                            }
+                        }
+                        error += best;
+                    }
+                    if (error < bestError)
+                    {
+                        bestError = error;
+                        bestBase = b;
+                        bestMul = m;
+                        bestTable = t;
+                        memcpy(bestIndices, indices, 16);
+                    }
+                }
+            }
+        }
+
+        uint64 bits = uint64(bestBase) << 56 | uint64(bestMul) << 52 | uint64(bestTable) << 48;
+        for (int i = 0; i < 16; i++)
+        {
+            // column by column
+            int x = i / 4, y = i % 4;
+            bits |= uint64(bestIndices[y * 4 + x]) << (45 - 3 * i);
+        }
+        for (int i = 0; i < 8; i++)
+            out[i] = uint8(bits >> (56 - 8 * i));
+    }
+
+    size_t getBlockSize(PixelFormat format)
+    {
+        return PixelUtil::getMemorySize(4, 4, 1, format);
+    }
+}
+    //-----------------------------------------------------------------------
+    bool BlockCompressor::isSupported(PixelFormat format)
+    {
+        switch (format)
+        {
+        case PF_DXT1:
+        case PF_DXT3:
+        case PF_DXT5:
+        case PF_BC4_UNORM:
+        case PF_BC5_UNORM:
+        case PF_BC7_UNORM:
+        case PF_ETC1_RGB8:
+        case PF_ETC2_RGB8:
+        case PF_ETC2_RGBA8:
+            return true;
+        default:
+            return false;
+        }
+    }
+    //-----------------------------------------------------------------------
+    void BlockCompressor::encode(const PixelBox& src, uchar* dst, PixelFormat format, Image::CompressionQuality quality)
+    {
+        OgreAssert(src.format == PF_BYTE_RGBA && src.getDepth() == 1, "source must be a PF_BYTE_RGBA slice");
+        OgreAssert(isSupported(format), "unsupported format");
+
+        uint32 width = src.getWidth(), height = src.getHeight();
+        uint32 blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+        size_t blockSize = getBlockSize(format);
+        const uchar* srcData = src.getTopLeftFrontPixelPtr();
+
+        auto encodeRows = [&](size_t first, size_t last) {
+            Block blk;
+            for (size_t by = first; by < last; by++)
+            {
+                uchar* out = dst + by * blocksX * blockSize;
+                for (uint32 bx = 0; bx < blocksX; bx++, out += blockSize)
+                {
+                    // replicate the border pixels of partial blocks
+                    for (uint32 i = 0; i < 16; i++)
+                    {
+                        uint32 x = std::min(bx * 4 + i % 4, width - 1), y = std::min<uint32>(by * 4 + i / 4, height - 1);
+                        const uchar* p = srcData + (y * src.rowPitch + x) * 4;
+                        for (int c = 0; c < 4; c++)
+                            blk.c[c][i] = p[c];
+                    }
+
+                    switch (format)
+                    {
+                    case PF_DXT1:
+                        encodeColourBlock(blk, true, quality, out);
+                        break;
+                    case PF_DXT3:
+                        encodeExplicitAlphaBlock(blk, out);
+                        encodeColourBlock(blk, false, quality, out + 8);
+                        break;
+                    case PF_DXT5:
+                        encodeChannelBlock(blk, 3, quality, out);
+                        encodeColourBlock(blk, false, quality, out + 8);
+                        break;
+                    case PF_BC4_UNORM:
+                        encodeChannelBlock(blk, 0, quality, out);
+                        break;
+                    case PF_BC5_UNORM:
+                        encodeChannelBlock(blk, 0, quality, out);
+                        encodeChannelBlock(blk, 1, quality, out + 8);
+                        break;
+                    case PF_BC7_UNORM:
+                        encodeBC7Block(blk, quality, out);
+                        break;
+                    case PF_ETC1_RGB8:
+                    case PF_ETC2_RGB8:
+                        encodeETCBlock(blk, quality, out);
+                        break;
+                    case PF_ETC2_RGBA8:
+                        encodeEACBlock(blk, quality, out);
+                        encodeETCBlock(blk, quality, out + 8);
+                        break;
+                    default:
+                        break;
+                    }
+                }
+            }
+        };
+
+        // about 1024 blocks per task
+        size_t grain = std::max<size_t>(1, 1024 / blocksX);
+        if (Root* root = Root::getSingletonPtr())
+            root->getWorkQueue()->parallelFor(0, blocksY, encodeRows, grain);
+        else
+            encodeRows(0, blocksY);
+    }
+    //-----------------------------------------------------------------------
+    void BlockCompressor::encode(const PixelBox& src, const PixelBox& dst, Image::CompressionQuality quality)
+    {
+        OgreAssert(dst.isConsecutive(), "destination must be consecutive");
+        size_t sliceSize = PixelUtil::getMemorySize(dst.getWidth(), dst.getHeight(), 1, dst.format);
+
+        Image rgba(PF_BYTE_RGBA, src.getWidth(), src.getHeight());
+        for (uint32 z = 0; z < src.getDepth(); z++)
+        {
+            PixelBox slice = src.getSubVolume(Box(src.left, src.top, src.front + z, src.right, src.bottom, src.front + z + 1));
+            PixelBox rgbaBox = rgba.getPixelBox();
+            if (slice.format != PF_BYTE_RGBA)
+                PixelUtil::bulkPixelConversion(slice, rgbaBox);
+            else
+                rgbaBox = slice;
+            encode(rgbaBox, dst.data + (dst.front + z) * sliceSize, dst.format, quality);
+        }
+    }
+}
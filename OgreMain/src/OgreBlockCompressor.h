@@ -0,0 +1,72 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef __BlockCompressor_H__
+#define __BlockCompressor_H__
+
+#include "OgrePrerequisites.h"
+#include "OgreImage.h"
+
+namespace Ogre {
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup Image
+    *  @{
+    */
+
+    /** CPU encoder for the block compressed pixel formats.
+
+        Encodes PF_DXT1, PF_DXT3, PF_DXT5, PF_BC4_UNORM, PF_BC5_UNORM, PF_BC7_UNORM,
+        PF_ETC1_RGB8, PF_ETC2_RGB8 and PF_ETC2_RGBA8. BC7 blocks are always written in mode 6.
+        The rows of blocks are distributed on the worker threads of the Root WorkQueue,
+        if there is one.
+    */
+    class BlockCompressor
+    {
+    public:
+        /// whether format can be encoded
+        static bool isSupported(PixelFormat format);
+
+        /** Encode a slice
+            @param src the pixels to encode, must be PF_BYTE_RGBA with a depth of 1
+            @param dst the consecutive blocks of format
+            @param format the compressed format
+            @param quality the speed/quality trade off
+        */
+        static void encode(const PixelBox& src, uchar* dst, PixelFormat format,
+                           Image::CompressionQuality quality);
+
+        /// encode a volume of any uncompressed format into a consecutive box of a compressed format
+        static void encode(const PixelBox& src, const PixelBox& dst,
+                           Image::CompressionQuality quality = Image::COMPRESS_NORMAL);
+    };
+    /** @} */
+    /** @} */
+}
+
+#endif
@@ -0,0 +1,808 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "OgreStableHeaders.h"
+#include "OgreBoundingVolumeHierarchy.h"
+#include "OgreWorkQueue.h"
+
+#include <unordered_set>
+
+namespace Ogre {
+
+    namespace
+    {
+        /// Trees smaller than this are not worth rebuilding
+        const size_t MIN_REBUILD_OBJECTS = 64;
+        /// Growth of the internal nodes since the last build which triggers a rebuild
+        const double REBUILD_GROWTH = 1.5;
+        /// Number of bins the centres are sorted into, to evaluate the splits
+        const int BUILD_BINS = 16;
+
+        /// Half the surface area of the box, enough to compare boxes
+        inline Real area(const Vector3& min, const Vector3& max)
+        {
+            Vector3 d = max - min;
+            return d.x * d.y + d.y * d.z + d.z * d.x;
+        }
+
+        inline Vector3 floor(Vector3 a, const Vector3& b)
+        {
+            a.makeFloor(b);
+            return a;
+        }
+
+        inline Vector3 ceil(Vector3 a, const Vector3& b)
+        {
+            a.makeCeil(b);
+            return a;
+        }
+
+        inline bool overlaps(const Vector3& minA, const Vector3& maxA, const Vector3& minB, const Vector3& maxB)
+        {
+            return minA.x <= maxB.x && minA.y <= maxB.y && minA.z <= maxB.z &&
+                   minB.x <= maxA.x && minB.y <= maxA.y && minB.z <= maxA.z;
+        }
+
+        struct RayOverlaps
+        {
+            const Ray& ray;
+            Vector3 invDir;
+
+            RayOverlaps(const Ray& r) : ray(r)
+            {
+                for (int i = 0; i < 3; ++i)
+                    invDir[i] = ray.getDirection()[i] != 0 ? 1 / ray.getDirection()[i] : 0;
+            }
+
+            bool operator()(const Vector3& min, const Vector3& max) const
+            {
+                // slabs test, along the ray only
+                const Vector3& origin = ray.getOrigin();
+                Real tmin = 0, tmax = std::numeric_limits<Real>::max();
+                for (int i = 0; i < 3; ++i)
+                {
+                    if (invDir[i] == 0)
+                    {
+                        if (origin[i] < min[i] || origin[i] > max[i])
+                            return false;
+                        continue;
+                    }
+                    Real t0 = (min[i] - origin[i]) * invDir[i];
+                    Real t1 = (max[i] - origin[i]) * invDir[i];
+                    if (t0 > t1)
+                        std::swap(t0, t1);
+                    tmin = std::max(tmin, t0);
+                    tmax = std::min(tmax, t1);
+                    if (tmin > tmax)
+                        return false;
+                }
+                return true;
+            }
+        };
+
+        struct SphereOverlaps
+        {
+            const Sphere& sphere;
+
+            bool operator()(const Vector3& min, const Vector3& max) const
+            {
+                const Vector3& centre = sphere.getCenter();
+                Real d2 = 0;
+                for (int i = 0; i < 3; ++i)
+                {
+                    if (centre[i] < min[i])
+                        d2 += Math::Sqr(min[i] - centre[i]);
+                    else if (centre[i] > max[i])
+                        d2 += Math::Sqr(centre[i] - max[i]);
+                }
+                return d2 <= Math::Sqr(sphere.getRadius());
+            }
+        };
+
+        struct BoxOverlaps
+        {
+            const AxisAlignedBox& box;
+
+            bool operator()(const Vector3& min, const Vector3& max) const
+            {
+                return box.isInfinite() || overlaps(min, max, box.getMinimum(), box.getMaximum());
+            }
+        };
+
+        struct VolumesOverlap
+        {
+            const PlaneBoundedVolumeList& volumes;
+
+            bool operator()(const Vector3& min, const Vector3& max) const
+            {
+                AxisAlignedBox box(min, max);
+                for (const auto& vol : volumes)
+                {
+                    if (vol.intersects(box))
+                        return true;
+                }
+                return false;
+            }
+        };
+    }
+    //-----------------------------------------------------------------------
+    struct BoundingVolumeHierarchy::RebuildJob
+    {
+        std::vector<BuildItem> items;
+        Tree tree;
+        std::atomic<bool> cancelled{false};
+        /// Objects inserted and removed since the items were gathered, main thread only
+        std::unordered_set<MovableObject*> inserted, removed;
+    };
+    //-----------------------------------------------------------------------
+    int32 BoundingVolumeHierarchy::Tree::allocateNode(void)
+    {
+        if (freeList >= 0)
+        {
+            int32 index = freeList;
+            freeList = nodes[index].parent;
+            return index;
+        }
+        nodes.push_back(Node());
+        return int32(nodes.size() - 1);
+    }
+    //-----------------------------------------------------------------------
+    void BoundingVolumeHierarchy::Tree::freeNode(int32 index)
+    {
+        Node& node = nodes[index];
+        node.object = 0;
+        node.children[0] = node.children[1] = -1;
+        // free nodes are chained through their parent
+        node.parent = freeList;
+        freeList = index;
+    }
+    //-----------------------------------------------------------------------
+    void BoundingVolumeHierarchy::Tree::insertLeaf(int32 leaf)
+    {
+        ++leafCount;
+        if (root < 0)
+        {
+            root = leaf;
+            nodes[leaf].parent = -1;
+            return;
+        }
+
+        // Descend towards the sibling which grows the tree the least: a new parent for
+        // a node costs its merged area, while going further down costs at least the
+        // growth of the node
+        const Vector3 leafMin = nodes[leaf].min, leafMax = nodes[leaf].max;
+        int32 index = root;
+        while (!nodes[index].isLeaf())
+        {
+            const Node& node = nodes[index];
+            Real combinedArea = area(floor(node.min, leafMin), ceil(node.max, leafMax));
+            Real cost = 2 * combinedArea;
+            Real inheritance = 2 * (combinedArea - area(node.min, node.max));
+
+            Real childCost[2];
+            for (int i = 0; i < 2; ++i)
+            {
+                const Node& child = nodes[node.children[i]];
+                Real merged = area(floor(child.min, leafMin), ceil(child.max, leafMax));
+                childCost[i] = (child.isLeaf() ? merged : merged - area(child.min, child.max)) + inheritance;
+            }
+
+            if (cost < childCost[0] && cost < childCost[1])
+                break;
+            index = node.children[childCost[1] < childCost[0] ? 1 : 0];
+        }
+
+        int32 sibling = index;
+        int32 oldParent = nodes[sibling].parent;
+        int32 newParent = allocateNode();
+
+        Node& parent = nodes[newParent];
+        parent.parent = oldParent;
+        parent.children[0] = sibling;
+        parent.children[1] = leaf;
+        parent.object = 0;
+        parent.min = floor(nodes[sibling].min, leafMin);
+        parent.max = ceil(nodes[sibling].max, leafMax);
+        internalArea += area(parent.min, parent.max);
+
+        nodes[sibling].parent = newParent;
+        nodes[leaf].parent = newParent;
+        if (oldParent < 0)
+        {
+            root = newParent;
+            return;
+        }
+
+        Node& grandParent = nodes[oldParent];
+        grandParent.children[grandParent.children[0] == sibling ? 0 : 1] = newParent;
+        refitAncestors(oldParent);
+    }
+    //-----------------------------------------------------------------------
+    void BoundingVolumeHierarchy::Tree::removeLeaf(int32 leaf)
+    {
+        --leafCount;
+        if (leaf == root)
+        {
+            root = -1;
+            return;
+        }
+
+        // The sibling takes the place of the parent
+        int32 parent = nodes[leaf].parent;
+        int32 grandParent = nodes[parent].parent;
+        int32 sibling = nodes[parent].children[nodes[parent].children[0] == leaf ? 1 : 0];
+        internalArea -= area(nodes[parent].min, nodes[parent].max);
+        freeNode(parent);
+
+        nodes[sibling].parent = grandParent;
+        if (grandParent < 0)
+        {
+            root = sibling;
+            return;
+        }
+
+        Node& node = nodes[grandParent];
+        node.children[node.children[0] == parent ? 0 : 1] = sibling;
+        refitAncestors(grandParent);
+    }
+    //-----------------------------------------------------------------------
+    void BoundingVolumeHierarchy::Tree::refitAncestors(int32 index)
+    {
+        while (index >= 0)
+        {
+            Node& node = nodes[index];
+            const Node& a = nodes[node.children[0]];
+            const Node& b = nodes[node.children[1]];
+            Vector3 min = floor(a.min, b.min);
+            Vector3 max = ceil(a.max, b.max);
+            // the ancestors already fit
+            if (min == node.min && max == node.max)
+                return;
+
+            internalArea += area(min, max) - area(node.min, node.max);
+            node.min = min;
+            node.max = max;
+            index = node.parent;
+        }
+    }
+    //-----------------------------------------------------------------------
+    BoundingVolumeHierarchy::BoundingVolumeHierarchy() : mRebuildArea(0)
+    {
+    }
+    //-----------------------------------------------------------------------
+    BoundingVolumeHierarchy::~BoundingVolumeHierarchy()
+    {
+        cancelRebuild();
+
+        for (const auto& node : mTree.nodes)
+        {
+            if (node.isLeaf() && node.object)
+                node.object->_setSceneQueryLeaf(NO_LEAF);
+        }
+        for (auto obj : mInfiniteObjects)
+            obj->_setSceneQueryLeaf(NO_LEAF);
+    }
+    //-----------------------------------------------------------------------
+    void BoundingVolumeHierarchy::update(MovableObject* obj, const AxisAlignedBox& bounds)
+    {
+        if (bounds.isNull())
+        {
+            remove(obj);
+            return;
+        }
+
+        int32 leaf = obj->_getSceneQueryLeaf();
+        if (bounds.isInfinite())
+        {
+            if (leaf >= 0)
+                removeFromTree(obj);
+            if (leaf != INFINITE_LEAF)
+            {
+                mInfiniteObjects.push_back(obj);
+                obj->_setSceneQueryLeaf(INFINITE_LEAF);
+            }
+            return;
+        }
+
+        if (leaf == INFINITE_LEAF)
+            removeFromInfinite(obj);
+        if (leaf < 0)
+        {
+            insert(obj, bounds.getMinimum(), bounds.getMaximum());
+            return;
+        }
+
+        Node& node = mTree.nodes[leaf];
+        if (node.min == bounds.getMinimum() && node.max == bounds.getMaximum())
+            return;
+
+        node.min = bounds.getMinimum();
+        node.max = bounds.getMaximum();
+        mTree.refitAncestors(node.parent);
+    }
+    //-----------------------------------------------------------------------
+    void BoundingVolumeHierarchy::remove(MovableObject* obj)
+    {
+        int32 leaf = obj->_getSceneQueryLeaf();
+        if (leaf >= 0)
+            removeFromTree(obj);
+        else if (leaf == INFINITE_LEAF)
+            removeFromInfinite(obj);
+    }
+    //-----------------------------------------------------------------------
+    void BoundingVolumeHierarchy::insert(MovableObject* obj, const Vector3& min, const Vector3& max)
+    {
+        int32 leaf = mTree.allocateNode();
+        Node& node = mTree.nodes[leaf];
+        node.min = min;
+        node.max = max;
+        node.children[0] = node.children[1] = -1;
+        node.object = obj;
+        mTree.insertLeaf(leaf);
+        obj->_setSceneQueryLeaf(leaf);
+
+        if (mRebuildJob)
+            mRebuildJob->inserted.insert(obj);
+    }
+    //-----------------------------------------------------------------------
+    void BoundingVolumeHierarchy::removeFromTree(MovableObject* obj)
+    {
+        int32 leaf = obj->_getSceneQueryLeaf();
+        mTree.removeLeaf(leaf);
+        mTree.freeNode(leaf);
+        obj->_setSceneQueryLeaf(NO_LEAF);
+
+        // the tree being rebuilt must drop the object, unless it was not in it
+        if (mRebuildJob && !mRebuildJob->inserted.erase(obj))
+            mRebuildJob->removed.insert(obj);
+    }
+    //-----------------------------------------------------------------------
+    void BoundingVolumeHierarchy::removeFromInfinite(MovableObject* obj)
+    {
+        auto it = std::find(mInfiniteObjects.begin(), mInfiniteObjects.end(), obj);
+        *it = mInfiniteObjects.back();
+        mInfiniteObjects.pop_back();
+        obj->_setSceneQueryLeaf(NO_LEAF);
+    }
+    //-----------------------------------------------------------------------
+    Real BoundingVolumeHierarchy::getCost(void) const
+    {
+        if (mTree.root < 0)
+            return 0;
+        Real rootArea = area(mTree.nodes[mTree.root].min, mTree.nodes[mTree.root].max);
+        return rootArea > 0 ? Real(mTree.internalArea / rootArea) : 0;
+    }
+    //-----------------------------------------------------------------------
+    void BoundingVolumeHierarchy::rebuildIfNeeded(bool inBackground)
+    {
+        if (mRebuildJob || mTree.leafCount < MIN_REBUILD_OBJECTS || mTree.internalArea <= mRebuildArea)
+            return;
+
+        WorkQueue* wq = Root::getSingleton().getWorkQueue();
+        if (!inBackground || !wq->getRequestsAccepted())
+        {
+            rebuild();
+            return;
+        }
+
+        auto job = std::make_shared<RebuildJob>();
+        gatherBuildItems(job->items);
+        mRebuildJob = job;
+
+        wq->addTask(
+            [this, job, wq]()
+            {
+                if (!job->cancelled)
+                    buildTree(job->items, job->tree);
+
+                wq->addMainThreadTask(
+                    [this, job]()
+                    {
+                        if (job->cancelled)
+                            return;
+                        mRebuildJob.reset();
+                        swapTree(job->tree, job.get());
+                    });
+            });
+    }
+    //-----------------------------------------------------------------------
+    void BoundingVolumeHierarchy::rebuild(void)
+    {
+        cancelRebuild();
+
+        std::vector<BuildItem> items;
+        gatherBuildItems(items);
+        Tree tree;
+        buildTree(items, tree);
+        swapTree(tree, NULL);
+    }
+    //-----------------------------------------------------------------------
+    void BoundingVolumeHierarchy::cancelRebuild(void)
+    {
+        if (!mRebuildJob)
+            return;
+
+        // the worker only touches the job, which it shares
+        mRebuildJob->cancelled = true;
+        mRebuildJob.reset();
+    }
+    //-----------------------------------------------------------------------
+    void BoundingVolumeHierarchy::gatherBuildItems(std::vector<BuildItem>& items) const
+    {
+        items.reserve(mTree.leafCount);
+        for (const auto& node : mTree.nodes)
+        {
+            if (node.isLeaf() && node.object)
+            {
+                BuildItem item = {node.min, node.max, (node.min + node.max) * 0.5f, node.object};
+                items.push_back(item);
+            }
+        }
+    }
+    //-----------------------------------------------------------------------
+    void BoundingVolumeHierarchy::swapTree(Tree& tree, const RebuildJob* job)
+    {
+        // Drop the objects removed since the items were gathered, and fit the other
+        // leaves to the current bounds of their objects
+        for (size_t i = 0; i < tree.nodes.size(); ++i)
+        {
+            Node& node = tree.nodes[i];
+            if (!node.isLeaf() || !node.object)
+                continue;
+
+            int32 leaf = node.object->_getSceneQueryLeaf();
+            if (leaf < 0 || (job && job->removed.count(node.object)))
+            {
+                tree.removeLeaf(int32(i));
+                tree.freeNode(int32(i));
+                continue;
+            }
+            node.min = mTree.nodes[leaf].min;
+            node.max = mTree.nodes[leaf].max;
+        }
+
+        // The children come after their parent, so the internal nodes can be refitted
+        // backwards
+        tree.internalArea = 0;
+        for (size_t i = tree.nodes.size(); i-- > 0;)
+        {
+            Node& node = tree.nodes[i];
+            if (node.isLeaf())
+                continue;
+            const Node& a = tree.nodes[node.children[0]];
+            const Node& b = tree.nodes[node.children[1]];
+            node.min = floor(a.min, b.min);
+            node.max = ceil(a.max, b.max);
+            tree.internalArea += area(node.min, node.max);
+        }
+
+        // Objects inserted since then are inserted again in the new tree
+        std::vector<BuildItem> inserted;
+        if (job)
+        {
+            for (auto obj : job->inserted)
+            {
+                const Node& node = mTree.nodes[obj->_getSceneQueryLeaf()];
+                BuildItem item = {node.min, node.max, Vector3::ZERO, obj};
+                inserted.push_back(item);
+            }
+        }
+
+        std::swap(mTree, tree);
+        for (size_t i = 0; i < mTree.nodes.size(); ++i)
+        {
+            const Node& node = mTree.nodes[i];
+            if (node.isLeaf() && node.object)
+                node.object->_setSceneQueryLeaf(int32(i));
+        }
+        for (const auto& item : inserted)
+            insert(item.object, item.min, item.max);
+
+        mRebuildArea = REBUILD_GROWTH * mTree.internalArea;
+    }
+    //-----------------------------------------------------------------------
+    void BoundingVolumeHierarchy::buildTree(std::vector<BuildItem>& items, Tree& tree)
+    {
+        tree = Tree();
+        if (items.empty())
+            return;
+
+        tree.nodes.reserve(2 * items.size() - 1);
+        tree.leafCount = items.size();
+
+        // Top down, depth first, so the children come after their parent
+        struct Range
+        {
+            size_t begin, end;
+            int32 parent;
+        };
+        std::vector<Range> stack;
+        stack.push_back({0, items.size(), -1});
+        while (!stack.empty())
+        {
+            Range range = stack.back();
+            stack.pop_back();
+
+            int32 index = tree.allocateNode();
+            Node& node = tree.nodes[index];
+            node.parent = range.parent;
+            node.children[0] = node.children[1] = -1;
+            node.object = 0;
+            if (range.parent < 0)
+                tree.root = index;
+            else
+            {
+                Node& parent = tree.nodes[range.parent];
+                parent.children[parent.children[0] < 0 ? 0 : 1] = index;
+            }
+
+            BuildItem* first = &items[range.begin];
+            size_t count = range.end - range.begin;
+            node.min = first->min;
+            node.max = first->max;
+            if (count == 1)
+            {
+                node.object = first->object;
+                continue;
+            }
+
+            Vector3 centreMin = first->centre, centreMax = first->centre;
+            for (size_t i = 1; i < count; ++i)
+            {
+                node.min.makeFloor(first[i].min);
+                node.max.makeCeil(first[i].max);
+                centreMin.makeFloor(first[i].centre);
+                centreMax.makeCeil(first[i].centre);
+            }
+            tree.internalArea += area(node.min, node.max);
+
+            // Split along the longest axis of the centres, where the surface area
+            // heuristic is the lowest among the bin boundaries
+            Vector3 extent = centreMax - centreMin;
+            int axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+            size_t split = count / 2;
+            if (extent[axis] > 0)
+            {
+                struct Bin
+                {
+                    Vector3 min, max;
+                    size_t count;
+                } bins[BUILD_BINS];
+                for (auto& bin : bins)
+                {
+                    bin.min = Vector3(std::numeric_limits<Real>::max());
+                    bin.max = Vector3(-std::numeric_limits<Real>::max());
+                    bin.count = 0;
+                }
+
+                Real scale = BUILD_BINS / extent[axis];
+                Real offset = centreMin[axis];
+                auto binOf = [scale, offset, axis](const BuildItem& item)
+                { return std::min(int((item.centre[axis] - offset) * scale), BUILD_BINS - 1); };
+
+                for (size_t i = 0; i < count; ++i)
+                {
+                    Bin& bin = bins[binOf(first[i])];
+                    bin.min.makeFloor(first[i].min);
+                    bin.max.makeCeil(first[i].max);
+                    ++bin.count;
+                }
+
+                // cost of the items right of each boundary
+                Real rightCost[BUILD_BINS];
+                Vector3 accMin = bins[BUILD_BINS - 1].min, accMax = bins[BUILD_BINS - 1].max;
+                size_t accCount = 0;
+                for (int i = BUILD_BINS - 1; i > 0; --i)
+                {
+                    accMin.makeFloor(bins[i].min);
+                    accMax.makeCeil(bins[i].max);
+                    accCount += bins[i].count;
+                    rightCost[i] = accCount ? accCount * area(accMin, accMax) : 0;
+                }
+
+                int bestSplit = -1;
+                Real bestCost = std::numeric_limits<Real>::max();
+                accMin = bins[0].min;
+                accMax = bins[0].max;
+                size_t leftCount = 0;
+                for (int i = 1; i < BUILD_BINS; ++i)
+                {
+                    accMin.makeFloor(bins[i - 1].min);
+                    accMax.makeCeil(bins[i - 1].max);
+                    leftCount += bins[i - 1].count;
+                    if (leftCount == 0 || leftCount == count)
+                        continue;
+                    Real cost = leftCount * area(accMin, accMax) + rightCost[i];
+                    if (cost < bestCost)
+                    {
+                        bestCost = cost;
+                        bestSplit = i;
+                    }
+                }
+
+                if (bestSplit > 0)
+                {
+                    split = std::partition(first, first + count,
+                                           [&binOf, bestSplit](const BuildItem& item)
+                                           { return binOf(item) < bestSplit; }) - first;
+                }
+                else
+                {
+                    std::nth_element(first, first + split, first + count,
+                                     [axis](const BuildItem& a, const BuildItem& b)
+                                     { return a.centre[axis] < b.centre[axis]; });
+                }
+            }
+
+            // the first half is popped, so built, first
+            stack.push_back({range.begin + split, range.end, index});
+            stack.push_back({range.begin, range.begin + split, index});
+        }
+    }
+    //-----------------------------------------------------------------------
+    template <typename Overlaps>
+    void BoundingVolumeHierarchy::collectObjects(const Overlaps& overlaps, ObjectList& result) const
+    {
+        result.insert(result.end(), mInfiniteObjects.begin(), mInfiniteObjects.end());
+        if (mTree.root < 0)
+            return;
+
+        std::vector<int32> stack;
+        stack.reserve(64);
+        stack.push_back(mTree.root);
+        while (!stack.empty())
+        {
+            const Node& node = mTree.nodes[stack.back()];
+            stack.pop_back();
+            if (!overlaps(node.min, node.max))
+                continue;
+
+            if (node.isLeaf())
+                result.push_back(node.object);
+            else
+            {
+                stack.push_back(node.children[1]);
+                stack.push_back(node.children[0]);
+            }
+        }
+    }
+    //-----------------------------------------------------------------------
+    void BoundingVolumeHierarchy::findObjects(const Ray& ray, ObjectList& result) const
+    {
+        collectObjects(RayOverlaps(ray), result);
+    }
+    //-----------------------------------------------------------------------
+    void BoundingVolumeHierarchy::findObjects(RayPacket& packet, const RayPacketVisitor& visitor) const
+    {
+        for (auto obj : mInfiniteObjects)
+            visitor(obj, packet.getMask());
+        if (mTree.root < 0)
+            return;
+
+        // Order the children along the first ray, the others mostly go the same way
+        const Ray& ray = packet.getRay(0);
+        std::vector<int32> stack;
+        stack.reserve(64);
+        stack.push_back(mTree.root);
+        while (!stack.empty())
+        {
+            // the maximal distances may have dropped since the node was pushed
+            const Node& node = mTree.nodes[stack.back()];
+            stack.pop_back();
+            RayPacket::Mask hits = packet.intersects(node.min, node.max);
+            if (!hits)
+                continue;
+
+            if (node.isLeaf())
+            {
+                visitor(node.object, hits);
+                continue;
+            }
+
+            const Node& a = mTree.nodes[node.children[0]];
+            const Node& b = mTree.nodes[node.children[1]];
+            Vector3 offset = (b.min + b.max) - (a.min + a.max);
+            bool aFirst = offset.dotProduct(ray.getDirection()) >= 0;
+            stack.push_back(node.children[aFirst ? 1 : 0]);
+            stack.push_back(node.children[aFirst ? 0 : 1]);
+        }
+    }
+    //-----------------------------------------------------------------------
+    void BoundingVolumeHierarchy::findObjects(const Sphere& sphere, ObjectList& result) const
+    {
+        collectObjects(SphereOverlaps{sphere}, result);
+    }
+    //-----------------------------------------------------------------------
+    void BoundingVolumeHierarchy::findObjects(const AxisAlignedBox& box, ObjectList& result) const
+    {
+        if (!box.isNull())
+            collectObjects(BoxOverlaps{box}, result);
+    }
+    //-----------------------------------------------------------------------
+    void BoundingVolumeHierarchy::findObjects(const PlaneBoundedVolumeList& volumes, ObjectList& result) const
+    {
+        collectObjects(VolumesOverlap{volumes}, result);
+    }
+    //-----------------------------------------------------------------------
+    void BoundingVolumeHierarchy::findPairs(ObjectPairList& result) const
+    {
+        // Infinite bounds intersect everything
+        for (size_t i = 0; i < mInfiniteObjects.size(); ++i)
+        {
+            for (size_t j = i + 1; j < mInfiniteObjects.size(); ++j)
+                result.push_back(std::make_pair(mInfiniteObjects[i], mInfiniteObjects[j]));
+            for (const auto& node : mTree.nodes)
+            {
+                if (node.isLeaf() && node.object)
+                    result.push_back(std::make_pair(mInfiniteObjects[i], node.object));
+            }
+        }
+        if (mTree.root < 0)
+            return;
+
+        // Pairs of nodes to test, a node paired with itself stands for the pairs
+        // within its subtree
+        std::vector<std::pair<int32, int32> > stack;
+        stack.reserve(64);
+        stack.push_back(std::make_pair(mTree.root, mTree.root));
+        while (!stack.empty())
+        {
+            std::pair<int32, int32> pair = stack.back();
+            stack.pop_back();
+
+            const Node& a = mTree.nodes[pair.first];
+            if (pair.first == pair.second)
+            {
+                if (!a.isLeaf())
+                {
+                    stack.push_back(std::make_pair(a.children[1], a.children[1]));
+                    stack.push_back(std::make_pair(a.children[0], a.children[1]));
+                    stack.push_back(std::make_pair(a.children[0], a.children[0]));
+                }
+                continue;
+            }
+
+            const Node& b = mTree.nodes[pair.second];
+            if (!overlaps(a.min, a.max, b.min, b.max))
+                continue;
+
+            if (a.isLeaf() && b.isLeaf())
+                result.push_back(std::make_pair(a.object, b.object));
+            else if (b.isLeaf() || (!a.isLeaf() && area(a.min, a.max) > area(b.min, b.max)))
+            {
+                // descend into the larger node
+                stack.push_back(std::make_pair(a.children[1], pair.second));
+                stack.push_back(std::make_pair(a.children[0], pair.second));
+            }
+            else
+            {
+                stack.push_back(std::make_pair(pair.first, b.children[1]));
+                stack.push_back(std::make_pair(pair.first, b.children[0]));
+            }
+        }
+    }
+}
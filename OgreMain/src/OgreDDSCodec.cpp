@@ -145,10 +145,10 @@ namespace {
     const uint32 DDSCAPS2_CUBEMAP_NEGATIVEZ = 0x00008000;
     const uint32 DDSCAPS2_VOLUME = 0x00200000;
 
+    const uint32 DDSD_LINEARSIZE = 0x00080000;
     // Currently unused
 //    const uint32 DDSD_PITCH = 0x00000008;
 //    const uint32 DDSD_MIPMAPCOUNT = 0x00020000;
-//    const uint32 DDSD_LINEARSIZE = 0x00080000;
 
     // Special FourCC codes
     const uint32 D3DFMT_R16F            = 111;
@@ -157,6 +157,10 @@ namespace {
     const uint32 D3DFMT_R32F            = 114;
     const uint32 D3DFMT_G32R32F         = 115;
     const uint32 D3DFMT_A32B32G32R32F   = 116;
+
+    const uint32 DXGI_FORMAT_BC7_UNORM = 98;
+    const uint32 D3D10_RESOURCE_DIMENSION_TEXTURE2D = 3;
+    const uint32 D3D10_RESOURCE_MISC_TEXTURECUBE = 0x4;
 }
 
     //---------------------------------------------------------------------
@@ -241,6 +245,12 @@ namespace {
         case PF_FLOAT16_R:
         case PF_FLOAT16_RGBA:
         case PF_FLOAT32_RGBA:
+        case PF_DXT1:
+        case PF_DXT3:
+        case PF_DXT5:
+        case PF_BC4_UNORM:
+        case PF_BC5_UNORM:
+        case PF_BC7_UNORM:
             break;
         default:
             // No crazy FOURCC or 565 et al. file formats at this stage
@@ -275,6 +285,8 @@ namespace {
                 DDSD_CAPS|DDSD_WIDTH|DDSD_HEIGHT|DDSD_PIXELFORMAT;  
 
             bool flipRgbMasks = false;
+            bool isCompressed = PixelUtil::isCompressed(image->getFormat());
+            bool hasExtendedHeader = image->getFormat() == PF_BC7_UNORM;
 
             // Initalise the rgbBits flags
             switch(image->getFormat())
@@ -317,6 +329,13 @@ namespace {
 
             // Initalise the SizeOrPitch flags (power two textures for now)
             ddsHeaderSizeOrPitch = static_cast<uint32>(ddsHeaderRgbBits * image->getWidth());
+            if (isCompressed)
+            {
+                // size of the top level instead
+                ddsHeaderFlags |= DDSD_LINEARSIZE;
+                ddsHeaderSizeOrPitch = static_cast<uint32>(
+                    PixelUtil::getMemorySize(image->getWidth(), image->getHeight(), 1, image->getFormat()));
+            }
 
             // Initalise the caps flags
             ddsHeaderCaps1 = (isVolume||isCubeMap) ? DDSCAPS_COMPLEX|DDSCAPS_TEXTURE : DDSCAPS_TEXTURE;
@@ -369,6 +388,32 @@ namespace {
             else {
                 ddsHeader.pixelFormat.fourCC = 0;
             }
+            if (isCompressed)
+            {
+                ddsHeader.pixelFormat.flags = DDPF_FOURCC;
+                switch (image->getFormat())
+                {
+                case PF_DXT1:
+                    ddsHeader.pixelFormat.fourCC = FOURCC('D', 'X', 'T', '1');
+                    break;
+                case PF_DXT3:
+                    ddsHeader.pixelFormat.fourCC = FOURCC('D', 'X', 'T', '3');
+                    break;
+                case PF_DXT5:
+                    ddsHeader.pixelFormat.fourCC = FOURCC('D', 'X', 'T', '5');
+                    break;
+                case PF_BC4_UNORM:
+                    ddsHeader.pixelFormat.fourCC = FOURCC('B', 'C', '4', 'U');
+                    break;
+                case PF_BC5_UNORM:
+                    ddsHeader.pixelFormat.fourCC = FOURCC('B', 'C', '5', 'U');
+                    break;
+                default:
+                    // BC7 is only defined by the DXGI format
+                    ddsHeader.pixelFormat.fourCC = FOURCC('D', 'X', '1', '0');
+                    break;
+                }
+            }
             ddsHeader.pixelFormat.rgbBits = ddsHeaderRgbBits;
 
             ddsHeader.pixelFormat.alphaMask = (hasAlpha)   ? 0xFF000000 : 0x00000000;
@@ -380,6 +425,19 @@ namespace {
             if( flipRgbMasks )
                 std::swap( ddsHeader.pixelFormat.redMask, ddsHeader.pixelFormat.blueMask );
 
+            if (isCompressed)
+            {
+                ddsHeader.pixelFormat.alphaMask = ddsHeader.pixelFormat.redMask = 0;
+                ddsHeader.pixelFormat.greenMask = ddsHeader.pixelFormat.blueMask = 0;
+            }
+
+            DDSExtendedHeader ddsExtHeader;
+            ddsExtHeader.dxgiFormat = DXGI_FORMAT_BC7_UNORM;
+            ddsExtHeader.resourceDimension = D3D10_RESOURCE_DIMENSION_TEXTURE2D;
+            ddsExtHeader.miscFlag = isCubeMap ? D3D10_RESOURCE_MISC_TEXTURECUBE : 0;
+            ddsExtHeader.arraySize = 1;
+            ddsExtHeader.reserved = 0;
+
             ddsHeader.caps.caps1 = ddsHeaderCaps1;
             ddsHeader.caps.caps2 = ddsHeaderCaps2;
 //          ddsHeader.caps.reserved[0] = 0;
@@ -388,6 +446,7 @@ namespace {
             // Swap endian
             flipEndian(&ddsMagic, sizeof(uint32));
             flipEndian(&ddsHeader, 4, sizeof(DDSHeader) / 4);
+            flipEndian(&ddsExtHeader, 4, sizeof(DDSExtendedHeader) / 4);
 
             char *tmpData = 0;
             char *dataPtr = (char*)image->getData();
@@ -403,11 +462,13 @@ namespace {
                 dataPtr = tmpData;
             }
 
-            size_t totalSize = sizeof(uint32) + DDS_HEADER_SIZE + image->getSize();
+            size_t extHeaderSize = hasExtendedHeader ? sizeof(DDSExtendedHeader) : 0;
+            size_t totalSize = sizeof(uint32) + DDS_HEADER_SIZE + extHeaderSize + image->getSize();
             auto pMemStream = OGRE_NEW Ogre::MemoryDataStream(totalSize);
 
             pMemStream->write(&ddsMagic, sizeof(uint32));
             pMemStream->write(&ddsHeader, DDS_HEADER_SIZE);
+            pMemStream->write(&ddsExtHeader, extHeaderSize);
             pMemStream->write(dataPtr, image->getSize());
             pMemStream->seek(0);
 
@@ -757,9 +818,8 @@ namespace {
             pCol[i].a = derivedAlphas[dw & 0x7];
     }
     //---------------------------------------------------------------------
-    void DDSCodec::decode(const DataStreamPtr& stream, const Any& output) const
+    PixelFormat DDSCodec::readHeader(const DataStreamPtr& stream, DDSHeader& header) const
     {
-        Image* image = any_cast<Image*>(output);
         // Read 4 character code
         uint32 fileType;
         stream->read(&fileType, sizeof(uint32));
@@ -772,7 +832,6 @@ namespace {
         }
         
         // Read header in full
-        DDSHeader header;
         stream->read(&header, sizeof(DDSHeader));
 
         // Endian flip if required, all 32-bit values
@@ -790,30 +849,6 @@ namespace {
                 "DDS header size mismatch!", "DDSCodec::decode");
         }
 
-        uint32 imgDepth = 1; // (deal with volume later)
-        uint32 numFaces = 1; // assume one face until we know otherwise
-        uint32 num_mipmaps = 0;
-        PixelFormat format = PF_UNKNOWN;
-
-        if (header.caps.caps1 & DDSCAPS_MIPMAP)
-        {
-            num_mipmaps = static_cast<uint8>(header.mipMapCount - 1);
-        }
-        else
-        {
-            num_mipmaps = 0;
-        }
-
-        bool decompressDXT = false;
-        // Figure out basic image type
-        if (header.caps.caps2 & DDSCAPS2_CUBEMAP)
-        {
-            numFaces = 6;
-        }
-        else if (header.caps.caps2 & DDSCAPS2_VOLUME)
-        {
-            imgDepth = header.depth;
-        }
         // Pixel format
         PixelFormat sourceFormat = PF_UNKNOWN;
 
@@ -843,6 +878,40 @@ namespace {
                 header.pixelFormat.alphaMask : 0);
         }
 
+        return sourceFormat;
+    }
+    //---------------------------------------------------------------------
+    void DDSCodec::decode(const DataStreamPtr& stream, const Any& output) const
+    {
+        Image* image = any_cast<Image*>(output);
+        DDSHeader header;
+        PixelFormat sourceFormat = readHeader(stream, header);
+
+        uint32 imgDepth = 1; // (deal with volume later)
+        uint32 numFaces = 1; // assume one face until we know otherwise
+        uint32 num_mipmaps = 0;
+        PixelFormat format = PF_UNKNOWN;
+
+        if (header.caps.caps1 & DDSCAPS_MIPMAP)
+        {
+            num_mipmaps = static_cast<uint8>(header.mipMapCount - 1);
+        }
+        else
+        {
+            num_mipmaps = 0;
+        }
+
+        bool decompressDXT = false;
+        // Figure out basic image type
+        if (header.caps.caps2 & DDSCAPS2_CUBEMAP)
+        {
+            numFaces = 6;
+        }
+        else if (header.caps.caps2 & DDSCAPS2_VOLUME)
+        {
+            imgDepth = header.depth;
+        }
+
         if (PixelUtil::isCompressed(sourceFormat))
         {
             if (Root::getSingleton().getRenderSystem() == NULL ||
@@ -1043,6 +1112,39 @@ namespace {
 
         }
     }
+    //---------------------------------------------------------------------
+    bool DDSCodec::decodeBands(const DataStreamPtr& stream, BandListener* listener, size_t maxBandSize) const
+    {
+        DDSHeader header;
+        PixelFormat format = readHeader(stream, header);
+
+        // the faces of cube maps are stored one after another, and volumes slice by slice
+        if (header.caps.caps2 & (DDSCAPS2_CUBEMAP | DDSCAPS2_VOLUME))
+            return false;
+
+        // decompression is left to decode
+        if (PixelUtil::isCompressed(format) &&
+            (Root::getSingleton().getRenderSystem() == NULL ||
+             !Root::getSingleton().getRenderSystem()->getCapabilities()->hasCapability(RSC_TEXTURE_COMPRESSION_DXT) ||
+             mDecodeEnforce))
+            return false;
+
+        uint32 numMipmaps = 0;
+        if (header.caps.caps1 & DDSCAPS_MIPMAP)
+            numMipmaps = static_cast<uint8>(header.mipMapCount - 1);
+
+        if (!listener->imageHeaderDecoded(header.width, header.height, format, numMipmaps))
+            return false;
+
+        uint32 width = header.width, height = header.height;
+        for (uint32 mip = 0; mip <= numMipmaps; ++mip)
+        {
+            readBands(stream, listener, mip, width, height, format, maxBandSize);
+            width = std::max(width / 2, 1u);
+            height = std::max(height / 2, 1u);
+        }
+        return true;
+    }
     //---------------------------------------------------------------------    
     String DDSCodec::getType() const 
     {
@@ -43,6 +43,7 @@ namespace Ogre {
     struct DXTColourBlock;
     struct DXTExplicitAlphaBlock;
     struct DXTInterpolatedAlphaBlock;
+    struct DDSHeader;
 
 
     /** Codec specialized in loading DDS (Direct Draw Surface) images.
@@ -61,6 +62,9 @@ namespace Ogre {
         PixelFormat convertPixelFormat(uint32 rgbBits, uint32 rMask,
             uint32 gMask, uint32 bMask, uint32 aMask) const;
 
+        /// Read and validate the header, returning the format of the stored data
+        PixelFormat readHeader(const DataStreamPtr& stream, DDSHeader& header) const;
+
         /// Unpack DXT colours into array of 16 colour values
         void unpackDXTColour(PixelFormat pf, const DXTColourBlock& block, ColourValue* pCol) const;
         /// Unpack DXT alphas into array of 16 colour values
@@ -77,6 +81,7 @@ namespace Ogre {
         DataStreamPtr encode(const Any& input) const override;
         void encodeToFile(const Any& input, const String& outFileName) const override;
         void decode(const DataStreamPtr& input, const Any& output) const override;
+        bool decodeBands(const DataStreamPtr& input, BandListener* listener, size_t maxBandSize) const override;
         String magicNumberToFileExt(const char *magicNumberPtr, size_t maxbytes) const override;
         String getType() const override;
 
@@ -26,8 +26,26 @@ THE SOFTWARE.
 -----------------------------------------------------------------------------
 */
 #include "OgreStableHeaders.h"
+#include "OgreBoundingVolumeHierarchy.h"
+#include "OgreWorkQueue.h"
 
 namespace Ogre {
+    namespace
+    {
+        /// The order the scene was searched in, movable type then name, before the
+        /// hierarchy was used
+        bool movableLess(const MovableObject* a, const MovableObject* b)
+        {
+            int order = a->getMovableType().compare(b->getMovableType());
+            return order != 0 ? order < 0 : a->getName() < b->getName();
+        }
+
+        typedef BoundingVolumeHierarchy::ObjectList ObjectList;
+        typedef BoundingVolumeHierarchy::ObjectPairList ObjectPairList;
+
+        /// Packets of rays cast by each task of a parallel batch
+        const size_t PACKETS_PER_TASK = 16;
+    }
     //---------------------------------------------------------------------
     DefaultIntersectionSceneQuery::DefaultIntersectionSceneQuery(SceneManager* creator)
     : IntersectionSceneQuery(creator)
@@ -40,74 +58,37 @@ namespace Ogre {
     //---------------------------------------------------------------------
     void DefaultIntersectionSceneQuery::execute(IntersectionSceneQueryListener* listener)
     {
-        // Iterate over all movable types
-        const auto& factories = Root::getSingleton().getMovableObjectFactories();
-        auto factIt = factories.begin();
-        while(factIt != factories.end())
+        // Only the pairs whose bounds intersect in the hierarchy are tested
+        ObjectPairList pairs;
+        mParentSceneMgr->_getSceneQueryBVH()->findPairs(pairs);
+
+        auto passes = [this](const MovableObject* m)
         {
-            const auto& objsA = mParentSceneMgr->getMovableObjects((factIt++)->first);
-            auto objItA = objsA.begin();
-            while (objItA != objsA.end())
+            return (m->getTypeFlags() & mQueryTypeMask) && (m->getQueryFlags() & mQueryMask) && m->isInScene();
+        };
+        ObjectPairList results;
+        for (auto& p : pairs)
+        {
+            if (passes(p.first) && passes(p.second) &&
+                p.first->getWorldBoundingBox().intersects(p.second->getWorldBoundingBox()))
             {
-                MovableObject* a = (objItA++)->second;
-                // skip entire section if type doesn't match
-                if (!(a->getTypeFlags() & mQueryTypeMask))
-                    break;
-
-                // Skip if a does not pass the mask
-                if (!(a->getQueryFlags() & mQueryMask) || !a->isInScene())
-                    continue;
-
-                // Check against later objects in the same group
-                auto objItB = objItA;
-                while (objItB != objsA.end())
-                {
-                    MovableObject* b = (objItB++)->second;
-
-                    // Apply mask to b (both must pass)
-                    if ((b->getQueryFlags() & mQueryMask) && b->isInScene())
-                    {
-                        const AxisAlignedBox& box1 = a->getWorldBoundingBox();
-                        const AxisAlignedBox& box2 = b->getWorldBoundingBox();
-
-                        if (box1.intersects(box2))
-                        {
-                            if (!listener->queryResult(a, b)) return;
-                        }
-                    }
-                }
-                // Check  against later groups
-                auto factItLater = factIt;
-                while (factItLater != factories.end())
-                {
-                    for (const auto& objItC :
-                         mParentSceneMgr->getMovableObjects((factItLater++)->first))
-                    {
-                        MovableObject* c = objItC.second;
-                        // skip entire section if type doesn't match
-                        if (!(c->getTypeFlags() & mQueryTypeMask))
-                            break;
-
-                        // Apply mask to c (both must pass)
-                        if ((c->getQueryFlags() & mQueryMask) && c->isInScene())
-                        {
-                            const AxisAlignedBox& box1 = a->getWorldBoundingBox();
-                            const AxisAlignedBox& box2 = c->getWorldBoundingBox();
-
-                            if (box1.intersects(box2))
-                            {
-                                if (!listener->queryResult(a, c)) return;
-                            }
-                        }
-                    }
-
-                }
-
+                if (movableLess(p.second, p.first))
+                    std::swap(p.first, p.second);
+                results.push_back(p);
             }
-
-
         }
 
+        std::sort(results.begin(), results.end(),
+                  [](const ObjectPairList::value_type& a, const ObjectPairList::value_type& b)
+                  {
+                      if (a.first != b.first)
+                          return movableLess(a.first, b.first);
+                      return movableLess(a.second, b.second);
+                  });
+        for (const auto& p : results)
+        {
+            if (!listener->queryResult(p.first, p.second)) return;
+        }
     }
     //---------------------------------------------------------------------
     DefaultAxisAlignedBoxSceneQuery::
@@ -122,21 +103,16 @@ namespace Ogre {
     //---------------------------------------------------------------------
     void DefaultAxisAlignedBoxSceneQuery::execute(SceneQueryListener* listener)
     {
-        // Iterate over all movable types
-        for(const auto& factIt : Root::getSingleton().getMovableObjectFactories())
+        ObjectList objects;
+        mParentSceneMgr->_getSceneQueryBVH()->findObjects(mAABB, objects);
+        std::sort(objects.begin(), objects.end(), movableLess);
+
+        for (auto a : objects)
         {
-            for (const auto& objIt : mParentSceneMgr->getMovableObjects(factIt.first))
+            if ((a->getTypeFlags() & mQueryTypeMask) && (a->getQueryFlags() & mQueryMask) && a->isInScene() &&
+                mAABB.intersects(a->getWorldBoundingBox()))
             {
-                MovableObject* a = objIt.second;
-                // skip whole group if type doesn't match
-                if (!(a->getTypeFlags() & mQueryTypeMask))
-                    break;
-
-                if ((a->getQueryFlags() & mQueryMask) && a->isInScene() &&
-                    mAABB.intersects(a->getWorldBoundingBox()))
-                {
-                    if (!listener->queryResult(a)) return;
-                }
+                if (!listener->queryResult(a)) return;
             }
         }
     }
@@ -152,35 +128,99 @@ namespace Ogre {
     //---------------------------------------------------------------------
     void DefaultRaySceneQuery::execute(RaySceneQueryListener* listener)
     {
-        // Note that because we have no scene partitioning, we actually
-        // perform a complete scene search even if restricted results are
-        // requested; smarter scene manager queries can utilise the paritioning 
-        // of the scene in order to reduce the number of intersection tests 
-        // required to fulfil the query
+        // Only the objects whose bounds the ray hits in the hierarchy are tested, even
+        // if restricted results are requested
+        ObjectList objects;
+        mParentSceneMgr->_getSceneQueryBVH()->findObjects(mRay, objects);
+        std::sort(objects.begin(), objects.end(), movableLess);
 
-        // Iterate over all movable types
-        for(const auto& factIt : Root::getSingleton().getMovableObjectFactories())
+        for (auto a : objects)
         {
-            for (const auto& objIt : mParentSceneMgr->getMovableObjects(factIt.first))
+            if ((a->getTypeFlags() & mQueryTypeMask) && (a->getQueryFlags() & mQueryMask) && a->isInScene())
             {
-                MovableObject* a = objIt.second;
-                // skip whole group if type doesn't match
-                if (!(a->getTypeFlags() & mQueryTypeMask))
-                    break;
+                // Do ray / box test
+                std::pair<bool, Real> result = mRay.intersects(a->getWorldBoundingBox());
 
-                if ((a->getQueryFlags() & mQueryMask) && a->isInScene())
+                if (result.first)
                 {
-                    // Do ray / box test
-                    std::pair<bool, Real> result = mRay.intersects(a->getWorldBoundingBox());
+                    if (!listener->queryResult(a, result.second)) return;
+                }
+            }
+        }
 
-                    if (result.first)
+    }
+    //---------------------------------------------------------------------
+    void DefaultRaySceneQuery::executeBatch(const Ray* rays, size_t count, RaySceneQueryResultEntry* results,
+                                            bool parallel)
+    {
+        const BoundingVolumeHierarchy* bvh = mParentSceneMgr->_getSceneQueryBVH();
+        castPackets(rays, count, results, parallel,
+                    [this, bvh](RayPacket& packet, RaySceneQueryResultEntry* hits)
                     {
-                        if (!listener->queryResult(a, result.second)) return;
-                    }
+                        bvh->findObjects(packet,
+                                         [this, &packet, hits](MovableObject* a, RayPacket::Mask hitRays)
+                                         {
+                                             if ((a->getTypeFlags() & mQueryTypeMask) &&
+                                                 (a->getQueryFlags() & mQueryMask) && a->isInScene())
+                                                 hitObject(packet, hitRays, a, hits);
+                                         });
+                    });
+    }
+    //---------------------------------------------------------------------
+    void DefaultRaySceneQuery::castPackets(const Ray* rays, size_t count, RaySceneQueryResultEntry* results,
+                                           bool parallel, const PacketCaster& cast) const
+    {
+        auto castRange = [rays, count, results, &cast](size_t first, size_t last)
+        {
+            for (size_t p = first; p < last; ++p)
+            {
+                size_t begin = p * RayPacket::WIDTH;
+                RayPacket packet(rays + begin, std::min<size_t>(RayPacket::WIDTH, count - begin));
+                for (size_t i = 0; i < packet.size(); ++i)
+                {
+                    RaySceneQueryResultEntry& result = results[begin + i];
+                    result.distance = 0;
+                    result.movable = NULL;
+                    result.worldFragment = NULL;
                 }
+                cast(packet, results + begin);
             }
-        }
+        };
 
+        size_t numPackets = (count + RayPacket::WIDTH - 1) / RayPacket::WIDTH;
+        if (parallel)
+            Root::getSingleton().getWorkQueue()->parallelFor(0, numPackets, castRange, PACKETS_PER_TASK);
+        else
+            castRange(0, numPackets);
+    }
+    //---------------------------------------------------------------------
+    uint32 DefaultRaySceneQuery::hitObject(RayPacket& packet, uint32 rays, MovableObject* obj,
+                                           RaySceneQueryResultEntry* results) const
+    {
+        // Test the whole packet first, then the rays left one by one, the same way as
+        // execute does
+        const AxisAlignedBox& box = obj->getWorldBoundingBox();
+        rays &= packet.intersects(box);
+
+        uint32 hits = 0;
+        for (size_t i = 0; i < packet.size(); ++i)
+        {
+            if (!(rays & (1 << i)))
+                continue;
+
+            std::pair<bool, Real> result = packet.getRay(i).intersects(box);
+            if (!result.first)
+                continue;
+
+            hits |= 1 << i;
+            if (isNearerHit(obj, result.second, results[i]))
+            {
+                results[i].distance = result.second;
+                results[i].movable = obj;
+                packet.setMaxDistance(i, result.second);
+            }
+        }
+        return hits;
     }
     //---------------------------------------------------------------------
     DefaultSphereSceneQuery::
@@ -194,24 +234,22 @@ namespace Ogre {
     //---------------------------------------------------------------------
     void DefaultSphereSceneQuery::execute(SceneQueryListener* listener)
     {
-        // Iterate over all movable types
-        for(const auto& factIt : Root::getSingleton().getMovableObjectFactories())
+        ObjectList objects;
+        mParentSceneMgr->_getSceneQueryBVH()->findObjects(mSphere, objects);
+        std::sort(objects.begin(), objects.end(), movableLess);
+
+        for (auto a : objects)
         {
-            for (const auto& objIt : mParentSceneMgr->getMovableObjects(factIt.first))
-            {
-                MovableObject* a = objIt.second;
-                // skip whole group if type doesn't match
-                if (!(a->getTypeFlags() & mQueryTypeMask))
-                    break;
-                // Skip unattached
-                if (!a->isInScene() || !(a->getQueryFlags() & mQueryMask))
-                    continue;
+            if (!(a->getTypeFlags() & mQueryTypeMask))
+                continue;
+            // Skip unattached
+            if (!a->isInScene() || !(a->getQueryFlags() & mQueryMask))
+                continue;
 
-                // Do sphere / sphere test
-                if (mSphere.intersects(a->getWorldBoundingSphere()))
-                {
-                    if (!listener->queryResult(a)) return;
-                }
+            // Do sphere / sphere test
+            if (mSphere.intersects(a->getWorldBoundingSphere()))
+            {
+                if (!listener->queryResult(a)) return;
             }
         }
     }
@@ -228,25 +266,23 @@ namespace Ogre {
     //---------------------------------------------------------------------
     void DefaultPlaneBoundedVolumeListSceneQuery::execute(SceneQueryListener* listener)
     {
-        // Iterate over all movable types
-        for(const auto& factIt : Root::getSingleton().getMovableObjectFactories())
+        ObjectList objects;
+        mParentSceneMgr->_getSceneQueryBVH()->findObjects(mVolumes, objects);
+        std::sort(objects.begin(), objects.end(), movableLess);
+
+        for (auto a : objects)
         {
-            for (const auto& objIt : mParentSceneMgr->getMovableObjects(factIt.first))
-            {
-                MovableObject* a = objIt.second;
-                // skip whole group if type doesn't match
-                if (!(a->getTypeFlags() & mQueryTypeMask))
-                    break;
+            if (!(a->getTypeFlags() & mQueryTypeMask))
+                continue;
 
-                for (const auto& vol : mVolumes)
+            for (const auto& vol : mVolumes)
+            {
+                // Do AABB / plane volume test
+                if ((a->getQueryFlags() & mQueryMask) && a->isInScene() &&
+                    vol.intersects(a->getWorldBoundingBox()))
                 {
-                    // Do AABB / plane volume test
-                    if ((a->getQueryFlags() & mQueryMask) && a->isInScene() &&
-                        vol.intersects(a->getWorldBoundingBox()))
-                    {
-                        if (!listener->queryResult(a)) return;
-                        break;
-                    }
+                    if (!listener->queryResult(a)) return;
+                    break;
                 }
             }
         }
@@ -26,6 +26,7 @@ THE SOFTWARE.
 -----------------------------------------------------------------------------
 */
 #include "OgreStableHeaders.h"
+#include "OgreProfileTrace.h"
 
 namespace Ogre
 {
@@ -155,6 +156,8 @@ namespace Ogre
             "DefaultWorkQueue('" << getName() << "')::WorkerFunc - thread " 
             << OGRE_THREAD_CURRENT_ID << " starting.";
 
+        ProfileTrace::setThreadName(getName() + " worker");
+
         // Initialise the thread for RS if necessary
         if (mWorkerRenderSystemAccess)
         {
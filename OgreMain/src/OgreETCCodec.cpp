@@ -68,7 +68,7 @@ namespace Ogre {
         uint8  iHeightLSB;
     } PKMHeader;
 
-    typedef struct {
+    struct KTXHeader {
         uint8     identifier[12];
         uint32    endianness;
         uint32    glType;
@@ -83,7 +83,7 @@ namespace Ogre {
         uint32    numberOfFaces;
         uint32    numberOfMipmapLevels;
         uint32    bytesOfKeyValueData;
-    } KTXHeader;
+    };
 
     //---------------------------------------------------------------------
     ETCCodec* ETCCodec::msPKMInstance = 0;
@@ -129,6 +129,27 @@ namespace Ogre {
     {
     }
     //---------------------------------------------------------------------
+    DataStreamPtr ETCCodec::encode(const Any& input) const
+    {
+        if (mType != "ktx")
+            return Codec::encode(input);
+
+        return encodeKTX(any_cast<Image*>(input));
+    }
+    //---------------------------------------------------------------------
+    void ETCCodec::encodeToFile(const Any& input, const String& outFileName) const
+    {
+        DataStreamPtr strm = encode(input);
+
+        std::ofstream of(outFileName.c_str(), std::ios_base::binary | std::ios_base::out);
+        if (!of)
+            OGRE_EXCEPT(Exception::ERR_CANNOT_WRITE_TO_FILE, "could not open '" + outFileName + "'");
+
+        char buffer[4096];
+        while (!strm->eof())
+            of.write(buffer, strm->read(buffer, sizeof(buffer)));
+    }
+    //---------------------------------------------------------------------
     void ETCCodec::decode(const DataStreamPtr& stream, const Any& output) const
     {
         Image* image = any_cast<Image*>(output);
@@ -215,9 +236,8 @@ namespace Ogre {
         stream->read(image->getData(), image->getSize());
     }
     //---------------------------------------------------------------------
-    void ETCCodec::decodeKTX(const DataStreamPtr& stream, Image* image)
+    PixelFormat ETCCodec::readKTXHeader(const DataStreamPtr& stream, KTXHeader& header)
     {
-        KTXHeader header;
         // Read the KTX header
         stream->read(&header, sizeof(KTXHeader));
 
@@ -323,6 +343,14 @@ namespace Ogre {
             OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS, "Unsupported glInternalFormat");
         }
 
+        return format;
+    }
+    //---------------------------------------------------------------------
+    void ETCCodec::decodeKTX(const DataStreamPtr& stream, Image* image)
+    {
+        KTXHeader header;
+        PixelFormat format = readKTXHeader(stream, header);
+
         image->create(format, header.pixelWidth, header.pixelHeight, 1, header.numberOfFaces,
                       header.numberOfMipmapLevels - 1);
 
@@ -346,4 +374,121 @@ namespace Ogre {
             mipOffset += imageSize;
         }
     }
+    //---------------------------------------------------------------------
+    bool ETCCodec::decodeBands(const DataStreamPtr& stream, BandListener* listener, size_t maxBandSize) const
+    {
+        if (mType != "ktx")
+            return false;
+
+        KTXHeader header;
+        PixelFormat format = readKTXHeader(stream, header);
+
+        // the faces of a level are interleaved
+        if (header.numberOfFaces != 1)
+            return false;
+
+        // only formats with 4x4 blocks can be split into rows
+        switch (format)
+        {
+        case PF_ETC1_RGB8:
+        case PF_ETC2_RGB8:
+        case PF_ETC2_RGBA8:
+        case PF_ETC2_RGB8A1:
+        case PF_ATC_RGB:
+        case PF_ATC_RGBA_EXPLICIT_ALPHA:
+        case PF_ATC_RGBA_INTERPOLATED_ALPHA:
+        case PF_DXT1:
+        case PF_DXT3:
+        case PF_DXT5:
+        case PF_R11G11B10_FLOAT:
+            break;
+        default:
+            return false;
+        }
+
+        uint32 numMipmaps = header.numberOfMipmapLevels - 1;
+        if (!listener->imageHeaderDecoded(header.pixelWidth, header.pixelHeight, format, numMipmaps))
+            return false;
+
+        stream->skip(header.bytesOfKeyValueData);
+
+        uint32 width = header.pixelWidth, height = header.pixelHeight;
+        for (uint32 level = 0; level <= numMipmaps; ++level)
+        {
+            uint32 imageSize = 0;
+            stream->read(&imageSize, sizeof(uint32));
+            readBands(stream, listener, level, width, height, format, maxBandSize);
+            width = std::max(width / 2, 1u);
+            height = std::max(height / 2, 1u);
+        }
+        return true;
+    }
+    //---------------------------------------------------------------------
+    DataStreamPtr ETCCodec::encodeKTX(const Image* image)
+    {
+        KTXHeader header = {};
+        const uint8 KTXFileIdentifier[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x31, 0x31, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+        memcpy(header.identifier, KTXFileIdentifier, sizeof(KTXFileIdentifier));
+        header.endianness = KTX_ENDIAN_REF;
+
+        const uint32 GL_RGB = 0x1907, GL_RGBA = 0x1908;
+        header.glBaseInternalFormat = GL_RGBA;
+        switch (image->getFormat())
+        {
+        case PF_ETC1_RGB8:
+            header.glInternalFormat = 0x8D64; // GL_ETC1_RGB8_OES
+            header.glBaseInternalFormat = GL_RGB;
+            break;
+        case PF_ETC2_RGB8:
+            header.glInternalFormat = 37492; // GL_COMPRESSED_RGB8_ETC2
+            header.glBaseInternalFormat = GL_RGB;
+            break;
+        case PF_ETC2_RGBA8:
+            header.glInternalFormat = 37496; // GL_COMPRESSED_RGBA8_ETC2_EAC
+            break;
+        case PF_ETC2_RGB8A1:
+            header.glInternalFormat = 37494; // GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2
+            break;
+        case PF_DXT1:
+            header.glInternalFormat = 33777;
+            break;
+        case PF_DXT3:
+            header.glInternalFormat = 33778;
+            break;
+        case PF_DXT5:
+            header.glInternalFormat = 33779;
+            break;
+        default:
+            OGRE_EXCEPT(Exception::ERR_NOT_IMPLEMENTED,
+                        "KTX encoding for " + PixelUtil::getFormatName(image->getFormat()) + " not supported");
+        }
+
+        OgreAssert(image->getDepth() == 1, "volume textures are not supported");
+
+        // compressed formats need neither type nor format
+        header.glTypeSize = 1;
+        header.pixelWidth = image->getWidth();
+        header.pixelHeight = image->getHeight();
+        header.numberOfFaces = image->getNumFaces();
+        header.numberOfMipmapLevels = image->getNumMipmaps() + 1;
+
+        size_t totalSize = sizeof(KTXHeader) + image->getSize() + header.numberOfMipmapLevels * sizeof(uint32);
+        auto stream = OGRE_NEW MemoryDataStream(totalSize);
+        stream->write(&header, sizeof(KTXHeader));
+
+        // levels are stored one after the other, each with the faces in turn.
+        // Block sizes are multiples of 4, so there is no padding.
+        for (uint32 mip = 0; mip < header.numberOfMipmapLevels; ++mip)
+        {
+            PixelBox level = image->getPixelBox(0, mip);
+            uint32 imageSize = uint32(PixelUtil::getMemorySize(level.getWidth(), level.getHeight(), 1, level.format));
+            stream->write(&imageSize, sizeof(uint32));
+
+            for (uint32 face = 0; face < header.numberOfFaces; ++face)
+                stream->write(image->getPixelBox(face, mip).data, imageSize);
+        }
+        stream->seek(0);
+
+        return DataStreamPtr(stream);
+    }
 }
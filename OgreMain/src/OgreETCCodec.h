@@ -31,6 +31,8 @@ THE SOFTWARE.
 #include "OgreImageCodec.h"
 
 namespace Ogre {
+    struct KTXHeader;
+
     /** \addtogroup Core
     *  @{
     */
@@ -56,7 +58,12 @@ namespace Ogre {
         ETCCodec(const String &type);
         virtual ~ETCCodec() { }
 
+        /// only supported for ktx, writes the compressed formats that are also read
+        DataStreamPtr encode(const Any& input) const override;
+        void encodeToFile(const Any& input, const String& outFileName) const override;
         void decode(const DataStreamPtr& input, const Any& output) const override;
+        /// only supported for 2D ktx files with 4x4 blocks
+        bool decodeBands(const DataStreamPtr& input, BandListener* listener, size_t maxBandSize) const override;
         String magicNumberToFileExt(const char *magicNumberPtr, size_t maxbytes) const override;
         String getType() const override;
 
@@ -66,7 +73,9 @@ namespace Ogre {
         static void shutdown(void);
     private:
         static void decodePKM(const DataStreamPtr& input, Image* image);
+        static PixelFormat readKTXHeader(const DataStreamPtr& input, KTXHeader& header);
         static void decodeKTX(const DataStreamPtr& input, Image* image);
+        static DataStreamPtr encodeKTX(const Image* image);
 
     };
     /** @} */
@@ -31,6 +31,50 @@ THE SOFTWARE.
 #include "OgreOptimisedUtil.h"
 
 namespace Ogre {
+    namespace {
+        const uint32 UNUSED = ~uint32(0);
+
+        /// finalizer of MurmurHash3
+        inline uint32 mixBits(uint32 h)
+        {
+            h ^= h >> 16;
+            h *= 0x85EBCA6B;
+            h ^= h >> 13;
+            h *= 0xC2B2AE35;
+            h ^= h >> 16;
+            return h;
+        }
+
+        /// bits of f, with -0.0 mapped to 0.0 so both are treated as the same position
+        inline uint32 positionBits(float f)
+        {
+            f += 0.0f;
+            uint32 bits;
+            memcpy(&bits, &f, sizeof(bits));
+            return bits;
+        }
+
+        inline uint32 hashPosition(const Vector3f& v)
+        {
+            return mixBits(mixBits(mixBits(positionBits(v[0])) ^ positionBits(v[1])) ^ positionBits(v[2]));
+        }
+
+        inline bool samePosition(const Vector3f& a, const Vector3f& b)
+        {
+            return positionBits(a[0]) == positionBits(b[0]) && positionBits(a[1]) == positionBits(b[1]) &&
+                   positionBits(a[2]) == positionBits(b[2]);
+        }
+
+        /// power of two table size, keeping the load factor at most 0.5
+        inline size_t tableSize(size_t count)
+        {
+            size_t size = 16;
+            while (size < count * 2)
+                size *= 2;
+            return size;
+        }
+    }
+
     /** Comparator for sorting geometries by vertex set */
     struct geometryLess {
         bool operator()(const EdgeListBuilder::Geometry& a, const EdgeListBuilder::Geometry& b) const
@@ -84,7 +128,7 @@ namespace Ogre {
     }
     //---------------------------------------------------------------------
     EdgeListBuilder::EdgeListBuilder()
-        : mEdgeData(0)
+        : mEdgeData(0), mNumEdgeKeys(0), mNumPendingEdges(0)
     {
     }
     //---------------------------------------------------------------------
@@ -112,6 +156,53 @@ namespace Ogre {
         mGeometryList.push_back(geometry);
     }
     //---------------------------------------------------------------------
+    void EdgeListBuilder::readBuffers(void)
+    {
+        mPositions.resize(mVertexDataList.size());
+        mIndexes.resize(mGeometryList.size());
+
+        for (const auto& g : mGeometryList)
+        {
+            std::vector<Vector3f>& positions = mPositions[g.vertexSet];
+            if (positions.empty())
+            {
+                // locate position element & the buffer to go with it
+                const VertexData* vertexData = mVertexDataList[g.vertexSet];
+                const VertexElement* posElem =
+                    vertexData->vertexDeclaration->findElementBySemantic(VES_POSITION);
+                HardwareVertexBufferSharedPtr vbuf =
+                    vertexData->vertexBufferBinding->getBuffer(posElem->getSource());
+                // lock the buffer for reading
+                HardwareBufferLockGuard vertexLock(vbuf, HardwareBuffer::HBL_READ_ONLY);
+                unsigned char* pVertex = static_cast<unsigned char*>(vertexLock.pData);
+
+                positions.resize(vbuf->getNumVertices());
+                for (auto& v : positions)
+                {
+                    float* pFloat;
+                    posElem->baseVertexPointerToElement(pVertex, &pFloat);
+                    memcpy(v.ptr(), pFloat, sizeof(Vector3f));
+                    pVertex += vbuf->getVertexSize();
+                }
+            }
+
+            const IndexData* indexData = g.indexData;
+            std::vector<uint32>& indexes = mIndexes[g.indexSet];
+            indexes.resize(indexData->indexCount);
+            HardwareBufferLockGuard indexLock(indexData->indexBuffer, HardwareBuffer::HBL_READ_ONLY);
+            if (indexData->indexBuffer->getType() == HardwareIndexBuffer::IT_32BIT)
+            {
+                const uint32* p32Idx = static_cast<uint32*>(indexLock.pData) + indexData->indexStart;
+                std::copy(p32Idx, p32Idx + indexes.size(), indexes.begin());
+            }
+            else
+            {
+                const uint16* p16Idx = static_cast<uint16*>(indexLock.pData) + indexData->indexStart;
+                std::copy(p16Idx, p16Idx + indexes.size(), indexes.begin());
+            }
+        }
+    }
+    //---------------------------------------------------------------------
     EdgeData* EdgeListBuilder::build(void)
     {
         /* Ok, here's the algorithm:
@@ -166,6 +257,9 @@ namespace Ogre {
         the mesh, not the valid hull for the mesh.
         */
 
+        if (mPositions.empty())
+            readBuffers();
+
         // Sort the geometries in the order of vertex set, so we can grouping
         // triangles by vertex set easy.
         std::sort(mGeometryList.begin(), mGeometryList.end(), geometryLess());
@@ -182,6 +276,27 @@ namespace Ogre {
             mEdgeData->edgeGroups[vSet].triCount = 0;
         }
 
+        // Size the tables for all vertices being distinct, and the edges of a closed mesh.
+        // The edge table grows, if there are more.
+        size_t numVertices = 0, numTriangles = 0;
+        for (const auto& positions : mPositions)
+            numVertices += positions.size();
+        for (const auto& g : mGeometryList)
+        {
+            size_t indexCount = mIndexes[g.indexSet].size();
+            if (g.opType == RenderOperation::OT_TRIANGLE_LIST)
+                numTriangles += indexCount / 3;
+            else if (indexCount > 2)
+                numTriangles += indexCount - 2;
+        }
+        mEdgeData->triangles.reserve(numTriangles);
+        mEdgeData->triangleFaceNormals.reserve(numTriangles);
+        mVertices.reserve(numVertices);
+        mVertexTable.assign(tableSize(numVertices), UNUSED);
+        EdgeSlot unusedSlot = {{UNUSED, UNUSED}, UNUSED, UNUSED};
+        mEdgeTable.assign(tableSize(numTriangles * 3 / 2), unusedSlot);
+        mPendingEdges.reserve(numTriangles * 3 / 2);
+
         // Build triangles and edge list
         for (auto& g : mGeometryList)
         {
@@ -192,7 +307,7 @@ namespace Ogre {
         mEdgeData->triangleLightFacings.resize(mEdgeData->triangles.size());
 
         // Record closed, ie the mesh is manifold
-        mEdgeData->isClosed = mEdgeMap.empty();
+        mEdgeData->isClosed = mNumPendingEdges == 0;
 
         return mEdgeData;
     }
@@ -222,20 +337,8 @@ namespace Ogre {
         // The edge group now we are dealing with.
         EdgeData::EdgeGroup& eg = mEdgeData->edgeGroups[vertexSet];
 
-        // locate position element & the buffer to go with it
-        const VertexData* vertexData = mVertexDataList[vertexSet];
-        const VertexElement* posElem = vertexData->vertexDeclaration->findElementBySemantic(VES_POSITION);
-        HardwareVertexBufferSharedPtr vbuf = 
-            vertexData->vertexBufferBinding->getBuffer(posElem->getSource());
-        // lock the buffer for reading
-        HardwareBufferLockGuard vertexLock(vbuf, HardwareBuffer::HBL_READ_ONLY);
-        unsigned char* pBaseVertex = static_cast<unsigned char*>(vertexLock.pData);
-
-        // Get the indexes ready for reading
-        bool idx32bit = (indexData->indexBuffer->getType() == HardwareIndexBuffer::IT_32BIT);
-        HardwareBufferLockGuard indexLock(indexData->indexBuffer, HardwareBuffer::HBL_READ_ONLY);
-        unsigned short* p16Idx = static_cast<unsigned short*>(indexLock.pData) + indexData->indexStart;
-        unsigned int* p32Idx = static_cast<unsigned int*>(indexLock.pData) + indexData->indexStart;
+        const Vector3f* positions = mPositions[vertexSet].data();
+        const uint32* pIdx = mIndexes[indexSet].data();
 
         // Iterate over all the groups of 3 indexes
         unsigned int index[3];
@@ -260,20 +363,10 @@ namespace Ogre {
             if (opType == RenderOperation::OT_TRIANGLE_LIST || t == 0)
             {
                 // Standard 3-index read for tri list or first tri in strip / fan
-                if (idx32bit)
-                {
-                    index[0] = p32Idx[0];
-                    index[1] = p32Idx[1];
-                    index[2] = p32Idx[2];
-                    p32Idx += 3;
-                }
-                else
-                {
-                    index[0] = p16Idx[0];
-                    index[1] = p16Idx[1];
-                    index[2] = p16Idx[2];
-                    p16Idx += 3;
-                }
+                index[0] = pIdx[0];
+                index[1] = pIdx[1];
+                index[2] = pIdx[2];
+                pIdx += 3;
             }
             else
             {
@@ -285,10 +378,7 @@ namespace Ogre {
                 // _anti_ clockwise orientation
                 index[(opType == RenderOperation::OT_TRIANGLE_STRIP) && (t & 1) ? 0 : 1] = index[2];
                 // Read for the last tri index
-                if (idx32bit)
-                    index[2] = *p32Idx++;
-                else
-                    index[2] = *p16Idx++;
+                index[2] = *pIdx++;
             }
 
             Vector3f v[3];
@@ -298,10 +388,7 @@ namespace Ogre {
                 tri.vertIndex[i] = index[i];
 
                 // Retrieve the vertex position
-                unsigned char* pVertex = pBaseVertex + (index[i] * vbuf->getVertexSize());
-                float* pFloat;
-                posElem->baseVertexPointerToElement(pVertex, &pFloat);
-                memcpy(v[i].ptr(), pFloat, sizeof(Vector3f));
+                v[i] = positions[index[i]];
                 // find this vertex in the existing vertex map, or create it
                 tri.sharedVertIndex[i] = 
                     findOrCreateCommonVertex(v[i], vertexSet, indexSet, index[i]);
@@ -342,34 +429,94 @@ namespace Ogre {
         uint32 sharedVertIndex1)
     {
         // Find the existing edge (should be reversed order) on shared vertices
-        EdgeMap::iterator emi = mEdgeMap.find(std::make_pair(sharedVertIndex1, sharedVertIndex0));
-        if (emi != mEdgeMap.end())
+        EdgeSlot& reversed = findEdgeSlot(sharedVertIndex1, sharedVertIndex0);
+        if (reversed.first != UNUSED)
         {
-            // The edge already exist, connect it
-            EdgeData::Edge& e = mEdgeData->edgeGroups[emi->second.first].edges[emi->second.second];
+            // The edge already exist, connect the one waiting longest
+            const PendingEdge& pending = mPendingEdges[reversed.first];
+            EdgeData::Edge& e = mEdgeData->edgeGroups[pending.vertexSet].edges[pending.edgeIndex];
             // update with second side
             e.triIndex[1] = triangleIndex;
             e.degenerate = false;
 
-            // Remove from the edge map, so we never supplied to connect edge again
-            mEdgeMap.erase(emi);
+            // Remove from the waiting edges, so we never supplied to connect edge again
+            reversed.first = pending.next;
+            --mNumPendingEdges;
+            return;
         }
+
+        // Not found, create new edge
+        EdgeData::EdgeList& edges = mEdgeData->edgeGroups[vertexSet].edges;
+        PendingEdge pending = {vertexSet, uint32(edges.size()), UNUSED};
+        uint32 pendingIndex = uint32(mPendingEdges.size());
+        mPendingEdges.push_back(pending);
+        ++mNumPendingEdges;
+
+        EdgeSlot* slot = &findEdgeSlot(sharedVertIndex0, sharedVertIndex1);
+        if (slot->sharedVertIndex[0] == UNUSED)
+        {
+            if ((mNumEdgeKeys + 1) * 2 > mEdgeTable.size())
+            {
+                growEdgeTable();
+                slot = &findEdgeSlot(sharedVertIndex0, sharedVertIndex1);
+            }
+            slot->sharedVertIndex[0] = sharedVertIndex0;
+            slot->sharedVertIndex[1] = sharedVertIndex1;
+            ++mNumEdgeKeys;
+        }
+        // append, so the edges get connected in the order they were created
+        if (slot->first == UNUSED)
+            slot->first = pendingIndex;
         else
+            mPendingEdges[slot->last].next = pendingIndex;
+        slot->last = pendingIndex;
+
+        EdgeData::Edge e;
+        e.degenerate = true; // initialise as degenerate
+
+        // Set only first tri, the other will be completed in connect existing edge
+        e.triIndex[0] = triangleIndex;
+        e.triIndex[1] = static_cast<uint32>(~0);
+        e.sharedVertIndex[0] = sharedVertIndex0;
+        e.sharedVertIndex[1] = sharedVertIndex1;
+        e.vertIndex[0] = vertIndex0;
+        e.vertIndex[1] = vertIndex1;
+        edges.push_back(e);
+    }
+    //---------------------------------------------------------------------
+    EdgeListBuilder::EdgeSlot& EdgeListBuilder::findEdgeSlot(uint32 sharedVertIndex0, uint32 sharedVertIndex1)
+    {
+        size_t mask = mEdgeTable.size() - 1;
+        size_t i = mixBits(sharedVertIndex0 * 0x9E3779B1 ^ sharedVertIndex1) & mask;
+        while (mEdgeTable[i].sharedVertIndex[0] != UNUSED &&
+               (mEdgeTable[i].sharedVertIndex[0] != sharedVertIndex0 ||
+                mEdgeTable[i].sharedVertIndex[1] != sharedVertIndex1))
         {
-            // Not found, create new edge
-            mEdgeMap.emplace(std::make_pair(sharedVertIndex0, sharedVertIndex1),
-                             std::make_pair(vertexSet, uint32(mEdgeData->edgeGroups[vertexSet].edges.size())));
-            EdgeData::Edge e;
-            e.degenerate = true; // initialise as degenerate
-
-            // Set only first tri, the other will be completed in connect existing edge
-            e.triIndex[0] = triangleIndex;
-            e.triIndex[1] = static_cast<uint32>(~0);
-            e.sharedVertIndex[0] = sharedVertIndex0;
-            e.sharedVertIndex[1] = sharedVertIndex1;
-            e.vertIndex[0] = vertIndex0;
-            e.vertIndex[1] = vertIndex1;
-            mEdgeData->edgeGroups[vertexSet].edges.push_back(e);
+            i = (i + 1) & mask;
+        }
+        return mEdgeTable[i];
+    }
+    //---------------------------------------------------------------------
+    void EdgeListBuilder::growEdgeTable()
+    {
+        std::vector<EdgeSlot> oldTable;
+        oldTable.swap(mEdgeTable);
+
+        mNumEdgeKeys = 0;
+        for (const auto& slot : oldTable)
+            mNumEdgeKeys += slot.first != UNUSED;
+
+        // only grow, if dropping the connected keys did not free enough slots
+        size_t size = oldTable.size();
+        if (mNumEdgeKeys * 4 >= size)
+            size *= 2;
+
+        EdgeSlot unusedSlot = {{UNUSED, UNUSED}, UNUSED, UNUSED};
+        mEdgeTable.assign(size, unusedSlot);
+        for (const auto& slot : oldTable)
+        {
+            if (slot.first != UNUSED)
+                findEdgeSlot(slot.sharedVertIndex[0], slot.sharedVertIndex[1]) = slot;
         }
     }
     //---------------------------------------------------------------------
@@ -379,11 +526,16 @@ namespace Ogre {
         // Because the algorithm doesn't care about manifold or not, we just identifying
         // the common vertex by EXACT same position.
         // Hint: We can use quantize method for welding almost same position vertex fastest.
-        std::pair<CommonVertexMap::iterator, bool> inserted = mCommonVertexMap.emplace(vec, mVertices.size());
-        if (!inserted.second)
+        size_t mask = mVertexTable.size() - 1;
+        size_t i = hashPosition(vec) & mask;
+        while (mVertexTable[i] != UNUSED)
         {
-            // Already existing, return old one
-            return inserted.first->second;
+            if (samePosition(mVertices[mVertexTable[i]].position, vec))
+            {
+                // Already existing, return old one
+                return mVertexTable[i];
+            }
+            i = (i + 1) & mask;
         }
         // Not found, insert
         CommonVertex newCommon;
@@ -393,6 +545,7 @@ namespace Ogre {
         newCommon.indexSet = indexSet;
         newCommon.originalIndex = originalIndex;
         mVertices.push_back(newCommon);
+        mVertexTable[i] = newCommon.index;
         return newCommon.index;
     }
     //---------------------------------------------------------------------
@@ -0,0 +1,297 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "OgreStableHeaders.h"
+#include "OgreEngineStatistics.h"
+
+#include <chrono>
+#include <fstream>
+
+namespace Ogre {
+
+    namespace
+    {
+        const char* builtinNames[EngineStatistics::SC_BUILTIN_COUNT] = {
+            "visible_objects",
+            "culled_objects",
+            "culled_nodes",
+            "set_pass",
+            "auto_param_uploads",
+            "buffer_lock_bytes",
+            "shader_cache_misses",
+            "resource_loads",
+            "resource_load_us",
+            "workqueue_tasks",
+            "workqueue_latency_us",
+            "program_changes",
+            "texture_changes",
+            "blend_changes"
+        };
+
+        struct ThreadCounters
+        {
+            /// Counted since the thread started, only written by the owning thread
+            std::atomic<uint64> values[EngineStatistics::MAX_COUNTERS];
+
+            ThreadCounters()
+            {
+                for (auto& v : values)
+                    v.store(0, std::memory_order_relaxed);
+            }
+        };
+
+        struct Registry
+        {
+            OGRE_WQ_MUTEX(mutex);
+            /// Kept after the threads finished, as their counts were not all sampled yet
+            std::vector<std::unique_ptr<ThreadCounters>> threads;
+            std::vector<String> names;
+            /// Sum of the threads at the last sample
+            uint64 sampled[EngineStatistics::MAX_COUNTERS];
+            uint64 totals[EngineStatistics::MAX_COUNTERS];
+            EngineStatistics::SampleList history;
+            size_t historySize;
+            uint64 lastSampleTime;
+
+            Registry() : names(builtinNames, builtinNames + EngineStatistics::SC_BUILTIN_COUNT),
+                historySize(300), lastSampleTime(0)
+            {
+                names.reserve(EngineStatistics::MAX_COUNTERS);
+                std::fill(std::begin(sampled), std::end(sampled), 0);
+                std::fill(std::begin(totals), std::end(totals), 0);
+            }
+        };
+
+        Registry& registry()
+        {
+            static Registry reg;
+            return reg;
+        }
+
+        // owned by the registry
+        thread_local ThreadCounters* tlsCounters = NULL;
+    }
+
+    std::atomic<bool> EngineStatistics::msEnabled(false);
+    //-----------------------------------------------------------------------
+    void EngineStatistics::setEnabled(bool enabled)
+    {
+        msEnabled.store(enabled);
+    }
+    //-----------------------------------------------------------------------
+    EngineStatistics::CounterId EngineStatistics::registerCounter(const String& name)
+    {
+        OgreAssert(!name.empty() && name.find_first_of("\",\\\n\r") == String::npos,
+                   "counter names must be usable in CSV and JSON");
+        Registry& reg = registry();
+        OGRE_WQ_LOCK_MUTEX(reg.mutex);
+        auto it = std::find(reg.names.begin(), reg.names.end(), name);
+        if (it != reg.names.end())
+            return CounterId(it - reg.names.begin());
+
+        OgreAssert(reg.names.size() < MAX_COUNTERS, "too many counters");
+        reg.names.push_back(name);
+        return CounterId(reg.names.size() - 1);
+    }
+    //-----------------------------------------------------------------------
+    size_t EngineStatistics::getCounterCount(void)
+    {
+        Registry& reg = registry();
+        OGRE_WQ_LOCK_MUTEX(reg.mutex);
+        return reg.names.size();
+    }
+    //-----------------------------------------------------------------------
+    const String& EngineStatistics::getCounterName(CounterId id)
+    {
+        Registry& reg = registry();
+        OGRE_WQ_LOCK_MUTEX(reg.mutex);
+        OgreAssert(id < reg.names.size(), "unknown counter");
+        // stays valid, as the names are only appended to their reserved storage
+        return reg.names[id];
+    }
+    //-----------------------------------------------------------------------
+    void EngineStatistics::_add(CounterId id, uint64 value)
+    {
+        assert(id < MAX_COUNTERS);
+        ThreadCounters* counters = tlsCounters;
+        if (!counters)
+        {
+            Registry& reg = registry();
+            OGRE_WQ_LOCK_MUTEX(reg.mutex);
+            reg.threads.emplace_back(new ThreadCounters);
+            counters = tlsCounters = reg.threads.back().get();
+        }
+        // only this thread writes, so no read-modify-write is needed
+        std::atomic<uint64>& counter = counters->values[id];
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+    //-----------------------------------------------------------------------
+    uint64 EngineStatistics::getMicroseconds(void)
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+    //-----------------------------------------------------------------------
+    void EngineStatistics::_sampleFrame(unsigned long frame)
+    {
+        if (!isEnabled())
+            return;
+
+        Registry& reg = registry();
+        OGRE_WQ_LOCK_MUTEX(reg.mutex);
+
+        uint64 now = getMicroseconds();
+        Sample sample;
+        sample.frame = frame;
+        sample.duration = reg.lastSampleTime ? now - reg.lastSampleTime : 0;
+        sample.values.resize(reg.names.size());
+        reg.lastSampleTime = now;
+
+        for (size_t i = 0; i < sample.values.size(); ++i)
+        {
+            uint64 sum = 0;
+            for (auto& t : reg.threads)
+                sum += t->values[i].load(std::memory_order_relaxed);
+            sample.values[i] = sum - reg.sampled[i];
+            reg.sampled[i] = sum;
+            reg.totals[i] += sample.values[i];
+        }
+
+        if (reg.history.size() == reg.historySize)
+            reg.history.pop_front();
+        reg.history.push_back(std::move(sample));
+    }
+    //-----------------------------------------------------------------------
+    uint64 EngineStatistics::getFrameValue(CounterId id)
+    {
+        Registry& reg = registry();
+        OGRE_WQ_LOCK_MUTEX(reg.mutex);
+        if (reg.history.empty() || id >= reg.history.back().values.size())
+            return 0;
+        return reg.history.back().values[id];
+    }
+    //-----------------------------------------------------------------------
+    uint64 EngineStatistics::getTotalValue(CounterId id)
+    {
+        OgreAssert(id < MAX_COUNTERS, "unknown counter");
+        Registry& reg = registry();
+        OGRE_WQ_LOCK_MUTEX(reg.mutex);
+        return reg.totals[id];
+    }
+    //-----------------------------------------------------------------------
+    void EngineStatistics::setHistorySize(size_t frames)
+    {
+        Registry& reg = registry();
+        OGRE_WQ_LOCK_MUTEX(reg.mutex);
+        reg.historySize = std::max<size_t>(frames, 1);
+        while (reg.history.size() > reg.historySize)
+            reg.history.pop_front();
+    }
+    //-----------------------------------------------------------------------
+    EngineStatistics::SampleList EngineStatistics::getHistory(void)
+    {
+        Registry& reg = registry();
+        OGRE_WQ_LOCK_MUTEX(reg.mutex);
+        return reg.history;
+    }
+    //-----------------------------------------------------------------------
+    void EngineStatistics::reset(void)
+    {
+        Registry& reg = registry();
+        OGRE_WQ_LOCK_MUTEX(reg.mutex);
+        // the thread counters are cumulative, what they counted so far is dropped by the next sample
+        reg.history.clear();
+        std::fill(std::begin(reg.totals), std::end(reg.totals), 0);
+        for (size_t i = 0; i < MAX_COUNTERS; ++i)
+        {
+            uint64 sum = 0;
+            for (auto& t : reg.threads)
+                sum += t->values[i].load(std::memory_order_relaxed);
+            reg.sampled[i] = sum;
+        }
+        reg.lastSampleTime = 0;
+    }
+    //-----------------------------------------------------------------------
+    void EngineStatistics::writeCSV(std::ostream& os)
+    {
+        Registry& reg = registry();
+        OGRE_WQ_LOCK_MUTEX(reg.mutex);
+
+        os << "frame,duration_us";
+        for (const auto& name : reg.names)
+            os << ',' << name;
+        os << '\n';
+
+        for (const auto& s : reg.history)
+        {
+            os << s.frame << ',' << s.duration;
+            for (size_t i = 0; i < reg.names.size(); ++i)
+                os << ',' << (i < s.values.size() ? s.values[i] : 0);
+            os << '\n';
+        }
+    }
+    //-----------------------------------------------------------------------
+    void EngineStatistics::writeJSON(std::ostream& os)
+    {
+        Registry& reg = registry();
+        OGRE_WQ_LOCK_MUTEX(reg.mutex);
+
+        os << "{\"totals\":{";
+        for (size_t i = 0; i < reg.names.size(); ++i)
+            os << (i ? "," : "") << '"' << reg.names[i] << "\":" << reg.totals[i];
+        os << "},\n\"frames\":[";
+
+        const char* separator = "\n";
+        for (const auto& s : reg.history)
+        {
+            os << separator << "{\"frame\":" << s.frame << ",\"duration_us\":" << s.duration;
+            for (size_t i = 0; i < s.values.size(); ++i)
+                os << ",\"" << reg.names[i] << "\":" << s.values[i];
+            os << '}';
+            separator = ",\n";
+        }
+        os << "\n]}\n";
+    }
+    //-----------------------------------------------------------------------
+    void EngineStatistics::exportCSV(const String& filename)
+    {
+        std::ofstream file(filename.c_str());
+        if (!file)
+            OGRE_EXCEPT(Exception::ERR_CANNOT_WRITE_TO_FILE, "Cannot open '" + filename + "' for writing",
+                        "EngineStatistics::exportCSV");
+        writeCSV(file);
+    }
+    //-----------------------------------------------------------------------
+    void EngineStatistics::exportJSON(const String& filename)
+    {
+        std::ofstream file(filename.c_str());
+        if (!file)
+            OGRE_EXCEPT(Exception::ERR_CANNOT_WRITE_TO_FILE, "Cannot open '" + filename + "' for writing",
+                        "EngineStatistics::exportJSON");
+        writeJSON(file);
+    }
+}
@@ -0,0 +1,367 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "OgreStableHeaders.h"
+#include "OgreGeometryCodec.h"
+#include "OgreSIMDHelper.h"
+
+#if __OGRE_HAVE_SSE && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define OGRE_GEOMETRYCODEC_SSE2 1
+#include <emmintrin.h>
+#else
+#define OGRE_GEOMETRYCODEC_SSE2 0
+#endif
+
+namespace Ogre {
+namespace {
+    const uchar VERTEX_HEADER = 0xA1;
+    const uchar INDEX_HEADER = 0xB1;
+
+    const size_t GROUP_SIZE = 16;
+    const size_t BLOCK_MAX_VERTICES = 256;
+    const size_t BLOCK_MAX_BYTES = 8192;
+    /// bytes per group, for each of the 2 bit modes
+    const size_t GROUP_BYTES[4] = {0, 4, 8, 16};
+
+    size_t getBlockSize(size_t vertexSize)
+    {
+        size_t size = std::min(BLOCK_MAX_VERTICES, BLOCK_MAX_BYTES / vertexSize);
+        return std::max(GROUP_SIZE, size & ~(GROUP_SIZE - 1));
+    }
+
+    uchar zigzag8(uchar d) { return uchar((d << 1) ^ (int8(d) >> 7)); }
+    uint32 zigzag32(uint32 d) { return (d << 1) ^ uint32(int32(d) >> 31); }
+    uint32 unzigzag32(uint32 z) { return (z >> 1) ^ (0 - (z & 1)); }
+
+    /// the largest value of the 2 and 4 bit modes marks a delta stored in a byte after the group
+    const uchar ESCAPE[4] = {0, 3, 15, 0};
+
+    size_t getGroupSize(const uchar* z, int mode)
+    {
+        if (mode == 0)
+            return std::count(z, z + GROUP_SIZE, 0) == GROUP_SIZE ? 0 : ~size_t(0);
+        if (mode == 3)
+            return GROUP_SIZE;
+        return GROUP_BYTES[mode] + std::count_if(z, z + GROUP_SIZE, [mode](uchar v) { return v >= ESCAPE[mode]; });
+    }
+
+    void encodeGroup(std::vector<uchar>& dst, const uchar* z, int mode)
+    {
+        uchar data[GROUP_SIZE] = {};
+        switch (mode)
+        {
+        case 1:
+            for (size_t i = 0; i < GROUP_SIZE; i++)
+                data[i % 4] |= std::min(z[i], ESCAPE[1]) << (i / 4 * 2);
+            break;
+        case 2:
+            for (size_t i = 0; i < GROUP_SIZE; i++)
+                data[i % 8] |= std::min(z[i], ESCAPE[2]) << (i / 8 * 4);
+            break;
+        case 3:
+            memcpy(data, z, GROUP_SIZE);
+            break;
+        }
+        dst.insert(dst.end(), data, data + GROUP_BYTES[mode]);
+
+        if (mode == 1 || mode == 2)
+        {
+            for (size_t i = 0; i < GROUP_SIZE; i++)
+                if (z[i] >= ESCAPE[mode])
+                    dst.push_back(z[i]);
+        }
+    }
+
+    /** unpacks a group of zigzag deltas and adds them up, starting from last
+    @return the end of the group, or NULL if it is truncated
+    */
+    const uchar* decodeGroup(const uchar* src, const uchar* end, int mode, uchar& last, uchar* out)
+    {
+        if (size_t(end - src) < GROUP_BYTES[mode])
+            return NULL;
+#if OGRE_GEOMETRYCODEC_SSE2
+        __m128i z;
+        switch (mode)
+        {
+        case 0:
+            z = _mm_setzero_si128();
+            break;
+        case 1:
+        {
+            int packed;
+            memcpy(&packed, src, sizeof(packed));
+            __m128i x = _mm_cvtsi32_si128(packed);
+            __m128i mask = _mm_set1_epi8(3);
+            __m128i v0 = _mm_and_si128(x, mask);
+            __m128i v1 = _mm_and_si128(_mm_srli_epi16(x, 2), mask);
+            __m128i v2 = _mm_and_si128(_mm_srli_epi16(x, 4), mask);
+            __m128i v3 = _mm_and_si128(_mm_srli_epi16(x, 6), mask);
+            z = _mm_unpacklo_epi64(_mm_unpacklo_epi32(v0, v1), _mm_unpacklo_epi32(v2, v3));
+            break;
+        }
+        case 2:
+        {
+            __m128i x = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src));
+            __m128i mask = _mm_set1_epi8(15);
+            z = _mm_unpacklo_epi64(_mm_and_si128(x, mask), _mm_and_si128(_mm_srli_epi16(x, 4), mask));
+            break;
+        }
+        default:
+            z = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+            break;
+        }
+        src += GROUP_BYTES[mode];
+
+        if (mode == 1 || mode == 2)
+        {
+            // patch in the escaped deltas
+            int escapes = _mm_movemask_epi8(_mm_cmpeq_epi8(z, _mm_set1_epi8(char(ESCAPE[mode]))));
+            if (escapes)
+            {
+                uchar values[GROUP_SIZE];
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(values), z);
+                for (size_t i = 0; i < GROUP_SIZE; i++)
+                {
+                    if (!(escapes & (1 << i)))
+                        continue;
+                    if (src == end)
+                        return NULL;
+                    values[i] = *src++;
+                }
+                z = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values));
+            }
+        }
+
+        // unzigzag: (z >> 1) ^ -(z & 1)
+        __m128i one = _mm_set1_epi8(1);
+        __m128i d = _mm_xor_si128(_mm_and_si128(_mm_srli_epi16(z, 1), _mm_set1_epi8(0x7f)),
+                                  _mm_sub_epi8(_mm_setzero_si128(), _mm_and_si128(z, one)));
+        // inclusive prefix sum
+        d = _mm_add_epi8(d, _mm_slli_si128(d, 1));
+        d = _mm_add_epi8(d, _mm_slli_si128(d, 2));
+        d = _mm_add_epi8(d, _mm_slli_si128(d, 4));
+        d = _mm_add_epi8(d, _mm_slli_si128(d, 8));
+        d = _mm_add_epi8(d, _mm_set1_epi8(char(last)));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), d);
+        last = out[GROUP_SIZE - 1];
+#else
+        const uchar* data = src;
+        src += GROUP_BYTES[mode];
+        for (size_t i = 0; i < GROUP_SIZE; i++)
+        {
+            uchar z = 0;
+            switch (mode)
+            {
+            case 1:
+                z = (data[i % 4] >> (i / 4 * 2)) & 3;
+                break;
+            case 2:
+                z = (data[i % 8] >> (i / 8 * 4)) & 15;
+                break;
+            case 3:
+                z = data[i];
+                break;
+            }
+            if ((mode == 1 || mode == 2) && z == ESCAPE[mode])
+            {
+                if (src == end)
+                    return NULL;
+                z = *src++;
+            }
+            last += uchar((z >> 1) ^ (0 - (z & 1)));
+            out[i] = last;
+        }
+#endif
+        return src;
+    }
+
+    void writeVarint(std::vector<uchar>& dst, uint64 v)
+    {
+        while (v >= 0x80)
+        {
+            dst.push_back(uchar(v | 0x80));
+            v >>= 7;
+        }
+        dst.push_back(uchar(v));
+    }
+
+    bool readVarint(const uchar*& src, const uchar* end, uint64& v)
+    {
+        v = 0;
+        for (int shift = 0; shift < 64 && src < end; shift += 7)
+        {
+            uchar b = *src++;
+            v |= uint64(b & 0x7f) << shift;
+            if (!(b & 0x80))
+                return true;
+        }
+        return false;
+    }
+}
+    //---------------------------------------------------------------------
+    void GeometryCodec::encodeVertexBuffer(std::vector<uchar>& dst, const uchar* vertices, size_t vertexCount,
+                                           size_t vertexSize)
+    {
+        dst.push_back(VERTEX_HEADER);
+        if (!vertexCount || !vertexSize)
+            return;
+
+        // the first vertex is stored as is, and is the base of the first deltas
+        dst.insert(dst.end(), vertices, vertices + vertexSize);
+        std::vector<uchar> last(vertices, vertices + vertexSize);
+
+        size_t blockSize = getBlockSize(vertexSize);
+        std::vector<uchar> deltas(blockSize);
+
+        for (size_t blockStart = 0; blockStart < vertexCount; blockStart += blockSize)
+        {
+            size_t count = std::min(blockSize, vertexCount - blockStart);
+            size_t groups = (count + GROUP_SIZE - 1) / GROUP_SIZE;
+
+            for (size_t k = 0; k < vertexSize; k++)
+            {
+                std::fill(deltas.begin(), deltas.end(), 0);
+                uchar prev = last[k];
+                for (size_t i = 0; i < count; i++)
+                {
+                    uchar v = vertices[(blockStart + i) * vertexSize + k];
+                    deltas[i] = zigzag8(uchar(v - prev));
+                    prev = v;
+                }
+                last[k] = prev;
+
+                // 2 bit headers, 4 groups per byte, followed by the group data
+                size_t headerPos = dst.size();
+                dst.resize(dst.size() + (groups + 3) / 4, 0);
+                for (size_t g = 0; g < groups; g++)
+                {
+                    const uchar* z = &deltas[g * GROUP_SIZE];
+                    int mode = 0;
+                    for (int m = 1; m < 4; m++)
+                    {
+                        if (getGroupSize(z, m) < getGroupSize(z, mode))
+                            mode = m;
+                    }
+                    dst[headerPos + g / 4] |= uchar(mode << (g % 4 * 2));
+                    encodeGroup(dst, z, mode);
+                }
+            }
+        }
+    }
+    //---------------------------------------------------------------------
+    bool GeometryCodec::decodeVertexBuffer(uchar* vertices, size_t vertexCount, size_t vertexSize,
+                                           const uchar* src, size_t srcSize)
+    {
+        const uchar* end = src + srcSize;
+        if (src == end || *src++ != VERTEX_HEADER)
+            return false;
+        if (!vertexCount || !vertexSize)
+            return src == end;
+
+        if (size_t(end - src) < vertexSize)
+            return false;
+        std::vector<uchar> last(src, src + vertexSize);
+        src += vertexSize;
+
+        size_t blockSize = getBlockSize(vertexSize);
+        std::vector<uchar> column(blockSize);
+
+        for (size_t blockStart = 0; blockStart < vertexCount; blockStart += blockSize)
+        {
+            size_t count = std::min(blockSize, vertexCount - blockStart);
+            size_t groups = (count + GROUP_SIZE - 1) / GROUP_SIZE;
+            uchar* dst = vertices + blockStart * vertexSize;
+
+            for (size_t k = 0; k < vertexSize; k++)
+            {
+                const uchar* header = src;
+                src += (groups + 3) / 4;
+                if (src > end)
+                    return false;
+
+                for (size_t g = 0; g < groups; g++)
+                {
+                    int mode = (header[g / 4] >> (g % 4 * 2)) & 3;
+                    src = decodeGroup(src, end, mode, last[k], &column[g * GROUP_SIZE]);
+                    if (!src)
+                        return false;
+                }
+                // the padding deltas are 0, so last[k] is the value of the last vertex
+
+                for (size_t i = 0; i < count; i++)
+                    dst[i * vertexSize + k] = column[i];
+            }
+        }
+
+        return src == end;
+    }
+    //---------------------------------------------------------------------
+    void GeometryCodec::encodeIndexBuffer(std::vector<uchar>& dst, const void* indexes, size_t indexCount,
+                                          bool use32bit)
+    {
+        dst.push_back(INDEX_HEADER);
+
+        uint32 next = 0, prev = 0;
+        for (size_t i = 0; i < indexCount; i++)
+        {
+            uint32 v = use32bit ? static_cast<const uint32*>(indexes)[i] : static_cast<const uint16*>(indexes)[i];
+            writeVarint(dst, v == next ? 0 : uint64(zigzag32(v - prev)) + 1);
+            next = std::max(next, v + 1);
+            prev = v;
+        }
+    }
+    //---------------------------------------------------------------------
+    bool GeometryCodec::decodeIndexBuffer(void* indexes, size_t indexCount, bool use32bit, const uchar* src,
+                                          size_t srcSize)
+    {
+        const uchar* end = src + srcSize;
+        if (src == end || *src++ != INDEX_HEADER)
+            return false;
+
+        uint32 maxIndex = use32bit ? 0xFFFFFFFF : 0xFFFF;
+        uint32 next = 0, prev = 0;
+        for (size_t i = 0; i < indexCount; i++)
+        {
+            uint64 code;
+            if (!readVarint(src, end, code) || code > 0x100000000ull)
+                return false;
+            uint32 v = code == 0 ? next : prev + unzigzag32(uint32(code - 1));
+            if (v > maxIndex)
+                return false;
+
+            if (use32bit)
+                static_cast<uint32*>(indexes)[i] = v;
+            else
+                static_cast<uint16*>(indexes)[i] = uint16(v);
+            next = std::max(next, v + 1);
+            prev = v;
+        }
+
+        return src == end;
+    }
+}
@@ -0,0 +1,78 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef __GeometryCodec_H__
+#define __GeometryCodec_H__
+
+#include "OgrePrerequisites.h"
+
+namespace Ogre {
+
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup Resources
+    *  @{
+    */
+    /** Lossless compression of vertex and index buffers, in the style of the meshoptimizer codec.
+
+        Vertex buffers are split into blocks of up to 256 vertices. In every block, each byte of the
+        vertex is delta coded against the same byte of the previous vertex and zigzag coded. The
+        deltas are stored in groups of 16, using 0, 2, 4 or 8 bits per delta, as selected by a 2 bit
+        header per group. The largest 2 and 4 bit value escapes to a full byte stored after the group,
+        so that a few outliers do not widen the whole group. This works best on vertices which are sorted by their first use, see
+        MeshOptimiser.
+    @par
+        Index buffers are coded as variable length integers: 0 for the next unused vertex, otherwise
+        the zigzag coded delta to the previous index.
+    */
+    class _OgrePrivate GeometryCodec
+    {
+    public:
+        /// Appends the compressed vertices to dst
+        static void encodeVertexBuffer(std::vector<uchar>& dst, const uchar* vertices, size_t vertexCount,
+                                       size_t vertexSize);
+        /** Decompresses the vertices, using SSE2 where available
+        @return false if the data is corrupt
+        */
+        static bool decodeVertexBuffer(uchar* vertices, size_t vertexCount, size_t vertexSize,
+                                       const uchar* src, size_t srcSize);
+
+        /// Appends the compressed indexes to dst
+        static void encodeIndexBuffer(std::vector<uchar>& dst, const void* indexes, size_t indexCount,
+                                      bool use32bit);
+        /** Decompresses the indexes
+        @return false if the data is corrupt
+        */
+        static bool decodeIndexBuffer(void* indexes, size_t indexCount, bool use32bit, const uchar* src,
+                                      size_t srcSize);
+    };
+    /** @} */
+    /** @} */
+}
+
+#endif
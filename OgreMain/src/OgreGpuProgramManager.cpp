@@ -32,6 +32,7 @@ THE SOFTWARE.
 #include "OgreHighLevelGpuProgramManager.h"
 #include "OgreUnifiedHighLevelGpuProgram.h"
 #include "OgreStreamSerialiser.h"
+#include "OgreEngineStatistics.h"
 
 namespace Ogre {
 namespace {
@@ -303,7 +304,10 @@ namespace {
     //---------------------------------------------------------------------
     bool GpuProgramManager::isMicrocodeAvailableInCache( uint32 id ) const
     {
-        return mMicrocodeCache.find(id) != mMicrocodeCache.end();
+        if (mMicrocodeCache.find(id) != mMicrocodeCache.end())
+            return true;
+        EngineStatistics::add(EngineStatistics::SC_SHADER_CACHE_MISSES);
+        return false;
     }
     //---------------------------------------------------------------------
     const GpuProgramManager::Microcode & GpuProgramManager::getMicrocodeFromCache( uint32 id ) const
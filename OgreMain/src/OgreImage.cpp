@@ -28,7 +28,11 @@ THE SOFTWARE.
 #include "OgreStableHeaders.h"
 #include "OgreImage.h"
 #include "OgreImageCodec.h"
+#include "OgreWorkQueue.h"
+#include "OgrePlatformInformation.h"
+#include "OgreSIMDHelper.h"
 #include "OgreImageResampler.h"
+#include "OgreBlockCompressor.h"
 
 namespace Ogre {
     //-----------------------------------------------------------------------------
@@ -470,7 +474,137 @@ namespace Ogre {
                 LinearResampler::scale(src, scaled);
             }
             break;
+
+        case FILTER_BOX:
+        case FILTER_KAISER:
+        case FILTER_LANCZOS:
+        {
+            // filter in float RGBA, converting from and to the source formats
+            Image fsrc(PF_FLOAT32_RGBA, src.getWidth(), src.getHeight(), src.getDepth());
+            Image fdst(PF_FLOAT32_RGBA, scaled.getWidth(), scaled.getHeight(), scaled.getDepth());
+            PixelUtil::bulkPixelConversion(src, fsrc.getPixelBox());
+            FilterResampler::scale((const float*)fsrc.getData(), src.getWidth(), src.getHeight(),
+                                   src.getDepth(), (float*)fdst.getData(), scaled.getWidth(),
+                                   scaled.getHeight(), scaled.getDepth(), 1, filter);
+            PixelUtil::bulkPixelConversion(fdst.getPixelBox(), scaled);
+            break;
         }
+        }
+    }
+    //-----------------------------------------------------------------------------
+    static float srgbToLinear(float c)
+    {
+        return c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+    }
+    static float linearToSrgb(float c)
+    {
+        return c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+    }
+    // applies fn to the colour channels of float RGBA data
+    template <typename F> static void transformColour(float* data, size_t numPixels, F fn)
+    {
+        auto transform = [data, fn](size_t first, size_t last) {
+            for (size_t i = first; i < last; i++)
+            {
+                data[i * 4 + 0] = fn(data[i * 4 + 0]);
+                data[i * 4 + 1] = fn(data[i * 4 + 1]);
+                data[i * 4 + 2] = fn(data[i * 4 + 2]);
+            }
+        };
+        if (Root* root = Root::getSingletonPtr())
+            root->getWorkQueue()->parallelFor(0, numPixels, transform, 16384);
+        else
+            transform(0, numPixels);
+    }
+    //-----------------------------------------------------------------------------
+    void Image::generateMipmaps(bool gammaCorrected, Filter filter)
+    {
+        OgreAssert(!PixelUtil::isCompressed(mFormat), "compressed formats are not supported");
+
+        uint32 numMips = Bitwise::mostSignificantBitSet(std::max(std::max(mWidth, mHeight), mDepth));
+        uint32 numFaces = getNumFaces();
+
+        Image result;
+        result.create(mFormat, mWidth, mHeight, mDepth, numFaces, numMips);
+
+        if (filter == FILTER_NEAREST)
+        {
+            for (uint32 face = 0; face < numFaces; face++)
+            {
+                PixelUtil::bulkPixelConversion(getPixelBox(face), result.getPixelBox(face));
+                for (uint32 mip = 1; mip <= numMips; mip++)
+                    scale(result.getPixelBox(face, mip - 1), result.getPixelBox(face, mip), filter);
+            }
+        }
+        else
+        {
+            if (filter == FILTER_LINEAR)
+                filter = FILTER_BOX;
+
+            // all faces of the current level in linear float RGBA
+            uint32 width = mWidth, height = mHeight, depth = mDepth;
+            size_t faceFloats = size_t(width) * height * depth * 4;
+            std::vector<float> level(faceFloats * numFaces), next, encoded;
+            for (uint32 face = 0; face < numFaces; face++)
+            {
+                PixelUtil::bulkPixelConversion(getPixelBox(face), result.getPixelBox(face));
+                PixelUtil::bulkPixelConversion(
+                    getPixelBox(face), PixelBox(width, height, depth, PF_FLOAT32_RGBA, &level[face * faceFloats]));
+            }
+            if (gammaCorrected)
+                transformColour(level.data(), level.size() / 4, srgbToLinear);
+
+            for (uint32 mip = 1; mip <= numMips; mip++)
+            {
+                uint32 nwidth = std::max(1u, width / 2), nheight = std::max(1u, height / 2),
+                       ndepth = std::max(1u, depth / 2);
+                faceFloats = size_t(nwidth) * nheight * ndepth * 4;
+                next.resize(faceFloats * numFaces);
+                // each level is computed from the previous one, which is cheap and barely
+                // distinguishable from filtering the top level with a wider kernel
+                FilterResampler::scale(level.data(), width, height, depth, next.data(), nwidth, nheight,
+                                       ndepth, numFaces, filter);
+                std::swap(level, next);
+                width = nwidth, height = nheight, depth = ndepth;
+
+                float* out = level.data();
+                if (gammaCorrected)
+                {
+                    encoded = level;
+                    transformColour(encoded.data(), encoded.size() / 4, linearToSrgb);
+                    out = encoded.data();
+                }
+                for (uint32 face = 0; face < numFaces; face++)
+                    PixelUtil::bulkPixelConversion(
+                        PixelBox(width, height, depth, PF_FLOAT32_RGBA, out + face * faceFloats),
+                        result.getPixelBox(face, mip));
+            }
+        }
+
+        // take over the buffer of result
+        result.mAutoDelete = false;
+        loadDynamicImage(result.mBuffer, mWidth, mHeight, mDepth, mFormat, true, numFaces, numMips);
+    }
+
+    //-----------------------------------------------------------------------------
+    void Image::compress(PixelFormat format, CompressionQuality quality)
+    {
+        OgreAssert(!PixelUtil::isCompressed(mFormat), "image is compressed already");
+        if (!BlockCompressor::isSupported(format))
+            OGRE_EXCEPT(Exception::ERR_NOT_IMPLEMENTED,
+                        "Compression to " + PixelUtil::getFormatName(format) + " not supported");
+
+        uint32 numFaces = getNumFaces();
+        Image result;
+        result.create(format, mWidth, mHeight, mDepth, numFaces, mNumMipmaps);
+
+        for (uint32 face = 0; face < numFaces; face++)
+            for (uint32 mip = 0; mip <= mNumMipmaps; mip++)
+                BlockCompressor::encode(getPixelBox(face, mip), result.getPixelBox(face, mip), quality);
+
+        // take over the buffer of result
+        result.mAutoDelete = false;
+        loadDynamicImage(result.mBuffer, mWidth, mHeight, mDepth, format, true, numFaces, mNumMipmaps);
     }
 
     //-----------------------------------------------------------------------------    
@@ -0,0 +1,53 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "OgreStableHeaders.h"
+#include "OgreStableHeaders.h"
+#include "OgreImageCodec.h"
+
+namespace Ogre {
+
+    void ImageCodec::readBands(const DataStreamPtr& input, BandListener* listener, uint32 mip, uint32 width,
+                               uint32 height, PixelFormat format, size_t maxBandSize)
+    {
+        // compressed formats are read in rows of 4x4 blocks
+        uint32 rowHeight = PixelUtil::isCompressed(format) ? 4 : 1;
+        size_t rowSize = PixelUtil::getMemorySize(width, rowHeight, 1, format);
+        uint32 bandHeight = uint32(std::max<size_t>(maxBandSize / rowSize, 1)) * rowHeight;
+
+        std::vector<uchar> buffer(PixelUtil::getMemorySize(width, std::min(bandHeight, height), 1, format));
+        for (uint32 top = 0; top < height; top += bandHeight)
+        {
+            uint32 rows = std::min(bandHeight, height - top);
+            PixelBox band(width, rows, 1, format, buffer.data());
+            size_t size = band.getConsecutiveSize();
+            if (input->read(buffer.data(), size) != size)
+                OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS, "unexpected end of " + input->getName());
+            listener->bandDecoded(mip, top, band);
+        }
+    }
+}
@@ -337,6 +337,201 @@ template<unsigned int channels> struct LinearResampler_Byte {
         }
     }
 };
+
+// separable resampler using a box, Kaiser or Lanczos kernel. Works on
+// consecutive PF_FLOAT32_RGBA data, resampling a stack of layers (cubemap
+// faces) independently, one axis after the other.
+struct FilterResampler {
+    // the source pixels contributing to each destination pixel
+    struct Weights {
+        std::vector<size_t> offsets; // first tap of each destination pixel, plus the end
+        std::vector<uint32> indices;
+        std::vector<float> weights;
+    };
+
+    static float sinc(float x) {
+        if (std::abs(x) < 1e-5f)
+            return 1.0f;
+        x *= Math::PI;
+        return std::sin(x) / x;
+    }
+
+    // modified Bessel function of the first kind of order 0
+    static float bessel0(float x) {
+        float sum = 1.0f, term = 1.0f;
+        for (int k = 1; k < 32 && term > sum * 1e-8f; k++) {
+            term *= (x * x * 0.25f) / float(k * k);
+            sum += term;
+        }
+        return sum;
+    }
+
+    // kernel radius in source pixels, before stretching for minification
+    static float getRadius(Image::Filter filter) {
+        return filter == Image::FILTER_BOX ? 0.5f : 3.0f;
+    }
+
+    static float evaluate(Image::Filter filter, float x) {
+        const float radius = 3.0f;
+        if (std::abs(x) >= radius)
+            return 0.0f;
+        if (filter == Image::FILTER_LANCZOS)
+            return sinc(x) * sinc(x / radius);
+
+        // Kaiser window with alpha = 4
+        const float alpha = 4.0f;
+        float t = x / radius;
+        return sinc(x) * bessel0(alpha * std::sqrt(1.0f - t * t)) / bessel0(alpha);
+    }
+
+    static Weights computeWeights(uint32 srcSize, uint32 dstSize, Image::Filter filter) {
+        Weights ret;
+        float scale = float(srcSize) / dstSize;
+        // the kernel is stretched when minifying
+        float support = std::max(scale, 1.0f);
+        float radius = getRadius(filter) * support;
+
+        ret.offsets.push_back(0);
+        for (uint32 i = 0; i < dstSize; i++) {
+            // source pixel j covers [j, j+1)
+            float centre = (i + 0.5f) * scale;
+            int first = int(std::floor(centre - radius));
+            int last = int(std::ceil(centre + radius));
+            size_t start = ret.weights.size();
+            float sum = 0;
+            for (int j = first; j < last; j++) {
+                float w;
+                if (filter == Image::FILTER_BOX)
+                    // area of the source pixel covered by the destination pixel
+                    w = std::min(float(j + 1), centre + radius) - std::max(float(j), centre - radius);
+                else
+                    w = evaluate(filter, (j + 0.5f - centre) / support);
+                if (filter == Image::FILTER_BOX ? w <= 0 : w == 0)
+                    continue;
+                // clamp to edge
+                ret.indices.push_back(uint32(Math::Clamp<int>(j, 0, int(srcSize) - 1)));
+                ret.weights.push_back(w);
+                sum += w;
+            }
+            for (size_t k = start; k < ret.weights.size(); k++)
+                ret.weights[k] /= sum;
+            ret.offsets.push_back(ret.weights.size());
+        }
+        return ret;
+    }
+
+    // runs fn on sub ranges of [0, count) on the worker threads, if there are any
+    template<typename F> static void parallelFor(size_t count, size_t floatsPerItem, const F& fn) {
+        size_t grain = std::max<size_t>(1, 16384 / floatsPerItem);
+        if (Root* root = Root::getSingletonPtr())
+            root->getWorkQueue()->parallelFor(0, count, fn, grain);
+        else
+            fn(0, count);
+    }
+
+    // resamples along the rows
+    static void resampleX(const float* src, uint32 srcWidth, float* dst, uint32 dstWidth, size_t numRows,
+                          const Weights& wt) {
+        parallelFor(numRows, dstWidth * 4, [&](size_t first, size_t last) {
+            for (size_t r = first; r < last; r++) {
+                const float* s = src + r * srcWidth * 4;
+                float* d = dst + r * dstWidth * 4;
+                for (uint32 x = 0; x < dstWidth; x++, d += 4) {
+#if __OGRE_HAVE_SSE || __OGRE_HAVE_NEON
+                    __m128 acc = _mm_setzero_ps();
+                    for (size_t k = wt.offsets[x]; k < wt.offsets[x + 1]; k++)
+                        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(s + wt.indices[k] * 4), _mm_set1_ps(wt.weights[k])));
+                    _mm_storeu_ps(d, acc);
+#else
+                    d[0] = d[1] = d[2] = d[3] = 0;
+                    for (size_t k = wt.offsets[x]; k < wt.offsets[x + 1]; k++) {
+                        const float* p = s + wt.indices[k] * 4;
+                        float w = wt.weights[k];
+                        d[0] += p[0] * w; d[1] += p[1] * w; d[2] += p[2] * w; d[3] += p[3] * w;
+                    }
+#endif
+                }
+            }
+        });
+    }
+
+    // resamples across lines of lineSize floats, which are lineStride floats apart.
+    // numOuter blocks of lines are resampled independently.
+    static void resampleLines(const float* src, size_t srcOuterStride, float* dst, size_t dstOuterStride,
+                              size_t numOuter, uint32 dstCount, size_t lineStride, size_t lineSize,
+                              const Weights& wt) {
+        parallelFor(numOuter * dstCount, lineSize, [&](size_t first, size_t last) {
+            for (size_t item = first; item < last; item++) {
+                size_t outer = item / dstCount;
+                size_t i = item % dstCount;
+                float* d = dst + outer * dstOuterStride + i * lineStride;
+                for (size_t k = wt.offsets[i]; k < wt.offsets[i + 1]; k++) {
+                    const float* s = src + outer * srcOuterStride + wt.indices[k] * lineStride;
+                    float w = wt.weights[k];
+                    bool firstTap = k == wt.offsets[i];
+                    size_t n = 0;
+#if __OGRE_HAVE_SSE || __OGRE_HAVE_NEON
+                    __m128 vw = _mm_set1_ps(w);
+                    for (; n + 4 <= lineSize; n += 4) {
+                        __m128 v = _mm_mul_ps(_mm_loadu_ps(s + n), vw);
+                        _mm_storeu_ps(d + n, firstTap ? v : _mm_add_ps(_mm_loadu_ps(d + n), v));
+                    }
+#endif
+                    for (; n < lineSize; n++)
+                        d[n] = firstTap ? s[n] * w : d[n] + s[n] * w;
+                }
+            }
+        });
+    }
+
+    static void scale(const float* src, uint32 srcWidth, uint32 srcHeight, uint32 srcDepth, float* dst,
+                      uint32 dstWidth, uint32 dstHeight, uint32 dstDepth, size_t numLayers,
+                      Image::Filter filter) {
+        std::vector<float> tmp[2];
+        int cur = 0;
+        const float* in = src;
+        uint32 width = srcWidth, height = srcHeight, depth = srcDepth;
+
+        // the last pass writes to dst
+        int numPasses = (srcWidth != dstWidth) + (srcHeight != dstHeight) + (srcDepth != dstDepth);
+        auto getOutput = [&](size_t numFloats) -> float* {
+            if (--numPasses == 0)
+                return dst;
+            tmp[cur].resize(numFloats);
+            return tmp[cur].data();
+        };
+
+        if (numPasses == 0) {
+            memcpy(dst, src, size_t(srcWidth) * srcHeight * srcDepth * numLayers * 4 * sizeof(float));
+            return;
+        }
+
+        if (width != dstWidth) {
+            float* out = getOutput(size_t(dstWidth) * height * depth * numLayers * 4);
+            resampleX(in, width, out, dstWidth, size_t(height) * depth * numLayers,
+                      computeWeights(width, dstWidth, filter));
+            in = out;
+            cur = 1 - cur;
+            width = dstWidth;
+        }
+        if (height != dstHeight) {
+            float* out = getOutput(size_t(width) * dstHeight * depth * numLayers * 4);
+            resampleLines(in, size_t(width) * height * 4, out, size_t(width) * dstHeight * 4,
+                          size_t(depth) * numLayers, dstHeight, width * 4, width * 4,
+                          computeWeights(height, dstHeight, filter));
+            in = out;
+            cur = 1 - cur;
+            height = dstHeight;
+        }
+        if (depth != dstDepth) {
+            float* out = getOutput(size_t(width) * height * dstDepth * numLayers * 4);
+            size_t sliceSize = size_t(width) * height * 4;
+            resampleLines(in, sliceSize * depth, out, sliceSize * dstDepth, numLayers, dstDepth,
+                          sliceSize, sliceSize, computeWeights(depth, dstDepth, filter));
+        }
+    }
+};
+
 /** @} */
 /** @} */
 
@@ -29,15 +29,32 @@ THE SOFTWARE.
 #include "OgreInstanceBatchHW.h"
 #include "OgreRenderOperation.h"
 #include "OgreInstancedEntity.h"
+#include "OgreOptimisedUtil.h"
 
 namespace Ogre
 {
+    /// Returns the planes a sphere is culled against by Frustum::isVisible
+    static size_t getCullingPlanes( const Camera *camera, Vector4 *planes )
+    {
+        size_t numPlanes = 0;
+        for( unsigned short i = 0; i < 6; ++i )
+        {
+            //Skip far plane if infinite view frustum
+            if( i == FRUSTUM_PLANE_FAR && camera->getFarClipDistance() == 0 )
+                continue;
+
+            const Plane &plane = camera->getFrustumPlane( i );
+            planes[numPlanes++] = Vector4( plane.normal, plane.d );
+        }
+        return numPlanes;
+    }
     InstanceBatchHW::InstanceBatchHW( InstanceManager *creator, MeshPtr &meshReference,
                                         const MaterialPtr &material, size_t instancesPerBatch,
                                         const Mesh::IndexMap *indexToBoneMap, const String &batchName ) :
                 InstanceBatch( creator, meshReference, material, instancesPerBatch,
                                 indexToBoneMap, batchName ),
-                mKeepStatic( false )
+                mKeepStatic( false ),
+                mUploadedInstances( std::numeric_limits<size_t>::max() )
     {
         //Override defaults, so that InstancedEntities don't create a skeleton instance
         mTechnSupportsSkeletal = false;
@@ -142,49 +159,176 @@ namespace Ogre
     //-----------------------------------------------------------------------
     size_t InstanceBatchHW::updateVertexBuffer( Camera *currentCamera )
     {
-        size_t retVal = 0;
+        if( !currentCamera )
+        {
+            //Now lock the vertex buffer and copy the 4x3 matrices of all entities in the scene
+            VertexBufferBinding* binding = mRenderOperation.vertexData->vertexBufferBinding;
+            const ushort bufferIdx = ushort(binding->getBufferCount()-1);
+            HardwareBufferLockGuard vertexLock(binding->getBuffer(bufferIdx), HardwareBuffer::HBL_DISCARD);
+            mUploadedInstances = std::numeric_limits<size_t>::max();
+            return fillVisibleInstances( 0, 0, 0, static_cast<float*>(vertexLock.pData) );
+        }
 
-        //Now lock the vertex buffer and copy the 4x3 matrices, only those who need it!
-        VertexBufferBinding* binding = mRenderOperation.vertexData->vertexBufferBinding; 
-        const ushort bufferIdx = ushort(binding->getBufferCount()-1);
-        HardwareBufferLockGuard vertexLock(binding->getBuffer(bufferIdx), HardwareBuffer::HBL_DISCARD);
-        float *pDest = static_cast<float*>(vertexLock.pData);
-        unsigned char numCustomParams           = mCreator->getNumCustomParams();
-        size_t customParamIdx                   = 0;
+        Vector4 planes[6];
+        const size_t numPlanes = getCullingPlanes( currentCamera, planes );
+        size_t idx = findVisibleInstances( currentCamera, planes, numPlanes );
+        if( idx == std::numeric_limits<size_t>::max() )
+        {
+            if( mCreator->getParallelCulling() )
+            {
+                //Cull the other batches of our manager for this camera as well
+                mCreator->_prepareVisibleInstances( currentCamera );
+                idx = findVisibleInstances( currentCamera, planes, numPlanes );
+            }
+            if( idx == std::numeric_limits<size_t>::max() )
+                idx = prepareVisibleInstances( currentCamera, planes, numPlanes );
+        }
 
-        for (auto *e : mInstancedEntities)
+        const VisibleInstances &visibleInstances = mVisibleInstances[idx];
+        if( idx != mUploadedInstances && visibleInstances.numInstances )
         {
+            //Only upload if the buffer holds the data of a different camera
+            VertexBufferBinding* binding = mRenderOperation.vertexData->vertexBufferBinding;
+            const ushort bufferIdx = ushort(binding->getBufferCount()-1);
+            const HardwareVertexBufferSharedPtr &vertexBuffer = binding->getBuffer(bufferIdx);
+            vertexBuffer->writeData( 0, visibleInstances.numInstances * vertexBuffer->getVertexSize(),
+                                     visibleInstances.data.data(), true );
+            mUploadedInstances = idx;
+        }
+
+        return visibleInstances.numInstances;
+    }
+    //-----------------------------------------------------------------------
+    size_t InstanceBatchHW::fillVisibleInstances( const Camera *camera, const Vector4 *planes,
+                                                  size_t numPlanes, float *pDest ) const
+    {
+        //Test the bounding spheres in chunks, so the scratch memory stays on the stack
+        const size_t chunkSize = 64;
+        OGRE_SIMD_ALIGNED_DECL( Vector4, spheres[chunkSize] );
+        char inScene[chunkSize];
+        char visible[chunkSize];
+
+        const bool cameraRelative = camera && mManager->getCameraRelativeRendering();
+        const Vector<3, float> cameraPos = cameraRelative ? Vector<3, float>( camera->getDerivedPosition() ) :
+                                                            Vector<3, float>( 0.0f );
+        const unsigned char numCustomParams = mCreator->getNumCustomParams();
+        size_t retVal = 0;
+
+        for( size_t first = 0; first < mInstancedEntities.size(); first += chunkSize )
+        {
+            const size_t count = std::min( chunkSize, mInstancedEntities.size() - first );
+
+            //Object is active and explicitly visible, see InstancedEntity::findVisible
+            for( size_t i = 0; i < count; ++i )
+            {
+                const InstancedEntity *e = mInstancedEntities[first + i];
+                inScene[i] = e->isInScene() && e->isVisible();
+                spheres[i] = inScene[i] ? Vector4( e->_getDerivedPosition(),
+                                                   e->getBoundingRadius() * e->getMaxScaleCoef() ) :
+                                          Vector4( 0.0f );
+            }
+
             //Cull on an individual basis, the less entities are visible, the less instances we draw.
             //No need to use null matrices at all!
-            if (e->findVisible(currentCamera ))
+            if( camera )
+                OptimisedUtil::getImplementation()->calculateSphereVisibility( planes, numPlanes, spheres,
+                                                                                visible, count );
+            else
+                std::fill( visible, visible + count, 1 );
+
+            for( size_t i = 0; i < count; ++i )
             {
-                const size_t floatsWritten = e->getTransforms3x4( (Matrix3x4f*)pDest);
+                if( !inScene[i] || !visible[i] )
+                    continue;
 
-                if( mManager->getCameraRelativeRendering() )
-                    makeMatrixCameraRelative3x4((Matrix3x4f*)pDest, floatsWritten / 12);
+                const size_t floatsWritten =
+                    mInstancedEntities[first + i]->getTransforms3x4( (Matrix3x4f*)pDest );
+
+                if( cameraRelative )
+                {
+                    Matrix3x4f *mat3x4 = (Matrix3x4f*)pDest;
+                    for( size_t m = 0; m < floatsWritten / 12; ++m )
+                        mat3x4[m].setTrans( mat3x4[m].getTrans() - cameraPos );
+                }
 
                 pDest += floatsWritten;
 
                 //Write custom parameters, if any
-                for (unsigned char i = 0; i < numCustomParams; ++i)
+                const size_t customParamIdx = ( first + i ) * numCustomParams;
+                for (unsigned char p = 0; p < numCustomParams; ++p)
                 {
-                    memcpy(pDest, mCustomParams[customParamIdx+i].ptr(), sizeof(Vector4f));
+                    memcpy(pDest, mCustomParams[customParamIdx+p].ptr(), sizeof(Vector4f));
                     pDest += 4;
                 }
                 ++retVal;
             }
-            customParamIdx += numCustomParams;
         }
 
         return retVal;
     }
     //-----------------------------------------------------------------------
+    size_t InstanceBatchHW::findVisibleInstances( const Camera *camera, const Vector4 *planes,
+                                                  size_t numPlanes ) const
+    {
+        //Reuse the result if the camera didn't change since it was rendered this frame
+        const unsigned long frameNumber = Root::getSingleton().getNextFrameNumber();
+        for( size_t i = 0; i < mVisibleInstances.size(); ++i )
+        {
+            const VisibleInstances &v = mVisibleInstances[i];
+            if( v.frameNumber == frameNumber && v.camera == camera && v.numPlanes == numPlanes &&
+                std::equal( planes, planes + numPlanes, v.planes ) )
+                return i;
+        }
+
+        return std::numeric_limits<size_t>::max();
+    }
+    //-----------------------------------------------------------------------
+    size_t InstanceBatchHW::prepareVisibleInstances( const Camera *camera, const Vector4 *planes,
+                                                     size_t numPlanes )
+    {
+        //Recycle the entries of previous frames
+        const unsigned long frameNumber = Root::getSingleton().getNextFrameNumber();
+        size_t freeIdx = 0;
+        while( freeIdx < mVisibleInstances.size() && mVisibleInstances[freeIdx].frameNumber == frameNumber )
+            ++freeIdx;
+
+        if( freeIdx == mVisibleInstances.size() )
+            mVisibleInstances.push_back( VisibleInstances() );
+        if( freeIdx == mUploadedInstances )
+            mUploadedInstances = std::numeric_limits<size_t>::max();
+
+        VisibleInstances &v = mVisibleInstances[freeIdx];
+        v.camera = camera;
+        v.frameNumber = frameNumber;
+        std::copy( planes, planes + numPlanes, v.planes );
+        v.numPlanes = numPlanes;
+
+        const VertexBufferBinding* binding = mRenderOperation.vertexData->vertexBufferBinding;
+        v.data.resize( binding->getBuffer( ushort(binding->getBufferCount()-1) )->getSizeInBytes() /
+                       sizeof(float) );
+        v.numInstances = fillVisibleInstances( camera, planes, numPlanes, v.data.data() );
+
+        return freeIdx;
+    }
+    //-----------------------------------------------------------------------
+    void InstanceBatchHW::_prepareVisibleInstances( const Camera *camera )
+    {
+        Vector4 planes[6];
+        const size_t numPlanes = getCullingPlanes( camera, planes );
+        if( findVisibleInstances( camera, planes, numPlanes ) == std::numeric_limits<size_t>::max() )
+            prepareVisibleInstances( camera, planes, numPlanes );
+    }
+    //-----------------------------------------------------------------------
     void InstanceBatchHW::_boundsDirty(void)
     {
         //Don't update if we're static, but still mark we're dirty
         if( !mBoundsDirty && !mKeepStatic )
             mCreator->_addDirtyBatch( this );
         mBoundsDirty = true;
+
+        //Instances moved, the culling results can't be reused
+        for( auto &v : mVisibleInstances )
+            v.frameNumber = std::numeric_limits<unsigned long>::max();
     }
     //-----------------------------------------------------------------------
     void InstanceBatchHW::setStaticAndUpdate( bool bStatic )
@@ -46,7 +46,8 @@ namespace Ogre
                 mSubMeshIdx( subMeshIdx ),
                 mSceneManager( sceneManager ),
                 mMaxLookupTableInstances(16),
-                mNumCustomParams( 0 )
+                mNumCustomParams( 0 ),
+                mParallelCulling( false )
     {
         mMeshReference = MeshManager::getSingleton().load( meshName, groupName );
 
@@ -432,6 +433,40 @@ namespace Ogre
         }
     }
     //-----------------------------------------------------------------------
+    void InstanceManager::_prepareVisibleInstances( Camera *camera )
+    {
+        if( mInstancingTechnique != HWInstancingBasic )
+            return;
+
+        OgreProfile("InstanceManager::_prepareVisibleInstances");
+
+        //Update the lazily derived camera data on this thread, before going wide
+        camera->getFrustumPlane( FRUSTUM_PLANE_NEAR );
+        camera->getDerivedPosition();
+
+        std::vector<InstanceBatchHW*> batches;
+        for (auto& b : mInstanceBatches)
+        {
+            for (auto *it : b.second)
+            {
+                InstanceBatchHW *batch = static_cast<InstanceBatchHW*>( it );
+                if( !batch->isStatic() && batch->getVisible() && batch->isInScene() &&
+                    camera->isVisible( batch->getWorldBoundingBox( true ) ) )
+                {
+                    batches.push_back( batch );
+                }
+            }
+        }
+
+        Root::getSingleton().getWorkQueue()->parallelFor(
+            0, batches.size(),
+            [&batches, camera](size_t first, size_t last)
+            {
+                for (size_t i = first; i < last; ++i)
+                    batches[i]->_prepareVisibleInstances( camera );
+            });
+    }
+    //-----------------------------------------------------------------------
     void InstanceManager::_addDirtyBatch( InstanceBatch *dirtyBatch )
     {
         if( mDirtyBatches.empty() )
@@ -254,6 +254,7 @@ namespace Ogre {
         // Clear SubMesh lists
         mSubMeshList.clear();
         mSubMeshNameMap.clear();
+        mQuantisationBounds.setNull();
 
         freeEdgeList();
 #if !OGRE_NO_MESHLOD
@@ -332,6 +333,7 @@ namespace Ogre {
         newMesh->mAABB = mAABB;
         newMesh->mBoundRadius = mBoundRadius;
         newMesh->mBoneBoundingRadius = mBoneBoundingRadius;
+        newMesh->mQuantisationBounds = mQuantisationBounds;
         newMesh->mAutoBuildEdgeLists = mAutoBuildEdgeLists;
         newMesh->mEdgeListsBuilt = mEdgeListsBuilt;
 
@@ -480,6 +482,44 @@ namespace Ogre {
         outRadius = std::sqrt(radiusSqr);
     }
     //-----------------------------------------------------------------------
+    void Mesh::_quantisePositions()
+    {
+        OgreAssert(mQuantisationBounds.isNull(), "positions are already quantised");
+        OgreAssert(!hasSkeleton() && !hasVertexAnimation() && mPoseList.empty(),
+                   "animated meshes can not be quantised");
+
+        std::vector<VertexData*> vertexDatas;
+        if (sharedVertexData)
+            vertexDatas.push_back(sharedVertexData);
+        for (auto *s : mSubMeshList)
+        {
+            if (!s->useSharedVertices)
+                vertexDatas.push_back(s->vertexData);
+        }
+
+        // exact bounds, the padding of mAABB would only waste precision
+        AxisAlignedBox bounds;
+        for (auto *vd : vertexDatas)
+        {
+            if (!vd->vertexCount)
+                continue;
+            auto posElem = vd->vertexDeclaration->findElementBySemantic(VES_POSITION);
+            OgreAssert(posElem && posElem->getType() == VET_FLOAT3, "only VET_FLOAT3 positions can be quantised");
+            AxisAlignedBox box;
+            Real radius;
+            _calcBoundsFromVertexBuffer(vd, box, radius);
+            bounds.merge(box);
+        }
+
+        if (bounds.isNull())
+            return;
+
+        for (auto *vd : vertexDatas)
+            vd->quantisePositions(bounds);
+
+        mQuantisationBounds = bounds;
+    }
+    //-----------------------------------------------------------------------
     void Mesh::setSkeletonName(const String& skelName)
     {
         if (skelName != getSkeletonName())
@@ -1571,6 +1611,11 @@ namespace Ogre {
         if (mEdgeListsBuilt)
             return;
 #if !OGRE_NO_MESHLOD
+        // The builders are prepared here, as manual LODs might have to be loaded and the
+        // buffers must only be read by one thread. The LODs are then built in parallel.
+        std::vector<EdgeListBuilder> builders(mMeshLodUsageList.size());
+        std::vector<unsigned short> buildLods;
+
         // Loop over LODs
         for (unsigned short lodIndex = 0; lodIndex < (unsigned short)mMeshLodUsageList.size(); ++lodIndex)
         {
@@ -1589,7 +1634,7 @@ namespace Ogre {
             else
             {
                 // Build
-                EdgeListBuilder eb;
+                EdgeListBuilder& eb = builders[lodIndex];
                 size_t vertexSetCount = 0;
                 bool atLeastOneIndexSet = false;
 
@@ -1644,17 +1689,8 @@ namespace Ogre {
 
                 if (atLeastOneIndexSet)
                 {
-                    usage.edgeData = eb.build();
-
-                #if OGRE_DEBUG_MODE
-                    // Override default log
-                    Log* log = LogManager::getSingleton().createLog(
-                        mName + "_lod" + StringConverter::toString(lodIndex) +
-                        "_prepshadow.log", false, false);
-                    usage.edgeData->log(log);
-                    // clean up log & close file handle
-                    LogManager::getSingleton().destroyLog(log);
-                #endif
+                    eb.readBuffers();
+                    buildLods.push_back(lodIndex);
                 }
                 else
                 {
@@ -1663,6 +1699,28 @@ namespace Ogre {
                 }
             }
         }
+
+        auto build = [&](size_t first, size_t last) {
+            for (size_t i = first; i < last; ++i)
+                mMeshLodUsageList[buildLods[i]].edgeData = builders[buildLods[i]].build();
+        };
+        if (Root* root = Root::getSingletonPtr())
+            root->getWorkQueue()->parallelFor(0, buildLods.size(), build, 1);
+        else
+            build(0, buildLods.size());
+
+    #if OGRE_DEBUG_MODE
+        for (unsigned short lodIndex : buildLods)
+        {
+            // Override default log
+            Log* log = LogManager::getSingleton().createLog(
+                mName + "_lod" + StringConverter::toString(lodIndex) +
+                "_prepshadow.log", false, false);
+            mMeshLodUsageList[lodIndex].edgeData->log(log);
+            // clean up log & close file handle
+            LogManager::getSingleton().destroyLog(log);
+        }
+    #endif
 #else
         // Build
         EdgeListBuilder eb;
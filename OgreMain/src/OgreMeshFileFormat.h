@@ -83,6 +83,12 @@ namespace Ogre {
                 M_SUBMESH_TEXTURE_ALIAS = 0x4200, // Repeating section
                     // char* aliasName;
                     // char* textureName;
+                // Optional, present if the indexes are compressed, see MeshSerializer::setCompressGeometry
+                // indexCount of the M_SUBMESH chunk is 0 in that case
+                M_SUBMESH_INDEX_DATA_COMPRESSED = 0x4300,
+                    // unsigned int indexCount
+                    // bool indexes32Bit
+                    // compressed index data, see GeometryCodec
 
             M_GEOMETRY          = 0x5000, // NB this chunk is embedded within M_MESH and M_SUBMESH
                 // unsigned int vertexCount
@@ -98,6 +104,9 @@ namespace Ogre {
                     // unsigned short vertexSize;   // Per-vertex size, must agree with declaration at this index
                     M_GEOMETRY_VERTEX_BUFFER_DATA = 0x5210,
                         // raw buffer data
+                    // replaces M_GEOMETRY_VERTEX_BUFFER_DATA, if the vertices are compressed
+                    M_GEOMETRY_VERTEX_BUFFER_DATA_COMPRESSED = 0x5220,
+                        // compressed buffer data, see GeometryCodec
             M_MESH_SKELETON_LINK = 0x6000,
                 // Optional link to skeleton
                 // char* skeletonName           : name of .skeleton to use
@@ -208,6 +217,12 @@ namespace Ogre {
             // unsigned short submesh_index;
             // float extremes [n_extremes][3];
 
+            // Optional, present if the positions are quantised to VET_SHORT4_NORM
+            // Written last, so older readers stop before it
+            M_MESH_QUANTISATION = 0xF000,
+            // float minx, miny, minz
+            // float maxx, maxy, maxz
+
     /* Version 1.2 of the .mesh format (deprecated)
     enum MeshChunkID {
         M_HEADER                = 0x1000,
@@ -0,0 +1,661 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "OgreStableHeaders.h"
+#include "OgreMeshOptimiser.h"
+#include "OgreSubMesh.h"
+#include "OgreAnimation.h"
+#include "OgreAnimationTrack.h"
+#include "OgreKeyFrame.h"
+#include "OgrePose.h"
+
+namespace Ogre
+{
+    namespace
+    {
+        const uint32 UNUSED = ~uint32(0);
+
+        template <typename F> void parallelFor(size_t count, size_t grain, const F& fn)
+        {
+            if (Root* root = Root::getSingletonPtr())
+                root->getWorkQueue()->parallelFor(0, count, fn, grain);
+            else
+                fn(0, count);
+        }
+
+        /** FIFO cache simulation
+
+            Every miss advances the time, so a vertex stays in the cache until size other vertices
+            were loaded after it.
+        */
+        struct VertexCache
+        {
+            std::vector<uint32> timestamps;
+            uint32 time;
+            uint32 size;
+
+            VertexCache(size_t vertexCount, uint32 cacheSize)
+                : timestamps(vertexCount, 0), time(cacheSize + 1), size(cacheSize)
+            {
+            }
+
+            /// returns 1 on a miss
+            uint32 access(uint32 v)
+            {
+                if (time - timestamps[v] <= size)
+                    return 0;
+                timestamps[v] = time++;
+                return 1;
+            }
+
+            uint32 accessTriangle(const uint32* tri) { return access(tri[0]) + access(tri[1]) + access(tri[2]); }
+
+            void flush() { time += size + 1; }
+        };
+
+        size_t getVertexCount(const uint32* indexes, size_t indexCount)
+        {
+            if (!indexCount)
+                return 0;
+            return *std::max_element(indexes, indexes + indexCount) + size_t(1);
+        }
+
+        /// the indexes of an IndexData, read back for processing
+        struct IndexJob
+        {
+            IndexData* indexData;
+            /// into the list of VertexJobs
+            size_t vertexJob;
+            /// whether the triangles may be reordered
+            bool reorder;
+            bool dirty;
+            std::vector<uint32> indexes;
+
+            IndexJob(IndexData* id, size_t vj, bool triList)
+                : indexData(id), vertexJob(vj), reorder(triList), dirty(false)
+            {
+            }
+        };
+
+        /// a VertexData and the targets of the data attached to its vertices
+        struct VertexJob
+        {
+            VertexData* vertexData;
+            /// the pose and vertex track target, 0 for the shared vertex data
+            ushort target;
+            /// the owner of the bone assignments, NULL for the shared vertex data
+            SubMesh* subMesh;
+            /// whether the vertices may be reordered
+            bool remap;
+            std::vector<Vector3f> positions;
+
+            VertexJob(VertexData* vd, ushort t, SubMesh* sm)
+                : vertexData(vd), target(t), subMesh(sm), remap(true)
+            {
+            }
+        };
+
+        void readIndexes(const IndexData* indexData, std::vector<uint32>& indexes)
+        {
+            const HardwareIndexBufferSharedPtr& ibuf = indexData->indexBuffer;
+            indexes.resize(indexData->indexCount);
+            if (ibuf->getType() == HardwareIndexBuffer::IT_32BIT)
+            {
+                ibuf->readData(indexData->indexStart * sizeof(uint32), indexes.size() * sizeof(uint32),
+                               indexes.data());
+                return;
+            }
+
+            std::vector<uint16> shortIndexes(indexes.size());
+            ibuf->readData(indexData->indexStart * sizeof(uint16), shortIndexes.size() * sizeof(uint16),
+                           shortIndexes.data());
+            std::copy(shortIndexes.begin(), shortIndexes.end(), indexes.begin());
+        }
+
+        void writeIndexes(const IndexData* indexData, const std::vector<uint32>& indexes)
+        {
+            const HardwareIndexBufferSharedPtr& ibuf = indexData->indexBuffer;
+            if (ibuf->getType() == HardwareIndexBuffer::IT_32BIT)
+            {
+                ibuf->writeData(indexData->indexStart * sizeof(uint32), indexes.size() * sizeof(uint32),
+                                indexes.data());
+                return;
+            }
+
+            std::vector<uint16> shortIndexes(indexes.begin(), indexes.end());
+            ibuf->writeData(indexData->indexStart * sizeof(uint16), shortIndexes.size() * sizeof(uint16),
+                            shortIndexes.data());
+        }
+
+        void readPositions(const VertexData* vertexData, std::vector<Vector3f>& positions)
+        {
+            const VertexElement* posElem =
+                vertexData->vertexDeclaration->findElementBySemantic(VES_POSITION);
+            if (!posElem || posElem->getType() != VET_FLOAT3)
+                return;
+
+            const HardwareVertexBufferSharedPtr& vbuf =
+                vertexData->vertexBufferBinding->getBuffer(posElem->getSource());
+            size_t vertexSize = vbuf->getVertexSize();
+            HardwareBufferLockGuard vbufLock(vbuf, vertexData->vertexStart * vertexSize,
+                                             vertexData->vertexCount * vertexSize,
+                                             HardwareBuffer::HBL_READ_ONLY);
+            positions.resize(vertexData->vertexCount);
+            auto pVert = static_cast<uchar*>(vbufLock.pData);
+            for (auto& p : positions)
+            {
+                float* pFloat;
+                posElem->baseVertexPointerToElement(pVert, &pFloat);
+                p = Vector3f(pFloat);
+                pVert += vertexSize;
+            }
+        }
+
+        /// moves vertex i of the buffer to remap[i]
+        void remapVertices(const HardwareVertexBufferSharedPtr& vbuf, size_t vertexStart,
+                           const std::vector<uint32>& remap)
+        {
+            size_t vertexSize = vbuf->getVertexSize();
+            size_t length = remap.size() * vertexSize;
+            std::vector<uchar> src(length), dst(length);
+            vbuf->readData(vertexStart * vertexSize, length, src.data());
+            for (size_t i = 0; i < remap.size(); ++i)
+                memcpy(&dst[remap[i] * vertexSize], &src[i * vertexSize], vertexSize);
+            vbuf->writeData(vertexStart * vertexSize, length, dst.data());
+        }
+
+        Mesh::VertexBoneAssignmentList remapBoneAssignments(const Mesh::VertexBoneAssignmentList& assignments,
+                                                      const std::vector<uint32>& remap)
+        {
+            Mesh::VertexBoneAssignmentList ret;
+            for (const auto& a : assignments)
+            {
+                VertexBoneAssignment vba = a.second;
+                vba.vertexIndex = remap[vba.vertexIndex];
+                ret.emplace(vba.vertexIndex, vba);
+            }
+            return ret;
+        }
+
+        void remapPose(Pose* pose, const std::vector<uint32>& remap)
+        {
+            Pose::VertexOffsetMap offsets = pose->getVertexOffsets();
+            Pose::NormalsMap normals = pose->getNormals();
+            pose->clearVertices();
+            for (const auto& o : offsets)
+            {
+                if (normals.empty())
+                    pose->addVertex(remap[o.first], o.second);
+                else
+                    pose->addVertex(remap[o.first], o.second, normals[o.first]);
+            }
+        }
+    }
+    //---------------------------------------------------------------------
+    MeshOptimiser::MeshOptimiser()
+        : mCacheSize(16)
+        , mOverdrawThreshold(1.05f)
+        , mOptimiseVertexCache(true)
+        , mOptimiseVertexFetch(true)
+    {
+    }
+    //---------------------------------------------------------------------
+    MeshOptimiser::Statistics MeshOptimiser::analyseVertexCache(const uint32* indexes, size_t indexCount,
+                                                                uint32 cacheSize)
+    {
+        Statistics stats;
+        stats.triangles = indexCount / 3;
+        indexCount = stats.triangles * 3;
+
+        size_t vertexCount = getVertexCount(indexes, indexCount);
+        VertexCache cache(vertexCount, cacheSize);
+        std::vector<uchar> referenced(vertexCount, 0);
+        for (size_t i = 0; i < indexCount; ++i)
+        {
+            uint32 v = indexes[i];
+            stats.transformedVertices += cache.access(v);
+            stats.vertices += !referenced[v];
+            referenced[v] = 1;
+        }
+        return stats;
+    }
+    //---------------------------------------------------------------------
+    void MeshOptimiser::optimiseVertexCache(uint32* indexes, size_t indexCount, uint32 cacheSize)
+    {
+        // Tipsify, see Sander, Nehab and Barczak: Fast Triangle Reordering for Vertex Locality
+        // and Reduced Overdraw
+        size_t triangleCount = indexCount / 3;
+        indexCount = triangleCount * 3;
+        if (triangleCount < 2)
+            return;
+        size_t vertexCount = getVertexCount(indexes, indexCount);
+
+        // the triangles using each vertex
+        std::vector<uint32> adjacencyStart(vertexCount + 1, 0);
+        for (size_t i = 0; i < indexCount; ++i)
+            adjacencyStart[indexes[i] + 1]++;
+        std::vector<uint32> liveTriangles(vertexCount);
+        for (size_t v = 0; v < vertexCount; ++v)
+        {
+            liveTriangles[v] = adjacencyStart[v + 1];
+            adjacencyStart[v + 1] += adjacencyStart[v];
+        }
+        std::vector<uint32> adjacency(indexCount);
+        std::vector<uint32> cursor(adjacencyStart.begin(), adjacencyStart.end() - 1);
+        for (size_t i = 0; i < indexCount; ++i)
+            adjacency[cursor[indexes[i]]++] = uint32(i / 3);
+
+        std::vector<uchar> emitted(triangleCount, 0);
+        std::vector<uint32> deadEnd;
+        deadEnd.reserve(indexCount);
+        std::vector<uint32> result;
+        result.reserve(indexCount);
+
+        VertexCache cache(vertexCount, cacheSize);
+        size_t scanCursor = 1;
+        uint32 fanningVertex = 0;
+        while (fanningVertex != UNUSED)
+        {
+            // emit all the remaining triangles around the fanning vertex
+            size_t candidates = deadEnd.size();
+            for (uint32 i = adjacencyStart[fanningVertex]; i < adjacencyStart[fanningVertex + 1]; ++i)
+            {
+                uint32 t = adjacency[i];
+                if (emitted[t])
+                    continue;
+                emitted[t] = 1;
+
+                for (int k = 0; k < 3; ++k)
+                {
+                    uint32 v = indexes[t * 3 + k];
+                    result.push_back(v);
+                    deadEnd.push_back(v);
+                    liveTriangles[v]--;
+                    cache.access(v);
+                }
+            }
+
+            // continue with the vertex of the emitted triangles, which stays in the cache the
+            // longest while its remaining triangles are emitted
+            uint32 next = UNUSED;
+            int bestPriority = -1;
+            for (size_t i = candidates; i < deadEnd.size(); ++i)
+            {
+                uint32 v = deadEnd[i];
+                if (!liveTriangles[v])
+                    continue;
+
+                uint32 age = cache.time - cache.timestamps[v];
+                int priority = age + 2 * liveTriangles[v] <= cacheSize ? int(age) : 0;
+                if (priority > bestPriority)
+                {
+                    next = v;
+                    bestPriority = priority;
+                }
+            }
+
+            // dead end: the most recently used vertex, that is still live
+            while (next == UNUSED && !deadEnd.empty())
+            {
+                uint32 v = deadEnd.back();
+                deadEnd.pop_back();
+                if (liveTriangles[v])
+                    next = v;
+            }
+
+            // finally any live vertex in input order
+            for (; next == UNUSED && scanCursor < vertexCount; ++scanCursor)
+            {
+                if (liveTriangles[scanCursor])
+                    next = uint32(scanCursor);
+            }
+
+            fanningVertex = next;
+        }
+
+        std::copy(result.begin(), result.end(), indexes);
+    }
+    //---------------------------------------------------------------------
+    void MeshOptimiser::optimiseOverdraw(uint32* indexes, size_t indexCount, const Vector3f* positions,
+                                         float threshold, uint32 cacheSize)
+    {
+        size_t triangleCount = indexCount / 3;
+        indexCount = triangleCount * 3;
+        if (threshold < 1 || triangleCount < 2)
+            return;
+        size_t vertexCount = getVertexCount(indexes, indexCount);
+        VertexCache cache(vertexCount, cacheSize);
+
+        // hard boundaries, where none of the vertices of the triangle are cached anyway
+        std::vector<uint32> hardBoundaries;
+        for (size_t t = 0; t < triangleCount; ++t)
+        {
+            if (cache.accessTriangle(&indexes[t * 3]) == 3 || t == 0)
+                hardBoundaries.push_back(uint32(t));
+        }
+        hardBoundaries.push_back(uint32(triangleCount));
+
+        // soft boundaries, where the ACMR of the cluster so far is within the threshold
+        std::vector<uint32> clusters;
+        for (size_t h = 0; h + 1 < hardBoundaries.size(); ++h)
+        {
+            uint32 start = hardBoundaries[h], end = hardBoundaries[h + 1];
+
+            cache.flush();
+            uint32 misses = 0;
+            for (uint32 t = start; t < end; ++t)
+                misses += cache.accessTriangle(&indexes[t * 3]);
+            float clusterThreshold = threshold * misses / (end - start);
+
+            cache.flush();
+            clusters.push_back(start);
+            uint32 runningMisses = 0, runningTriangles = 0;
+            for (uint32 t = start; t < end; ++t)
+            {
+                runningMisses += cache.accessTriangle(&indexes[t * 3]);
+                runningTriangles++;
+
+                if (t + 1 < end && runningMisses <= clusterThreshold * runningTriangles)
+                {
+                    clusters.push_back(t + 1);
+                    cache.flush();
+                    runningMisses = runningTriangles = 0;
+                }
+            }
+        }
+        clusters.push_back(uint32(triangleCount));
+
+        // clusters facing away from the centre occlude the others, so draw them first
+        Vector3 meshCentroid(0);
+        for (size_t i = 0; i < indexCount; ++i)
+            meshCentroid += Vector3(positions[indexes[i]]);
+        meshCentroid /= Real(indexCount);
+
+        size_t clusterCount = clusters.size() - 1;
+        std::vector<Real> sortKeys(clusterCount);
+        for (size_t c = 0; c < clusterCount; ++c)
+        {
+            Vector3 centroid(0), normal(0);
+            Real area = 0;
+            for (uint32 t = clusters[c]; t < clusters[c + 1]; ++t)
+            {
+                Vector3 p0(positions[indexes[t * 3]]);
+                Vector3 p1(positions[indexes[t * 3 + 1]]);
+                Vector3 p2(positions[indexes[t * 3 + 2]]);
+                Vector3 n = (p1 - p0).crossProduct(p2 - p0);
+                Real a = n.length();
+                centroid += (p0 + p1 + p2) * (a / 3);
+                normal += n;
+                area += a;
+            }
+            if (area > 0)
+                centroid /= area;
+            normal.normalise();
+            sortKeys[c] = (centroid - meshCentroid).dotProduct(normal);
+        }
+
+        std::vector<uint32> order(clusterCount);
+        for (size_t c = 0; c < clusterCount; ++c)
+            order[c] = uint32(c);
+        std::stable_sort(order.begin(), order.end(),
+                         [&sortKeys](uint32 a, uint32 b) { return sortKeys[a] > sortKeys[b]; });
+
+        std::vector<uint32> result;
+        result.reserve(indexCount);
+        for (uint32 c : order)
+            result.insert(result.end(), indexes + clusters[c] * 3, indexes + clusters[c + 1] * 3);
+        std::copy(result.begin(), result.end(), indexes);
+    }
+    //---------------------------------------------------------------------
+    void MeshOptimiser::buildVertexFetchRemap(const uint32* indexes, size_t indexCount, size_t vertexCount,
+                                              std::vector<uint32>& remap)
+    {
+        remap.assign(vertexCount, UNUSED);
+        uint32 next = 0;
+        for (size_t i = 0; i < indexCount; ++i)
+        {
+            uint32& r = remap[indexes[i]];
+            if (r == UNUSED)
+                r = next++;
+        }
+        for (auto& r : remap)
+        {
+            if (r == UNUSED)
+                r = next++;
+        }
+    }
+    //---------------------------------------------------------------------
+    MeshOptimiser::Statistics MeshOptimiser::analyse(const Mesh* mesh) const
+    {
+        Statistics stats;
+        std::set<const IndexData*> visited;
+        std::vector<uint32> indexes;
+        auto addIndexData = [&](const IndexData* indexData) {
+            if (!indexData->indexBuffer || !indexData->indexCount || !visited.insert(indexData).second)
+                return;
+            readIndexes(indexData, indexes);
+            Statistics s = analyseVertexCache(indexes.data(), indexes.size(), mCacheSize);
+            stats.triangles += s.triangles;
+            stats.vertices += s.vertices;
+            stats.transformedVertices += s.transformedVertices;
+        };
+
+        for (const auto* sm : mesh->getSubMeshes())
+        {
+            if (sm->operationType != RenderOperation::OT_TRIANGLE_LIST)
+                continue;
+            addIndexData(sm->indexData);
+            for (const auto* lod : sm->mLodFaceList)
+                addIndexData(lod);
+        }
+        return stats;
+    }
+    //---------------------------------------------------------------------
+    void MeshOptimiser::optimise(Mesh* mesh) const
+    {
+        const auto& subMeshes = mesh->getSubMeshes();
+
+        std::vector<VertexJob> vertexJobs;
+        std::vector<size_t> subMeshVertexJob;
+        if (mesh->sharedVertexData)
+            vertexJobs.emplace_back(mesh->sharedVertexData, 0, (SubMesh*)NULL);
+        for (size_t i = 0; i < subMeshes.size(); ++i)
+        {
+            SubMesh* sm = subMeshes[i];
+            if (sm->useSharedVertices)
+            {
+                OgreAssert(mesh->sharedVertexData, "SubMesh uses missing shared vertex data");
+                subMeshVertexJob.push_back(0);
+            }
+            else
+            {
+                subMeshVertexJob.push_back(vertexJobs.size());
+                vertexJobs.emplace_back(sm->vertexData, ushort(i + 1), sm);
+            }
+        }
+
+        // the full LOD of all SubMeshes come first, to take precedence in the vertex order
+        std::vector<IndexJob> indexJobs;
+        std::set<IndexData*> visited;
+        auto addIndexData = [&](IndexData* indexData, size_t i) {
+            if (!indexData->indexBuffer || !indexData->indexCount || !visited.insert(indexData).second)
+                return;
+            bool triList = subMeshes[i]->operationType == RenderOperation::OT_TRIANGLE_LIST;
+            indexJobs.emplace_back(indexData, subMeshVertexJob[i], triList);
+        };
+        for (size_t i = 0; i < subMeshes.size(); ++i)
+        {
+            // the order of the vertices matters, when they are drawn without indexes
+            if (!subMeshes[i]->indexData->indexBuffer)
+                vertexJobs[subMeshVertexJob[i]].remap = false;
+            addIndexData(subMeshes[i]->indexData, i);
+        }
+        for (size_t i = 0; i < subMeshes.size(); ++i)
+        {
+            for (auto* lod : subMeshes[i]->mLodFaceList)
+                addIndexData(lod, i);
+        }
+
+        // index data sharing parts of a buffer must keep their triangle order
+        std::vector<IndexJob*> byRange;
+        for (auto& job : indexJobs)
+            byRange.push_back(&job);
+        std::sort(byRange.begin(), byRange.end(), [](const IndexJob* a, const IndexJob* b) {
+            if (a->indexData->indexBuffer != b->indexData->indexBuffer)
+                return a->indexData->indexBuffer < b->indexData->indexBuffer;
+            return a->indexData->indexStart < b->indexData->indexStart;
+        });
+        for (size_t i = 0; i < byRange.size(); ++i)
+        {
+            const IndexData* a = byRange[i]->indexData;
+            for (size_t j = i + 1; j < byRange.size(); ++j)
+            {
+                const IndexData* b = byRange[j]->indexData;
+                if (a->indexBuffer != b->indexBuffer || a->indexStart + a->indexCount <= b->indexStart)
+                    break;
+                byRange[i]->reorder = byRange[j]->reorder = false;
+            }
+        }
+
+        // buffers can only be accessed on the calling thread
+        bool sortOverdraw = mOverdrawThreshold >= 1;
+        for (auto& job : indexJobs)
+        {
+            readIndexes(job.indexData, job.indexes);
+            VertexJob& vertexJob = vertexJobs[job.vertexJob];
+            if (getVertexCount(job.indexes.data(), job.indexes.size()) > vertexJob.vertexData->vertexCount)
+            {
+                job.reorder = false;
+                vertexJob.remap = false;
+            }
+            if (job.reorder && sortOverdraw && vertexJob.positions.empty())
+                readPositions(vertexJob.vertexData, vertexJob.positions);
+        }
+
+        if (mOptimiseVertexCache || sortOverdraw)
+        {
+            parallelFor(indexJobs.size(), 1, [&](size_t first, size_t last) {
+                for (size_t i = first; i < last; ++i)
+                {
+                    IndexJob& job = indexJobs[i];
+                    if (!job.reorder)
+                        continue;
+                    if (mOptimiseVertexCache)
+                        optimiseVertexCache(job.indexes.data(), job.indexes.size(), mCacheSize);
+                    const auto& positions = vertexJobs[job.vertexJob].positions;
+                    if (sortOverdraw && !positions.empty())
+                        optimiseOverdraw(job.indexes.data(), job.indexes.size(), positions.data(),
+                                         mOverdrawThreshold, mCacheSize);
+                    job.dirty = true;
+                }
+            });
+        }
+
+        for (size_t vj = 0; mOptimiseVertexFetch && vj < vertexJobs.size(); ++vj)
+        {
+            VertexJob& vertexJob = vertexJobs[vj];
+            if (!vertexJob.remap)
+                continue;
+
+            std::vector<uint32> indexes;
+            for (const auto& job : indexJobs)
+            {
+                if (job.vertexJob == vj)
+                    indexes.insert(indexes.end(), job.indexes.begin(), job.indexes.end());
+            }
+
+            VertexData* vertexData = vertexJob.vertexData;
+            std::vector<uint32> remap;
+            buildVertexFetchRemap(indexes.data(), indexes.size(), vertexData->vertexCount, remap);
+
+            bool identity = true;
+            for (size_t v = 0; identity && v < remap.size(); ++v)
+                identity = remap[v] == v;
+            if (identity)
+                continue;
+
+            for (auto& job : indexJobs)
+            {
+                if (job.vertexJob != vj)
+                    continue;
+                for (auto& i : job.indexes)
+                    i = remap[i];
+                job.dirty = true;
+            }
+
+            for (const auto& b : vertexData->vertexBufferBinding->getBindings())
+                remapVertices(b.second, vertexData->vertexStart, remap);
+
+            if (vertexJob.subMesh)
+            {
+                Mesh::VertexBoneAssignmentList assignments =
+                    remapBoneAssignments(vertexJob.subMesh->getBoneAssignments(), remap);
+                vertexJob.subMesh->clearBoneAssignments();
+                for (const auto& a : assignments)
+                    vertexJob.subMesh->addBoneAssignment(a.second);
+            }
+            else
+            {
+                Mesh::VertexBoneAssignmentList assignments =
+                    remapBoneAssignments(mesh->getBoneAssignments(), remap);
+                mesh->clearBoneAssignments();
+                for (const auto& a : assignments)
+                    mesh->addBoneAssignment(a.second);
+            }
+
+            for (auto* pose : mesh->getPoseList())
+            {
+                if (pose->getTarget() == vertexJob.target)
+                    remapPose(pose, remap);
+            }
+
+            for (unsigned short a = 0; a < mesh->getNumAnimations(); ++a)
+            {
+                for (const auto& t : mesh->getAnimation(a)->_getVertexTrackList())
+                {
+                    VertexAnimationTrack* track = t.second;
+                    if (track->getHandle() != vertexJob.target || track->getAnimationType() != VAT_MORPH)
+                        continue;
+                    for (unsigned short k = 0; k < track->getNumKeyFrames(); ++k)
+                        remapVertices(track->getVertexMorphKeyFrame(k)->getVertexBuffer(), 0, remap);
+                }
+            }
+        }
+
+        for (const auto& job : indexJobs)
+        {
+            if (job.dirty)
+                writeIndexes(job.indexData, job.indexes);
+        }
+
+        if (mesh->isEdgeListBuilt())
+        {
+            mesh->freeEdgeList();
+            mesh->buildEdgeList();
+        }
+    }
+}
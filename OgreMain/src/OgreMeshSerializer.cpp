@@ -47,7 +47,7 @@ namespace Ogre {
     const unsigned short HEADER_CHUNK_ID = 0x1000;
     //---------------------------------------------------------------------
     MeshSerializer::MeshSerializer()
-        :mListener(0)
+        :mListener(0), mCompressGeometry(false)
     {
         // Init implementations
         // String identifiers have not always been 100% unified with OGRE version
@@ -133,7 +133,9 @@ namespace Ogre {
             OGRE_EXCEPT(Exception::ERR_INTERNAL_ERROR, "Cannot find serializer implementation for "
                     "specified version", "MeshSerializer::exportMesh");
 
-                    
+
+        // older formats do not know the compressed chunks
+        impl->setCompressGeometry(mCompressGeometry && impl == mVersionData[0]->impl);
         impl->exportMesh(pMesh, stream, endianMode);
     }
     //---------------------------------------------------------------------
@@ -33,6 +33,7 @@ THE SOFTWARE.
 #include "OgreAnimationTrack.h"
 #include "OgreLodStrategyManager.h"
 #include "OgreDistanceLodStrategy.h"
+#include "OgreGeometryCodec.h"
 
 #if OGRE_COMPILER == OGRE_COMPILER_MSVC
 // Disable conversion warnings, we do a lot of them, intentionally
@@ -44,8 +45,19 @@ namespace Ogre {
 
     /// stream overhead = ID + size
     const long MSTREAM_OVERHEAD_SIZE = sizeof(uint16) + sizeof(uint32);
+
+    namespace
+    {
+        template <typename F> void parallelFor(size_t count, size_t grain, const F& fn)
+        {
+            if (Root* root = Root::getSingletonPtr())
+                root->getWorkQueue()->parallelFor(0, count, fn, grain);
+            else
+                fn(0, count);
+        }
+    }
     //---------------------------------------------------------------------
-    MeshSerializerImpl::MeshSerializerImpl()
+    MeshSerializerImpl::MeshSerializerImpl() : mCompressGeometry(false)
     {
         // Version number
         mVersion = "[MeshSerializer_v1.100]";
@@ -82,10 +94,14 @@ namespace Ogre {
         LogManager::getSingleton().logMessage("File header written.");
 
 
+        if (mCompressGeometry)
+            compressGeometry(pMesh);
+
         LogManager::getSingleton().logMessage("Writing mesh data...");
         pushInnerChunk(mStream);
         writeMesh(pMesh);
         popInnerChunk(mStream);
+        mCompressedBuffers.clear();
         LogManager::getSingleton().logMessage("Mesh data exported.");
 
         LogManager::getSingleton().logMessage("MeshSerializer export successful.");
@@ -104,18 +120,146 @@ namespace Ogre {
         pushInnerChunk(stream);
         unsigned short streamID = readChunk(stream);
 
-        while(!stream->eof())
+        try
         {
-            switch (streamID)
+            while(!stream->eof())
             {
-            case M_MESH:
-                readMesh(stream, pMesh, listener);
-                break;
-            }
+                switch (streamID)
+                {
+                case M_MESH:
+                    readMesh(stream, pMesh, listener);
+                    break;
+                }
 
-            streamID = readChunk(stream);
+                streamID = readChunk(stream);
+            }
+        }
+        catch (...)
+        {
+            discardDecodeJobs();
+            mDeferredGeometry.clear();
+            throw;
         }
         popInnerChunk(stream);
+
+        decompressGeometry();
+    }
+    //---------------------------------------------------------------------
+    void MeshSerializerImpl::compressGeometry(const Mesh* pMesh)
+    {
+        struct EncodeJob
+        {
+            std::vector<uchar> data;
+            size_t count;
+            size_t size;
+            bool isIndex;
+            std::vector<uchar>* dst;
+        };
+        std::vector<EncodeJob> jobs;
+
+        // read back the buffers here, as they can only be locked on the main thread
+        auto addVertexData = [&](const VertexData* vertexData) {
+            for (auto& vbi : vertexData->vertexBufferBinding->getBindings())
+            {
+                const HardwareVertexBufferSharedPtr& vbuf = vbi.second;
+                auto& dst = mCompressedBuffers[std::make_pair(vbuf.get(), vertexData->vertexCount)];
+                if (!dst.empty())
+                    continue;
+                EncodeJob job = {std::vector<uchar>(vbuf->getVertexSize() * vertexData->vertexCount),
+                                 vertexData->vertexCount, vbuf->getVertexSize(), false, &dst};
+                vbuf->readData(0, job.data.size(), job.data.data());
+                flipToLittleEndian(job.data.data(), job.count, job.size,
+                                   vertexData->vertexDeclaration->findElementsBySource(vbi.first));
+                jobs.push_back(std::move(job));
+            }
+        };
+
+        if (pMesh->sharedVertexData)
+            addVertexData(pMesh->sharedVertexData);
+
+        for (auto *s : pMesh->getSubMeshes())
+        {
+            if (!s->useSharedVertices)
+                addVertexData(s->vertexData);
+
+            const HardwareIndexBufferSharedPtr& ibuf = s->indexData->indexBuffer;
+            if (!ibuf || !s->indexData->indexCount)
+                continue;
+            auto& dst = mCompressedBuffers[std::make_pair(ibuf.get(), s->indexData->indexCount)];
+            if (!dst.empty())
+                continue;
+            EncodeJob job = {std::vector<uchar>(ibuf->getIndexSize() * s->indexData->indexCount),
+                             s->indexData->indexCount, ibuf->getIndexSize(), true, &dst};
+            ibuf->readData(0, job.data.size(), job.data.data());
+            jobs.push_back(std::move(job));
+        }
+
+        parallelFor(jobs.size(), 1, [&jobs](size_t first, size_t last) {
+            for (size_t i = first; i < last; ++i)
+            {
+                EncodeJob& job = jobs[i];
+                if (job.isIndex)
+                    GeometryCodec::encodeIndexBuffer(*job.dst, job.data.data(), job.count, job.size == 4);
+                else
+                    GeometryCodec::encodeVertexBuffer(*job.dst, job.data.data(), job.count, job.size);
+            }
+        });
+    }
+    //---------------------------------------------------------------------
+    const std::vector<uchar>* MeshSerializerImpl::getCompressedBuffer(const HardwareBuffer* buf,
+                                                                      size_t count) const
+    {
+        auto it = mCompressedBuffers.find(std::make_pair(buf, count));
+        return it != mCompressedBuffers.end() ? &it->second : NULL;
+    }
+    //---------------------------------------------------------------------
+    void MeshSerializerImpl::decompressGeometry()
+    {
+        if (!mDecodeJobs.empty())
+        {
+            // the buffers were locked while reading, so the workers only touch memory
+            std::vector<char> valid(mDecodeJobs.size());
+            parallelFor(mDecodeJobs.size(), 1, [this, &valid](size_t first, size_t last) {
+                for (size_t i = first; i < last; ++i)
+                {
+                    DecodeJob& job = mDecodeJobs[i];
+                    valid[i] = GeometryCodec::decodeVertexBuffer(static_cast<uchar*>(job.pDest), job.vertexCount,
+                                                                 job.vertexSize, job.data.data(), job.data.size());
+                    if (valid[i])
+                        flipFromLittleEndian(job.pDest, job.vertexCount, job.vertexSize, job.elems);
+                }
+            });
+            discardDecodeJobs();
+
+            if (std::find(valid.begin(), valid.end(), false) != valid.end())
+            {
+                mDeferredGeometry.clear();
+                OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS, "Corrupt compressed vertex buffer data",
+                            "MeshSerializerImpl::decompressGeometry");
+            }
+        }
+
+        for (auto *vertexData : mDeferredGeometry)
+            finaliseGeometry(vertexData);
+        mDeferredGeometry.clear();
+    }
+    //---------------------------------------------------------------------
+    void MeshSerializerImpl::discardDecodeJobs(VertexData* owner)
+    {
+        auto it = mDecodeJobs.begin();
+        while (it != mDecodeJobs.end())
+        {
+            if (owner && it->owner != owner)
+            {
+                ++it;
+                continue;
+            }
+            it->buffer->unlock();
+            it = mDecodeJobs.erase(it);
+        }
+        if (owner)
+            mDeferredGeometry.erase(std::remove(mDeferredGeometry.begin(), mDeferredGeometry.end(), owner),
+                                    mDeferredGeometry.end());
     }
     //---------------------------------------------------------------------
     void MeshSerializerImpl::writeMesh(const Mesh* pMesh)
@@ -205,6 +349,10 @@ namespace Ogre {
 
         // Write submesh extremes
         writeExtremes(pMesh);
+
+        // Write position quantisation
+        if (!pMesh->getQuantisationBounds().isNull())
+            writeQuantisationInfo(pMesh);
             popInnerChunk(mStream);
         }
     }
@@ -241,7 +389,9 @@ namespace Ogre {
         // bool useSharedVertices
         writeBools(&s->useSharedVertices, 1);
 
-        unsigned int indexCount = static_cast<unsigned int>(s->indexData->indexCount);
+        // the indexes follow in a separate chunk, if compressed
+        bool compressedIndexes = getCompressedBuffer(s->indexData->indexBuffer.get(), s->indexData->indexCount);
+        unsigned int indexCount = compressedIndexes ? 0 : static_cast<unsigned int>(s->indexData->indexCount);
         writeInts(&indexCount, 1);
 
         // bool indexes32Bit
@@ -277,6 +427,9 @@ namespace Ogre {
         // Operation type
         writeSubMeshOperation(s);
 
+        if (compressedIndexes)
+            writeSubMeshIndexDataCompressed(s);
+
         // Bone assignments
         if (!s->mBoneAssignments.empty())
         {
@@ -346,6 +499,26 @@ namespace Ogre {
         writeShorts(&opType, 1);
     }
     //---------------------------------------------------------------------
+    void MeshSerializerImpl::writeSubMeshIndexDataCompressed(const SubMesh* s)
+    {
+        const auto& data = *getCompressedBuffer(s->indexData->indexBuffer.get(), s->indexData->indexCount);
+        writeChunkHeader(M_SUBMESH_INDEX_DATA_COMPRESSED, calcSubMeshIndexDataCompressedSize(s));
+
+        // unsigned int indexCount
+        unsigned int indexCount = static_cast<unsigned int>(s->indexData->indexCount);
+        writeInts(&indexCount, 1);
+        // bool indexes32Bit
+        bool idx32bit = s->indexData->indexBuffer->getType() == HardwareIndexBuffer::IT_32BIT;
+        writeBools(&idx32bit, 1);
+        writeData(data.data(), 1, data.size());
+    }
+    //---------------------------------------------------------------------
+    size_t MeshSerializerImpl::calcSubMeshIndexDataCompressedSize(const SubMesh* pSub)
+    {
+        const auto& data = *getCompressedBuffer(pSub->indexData->indexBuffer.get(), pSub->indexData->indexCount);
+        return MSTREAM_OVERHEAD_SIZE + sizeof(unsigned int) + sizeof(bool) + data.size();
+    }
+    //---------------------------------------------------------------------
     void MeshSerializerImpl::writeGeometry(const VertexData* vertexData)
     {
         const VertexDeclaration::VertexElementList& elemList =
@@ -398,6 +571,9 @@ namespace Ogre {
         {
             const HardwareVertexBufferSharedPtr& vbuf = vbi.second;
             size_t vbufSizeInBytes = vbuf->getVertexSize() * vertexData->vertexCount; // vbuf->getSizeInBytes() is too large for meshes prepared for shadow volumes
+            const auto* compressed = getCompressedBuffer(vbuf.get(), vertexData->vertexCount);
+            if (compressed)
+                vbufSizeInBytes = compressed->size();
             size = (MSTREAM_OVERHEAD_SIZE * 2) + (sizeof(unsigned short) * 2) + vbufSizeInBytes;
             writeChunkHeader(M_GEOMETRY_VERTEX_BUFFER,  size);
             // unsigned short bindIndex;    // Index to bind this buffer to
@@ -410,6 +586,14 @@ namespace Ogre {
                 {
             // Data
             size = MSTREAM_OVERHEAD_SIZE + vbufSizeInBytes;
+            if (compressed)
+            {
+                // already little endian
+                writeChunkHeader(M_GEOMETRY_VERTEX_BUFFER_DATA_COMPRESSED, size);
+                writeData(compressed->data(), 1, compressed->size());
+            }
+            else
+            {
             writeChunkHeader(M_GEOMETRY_VERTEX_BUFFER_DATA, size);
             HardwareBufferLockGuard vbufLock(vbuf, HardwareBuffer::HBL_READ_ONLY);
 
@@ -431,6 +615,7 @@ namespace Ogre {
             {
                 writeData(vbufLock.pData, vbuf->getVertexSize(), vertexData->vertexCount);
             }
+            }
         }
                 popInnerChunk(mStream);
             }
@@ -512,6 +697,9 @@ namespace Ogre {
 
         size += calcExtremesSize(pMesh);
 
+        if (!pMesh->getQuantisationBounds().isNull())
+            size += calcQuantisationInfoSize();
+
         return size;
     }
     //---------------------------------------------------------------------
@@ -532,7 +720,9 @@ namespace Ogre {
         bool idx32bit = (pSub->indexData->indexBuffer &&
             pSub->indexData->indexBuffer->getType() == HardwareIndexBuffer::IT_32BIT);
         // unsigned int* / unsigned short* faceVertexIndices
-        if (idx32bit)
+        if (getCompressedBuffer(pSub->indexData->indexBuffer.get(), pSub->indexData->indexCount))
+            size += calcSubMeshIndexDataCompressedSize(pSub);
+        else if (idx32bit)
             size += sizeof(unsigned int) * pSub->indexData->indexCount;
         else
             size += sizeof(unsigned short) * pSub->indexData->indexCount;
@@ -576,7 +766,10 @@ namespace Ogre {
         for (auto& vbi : bindings)
         {
             const HardwareVertexBufferSharedPtr& vbuf = vbi.second;
-            size += vbuf->getVertexSize() * vertexData->vertexCount; // vbuf->getSizeInBytes() is too large for meshes prepared for shadow volumes
+            if (const auto* compressed = getCompressedBuffer(vbuf.get(), vertexData->vertexCount))
+                size += compressed->size();
+            else
+                size += vbuf->getVertexSize() * vertexData->vertexCount; // vbuf->getSizeInBytes() is too large for meshes prepared for shadow volumes
         }
         return size;
     }
@@ -590,6 +783,7 @@ namespace Ogre {
         unsigned int vertexCount = 0;
         readInts(stream, &vertexCount, 1);
         dest->vertexCount = vertexCount;
+        size_t numDecodeJobs = mDecodeJobs.size();
         // Find optional geometry streams
         if (!stream->eof())
         {
@@ -622,6 +816,15 @@ namespace Ogre {
             popInnerChunk(stream);
         }
 
+        // compressed buffers are populated once the whole mesh was read
+        if (mDecodeJobs.size() != numDecodeJobs)
+            mDeferredGeometry.push_back(dest);
+        else
+            finaliseGeometry(dest);
+    }
+    //---------------------------------------------------------------------
+    void MeshSerializerImpl::finaliseGeometry(VertexData* dest)
+    {
         // Perform any necessary colour conversions from ARGB to ABGR (UBYTE4)
         dest->convertPackedColour(_DETAIL_SWAP_RB, VET_UBYTE4_NORM);
 
@@ -718,7 +921,7 @@ namespace Ogre {
         // Check for vertex data header
         unsigned short headerID;
         headerID = readChunk(stream);
-        if (headerID != M_GEOMETRY_VERTEX_BUFFER_DATA)
+        if (headerID != M_GEOMETRY_VERTEX_BUFFER_DATA && headerID != M_GEOMETRY_VERTEX_BUFFER_DATA_COMPRESSED)
         {
             OGRE_EXCEPT(Exception::ERR_ITEM_NOT_FOUND, "Can't find vertex buffer data area",
                 "MeshSerializerImpl::readGeometryVertexBuffer");
@@ -737,6 +940,26 @@ namespace Ogre {
             dest->vertexCount,
             pMesh->mVertexBufferUsage,
             pMesh->mVertexBufferShadowBuffer);
+
+        if (headerID == M_GEOMETRY_VERTEX_BUFFER_DATA_COMPRESSED)
+        {
+            // keep the buffer locked and decode it in parallel with the others, see decompressGeometry
+            DecodeJob job;
+            job.data.resize(mCurrentstreamLen - MSTREAM_OVERHEAD_SIZE);
+            stream->read(job.data.data(), job.data.size());
+            job.buffer = vbuf;
+            job.vertexCount = dest->vertexCount;
+            job.vertexSize = vertexSize;
+            job.elems = dest->vertexDeclaration->findElementsBySource(bindIndex);
+            job.owner = dest;
+            job.pDest = vbuf->lock(HardwareBuffer::HBL_DISCARD);
+            mDecodeJobs.push_back(std::move(job));
+
+            dest->vertexBufferBinding->setBinding(bindIndex, vbuf);
+            popInnerChunk(stream);
+            return;
+        }
+
         HardwareBufferLockGuard vbufLock(vbuf, HardwareBuffer::HBL_DISCARD);
         stream->read(vbufLock.pData, dest->vertexCount * vertexSize);
 
@@ -826,7 +1049,8 @@ namespace Ogre {
                  streamID == M_EDGE_LISTS ||
                  streamID == M_POSES ||
                  streamID == M_ANIMATIONS ||
-                 streamID == M_TABLE_EXTREMES))
+                 streamID == M_TABLE_EXTREMES ||
+                 streamID == M_MESH_QUANTISATION))
             {
                 switch(streamID)
                 {
@@ -838,6 +1062,7 @@ namespace Ogre {
                     catch (ItemIdentityException&)
                     {
                         // duff geometry data entry with 0 vertices
+                        discardDecodeJobs(pMesh->sharedVertexData);
                         pMesh->resetVertexData();
                         // Skip this stream (pointer will have been returned to just after header)
                         stream->skip(mCurrentstreamLen - MSTREAM_OVERHEAD_SIZE);
@@ -873,6 +1098,9 @@ namespace Ogre {
                 case M_TABLE_EXTREMES:
                     readExtremes(stream, pMesh);
                     break;
+                case M_MESH_QUANTISATION:
+                    readQuantisationInfo(stream, pMesh);
+                    break;
                 }
 
                 if (!stream->eof())
@@ -972,13 +1200,17 @@ namespace Ogre {
             while(!stream->eof() &&
                 (streamID == M_SUBMESH_BONE_ASSIGNMENT ||
                  streamID == M_SUBMESH_OPERATION ||
-                 streamID == M_SUBMESH_TEXTURE_ALIAS))
+                 streamID == M_SUBMESH_TEXTURE_ALIAS ||
+                 streamID == M_SUBMESH_INDEX_DATA_COMPRESSED))
             {
                 switch(streamID)
                 {
                 case M_SUBMESH_OPERATION:
                     readSubMeshOperation(stream, pMesh, sm);
                     break;
+                case M_SUBMESH_INDEX_DATA_COMPRESSED:
+                    readSubMeshIndexDataCompressed(stream, pMesh, sm);
+                    break;
                 case M_SUBMESH_BONE_ASSIGNMENT:
                     readSubMeshBoneAssignment(stream, pMesh, sm);
                     break;
@@ -1020,6 +1252,35 @@ namespace Ogre {
         sm->operationType = static_cast<RenderOperation::OperationType>(opType);
     }
     //---------------------------------------------------------------------
+    void MeshSerializerImpl::readSubMeshIndexDataCompressed(const DataStreamPtr& stream,
+        Mesh* pMesh, SubMesh* sm)
+    {
+        // unsigned int indexCount
+        unsigned int indexCount = 0;
+        readInts(stream, &indexCount, 1);
+        // bool indexes32Bit
+        bool idx32bit;
+        readBools(stream, &idx32bit, 1);
+
+        std::vector<uchar> data(mCurrentstreamLen - MSTREAM_OVERHEAD_SIZE - sizeof(unsigned int) - sizeof(bool));
+        stream->read(data.data(), data.size());
+
+        HardwareIndexBufferSharedPtr ibuf = pMesh->getHardwareBufferManager()->createIndexBuffer(
+            idx32bit ? HardwareIndexBuffer::IT_32BIT : HardwareIndexBuffer::IT_16BIT, indexCount,
+            pMesh->mIndexBufferUsage, pMesh->mIndexBufferShadowBuffer);
+        {
+            HardwareBufferLockGuard ibufLock(ibuf, HardwareBuffer::HBL_DISCARD);
+            if (!GeometryCodec::decodeIndexBuffer(ibufLock.pData, indexCount, idx32bit, data.data(), data.size()))
+            {
+                OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS, "Corrupt compressed index data",
+                            "MeshSerializerImpl::readSubMeshIndexDataCompressed");
+            }
+        }
+
+        sm->indexData->indexBuffer = ibuf;
+        sm->indexData->indexCount = indexCount;
+    }
+    //---------------------------------------------------------------------
     void MeshSerializerImpl::writeSkeletonLink(const String& skelName)
     {
         writeChunkHeader(M_MESH_SKELETON_LINK, calcSkeletonLinkSize(skelName));
@@ -2576,6 +2837,29 @@ namespace Ogre {
         readFloats(stream, sm->extremityPoints.front().ptr(), n_floats);
     }
 
+    //---------------------------------------------------------------------
+    void MeshSerializerImpl::writeQuantisationInfo(const Mesh* pMesh)
+    {
+        writeChunkHeader(M_MESH_QUANTISATION, calcQuantisationInfoSize());
+
+        const AxisAlignedBox& bounds = pMesh->getQuantisationBounds();
+        writeFloats(bounds.getMinimum().ptr(), 3);
+        writeFloats(bounds.getMaximum().ptr(), 3);
+    }
+    //---------------------------------------------------------------------
+    size_t MeshSerializerImpl::calcQuantisationInfoSize()
+    {
+        return MSTREAM_OVERHEAD_SIZE + sizeof(float) * 6;
+    }
+    //---------------------------------------------------------------------
+    void MeshSerializerImpl::readQuantisationInfo(const DataStreamPtr& stream, Mesh* pMesh)
+    {
+        Vector3 min, max;
+        readFloats(stream, min.ptr(), 3);
+        readFloats(stream, max.ptr(), 3);
+        pMesh->mQuantisationBounds.setExtents(min, max);
+    }
+
     void MeshSerializerImpl::enableValidation()
     {
 #if OGRE_SERIALIZER_VALIDATE_CHUNKSIZE
@@ -82,13 +82,46 @@ namespace Ogre {
         */
         void importMesh(const DataStreamPtr& stream, Mesh* pDest, MeshSerializerListener *listener);
 
+        /// Sets whether the vertex and index buffers are compressed on export
+        void setCompressGeometry(bool compress) { mCompressGeometry = compress; }
+
     protected:
+        /// A compressed vertex buffer, which is decoded once the whole mesh was read
+        struct DecodeJob
+        {
+            std::vector<uchar> data;
+            HardwareVertexBufferSharedPtr buffer;
+            void* pDest;
+            size_t vertexCount;
+            size_t vertexSize;
+            VertexDeclaration::VertexElementList elems;
+            VertexData* owner;
+        };
+        typedef std::vector<DecodeJob> DecodeJobList;
+        DecodeJobList mDecodeJobs;
+        /// geometry waiting for its buffers to be decoded
+        std::vector<VertexData*> mDeferredGeometry;
+
+        typedef std::map<std::pair<const HardwareBuffer*, size_t>, std::vector<uchar> > CompressedBufferMap;
+        CompressedBufferMap mCompressedBuffers;
+        bool mCompressGeometry;
+
+        /// Compresses all buffers of the mesh in parallel, ahead of calculating the chunk sizes
+        void compressGeometry(const Mesh* pMesh);
+        /// Decodes the pending buffers in parallel and unlocks them
+        void decompressGeometry();
+        /// Unlocks and drops the pending buffers of owner, or all if owner is NULL
+        void discardDecodeJobs(VertexData* owner = NULL);
+        /// Post processes the vertex data, once its buffers are populated
+        void finaliseGeometry(VertexData* dest);
+        const std::vector<uchar>* getCompressedBuffer(const HardwareBuffer* buf, size_t count) const;
 
         // Internal methods
         virtual void writeSubMeshNameTable(const Mesh* pMesh);
         virtual void writeMesh(const Mesh* pMesh);
         virtual void writeSubMesh(const SubMesh* s);
         virtual void writeSubMeshOperation(const SubMesh* s);
+        virtual void writeSubMeshIndexDataCompressed(const SubMesh* s);
         virtual void writeGeometry(const VertexData* pGeom);
         virtual void writeSkeletonLink(const String& skelName);
         virtual void writeMeshBoneAssignment(const VertexBoneAssignment& assign);
@@ -111,6 +144,7 @@ namespace Ogre {
         virtual void writePoseKeyframePoseRef(const VertexPoseKeyFrame::PoseRef& poseRef);
         virtual void writeExtremes(const Mesh *pMesh);
         virtual void writeSubMeshExtremes(unsigned short idx, const SubMesh* s);
+        virtual void writeQuantisationInfo(const Mesh* pMesh);
 
         virtual size_t calcMeshSize(const Mesh* pMesh);
         virtual size_t calcSubMeshSize(const SubMesh* pSub);
@@ -118,6 +152,7 @@ namespace Ogre {
         virtual size_t calcSkeletonLinkSize(const String& skelName);
         virtual size_t calcBoneAssignmentSize(void);
         virtual size_t calcSubMeshOperationSize();
+        virtual size_t calcSubMeshIndexDataCompressedSize(const SubMesh* pSub);
         virtual size_t calcSubMeshNameTableSize(const Mesh* pMesh);
         virtual size_t calcLodLevelSize(const Mesh* pMesh);
         virtual size_t calcLodUsageManualSize(const MeshLodUsage& usage);
@@ -138,12 +173,14 @@ namespace Ogre {
         virtual size_t calcBoundsInfoSize();
         virtual size_t calcExtremesSize(const Mesh* pMesh);
         virtual size_t calcSubMeshExtremesSize(const SubMesh* s);
+        virtual size_t calcQuantisationInfoSize();
 
         virtual void readTextureLayer(const DataStreamPtr& stream, Mesh* pMesh, MaterialPtr& pMat);
         virtual void readSubMeshNameTable(const DataStreamPtr& stream, Mesh* pMesh);
         virtual void readMesh(const DataStreamPtr& stream, Mesh* pMesh, MeshSerializerListener *listener);
         virtual void readSubMesh(const DataStreamPtr& stream, Mesh* pMesh, MeshSerializerListener *listener);
         virtual void readSubMeshOperation(const DataStreamPtr& stream, Mesh* pMesh, SubMesh* sub);
+        virtual void readSubMeshIndexDataCompressed(const DataStreamPtr& stream, Mesh* pMesh, SubMesh* sub);
         virtual void readGeometry(const DataStreamPtr& stream, Mesh* pMesh, VertexData* dest);
         virtual void readGeometryVertexDeclaration(const DataStreamPtr& stream, Mesh* pMesh, VertexData* dest);
         virtual void readGeometryVertexElement(const DataStreamPtr& stream, Mesh* pMesh, VertexData* dest);
@@ -170,6 +207,7 @@ namespace Ogre {
         virtual void readMorphKeyFrame(const DataStreamPtr& stream, Mesh* pMesh, VertexAnimationTrack* track);
         virtual void readPoseKeyFrame(const DataStreamPtr& stream, VertexAnimationTrack* track);
         virtual void readExtremes(const DataStreamPtr& stream, Mesh *pMesh);
+        virtual void readQuantisationInfo(const DataStreamPtr& stream, Mesh* pMesh);
 
 
         /// Flip an entire vertex buffer from little endian
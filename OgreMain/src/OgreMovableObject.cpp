@@ -30,6 +30,7 @@ THE SOFTWARE.
 #include "OgreTagPoint.h"
 #include "OgreEntity.h"
 #include "OgreLodListener.h"
+#include "OgreBoundingVolumeHierarchy.h"
 
 namespace Ogre {
     //-----------------------------------------------------------------------
@@ -62,6 +63,7 @@ namespace Ogre {
         , mVisibilityFlags(msDefaultVisibilityFlags)
         , mLightListUpdated(0)
         , mLightMask(0xFFFFFFFF)
+        , mSceneQueryLeaf(BoundingVolumeHierarchy::NOT_TRACKED)
     {
         if (Root::getSingletonPtr())
             mMinPixelSize = Root::getSingleton().getDefaultMinPixelSize();
@@ -76,6 +78,9 @@ namespace Ogre {
         }
 
         detachFromParent(); // this should never throw, if it does terminating is the thing to do
+
+        if (mManager && mSceneQueryLeaf != BoundingVolumeHierarchy::NOT_TRACKED)
+            mManager->_notifyMovableObjectDetached(this);
     }
     //-----------------------------------------------------------------------
     void MovableObject::_notifyAttached(Node* parent, bool isTagPoint)
@@ -87,6 +92,10 @@ namespace Ogre {
         mParentNode = parent;
         mParentIsTagPoint = isTagPoint;
 
+        // Detached objects are not searched by the default scene queries
+        if (!parent && mManager && mSceneQueryLeaf != BoundingVolumeHierarchy::NOT_TRACKED)
+            mManager->_notifyMovableObjectDetached(this);
+
         // Mark light list being dirty, simply decrease
         // counter by one for minimise overhead
         --mLightListUpdated;
@@ -288,6 +297,9 @@ namespace Ogre {
         {
             mWorldAABB = this->getBoundingBox();
             mWorldAABB.transform(_getParentNodeFullTransform());
+
+            if (mParentNode && mManager && mSceneQueryLeaf != BoundingVolumeHierarchy::NOT_TRACKED)
+                mManager->_notifyMovableObjectBoundsUpdated(const_cast<MovableObject*>(this));
         }
 
         return mWorldAABB;
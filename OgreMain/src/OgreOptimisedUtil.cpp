@@ -38,6 +38,16 @@ namespace Ogre {
 #if __OGRE_HAVE_SSE || __OGRE_HAVE_NEON
     extern OptimisedUtil* _getOptimisedUtilSSE(void);
 #endif
+#if __OGRE_HAVE_AVX2
+    extern OptimisedUtil* _getOptimisedUtilAVX(void);
+#endif
+
+    //---------------------------------------------------------------------
+    static bool _isAVX2Supported(void)
+    {
+        const uint required = PlatformInformation::CPU_FEATURE_AVX2 | PlatformInformation::CPU_FEATURE_FMA;
+        return (PlatformInformation::getCpuFeatures() & required) == required;
+    }
 
 #ifdef __DO_PROFILE__
     //---------------------------------------------------------------------
@@ -50,6 +60,9 @@ namespace Ogre {
             IMPL_DEFAULT,
 #if __OGRE_HAVE_SSE || __OGRE_HAVE_NEON
             IMPL_SSE,
+#endif
+#if __OGRE_HAVE_AVX2
+            IMPL_AVX,
 #endif
             IMPL_COUNT
         };
@@ -97,6 +110,12 @@ namespace Ogre {
             {
                 mOptimisedUtils.push_back(_getOptimisedUtilSSE());
             }
+#endif
+#if __OGRE_HAVE_AVX2
+            if (_isAVX2Supported())
+            {
+                mOptimisedUtils.push_back(_getOptimisedUtilAVX());
+            }
 #endif
         }
 
@@ -315,6 +334,36 @@ namespace Ogre {
             ++index;    // So we can put break point here even if in release build
         }
 
+        virtual void calculateSphereVisibility(
+            const Vector4* planes,
+            size_t numPlanes,
+            const Vector4* spheres,
+            char* visibilities,
+            size_t numSpheres)
+        {
+            static ProfileItems results;
+            static size_t index;
+            index = Root::getSingleton().getNextFrameNumber() % mOptimisedUtils.size();
+            OptimisedUtil* impl = mOptimisedUtils[index];
+            ProfileItem& profile = results[index];
+
+            profile.begin();
+            impl->calculateSphereVisibility(
+                planes,
+                numPlanes,
+                spheres,
+                visibilities,
+                numSpheres);
+            profile.end();
+
+            LogManager::getSingleton().logMessage(StringUtil::format(
+                "OptimisedUtilProfiler: %s - impl %zu = %u avg ticks\n", __FUNCTION__, index, profile.mAvgTicks));
+
+            // You can put break point here while running test application, to
+            // watch profile results.
+            ++index;    // So we can put break point here even if in release build
+        }
+
     };
 #endif // __DO_PROFILE__
 
@@ -368,6 +417,13 @@ namespace Ogre {
 
 #else   // !__DO_PROFILE__
 
+#if __OGRE_HAVE_AVX2
+        if (_isAVX2Supported())
+        {
+            return _getOptimisedUtilAVX();
+        }
+        else
+#endif
 #if __OGRE_HAVE_SSE
         if (PlatformInformation::getCpuFeatures() & PlatformInformation::CPU_FEATURE_SSE)
         {
@@ -387,5 +443,23 @@ namespace Ogre {
 
 #endif  // __DO_PROFILE__
     }
+    //---------------------------------------------------------------------
+    OptimisedUtil::NamedImplementationList OptimisedUtil::getSupportedImplementations(void)
+    {
+        NamedImplementationList ret;
+        ret.push_back(NamedImplementation("General", _getOptimisedUtilGeneral()));
+#if __OGRE_HAVE_SSE
+        if (PlatformInformation::getCpuFeatures() & PlatformInformation::CPU_FEATURE_SSE)
+            ret.push_back(NamedImplementation("SSE", _getOptimisedUtilSSE()));
+#elif __OGRE_HAVE_NEON
+        if (PlatformInformation::getCpuFeatures() & PlatformInformation::CPU_FEATURE_NEON)
+            ret.push_back(NamedImplementation("NEON", _getOptimisedUtilSSE()));
+#endif
+#if __OGRE_HAVE_AVX2
+        if (_isAVX2Supported())
+            ret.push_back(NamedImplementation("AVX2", _getOptimisedUtilAVX()));
+#endif
+        return ret;
+    }
 
 }
@@ -0,0 +1,830 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "OgreStableHeaders.h"
+#include "OgreOptimisedUtil.h"
+
+#if __OGRE_HAVE_AVX2
+
+#include <immintrin.h>
+
+//-------------------------------------------------------------------------
+//
+// The AVX2 and FMA instructions are enabled per function rather than for
+// the whole file, so the rest of OgreMain keeps running on any x86 CPU and
+// no inline function of a header gets compiled with them by accident.
+// The implementation is only picked when PlatformInformation reports both
+// AVX2 and FMA, which includes the OS saving the YMM registers.
+//
+// All loads and stores are unaligned, these cost nothing extra on AVX
+// capable CPUs when the data happen to be aligned.
+//
+//-------------------------------------------------------------------------
+
+#if OGRE_COMPILER == OGRE_COMPILER_MSVC
+#   define OGRE_AVX2_TARGET
+#else
+#   define OGRE_AVX2_TARGET __attribute__((target("avx2,fma")))
+#endif
+
+namespace Ogre {
+
+//-------------------------------------------------------------------------
+// Local classes
+//-------------------------------------------------------------------------
+
+    /** AVX2 implementation of OptimisedUtil.
+    @note
+        Don't use this class directly, use OptimisedUtil instead.
+    */
+    class _OgrePrivate OptimisedUtilAVX : public OptimisedUtil
+    {
+    public:
+        /// @copydoc OptimisedUtil::softwareVertexSkinning
+        void softwareVertexSkinning(
+            const float *srcPosPtr, float *destPosPtr,
+            const float *srcNormPtr, float *destNormPtr,
+            const float *blendWeightPtr, const unsigned char* blendIndexPtr,
+            const Affine3* const* blendMatrices,
+            size_t srcPosStride, size_t destPosStride,
+            size_t srcNormStride, size_t destNormStride,
+            size_t blendWeightStride, size_t blendIndexStride,
+            size_t numWeightsPerVertex,
+            size_t numVertices) override;
+
+        /// @copydoc OptimisedUtil::softwareVertexMorph
+        void softwareVertexMorph(
+            float t,
+            const float *srcPos1, const float *srcPos2,
+            float *dstPos,
+            size_t pos1VSize, size_t pos2VSize, size_t dstVSize,
+            size_t numVertices,
+            bool morphNormals) override;
+
+        /// @copydoc OptimisedUtil::concatenateAffineMatrices
+        void concatenateAffineMatrices(
+            const Affine3& baseMatrix,
+            const Affine3* srcMatrices,
+            Affine3* dstMatrices,
+            size_t numMatrices) override;
+
+        /// @copydoc OptimisedUtil::calculateFaceNormals
+        void calculateFaceNormals(
+            const float *positions,
+            const EdgeData::Triangle *triangles,
+            Vector4 *faceNormals,
+            size_t numTriangles) override;
+
+        /// @copydoc OptimisedUtil::calculateLightFacing
+        void calculateLightFacing(
+            const Vector4& lightPos,
+            const Vector4* faceNormals,
+            char* lightFacings,
+            size_t numFaces) override;
+
+        /// @copydoc OptimisedUtil::extrudeVertices
+        void extrudeVertices(
+            const Vector4& lightPos,
+            Real extrudeDist,
+            const float* srcPositions,
+            float* destPositions,
+            size_t numVertices) override;
+
+        /// @copydoc OptimisedUtil::calculateSphereVisibility
+        void calculateSphereVisibility(
+            const Vector4* planes,
+            size_t numPlanes,
+            const Vector4* spheres,
+            char* visibilities,
+            size_t numSpheres) override;
+    };
+    //---------------------------------------------------------------------
+    // Helpers
+    //---------------------------------------------------------------------
+    /// Loads x, y, z with w = 0, without touching memory past the vector
+    static OGRE_FORCE_INLINE OGRE_AVX2_TARGET __m128 _load3(const float* p)
+    {
+        return _mm_movelh_ps(_mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64*>(p)), _mm_load_ss(p + 2));
+    }
+    //---------------------------------------------------------------------
+    /// Stores x, y, z, without touching memory past the vector
+    static OGRE_FORCE_INLINE OGRE_AVX2_TARGET void _store3(float* p, __m128 v)
+    {
+        _mm_storel_pi(reinterpret_cast<__m64*>(p), v);
+        _mm_store_ss(p + 2, _mm_movehl_ps(v, v));
+    }
+    //---------------------------------------------------------------------
+    /** Reciprocal square root, refined by one Newton-Raphson iteration, which is
+        close enough to 1 / sqrt(x) and much cheaper.
+    */
+    static OGRE_FORCE_INLINE OGRE_AVX2_TARGET __m128 _rsqrt(__m128 x)
+    {
+        __m128 r = _mm_rsqrt_ps(x);
+        return _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), r), _mm_fnmadd_ps(_mm_mul_ps(x, r), r, _mm_set1_ps(3.0f)));
+    }
+    //---------------------------------------------------------------------
+    static OGRE_FORCE_INLINE OGRE_AVX2_TARGET __m256 _rsqrt(__m256 x)
+    {
+        __m256 r = _mm256_rsqrt_ps(x);
+        return _mm256_mul_ps(_mm256_mul_ps(_mm256_set1_ps(0.5f), r),
+                             _mm256_fnmadd_ps(_mm256_mul_ps(x, r), r, _mm256_set1_ps(3.0f)));
+    }
+    //---------------------------------------------------------------------
+    /// Same as Vector3::normalise, zero-sized vectors are left unchanged
+    static OGRE_FORCE_INLINE OGRE_AVX2_TARGET __m128 _normalise3(__m128 v)
+    {
+        __m128 len2 = _mm_dp_ps(v, v, 0x7F);
+        len2 = _mm_max_ps(len2, _mm_set1_ps(std::numeric_limits<float>::min()));
+        return _mm_mul_ps(v, _rsqrt(len2));
+    }
+    //---------------------------------------------------------------------
+    static OGRE_FORCE_INLINE OGRE_AVX2_TARGET __m256 _duplicate(__m128 v)
+    {
+        return _mm256_insertf128_ps(_mm256_castps128_ps256(v), v, 1);
+    }
+    //---------------------------------------------------------------------
+    /** Loads 8 packed xyz vectors and transposes them, x, y and z receive
+        the components of the vectors in order.
+    */
+    static OGRE_FORCE_INLINE OGRE_AVX2_TARGET void _loadTransposed8x3(
+        const float* p, __m256& x, __m256& y, __m256& z)
+    {
+        // [x0 y0 z0 x1 | x4 y4 z4 x5], [y1 z1 x2 y2 | y5 z5 x6 y6], [z2 x3 y3 z3 | z6 x7 y7 z7]
+        __m256 m03 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(p + 0)), _mm_loadu_ps(p + 12), 1);
+        __m256 m14 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(p + 4)), _mm_loadu_ps(p + 16), 1);
+        __m256 m25 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(p + 8)), _mm_loadu_ps(p + 20), 1);
+
+        __m256 xy = _mm256_shuffle_ps(m14, m25, _MM_SHUFFLE(2, 1, 3, 2));   // [x2 y2 x3 y3]
+        __m256 yz = _mm256_shuffle_ps(m03, m14, _MM_SHUFFLE(1, 0, 2, 1));   // [y0 z0 y1 z1]
+        x = _mm256_shuffle_ps(m03, xy, _MM_SHUFFLE(2, 0, 3, 0));            // [x0 x1 x2 x3]
+        y = _mm256_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0));             // [y0 y1 y2 y3]
+        z = _mm256_shuffle_ps(yz, m25, _MM_SHUFFLE(3, 0, 3, 1));            // [z0 z1 z2 z3]
+    }
+    //---------------------------------------------------------------------
+    /// Inverse of _loadTransposed8x3
+    static OGRE_FORCE_INLINE OGRE_AVX2_TARGET void _storeTransposed8x3(
+        float* p, __m256 x, __m256 y, __m256 z)
+    {
+        __m256 xy = _mm256_shuffle_ps(x, y, _MM_SHUFFLE(2, 0, 2, 0));       // [x0 x2 y0 y2]
+        __m256 yz = _mm256_shuffle_ps(y, z, _MM_SHUFFLE(3, 1, 3, 1));       // [y1 y3 z1 z3]
+        __m256 zx = _mm256_shuffle_ps(z, x, _MM_SHUFFLE(3, 1, 2, 0));       // [z0 z2 x1 x3]
+        __m256 m03 = _mm256_shuffle_ps(xy, zx, _MM_SHUFFLE(2, 0, 2, 0));    // [x0 y0 z0 x1]
+        __m256 m14 = _mm256_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0));    // [y1 z1 x2 y2]
+        __m256 m25 = _mm256_shuffle_ps(zx, yz, _MM_SHUFFLE(3, 1, 3, 1));    // [z2 x3 y3 z3]
+
+        _mm256_storeu_ps(p + 0, _mm256_permute2f128_ps(m03, m14, 0x20));
+        _mm256_storeu_ps(p + 8, _mm256_permute2f128_ps(m25, m03, 0x30));
+        _mm256_storeu_ps(p + 16, _mm256_permute2f128_ps(m14, m25, 0x31));
+    }
+    //---------------------------------------------------------------------
+    /** Loads 8 Vector4 and transposes them. Note the lanes hold the vectors
+        in the order 0, 2, 4, 6, 1, 3, 5, 7, see _storeFlags8.
+    */
+    static OGRE_FORCE_INLINE OGRE_AVX2_TARGET void _loadTransposed8x4(
+        const Vector4* v, __m256& x, __m256& y, __m256& z, __m256& w)
+    {
+        __m256 v01 = _mm256_loadu_ps(&v[0].x);
+        __m256 v23 = _mm256_loadu_ps(&v[2].x);
+        __m256 v45 = _mm256_loadu_ps(&v[4].x);
+        __m256 v67 = _mm256_loadu_ps(&v[6].x);
+
+        __m256 t0 = _mm256_unpacklo_ps(v01, v23);   // [x0 x2 y0 y2 | x1 x3 y1 y3]
+        __m256 t1 = _mm256_unpackhi_ps(v01, v23);   // [z0 z2 w0 w2 | z1 z3 w1 w3]
+        __m256 t2 = _mm256_unpacklo_ps(v45, v67);
+        __m256 t3 = _mm256_unpackhi_ps(v45, v67);
+
+        x = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+        y = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+        z = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+        w = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+    }
+    //---------------------------------------------------------------------
+    /// Stores the result of a comparison of 8 lanes loaded by _loadTransposed8x4 as flags
+    static OGRE_FORCE_INLINE OGRE_AVX2_TARGET void _storeFlags8(char* dst, __m256 cmp)
+    {
+        // Pack to bytes, then restore the order of the vectors
+        __m128i words = _mm_packs_epi32(_mm_castps_si128(_mm256_castps256_ps128(cmp)),
+                                        _mm_castps_si128(_mm256_extractf128_ps(cmp, 1)));
+        __m128i bytes = _mm_shuffle_epi8(_mm_packs_epi16(words, words),
+                                         _mm_setr_epi8(0, 4, 1, 5, 2, 6, 3, 7, 0, 4, 1, 5, 2, 6, 3, 7));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dst), _mm_and_si128(bytes, _mm_set1_epi8(1)));
+    }
+    //---------------------------------------------------------------------
+    /** Collapses the blend matrices of a vertex weighted by its blend weights,
+        and transposes the result to columns, with w = 0.
+    @remarks
+        Rows 0 and 1 of the matrices share a register. The weights are
+        normalised, so there is no need to skip the zero ones.
+    */
+    template <size_t numWeights>
+    static OGRE_FORCE_INLINE OGRE_AVX2_TARGET void _collapseMatrix(
+        __m128& c0, __m128& c1, __m128& c2, __m128& c3,
+        const Affine3* const* blendMatrices,
+        const float* pBlendWeight, const unsigned char* pBlendIndex,
+        size_t numWeightsPerVertex)
+    {
+        __m256 m01 = _mm256_setzero_ps();
+        __m128 m2 = _mm_setzero_ps();
+        for (size_t blendIdx = 0; blendIdx < (numWeights ? numWeights : numWeightsPerVertex); ++blendIdx)
+        {
+            const float* mat = (*blendMatrices[pBlendIndex[blendIdx]])[0];
+            __m256 weight = _mm256_broadcast_ss(pBlendWeight + blendIdx);
+            m01 = _mm256_fmadd_ps(_mm256_loadu_ps(mat), weight, m01);
+            m2 = _mm_fmadd_ps(_mm_loadu_ps(mat + 8), _mm256_castps256_ps128(weight), m2);
+        }
+        c0 = _mm256_castps256_ps128(m01);
+        c1 = _mm256_extractf128_ps(m01, 1);
+        c2 = m2;
+        c3 = _mm_setzero_ps();
+        _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+    }
+    //---------------------------------------------------------------------
+    /** Normalises two vectors at once, one per 128 bits lane, w must be 0.
+        Zero-sized vectors are left unchanged, like Vector3::normalise.
+    */
+    static OGRE_FORCE_INLINE OGRE_AVX2_TARGET __m256 _normalise3x2(__m256 v)
+    {
+        __m256 sq = _mm256_mul_ps(v, v);
+        __m256 len2 = _mm256_add_ps(sq, _mm256_permute_ps(sq, _MM_SHUFFLE(1, 0, 3, 2)));
+        len2 = _mm256_add_ps(len2, _mm256_permute_ps(len2, _MM_SHUFFLE(2, 3, 0, 1)));
+        // Zero-sized vectors stay zero-sized rather than becoming NaN
+        len2 = _mm256_max_ps(len2, _mm256_set1_ps(std::numeric_limits<float>::min()));
+        return _mm256_mul_ps(v, _rsqrt(len2));
+    }
+    //---------------------------------------------------------------------
+    /** Skins the position of a vertex, and returns its normal transformed but not
+        normalised when blendNormal.
+    */
+    template <bool blendNormal, size_t numWeights>
+    static OGRE_FORCE_INLINE OGRE_AVX2_TARGET __m128 _skinVertex(
+        const float *pSrcPos, float *pDestPos, const float *pSrcNorm,
+        const float *pBlendWeight, const unsigned char* pBlendIndex,
+        const Affine3* const* blendMatrices, size_t numWeightsPerVertex)
+    {
+        __m128 c0, c1, c2, c3;
+        _collapseMatrix<numWeights>(c0, c1, c2, c3, blendMatrices, pBlendWeight, pBlendIndex, numWeightsPerVertex);
+
+        // Transform position by the 3x4 matrix
+        __m128 pos = _mm_fmadd_ps(c0, _mm_broadcast_ss(pSrcPos + 0),
+                     _mm_fmadd_ps(c1, _mm_broadcast_ss(pSrcPos + 1),
+                     _mm_fmadd_ps(c2, _mm_broadcast_ss(pSrcPos + 2), c3)));
+        _store3(pDestPos, pos);
+
+        if (!blendNormal)
+            return pos;
+
+        // Transform normal by the 3x3 part
+        return _mm_fmadd_ps(c0, _mm_broadcast_ss(pSrcNorm + 0),
+               _mm_fmadd_ps(c1, _mm_broadcast_ss(pSrcNorm + 1),
+               _mm_mul_ps(c2, _mm_broadcast_ss(pSrcNorm + 2))));
+    }
+    //---------------------------------------------------------------------
+    template <bool blendNormal, size_t numWeights>
+    static OGRE_AVX2_TARGET void softwareVertexSkinning_AVX(
+        const float *pSrcPos, float *pDestPos,
+        const float *pSrcNorm, float *pDestNorm,
+        const float *pBlendWeight, const unsigned char* pBlendIndex,
+        const Affine3* const* blendMatrices,
+        size_t srcPosStride, size_t destPosStride,
+        size_t srcNormStride, size_t destNormStride,
+        size_t blendWeightStride, size_t blendIndexStride,
+        size_t numWeightsPerVertex,
+        size_t numVertices)
+    {
+        if (blendNormal)
+        {
+            // Two vertices per-iteration, so the normals are normalised together
+            for ( ; numVertices >= 2; numVertices -= 2)
+            {
+                __m128 norm0 = _skinVertex<true, numWeights>(pSrcPos, pDestPos, pSrcNorm,
+                    pBlendWeight, pBlendIndex, blendMatrices, numWeightsPerVertex);
+                float* pDestNorm0 = pDestNorm;
+                advanceRawPointer(pSrcPos, srcPosStride);
+                advanceRawPointer(pDestPos, destPosStride);
+                advanceRawPointer(pSrcNorm, srcNormStride);
+                advanceRawPointer(pDestNorm, destNormStride);
+                advanceRawPointer(pBlendWeight, blendWeightStride);
+                advanceRawPointer(pBlendIndex, blendIndexStride);
+
+                __m128 norm1 = _skinVertex<true, numWeights>(pSrcPos, pDestPos, pSrcNorm,
+                    pBlendWeight, pBlendIndex, blendMatrices, numWeightsPerVertex);
+
+                __m256 norm = _normalise3x2(_mm256_insertf128_ps(_mm256_castps128_ps256(norm0), norm1, 1));
+                _store3(pDestNorm0, _mm256_castps256_ps128(norm));
+                _store3(pDestNorm, _mm256_extractf128_ps(norm, 1));
+
+                advanceRawPointer(pSrcPos, srcPosStride);
+                advanceRawPointer(pDestPos, destPosStride);
+                advanceRawPointer(pSrcNorm, srcNormStride);
+                advanceRawPointer(pDestNorm, destNormStride);
+                advanceRawPointer(pBlendWeight, blendWeightStride);
+                advanceRawPointer(pBlendIndex, blendIndexStride);
+            }
+
+            if (numVertices)
+            {
+                __m128 norm = _skinVertex<true, numWeights>(pSrcPos, pDestPos, pSrcNorm,
+                    pBlendWeight, pBlendIndex, blendMatrices, numWeightsPerVertex);
+                _store3(pDestNorm, _normalise3(norm));
+            }
+        }
+        else
+        {
+            for (size_t vertIdx = 0; vertIdx < numVertices; ++vertIdx)
+            {
+                _skinVertex<false, numWeights>(pSrcPos, pDestPos, NULL,
+                    pBlendWeight, pBlendIndex, blendMatrices, numWeightsPerVertex);
+
+                advanceRawPointer(pSrcPos, srcPosStride);
+                advanceRawPointer(pDestPos, destPosStride);
+                advanceRawPointer(pBlendWeight, blendWeightStride);
+                advanceRawPointer(pBlendIndex, blendIndexStride);
+            }
+        }
+    }
+    //---------------------------------------------------------------------
+    template <bool blendNormal>
+    static void softwareVertexSkinning_AVX(
+        const float *pSrcPos, float *pDestPos,
+        const float *pSrcNorm, float *pDestNorm,
+        const float *pBlendWeight, const unsigned char* pBlendIndex,
+        const Affine3* const* blendMatrices,
+        size_t srcPosStride, size_t destPosStride,
+        size_t srcNormStride, size_t destNormStride,
+        size_t blendWeightStride, size_t blendIndexStride,
+        size_t numWeightsPerVertex,
+        size_t numVertices)
+    {
+        // Unroll the blend weights loop for the usual counts
+#define __SKINNING_AVX(numWeights)                                                                      \
+        softwareVertexSkinning_AVX<blendNormal, numWeights>(                                            \
+            pSrcPos, pDestPos, pSrcNorm, pDestNorm, pBlendWeight, pBlendIndex, blendMatrices,           \
+            srcPosStride, destPosStride, srcNormStride, destNormStride,                                 \
+            blendWeightStride, blendIndexStride, numWeightsPerVertex, numVertices)
+
+        switch (numWeightsPerVertex)
+        {
+        case 1: __SKINNING_AVX(1); break;
+        case 2: __SKINNING_AVX(2); break;
+        case 3: __SKINNING_AVX(3); break;
+        case 4: __SKINNING_AVX(4); break;
+        default: __SKINNING_AVX(0); break;
+        }
+
+#undef __SKINNING_AVX
+    }
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    void OptimisedUtilAVX::softwareVertexSkinning(
+        const float *pSrcPos, float *pDestPos,
+        const float *pSrcNorm, float *pDestNorm,
+        const float *pBlendWeight, const unsigned char* pBlendIndex,
+        const Affine3* const* blendMatrices,
+        size_t srcPosStride, size_t destPosStride,
+        size_t srcNormStride, size_t destNormStride,
+        size_t blendWeightStride, size_t blendIndexStride,
+        size_t numWeightsPerVertex,
+        size_t numVertices)
+    {
+        if (pSrcNorm)
+            softwareVertexSkinning_AVX<true>(
+                pSrcPos, pDestPos, pSrcNorm, pDestNorm, pBlendWeight, pBlendIndex, blendMatrices,
+                srcPosStride, destPosStride, srcNormStride, destNormStride,
+                blendWeightStride, blendIndexStride, numWeightsPerVertex, numVertices);
+        else
+            softwareVertexSkinning_AVX<false>(
+                pSrcPos, pDestPos, pSrcNorm, pDestNorm, pBlendWeight, pBlendIndex, blendMatrices,
+                srcPosStride, destPosStride, srcNormStride, destNormStride,
+                blendWeightStride, blendIndexStride, numWeightsPerVertex, numVertices);
+    }
+    //---------------------------------------------------------------------
+    static OGRE_AVX2_TARGET void softwareVertexMorph_AVX(
+        float t,
+        const float *pSrc1, const float *pSrc2,
+        float *pDst,
+        size_t pos1VSize, size_t pos2VSize, size_t dstVSize,
+        size_t numVertices,
+        bool morphNormals)
+    {
+        const size_t vertexSize = (morphNormals ? 6 : 3) * sizeof(float);
+        if (pos1VSize == vertexSize && pos2VSize == vertexSize && dstVSize == vertexSize)
+        {
+            // Packed buffers, interpolate as a flat array of floats
+            const size_t numFloats = numVertices * vertexSize / sizeof(float);
+            const __m256 t8 = _mm256_set1_ps(t);
+            size_t i = 0;
+            for (; i + 8 <= numFloats; i += 8)
+            {
+                __m256 a = _mm256_loadu_ps(pSrc1 + i);
+                __m256 b = _mm256_loadu_ps(pSrc2 + i);
+                _mm256_storeu_ps(pDst + i, _mm256_fmadd_ps(t8, _mm256_sub_ps(b, a), a));
+            }
+            for (; i < numFloats; ++i)
+                pDst[i] = pSrc1[i] + t * (pSrc2[i] - pSrc1[i]);
+
+            // Nlerp, we don't have enough information for a spherical interpolation
+            if (morphNormals)
+            {
+                for (size_t v = 0; v < numVertices; ++v)
+                {
+                    float* pNorm = pDst + v * 6 + 3;
+                    _store3(pNorm, _normalise3(_load3(pNorm)));
+                }
+            }
+            return;
+        }
+
+        const __m128 t4 = _mm_set1_ps(t);
+        for (size_t v = 0; v < numVertices; ++v)
+        {
+            __m128 a = _load3(pSrc1);
+            __m128 b = _load3(pSrc2);
+            _store3(pDst, _mm_fmadd_ps(t4, _mm_sub_ps(b, a), a));
+
+            if (morphNormals)
+            {
+                // normals must be in the same buffer as pos
+                a = _load3(pSrc1 + 3);
+                b = _load3(pSrc2 + 3);
+                _store3(pDst + 3, _normalise3(_mm_fmadd_ps(t4, _mm_sub_ps(b, a), a)));
+            }
+
+            advanceRawPointer(pSrc1, pos1VSize);
+            advanceRawPointer(pSrc2, pos2VSize);
+            advanceRawPointer(pDst, dstVSize);
+        }
+    }
+    //---------------------------------------------------------------------
+    void OptimisedUtilAVX::softwareVertexMorph(
+        float t,
+        const float *pSrc1, const float *pSrc2,
+        float *pDst,
+        size_t pos1VSize, size_t pos2VSize, size_t dstVSize,
+        size_t numVertices,
+        bool morphNormals)
+    {
+        softwareVertexMorph_AVX(t, pSrc1, pSrc2, pDst, pos1VSize, pos2VSize, dstVSize, numVertices, morphNormals);
+    }
+    //---------------------------------------------------------------------
+    static OGRE_AVX2_TARGET void concatenateAffineMatrices_AVX(
+        const Affine3& baseMatrix,
+        const Affine3* pSrcMat,
+        Affine3* pDstMat,
+        size_t numMatrices)
+    {
+        // Row i of the result is the sum of the rows of the source weighted by
+        // row i of the base matrix, plus the translation of the latter.
+        __m256 b[3][4];
+        for (int i = 0; i < 3; ++i)
+        {
+            for (int j = 0; j < 3; ++j)
+                b[i][j] = _mm256_set1_ps(baseMatrix[i][j]);
+            b[i][3] = _mm256_setr_ps(0, 0, 0, baseMatrix[i][3], 0, 0, 0, baseMatrix[i][3]);
+        }
+
+        // Two matrices per-iteration
+        size_t i = 0;
+        for (; i + 2 <= numMatrices; i += 2, pSrcMat += 2, pDstMat += 2)
+        {
+            __m256 s[3];
+            for (int j = 0; j < 3; ++j)
+                s[j] = _mm256_insertf128_ps(
+                    _mm256_castps128_ps256(_mm_loadu_ps(pSrcMat[0][j])), _mm_loadu_ps(pSrcMat[1][j]), 1);
+
+            for (int r = 0; r < 3; ++r)
+            {
+                __m256 row = _mm256_fmadd_ps(b[r][0], s[0],
+                             _mm256_fmadd_ps(b[r][1], s[1],
+                             _mm256_fmadd_ps(b[r][2], s[2], b[r][3])));
+                _mm_storeu_ps(pDstMat[0][r], _mm256_castps256_ps128(row));
+                _mm_storeu_ps(pDstMat[1][r], _mm256_extractf128_ps(row, 1));
+            }
+        }
+
+        // Dealing with the remaining matrix
+        if (i < numMatrices)
+        {
+            __m128 s0 = _mm_loadu_ps((*pSrcMat)[0]);
+            __m128 s1 = _mm_loadu_ps((*pSrcMat)[1]);
+            __m128 s2 = _mm_loadu_ps((*pSrcMat)[2]);
+            for (int r = 0; r < 3; ++r)
+            {
+                __m128 row = _mm_fmadd_ps(_mm256_castps256_ps128(b[r][0]), s0,
+                             _mm_fmadd_ps(_mm256_castps256_ps128(b[r][1]), s1,
+                             _mm_fmadd_ps(_mm256_castps256_ps128(b[r][2]), s2, _mm256_castps256_ps128(b[r][3]))));
+                _mm_storeu_ps((*pDstMat)[r], row);
+            }
+        }
+    }
+    //---------------------------------------------------------------------
+    void OptimisedUtilAVX::concatenateAffineMatrices(
+        const Affine3& baseMatrix,
+        const Affine3* pSrcMat,
+        Affine3* pDstMat,
+        size_t numMatrices)
+    {
+        concatenateAffineMatrices_AVX(baseMatrix, pSrcMat, pDstMat, numMatrices);
+    }
+    //---------------------------------------------------------------------
+    /// Loads the given corner of 8 triangles, transposed to x, y and z
+    static OGRE_FORCE_INLINE OGRE_AVX2_TARGET void _loadCorners8(
+        const float* positions, const EdgeData::Triangle* t, int corner, __m256& x, __m256& y, __m256& z)
+    {
+        __m256 v04 = _mm256_insertf128_ps(_mm256_castps128_ps256(
+            _load3(positions + t[0].vertIndex[corner] * 3)), _load3(positions + t[4].vertIndex[corner] * 3), 1);
+        __m256 v15 = _mm256_insertf128_ps(_mm256_castps128_ps256(
+            _load3(positions + t[1].vertIndex[corner] * 3)), _load3(positions + t[5].vertIndex[corner] * 3), 1);
+        __m256 v26 = _mm256_insertf128_ps(_mm256_castps128_ps256(
+            _load3(positions + t[2].vertIndex[corner] * 3)), _load3(positions + t[6].vertIndex[corner] * 3), 1);
+        __m256 v37 = _mm256_insertf128_ps(_mm256_castps128_ps256(
+            _load3(positions + t[3].vertIndex[corner] * 3)), _load3(positions + t[7].vertIndex[corner] * 3), 1);
+
+        __m256 t0 = _mm256_unpacklo_ps(v04, v26);   // x0 x2 y0 y2
+        __m256 t1 = _mm256_unpacklo_ps(v15, v37);   // x1 x3 y1 y3
+        x = _mm256_unpacklo_ps(t0, t1);             // x0 x1 x2 x3
+        y = _mm256_unpackhi_ps(t0, t1);             // y0 y1 y2 y3
+        z = _mm256_unpacklo_ps(_mm256_unpackhi_ps(v04, v26), _mm256_unpackhi_ps(v15, v37));
+    }
+    //---------------------------------------------------------------------
+    static OGRE_AVX2_TARGET void calculateFaceNormals_AVX(
+        const float *positions,
+        const EdgeData::Triangle *triangles,
+        Vector4 *faceNormals,
+        size_t numTriangles)
+    {
+        // Eight triangles per-iteration, working on separated x, y and z components.
+        // Gather instructions are slower than transposing the loaded corners on
+        // most CPUs.
+        for ( ; numTriangles >= 8; numTriangles -= 8, triangles += 8, faceNormals += 8)
+        {
+            __m256 x1, y1, z1, x2, y2, z2, x3, y3, z3;
+            _loadCorners8(positions, triangles, 0, x1, y1, z1);
+            _loadCorners8(positions, triangles, 1, x2, y2, z2);
+            _loadCorners8(positions, triangles, 2, x3, y3, z3);
+
+            // v2 - v1 and v3 - v1
+            __m256 ax = _mm256_sub_ps(x2, x1);
+            __m256 ay = _mm256_sub_ps(y2, y1);
+            __m256 az = _mm256_sub_ps(z2, z1);
+            __m256 bx = _mm256_sub_ps(x3, x1);
+            __m256 by = _mm256_sub_ps(y3, y1);
+            __m256 bz = _mm256_sub_ps(z3, z1);
+
+            // Cross product, and the distance of the triangle from origin
+            __m256 nx = _mm256_fmsub_ps(ay, bz, _mm256_mul_ps(az, by));
+            __m256 ny = _mm256_fmsub_ps(az, bx, _mm256_mul_ps(ax, bz));
+            __m256 nz = _mm256_fmsub_ps(ax, by, _mm256_mul_ps(ay, bx));
+            __m256 nw = _mm256_fmadd_ps(nx, x1, _mm256_fmadd_ps(ny, y1, _mm256_mul_ps(nz, z1)));
+            nw = _mm256_sub_ps(_mm256_setzero_ps(), nw);
+
+            // Transpose back, lanes hold [0 1 2 3 | 4 5 6 7] of each component
+            __m256 t0 = _mm256_unpacklo_ps(nx, ny);     // [x0 y0 x1 y1]
+            __m256 t1 = _mm256_unpacklo_ps(nz, nw);     // [z0 w0 z1 w1]
+            __m256 t2 = _mm256_unpackhi_ps(nx, ny);     // [x2 y2 x3 y3]
+            __m256 t3 = _mm256_unpackhi_ps(nz, nw);     // [z2 w2 z3 w3]
+            __m256 f0 = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(1, 0, 1, 0));
+            __m256 f1 = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 2, 3, 2));
+            __m256 f2 = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(1, 0, 1, 0));
+            __m256 f3 = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(3, 2, 3, 2));
+
+            _mm256_storeu_ps(&faceNormals[0].x, _mm256_permute2f128_ps(f0, f1, 0x20));
+            _mm256_storeu_ps(&faceNormals[2].x, _mm256_permute2f128_ps(f2, f3, 0x20));
+            _mm256_storeu_ps(&faceNormals[4].x, _mm256_permute2f128_ps(f0, f1, 0x31));
+            _mm256_storeu_ps(&faceNormals[6].x, _mm256_permute2f128_ps(f2, f3, 0x31));
+        }
+
+        // Dealing with remaining triangles
+        for ( ; numTriangles; --numTriangles)
+        {
+            const EdgeData::Triangle& t = *triangles++;
+            __m128 v1 = _load3(positions + t.vertIndex[0] * 3);
+            __m128 a = _mm_sub_ps(_load3(positions + t.vertIndex[1] * 3), v1);
+            __m128 b = _mm_sub_ps(_load3(positions + t.vertIndex[2] * 3), v1);
+
+            // a.yzx * b.zxy - a.zxy * b.yzx
+            __m128 n = _mm_fmsub_ps(
+                _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 1, 0, 2)),
+                _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 1, 0, 2)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1))));
+            __m128 d = _mm_sub_ps(_mm_setzero_ps(), _mm_dp_ps(n, v1, 0x78));
+            _mm_storeu_ps(&faceNormals->x, _mm_blend_ps(n, d, 0x8));
+            ++faceNormals;
+        }
+    }
+    //---------------------------------------------------------------------
+    void OptimisedUtilAVX::calculateFaceNormals(
+        const float *positions,
+        const EdgeData::Triangle *triangles,
+        Vector4 *faceNormals,
+        size_t numTriangles)
+    {
+        calculateFaceNormals_AVX(positions, triangles, faceNormals, numTriangles);
+    }
+    //---------------------------------------------------------------------
+    static OGRE_AVX2_TARGET void calculateLightFacing_AVX(
+        const Vector4& lightPos,
+        const Vector4* faceNormals,
+        char* lightFacings,
+        size_t numFaces)
+    {
+        const __m256 zero = _mm256_setzero_ps();
+        const __m256 lx = _mm256_set1_ps(lightPos.x);
+        const __m256 ly = _mm256_set1_ps(lightPos.y);
+        const __m256 lz = _mm256_set1_ps(lightPos.z);
+        const __m256 lw = _mm256_set1_ps(lightPos.w);
+
+        // Eight faces per-iteration
+        for ( ; numFaces >= 8; numFaces -= 8, faceNormals += 8, lightFacings += 8)
+        {
+            __m256 x, y, z, w;
+            _loadTransposed8x4(faceNormals, x, y, z, w);
+            __m256 dp = _mm256_fmadd_ps(lx, x, _mm256_fmadd_ps(ly, y, _mm256_fmadd_ps(lz, z, _mm256_mul_ps(lw, w))));
+            _storeFlags8(lightFacings, _mm256_cmp_ps(dp, zero, _CMP_GT_OQ));
+        }
+
+        // Dealing with remaining faces
+        for ( ; numFaces; --numFaces)
+        {
+            *lightFacings++ = (lightPos.dotProduct(*faceNormals++) > 0);
+        }
+    }
+    //---------------------------------------------------------------------
+    void OptimisedUtilAVX::calculateLightFacing(
+        const Vector4& lightPos,
+        const Vector4* faceNormals,
+        char* lightFacings,
+        size_t numFaces)
+    {
+        calculateLightFacing_AVX(lightPos, faceNormals, lightFacings, numFaces);
+    }
+    //---------------------------------------------------------------------
+    static OGRE_AVX2_TARGET void extrudeVertices_AVX(
+        const Vector4& lightPos,
+        Real extrudeDist,
+        const float* pSrcPos,
+        float* pDestPos,
+        size_t numVertices)
+    {
+        if (lightPos.w == 0.0f)
+        {
+            // Directional light, extrusion is along light direction
+            Vector3 extrusionDir(-lightPos.x, -lightPos.y, -lightPos.z);
+            extrusionDir.normalise();
+            extrusionDir *= extrudeDist;
+
+            // Eight vertices per-iteration, the direction repeats every three registers
+            const float ex = extrusionDir.x, ey = extrusionDir.y, ez = extrusionDir.z;
+            const __m256 d0 = _mm256_setr_ps(ex, ey, ez, ex, ey, ez, ex, ey);
+            const __m256 d1 = _mm256_setr_ps(ez, ex, ey, ez, ex, ey, ez, ex);
+            const __m256 d2 = _mm256_setr_ps(ey, ez, ex, ey, ez, ex, ey, ez);
+            for ( ; numVertices >= 8; numVertices -= 8, pSrcPos += 24, pDestPos += 24)
+            {
+                _mm256_storeu_ps(pDestPos + 0, _mm256_add_ps(_mm256_loadu_ps(pSrcPos + 0), d0));
+                _mm256_storeu_ps(pDestPos + 8, _mm256_add_ps(_mm256_loadu_ps(pSrcPos + 8), d1));
+                _mm256_storeu_ps(pDestPos + 16, _mm256_add_ps(_mm256_loadu_ps(pSrcPos + 16), d2));
+            }
+
+            for ( ; numVertices; --numVertices)
+            {
+                *pDestPos++ = *pSrcPos++ + ex;
+                *pDestPos++ = *pSrcPos++ + ey;
+                *pDestPos++ = *pSrcPos++ + ez;
+            }
+        }
+        else
+        {
+            // Point light, calculate extrusionDir for every vertex
+            assert(lightPos.w == 1.0f);
+
+            const __m256 zero = _mm256_setzero_ps();
+            const __m256 lx = _mm256_set1_ps(lightPos.x);
+            const __m256 ly = _mm256_set1_ps(lightPos.y);
+            const __m256 lz = _mm256_set1_ps(lightPos.z);
+            const __m256 dist = _mm256_set1_ps(extrudeDist);
+
+            // Eight vertices per-iteration
+            for ( ; numVertices >= 8; numVertices -= 8, pSrcPos += 24, pDestPos += 24)
+            {
+                __m256 x, y, z;
+                _loadTransposed8x3(pSrcPos, x, y, z);
+                __m256 dx = _mm256_sub_ps(x, lx);
+                __m256 dy = _mm256_sub_ps(y, ly);
+                __m256 dz = _mm256_sub_ps(z, lz);
+
+                // Zero-sized directions are left unchanged, like Vector3::normalise
+                __m256 len2 = _mm256_fmadd_ps(dx, dx, _mm256_fmadd_ps(dy, dy, _mm256_mul_ps(dz, dz)));
+                __m256 scale = _mm256_and_ps(_mm256_mul_ps(dist, _rsqrt(len2)), _mm256_cmp_ps(len2, zero, _CMP_GT_OQ));
+
+                _storeTransposed8x3(pDestPos,
+                    _mm256_fmadd_ps(dx, scale, x), _mm256_fmadd_ps(dy, scale, y), _mm256_fmadd_ps(dz, scale, z));
+            }
+
+            const __m128 light = _mm_setr_ps(lightPos.x, lightPos.y, lightPos.z, 0);
+            for ( ; numVertices; --numVertices, pSrcPos += 3, pDestPos += 3)
+            {
+                __m128 pos = _load3(pSrcPos);
+                __m128 dir = _normalise3(_mm_sub_ps(pos, light));
+                _store3(pDestPos, _mm_fmadd_ps(dir, _mm256_castps256_ps128(dist), pos));
+            }
+        }
+    }
+    //---------------------------------------------------------------------
+    void OptimisedUtilAVX::extrudeVertices(
+        const Vector4& lightPos,
+        Real extrudeDist,
+        const float* pSrcPos,
+        float* pDestPos,
+        size_t numVertices)
+    {
+        extrudeVertices_AVX(lightPos, extrudeDist, pSrcPos, pDestPos, numVertices);
+    }
+    //---------------------------------------------------------------------
+    static OGRE_AVX2_TARGET void calculateSphereVisibility_AVX(
+        const Vector4* planes,
+        size_t numPlanes,
+        const Vector4* spheres,
+        char* visibilities,
+        size_t numSpheres)
+    {
+        const __m256 zero = _mm256_setzero_ps();
+
+        // Eight spheres per-iteration
+        for ( ; numSpheres >= 8; numSpheres -= 8, spheres += 8, visibilities += 8)
+        {
+            __m256 cx, cy, cz, r;
+            _loadTransposed8x4(spheres, cx, cy, cz, r);
+            __m256 negR = _mm256_sub_ps(zero, r);
+
+            // Accumulate the culled spheres, same as Plane::getDistance(centre) < -radius
+            __m256 culled = zero;
+            for (size_t p = 0; p < numPlanes && _mm256_movemask_ps(culled) != 0xFF; ++p)
+            {
+                const Vector4& plane = planes[p];
+                __m256 dist = _mm256_fmadd_ps(_mm256_set1_ps(plane.x), cx,
+                              _mm256_fmadd_ps(_mm256_set1_ps(plane.y), cy,
+                              _mm256_fmadd_ps(_mm256_set1_ps(plane.z), cz, _mm256_set1_ps(plane.w))));
+                culled = _mm256_or_ps(culled, _mm256_cmp_ps(dist, negR, _CMP_LT_OQ));
+            }
+            _storeFlags8(visibilities, _mm256_xor_ps(culled, _mm256_castsi256_ps(_mm256_set1_epi32(-1))));
+        }
+
+        // Dealing with remaining spheres
+        for ( ; numSpheres; --numSpheres, ++spheres)
+        {
+            bool visible = true;
+            for (size_t p = 0; p < numPlanes && visible; ++p)
+            {
+                const Vector4& plane = planes[p];
+                float dist = plane.x * spheres->x + plane.y * spheres->y + plane.z * spheres->z + plane.w;
+                visible = !(dist < -spheres->w);
+            }
+            *visibilities++ = visible;
+        }
+    }
+    //---------------------------------------------------------------------
+    void OptimisedUtilAVX::calculateSphereVisibility(
+        const Vector4* planes,
+        size_t numPlanes,
+        const Vector4* spheres,
+        char* visibilities,
+        size_t numSpheres)
+    {
+        calculateSphereVisibility_AVX(planes, numPlanes, spheres, visibilities, numSpheres);
+    }
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    extern OptimisedUtil* _getOptimisedUtilAVX(void);
+    extern OptimisedUtil* _getOptimisedUtilAVX(void)
+    {
+        static OptimisedUtilAVX msOptimisedUtilAVX;
+        return &msOptimisedUtilAVX;
+    }
+
+}
+
+#endif // __OGRE_HAVE_AVX2
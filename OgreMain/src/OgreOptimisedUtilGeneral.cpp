@@ -91,6 +91,14 @@ namespace Ogre {
             const float* srcPositions,
             float* destPositions,
             size_t numVertices) override;
+
+        /// @copydoc OptimisedUtil::calculateSphereVisibility
+        void calculateSphereVisibility(
+            const Vector4* planes,
+            size_t numPlanes,
+            const Vector4* spheres,
+            char* visibilities,
+            size_t numSpheres) override;
     };
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
@@ -364,6 +372,27 @@ namespace Ogre {
         }
     }
     //---------------------------------------------------------------------
+    void OptimisedUtilGeneral::calculateSphereVisibility(
+        const Vector4* planes,
+        size_t numPlanes,
+        const Vector4* spheres,
+        char* visibilities,
+        size_t numSpheres)
+    {
+        for (size_t i = 0; i < numSpheres; ++i, ++spheres)
+        {
+            bool visible = true;
+            for (size_t p = 0; p < numPlanes && visible; ++p)
+            {
+                // Same as Plane::getDistance(centre) < -radius
+                const Vector4& plane = planes[p];
+                Real dist = plane.x * spheres->x + plane.y * spheres->y + plane.z * spheres->z + plane.w;
+                visible = !(dist < -spheres->w);
+            }
+            *visibilities++ = visible;
+        }
+    }
+    //---------------------------------------------------------------------
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
     extern OptimisedUtil* _getOptimisedUtilGeneral(void);
@@ -129,6 +129,14 @@ namespace Ogre {
             const float* srcPositions,
             float* destPositions,
             size_t numVertices) override;
+
+        /// @copydoc OptimisedUtil::calculateSphereVisibility
+        void __OGRE_SIMD_ALIGN_ATTRIBUTE calculateSphereVisibility(
+            const Vector4* planes,
+            size_t numPlanes,
+            const Vector4* spheres,
+            char* visibilities,
+            size_t numSpheres) override;
     };
 
 #if defined(__OGRE_SIMD_ALIGN_STACK)
@@ -268,6 +276,24 @@ namespace Ogre {
                 destPositions,
                 numVertices);
         }
+
+        /// @copydoc OptimisedUtil::calculateSphereVisibility
+        virtual void calculateSphereVisibility(
+            const Vector4* planes,
+            size_t numPlanes,
+            const Vector4* spheres,
+            char* visibilities,
+            size_t numSpheres)
+        {
+            __OGRE_SIMD_ALIGN_STACK();
+
+            mImpl->calculateSphereVisibility(
+                planes,
+                numPlanes,
+                spheres,
+                visibilities,
+                numSpheres);
+        }
     };
 #endif  // !defined(__OGRE_SIMD_ALIGN_STACK)
 
@@ -1498,17 +1524,18 @@ namespace Ogre {
                 
                 // Fill a 4-vec with vector length
                 // square
-                __m128 tmp = _mm_mul_ps(norm, norm);
+                __m128 sq = _mm_mul_ps(norm, norm);
                 // Add - for this we want this effect:
                 // orig   3 | 2 | 1 | 0
                 // add1   0 | 0 | 0 | 2
                 // add2   2 | 3 | 0 | 3
                 // This way elements 0, 2 and 3 have the sum of all entries (except 1 which is unused)
+                // Both additions must shuffle the original squares, not the partial sums
                 
-                tmp = _mm_add_ps(tmp, _mm_shuffle_ps(tmp, tmp, _MM_SHUFFLE(0,0,0,2)));
+                __m128 tmp = _mm_add_ps(sq, _mm_shuffle_ps(sq, sq, _MM_SHUFFLE(0,0,0,2)));
                 // Add final combination & sqrt 
                 // bottom 3 elements of l will have length, we don't care about 4
-                tmp = _mm_add_ps(tmp, _mm_shuffle_ps(tmp, tmp, _MM_SHUFFLE(2,3,0,3)));
+                tmp = _mm_add_ps(tmp, _mm_shuffle_ps(sq, sq, _MM_SHUFFLE(2,3,0,3)));
                 // Then divide to normalise
                 norm = _mm_div_ps(norm, _mm_sqrt_ps(tmp));
                 
@@ -2134,6 +2161,70 @@ namespace Ogre {
         }
     }
     //---------------------------------------------------------------------
+    void OptimisedUtilSSE::calculateSphereVisibility(
+        const Vector4* planes,
+        size_t numPlanes,
+        const Vector4* spheres,
+        char* visibilities,
+        size_t numSpheres)
+    {
+        __OGRE_CHECK_STACK_ALIGNED_FOR_SSE();
+
+        assert(_isAlignedForSSE(spheres));
+
+        __m128 zero = _mm_setzero_ps();
+
+        size_t numIterations = numSpheres / 4;
+        numSpheres &= 3;
+
+        // Four spheres per-iteration
+        for (size_t i = 0; i < numIterations; ++i)
+        {
+            // Load spheres, aligned, and transpose to cx, cy, cz and radius of four spheres
+            __m128 cx = __MM_LOAD_PS(&spheres[0].x);
+            __m128 cy = __MM_LOAD_PS(&spheres[1].x);
+            __m128 cz = __MM_LOAD_PS(&spheres[2].x);
+            __m128 r = __MM_LOAD_PS(&spheres[3].x);
+            spheres += 4;
+            __MM_TRANSPOSE4x4_PS(cx, cy, cz, r);
+            __m128 negR = _mm_sub_ps(zero, r);
+
+            // Accumulate the culled spheres, same as Plane::getDistance(centre) < -radius
+            int culled = 0;
+            for (size_t p = 0; p < numPlanes && culled != 0xF; ++p)
+            {
+                __m128 plane = _mm_loadu_ps(&planes[p].x);
+                __m128 dist = _mm_add_ps(
+                    _mm_add_ps(
+                        _mm_add_ps(
+                            _mm_mul_ps(__MM_SELECT(plane, 0), cx),
+                            _mm_mul_ps(__MM_SELECT(plane, 1), cy)),
+                        _mm_mul_ps(__MM_SELECT(plane, 2), cz)),
+                    __MM_SELECT(plane, 3));
+                culled |= _mm_movemask_ps(_mm_cmplt_ps(dist, negR));
+            }
+
+            visibilities[0] = !(culled & 1);
+            visibilities[1] = !(culled & 2);
+            visibilities[2] = !(culled & 4);
+            visibilities[3] = !(culled & 8);
+            visibilities += 4;
+        }
+
+        // Dealing with remaining spheres
+        for (size_t i = 0; i < numSpheres; ++i, ++spheres)
+        {
+            bool visible = true;
+            for (size_t p = 0; p < numPlanes && visible; ++p)
+            {
+                const Vector4& plane = planes[p];
+                float dist = plane.x * spheres->x + plane.y * spheres->y + plane.z * spheres->z + plane.w;
+                visible = !(dist < -spheres->w);
+            }
+            *visibilities++ = visible;
+        }
+    }
+    //---------------------------------------------------------------------
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
     extern OptimisedUtil* _getOptimisedUtilSSE(void);
@@ -141,7 +141,14 @@ namespace Ogre {
 
         float getValue(void) const override { return 0; } // N/A
 
-        void setValue(float value) override { mTarget->_update(value); }
+        void setValue(float value) override
+        {
+            ParticleSystemManager& mgr = ParticleSystemManager::getSingleton();
+            if (mgr.getParallelUpdate())
+                mgr._queueUpdate(mTarget, value);
+            else
+                mTarget->_update(value);
+        }
 
     };
     //-----------------------------------------------------------------------
@@ -222,6 +229,7 @@ namespace Ogre {
             // Destroy controller
             ControllerManager::getSingleton().destroyController(mTimeController);
             mTimeController = 0;
+            ParticleSystemManager::getSingleton()._cancelUpdate(this);
         }
 
         // Arrange for the deletion of emitters & affectors
@@ -429,9 +437,18 @@ namespace Ogre {
     void ParticleSystem::_update(Real timeElapsed)
     {
         OgreProfile("ParticleSystem");
+        if (!_prepareUpdate(timeElapsed))
+            return;
+
+        if (_updateParticles(timeElapsed))
+            mParentNode->needUpdate();
+    }
+    //-----------------------------------------------------------------------
+    bool ParticleSystem::_prepareUpdate(Real& timeElapsed)
+    {
         // Only update if attached to a node
         if (!mParentNode)
-            return;
+            return false;
 
         Real nonvisibleTimeout = mNonvisibleTimeoutSet ?
             mNonvisibleTimeout : msDefaultNonvisibleTimeout;
@@ -447,7 +464,7 @@ namespace Ogre {
                 if (mTimeSinceLastVisible >= nonvisibleTimeout)
                 {
                     // No update
-                    return;
+                    return false;
                 }
             }
         }
@@ -461,6 +478,14 @@ namespace Ogre {
         // Initialise emitted emitters list if not done already
         initialiseEmittedEmitters();
 
+        // bring the cached node transform up to date, so it is only read from here on
+        mParentNode->_getFullTransform();
+
+        return true;
+    }
+    //-----------------------------------------------------------------------
+    bool ParticleSystem::_updateParticles(Real timeElapsed)
+    {
         Real iterationInterval = mIterationIntervalSet ? 
             mIterationInterval : msDefaultIterationInterval;
         if (iterationInterval > 0)
@@ -499,8 +524,7 @@ namespace Ogre {
 
         if (!mBoundsAutoUpdate && mBoundsUpdateTime > 0.0f)
             mBoundsUpdateTime -= timeElapsed; // count down 
-        _updateBounds();
-
+        return calculateBounds();
     }
     //-----------------------------------------------------------------------
     void ParticleSystem::_expire(Real timeElapsed)
@@ -553,8 +577,8 @@ namespace Ogre {
     {
         OgreProfile("_triggerEmitters");
         // Add up requests for emission
-        static std::vector<unsigned> requested;
-        static std::vector<unsigned> emittedRequested;
+        std::vector<unsigned>& requested = mEmissionRequests;
+        std::vector<unsigned>& emittedRequested = mEmittedEmissionRequests;
 
         if( requested.size() != mEmitters.size() )
             requested.resize( mEmitters.size() );
@@ -834,6 +858,12 @@ namespace Ogre {
     }
     //-----------------------------------------------------------------------
     void ParticleSystem::_updateBounds()
+    {
+        if (calculateBounds())
+            mParentNode->needUpdate();
+    }
+    //-----------------------------------------------------------------------
+    bool ParticleSystem::calculateBounds()
     {
         OgreProfile("_updateBounds");
         if (mParentNode && (mBoundsAutoUpdate || mBoundsUpdateTime > 0.0f))
@@ -896,11 +926,12 @@ namespace Ogre {
                     mAABB.merge(newAABB);
             }
 
-            mParentNode->needUpdate();
-
             if (mRenderer)
                 mRenderer->_notifyBoundingBox(mAABB);
+
+            return true;
         }
+        return false;
     }
     //-----------------------------------------------------------------------
     void ParticleSystem::fastForward(Real time, Real interval)
@@ -1018,6 +1049,7 @@ namespace Ogre {
             // Destroy controller
             ControllerManager::getSingleton().destroyController(mTimeController);
             mTimeController = 0;
+            ParticleSystemManager::getSingleton()._cancelUpdate(this);
         }
     }
     //-----------------------------------------------------------------------
@@ -48,7 +48,7 @@ namespace Ogre {
         assert( msSingleton );  return ( *msSingleton );  
     }
     //-----------------------------------------------------------------------
-    ParticleSystemManager::ParticleSystemManager()
+    ParticleSystemManager::ParticleSystemManager() : mParallelUpdate(false)
     {
         OGRE_LOCK_AUTO_MUTEX;
         mFactory = OGRE_NEW ParticleSystemFactory();
@@ -331,6 +331,51 @@ namespace Ogre {
 
     }
     //-----------------------------------------------------------------------
+    void ParticleSystemManager::_queueUpdate(ParticleSystem* sys, Real timeElapsed)
+    {
+        mQueuedUpdates.emplace_back(sys, timeElapsed);
+    }
+    //-----------------------------------------------------------------------
+    void ParticleSystemManager::_cancelUpdate(ParticleSystem* sys)
+    {
+        mQueuedUpdates.erase(std::remove_if(mQueuedUpdates.begin(), mQueuedUpdates.end(),
+                                            [sys](const std::pair<ParticleSystem*, Real>& u)
+                                            { return u.first == sys; }),
+                             mQueuedUpdates.end());
+    }
+    //-----------------------------------------------------------------------
+    void ParticleSystemManager::_processQueuedUpdates()
+    {
+        if (mQueuedUpdates.empty())
+            return;
+
+        OgreProfile("ParticleSystemManager::_processQueuedUpdates");
+
+        // renderer configuration may load materials, so it stays on this thread
+        auto end = std::remove_if(mQueuedUpdates.begin(), mQueuedUpdates.end(),
+                                  [](std::pair<ParticleSystem*, Real>& u)
+                                  { return !u.first->_prepareUpdate(u.second); });
+        mQueuedUpdates.erase(end, mQueuedUpdates.end());
+
+        std::vector<uchar> boundsChanged(mQueuedUpdates.size());
+        Root::getSingleton().getWorkQueue()->parallelFor(
+            0, mQueuedUpdates.size(),
+            [this, &boundsChanged](size_t first, size_t last)
+            {
+                for (size_t i = first; i < last; ++i)
+                    boundsChanged[i] = mQueuedUpdates[i].first->_updateParticles(mQueuedUpdates[i].second);
+            });
+
+        // the scene graph is not thread-safe
+        for (size_t i = 0; i < mQueuedUpdates.size(); ++i)
+        {
+            if (boundsChanged[i])
+                mQueuedUpdates[i].first->getParentNode()->needUpdate();
+        }
+
+        mQueuedUpdates.clear();
+    }
+    //-----------------------------------------------------------------------
     ParticleSystemManager::ParticleAffectorFactoryIterator 
     ParticleSystemManager::getAffectorFactoryIterator(void)
     {
@@ -39,6 +39,21 @@ THE SOFTWARE.
 *  @{
 */
 
+/**
+ * Convert a row of pixels from one type to another. Specialised below for the
+ * converters that have a SIMD implementation.
+ */
+template <class U> struct PixelRowConverter
+{
+    static void conversion(const typename U::SrcType *srcptr, typename U::DstType *dstptr, size_t count)
+    {
+        for(size_t x=0; x<count; x++)
+        {
+            dstptr[x] = U::pixelConvert(srcptr[x]);
+        }
+    }
+};
+
 /**
  * Convert a box of pixel from one type to another. Who needs automatic code 
  * generation when we have C++ templates and the policy design pattern.
@@ -64,10 +79,7 @@ template <class U> struct PixelBoxConverter
         {
             for(size_t y=src.top; y<src.bottom; y++)
             {
-                for(size_t x=0; x<k; x++)
-                {
-                    dstptr[x] = U::pixelConvert(srcptr[x]);
-                }
+                PixelRowConverter<U>::conversion(srcptr, dstptr, k);
                 srcptr += src.rowPitch;
                 dstptr += dst.rowPitch;
             }
@@ -104,198 +116,119 @@ struct Col4f {
         r(inR), g(inG), b(inB), a(inA) { }
     float r,g,b,a;
 };
-
-struct A8R8G8B8toA8B8G8R8: public PixelConverter <Ogre::uint32, Ogre::uint32, FMTCONVERTERID(Ogre::PF_A8R8G8B8, Ogre::PF_A8B8G8R8)>
-{
-    inline static DstType pixelConvert(SrcType inp)
-    {
-        return ((inp&0x000000FF)<<16)|(inp&0xFF00FF00)|((inp&0x00FF0000)>>16);
-    }
-};
-
-struct A8R8G8B8toB8G8R8A8: public PixelConverter <Ogre::uint32, Ogre::uint32, FMTCONVERTERID(Ogre::PF_A8R8G8B8, Ogre::PF_B8G8R8A8)>
-{
-    inline static DstType pixelConvert(SrcType inp)
-    {
-        return ((inp&0x000000FF)<<24)|((inp&0x0000FF00)<<8)|((inp&0x00FF0000)>>8)|((inp&0xFF000000)>>24);
-    }
-};
-
-struct A8R8G8B8toR8G8B8A8: public PixelConverter <Ogre::uint32, Ogre::uint32, FMTCONVERTERID(Ogre::PF_A8R8G8B8, Ogre::PF_R8G8B8A8)>
-{
-    inline static DstType pixelConvert(SrcType inp)
-    {
-        return ((inp&0x00FFFFFF)<<8)|((inp&0xFF000000)>>24);
-    }
-};
-
-struct A8B8G8R8toA8R8G8B8: public PixelConverter <Ogre::uint32, Ogre::uint32, FMTCONVERTERID(Ogre::PF_A8B8G8R8, Ogre::PF_A8R8G8B8)>
-{
-    inline static DstType pixelConvert(SrcType inp)
-    {
-        return ((inp&0x000000FF)<<16)|(inp&0xFF00FF00)|((inp&0x00FF0000)>>16);
-    }
+/** Type for PF_FLOAT16_R/GR/RGB/RGBA */
+template <int channels> struct ColNh {
+    Ogre::uint16 c[channels];
 };
-
-struct A8B8G8R8toB8G8R8A8: public PixelConverter <Ogre::uint32, Ogre::uint32, FMTCONVERTERID(Ogre::PF_A8B8G8R8, Ogre::PF_B8G8R8A8)>
-{
-    inline static DstType pixelConvert(SrcType inp)
-    {
-        return ((inp&0x00FFFFFF)<<8)|((inp&0xFF000000)>>24);
-    }
+/** Type for PF_FLOAT32_R/GR/RGB/RGBA */
+template <int channels> struct ColNf {
+    float c[channels];
 };
 
-struct A8B8G8R8toR8G8B8A8: public PixelConverter <Ogre::uint32, Ogre::uint32, FMTCONVERTERID(Ogre::PF_A8B8G8R8, Ogre::PF_R8G8B8A8)>
-{
-    inline static DstType pixelConvert(SrcType inp)
-    {
-        return ((inp&0x000000FF)<<24)|((inp&0x0000FF00)<<8)|((inp&0x00FF0000)>>8)|((inp&0xFF000000)>>24);
-    }
-};
-
-struct B8G8R8A8toA8R8G8B8: public PixelConverter <Ogre::uint32, Ogre::uint32, FMTCONVERTERID(Ogre::PF_B8G8R8A8, Ogre::PF_A8R8G8B8)>
-{
-    inline static DstType pixelConvert(SrcType inp)
-    {
-        return ((inp&0x000000FF)<<24)|((inp&0x0000FF00)<<8)|((inp&0x00FF0000)>>8)|((inp&0xFF000000)>>24);
-    }
-};
-
-struct B8G8R8A8toA8B8G8R8: public PixelConverter <Ogre::uint32, Ogre::uint32, FMTCONVERTERID(Ogre::PF_B8G8R8A8, Ogre::PF_A8B8G8R8)>
-{
-    inline static DstType pixelConvert(SrcType inp)
-    {
-        return ((inp&0x000000FF)<<24)|((inp&0xFFFFFF00)>>8);
-    }
-};
-
-struct B8G8R8A8toR8G8B8A8: public PixelConverter <Ogre::uint32, Ogre::uint32, FMTCONVERTERID(Ogre::PF_B8G8R8A8, Ogre::PF_R8G8B8A8)>
-{
-    inline static DstType pixelConvert(SrcType inp)
-    {
-        return ((inp&0x0000FF00)<<16)|(inp&0x00FF00FF)|((inp&0xFF000000)>>16);
-    }
-};
-
-struct R8G8B8A8toA8R8G8B8: public PixelConverter <Ogre::uint32, Ogre::uint32, FMTCONVERTERID(Ogre::PF_R8G8B8A8, Ogre::PF_A8R8G8B8)>
-{
-    inline static DstType pixelConvert(SrcType inp)
-    {
-        return ((inp&0x000000FF)<<24)|((inp&0xFFFFFF00)>>8);
-    }
-};
-
-struct R8G8B8A8toA8B8G8R8: public PixelConverter <Ogre::uint32, Ogre::uint32, FMTCONVERTERID(Ogre::PF_R8G8B8A8, Ogre::PF_A8B8G8R8)>
-{
-    inline static DstType pixelConvert(SrcType inp)
-    {
-        return ((inp&0x000000FF)<<24)|((inp&0x0000FF00)<<8)|((inp&0x00FF0000)>>8)|((inp&0xFF000000)>>24);
-    }
-};
-
-struct R8G8B8A8toB8G8R8A8: public PixelConverter <Ogre::uint32, Ogre::uint32, FMTCONVERTERID(Ogre::PF_R8G8B8A8, Ogre::PF_B8G8R8A8)>
-{
-    inline static DstType pixelConvert(SrcType inp)
-    {
-        return ((inp&0x0000FF00)<<16)|(inp&0x00FF00FF)|((inp&0xFF000000)>>16);
-    }
+#if __OGRE_HAVE_PIXELCONV_SIMD
+/** Four 32 bit pixels, so the swizzlers below serve for single pixels and SIMD registers alike */
+struct Pixel4u {
+    Pixel4u(__m128i inV): v(inV) { }
+    explicit Pixel4u(Ogre::uint32 c): v(_mm_set1_epi32(int(c))) { }
+    __m128i v;
 };
+inline Pixel4u operator&(const Pixel4u& a, const Pixel4u& b) { return _mm_and_si128(a.v, b.v); }
+inline Pixel4u operator|(const Pixel4u& a, const Pixel4u& b) { return _mm_or_si128(a.v, b.v); }
+template <int bits> inline Pixel4u shiftLeft(const Pixel4u& a) { return _mm_slli_epi32(a.v, bits); }
+template <int bits> inline Pixel4u shiftRight(const Pixel4u& a) { return _mm_srli_epi32(a.v, bits); }
+#endif
+template <int bits> inline Ogre::uint32 shiftLeft(Ogre::uint32 a) { return a << bits; }
+template <int bits> inline Ogre::uint32 shiftRight(Ogre::uint32 a) { return a >> bits; }
 
-struct A8B8G8R8toR8: public PixelConverter <Ogre::uint32, Ogre::uint8, FMTCONVERTERID(Ogre::PF_A8B8G8R8, Ogre::PF_R8)>
+template <int bytes, bool left = (bytes > 0)> struct ByteShifter
 {
-    inline static DstType pixelConvert(SrcType inp)
-    {
-        return (Ogre::uint8)(inp&0x000000FF);
-    }
+    template <class T> inline static T shift(T inp) { return shiftLeft<8 * bytes>(inp); }
 };
-
-struct R8toA8B8G8R8: public PixelConverter <Ogre::uint8, Ogre::uint32, FMTCONVERTERID(Ogre::PF_R8, Ogre::PF_A8B8G8R8)>
+template <int bytes> struct ByteShifter<bytes, false>
 {
-    inline static DstType pixelConvert(SrcType inp)
-    {
-        return 0xFF000000|((unsigned int)inp);
-    }
+    template <class T> inline static T shift(T inp) { return shiftRight<-8 * bytes>(inp); }
 };
 
-struct A8R8G8B8toR8: public PixelConverter <Ogre::uint32, Ogre::uint8, FMTCONVERTERID(Ogre::PF_A8R8G8B8, Ogre::PF_R8)>
+// byte <from> of the input moved to byte <to>. from -1 gives 0xFF and -2 gives 0
+template <int from, int to> struct ByteMover
 {
-    inline static DstType pixelConvert(SrcType inp)
-    {
-        return (Ogre::uint8)((inp&0x00FF0000)>>16);
-    }
+    template <class T> inline static T move(T inp) { return ByteShifter<to - from>::shift(inp & T(0xFFu << (8 * from))); }
 };
-
-struct R8toA8R8G8B8: public PixelConverter <Ogre::uint8, Ogre::uint32, FMTCONVERTERID(Ogre::PF_R8, Ogre::PF_A8R8G8B8)>
+template <int to> struct ByteMover<-1, to>
 {
-    inline static DstType pixelConvert(SrcType inp)
-    {
-        return 0xFF000000|(((unsigned int)inp)<<16);
-    }
+    template <class T> inline static T move(T) { return T(0xFFu << (8 * to)); }
 };
-
-struct B8G8R8A8toR8: public PixelConverter <Ogre::uint32, Ogre::uint8, FMTCONVERTERID(Ogre::PF_B8G8R8A8, Ogre::PF_R8)>
+template <int to> struct ByteMover<-2, to>
 {
-    inline static DstType pixelConvert(SrcType inp)
-    {
-        return (Ogre::uint8)((inp&0x0000FF00)>>8);
-    }
+    template <class T> inline static T move(T) { return T(0u); }
 };
 
-struct R8toB8G8R8A8: public PixelConverter <Ogre::uint8, Ogre::uint32, FMTCONVERTERID(Ogre::PF_R8, Ogre::PF_B8G8R8A8)>
+// byte n of the result is byte s<n> of the input, see ByteMover
+template <int s0, int s1, int s2, int s3> struct ByteSwizzler
 {
-    inline static DstType pixelConvert(SrcType inp)
+    template <class T> inline static T swizzle(T inp)
     {
-        return 0x000000FF|(((unsigned int)inp)<<8);
+        return ByteMover<s0, 0>::move(inp) | ByteMover<s1, 1>::move(inp) |
+               ByteMover<s2, 2>::move(inp) | ByteMover<s3, 3>::move(inp);
     }
 };
 
-struct A8B8G8R8toL8: public PixelConverter <Ogre::uint32, Ogre::uint8, FMTCONVERTERID(Ogre::PF_A8B8G8R8, Ogre::PF_L8)>
+template <int id, int s0, int s1, int s2, int s3> struct Uint32Swizzler:
+    public PixelConverter <Ogre::uint32, Ogre::uint32, id>
 {
-    inline static DstType pixelConvert(SrcType inp)
+    inline static Ogre::uint32 pixelConvert(Ogre::uint32 inp)
     {
-        return (Ogre::uint8)(inp&0x000000FF);
+        return ByteSwizzler<s0, s1, s2, s3>::swizzle(inp);
     }
 };
 
-struct L8toA8B8G8R8: public PixelConverter <Ogre::uint8, Ogre::uint32, FMTCONVERTERID(Ogre::PF_L8, Ogre::PF_A8B8G8R8)>
+// the byte is replicated to the bytes with s<n> == 0
+template <int id, int s0, int s1, int s2, int s3> struct Uint8toUint32Swizzler:
+    public PixelConverter <Ogre::uint8, Ogre::uint32, id>
 {
-    inline static DstType pixelConvert(SrcType inp)
+    inline static Ogre::uint32 pixelConvert(Ogre::uint8 inp)
     {
-        return 0xFF000000|(((unsigned int)inp)<<0)|(((unsigned int)inp)<<8)|(((unsigned int)inp)<<16);
+        return ByteSwizzler<s0, s1, s2, s3>::swizzle(Ogre::uint32(inp));
     }
 };
 
-struct A8R8G8B8toL8: public PixelConverter <Ogre::uint32, Ogre::uint8, FMTCONVERTERID(Ogre::PF_A8R8G8B8, Ogre::PF_L8)>
+template <int id, int byte> struct Uint32toUint8Extractor:
+    public PixelConverter <Ogre::uint32, Ogre::uint8, id>
 {
-    inline static DstType pixelConvert(SrcType inp)
+    inline static Ogre::uint8 pixelConvert(Ogre::uint32 inp)
     {
-        return (Ogre::uint8)((inp&0x00FF0000)>>16);
+        return (Ogre::uint8)(inp >> (8 * byte));
     }
 };
 
-struct L8toA8R8G8B8: public PixelConverter <Ogre::uint8, Ogre::uint32, FMTCONVERTERID(Ogre::PF_L8, Ogre::PF_A8R8G8B8)>
-{
-    inline static DstType pixelConvert(SrcType inp)
-    {
-        return 0xFF000000|(((unsigned int)inp)<<0)|(((unsigned int)inp)<<8)|(((unsigned int)inp)<<16);
-    }
-};
+// A8R8G8B8 is B,G,R,A from the least significant byte up, A8B8G8R8 is R,G,B,A,
+// B8G8R8A8 is A,R,G,B and R8G8B8A8 is A,B,G,R
+typedef Uint32Swizzler<FMTCONVERTERID(Ogre::PF_A8R8G8B8, Ogre::PF_A8B8G8R8), 2, 1, 0, 3> A8R8G8B8toA8B8G8R8;
+typedef Uint32Swizzler<FMTCONVERTERID(Ogre::PF_A8R8G8B8, Ogre::PF_B8G8R8A8), 3, 2, 1, 0> A8R8G8B8toB8G8R8A8;
+typedef Uint32Swizzler<FMTCONVERTERID(Ogre::PF_A8R8G8B8, Ogre::PF_R8G8B8A8), 3, 0, 1, 2> A8R8G8B8toR8G8B8A8;
+typedef Uint32Swizzler<FMTCONVERTERID(Ogre::PF_A8B8G8R8, Ogre::PF_A8R8G8B8), 2, 1, 0, 3> A8B8G8R8toA8R8G8B8;
+typedef Uint32Swizzler<FMTCONVERTERID(Ogre::PF_A8B8G8R8, Ogre::PF_B8G8R8A8), 3, 0, 1, 2> A8B8G8R8toB8G8R8A8;
+typedef Uint32Swizzler<FMTCONVERTERID(Ogre::PF_A8B8G8R8, Ogre::PF_R8G8B8A8), 3, 2, 1, 0> A8B8G8R8toR8G8B8A8;
+typedef Uint32Swizzler<FMTCONVERTERID(Ogre::PF_B8G8R8A8, Ogre::PF_A8R8G8B8), 3, 2, 1, 0> B8G8R8A8toA8R8G8B8;
+typedef Uint32Swizzler<FMTCONVERTERID(Ogre::PF_B8G8R8A8, Ogre::PF_A8B8G8R8), 1, 2, 3, 0> B8G8R8A8toA8B8G8R8;
+typedef Uint32Swizzler<FMTCONVERTERID(Ogre::PF_B8G8R8A8, Ogre::PF_R8G8B8A8), 0, 3, 2, 1> B8G8R8A8toR8G8B8A8;
+typedef Uint32Swizzler<FMTCONVERTERID(Ogre::PF_R8G8B8A8, Ogre::PF_A8R8G8B8), 1, 2, 3, 0> R8G8B8A8toA8R8G8B8;
+typedef Uint32Swizzler<FMTCONVERTERID(Ogre::PF_R8G8B8A8, Ogre::PF_A8B8G8R8), 3, 2, 1, 0> R8G8B8A8toA8B8G8R8;
+typedef Uint32Swizzler<FMTCONVERTERID(Ogre::PF_R8G8B8A8, Ogre::PF_B8G8R8A8), 0, 3, 2, 1> R8G8B8A8toB8G8R8A8;
 
-struct B8G8R8A8toL8: public PixelConverter <Ogre::uint32, Ogre::uint8, FMTCONVERTERID(Ogre::PF_B8G8R8A8, Ogre::PF_L8)>
-{
-    inline static DstType pixelConvert(SrcType inp)
-    {
-        return (Ogre::uint8)((inp&0x0000FF00)>>8);
-    }
-};
+typedef Uint32toUint8Extractor<FMTCONVERTERID(Ogre::PF_A8B8G8R8, Ogre::PF_R8), 0> A8B8G8R8toR8;
+typedef Uint8toUint32Swizzler<FMTCONVERTERID(Ogre::PF_R8, Ogre::PF_A8B8G8R8), 0, -2, -2, -1> R8toA8B8G8R8;
+typedef Uint32toUint8Extractor<FMTCONVERTERID(Ogre::PF_A8R8G8B8, Ogre::PF_R8), 2> A8R8G8B8toR8;
+typedef Uint8toUint32Swizzler<FMTCONVERTERID(Ogre::PF_R8, Ogre::PF_A8R8G8B8), -2, -2, 0, -1> R8toA8R8G8B8;
+typedef Uint32toUint8Extractor<FMTCONVERTERID(Ogre::PF_B8G8R8A8, Ogre::PF_R8), 1> B8G8R8A8toR8;
+typedef Uint8toUint32Swizzler<FMTCONVERTERID(Ogre::PF_R8, Ogre::PF_B8G8R8A8), -1, 0, -2, -2> R8toB8G8R8A8;
 
-struct L8toB8G8R8A8: public PixelConverter <Ogre::uint8, Ogre::uint32, FMTCONVERTERID(Ogre::PF_L8, Ogre::PF_B8G8R8A8)>
-{
-    inline static DstType pixelConvert(SrcType inp)
-    {
-        return 0x000000FF|(((unsigned int)inp)<<8)|(((unsigned int)inp)<<16)|(((unsigned int)inp)<<24);
-    }
-};
+typedef Uint32toUint8Extractor<FMTCONVERTERID(Ogre::PF_A8B8G8R8, Ogre::PF_L8), 0> A8B8G8R8toL8;
+typedef Uint8toUint32Swizzler<FMTCONVERTERID(Ogre::PF_L8, Ogre::PF_A8B8G8R8), 0, 0, 0, -1> L8toA8B8G8R8;
+typedef Uint32toUint8Extractor<FMTCONVERTERID(Ogre::PF_A8R8G8B8, Ogre::PF_L8), 2> A8R8G8B8toL8;
+typedef Uint8toUint32Swizzler<FMTCONVERTERID(Ogre::PF_L8, Ogre::PF_A8R8G8B8), 0, 0, 0, -1> L8toA8R8G8B8;
+typedef Uint32toUint8Extractor<FMTCONVERTERID(Ogre::PF_B8G8R8A8, Ogre::PF_L8), 1> B8G8R8A8toL8;
+typedef Uint8toUint32Swizzler<FMTCONVERTERID(Ogre::PF_L8, Ogre::PF_B8G8R8A8), -1, 0, 0, 0> L8toB8G8R8A8;
 
 struct L8toL16: public PixelConverter <Ogre::uint8, Ogre::uint16, FMTCONVERTERID(Ogre::PF_L8, Ogre::PF_L16)>
 {
@@ -318,7 +251,7 @@ struct R8G8B8toB8G8R8: public PixelConverter <Col3b, Col3b, FMTCONVERTERID(Ogre:
     inline static DstType pixelConvert(const SrcType &inp)
     {
         return Col3b(inp.z, inp.y, inp.x);
-    }  
+    }
 };
 
 struct B8G8R8toR8G8B8: public PixelConverter <Col3b, Col3b, FMTCONVERTERID(Ogre::PF_B8G8R8, Ogre::PF_R8G8B8)>
@@ -326,7 +259,7 @@ struct B8G8R8toR8G8B8: public PixelConverter <Col3b, Col3b, FMTCONVERTERID(Ogre:
     inline static DstType pixelConvert(const SrcType &inp)
     {
         return Col3b(inp.z, inp.y, inp.x);
-    }  
+    }
 };
 
 // X8Y8Z8 ->  X8<<xshift Y8<<yshift Z8<<zshift A8<<ashift
@@ -343,12 +276,12 @@ template <int id, unsigned int xshift, unsigned int yshift, unsigned int zshift,
     }
 };
 
-struct R8G8B8toA8R8G8B8: public Col3btoUint32swizzler<FMTCONVERTERID(Ogre::PF_R8G8B8, Ogre::PF_A8R8G8B8), 16, 8, 0, 24> { };
-struct B8G8R8toA8R8G8B8: public Col3btoUint32swizzler<FMTCONVERTERID(Ogre::PF_B8G8R8, Ogre::PF_A8R8G8B8), 0, 8, 16, 24> { };
-struct R8G8B8toA8B8G8R8: public Col3btoUint32swizzler<FMTCONVERTERID(Ogre::PF_R8G8B8, Ogre::PF_A8B8G8R8), 0, 8, 16, 24> { };
-struct B8G8R8toA8B8G8R8: public Col3btoUint32swizzler<FMTCONVERTERID(Ogre::PF_B8G8R8, Ogre::PF_A8B8G8R8), 16, 8, 0, 24> { };
-struct R8G8B8toB8G8R8A8: public Col3btoUint32swizzler<FMTCONVERTERID(Ogre::PF_R8G8B8, Ogre::PF_B8G8R8A8), 8, 16, 24, 0> { };
-struct B8G8R8toB8G8R8A8: public Col3btoUint32swizzler<FMTCONVERTERID(Ogre::PF_B8G8R8, Ogre::PF_B8G8R8A8), 24, 16, 8, 0> { };
+typedef Col3btoUint32swizzler<FMTCONVERTERID(Ogre::PF_R8G8B8, Ogre::PF_A8R8G8B8), 16, 8, 0, 24> R8G8B8toA8R8G8B8;
+typedef Col3btoUint32swizzler<FMTCONVERTERID(Ogre::PF_B8G8R8, Ogre::PF_A8R8G8B8), 0, 8, 16, 24> B8G8R8toA8R8G8B8;
+typedef Col3btoUint32swizzler<FMTCONVERTERID(Ogre::PF_R8G8B8, Ogre::PF_A8B8G8R8), 0, 8, 16, 24> R8G8B8toA8B8G8R8;
+typedef Col3btoUint32swizzler<FMTCONVERTERID(Ogre::PF_B8G8R8, Ogre::PF_A8B8G8R8), 16, 8, 0, 24> B8G8R8toA8B8G8R8;
+typedef Col3btoUint32swizzler<FMTCONVERTERID(Ogre::PF_R8G8B8, Ogre::PF_B8G8R8A8), 8, 16, 24, 0> R8G8B8toB8G8R8A8;
+typedef Col3btoUint32swizzler<FMTCONVERTERID(Ogre::PF_B8G8R8, Ogre::PF_B8G8R8A8), 24, 16, 8, 0> B8G8R8toB8G8R8A8;
 
 struct A8R8G8B8toR8G8B8: public PixelConverter <Ogre::uint32, Col3b, FMTCONVERTERID(Ogre::PF_A8R8G8B8, Ogre::PF_BYTE_RGB)>
 {
@@ -367,65 +300,239 @@ struct A8R8G8B8toB8G8R8: public PixelConverter <Ogre::uint32, Col3b, FMTCONVERTE
 
 // Only conversions from X8R8G8B8 to formats with alpha need to be defined, the rest is implicitly the same
 // as A8R8G8B8
-struct X8R8G8B8toA8R8G8B8: public PixelConverter <Ogre::uint32, Ogre::uint32, FMTCONVERTERID(Ogre::PF_X8R8G8B8, Ogre::PF_A8R8G8B8)>
+typedef Uint32Swizzler<FMTCONVERTERID(Ogre::PF_X8R8G8B8, Ogre::PF_A8R8G8B8), 0, 1, 2, -1> X8R8G8B8toA8R8G8B8;
+typedef Uint32Swizzler<FMTCONVERTERID(Ogre::PF_X8R8G8B8, Ogre::PF_A8B8G8R8), 2, 1, 0, -1> X8R8G8B8toA8B8G8R8;
+typedef Uint32Swizzler<FMTCONVERTERID(Ogre::PF_X8R8G8B8, Ogre::PF_B8G8R8A8), -1, 2, 1, 0> X8R8G8B8toB8G8R8A8;
+typedef Uint32Swizzler<FMTCONVERTERID(Ogre::PF_X8R8G8B8, Ogre::PF_R8G8B8A8), -1, 0, 1, 2> X8R8G8B8toR8G8B8A8;
+
+// X8B8G8R8
+typedef Uint32Swizzler<FMTCONVERTERID(Ogre::PF_X8B8G8R8, Ogre::PF_A8R8G8B8), 2, 1, 0, -1> X8B8G8R8toA8R8G8B8;
+typedef Uint32Swizzler<FMTCONVERTERID(Ogre::PF_X8B8G8R8, Ogre::PF_A8B8G8R8), 0, 1, 2, -1> X8B8G8R8toA8B8G8R8;
+typedef Uint32Swizzler<FMTCONVERTERID(Ogre::PF_X8B8G8R8, Ogre::PF_B8G8R8A8), -1, 0, 1, 2> X8B8G8R8toB8G8R8A8;
+typedef Uint32Swizzler<FMTCONVERTERID(Ogre::PF_X8B8G8R8, Ogre::PF_R8G8B8A8), -1, 2, 1, 0> X8B8G8R8toR8G8B8A8;
+
+// Float16 <-> Float32, channel by channel
+template <int id, int channels> struct Float16toFloat32:
+    public PixelConverter <ColNh<channels>, ColNf<channels>, id>
 {
-    inline static DstType pixelConvert(SrcType inp)
+    inline static ColNf<channels> pixelConvert(const ColNh<channels> &inp)
     {
-        return inp | 0xFF000000;
+        ColNf<channels> ret;
+        for(int i=0; i<channels; i++)
+            ret.c[i] = Ogre::Bitwise::halfToFloat(inp.c[i]);
+        return ret;
     }
 };
-struct X8R8G8B8toA8B8G8R8: public PixelConverter <Ogre::uint32, Ogre::uint32, FMTCONVERTERID(Ogre::PF_X8R8G8B8, Ogre::PF_A8B8G8R8)>
+template <int id, int channels> struct Float32toFloat16:
+    public PixelConverter <ColNf<channels>, ColNh<channels>, id>
 {
-    inline static DstType pixelConvert(SrcType inp)
+    inline static ColNh<channels> pixelConvert(const ColNf<channels> &inp)
     {
-        return ((inp&0x0000FF)<<16)|((inp&0xFF0000)>>16)|(inp&0x00FF00)|0xFF000000;
+        ColNh<channels> ret;
+        for(int i=0; i<channels; i++)
+            ret.c[i] = Ogre::Bitwise::floatToHalf(inp.c[i]);
+        return ret;
     }
 };
-struct X8R8G8B8toB8G8R8A8: public PixelConverter <Ogre::uint32, Ogre::uint32, FMTCONVERTERID(Ogre::PF_X8R8G8B8, Ogre::PF_B8G8R8A8)>
+
+typedef Float16toFloat32<FMTCONVERTERID(Ogre::PF_FLOAT16_R, Ogre::PF_FLOAT32_R), 1> FLOAT16RtoFLOAT32R;
+typedef Float16toFloat32<FMTCONVERTERID(Ogre::PF_FLOAT16_GR, Ogre::PF_FLOAT32_GR), 2> FLOAT16GRtoFLOAT32GR;
+typedef Float16toFloat32<FMTCONVERTERID(Ogre::PF_FLOAT16_RGB, Ogre::PF_FLOAT32_RGB), 3> FLOAT16RGBtoFLOAT32RGB;
+typedef Float16toFloat32<FMTCONVERTERID(Ogre::PF_FLOAT16_RGBA, Ogre::PF_FLOAT32_RGBA), 4> FLOAT16RGBAtoFLOAT32RGBA;
+typedef Float32toFloat16<FMTCONVERTERID(Ogre::PF_FLOAT32_R, Ogre::PF_FLOAT16_R), 1> FLOAT32RtoFLOAT16R;
+typedef Float32toFloat16<FMTCONVERTERID(Ogre::PF_FLOAT32_GR, Ogre::PF_FLOAT16_GR), 2> FLOAT32GRtoFLOAT16GR;
+typedef Float32toFloat16<FMTCONVERTERID(Ogre::PF_FLOAT32_RGB, Ogre::PF_FLOAT16_RGB), 3> FLOAT32RGBtoFLOAT16RGB;
+typedef Float32toFloat16<FMTCONVERTERID(Ogre::PF_FLOAT32_RGBA, Ogre::PF_FLOAT16_RGBA), 4> FLOAT32RGBAtoFLOAT16RGBA;
+
+#if __OGRE_HAVE_PIXELCONV_SIMD && OGRE_ENDIAN == OGRE_ENDIAN_LITTLE
+/*
+ * SIMD row converters. They produce the very same bits as the pixelConvert
+ * methods above, which handle the pixels left over at the end of the row.
+ */
+template <int id, int s0, int s1, int s2, int s3> struct PixelRowConverter<Uint32Swizzler<id, s0, s1, s2, s3> >
 {
-    inline static DstType pixelConvert(SrcType inp)
+    typedef ByteSwizzler<s0, s1, s2, s3> Swizzler;
+    static void conversion(const Ogre::uint32 *srcptr, Ogre::uint32 *dstptr, size_t count)
     {
-        return ((inp&0x0000FF)<<24)|((inp&0xFF0000)>>8)|((inp&0x00FF00)<<8)|0x000000FF;
+        size_t x = 0;
+        for(; x + 4 <= count; x += 4)
+        {
+            Pixel4u p(_mm_loadu_si128((const __m128i*)(srcptr + x)));
+            _mm_storeu_si128((__m128i*)(dstptr + x), Swizzler::swizzle(p).v);
+        }
+        for(; x < count; x++)
+            dstptr[x] = Swizzler::swizzle(srcptr[x]);
     }
 };
-struct X8R8G8B8toR8G8B8A8: public PixelConverter <Ogre::uint32, Ogre::uint32, FMTCONVERTERID(Ogre::PF_X8R8G8B8, Ogre::PF_R8G8B8A8)>
+
+template <int id, int s0, int s1, int s2, int s3> struct PixelRowConverter<Uint8toUint32Swizzler<id, s0, s1, s2, s3> >
 {
-    inline static DstType pixelConvert(SrcType inp)
+    typedef ByteSwizzler<s0, s1, s2, s3> Swizzler;
+    static void conversion(const Ogre::uint8 *srcptr, Ogre::uint32 *dstptr, size_t count)
     {
-        return ((inp&0xFFFFFF)<<8)|0x000000FF;
+        const __m128i zero = _mm_setzero_si128();
+        size_t x = 0;
+        for(; x + 16 <= count; x += 16)
+        {
+            __m128i v = _mm_loadu_si128((const __m128i*)(srcptr + x));
+            __m128i lo = _mm_unpacklo_epi8(v, zero);
+            __m128i hi = _mm_unpackhi_epi8(v, zero);
+            _mm_storeu_si128((__m128i*)(dstptr + x), Swizzler::swizzle(Pixel4u(_mm_unpacklo_epi16(lo, zero))).v);
+            _mm_storeu_si128((__m128i*)(dstptr + x + 4), Swizzler::swizzle(Pixel4u(_mm_unpackhi_epi16(lo, zero))).v);
+            _mm_storeu_si128((__m128i*)(dstptr + x + 8), Swizzler::swizzle(Pixel4u(_mm_unpacklo_epi16(hi, zero))).v);
+            _mm_storeu_si128((__m128i*)(dstptr + x + 12), Swizzler::swizzle(Pixel4u(_mm_unpackhi_epi16(hi, zero))).v);
+        }
+        for(; x < count; x++)
+            dstptr[x] = Swizzler::swizzle(Ogre::uint32(srcptr[x]));
     }
 };
 
-// X8B8G8R8
-struct X8B8G8R8toA8R8G8B8: public PixelConverter <Ogre::uint32, Ogre::uint32, FMTCONVERTERID(Ogre::PF_X8B8G8R8, Ogre::PF_A8R8G8B8)>
+template <int id, int byte> struct PixelRowConverter<Uint32toUint8Extractor<id, byte> >
 {
-    inline static DstType pixelConvert(SrcType inp)
+    static __m128i extract(const Ogre::uint32 *srcptr)
     {
-        return ((inp&0x0000FF)<<16)|((inp&0xFF0000)>>16)|(inp&0x00FF00)|0xFF000000;
+        Pixel4u p(_mm_loadu_si128((const __m128i*)srcptr));
+        return (shiftRight<8 * byte>(p) & Pixel4u(0xFFu)).v;
+    }
+    static void conversion(const Ogre::uint32 *srcptr, Ogre::uint8 *dstptr, size_t count)
+    {
+        size_t x = 0;
+        for(; x + 16 <= count; x += 16)
+        {
+            __m128i lo = _mm_packs_epi32(extract(srcptr + x), extract(srcptr + x + 4));
+            __m128i hi = _mm_packs_epi32(extract(srcptr + x + 8), extract(srcptr + x + 12));
+            _mm_storeu_si128((__m128i*)(dstptr + x), _mm_packus_epi16(lo, hi));
+        }
+        for(; x < count; x++)
+            dstptr[x] = Uint32toUint8Extractor<id, byte>::pixelConvert(srcptr[x]);
     }
 };
-struct X8B8G8R8toA8B8G8R8: public PixelConverter <Ogre::uint32, Ogre::uint32, FMTCONVERTERID(Ogre::PF_X8B8G8R8, Ogre::PF_A8B8G8R8)>
+
+template <> struct PixelRowConverter<L8toL16>
 {
-    inline static DstType pixelConvert(SrcType inp)
+    static void conversion(const Ogre::uint8 *srcptr, Ogre::uint16 *dstptr, size_t count)
     {
-        return inp | 0xFF000000;
+        size_t x = 0;
+        for(; x + 16 <= count; x += 16)
+        {
+            __m128i v = _mm_loadu_si128((const __m128i*)(srcptr + x));
+            _mm_storeu_si128((__m128i*)(dstptr + x), _mm_unpacklo_epi8(v, v));
+            _mm_storeu_si128((__m128i*)(dstptr + x + 8), _mm_unpackhi_epi8(v, v));
+        }
+        for(; x < count; x++)
+            dstptr[x] = L8toL16::pixelConvert(srcptr[x]);
     }
 };
-struct X8B8G8R8toB8G8R8A8: public PixelConverter <Ogre::uint32, Ogre::uint32, FMTCONVERTERID(Ogre::PF_X8B8G8R8, Ogre::PF_B8G8R8A8)>
+
+template <> struct PixelRowConverter<L16toL8>
 {
-    inline static DstType pixelConvert(SrcType inp)
+    static void conversion(const Ogre::uint16 *srcptr, Ogre::uint8 *dstptr, size_t count)
     {
-        return ((inp&0xFFFFFF)<<8)|0x000000FF;
+        size_t x = 0;
+        for(; x + 16 <= count; x += 16)
+        {
+            __m128i lo = _mm_srli_epi16(_mm_loadu_si128((const __m128i*)(srcptr + x)), 8);
+            __m128i hi = _mm_srli_epi16(_mm_loadu_si128((const __m128i*)(srcptr + x + 8)), 8);
+            _mm_storeu_si128((__m128i*)(dstptr + x), _mm_packus_epi16(lo, hi));
+        }
+        for(; x < count; x++)
+            dstptr[x] = L16toL8::pixelConvert(srcptr[x]);
     }
 };
-struct X8B8G8R8toR8G8B8A8: public PixelConverter <Ogre::uint32, Ogre::uint32, FMTCONVERTERID(Ogre::PF_X8B8G8R8, Ogre::PF_R8G8B8A8)>
+
+// byte of the packed input, which holds x, y, z from the least significant byte up,
+// that ends up in the byte at the given shift
+#define COL3BSOURCEBYTE(shift) (zshift == (shift) ? 0 : yshift == (shift) ? 1 : xshift == (shift) ? 2 : -1)
+template <int id, unsigned int xshift, unsigned int yshift, unsigned int zshift, unsigned int ashift>
+struct PixelRowConverter<Col3btoUint32swizzler<id, xshift, yshift, zshift, ashift> >
 {
-    inline static DstType pixelConvert(SrcType inp)
+    typedef ByteSwizzler<COL3BSOURCEBYTE(0), COL3BSOURCEBYTE(8), COL3BSOURCEBYTE(16), COL3BSOURCEBYTE(24)> Swizzler;
+    static void conversion(const Col3b *srcptr, Ogre::uint32 *dstptr, size_t count)
+    {
+        const Ogre::uint8* src = reinterpret_cast<const Ogre::uint8*>(srcptr);
+        size_t x = 0;
+        // 16 bytes are loaded for 4 pixels, so stop before reading past the row
+        for(; x + 6 <= count; x += 4)
+        {
+            __m128i v = _mm_loadu_si128((const __m128i*)(src + x * 3));
+            __m128i p01 = _mm_unpacklo_epi32(v, _mm_srli_si128(v, 3));
+            __m128i p23 = _mm_unpacklo_epi32(_mm_srli_si128(v, 6), _mm_srli_si128(v, 9));
+            _mm_storeu_si128((__m128i*)(dstptr + x), Swizzler::swizzle(Pixel4u(_mm_unpacklo_epi64(p01, p23))).v);
+        }
+        for(; x < count; x++)
+            dstptr[x] = Col3btoUint32swizzler<id, xshift, yshift, zshift, ashift>::pixelConvert(srcptr[x]);
+    }
+};
+#undef COL3BSOURCEBYTE
+
+// vectorised Bitwise::halfToFloatI
+inline __m128i halfToFloat4(__m128i h)
+{
+    __m128i s = _mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(0x8000)), 16);
+    __m128i em = _mm_and_si128(h, _mm_set1_epi32(0x7fff));
+    __m128i r = _mm_slli_epi32(_mm_add_epi32(em, _mm_set1_epi32(112 << 10)), 13);
+    r = _mm_andnot_si128(_mm_cmplt_epi32(em, _mm_set1_epi32(1 << 10)), r);
+    r = _mm_add_epi32(r, _mm_and_si128(_mm_cmpgt_epi32(em, _mm_set1_epi32((31 << 10) - 1)), _mm_set1_epi32(112 << 23)));
+    return _mm_or_si128(s, r);
+}
+
+// vectorised Bitwise::floatToHalfI, the result is in the lower 16 bits
+inline __m128i floatToHalf4(__m128i ui)
+{
+    __m128i s = _mm_and_si128(_mm_srli_epi32(ui, 16), _mm_set1_epi32(0x8000));
+    __m128i em = _mm_and_si128(ui, _mm_set1_epi32(0x7fffffff));
+    __m128i h = _mm_srai_epi32(_mm_add_epi32(em, _mm_set1_epi32((1 << 12) - (112 << 23))), 13);
+    h = _mm_andnot_si128(_mm_cmplt_epi32(em, _mm_set1_epi32(113 << 23)), h);
+    __m128i mask = _mm_cmpgt_epi32(em, _mm_set1_epi32((143 << 23) - 1));
+    h = _mm_or_si128(_mm_andnot_si128(mask, h), _mm_and_si128(mask, _mm_set1_epi32(0x7c00)));
+    mask = _mm_cmpgt_epi32(em, _mm_set1_epi32(255 << 23));
+    h = _mm_or_si128(_mm_andnot_si128(mask, h), _mm_and_si128(mask, _mm_set1_epi32(0x7e00)));
+    return _mm_or_si128(s, h);
+}
+
+template <int id, int channels> struct PixelRowConverter<Float16toFloat32<id, channels> >
+{
+    static void conversion(const ColNh<channels> *srcptr, ColNf<channels> *dstptr, size_t count)
     {
-        return ((inp&0x0000FF)<<24)|((inp&0xFF0000)>>8)|((inp&0x00FF00)<<8)|0x000000FF;
+        const Ogre::uint16* src = srcptr->c;
+        float* dst = dstptr->c;
+        const __m128i zero = _mm_setzero_si128();
+        size_t n = count * channels;
+        size_t i = 0;
+        for(; i + 8 <= n; i += 8)
+        {
+            __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+            _mm_storeu_si128((__m128i*)(dst + i), halfToFloat4(_mm_unpacklo_epi16(v, zero)));
+            _mm_storeu_si128((__m128i*)(dst + i + 4), halfToFloat4(_mm_unpackhi_epi16(v, zero)));
+        }
+        for(; i < n; i++)
+            dst[i] = Ogre::Bitwise::halfToFloat(src[i]);
     }
 };
 
+template <int id, int channels> struct PixelRowConverter<Float32toFloat16<id, channels> >
+{
+    static __m128i convert(const float *src)
+    {
+        // sign extend, so the signed saturation of the pack keeps all 16 bits
+        __m128i h = floatToHalf4(_mm_loadu_si128((const __m128i*)src));
+        return _mm_srai_epi32(_mm_slli_epi32(h, 16), 16);
+    }
+    static void conversion(const ColNf<channels> *srcptr, ColNh<channels> *dstptr, size_t count)
+    {
+        const float* src = srcptr->c;
+        Ogre::uint16* dst = dstptr->c;
+        size_t n = count * channels;
+        size_t i = 0;
+        for(; i + 8 <= n; i += 8)
+        {
+            _mm_storeu_si128((__m128i*)(dst + i), _mm_packs_epi32(convert(src + i), convert(src + i + 4)));
+        }
+        for(; i < n; i++)
+            dst[i] = Ogre::Bitwise::floatToHalf(src[i]);
+    }
+};
+#endif
 
 #define CASECONVERTER(type) case type::ID : PixelBoxConverter<type>::conversion(src, dst); return 1;
 
@@ -478,6 +585,14 @@ inline int doOptimizedConversion(const Ogre::PixelBox &src, const Ogre::PixelBox
         CASECONVERTER(X8B8G8R8toA8B8G8R8);
         CASECONVERTER(X8B8G8R8toB8G8R8A8);
         CASECONVERTER(X8B8G8R8toR8G8B8A8);
+        CASECONVERTER(FLOAT16RtoFLOAT32R);
+        CASECONVERTER(FLOAT16GRtoFLOAT32GR);
+        CASECONVERTER(FLOAT16RGBtoFLOAT32RGB);
+        CASECONVERTER(FLOAT16RGBAtoFLOAT32RGBA);
+        CASECONVERTER(FLOAT32RtoFLOAT16R);
+        CASECONVERTER(FLOAT32GRtoFLOAT16GR);
+        CASECONVERTER(FLOAT32RGBtoFLOAT16RGB);
+        CASECONVERTER(FLOAT32RGBAtoFLOAT16RGBA);
 
         default:
             return 0;
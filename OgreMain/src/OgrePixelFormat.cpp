@@ -28,6 +28,20 @@ THE SOFTWARE.
 #include "OgreStableHeaders.h"
 #include "OgrePixelFormat.h"
 #include "OgrePixelFormatDescriptions.h"
+#include "OgreWorkQueue.h"
+#include "OgreBlockCompressor.h"
+#include "OgrePlatformInformation.h"
+#include "OgreSIMDHelper.h"
+
+// the row converters need SSE2, which is not implied by __OGRE_HAVE_SSE on 32 bit x86
+#if __OGRE_HAVE_SSE && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define __OGRE_HAVE_PIXELCONV_SIMD 1
+#elif __OGRE_HAVE_NEON
+#define __OGRE_HAVE_PIXELCONV_SIMD 1
+#else
+#define __OGRE_HAVE_PIXELCONV_SIMD 0
+#endif
 
 namespace {
 #include "OgrePixelConversions.h"
@@ -655,12 +669,72 @@ namespace Ogre {
         }
     }
     //-----------------------------------------------------------------------
+    /* Convert pixels of different, uncompressed formats */
+    static void convertPixelBox(const PixelBox &src, const PixelBox &dst)
+    {
+// NB VC6 can't handle the templates required for optimised conversion, tough
+#if OGRE_COMPILER != OGRE_COMPILER_MSVC || OGRE_COMP_VER >= 1300
+        // Is there a specialized, inlined, conversion?
+        if(doOptimizedConversion(src, dst))
+        {
+            // If so, good
+            return;
+        }
+#endif
+
+        const size_t srcPixelSize = PixelUtil::getNumElemBytes(src.format);
+        const size_t dstPixelSize = PixelUtil::getNumElemBytes(dst.format);
+        uint8* srcptr = src.getTopLeftFrontPixelPtr();
+        uint8* dstptr = dst.getTopLeftFrontPixelPtr();
+
+        // Old way, not taking into account box dimensions
+        //uint8 *srcptr = static_cast<uint8*>(src.data), *dstptr = static_cast<uint8*>(dst.data);
+
+        // Calculate pitches+skips in bytes
+        const size_t srcRowSkipBytes = src.getRowSkip()*srcPixelSize;
+        const size_t srcSliceSkipBytes = src.getSliceSkip()*srcPixelSize;
+        const size_t dstRowSkipBytes = dst.getRowSkip()*dstPixelSize;
+        const size_t dstSliceSkipBytes = dst.getSliceSkip()*dstPixelSize;
+
+        // The brute force fallback
+        float r = 0, g = 0, b = 0, a = 1;
+        for(size_t z=src.front; z<src.back; z++)
+        {
+            for(size_t y=src.top; y<src.bottom; y++)
+            {
+                for(size_t x=src.left; x<src.right; x++)
+                {
+                    PixelUtil::unpackColour(&r, &g, &b, &a, src.format, srcptr);
+                    PixelUtil::packColour(r, g, b, a, dst.format, dstptr);
+                    srcptr += srcPixelSize;
+                    dstptr += dstPixelSize;
+                }
+                srcptr += srcRowSkipBytes;
+                dstptr += dstRowSkipBytes;
+            }
+            srcptr += srcSliceSkipBytes;
+            dstptr += dstSliceSkipBytes;
+        }
+    }
+    //-----------------------------------------------------------------------
+    // images with fewer pixels are converted on the calling thread
+    static const size_t PARALLEL_CONVERSION_MIN_PIXELS = 512 * 512;
+    // pixels converted by one task at least
+    static const size_t PARALLEL_CONVERSION_TASK_PIXELS = 64 * 1024;
+    //-----------------------------------------------------------------------
     /* Convert pixels from one format to another */
     void PixelUtil::bulkPixelConversion(const PixelBox &src, const PixelBox &dst)
     {
         OgreAssert(src.getSize() == dst.getSize(), "");
 
-        // Check for compressed formats, we don't support decompression, compression or recoding
+        // Compress on the CPU, if we have an encoder for the format
+        if(!PixelUtil::isCompressed(src.format) && BlockCompressor::isSupported(dst.format))
+        {
+            BlockCompressor::encode(src, dst);
+            return;
+        }
+
+        // Check for compressed formats, we don't support decompression or recoding
         if(PixelUtil::isCompressed(src.format) || PixelUtil::isCompressed(dst.format))
         {
             OgreAssert(src.format == dst.format && src.isConsecutive() && dst.isConsecutive(),
@@ -734,49 +808,30 @@ namespace Ogre {
             return;
         }
 
-// NB VC6 can't handle the templates required for optimised conversion, tough
-#if OGRE_COMPILER != OGRE_COMPILER_MSVC || OGRE_COMP_VER >= 1300
-        // Is there a specialized, inlined, conversion?
-        if(doOptimizedConversion(src, dst))
+        // Large images are converted in bands of rows on the worker threads
+        WorkQueue* workQueue = Root::getSingletonPtr() ? Root::getSingleton().getWorkQueue() : NULL;
+        const size_t numRows = src.getHeight() * src.getDepth();
+        if(workQueue && numRows > 1 && src.getWidth() * numRows >= PARALLEL_CONVERSION_MIN_PIXELS)
         {
-            // If so, good
-            return;
-        }
-#endif
-
-        const size_t srcPixelSize = PixelUtil::getNumElemBytes(src.format);
-        const size_t dstPixelSize = PixelUtil::getNumElemBytes(dst.format);
-        uint8* srcptr = src.getTopLeftFrontPixelPtr();
-        uint8* dstptr = dst.getTopLeftFrontPixelPtr();
-
-        // Old way, not taking into account box dimensions
-        //uint8 *srcptr = static_cast<uint8*>(src.data), *dstptr = static_cast<uint8*>(dst.data);
-
-        // Calculate pitches+skips in bytes
-        const size_t srcRowSkipBytes = src.getRowSkip()*srcPixelSize;
-        const size_t srcSliceSkipBytes = src.getSliceSkip()*srcPixelSize;
-        const size_t dstRowSkipBytes = dst.getRowSkip()*dstPixelSize;
-        const size_t dstSliceSkipBytes = dst.getSliceSkip()*dstPixelSize;
-
-        // The brute force fallback
-        float r = 0, g = 0, b = 0, a = 1;
-        for(size_t z=src.front; z<src.back; z++)
-        {
-            for(size_t y=src.top; y<src.bottom; y++)
-            {
-                for(size_t x=src.left; x<src.right; x++)
+            const size_t height = src.getHeight();
+            const size_t rowsPerTask = std::max<size_t>(1, PARALLEL_CONVERSION_TASK_PIXELS / src.getWidth());
+            workQueue->parallelFor(0, numRows, [&](size_t first, size_t last) {
+                while(first < last)
                 {
-                    unpackColour(&r, &g, &b, &a, src.format, srcptr);
-                    packColour(r, g, b, a, dst.format, dstptr);
-                    srcptr += srcPixelSize;
-                    dstptr += dstPixelSize;
+                    // a band must not cross slices
+                    size_t z = first / height;
+                    size_t y = first % height;
+                    size_t rows = std::min(last - first, height - y);
+                    Box srcBox(src.left, src.top + y, src.front + z, src.right, src.top + y + rows, src.front + z + 1);
+                    Box dstBox(dst.left, dst.top + y, dst.front + z, dst.right, dst.top + y + rows, dst.front + z + 1);
+                    convertPixelBox(src.getSubVolume(srcBox), dst.getSubVolume(dstBox));
+                    first += rows;
                 }
-                srcptr += srcRowSkipBytes;
-                dstptr += dstRowSkipBytes;
-            }
-            srcptr += srcSliceSkipBytes;
-            dstptr += dstSliceSkipBytes;
+            }, rowsPerTask);
+            return;
         }
+
+        convertPixelBox(src, dst);
     }
     //-----------------------------------------------------------------------
     void PixelUtil::bulkPixelVerticalFlip(const PixelBox &box)
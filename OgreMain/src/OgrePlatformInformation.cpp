@@ -146,12 +146,12 @@ namespace Ogre {
     }
 
     //---------------------------------------------------------------------
-    // Performs CPUID instruction with 'query', fill the results, and return value of eax.
-    static uint _performCpuid(int query, CpuidResult& result)
+    // Performs CPUID instruction with 'query' and 'subQuery', fill the results, and return value of eax.
+    static uint _performCpuid(int query, CpuidResult& result, int subQuery = 0)
     {
 #if OGRE_COMPILER == OGRE_COMPILER_MSVC
         int CPUInfo[4];
-        __cpuid(CPUInfo, query);
+        __cpuidex(CPUInfo, query, subQuery);
         result._eax = CPUInfo[0];
         result._ebx = CPUInfo[1];
         result._ecx = CPUInfo[2];
@@ -161,7 +161,7 @@ namespace Ogre {
         #if OGRE_ARCH_TYPE == OGRE_ARCHITECTURE_64
         __asm__
         (
-            "cpuid": "=a" (result._eax), "=b" (result._ebx), "=c" (result._ecx), "=d" (result._edx) : "a" (query)
+            "cpuid": "=a" (result._eax), "=b" (result._ebx), "=c" (result._ecx), "=d" (result._edx) : "a" (query), "c" (subQuery)
         );
         #else
         __asm__
@@ -171,7 +171,7 @@ namespace Ogre {
             "movl   %%ebx, %%edi    \n\t"
             "popl   %%ebx           \n\t"
             : "=a" (result._eax), "=D" (result._ebx), "=c" (result._ecx), "=d" (result._edx)
-            : "a" (query)
+            : "a" (query), "c" (subQuery)
         );
        #endif // OGRE_ARCHITECTURE_64
         return result._eax;
@@ -182,6 +182,21 @@ namespace Ogre {
 #endif
     }
 
+    //---------------------------------------------------------------------
+    // Reads the extended control register 0, telling which register states the OS saves.
+    static uint64 _performXgetbv(void)
+    {
+#if OGRE_COMPILER == OGRE_COMPILER_MSVC
+        return _xgetbv(0);
+#elif (OGRE_COMPILER == OGRE_COMPILER_GNUC || OGRE_COMPILER == OGRE_COMPILER_CLANG) && OGRE_PLATFORM != OGRE_PLATFORM_EMSCRIPTEN
+        uint eax, edx;
+        __asm__ (".byte 0x0f, 0x01, 0xd0" : "=a" (eax), "=d" (edx) : "c" (0)); // xgetbv
+        return (uint64(edx) << 32) | eax;
+#else
+        return 0;
+#endif
+    }
+
 #if OGRE_COMPILER == OGRE_COMPILER_MSVC
 #pragma warning(pop)
 #endif
@@ -262,6 +277,37 @@ namespace Ogre {
     // Compiler-independent routines
     //---------------------------------------------------------------------
 
+#define CPUID_STD_FMA               (1<<12)     // ECX[12] - Bit 12 of standard function 1 indicate FMA supported
+#define CPUID_STD_OSXSAVE           (1<<27)     // ECX[27] - Bit 27 of standard function 1 indicate XGETBV is enabled by the OS
+#define CPUID_STD_AVX               (1<<28)     // ECX[28] - Bit 28 of standard function 1 indicate AVX supported
+
+#define CPUID_FUNC_STRUCTURED_EXTENDED_FEATURES 0x7
+#define CPUID_SEF_AVX2              (1<<5)      // EBX[5]  - Bit 5 of function 7 indicate AVX2 supported
+
+#define XCR0_SSE_AVX_STATE          0x6         // Bit 1 and 2 of XCR0 indicate the OS saves the XMM and YMM registers
+
+    // Checks the AVX features, which also need the OS to save the YMM registers
+    static uint _queryAvxFeatures(uint maxFunctionSupport, const CpuidResult& standardFeatures)
+    {
+        uint features = 0;
+        if (!(standardFeatures._ecx & CPUID_STD_OSXSAVE) || !(standardFeatures._ecx & CPUID_STD_AVX) ||
+            (_performXgetbv() & XCR0_SSE_AVX_STATE) != XCR0_SSE_AVX_STATE)
+            return features;
+
+        features |= PlatformInformation::CPU_FEATURE_AVX;
+        if (standardFeatures._ecx & CPUID_STD_FMA)
+            features |= PlatformInformation::CPU_FEATURE_FMA;
+
+        if (maxFunctionSupport >= CPUID_FUNC_STRUCTURED_EXTENDED_FEATURES)
+        {
+            CpuidResult result;
+            _performCpuid(CPUID_FUNC_STRUCTURED_EXTENDED_FEATURES, result, 0);
+            if (result._ebx & CPUID_SEF_AVX2)
+                features |= PlatformInformation::CPU_FEATURE_AVX2;
+        }
+        return features;
+    }
+
     static uint queryCpuFeatures(void)
     {
 
@@ -305,6 +351,7 @@ namespace Ogre {
             if (_performCpuid(CPUID_FUNC_VENDOR_ID, result))
             {
                 // Check vendor strings
+                const uint maxFunctionSupport = result._eax;
                 if (memcmp(&result._ebx, "GenuineIntel", 12) == 0)
                 {
                     if (result._eax > 2)
@@ -312,6 +359,7 @@ namespace Ogre {
 
                     // Check standard feature
                     _performCpuid(CPUID_FUNC_STANDARD_FEATURES, result);
+                    features |= _queryAvxFeatures(maxFunctionSupport, result);
 
                     if (result._edx & CPUID_STD_FPU)
                         features |= PlatformInformation::CPU_FEATURE_FPU;
@@ -357,6 +405,7 @@ namespace Ogre {
 
                     // Check standard feature
                     _performCpuid(CPUID_FUNC_STANDARD_FEATURES, result);
+                    features |= _queryAvxFeatures(maxFunctionSupport, result);
 
                     if (result._edx & CPUID_STD_FPU)
                         features |= PlatformInformation::CPU_FEATURE_FPU;
@@ -413,7 +462,10 @@ namespace Ogre {
             | PlatformInformation::CPU_FEATURE_SSE2
             | PlatformInformation::CPU_FEATURE_SSE3
             | PlatformInformation::CPU_FEATURE_SSE41
-            | PlatformInformation::CPU_FEATURE_SSE42;
+            | PlatformInformation::CPU_FEATURE_SSE42
+            | PlatformInformation::CPU_FEATURE_AVX
+            | PlatformInformation::CPU_FEATURE_AVX2
+            | PlatformInformation::CPU_FEATURE_FMA;
 
         if ((features & sse_features) && !_checkOperatingSystemSupportSSE())
         {
@@ -687,6 +739,12 @@ namespace Ogre {
                 " *        SSE41: " + StringConverter::toString(hasCpuFeature(CPU_FEATURE_SSE41), true));
             pLog->logMessage(
                 " *        SSE42: " + StringConverter::toString(hasCpuFeature(CPU_FEATURE_SSE42), true));
+            pLog->logMessage(
+                " *          AVX: " + StringConverter::toString(hasCpuFeature(CPU_FEATURE_AVX), true));
+            pLog->logMessage(
+                " *         AVX2: " + StringConverter::toString(hasCpuFeature(CPU_FEATURE_AVX2), true));
+            pLog->logMessage(
+                " *          FMA: " + StringConverter::toString(hasCpuFeature(CPU_FEATURE_FMA), true));
             pLog->logMessage(
                 " *          MMX: " + StringConverter::toString(hasCpuFeature(CPU_FEATURE_MMX), true));
             pLog->logMessage(
@@ -0,0 +1,260 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "OgreStableHeaders.h"
+#include "OgreProfileTrace.h"
+#include "OgreBitwise.h"
+
+#include <chrono>
+#include <fstream>
+#include <unordered_map>
+
+namespace Ogre {
+
+    namespace
+    {
+        struct TraceEvent
+        {
+            /// Nanoseconds of the steady clock
+            std::atomic<uint64> time;
+            /// Name id, with the end flag
+            std::atomic<uint32> name;
+        };
+
+        struct ThreadBuffer
+        {
+            /// Allocated on the first event, as naming a thread must not cost memory
+            std::unique_ptr<TraceEvent[]> events;
+            size_t mask;
+            /// Number of events recorded so far, only written by the owning thread
+            std::atomic<uint64> head;
+            uint32 id;
+            String name;
+
+            ThreadBuffer(uint32 _id) : mask(0), head(0), id(_id) {}
+        };
+
+        struct Registry
+        {
+            OGRE_WQ_MUTEX(mutex);
+            std::vector<std::unique_ptr<ThreadBuffer>> threads;
+            std::unordered_map<String, ProfileTrace::NameId> nameIds;
+            std::vector<String> names;
+            size_t bufferSize;
+            uint64 epoch;
+
+            Registry() : bufferSize(65536), epoch(now()) {}
+
+            static uint64 now()
+            {
+                return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                           std::chrono::steady_clock::now().time_since_epoch()).count();
+            }
+
+            /// Buffer of the calling thread, called with the mutex locked
+            ThreadBuffer* getThreadBuffer();
+        };
+
+        Registry& registry()
+        {
+            static Registry reg;
+            return reg;
+        }
+
+        // owned by the registry, which keeps the buffers of the finished threads for the export
+        thread_local ThreadBuffer* tlsBuffer = NULL;
+
+        ThreadBuffer* Registry::getThreadBuffer()
+        {
+            if (!tlsBuffer)
+            {
+                threads.emplace_back(new ThreadBuffer(uint32(threads.size() + 1)));
+                tlsBuffer = threads.back().get();
+            }
+            return tlsBuffer;
+        }
+
+        void writeJsonString(std::ostream& os, const String& str)
+        {
+            os << '"';
+            for (char c : str)
+            {
+                if (c == '"' || c == '\\')
+                    os << '\\' << c;
+                else if ((unsigned char)c < 0x20)
+                    os << StringUtil::format("\\u%04x", c);
+                else
+                    os << c;
+            }
+            os << '"';
+        }
+    }
+
+    std::atomic<bool> ProfileTrace::msEnabled(false);
+    //-----------------------------------------------------------------------
+    void ProfileTrace::setEnabled(bool enabled)
+    {
+        msEnabled.store(enabled);
+    }
+    //-----------------------------------------------------------------------
+    void ProfileTrace::setThreadBufferSize(size_t events)
+    {
+        Registry& reg = registry();
+        OGRE_WQ_LOCK_MUTEX(reg.mutex);
+        reg.bufferSize = Bitwise::firstPO2From(uint32(std::max<size_t>(events, 2)));
+    }
+    //-----------------------------------------------------------------------
+    ProfileTrace::NameId ProfileTrace::intern(const String& name)
+    {
+        Registry& reg = registry();
+        OGRE_WQ_LOCK_MUTEX(reg.mutex);
+        auto it = reg.nameIds.find(name);
+        if (it != reg.nameIds.end())
+            return it->second;
+
+        OgreAssert(reg.names.size() < END_FLAG, "too many trace names");
+        NameId id = NameId(reg.names.size());
+        reg.names.push_back(name);
+        reg.nameIds.emplace(name, id);
+        return id;
+    }
+    //-----------------------------------------------------------------------
+    void ProfileTrace::setThreadName(const String& name)
+    {
+        Registry& reg = registry();
+        OGRE_WQ_LOCK_MUTEX(reg.mutex);
+        reg.getThreadBuffer()->name = name;
+    }
+    //-----------------------------------------------------------------------
+    void ProfileTrace::record(uint32 event)
+    {
+        ThreadBuffer* buffer = tlsBuffer;
+        if (!buffer || !buffer->events)
+        {
+            Registry& reg = registry();
+            OGRE_WQ_LOCK_MUTEX(reg.mutex);
+            buffer = reg.getThreadBuffer();
+            buffer->events.reset(new TraceEvent[reg.bufferSize]);
+            buffer->mask = reg.bufferSize - 1;
+        }
+
+        uint64 head = buffer->head.load(std::memory_order_relaxed);
+        TraceEvent& e = buffer->events[head & buffer->mask];
+        e.time.store(Registry::now(), std::memory_order_relaxed);
+        e.name.store(event, std::memory_order_relaxed);
+        // publishes the event to writeChromeTrace
+        buffer->head.store(head + 1, std::memory_order_release);
+    }
+    //-----------------------------------------------------------------------
+    void ProfileTrace::clear(void)
+    {
+        Registry& reg = registry();
+        OGRE_WQ_LOCK_MUTEX(reg.mutex);
+        for (auto& t : reg.threads)
+            t->head.store(0);
+        reg.epoch = Registry::now();
+    }
+    //-----------------------------------------------------------------------
+    void ProfileTrace::writeChromeTrace(std::ostream& os)
+    {
+        Registry& reg = registry();
+        OGRE_WQ_LOCK_MUTEX(reg.mutex);
+
+        os << "{\"traceEvents\":[";
+        const char* separator = "\n";
+        std::vector<std::pair<uint32, uint64>> events, open;
+        for (auto& t : reg.threads)
+        {
+            if (!t->name.empty())
+            {
+                os << separator << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << t->id
+                   << ",\"args\":{\"name\":";
+                writeJsonString(os, t->name);
+                os << "}}";
+                separator = ",\n";
+            }
+            if (!t->events)
+                continue;
+
+            // copy the events, then drop the ones the thread may have overwritten meanwhile
+            size_t capacity = t->mask + 1;
+            uint64 head = t->head.load(std::memory_order_acquire);
+            uint64 first = head > capacity ? head - capacity : 0;
+            events.clear();
+            for (uint64 i = first; i < head; ++i)
+            {
+                const TraceEvent& e = t->events[i & t->mask];
+                events.emplace_back(e.name.load(std::memory_order_relaxed),
+                                    e.time.load(std::memory_order_relaxed));
+            }
+            uint64 valid = t->head.load(std::memory_order_acquire);
+            // the slot of the event being recorded may be half written as well
+            valid = valid >= capacity ? valid - capacity + 1 : 0;
+            if (valid > first)
+                events.erase(events.begin(), events.begin() + std::min<uint64>(valid - first, events.size()));
+
+            // pair the begin and end events, an end without begin lost it to the ring
+            open.clear();
+            for (const auto& e : events)
+            {
+                if (!(e.first & END_FLAG))
+                {
+                    open.push_back(e);
+                    continue;
+                }
+
+                uint32 name = e.first & ~uint32(END_FLAG);
+                auto it = std::find_if(open.rbegin(), open.rend(),
+                                       [name](const std::pair<uint32, uint64>& o) { return o.first == name; });
+                if (it == open.rend())
+                    continue;
+
+                uint64 begin = std::max(it->second, reg.epoch);
+                uint64 end = std::max(e.second, begin);
+                // scopes opened after this one and not closed before it lost their end
+                open.erase(std::next(it).base(), open.end());
+
+                os << separator << "{\"name\":";
+                writeJsonString(os, reg.names[name]);
+                os << ",\"cat\":\"ogre\",\"ph\":\"X\",\"pid\":1,\"tid\":" << t->id
+                   << StringUtil::format(",\"ts\":%.3f,\"dur\":%.3f}", (begin - reg.epoch) / 1000.0,
+                                         (end - begin) / 1000.0);
+                separator = ",\n";
+            }
+        }
+        os << "\n],\"displayTimeUnit\":\"ms\"}\n";
+    }
+    //-----------------------------------------------------------------------
+    void ProfileTrace::exportChromeTrace(const String& filename)
+    {
+        std::ofstream file(filename.c_str());
+        if (!file)
+            OGRE_EXCEPT(Exception::ERR_CANNOT_WRITE_TO_FILE, "Cannot open '" + filename + "' for writing",
+                        "ProfileTrace::exportChromeTrace");
+        writeChromeTrace(file);
+    }
+}
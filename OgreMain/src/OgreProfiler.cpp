@@ -40,6 +40,7 @@ Ogre-dependent is in the visualization/logging routines and the use of the Timer
 */
 
 #include "OgreTimer.h"
+#include "OgreProfileTrace.h"
 
 #ifdef USE_REMOTERY
 #include "Remotery.h"
@@ -204,6 +205,9 @@ namespace Ogre {
 
         rmt_BeginCPUSampleDynamic(profileName.c_str(), RMTSF_Aggregate);
 #else
+        if (ProfileTrace::isEnabled() && (groupID & mProfileMask))
+            ProfileTrace::begin(ProfileTrace::intern(profileName));
+
         // if the profiler is enabled
         if (!mEnabled)
             return;
@@ -271,6 +275,9 @@ namespace Ogre {
 
         rmt_EndCPUSample();
 #else
+        if (ProfileTrace::isEnabled() && (groupID & mProfileMask))
+            ProfileTrace::end(ProfileTrace::intern(profileName));
+
         if(!mEnabled) 
         {
             // if the profiler received a request to be enabled or disabled
@@ -80,7 +80,8 @@ namespace Ogre {
     @note
         Radix sorting is often associated with just unsigned integer values. Our
         implementation can handle both unsigned and signed integers, as well as
-        floats (which are often not supported by other radix sorters). doubles
+        floats (which are often not supported by other radix sorters) and 64 bit
+        unsigned integers, which are useful for packed sort keys. doubles
         are not supported; you will need to implement your functor object to convert
         to float if you wish to use this sort routine.
     */
@@ -91,8 +92,8 @@ namespace Ogre {
         typedef typename TContainer::iterator ContainerIter;
     protected:
         /// Alpha-pass counters of values (histogram)
-        /// 4 of them so we can radix sort a maximum of a 32bit value
-        int mCounters[4][256];
+        /// 8 of them so we can radix sort a maximum of a 64bit value
+        int mCounters[8][256];
         /// Beta-pass offsets 
         int mOffsets[256];
         /// Sort area size
@@ -309,6 +310,10 @@ namespace Ogre {
 
             for (p = 0; p < mNumPasses - 1; ++p)
             {
+                // skip the bytes all the values share, common with packed keys
+                if (mCounters[p][getByte(p, (*mSrc)[0].key)] == mSortSize)
+                    continue;
+
                 sortPass(p);
                 // flip src/dst
                 SortVector* tmp = mSrc;
@@ -0,0 +1,129 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "OgreStableHeaders.h"
+#include "OgreRayPacket.h"
+#include "OgrePlatformInformation.h"
+
+#if (__OGRE_HAVE_SSE && OGRE_ARCH_TYPE == OGRE_ARCHITECTURE_64) || __OGRE_HAVE_NEON
+#define OGRE_RAY_PACKET_SIMD 1
+#include "OgreSIMDHelper.h"
+#else
+#define OGRE_RAY_PACKET_SIMD 0
+#endif
+
+namespace Ogre {
+    //-----------------------------------------------------------------------
+    RayPacket::RayPacket(const Ray* rays, size_t count) : mRays(rays), mCount(count)
+    {
+        assert(count <= WIDTH);
+        for (size_t i = 0; i < WIDTH; ++i)
+        {
+            // the unused lanes repeat the first ray, but never hit as they end before
+            // they start
+            const Ray& ray = rays[i < count ? i : 0];
+            for (int c = 0; c < 3; ++c)
+            {
+                // Clamp the inverse of zero components to a finite value, so the
+                // distances to the faces the ray lies in are 0 rather than NaN
+                Real invDir = 1 / ray.getDirection()[c];
+                mOrigin[c][i] = ray.getOrigin()[c];
+                mInvDirection[c][i] = Math::Clamp(invDir, -std::numeric_limits<Real>::max(),
+                                                  std::numeric_limits<Real>::max());
+            }
+            mMaxDistance[i] = i < count ? std::numeric_limits<Real>::infinity() : -1;
+        }
+    }
+    //-----------------------------------------------------------------------
+    RayPacket::Mask RayPacket::intersects(const Vector3& min, const Vector3& max, Real* nearest) const
+    {
+        // slabs test of all the rays, along the rays only
+#if OGRE_RAY_PACKET_SIMD
+        __m128 tmin = _mm_setzero_ps();
+        __m128 tmax = _mm_loadu_ps(mMaxDistance);
+        for (int c = 0; c < 3; ++c)
+        {
+            __m128 origin = _mm_loadu_ps(mOrigin[c]);
+            __m128 invDir = _mm_loadu_ps(mInvDirection[c]);
+            __m128 t0 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(min[c]), origin), invDir);
+            __m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(max[c]), origin), invDir);
+            tmin = _mm_max_ps(tmin, _mm_min_ps(t0, t1));
+            tmax = _mm_min_ps(tmax, _mm_max_ps(t0, t1));
+        }
+        Mask hits = Mask(_mm_movemask_ps(_mm_cmple_ps(tmin, tmax)));
+
+        if (nearest && hits)
+        {
+            OGRE_ALIGNED_DECL(float, entry[WIDTH], 16);
+            _mm_store_ps(entry, tmin);
+            Real d = std::numeric_limits<Real>::infinity();
+            for (size_t i = 0; i < WIDTH; ++i)
+            {
+                if (hits & (1 << i))
+                    d = std::min(d, entry[i]);
+            }
+            *nearest = d;
+        }
+        return hits;
+#else
+        Mask hits = 0;
+        Real d = std::numeric_limits<Real>::infinity();
+        for (size_t i = 0; i < WIDTH; ++i)
+        {
+            Real tmin = 0, tmax = mMaxDistance[i];
+            for (int c = 0; c < 3; ++c)
+            {
+                Real t0 = (min[c] - mOrigin[c][i]) * mInvDirection[c][i];
+                Real t1 = (max[c] - mOrigin[c][i]) * mInvDirection[c][i];
+                tmin = std::max(tmin, std::min(t0, t1));
+                tmax = std::min(tmax, std::max(t0, t1));
+            }
+            if (tmin <= tmax)
+            {
+                hits |= 1 << i;
+                d = std::min(d, tmin);
+            }
+        }
+        if (nearest && hits)
+            *nearest = d;
+        return hits;
+#endif
+    }
+    //-----------------------------------------------------------------------
+    RayPacket::Mask RayPacket::intersects(const AxisAlignedBox& box, Real* nearest) const
+    {
+        if (box.isNull())
+            return 0;
+        if (box.isInfinite())
+        {
+            if (nearest)
+                *nearest = 0;
+            return getMask();
+        }
+        return intersects(box.getMinimum(), box.getMaximum(), nearest);
+    }
+}
@@ -33,6 +33,7 @@ THE SOFTWARE.
 #include "OgreMaterial.h"
 #include "OgreRenderQueueSortingGrouping.h"
 #include "OgreSceneManagerEnumerator.h"
+#include "OgreEngineStatistics.h"
 
 namespace Ogre {
 
@@ -263,7 +264,10 @@ namespace Ogre {
 
         mo->_notifyCurrentCamera(cam);
         if (!mo->isVisible())
+        {
+            EngineStatistics::add(EngineStatistics::SC_CULLED_OBJECTS);
             return;
+        }
 
         const auto& bbox = mo->getWorldBoundingBox(true);
         const auto& bsphere = mo->getWorldBoundingSphere(true);
@@ -271,6 +275,7 @@ namespace Ogre {
         if (!onlyShadowCasters || mo->getCastShadows())
         {
             mo->_updateRenderQueue(this);
+            EngineStatistics::add(EngineStatistics::SC_VISIBLE_OBJECTS);
             if (visibleBounds)
             {
                 visibleBounds->merge(bbox, bsphere, cam, receiveShadows);
@@ -95,6 +95,53 @@ namespace {
             return static_cast<float>(- p.renderable->getSquaredViewDepth(camera));
         }
     };
+
+    /// Folds a hash to its lowest bits
+    uint32 foldHash(uint32 hash, int bits)
+    {
+        hash *= 0x9E3779B1; // spread the bits of pointers, which share their lowest ones
+        return hash >> (32 - bits);
+    }
+
+    /** Packs the state of a RenderablePass into a key, from the most significant bits
+        bits   purpose
+         4     Pass index, so the passes of a renderable are rendered in order
+        16     GPU programs
+        16     Textures
+         6     Pass, which sets the remaining state
+         8     Vertex declaration
+        14     Camera distance, front to back
+    */
+    uint64 calculateSortKey(const RenderablePass& rp, const Camera* cam)
+    {
+        const Pass* pass = rp.pass;
+        uint32 programs = 0;
+        for (int i = 0; i < GPT_COUNT; i++)
+        {
+            if (pass->hasGpuProgram(GpuProgramType(i)))
+                programs = HashCombine(programs, pass->getGpuProgram(GpuProgramType(i)).get());
+        }
+        uint32 textures = 0;
+        for (auto* tus : pass->getTextureUnitStates())
+            textures = HashCombine(textures, tus->_getTexturePtr().get());
+
+        RenderOperation op;
+        rp.renderable->getRenderOperation(op);
+        const VertexDeclaration* decl = op.vertexData ? op.vertexData->vertexDeclaration : NULL;
+
+        // the bits of positive floats order like them, keep the exponent and the highest
+        // bits of the mantissa
+        float depth = std::max(float(rp.renderable->getSquaredViewDepth(cam)), 0.0f);
+        uint32 depthBits;
+        memcpy(&depthBits, &depth, sizeof(depthBits));
+
+        return (uint64(std::min<ushort>(pass->getIndex(), 15)) << 60) |
+               (uint64(foldHash(programs, 16)) << 44) |
+               (uint64(foldHash(textures, 16)) << 28) |
+               (uint64(foldHash(HashCombine(0, pass), 6)) << 22) |
+               (uint64(foldHash(HashCombine(0, decl), 8)) << 14) |
+               (depthBits >> 17);
+    }
 }
     //-----------------------------------------------------------------------
     RenderPriorityGroup::RenderPriorityGroup(RenderQueueGroup* parent, 
@@ -131,7 +178,9 @@ namespace {
         mSolidsDiffuseSpecular.addOrganisationMode(om);
         mSolidsDecal.addOrganisationMode(om);
         mSolidsNoShadowReceive.addOrganisationMode(om);
-        mTransparentsUnsorted.addOrganisationMode(om);
+        // unsorted transparents must not be ordered by distance
+        mTransparentsUnsorted.addOrganisationMode(
+            om == QueuedRenderableCollection::OM_SORT_KEY ? QueuedRenderableCollection::OM_PASS_GROUP : om);
     }
     //-----------------------------------------------------------------------
     void RenderPriorityGroup::defaultOrganisationMode(void)
@@ -306,8 +355,9 @@ namespace {
             i.second.clear();
         }
 
-        // Clear sorted list
+        // Clear sorted lists
         mSortedDescending.clear();
+        mSortedByKey.clear();
     }
     //-----------------------------------------------------------------------
     void QueuedRenderableCollection::removePassGroup(Pass* p)
@@ -328,6 +378,26 @@ namespace {
         static RadixSort<RenderablePassList, RenderablePass, uint32> msRadixSorter1;
         /// Radix sorter for sort value 2 (distance)
         static RadixSort<RenderablePassList, RenderablePass, float> msRadixSorter2;
+        /// Radix sorter for the sort keys
+        static RadixSort<KeyedRenderablePassList, KeyedRenderablePass, uint64> msRadixSorterKey;
+
+        if (mOrganisationMode & OM_SORT_KEY)
+        {
+            for (auto& i : mSortedByKey)
+                i.key = calculateSortKey(i.rp, cam);
+
+            // see below for the tipping point, the radix sort skips the bytes the keys share
+            if (mSortedByKey.size() > 2000)
+            {
+                msRadixSorterKey.sort(mSortedByKey, [](const KeyedRenderablePass& p) { return p.key; });
+            }
+            else
+            {
+                std::stable_sort(mSortedByKey.begin(), mSortedByKey.end(),
+                                 [](const KeyedRenderablePass& a, const KeyedRenderablePass& b)
+                                 { return a.key < b.key; });
+            }
+        }
 
         // ascending and descending sort both set bit 1
         // We always sort descending, because the only difference is in the
@@ -394,6 +464,12 @@ namespace {
             mSortedDescending.push_back(RenderablePass(rend, pass));
         }
 
+        if (mOrganisationMode & OM_SORT_KEY)
+        {
+            // the keys depend on the camera, so they are calculated by sort
+            mSortedByKey.push_back(RenderablePass(rend, pass));
+        }
+
         if (mOrganisationMode & OM_PASS_GROUP)
         {
             // Optionally create new pass entry, build a new list
@@ -417,6 +493,8 @@ namespace {
             // try to fall back
             if (OM_PASS_GROUP & mOrganisationMode)
                 om = OM_PASS_GROUP;
+            else if (OM_SORT_KEY & mOrganisationMode)
+                om = OM_SORT_KEY;
             else if (OM_SORT_ASCENDING & mOrganisationMode)
                 om = OM_SORT_ASCENDING;
             else if (OM_SORT_DESCENDING & mOrganisationMode)
@@ -439,6 +517,9 @@ namespace {
         case OM_SORT_ASCENDING:
             acceptVisitorAscending(visitor);
             break;
+        case OM_SORT_KEY:
+            acceptVisitorSortKey(visitor);
+            break;
         }
         
     }
@@ -480,9 +561,30 @@ namespace {
 
     }
     //-----------------------------------------------------------------------
+    void QueuedRenderableCollection::acceptVisitorSortKey(
+        QueuedRenderableVisitor* visitor) const
+    {
+        // visit the runs of the same pass as groups, so the pass is only set once per run
+        const Pass* pass = NULL;
+        mPassRun.clear();
+        for (const auto& i : mSortedByKey)
+        {
+            if (i.rp.pass != pass && !mPassRun.empty())
+            {
+                visitor->visit(pass, mPassRun);
+                mPassRun.clear();
+            }
+            pass = i.rp.pass;
+            mPassRun.push_back(i.rp.renderable);
+        }
+        if (!mPassRun.empty())
+            visitor->visit(pass, mPassRun);
+    }
+    //-----------------------------------------------------------------------
     void QueuedRenderableCollection::merge( const QueuedRenderableCollection& rhs )
     {
         mSortedDescending.insert( mSortedDescending.end(), rhs.mSortedDescending.begin(), rhs.mSortedDescending.end() );
+        mSortedByKey.insert( mSortedByKey.end(), rhs.mSortedByKey.begin(), rhs.mSortedByKey.end() );
 
         for (const auto& srcGroup : rhs.mGrouped)
         {
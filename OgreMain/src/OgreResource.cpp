@@ -27,6 +27,8 @@ THE SOFTWARE.
 */
 // Ogre includes
 #include "OgreStableHeaders.h"
+#include "OgreProfileTrace.h"
+#include "OgreEngineStatistics.h"
 
 namespace Ogre 
 {
@@ -94,6 +96,7 @@ namespace Ogre
         // Scope lock for actual loading
         try
         {
+            OgreTraceScope("Resource::prepare");
 
                     OGRE_LOCK_AUTO_MUTEX;
 
@@ -208,6 +211,9 @@ namespace Ogre
         // Scope lock for actual loading
         try
         {
+            OgreTraceScope("Resource::load");
+            EngineStatistics::ScopedTimer loadTimer(EngineStatistics::SC_RESOURCE_LOAD_TIME);
+            EngineStatistics::add(EngineStatistics::SC_RESOURCE_LOADS);
 
                     OGRE_LOCK_AUTO_MUTEX;
 
@@ -60,6 +60,8 @@ THE SOFTWARE.
 #include "OgreGpuProgramManager.h"
 #include "OgreExternalTextureSourceManager.h"
 #include "OgreCompositorManager.h"
+#include "OgreProfileTrace.h"
+#include "OgreEngineStatistics.h"
 
 #if OGRE_NO_PVRTC_CODEC == 0
 #  include "OgrePVRTCCodec.h"
@@ -679,6 +681,8 @@ namespace Ogre {
         // Tell the queue to process responses
         mWorkQueue->processMainThreadTasks();
 
+        EngineStatistics::_sampleFrame(mNextFrame);
+
         OgreProfileEndGroup("Frame", OGREPROF_GENERAL);
 
         return ret;
@@ -778,6 +782,8 @@ namespace Ogre {
     //-----------------------------------------------------------------------
     bool Root::renderOneFrame(void)
     {
+        OgreTraceScope("Root::renderOneFrame");
+
         if(!_fireFrameStarted())
             return false;
 
@@ -789,6 +795,8 @@ namespace Ogre {
     //---------------------------------------------------------------------
     bool Root::renderOneFrame(Real timeSinceLastFrame)
     {
+        OgreTraceScope("Root::renderOneFrame");
+
         FrameEvent evt;
         evt.timeSinceLastFrame = timeSinceLastFrame;
 
@@ -95,6 +95,12 @@ OGRE_FORCE_INLINE __m128 _mm_sub_ss(__m128 a, __m128 b)
     a[0] -= b[0];
     return a;
 }
+
+// self written
+OGRE_FORCE_INLINE __m128i _mm_unpacklo_epi64(__m128i a, __m128i b)
+{
+    return vreinterpretq_m128i_s64(vcombine_s64(vget_low_s64(vreinterpretq_s64_m128i(a)), vget_low_s64(vreinterpretq_s64_m128i(b))));
+}
 #endif
 
 
@@ -43,6 +43,9 @@ THE SOFTWARE.
 #include "OgreRenderTexture.h"
 #include "OgreLodListener.h"
 #include "OgreDefaultDebugDrawer.h"
+#include "OgreBoundingVolumeHierarchy.h"
+#include "OgreProfileTrace.h"
+#include "OgreEngineStatistics.h"
 
 // This class implements the most basic scene manager
 
@@ -81,6 +84,7 @@ mLightClippingInfoMapFrameNumber(999),
 mVisibilityMask(0xFFFFFFFF),
 mFindVisibleObjects(true),
 mCameraRelativeRendering(false),
+mSolidsSortedByKey(false),
 mLastLightHash(0),
 mGpuParamsDirty((uint16)GPV_ALL)
 {
@@ -98,6 +102,8 @@ mGpuParamsDirty((uint16)GPV_ALL)
 
     // create the auto param data source instance
     mAutoParamDataSource.reset(createAutoParamDataSource());
+
+    mLastPassPrograms.fill(NULL);
 }
 //-----------------------------------------------------------------------
 SceneManager::~SceneManager()
@@ -639,6 +645,8 @@ SceneNode* SceneManager::getSceneNode(const String& name, bool throwExceptionIfN
 //-----------------------------------------------------------------------
 const Pass* SceneManager::_setPass(const Pass* pass, bool shadowDerivation)
 {
+    EngineStatistics::add(EngineStatistics::SC_SET_PASS);
+
     //If using late material resolving, swap now.
     if (isLateMaterialResolving()) 
     {
@@ -875,9 +883,46 @@ const Pass* SceneManager::_setPass(const Pass* pass, bool shadowDerivation)
     // mark global params as dirty
     mGpuParamsDirty |= (uint16)GPV_GLOBAL;
 
+    if (EngineStatistics::isEnabled())
+        countPassStateChanges(pass);
+
     return pass;
 }
 //-----------------------------------------------------------------------
+void SceneManager::countPassStateChanges(const Pass* pass)
+{
+    uint64 programChanges = 0;
+    for (int i = 0; i < GPT_COUNT; i++)
+    {
+        GpuProgramType type = GpuProgramType(i);
+        const GpuProgram* prog = pass->hasGpuProgram(type) ? pass->getGpuProgram(type).get() : NULL;
+        if (prog != mLastPassPrograms[i])
+            ++programChanges;
+        mLastPassPrograms[i] = prog;
+    }
+
+    uint64 textureChanges = 0;
+    const auto& states = pass->getTextureUnitStates();
+    // disabled units change as well
+    if (mLastPassTextures.size() < states.size())
+        mLastPassTextures.resize(states.size(), NULL);
+    for (size_t unit = 0; unit < mLastPassTextures.size(); ++unit)
+    {
+        const Texture* tex = unit < states.size() ? states[unit]->_getTexturePtr().get() : NULL;
+        if (tex != mLastPassTextures[unit])
+            ++textureChanges;
+        mLastPassTextures[unit] = tex;
+    }
+
+    if (pass->getBlendState() != mLastPassBlendState)
+    {
+        EngineStatistics::_add(EngineStatistics::SC_BLEND_CHANGES, 1);
+        mLastPassBlendState = pass->getBlendState();
+    }
+    EngineStatistics::_add(EngineStatistics::SC_PROGRAM_CHANGES, programChanges);
+    EngineStatistics::_add(EngineStatistics::SC_TEXTURE_CHANGES, textureChanges);
+}
+//-----------------------------------------------------------------------
 static void updateShadowSplitOptions(const SceneManager* sceneManager, RenderQueue* queue)
 {
     int shadowTechnique = sceneManager->getShadowTechnique();
@@ -913,8 +958,15 @@ void SceneManager::prepareRenderQueue(void)
     // with defaults too
     for (auto& group : q->_getQueueGroups())
     {
-        if (group)
-            group->defaultOrganisationMode();
+        if (!group)
+            continue;
+
+        group->defaultOrganisationMode();
+        if (mSolidsSortedByKey)
+        {
+            group->resetOrganisationModes();
+            group->addOrganisationMode(QueuedRenderableCollection::OM_SORT_KEY);
+        }
     }
 
     // shadow split options
@@ -925,6 +977,7 @@ void SceneManager::_renderScene(Camera* camera, Viewport* vp, bool includeOverla
 {
     assert(camera);
     OgreProfileGroup(camera->getName(), OGREPROF_GENERAL);
+    OgreTraceScope("SceneManager::_renderScene");
 
     auto prevSceneManager = Root::getSingleton()._getCurrentSceneManager();
     Root::getSingleton()._setCurrentSceneManager(this);
@@ -962,6 +1015,7 @@ void SceneManager::_renderScene(Camera* camera, Viewport* vp, bool includeOverla
 
     // Update controllers 
     ControllerManager::getSingleton().updateAllControllers();
+    ParticleSystemManager::getSingleton()._processQueuedUpdates();
 
     // Update the scene, only do this once per frame
     unsigned long thisFrameNumber = Root::getSingleton().getNextFrameNumber();
@@ -1271,6 +1325,10 @@ void SceneManager::_updateSceneGraph(Camera* cam)
     //   certain scene graph branches
     getRootSceneNode()->_update(true, false);
 
+    // Moving objects degrade the hierarchy of the default queries
+    if (mSceneQueryBVH)
+        mSceneQueryBVH->rebuildIfNeeded();
+
     firePostUpdateSceneGraph(cam);
 }
 //-----------------------------------------------------------------------
@@ -3221,6 +3279,45 @@ void SceneManager::destroyQuery(SceneQuery* query)
     OGRE_DELETE query;
 }
 //---------------------------------------------------------------------
+BoundingVolumeHierarchy* SceneManager::_getSceneQueryBVH(void)
+{
+    if (!mSceneQueryBVH)
+    {
+        mSceneQueryBVH = std::make_unique<BoundingVolumeHierarchy>();
+
+        // Objects get their bounds once attached
+        for (const auto& c : mMovableObjectCollectionMap)
+        {
+            for (const auto& m : c.second->map)
+            {
+                if (m.second->isAttached() && m.second->_getSceneQueryLeaf() != BoundingVolumeHierarchy::NOT_TRACKED)
+                    _notifyMovableObjectBoundsUpdated(m.second);
+            }
+        }
+        mSceneQueryBVH->rebuild();
+    }
+    return mSceneQueryBVH.get();
+}
+//---------------------------------------------------------------------
+void SceneManager::_notifyMovableObjectBoundsUpdated(MovableObject* obj)
+{
+    if (!mSceneQueryBVH)
+        return;
+
+    // The sphere queries test the world bounding sphere, which may reach past the box,
+    // so derive it along
+    const Sphere& sphere = obj->getWorldBoundingSphere(true);
+    AxisAlignedBox bounds(sphere.getCenter() - sphere.getRadius(), sphere.getCenter() + sphere.getRadius());
+    bounds.merge(obj->getWorldBoundingBox());
+    mSceneQueryBVH->update(obj, bounds);
+}
+//---------------------------------------------------------------------
+void SceneManager::_notifyMovableObjectDetached(MovableObject* obj)
+{
+    if (mSceneQueryBVH)
+        mSceneQueryBVH->remove(obj);
+}
+//---------------------------------------------------------------------
 SceneManager::MovableObjectCollection* 
 SceneManager::getMovableObjectCollection(const String& typeName)
 {
@@ -3288,6 +3385,8 @@ MovableObject* SceneManager::createMovableObject(const String& name,
 
         MovableObject* newObj = factory->createInstance(name, this, params);
         objectMap->map[name] = newObj;
+        // searched by the default scene queries
+        newObj->_setSceneQueryLeaf(BoundingVolumeHierarchy::NO_LEAF);
         return newObj;
     }
 
@@ -3450,6 +3549,23 @@ void SceneManager::injectMovableObject(MovableObject* m)
 
         objectMap->map[m->getName()] = m;
     }
+
+    // The default scene queries only search the types with a factory
+    if (m->_getManager() == this && m->_getSceneQueryLeaf() == BoundingVolumeHierarchy::NOT_TRACKED &&
+        Root::getSingleton().hasMovableObjectFactory(m->getMovableType()))
+    {
+        m->_setSceneQueryLeaf(BoundingVolumeHierarchy::NO_LEAF);
+        if (m->isAttached())
+            _notifyMovableObjectBoundsUpdated(m);
+    }
+}
+//---------------------------------------------------------------------
+void SceneManager::untrackMovableObject(MovableObject* m)
+{
+    if (m->_getManager() != this || m->_getSceneQueryLeaf() == BoundingVolumeHierarchy::NOT_TRACKED)
+        return;
+    _notifyMovableObjectDetached(m);
+    m->_setSceneQueryLeaf(BoundingVolumeHierarchy::NOT_TRACKED);
 }
 //---------------------------------------------------------------------
 void SceneManager::extractMovableObject(const String& name, const String& typeName)
@@ -3461,6 +3577,7 @@ void SceneManager::extractMovableObject(const String& name, const String& typeNa
         if (mi != objectMap->map.end())
         {
             // no delete
+            untrackMovableObject(mi->second);
             objectMap->map.erase(mi);
         }
     }
@@ -3478,6 +3595,8 @@ void SceneManager::extractAllMovableObjectsByType(const String& typeName)
     {
             OGRE_LOCK_MUTEX(objectMap->mutex);
         // no deletion
+        for (auto& m : objectMap->map)
+            untrackMovableObject(m.second);
         objectMap->map.clear();
     }
 }
@@ -3656,6 +3775,7 @@ void SceneManager::updateGpuProgramParameters(const Pass* pass)
             {
                 mDestRenderSystem->bindGpuProgramParameters(t, pass->getGpuProgramParameters(t),
                                                             mGpuParamsDirty);
+                EngineStatistics::add(EngineStatistics::SC_AUTO_PARAM_UPLOADS);
             }
         }
     }
@@ -3665,6 +3785,7 @@ void SceneManager::updateGpuProgramParameters(const Pass* pass)
     {
         mFixedFunctionParams->_updateAutoParams(mAutoParamDataSource.get(), mGpuParamsDirty);
         mDestRenderSystem->applyFixedFunctionParams(mFixedFunctionParams, mGpuParamsDirty);
+        EngineStatistics::add(EngineStatistics::SC_AUTO_PARAM_UPLOADS);
     }
 
     mGpuParamsDirty = 0;
@@ -26,6 +26,7 @@ THE SOFTWARE.
 -----------------------------------------------------------------------------
 */
 #include "OgreStableHeaders.h"
+#include "OgreEngineStatistics.h"
 
 namespace Ogre {
     //-----------------------------------------------------------------------
@@ -230,7 +231,10 @@ namespace Ogre {
     {
         // Check self visible
         if (!cam->isVisible(mWorldAABB))
+        {
+            EngineStatistics::add(EngineStatistics::SC_CULLED_NODES);
             return;
+        }
 
         // Add all entities
         for (auto *o : mObjectsByName)
@@ -232,6 +232,59 @@ namespace Ogre {
         return mResult;
     }
     //-----------------------------------------------------------------------
+    bool RaySceneQuery::isNearerHit(MovableObject* movable, Real distance, const RaySceneQueryResultEntry& nearest)
+    {
+        if (!nearest.movable && !nearest.worldFragment)
+            return true;
+        if (distance != nearest.distance || !nearest.movable)
+            return distance < nearest.distance;
+
+        int order = movable->getMovableType().compare(nearest.movable->getMovableType());
+        return order != 0 ? order < 0 : movable->getName() < nearest.movable->getName();
+    }
+    //-----------------------------------------------------------------------
+    void RaySceneQuery::executeBatch(const Ray* rays, size_t count, RaySceneQueryResultEntry* results, bool parallel)
+    {
+        // Generic version, casting the rays one by one
+        struct NearestHitListener : public RaySceneQueryListener
+        {
+            RaySceneQueryResultEntry nearest;
+
+            bool queryResult(MovableObject* obj, Real distance) override
+            {
+                if (isNearerHit(obj, distance, nearest))
+                {
+                    nearest.distance = distance;
+                    nearest.movable = obj;
+                    nearest.worldFragment = NULL;
+                }
+                return true;
+            }
+            bool queryResult(SceneQuery::WorldFragment* fragment, Real distance) override
+            {
+                if ((!nearest.movable && !nearest.worldFragment) || distance < nearest.distance)
+                {
+                    nearest.distance = distance;
+                    nearest.movable = NULL;
+                    nearest.worldFragment = fragment;
+                }
+                return true;
+            }
+        } listener;
+
+        Ray ray = mRay;
+        for (size_t i = 0; i < count; ++i)
+        {
+            listener.nearest.distance = 0;
+            listener.nearest.movable = NULL;
+            listener.nearest.worldFragment = NULL;
+            mRay = rays[i];
+            execute(&listener);
+            results[i] = listener.nearest;
+        }
+        mRay = ray;
+    }
+    //-----------------------------------------------------------------------
     const RaySceneQueryResult& RaySceneQuery::getLastResults(void) const
     {
         return mResult;
@@ -29,6 +29,8 @@ THE SOFTWARE.
 #include "OgreStaticGeometry.h"
 #include "OgreEdgeListBuilder.h"
 #include "OgreLodStrategy.h"
+#include "OgreDefaultHardwareBufferManager.h"
+#include "OgreStaticGeometrySerializer.h"
 
 namespace Ogre {
 
@@ -37,6 +39,59 @@ namespace Ogre {
     #define REGION_MAX_INDEX 511
     #define REGION_MIN_INDEX -512
 
+    struct StaticGeometry::BuildJob
+    {
+        std::vector<Region*> regions;
+        SourceBufferMap srcBuffers;
+        bool stencilShadows = false;
+        std::atomic<size_t> numPrepared{0};
+        std::atomic<bool> cancelled{false};
+        /// set once a background build is done accessing the regions
+        bool prepared = false;
+        std::exception_ptr error;
+        OGRE_WQ_MUTEX(mutex);
+        OGRE_WQ_THREAD_SYNCHRONISER(preparedSync);
+    };
+
+    struct StaticGeometry::StreamSource
+    {
+        DataStreamPtr stream;
+        /// knows the endianness of the stream
+        SharedPtr<StaticGeometrySerializer> serializer;
+        /// set once the regions are destroyed, pending requests are dropped then
+        bool closed = false;
+        OGRE_WQ_MUTEX(mutex);
+    };
+
+    /// Read access to a source buffer, using its copy for parallel builds
+    struct SourceBufferReader
+    {
+        HardwareBufferLockGuard lock;
+        const uchar* pData;
+
+        SourceBufferReader(const StaticGeometry::SourceBufferMap& srcBuffers, HardwareBuffer* buf,
+                           size_t offset, size_t length)
+        {
+            auto it = srcBuffers.find(buf);
+            if (it != srcBuffers.end())
+            {
+                pData = it->second.data() + offset;
+                return;
+            }
+            lock.lock(buf, offset, length, HardwareBuffer::HBL_READ_ONLY);
+            pData = static_cast<const uchar*>(lock.pData);
+        }
+    };
+
+    static void copySourceBuffer(StaticGeometry::SourceBufferMap& srcBuffers, HardwareBuffer* buf)
+    {
+        if (srcBuffers.count(buf))
+            return;
+        auto& data = srcBuffers[buf];
+        data.resize(buf->getSizeInBytes());
+        buf->readData(0, data.size(), data.data());
+    }
+
     //--------------------------------------------------------------------------
     StaticGeometry::StaticGeometry(SceneManager* owner, const String& name):
         mOwner(owner),
@@ -50,7 +105,10 @@ namespace Ogre {
         mVisible(true),
         mRenderQueueID(RENDER_QUEUE_MAIN),
         mRenderQueueIDSet(false),
-        mVisibilityFlags(Ogre::MovableObject::getDefaultVisibilityFlags())
+        mVisibilityFlags(Ogre::MovableObject::getDefaultVisibilityFlags()),
+        mListener(0),
+        mParallelBuild(false),
+        mStreamingDistance(0)
     {
     }
     //--------------------------------------------------------------------------
@@ -150,24 +208,29 @@ namespace Ogre {
         Region* ret = getRegion(index);
         if (!ret && autoCreate)
         {
-            // Make a name
-            StringStream str;
-            str << mName << ":" << index;
             // Calculate the region centre
-            Vector3 centre = getRegionCentre(x, y, z);
-            ret = OGRE_NEW Region(this, str.str(), mOwner, index, centre);
-            mOwner->injectMovableObject(ret);
-            ret->setVisible(mVisible);
-            ret->setCastShadows(mCastShadows);
-            if (mRenderQueueIDSet)
-            {
-                ret->setRenderQueueGroup(mRenderQueueID);
-            }
-            mRegionMap[index] = ret;
+            ret = createRegion(index, getRegionCentre(x, y, z));
         }
         return ret;
     }
     //--------------------------------------------------------------------------
+    StaticGeometry::Region* StaticGeometry::createRegion(uint32 index, const Vector3& centre)
+    {
+        // Make a name
+        StringStream str;
+        str << mName << ":" << index;
+        Region* ret = OGRE_NEW Region(this, str.str(), mOwner, index, centre);
+        mOwner->injectMovableObject(ret);
+        ret->setVisible(mVisible);
+        ret->setCastShadows(mCastShadows);
+        if (mRenderQueueIDSet)
+        {
+            ret->setRenderQueueGroup(mRenderQueueID);
+        }
+        mRegionMap[index] = ret;
+        return ret;
+    }
+    //--------------------------------------------------------------------------
     StaticGeometry::Region* StaticGeometry::getRegion(uint32 index)
     {
         RegionMap::iterator i = mRegionMap.find(index);
@@ -512,7 +575,7 @@ namespace Ogre {
         }
     }
     //--------------------------------------------------------------------------
-    void StaticGeometry::build(void)
+    SharedPtr<StaticGeometry::BuildJob> StaticGeometry::startBuild(bool parallel)
     {
         // Make sure there's nothing from previous builds
         destroy();
@@ -523,25 +586,239 @@ namespace Ogre {
             Region* region = getRegion(qsm->worldBounds, true);
             region->assign(qsm);
         }
-        bool stencilShadows = false;
+
+        auto job = std::make_shared<BuildJob>();
         if (mCastShadows && mOwner->isShadowTechniqueStencilBased())
         {
-            stencilShadows = true;
+            job->stencilShadows = true;
         }
 
-        // Now tell each region to build itself
+        // The bucket structure uses the HardwareBufferManager, so set it up here
         for (auto & ri : mRegionMap)
         {
-            ri.second->build(stencilShadows);
-            
+            ri.second->_assignLods();
+            job->regions.push_back(ri.second);
+        }
+
+        if (parallel)
+        {
+            // Locking is not thread-safe, so the worker threads read from copies
+            for (auto & l : mSubMeshGeometryLookup)
+            {
+                for (auto & geom : *l.second)
+                {
+                    copySourceBuffer(job->srcBuffers, geom.indexData->indexBuffer.get());
+                    for (auto & b : geom.vertexData->vertexBufferBinding->getBindings())
+                        copySourceBuffer(job->srcBuffers, b.second.get());
+                }
+            }
+        }
+
+        return job;
+    }
+    //--------------------------------------------------------------------------
+    void StaticGeometry::prepareRegion(BuildJob& job, Region* region)
+    {
+        region->_fillBuffers(job.stencilShadows, job.srcBuffers);
+
+        size_t numPrepared = ++job.numPrepared;
+        if (mListener)
+            mListener->regionPrepared(this, numPrepared, job.regions.size());
+    }
+    //--------------------------------------------------------------------------
+    void StaticGeometry::prepareRegions(BuildJob& job)
+    {
+        Root::getSingleton().getWorkQueue()->parallelFor(
+            0, job.regions.size(),
+            [this, &job](size_t begin, size_t end)
+            {
+                for (size_t i = begin; i < end && !job.cancelled; ++i)
+                    prepareRegion(job, job.regions[i]);
+            });
+    }
+    //--------------------------------------------------------------------------
+    void StaticGeometry::build(void)
+    {
+        auto job = startBuild(mParallelBuild);
+
+        if (mParallelBuild)
+            prepareRegions(*job);
+
+        // Now tell each region to build itself
+        for (auto region : job->regions)
+        {
+            if (!mParallelBuild)
+                prepareRegion(*job, region);
+
+            region->_uploadBuffers(job->stencilShadows);
+
             // Set the visibility flags on these regions
-            ri.second->setVisibilityFlags(mVisibilityFlags);
+            region->setVisibilityFlags(mVisibilityFlags);
         }
 
+        if (mListener)
+            mListener->buildFinished(this);
+    }
+    //--------------------------------------------------------------------------
+    void StaticGeometry::buildInBackground(void)
+    {
+        WorkQueue* wq = Root::getSingleton().getWorkQueue();
+        if (!wq->getRequestsAccepted())
+        {
+            build();
+            return;
+        }
+
+        auto job = startBuild(true);
+        mBuildJob = job;
+
+        wq->addTask(
+            [this, job, wq]()
+            {
+                try
+                {
+                    prepareRegions(*job);
+                }
+                catch (...)
+                {
+                    job->error = std::current_exception();
+                }
+
+                // Hardware buffers must be created on the main thread, one region per task
+                // so processMainThreadTasks can spread them over several frames
+                for (auto region : job->regions)
+                {
+                    wq->addMainThreadTask(
+                        [this, job, region]()
+                        {
+                            if (job->cancelled || job->error)
+                                return;
+                            region->_uploadBuffers(job->stencilShadows);
+                            region->setVisibilityFlags(mVisibilityFlags);
+                        });
+                }
+                wq->addMainThreadTask(
+                    [this, job]()
+                    {
+                        if (job->cancelled)
+                            return;
+                        mBuildJob.reset();
+                        if (job->error)
+                        {
+                            destroy();
+                            std::rethrow_exception(job->error);
+                        }
+                        if (mListener)
+                            mListener->buildFinished(this);
+                    });
+
+                OGRE_WQ_LOCK_MUTEX(job->mutex);
+                job->prepared = true;
+                OGRE_THREAD_NOTIFY_ALL(job->preparedSync);
+            });
+    }
+    //--------------------------------------------------------------------------
+    void StaticGeometry::setStreamSource(const DataStreamPtr& stream,
+                                         const SharedPtr<StaticGeometrySerializer>& serializer)
+    {
+        mStreamSource = std::make_shared<StreamSource>();
+        mStreamSource->stream = stream;
+        mStreamSource->serializer = serializer;
+    }
+    //--------------------------------------------------------------------------
+    void StaticGeometry::requestRegionStreaming(Region* region, bool load)
+    {
+        region->mStreamRequestPending = true;
+
+        // the region might be destroyed in the meantime, so look it up again by ID
+        auto source = mStreamSource;
+        uint32 regionID = region->getID();
+        WorkQueue* wq = Root::getSingleton().getWorkQueue();
+
+        if (!load)
+        {
+            // defer unloading, as the renderables might still be queued
+            wq->addMainThreadTask(
+                [this, source, regionID]()
+                {
+                    Region* r = source->closed ? 0 : getRegion(regionID);
+                    if (!r)
+                        return;
+                    r->mStreamRequestPending = false;
+                    if (Root::getSingleton().getNextFrameNumber() - r->mLastStreamFrame > 1)
+                        r->_unloadGeometry();
+                });
+            return;
+        }
+
+        size_t offset = region->mStreamOffset;
+        size_t length = region->mStreamLength;
+        wq->addTask(
+            [this, source, regionID, offset, length, wq]()
+            {
+                // only read the data here, buffers must be created on the main thread
+                auto data = std::make_shared<MemoryDataStream>(length);
+                String error;
+                try
+                {
+                    OGRE_WQ_LOCK_MUTEX(source->mutex);
+                    source->stream->seek(offset);
+                    if (source->stream->read(data->getPtr(), length) != length)
+                        error = "unexpected end of stream";
+                }
+                catch (const std::exception& e)
+                {
+                    error = e.what();
+                }
+
+                wq->addMainThreadTask(
+                    [this, source, regionID, data, error]()
+                    {
+                        Region* r = source->closed ? 0 : getRegion(regionID);
+                        if (!r)
+                            return;
+                        r->mStreamRequestPending = false;
+                        if (!error.empty())
+                        {
+                            // do not try again
+                            r->mStreamLength = 0;
+                            LogManager::getSingleton().logError("StaticGeometry - failed to load region " +
+                                                                r->getName() + ": " + error);
+                            return;
+                        }
+                        if (!r->isLoaded())
+                            source->serializer->importRegion(data, r);
+                    });
+            });
+    }
+    //--------------------------------------------------------------------------
+    void StaticGeometry::cancelBuild()
+    {
+        if (!mBuildJob)
+            return;
+
+        mBuildJob->cancelled = true;
+#if OGRE_THREAD_SUPPORT
+        {
+            // the worker threads might still access the regions
+            OGRE_WQ_LOCK_MUTEX_NAMED(mBuildJob->mutex, lock);
+            while (!mBuildJob->prepared)
+                OGRE_THREAD_WAIT(mBuildJob->preparedSync, mBuildJob->mutex, lock);
+        }
+#endif
+        mBuildJob.reset();
     }
     //--------------------------------------------------------------------------
     void StaticGeometry::destroy(void)
     {
+        cancelBuild();
+
+        if (mStreamSource)
+        {
+            mStreamSource->closed = true;
+            mStreamSource.reset();
+        }
+
         // delete the regions
         for (auto & i : mRegionMap)
         {
@@ -672,7 +949,8 @@ namespace Ogre {
         SceneManager* mgr, uint32 regionID, const Vector3& centre)
         : MovableObject(name), mParent(parent),
         mRegionID(regionID), mCentre(centre), mBoundingRadius(0.0f),
-        mCurrentLod(0), mLodStrategy(0), mCamera(0), mSquaredViewDepth(0)
+        mCurrentLod(0), mLodStrategy(0), mCamera(0), mSquaredViewDepth(0),
+        mStreamOffset(0), mStreamLength(0), mStreamRequestPending(false), mLastStreamFrame(0)
     {
         mManager = mgr;
     }
@@ -695,6 +973,16 @@ namespace Ogre {
 
     }
     //-----------------------------------------------------------------------
+    void StaticGeometry::Region::_unloadGeometry()
+    {
+        for (auto & i : mLodBucketList)
+        {
+            OGRE_DELETE i;
+        }
+        mLodBucketList.clear();
+        mCurrentLod = 0;
+    }
+    //-----------------------------------------------------------------------
     void StaticGeometry::Region::_releaseManualHardwareResources()
     {
         for (auto & i : mLodBucketList)
@@ -762,8 +1050,13 @@ namespace Ogre {
     //--------------------------------------------------------------------------
     void StaticGeometry::Region::build(bool stencilShadows)
     {
-        // Create a node
-        mManager->getRootSceneNode()->createChildSceneNode(mCentre)->attachObject(this);
+        _assignLods();
+        _fillBuffers(stencilShadows, SourceBufferMap());
+        _uploadBuffers(stencilShadows);
+    }
+    //--------------------------------------------------------------------------
+    void StaticGeometry::Region::_assignLods()
+    {
         // We need to create enough LOD buckets to deal with the highest LOD
         // we encountered in all the meshes queued
         for (ushort lod = 0; lod < mLodValues.size(); ++lod)
@@ -779,12 +1072,41 @@ namespace Ogre {
             {
                 lodBucket->assign(*qi, lod);
             }
-            // now build
-            lodBucket->build(stencilShadows);
+        }
+    }
+    //--------------------------------------------------------------------------
+    void StaticGeometry::Region::_fillBuffers(bool stencilShadows, const SourceBufferMap& srcBuffers)
+    {
+        // LODs share the source buffers, but not the merged ones
+        for (auto lodBucket : mLodBucketList)
+        {
+            lodBucket->_fillBuffers(false, srcBuffers);
         }
 
+        if (!stencilShadows)
+            return;
 
+        // the merged buffers are in system memory, so the edge lists can be built in parallel
+        auto buildEdgeLists = [this](size_t first, size_t last) {
+            for (size_t i = first; i < last; ++i)
+                mLodBucketList[i]->_buildEdgeList();
+        };
+        if (Root* root = Root::getSingletonPtr())
+            root->getWorkQueue()->parallelFor(0, mLodBucketList.size(), buildEdgeLists, 1);
+        else
+            buildEdgeLists(0, mLodBucketList.size());
+    }
+    //--------------------------------------------------------------------------
+    void StaticGeometry::Region::_uploadBuffers(bool stencilShadows)
+    {
+        // Create a node, streamed regions already have one
+        if (!mParentNode)
+            mManager->getRootSceneNode()->createChildSceneNode(mCentre)->attachObject(this);
 
+        for (auto lodBucket : mLodBucketList)
+        {
+            lodBucket->_uploadBuffers(stencilShadows);
+        }
     }
     //--------------------------------------------------------------------------
     const String& StaticGeometry::Region::getMovableType(void) const
@@ -800,6 +1122,22 @@ namespace Ogre {
         // Cache squared view depth for use by GeometryBucket
         mSquaredViewDepth = mParentNode->getSquaredViewDepth(cam->getLodCamera());
 
+        if (isStreamed())
+        {
+            unsigned long frame = Root::getSingleton().getNextFrameNumber();
+            Real streamingDist = mParent->getStreamingDistance();
+            if (streamingDist <= 0 || mSquaredViewDepth <= Math::Sqr(streamingDist + mBoundingRadius))
+                mLastStreamFrame = frame;
+
+            // only unload if no camera needed the region this or the last frame
+            bool needed = frame - mLastStreamFrame <= 1;
+            if (!mStreamRequestPending && needed != isLoaded())
+                mParent->requestRegionStreaming(this, needed);
+
+            if (!isLoaded())
+                return;
+        }
+
         // No LOD strategy set yet, skip (this indicates that there are no submeshes)
         if (mLodStrategy == 0)
             return;
@@ -860,7 +1198,7 @@ namespace Ogre {
     //--------------------------------------------------------------------------
     bool StaticGeometry::Region::isVisible(void) const
     {
-        if(!mVisible || mBeyondFarDistance)
+        if(!mVisible || mBeyondFarDistance || !isLoaded())
             return false;
 
         SceneManager* sm = Root::getSingleton()._getCurrentSceneManager();
@@ -906,6 +1244,8 @@ namespace Ogre {
     //--------------------------------------------------------------------------
     EdgeData* StaticGeometry::Region::getEdgeList(void)
     {
+        if (!isLoaded())
+            return 0;
         return mLodBucketList[mCurrentLod]->getEdgeList();
     }
     //--------------------------------------------------------------------------
@@ -989,16 +1329,56 @@ namespace Ogre {
     //--------------------------------------------------------------------------
     void StaticGeometry::LODBucket::build(bool stencilShadows)
     {
+        _fillBuffers(stencilShadows, SourceBufferMap());
+        _uploadBuffers(stencilShadows);
+    }
+    //--------------------------------------------------------------------------
+    void StaticGeometry::LODBucket::_fillBuffers(bool stencilShadows, const SourceBufferMap& srcBuffers)
+    {
+        // Just pass this on to child buckets
+        for (auto & i : mMaterialBucketMap)
+        {
+            i.second->_fillBuffers(stencilShadows, srcBuffers);
+        }
 
+        if (stencilShadows)
+        {
+            _buildEdgeList();
+        }
+    }
+    //--------------------------------------------------------------------------
+    void StaticGeometry::LODBucket::_buildEdgeList()
+    {
         EdgeListBuilder eb;
         size_t vertexSet = 0;
 
-        // Just pass this on to child buckets
+        for (auto & i : mMaterialBucketMap)
+        {
+            for (GeometryBucket* geom : i.second->getGeometryList())
+            {
+                // Check we're dealing with 16-bit indexes here
+                // Since stencil shadows can only deal with 16-bit
+                // More than that and stencil is probably too CPU-heavy
+                // in any case
+                assert(geom->getIndexData()->indexBuffer->getType()
+                    == HardwareIndexBuffer::IT_16BIT &&
+                    "Only 16-bit indexes allowed when using stencil shadows");
+                eb.addVertexData(geom->getVertexData());
+                eb.addIndexData(geom->getIndexData(), vertexSet++);
+            }
+        }
+
+        OGRE_DELETE mEdgeList;
+        mEdgeList = eb.build();
+    }
+    //--------------------------------------------------------------------------
+    void StaticGeometry::LODBucket::_uploadBuffers(bool stencilShadows)
+    {
         for (auto & i : mMaterialBucketMap)
         {
             MaterialBucket* mat = i.second;
 
-            mat->build(stencilShadows);
+            mat->_uploadBuffers(stencilShadows);
 
             if (stencilShadows)
             {
@@ -1015,27 +1395,8 @@ namespace Ogre {
                         }
                     }
                 }
-
-                for (GeometryBucket* geom : mat->getGeometryList())
-                {
-                    // Check we're dealing with 16-bit indexes here
-                    // Since stencil shadows can only deal with 16-bit
-                    // More than that and stencil is probably too CPU-heavy
-                    // in any case
-                    assert(geom->getIndexData()->indexBuffer->getType()
-                        == HardwareIndexBuffer::IT_16BIT &&
-                        "Only 16-bit indexes allowed when using stencil shadows");
-                    eb.addVertexData(geom->getVertexData());
-                    eb.addIndexData(geom->getIndexData(), vertexSet++);
-                }
-
             }
         }
-
-        if (stencilShadows)
-        {
-            mEdgeList = eb.build();
-        }
     }
     //--------------------------------------------------------------------------
     void StaticGeometry::LODBucket::addRenderables(RenderQueue* queue,
@@ -1200,13 +1561,27 @@ namespace Ogre {
     }
     //--------------------------------------------------------------------------
     void StaticGeometry::MaterialBucket::build(bool stencilShadows)
+    {
+        _fillBuffers(stencilShadows, SourceBufferMap());
+        _uploadBuffers(stencilShadows);
+    }
+    //--------------------------------------------------------------------------
+    void StaticGeometry::MaterialBucket::_fillBuffers(bool stencilShadows, const SourceBufferMap& srcBuffers)
+    {
+        // tell the geometry buckets to build
+        for (auto gb : mGeometryBucketList)
+        {
+            gb->_fillBuffers(stencilShadows, srcBuffers);
+        }
+    }
+    //--------------------------------------------------------------------------
+    void StaticGeometry::MaterialBucket::_uploadBuffers(bool stencilShadows)
     {
         mTechnique = 0;
         mMaterial->load();
-        // tell the geometry buckets to build
         for (auto gb : mGeometryBucketList)
         {
-            gb->build(stencilShadows);
+            gb->_uploadBuffers(stencilShadows);
         }
     }
     //--------------------------------------------------------------------------
@@ -1326,6 +1701,11 @@ namespace Ogre {
         OGRE_DELETE mIndexData;
     }
     //--------------------------------------------------------------------------
+    StaticGeometry::GeometryBucket::GeometryBucket(MaterialBucket* parent)
+        : Renderable(), mParent(parent), mVertexData(0), mIndexData(0), mMaxVertexIndex(0)
+    {
+    }
+    //--------------------------------------------------------------------------
     const MaterialPtr& StaticGeometry::GeometryBucket::getMaterial(void) const
     {
         return mParent->getMaterial();
@@ -1405,6 +1785,12 @@ namespace Ogre {
         }
     }
     void StaticGeometry::GeometryBucket::build(bool stencilShadows)
+    {
+        _fillBuffers(stencilShadows, SourceBufferMap());
+        _uploadBuffers(stencilShadows);
+    }
+    //--------------------------------------------------------------------------
+    void StaticGeometry::GeometryBucket::_fillBuffers(bool stencilShadows, const SourceBufferMap& srcBuffers)
     {
         // Need to double the vertex count for the position buffer
         // if we're doing stencil shadows
@@ -1418,11 +1804,12 @@ namespace Ogre {
         VertexDeclaration* dcl = mVertexData->vertexDeclaration;
         VertexBufferBinding* binds = mVertexData->vertexBufferBinding;
 
-        // create index buffer, and lock
+        // create system memory index buffer, and lock
+        // these are created directly, as the HardwareBufferManager is not thread-safe
         auto indexType = mIndexData->indexBuffer->getType();
-        mIndexData->indexBuffer = HardwareBufferManager::getSingleton()
-            .createIndexBuffer(indexType, mIndexData->indexCount,
-                HardwareBuffer::HBU_STATIC_WRITE_ONLY);
+        mIndexData->indexBuffer = std::make_shared<HardwareIndexBuffer>(
+            nullptr, indexType, mIndexData->indexCount,
+            new DefaultHardwareBuffer(HardwareIndexBuffer::indexSize(indexType) * mIndexData->indexCount));
         HardwareBufferLockGuard dstIndexLock(mIndexData->indexBuffer, HardwareBuffer::HBL_DISCARD);
         uint32* p32Dest = static_cast<uint32*>(dstIndexLock.pData);
         uint16* p16Dest = static_cast<uint16*>(dstIndexLock.pData);
@@ -1433,11 +1820,10 @@ namespace Ogre {
         std::vector<VertexDeclaration::VertexElementList> bufferElements;
         for (b = 0; b < binds->getBufferCount(); ++b)
         {
-            HardwareVertexBufferSharedPtr vbuf =
-                HardwareBufferManager::getSingleton().createVertexBuffer(
-                    dcl->getVertexSize(b),
-                    mVertexData->vertexCount,
-                    HardwareBuffer::HBU_STATIC_WRITE_ONLY);
+            size_t vertexSize = dcl->getVertexSize(b);
+            auto vbuf = std::make_shared<HardwareVertexBuffer>(
+                nullptr, vertexSize, mVertexData->vertexCount,
+                new DefaultHardwareBuffer(vertexSize * mVertexData->vertexCount));
             binds->setBinding(b, vbuf);
             uchar* pLock = static_cast<uchar*>(
                 vbuf->lock(HardwareBuffer::HBL_DISCARD));
@@ -1457,24 +1843,23 @@ namespace Ogre {
             QueuedGeometry* geom = *gi;
             // Copy indexes across with offset
             IndexData* srcIdxData = geom->geometry->indexData;
-            HardwareBufferLockGuard srcIdxLock(srcIdxData->indexBuffer,
-                                               srcIdxData->indexStart * srcIdxData->indexBuffer->getIndexSize(), 
-                                               srcIdxData->indexCount * srcIdxData->indexBuffer->getIndexSize(),
-                                               HardwareBuffer::HBL_READ_ONLY);
-            if (indexType == HardwareIndexBuffer::IT_32BIT)
-            {
-                uint32* pSrc = static_cast<uint32*>(srcIdxLock.pData);
-                copyIndexes(pSrc, p32Dest, srcIdxData->indexCount, indexOffset);
-                p32Dest += srcIdxData->indexCount;
-            }
-            else
             {
-                // Lock source indexes
-                uint16* pSrc = static_cast<uint16*>(srcIdxLock.pData);
-                copyIndexes(pSrc, p16Dest, srcIdxData->indexCount, indexOffset);
-                p16Dest += srcIdxData->indexCount;
+                SourceBufferReader srcIdx(srcBuffers, srcIdxData->indexBuffer.get(),
+                                          srcIdxData->indexStart * srcIdxData->indexBuffer->getIndexSize(),
+                                          srcIdxData->indexCount * srcIdxData->indexBuffer->getIndexSize());
+                if (indexType == HardwareIndexBuffer::IT_32BIT)
+                {
+                    auto pSrc = reinterpret_cast<const uint32*>(srcIdx.pData);
+                    copyIndexes(pSrc, p32Dest, srcIdxData->indexCount, indexOffset);
+                    p32Dest += srcIdxData->indexCount;
+                }
+                else
+                {
+                    auto pSrc = reinterpret_cast<const uint16*>(srcIdx.pData);
+                    copyIndexes(pSrc, p16Dest, srcIdxData->indexCount, indexOffset);
+                    p16Dest += srcIdxData->indexCount;
+                }
             }
-            srcIdxLock.unlock();
 
             // Now deal with vertex buffers
             // we can rely on buffer counts / formats being the same
@@ -1484,14 +1869,15 @@ namespace Ogre {
             {
                 // lock source
                 HardwareVertexBufferSharedPtr srcBuf = srcBinds->getBuffer(b);
-                HardwareBufferLockGuard srcBufLock(srcBuf, HardwareBuffer::HBL_READ_ONLY);
-                uchar* pSrcBase = static_cast<uchar*>(srcBufLock.pData);
+                SourceBufferReader srcBufReader(srcBuffers, srcBuf.get(), 0, srcBuf->getSizeInBytes());
+                const uchar* pSrcBase = srcBufReader.pData;
                 // Get buffer lock pointer, we'll update this later
                 uchar* pDstBase = destBufferLocks[b];
                 size_t bufInc = srcBuf->getVertexSize();
 
                 // Iterate over vertices
-                float *pSrcReal, *pDstReal;
+                const float* pSrcReal;
+                float* pDstReal;
                 Vector3 tmp;
                 for (size_t v = 0; v < srcVData->vertexCount; ++v)
                 {
@@ -1502,7 +1888,7 @@ namespace Ogre {
                     for (ei = elems.begin(); ei != elems.end(); ++ei)
                     {
                         VertexElement& elem = *ei;
-                        elem.baseVertexPointerToElement(pSrcBase, &pSrcReal);
+                        pSrcReal = reinterpret_cast<const float*>(pSrcBase + elem.getOffset());
                         elem.baseVertexPointerToElement(pDstBase, &pDstReal);
                         switch (elem.getSemantic())
                         {
@@ -1565,6 +1951,26 @@ namespace Ogre {
         {
             binds->getBuffer(b)->unlock();
         }
+    }
+    //--------------------------------------------------------------------------
+    void StaticGeometry::GeometryBucket::_uploadBuffers(bool stencilShadows)
+    {
+        // Replace the system memory buffers by hardware buffers
+        HardwareBufferManager& mgr = HardwareBufferManager::getSingleton();
+        HardwareIndexBufferSharedPtr srcIndexBuffer = mIndexData->indexBuffer;
+        mIndexData->indexBuffer = mgr.createIndexBuffer(
+            srcIndexBuffer->getType(), srcIndexBuffer->getNumIndexes(), HardwareBuffer::HBU_STATIC_WRITE_ONLY);
+        mIndexData->indexBuffer->copyData(*srcIndexBuffer);
+
+        VertexBufferBinding* binds = mVertexData->vertexBufferBinding;
+        for (ushort b = 0; b < binds->getBufferCount(); ++b)
+        {
+            HardwareVertexBufferSharedPtr srcBuf = binds->getBuffer(b);
+            HardwareVertexBufferSharedPtr vbuf = mgr.createVertexBuffer(
+                srcBuf->getVertexSize(), srcBuf->getNumVertices(), HardwareBuffer::HBU_STATIC_WRITE_ONLY);
+            vbuf->copyData(*srcBuf);
+            binds->setBinding(b, vbuf);
+        }
 
         if (stencilShadows)
         {
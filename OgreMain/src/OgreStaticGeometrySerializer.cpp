@@ -0,0 +1,537 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "OgreStableHeaders.h"
+#include "OgreStaticGeometrySerializer.h"
+#include "OgreDefaultHardwareBufferManager.h"
+#include "OgreLodStrategy.h"
+#include "OgreLodStrategyManager.h"
+
+namespace Ogre {
+
+    /// stream overhead = ID + size
+    const size_t SGSTREAM_OVERHEAD_SIZE = sizeof(uint16) + sizeof(uint32);
+    //---------------------------------------------------------------------
+    StaticGeometrySerializer::StaticGeometrySerializer()
+    {
+        mVersion = "[StaticGeometrySerializer_v1.00]";
+    }
+    //---------------------------------------------------------------------
+    void StaticGeometrySerializer::exportStaticGeometry(const StaticGeometry* geom, const String& filename,
+                                                        Endian endianMode)
+    {
+        DataStreamPtr stream = _openFileStream(filename, std::ios::binary | std::ios::out);
+        exportStaticGeometry(geom, stream, endianMode);
+
+        stream->close();
+    }
+    //---------------------------------------------------------------------
+    void StaticGeometrySerializer::exportStaticGeometry(const StaticGeometry* geom, const DataStreamPtr& stream,
+                                                        Endian endianMode)
+    {
+        // Decide on endian mode
+        determineEndianness(endianMode);
+
+        mStream = stream;
+        if (!stream->isWriteable())
+        {
+            OGRE_EXCEPT(Exception::ERR_CANNOT_WRITE_TO_FILE, "Unable to write to stream " + stream->getName());
+        }
+
+        writeFileHeader();
+
+        pushInnerChunk(mStream);
+        writeSettings(geom);
+        for (const auto& r : geom->getRegions())
+        {
+            writeRegion(r.second);
+        }
+        popInnerChunk(mStream);
+
+        mStream.reset();
+    }
+    //---------------------------------------------------------------------
+    void StaticGeometrySerializer::importStaticGeometry(const DataStreamPtr& stream, StaticGeometry* dest,
+                                                        bool streamRegions)
+    {
+        // Determine endianness (must be the first thing we do!)
+        determineEndianness(stream);
+        readFileHeader(stream);
+
+        // Make sure there's nothing from previous builds
+        dest->destroy();
+
+        pushInnerChunk(stream);
+        unsigned short streamID = stream->eof() ? 0 : readChunk(stream);
+        while (!stream->eof())
+        {
+            switch (streamID)
+            {
+            case SG_SETTINGS:
+                readSettings(stream, dest);
+                break;
+            case SG_REGION:
+            {
+                size_t regionEnd = stream->tell() - SGSTREAM_OVERHEAD_SIZE + mCurrentstreamLen;
+                StaticGeometry::Region* region = readRegionHeader(stream, dest);
+                if (streamRegions)
+                {
+                    // Remember where the geometry is and skip it for now
+                    region->mStreamOffset = stream->tell();
+                    region->mStreamLength = regionEnd - region->mStreamOffset;
+                    stream->seek(regionEnd);
+
+                    // Attach, so the region gets notified about cameras
+                    dest->mOwner->getRootSceneNode()->createChildSceneNode(region->getCentre())->attachObject(region);
+                    region->setVisibilityFlags(dest->mVisibilityFlags);
+                }
+                else
+                {
+                    importRegion(stream, region);
+                }
+                break;
+            }
+            default:
+                break;
+            }
+
+            if (!stream->eof())
+            {
+                streamID = readChunk(stream);
+            }
+        }
+        popInnerChunk(stream);
+
+        if (streamRegions)
+        {
+            dest->setStreamSource(stream, std::make_shared<StaticGeometrySerializer>(*this));
+        }
+    }
+    //---------------------------------------------------------------------
+    void StaticGeometrySerializer::importRegion(const DataStreamPtr& stream, StaticGeometry::Region* region)
+    {
+        pushInnerChunk(stream);
+        if (!stream->eof())
+        {
+            unsigned short streamID = readChunk(stream);
+            while (!stream->eof() && streamID == SG_LOD)
+            {
+                readLod(stream, region);
+                if (!stream->eof())
+                {
+                    streamID = readChunk(stream);
+                }
+            }
+            if (!stream->eof())
+            {
+                // Backpedal back to start of non-LOD chunk
+                backpedalChunkHeader(stream);
+            }
+        }
+        popInnerChunk(stream);
+
+        StaticGeometry* geom = region->getParent();
+        bool stencilShadows = geom->mCastShadows && geom->mOwner->isShadowTechniqueStencilBased();
+
+        // The geometry is in system memory, like after merging it during a build
+        if (stencilShadows)
+        {
+            for (auto lod : region->getLODBuckets())
+                lod->_buildEdgeList();
+        }
+        region->_uploadBuffers(stencilShadows);
+        region->setVisibilityFlags(geom->mVisibilityFlags);
+    }
+    //---------------------------------------------------------------------
+    void StaticGeometrySerializer::writeSettings(const StaticGeometry* geom)
+    {
+        writeChunkHeader(SG_SETTINGS, SGSTREAM_OVERHEAD_SIZE + sizeof(float) * 7 + sizeof(bool));
+        writeObject(geom->getRegionDimensions());
+        writeObject(geom->getOrigin());
+        float dist = geom->getRenderingDistance();
+        writeFloats(&dist, 1);
+        writeBools(&geom->mCastShadows, 1);
+    }
+    //---------------------------------------------------------------------
+    void StaticGeometrySerializer::writeRegion(const StaticGeometry::Region* region)
+    {
+        OgreAssert(region->isLoaded(), "geometry of streamed region must be loaded");
+
+        writeChunkHeader(SG_REGION, calcRegionSize(region));
+
+        uint32 id = region->getID();
+        writeInts(&id, 1);
+        writeObject(region->getCentre());
+        writeObject(region->getBoundingBox().getMinimum());
+        writeObject(region->getBoundingBox().getMaximum());
+        float radius = region->getBoundingRadius();
+        writeFloats(&radius, 1);
+        writeString(region->mLodStrategy->getName());
+        uint16 numLodValues = static_cast<uint16>(region->mLodValues.size());
+        writeShorts(&numLodValues, 1);
+        writeFloats(region->mLodValues.data(), numLodValues);
+
+        for (auto lod : region->getLODBuckets())
+        {
+            writeLod(lod);
+        }
+    }
+    //---------------------------------------------------------------------
+    void StaticGeometrySerializer::writeLod(StaticGeometry::LODBucket* lod)
+    {
+        writeChunkHeader(SG_LOD, calcLodSize(lod));
+
+        uint16 index = lod->getLod();
+        writeShorts(&index, 1);
+        float lodValue = lod->getLodValue();
+        writeFloats(&lodValue, 1);
+
+        for (const auto& m : lod->getMaterialBuckets())
+        {
+            writeMaterial(m.second);
+        }
+    }
+    //---------------------------------------------------------------------
+    void StaticGeometrySerializer::writeMaterial(StaticGeometry::MaterialBucket* mat)
+    {
+        writeChunkHeader(SG_MATERIAL, calcMaterialSize(mat));
+
+        writeString(mat->getMaterial()->getName());
+        writeString(mat->getMaterial()->getGroup());
+
+        for (auto geom : mat->getGeometryList())
+        {
+            writeGeometry(geom);
+        }
+    }
+    //---------------------------------------------------------------------
+    void StaticGeometrySerializer::writeGeometry(const StaticGeometry::GeometryBucket* geom)
+    {
+        writeChunkHeader(SG_GEOMETRY, calcGeometrySize(geom));
+
+        const VertexData* vertexData = geom->getVertexData();
+        const IndexData* indexData = geom->getIndexData();
+
+        uint32 vertexCount = static_cast<uint32>(vertexData->vertexCount);
+        writeInts(&vertexCount, 1);
+        bool idx32bit = indexData->indexBuffer->getType() == HardwareIndexBuffer::IT_32BIT;
+        writeBools(&idx32bit, 1);
+        uint32 indexCount = static_cast<uint32>(indexData->indexCount);
+        writeInts(&indexCount, 1);
+
+        HardwareBufferLockGuard indexLock(indexData->indexBuffer, HardwareBuffer::HBL_READ_ONLY);
+        if (idx32bit)
+            writeInts(static_cast<const uint32*>(indexLock.pData), indexCount);
+        else
+            writeShorts(static_cast<const uint16*>(indexLock.pData), indexCount);
+        indexLock.unlock();
+
+        for (const auto& elem : vertexData->vertexDeclaration->getElements())
+        {
+            writeChunkHeader(SG_GEOMETRY_VERTEX_ELEMENT, SGSTREAM_OVERHEAD_SIZE + sizeof(uint16) * 5);
+            uint16 data[5] = {elem.getSource(), uint16(elem.getType()), uint16(elem.getSemantic()),
+                              uint16(elem.getOffset()), elem.getIndex()};
+            writeShorts(data, 5);
+        }
+
+        // the buffers might be padded after prepareForShadowVolume, only write the used part
+        for (const auto& b : vertexData->vertexBufferBinding->getBindings())
+        {
+            const HardwareVertexBufferSharedPtr& vbuf = b.second;
+            size_t vertexSize = vbuf->getVertexSize();
+            writeChunkHeader(SG_GEOMETRY_VERTEX_BUFFER,
+                             SGSTREAM_OVERHEAD_SIZE + sizeof(uint16) * 2 + vertexSize * vertexCount);
+            uint16 data[2] = {b.first, uint16(vertexSize)};
+            writeShorts(data, 2);
+
+            std::vector<uchar> buf(vertexSize * vertexCount);
+            vbuf->readData(0, buf.size(), buf.data());
+            if (mFlipEndian)
+            {
+                flipVertexData(buf.data(), vertexCount, vertexSize,
+                               vertexData->vertexDeclaration->findElementsBySource(b.first));
+            }
+            writeData(buf.data(), vertexSize, vertexCount);
+        }
+    }
+    //---------------------------------------------------------------------
+    size_t StaticGeometrySerializer::calcRegionSize(const StaticGeometry::Region* region)
+    {
+        size_t size = SGSTREAM_OVERHEAD_SIZE;
+        size += sizeof(uint32);
+        size += sizeof(float) * 10;
+        size += calcStringSize(region->mLodStrategy->getName());
+        size += sizeof(uint16) + sizeof(float) * region->mLodValues.size();
+
+        for (auto lod : region->getLODBuckets())
+        {
+            size += calcLodSize(lod);
+        }
+        return size;
+    }
+    //---------------------------------------------------------------------
+    size_t StaticGeometrySerializer::calcLodSize(StaticGeometry::LODBucket* lod)
+    {
+        size_t size = SGSTREAM_OVERHEAD_SIZE + sizeof(uint16) + sizeof(float);
+        for (const auto& m : lod->getMaterialBuckets())
+        {
+            size += calcMaterialSize(m.second);
+        }
+        return size;
+    }
+    //---------------------------------------------------------------------
+    size_t StaticGeometrySerializer::calcMaterialSize(StaticGeometry::MaterialBucket* mat)
+    {
+        size_t size = SGSTREAM_OVERHEAD_SIZE;
+        size += calcStringSize(mat->getMaterial()->getName());
+        size += calcStringSize(mat->getMaterial()->getGroup());
+        for (auto geom : mat->getGeometryList())
+        {
+            size += calcGeometrySize(geom);
+        }
+        return size;
+    }
+    //---------------------------------------------------------------------
+    size_t StaticGeometrySerializer::calcGeometrySize(const StaticGeometry::GeometryBucket* geom)
+    {
+        const VertexData* vertexData = geom->getVertexData();
+        const IndexData* indexData = geom->getIndexData();
+
+        size_t size = SGSTREAM_OVERHEAD_SIZE;
+        size += sizeof(uint32) + sizeof(bool) + sizeof(uint32);
+        size += indexData->indexCount * indexData->indexBuffer->getIndexSize();
+
+        size_t numElements = vertexData->vertexDeclaration->getElementCount();
+        size += numElements * (SGSTREAM_OVERHEAD_SIZE + sizeof(uint16) * 5);
+
+        for (const auto& b : vertexData->vertexBufferBinding->getBindings())
+        {
+            size += SGSTREAM_OVERHEAD_SIZE + sizeof(uint16) * 2;
+            size += b.second->getVertexSize() * vertexData->vertexCount;
+        }
+        return size;
+    }
+    //---------------------------------------------------------------------
+    void StaticGeometrySerializer::readSettings(const DataStreamPtr& stream, StaticGeometry* dest)
+    {
+        Vector3 dimensions, origin;
+        readObject(stream, dimensions);
+        readObject(stream, origin);
+        float dist;
+        readFloats(stream, &dist, 1);
+        bool castShadows;
+        readBools(stream, &castShadows, 1);
+
+        dest->setRegionDimensions(dimensions);
+        dest->setOrigin(origin);
+        dest->setRenderingDistance(dist);
+        dest->setCastShadows(castShadows);
+    }
+    //---------------------------------------------------------------------
+    StaticGeometry::Region* StaticGeometrySerializer::readRegionHeader(const DataStreamPtr& stream,
+                                                                       StaticGeometry* dest)
+    {
+        uint32 id;
+        readInts(stream, &id, 1);
+        Vector3 centre, boundsMin, boundsMax;
+        readObject(stream, centre);
+        readObject(stream, boundsMin);
+        readObject(stream, boundsMax);
+        float radius;
+        readFloats(stream, &radius, 1);
+        String lodStrategy = readString(stream);
+        uint16 numLodValues;
+        readShorts(stream, &numLodValues, 1);
+
+        StaticGeometry::Region* region = dest->createRegion(id, centre);
+        region->mAABB.setExtents(boundsMin, boundsMax);
+        region->mBoundingRadius = radius;
+        region->mLodStrategy = LodStrategyManager::getSingleton().getStrategy(lodStrategy);
+        region->mLodValues.resize(numLodValues);
+        readFloats(stream, region->mLodValues.data(), numLodValues);
+
+        return region;
+    }
+    //---------------------------------------------------------------------
+    void StaticGeometrySerializer::readLod(const DataStreamPtr& stream, StaticGeometry::Region* region)
+    {
+        uint16 index;
+        readShorts(stream, &index, 1);
+        float lodValue;
+        readFloats(stream, &lodValue, 1);
+
+        auto lod = OGRE_NEW StaticGeometry::LODBucket(region, index, lodValue);
+        region->mLodBucketList.push_back(lod);
+
+        pushInnerChunk(stream);
+        if (!stream->eof())
+        {
+            unsigned short streamID = readChunk(stream);
+            while (!stream->eof() && streamID == SG_MATERIAL)
+            {
+                readMaterial(stream, lod);
+                if (!stream->eof())
+                {
+                    streamID = readChunk(stream);
+                }
+            }
+            if (!stream->eof())
+            {
+                // Backpedal back to start of non-material chunk
+                backpedalChunkHeader(stream);
+            }
+        }
+        popInnerChunk(stream);
+    }
+    //---------------------------------------------------------------------
+    void StaticGeometrySerializer::readMaterial(const DataStreamPtr& stream, StaticGeometry::LODBucket* lod)
+    {
+        String name = readString(stream);
+        String group = readString(stream);
+
+        MaterialPtr material = MaterialManager::getSingleton().getByName(name, group);
+        if (!material)
+        {
+            LogManager::getSingleton().logError("StaticGeometrySerializer - can't assign material '" + name +
+                                                "' as it does not exist");
+            material = MaterialManager::getSingleton().getDefaultMaterial();
+        }
+
+        auto mat = OGRE_NEW StaticGeometry::MaterialBucket(lod, material);
+        lod->mMaterialBucketMap[name] = mat;
+
+        pushInnerChunk(stream);
+        if (!stream->eof())
+        {
+            unsigned short streamID = readChunk(stream);
+            while (!stream->eof() && streamID == SG_GEOMETRY)
+            {
+                readGeometry(stream, mat);
+                if (!stream->eof())
+                {
+                    streamID = readChunk(stream);
+                }
+            }
+            if (!stream->eof())
+            {
+                // Backpedal back to start of non-geometry chunk
+                backpedalChunkHeader(stream);
+            }
+        }
+        popInnerChunk(stream);
+    }
+    //---------------------------------------------------------------------
+    void StaticGeometrySerializer::readGeometry(const DataStreamPtr& stream, StaticGeometry::MaterialBucket* mat)
+    {
+        uint32 vertexCount, indexCount;
+        bool idx32bit;
+        readInts(stream, &vertexCount, 1);
+        readBools(stream, &idx32bit, 1);
+        readInts(stream, &indexCount, 1);
+
+        auto geom = OGRE_NEW StaticGeometry::GeometryBucket(mat);
+        mat->mGeometryBucketList.push_back(geom);
+        geom->mMaxVertexIndex = idx32bit ? 0xFFFFFFFF : 0xFFFF;
+
+        // Read into system memory buffers, like after merging the geometry during a build
+        auto indexType = idx32bit ? HardwareIndexBuffer::IT_32BIT : HardwareIndexBuffer::IT_16BIT;
+        geom->mIndexData = OGRE_NEW IndexData();
+        geom->mIndexData->indexCount = indexCount;
+        geom->mIndexData->indexBuffer = std::make_shared<HardwareIndexBuffer>(
+            nullptr, indexType, indexCount,
+            new DefaultHardwareBuffer(HardwareIndexBuffer::indexSize(indexType) * indexCount));
+        HardwareBufferLockGuard indexLock(geom->mIndexData->indexBuffer, HardwareBuffer::HBL_DISCARD);
+        if (idx32bit)
+            readInts(stream, static_cast<uint32*>(indexLock.pData), indexCount);
+        else
+            readShorts(stream, static_cast<uint16*>(indexLock.pData), indexCount);
+        indexLock.unlock();
+
+        geom->mVertexData = OGRE_NEW VertexData();
+        geom->mVertexData->vertexCount = vertexCount;
+        VertexDeclaration* decl = geom->mVertexData->vertexDeclaration;
+
+        pushInnerChunk(stream);
+        if (!stream->eof())
+        {
+            unsigned short streamID = readChunk(stream);
+            while (!stream->eof() &&
+                   (streamID == SG_GEOMETRY_VERTEX_ELEMENT || streamID == SG_GEOMETRY_VERTEX_BUFFER))
+            {
+                if (streamID == SG_GEOMETRY_VERTEX_ELEMENT)
+                {
+                    uint16 data[5];
+                    readShorts(stream, data, 5);
+                    decl->addElement(data[0], data[3], VertexElementType(data[1]), VertexElementSemantic(data[2]),
+                                     data[4]);
+                }
+                else
+                {
+                    uint16 data[2];
+                    readShorts(stream, data, 2);
+                    size_t vertexSize = data[1];
+                    HardwareVertexBufferSharedPtr vbuf = std::make_shared<HardwareVertexBuffer>(
+                        nullptr, vertexSize, vertexCount, new DefaultHardwareBuffer(vertexSize * vertexCount));
+                    HardwareBufferLockGuard vertexLock(vbuf, HardwareBuffer::HBL_DISCARD);
+                    stream->read(vertexLock.pData, vertexSize * vertexCount);
+                    if (mFlipEndian)
+                    {
+                        flipVertexData(vertexLock.pData, vertexCount, vertexSize, decl->findElementsBySource(data[0]));
+                    }
+                    vertexLock.unlock();
+                    geom->mVertexData->vertexBufferBinding->setBinding(data[0], vbuf);
+                }
+
+                if (!stream->eof())
+                {
+                    streamID = readChunk(stream);
+                }
+            }
+            if (!stream->eof())
+            {
+                // Backpedal back to start of non-vertex chunk
+                backpedalChunkHeader(stream);
+            }
+        }
+        popInnerChunk(stream);
+    }
+    //---------------------------------------------------------------------
+    void StaticGeometrySerializer::flipVertexData(void* pData, size_t vertexCount, size_t vertexSize,
+                                                  const VertexDeclaration::VertexElementList& elems)
+    {
+        uchar* pBase = static_cast<uchar*>(pData);
+        for (size_t v = 0; v < vertexCount; ++v, pBase += vertexSize)
+        {
+            for (const auto& e : elems)
+            {
+                // byte sized components, like colours, do not need flipping
+                size_t count = VertexElement::getTypeCount(e.getType());
+                Bitwise::bswapChunks(pBase + e.getOffset(), VertexElement::getTypeSize(e.getType()) / count, count);
+            }
+        }
+    }
+}
@@ -30,6 +30,21 @@ THE SOFTWARE.
 
 namespace Ogre
 {
+    namespace
+    {
+        /// vertices are processed in blocks of this size, each recording its own splits
+        const size_t VERTEX_BLOCK_SIZE = 4096;
+        /// marks the entry of mCornerSplits, where a split vertex was created
+        const uint32 SPLIT_CREATED = 0x80000000;
+
+        template <typename F> void parallelFor(size_t count, size_t grain, const F& fn)
+        {
+            if (Root* root = Root::getSingletonPtr())
+                root->getWorkQueue()->parallelFor(0, count, fn, grain);
+            else
+                fn(0, count);
+        }
+    }
     //---------------------------------------------------------------------
     TangentSpaceCalc::TangentSpaceCalc()
         : mVData(0)
@@ -202,25 +217,27 @@ namespace Ogre
     {
         // Just run through our complete (possibly augmented) list of vertices
         // Normalise the tangents & binormals
-        for (auto & v : mVertexArray)
-        {
-            v.tangent.normalise();
-            v.binormal.normalise();
-
-            // Orthogonalise with the vertex normal since it's currently
-            // orthogonal with the face normals, but will be close to ortho
-            // Apply Gram-Schmidt orthogonalise
-            Vector3 temp = v.tangent;
-            v.tangent = temp - (v.norm * v.norm.dotProduct(temp));
-
-            temp = v.binormal;
-            v.binormal = temp - (v.norm * v.norm.dotProduct(temp));
-
-            // renormalize 
-            v.tangent.normalise();
-            v.binormal.normalise();
-
-        }
+        parallelFor(mVertexArray.size(), VERTEX_BLOCK_SIZE, [this](size_t first, size_t last) {
+            for (size_t i = first; i < last; ++i)
+            {
+                VertexInfo& v = mVertexArray[i];
+                v.tangent.normalise();
+                v.binormal.normalise();
+
+                // Orthogonalise with the vertex normal since it's currently
+                // orthogonal with the face normals, but will be close to ortho
+                // Apply Gram-Schmidt orthogonalise
+                Vector3 temp = v.tangent;
+                v.tangent = temp - (v.norm * v.norm.dotProduct(temp));
+
+                temp = v.binormal;
+                v.binormal = temp - (v.norm * v.norm.dotProduct(temp));
+
+                // renormalize
+                v.tangent.normalise();
+                v.binormal.normalise();
+            }
+        });
     }
     //---------------------------------------------------------------------
     void TangentSpaceCalc::processFaces(Result& result)
@@ -236,6 +253,40 @@ namespace Ogre
             }
         }
 
+        /* The faces are added to the vertices in parallel, but in the same order as a
+        sequential loop over the faces would. This keeps the results exact:
+          Calculate the tangent space of all faces, in parallel
+          List the faces of each vertex in face order
+          For each vertex, in parallel
+            Add its faces in order, splitting it where needed
+          Number the split vertices in face order
+        */
+        readFaces();
+        parallelFor(mFaces.size(), 1024, [this](size_t first, size_t last) { calculateFaces(first, last); });
+        buildCorners();
+
+        size_t numBlocks = (mVertexArray.size() + VERTEX_BLOCK_SIZE - 1) / VERTEX_BLOCK_SIZE;
+        mBlockSplits.resize(numBlocks);
+        parallelFor(numBlocks, 1, [this](size_t first, size_t last) {
+            for (size_t block = first; block < last; ++block)
+                addFacesToVertices(block);
+        });
+
+        resolveSplits(result);
+    }
+    //---------------------------------------------------------------------
+    void TangentSpaceCalc::readFaces()
+    {
+        mFaceStart.resize(1);
+        for (size_t i = 0; i < mIDataList.size(); ++i)
+        {
+            const IndexData* i_in = mIDataList[i];
+            size_t faceCount = mOpTypes[i] == RenderOperation::OT_TRIANGLE_LIST ?
+                i_in->indexCount / 3 : i_in->indexCount - 2;
+            mFaceStart.push_back(mFaceStart.back() + faceCount);
+        }
+        mFaces.resize(mFaceStart.back());
+
         for (size_t i = 0; i < mIDataList.size(); ++i)
         {
             IndexData* i_in = mIDataList[i];
@@ -249,11 +300,9 @@ namespace Ogre
             bool isIT32 = ibuf->getType() == HardwareIndexBuffer::IT_32BIT;
 
             // current triangle
-            size_t vertInd[3] = { 0, 0, 0 };
-            // loop through all faces to calculate the tangents and normals
-            size_t faceCount = opType == RenderOperation::OT_TRIANGLE_LIST ? 
-                i_in->indexCount / 3 : i_in->indexCount - 2;
-            for (size_t f = 0; f < faceCount; ++f)
+            uint32 vertInd[3] = { 0, 0, 0 };
+            FaceInfo* face = &mFaces[mFaceStart[i]];
+            for (size_t f = 0; f < mFaceStart[i + 1] - mFaceStart[i]; ++f, ++face)
             {
                 bool invertOrdering = false;
                 // Read 1 or 3 indexes depending on type
@@ -287,160 +336,227 @@ namespace Ogre
                 }
 
                 // deal with strip inversion of winding
-                size_t localVertInd[3];
-                localVertInd[0] = vertInd[0];
-                if (invertOrdering)
-                {
-                    localVertInd[1] = vertInd[2];
-                    localVertInd[2] = vertInd[1];
-                }
-                else
-                {
-                    localVertInd[1] = vertInd[1];
-                    localVertInd[2] = vertInd[2];
-                }
-
+                face->vertInd[0] = vertInd[0];
+                face->vertInd[1] = vertInd[invertOrdering ? 2 : 1];
+                face->vertInd[2] = vertInd[invertOrdering ? 1 : 2];
+            }
+        }
+    }
+    //---------------------------------------------------------------------
+    void TangentSpaceCalc::calculateFaces(size_t first, size_t last)
+    {
+        for (size_t f = first; f < last; ++f)
+        {
+            FaceInfo& face = mFaces[f];
+            size_t localVertInd[3] = {face.vertInd[0], face.vertInd[1], face.vertInd[2]};
 
-                // For each triangle
-                //   Calculate tangent & binormal per triangle
-                //   Note these are not normalised, are weighted by UV area
-                Vector3 faceTsU, faceTsV, faceNorm;
-                calculateFaceTangentSpace(localVertInd, faceTsU, faceTsV, faceNorm);
+            // For each triangle
+            //   Calculate tangent & binormal per triangle
+            //   Note these are not normalised, are weighted by UV area
+            calculateFaceTangentSpace(localVertInd, face.tsU, face.tsV, face.norm);
 
-                // Skip invalid UV space triangles
-                if (faceTsU.isZeroLength() || faceTsV.isZeroLength())
-                    continue;
+            // Skip invalid UV space triangles
+            face.valid = !(face.tsU.isZeroLength() || face.tsV.isZeroLength());
+            if (!face.valid)
+                continue;
 
-                addFaceTangentSpaceToVertices(i, f, localVertInd, faceTsU, faceTsV, faceNorm, result);
+            // Calculate parity for this triangle
+            face.parity = calculateParity(face.tsU, face.tsV, face.norm);
 
+            // We want to re-weight the tangents by the angle the face makes with the vertex
+            // in order to obtain tessellation-independent results
+            for (int v = 0; v < 3; ++v)
+            {
+                face.angleWeight[v] = calculateAngleWeight(localVertInd[v],
+                    localVertInd[(v+1)%3], localVertInd[(v+2)%3]);
             }
         }
+    }
+    //---------------------------------------------------------------------
+    void TangentSpaceCalc::buildCorners()
+    {
+        // count the faces of each vertex
+        mCornerStart.assign(mVertexArray.size() + 1, 0);
+        for (const auto& face : mFaces)
+        {
+            if (!face.valid)
+                continue;
+            for (uint32 v : face.vertInd)
+                ++mCornerStart[v + 1];
+        }
+        for (size_t v = 0; v < mVertexArray.size(); ++v)
+            mCornerStart[v + 1] += mCornerStart[v];
+
+        // list them in face order
+        mCornerCursor = mCornerStart;
+        mCorners.resize(mCornerStart.back());
+        for (size_t f = 0; f < mFaces.size(); ++f)
+        {
+            if (!mFaces[f].valid)
+                continue;
+            for (int v = 0; v < 3; ++v)
+                mCorners[mCornerCursor[mFaces[f].vertInd[v]]++] = uint32(f * 3 + v);
+        }
 
+        if (mSplitMirrored || mSplitRotated)
+            mCornerSplits.assign(mCorners.size(), 0);
     }
     //---------------------------------------------------------------------
-    void TangentSpaceCalc::addFaceTangentSpaceToVertices(
-        size_t indexSet, size_t faceIndex, size_t *localVertInd, 
-        const Vector3& faceTsU, const Vector3& faceTsV, const Vector3& faceNorm, 
-        Result& result)
+    void TangentSpaceCalc::addFacesToVertices(size_t block)
     {
-        // Calculate parity for this triangle
-        int faceParity = calculateParity(faceTsU, faceTsV, faceNorm);
-        // Now add these to each vertex referenced by the face
-        for (int v = 0; v < 3; ++v)
+        std::vector<SplitVertex>& splits = mBlockSplits[block];
+        splits.clear();
+
+        size_t end = std::min((block + 1) * VERTEX_BLOCK_SIZE, mCornerStart.size() - 1);
+        for (size_t i = block * VERTEX_BLOCK_SIZE; i < end; ++i)
         {
-            // index 0 is vertex we're calculating, 1 and 2 are the others
+            VertexInfo& original = mVertexArray[i];
+            // What split the opposite parity vertex copy is at (0 if not created yet)
+            uint32 oppositeParity = 0;
 
-            // We want to re-weight these by the angle the face makes with the vertex
-            // in order to obtain tessellation-independent results
-            Real angleWeight = calculateAngleWeight(localVertInd[v], 
-                localVertInd[(v+1)%3], localVertInd[(v+2)%3]);
-
-
-            VertexInfo* vertex = &(mVertexArray[localVertInd[v]]);
-
-            // check parity (0 means not set)
-            // Locate parity-version of vertex index, or create if doesn't exist
-            // If parity-version of vertex index was different, record alteration
-            // in triangle remap
-            // in vertex split list
-            bool splitVertex = false;
-            size_t reusedOppositeParity = 0;
-            bool splitBecauseOfParity = false;
-            bool newVertex = false;
-            if (!vertex->parity)
-            {
-                // init
-                vertex->parity = faceParity;
-                newVertex = true;
-            }
-            if (mSplitMirrored)
+            for (uint32 corner = mCornerStart[i]; corner < mCornerStart[i + 1]; ++corner)
             {
-                if (!newVertex && faceParity != calculateParity(vertex->tangent, vertex->binormal, vertex->norm))//vertex->parity != faceParity)
+                const FaceInfo& face = mFaces[mCorners[corner] / 3];
+                Real angleWeight = face.angleWeight[mCorners[corner] % 3];
+
+                Vector3* tangent = &original.tangent;
+                Vector3* binormal = &original.binormal;
+
+                // check parity (0 means not set)
+                // Locate parity-version of vertex index, or create if doesn't exist
+                // If parity-version of vertex index was different, record the split
+                bool splitVertex = false;
+                uint32 reusedOppositeParity = 0;
+                bool splitBecauseOfParity = false;
+                bool newVertex = false;
+                if (!original.parity)
+                {
+                    // init
+                    original.parity = face.parity;
+                    newVertex = true;
+                }
+                if (mSplitMirrored)
                 {
-                    // Check for existing alternative parity
-                    if (vertex->oppositeParityIndex)
+                    if (!newVertex && face.parity != calculateParity(original.tangent, original.binormal, original.norm))
                     {
-                        // Ok, have already split this vertex because of parity
-                        // Use the same one again
-                        reusedOppositeParity = vertex->oppositeParityIndex;
-                        vertex = &(mVertexArray[reusedOppositeParity]);
+                        // Check for existing alternative parity
+                        if (oppositeParity)
+                        {
+                            // Ok, have already split this vertex because of parity
+                            // Use the same one again
+                            reusedOppositeParity = oppositeParity;
+                            tangent = &splits[oppositeParity - 1].tangent;
+                            binormal = &splits[oppositeParity - 1].binormal;
+                        }
+                        else
+                        {
+                            splitVertex = true;
+                            splitBecauseOfParity = true;
+                        }
                     }
-                    else
+                }
+
+                if (mSplitRotated)
+                {
+                    // deal with excessive tangent space rotations as well as mirroring
+                    // same kind of split behaviour appropriate
+                    if (!newVertex && !splitVertex)
                     {
-                        splitVertex = true;
-                        splitBecauseOfParity = true;
-
-                        LogManager::getSingleton().stream(LML_TRIVIAL)
-                            << "TSC parity split - Vpar: " << vertex->parity 
-                            << " Fpar: " << faceParity
-                            << " faceTsU: " << faceTsU
-                            << " faceTsV: " << faceTsV
-                            << " faceNorm: " << faceNorm
-                            << " vertTsU:" << vertex->tangent
-                            << " vertTsV:" << vertex->binormal
-                            << " vertNorm:" << vertex->norm;
+                        // If more than 90 degrees, split
+                        Vector3 uvCurrent = *tangent + *binormal;
+
+                        // project down to the plane (plane normal = face normal)
+                        Vector3 vRotHalf = uvCurrent - face.norm;
+                        vRotHalf *= face.norm.dotProduct(uvCurrent);
 
+                        if ((face.tsU + face.tsV).dotProduct(vRotHalf) < 0.0f)
+                        {
+                            splitVertex = true;
+                        }
                     }
                 }
-            }
 
-            if (mSplitRotated)
-            {
-
-                // deal with excessive tangent space rotations as well as mirroring
-                // same kind of split behaviour appropriate
-                if (!newVertex && !splitVertex)
+                if (splitVertex)
                 {
-                    // If more than 90 degrees, split
-                    Vector3 uvCurrent = vertex->tangent + vertex->binormal;
-
-                    // project down to the plane (plane normal = face normal)
-                    Vector3 vRotHalf = uvCurrent - faceNorm;
-                    vRotHalf *= faceNorm.dotProduct(uvCurrent);
-
-                    if ((faceTsU + faceTsV).dotProduct(vRotHalf) < 0.0f)
+                    // start with a reset tangent space
+                    SplitVertex split = {Vector3::ZERO, Vector3::ZERO, face.parity, splitBecauseOfParity, 0};
+                    splits.push_back(split);
+                    uint32 splitIndex = uint32(splits.size());
+                    // re-point opposite parity
+                    if (splitBecauseOfParity)
                     {
-                        splitVertex = true;
+                        oppositeParity = splitIndex;
                     }
+                    mCornerSplits[corner] = splitIndex | SPLIT_CREATED;
+                    tangent = &splits.back().tangent;
+                    binormal = &splits.back().binormal;
                 }
-            }
-
-            if (splitVertex)
-            {
-                size_t newVertexIndex = mVertexArray.size();
-                VertexSplit splitInfo(localVertInd[v], newVertexIndex);
-                result.vertexSplits.push_back(splitInfo);
-                // re-point opposite parity
-                if (splitBecauseOfParity)
+                else if (reusedOppositeParity)
                 {
-                    vertex->oppositeParityIndex = newVertexIndex;
+                    // didn't split again, but we do need to record the re-used remapping
+                    mCornerSplits[corner] = reusedOppositeParity;
                 }
-                // copy old values but reset tangent space
-                VertexInfo locVertex = *vertex;
-                locVertex.tangent = Vector3::ZERO;
-                locVertex.binormal = Vector3::ZERO;
-                locVertex.parity = faceParity;
-                mVertexArray.push_back(locVertex);
-                result.indexesRemapped.push_back(IndexRemap(indexSet, faceIndex, splitInfo));
-
-                vertex = &(mVertexArray[newVertexIndex]);
 
+                // Add weighted tangent & binormal
+                *tangent += (face.tsU * angleWeight);
+                *binormal += (face.tsV * angleWeight);
             }
-            else if (reusedOppositeParity)
-            {
-                // didn't split again, but we do need to record the re-used remapping
-                VertexSplit splitInfo(localVertInd[v], reusedOppositeParity);
-                result.indexesRemapped.push_back(IndexRemap(indexSet, faceIndex, splitInfo));
+        }
+    }
+    //---------------------------------------------------------------------
+    void TangentSpaceCalc::resolveSplits(Result& result)
+    {
+        if (!mSplitMirrored && !mSplitRotated)
+            return;
 
-            }
+        // formatting the message is expensive with many splits, so skip it when it would be dropped
+        Log* log = LogManager::getSingleton().getDefaultLog();
+        bool logSplits = log && log->getMinLogLevel() <= LML_TRIVIAL;
+
+        // walk the faces in order again, so the split vertices get appended in
+        // the order they were encountered
+        mCornerCursor = mCornerStart;
+        for (size_t i = 0; i < mIDataList.size(); ++i)
+        {
+            for (size_t f = 0; f < mFaceStart[i + 1] - mFaceStart[i]; ++f)
+            {
+                const FaceInfo& face = mFaces[mFaceStart[i] + f];
+                if (!face.valid)
+                    continue;
 
-            // Add weighted tangent & binormal
-            vertex->tangent += (faceTsU * angleWeight);
-            vertex->binormal += (faceTsV * angleWeight);
+                for (uint32 v : face.vertInd)
+                {
+                    uint32 splitIndex = mCornerSplits[mCornerCursor[v]++];
+                    if (!splitIndex)
+                        continue;
 
+                    SplitVertex& split = mBlockSplits[v / VERTEX_BLOCK_SIZE][(splitIndex & ~SPLIT_CREATED) - 1];
+                    if (splitIndex & SPLIT_CREATED)
+                    {
+                        if (split.mirrored && logSplits)
+                        {
+                            log->stream(LML_TRIVIAL)
+                                << "TSC parity split - Vpar: " << mVertexArray[v].parity
+                                << " Fpar: " << face.parity
+                                << " faceTsU: " << face.tsU
+                                << " faceTsV: " << face.tsV
+                                << " faceNorm: " << face.norm
+                                << " vertNorm:" << mVertexArray[v].norm;
+                        }
 
+                        // copy old values but use the split tangent space
+                        VertexInfo locVertex = mVertexArray[v];
+                        locVertex.tangent = split.tangent;
+                        locVertex.binormal = split.binormal;
+                        locVertex.parity = split.parity;
+                        split.index = mVertexArray.size();
+                        mVertexArray.push_back(locVertex);
+                        result.vertexSplits.push_back(VertexSplit(v, split.index));
+                    }
+                    result.indexesRemapped.push_back(IndexRemap(i, f, VertexSplit(v, split.index)));
+                }
+            }
         }
-
     }
     //---------------------------------------------------------------------
     int TangentSpaceCalc::calculateParity(const Vector3& u, const Vector3& v, const Vector3& n)
@@ -28,6 +28,7 @@ THE SOFTWARE.
 #include "OgreStableHeaders.h"
 #include "OgreHardwarePixelBuffer.h"
 #include "OgreImage.h"
+#include "OgreImageCodec.h"
 #include "OgreTexture.h"
 
 namespace Ogre {
@@ -59,7 +60,8 @@ namespace Ogre {
             mTextureType(TEX_TYPE_2D),
             mDesiredIntegerBitDepth(0),
             mDesiredFloatBitDepth(0),
-            mDesiredFormat(PF_UNKNOWN)
+            mDesiredFormat(PF_UNKNOWN),
+            mBandCodec(NULL)
     {
         if (createParamDictionary("Texture"))
         {
@@ -166,15 +168,13 @@ namespace Ogre {
         return getTextureType() == TEX_TYPE_CUBE_MAP ? 6 : 1;
     }
     //--------------------------------------------------------------------------
-    void Texture::_loadImages( const ConstImagePtrList& images )
+    void Texture::createForImage(uint32 width, uint32 height, uint32 depth, PixelFormat format, uint32 imageMips)
     {
-        OgreAssert(!images.empty(), "Cannot load empty vector of images");
-
-        // Set desired texture size and properties from images[0]
-        mSrcWidth = mWidth = images[0]->getWidth();
-        mSrcHeight = mHeight = images[0]->getHeight();
-        mSrcDepth = mDepth = images[0]->getDepth();
-        mSrcFormat = images[0]->getFormat();
+        // Set desired texture size and properties from the image
+        mSrcWidth = mWidth = width;
+        mSrcHeight = mHeight = height;
+        mSrcDepth = mDepth = depth;
+        mSrcFormat = format;
 
         if(!mLayerNames.empty() && mTextureType != TEX_TYPE_CUBE_MAP)
             mDepth = uint32(mLayerNames.size());
@@ -194,8 +194,6 @@ namespace Ogre {
         }
 
         // The custom mipmaps in the image clamp the request
-        uint32 imageMips = images[0]->getNumMipmaps();
-
         if(imageMips > 0)
         {
             mNumMipmaps = mNumRequestedMipmaps = std::min(mNumRequestedMipmaps, imageMips);
@@ -205,6 +203,33 @@ namespace Ogre {
 
         // Create the texture
         createInternalResources();
+    }
+    //--------------------------------------------------------------------------
+    void Texture::_loadImages( const ConstImagePtrList& images )
+    {
+        OgreAssert(!images.empty(), "Cannot load empty vector of images");
+
+        uint32 imageMips = images[0]->getNumMipmaps();
+        createForImage(images[0]->getWidth(), images[0]->getHeight(), images[0]->getDepth(),
+                       images[0]->getFormat(), imageMips);
+
+        // Generate the mipmaps on the CPU, if the render system does not
+        ConstImagePtrList generated;
+        std::vector<Image> generatedImages;
+        if ((mUsage & TU_AUTOMIPMAP) && !mMipmapsHardwareGenerated && mNumMipmaps > 0 && imageMips == 0 &&
+            !PixelUtil::isCompressed(mSrcFormat))
+        {
+            generatedImages.resize(images.size());
+            for (size_t i = 0; i < images.size(); ++i)
+            {
+                generatedImages[i] = *images[i];
+                generatedImages[i].generateMipmaps(isHardwareGammaEnabled());
+                generated.push_back(&generatedImages[i]);
+            }
+            imageMips = generatedImages[0].getNumMipmaps();
+        }
+        const ConstImagePtrList& srcImages = generated.empty() ? images : generated;
+
         // Check if we're loading one image with multiple faces
         // or a vector of images representing the faces
         uint32 faces;
@@ -273,7 +298,7 @@ namespace Ogre {
                 if(multiImage)
                 {
                     // Load from multiple images
-                    src = images[i]->getPixelBox(0, mip);
+                    src = srcImages[i]->getPixelBox(0, mip);
                     // set dst layer
                     if(mDepth > 1)
                     {
@@ -284,13 +309,13 @@ namespace Ogre {
                 else
                 {
                     // Load from faces of images[0]
-                    src = images[0]->getPixelBox(i, mip);
+                    src = srcImages[0]->getPixelBox(i, mip);
                 }
 
                 if(mGamma != 1.0f) {
                     // Apply gamma correction
                     // Do not overwrite original image but do gamma correction in temporary buffer
-                    Image tmp(src.format, src.getWidth(), getHeight(), src.getDepth());
+                    Image tmp(src.format, src.getWidth(), src.getHeight(), src.getDepth());
                     PixelBox corrected = tmp.getPixelBox();
                     PixelUtil::bulkPixelConversion(src, corrected);
 
@@ -470,6 +495,9 @@ namespace Ogre {
         {
             if(mLayerNames.empty())
             {
+                if (prepareBands(ext, haveNPOT))
+                    return;
+
                 readImage(loadedImages, mName, ext, haveNPOT);
 
                 // If this is a volumetric texture set the texture type flag accordingly.
@@ -526,9 +554,103 @@ namespace Ogre {
         std::swap(mLoadedImages, loadedImages);
     }
 
+    bool Texture::prepareBands(const String& ext, bool haveNPOT)
+    {
+        String type = ext;
+        StringUtil::toLowerCase(type);
+
+        size_t bandSize = TextureManager::getSingleton().getStreamingBandSize();
+        if (!bandSize || mTextureType != TEX_TYPE_2D || mGamma != 1.0f || !Codec::isCodecRegistered(type))
+            return false;
+
+        auto codec = dynamic_cast<ImageCodec*>(Codec::getCodec(type));
+        if (!codec)
+            return false;
+
+        struct HeaderReader : public ImageCodec::BandListener
+        {
+            uint32 width = 0, height = 0;
+            PixelFormat format = PF_UNKNOWN;
+            bool imageHeaderDecoded(uint32 w, uint32 h, PixelFormat fmt, uint32) override
+            {
+                width = w;
+                height = h;
+                format = fmt;
+                return false;
+            }
+            void bandDecoded(uint32, uint32, const PixelBox&) override {}
+        } header;
+
+        DataStreamPtr stream = ResourceGroupManager::getSingleton().openResource(mName, mGroup, this);
+        codec->decodeBands(stream, &header, bandSize);
+
+        // not supported by the codec or small enough to be loaded at once
+        if (header.format == PF_UNKNOWN ||
+            PixelUtil::getMemorySize(header.width, header.height, 1, header.format) <= bandSize)
+            return false;
+
+        // would need to be scaled to a power of 2
+        if (!haveNPOT && (!Bitwise::isPO2(header.width) || !Bitwise::isPO2(header.height)))
+            return false;
+
+        stream->seek(0);
+        mBandStream = stream;
+        mBandCodec = codec;
+        return true;
+    }
+
+    void Texture::loadBands()
+    {
+        struct Uploader : public ImageCodec::BandListener
+        {
+            Texture* tex;
+            bool imageHeaderDecoded(uint32 width, uint32 height, PixelFormat format, uint32 numMipmaps) override
+            {
+                bool compressed = PixelUtil::isCompressed(format);
+                // see prepareImpl
+                if (compressed && numMipmaps == 0 &&
+                    !Root::getSingleton().getRenderSystem()->getCapabilities()->hasCapability(
+                        RSC_AUTOMIPMAP_COMPRESSED))
+                {
+                    tex->mNumMipmaps = tex->mNumRequestedMipmaps = 0;
+                    tex->mUsage &= ~TU_AUTOMIPMAP;
+                }
+
+                tex->createForImage(width, height, 1, format, numMipmaps);
+
+                // the mipmaps would have to be generated from the full image on the CPU
+                return !((tex->mUsage & TU_AUTOMIPMAP) && !tex->mMipmapsHardwareGenerated &&
+                         tex->mNumMipmaps > 0 && numMipmaps == 0 && !compressed);
+            }
+            void bandDecoded(uint32 mip, uint32 top, const PixelBox& band) override
+            {
+                if (mip > tex->mNumMipmaps)
+                    return;
+                auto buffer = tex->getBuffer(0, mip);
+                buffer->blitFromMemory(band, Box(0, top, buffer->getWidth(), top + band.getHeight()));
+            }
+        } uploader;
+        uploader.tex = this;
+
+        DataStreamPtr stream;
+        std::swap(stream, mBandStream);
+        if (mBandCodec->decodeBands(stream, &uploader, TextureManager::getSingleton().getStreamingBandSize()))
+        {
+            mSize = getNumFaces() * PixelUtil::getMemorySize(mWidth, mHeight, mDepth, mFormat);
+            return;
+        }
+
+        // decode the whole image instead, the texture might be created already
+        stream->seek(0);
+        Image img;
+        img.load(stream, mBandCodec->getType());
+        _loadImages({&img});
+    }
+
     void Texture::unprepareImpl()
     {
         mLoadedImages.clear();
+        mBandStream.reset();
     }
 
     void Texture::loadImpl()
@@ -539,6 +661,12 @@ namespace Ogre {
             return;
         }
 
+        if (mBandStream)
+        {
+            loadBands();
+            return;
+        }
+
         LoadedImages loadedImages;
         // Now the only copy is on the stack and will be cleaned in case of
         // exceptions being thrown from _loadImages
@@ -44,6 +44,7 @@ namespace Ogre {
          : mPreferredIntegerBitDepth(0)
          , mPreferredFloatBitDepth(0)
          , mDefaultNumMipmaps(MIP_UNLIMITED)
+         , mStreamingBandSize(16 << 20)
     {
         mResourceType = "Texture";
         mLoadOrder = 75.0f;
@@ -28,6 +28,7 @@ THE SOFTWARE.
 #include "OgreStableHeaders.h"
 #include "OgreVertexIndexData.h"
 #include "OgreHardwareVertexBuffer.h"
+#include "OgreMeshOptimiser.h"
 
 #define INT10_MAX ((1 << 9) - 1)
 
@@ -92,14 +93,23 @@ namespace Ogre {
         pHalf[2] = Bitwise::floatToHalf(pFloat[2]);
     }
 
+    static void float_to_half_2(uint8* pDst, uint8* pSrc, int elemOffset)
+    {
+        float* pFloat = (float*)(pSrc + elemOffset);
+        uint16* pHalf = (uint16*)(pDst + elemOffset);
+        pHalf[0] = Bitwise::floatToHalf(pFloat[0]);
+        pHalf[1] = Bitwise::floatToHalf(pFloat[1]);
+    }
+
     /** Splice out an element from a vertex buffer
      * @param elem The element to splice out of the vertex
      * @param srcBuf Source buffer
      * @param pDst Destination buffer for the vertex without the element
      * @param pElemDst Destination buffer for the element (can be the same as pDst)
      */
+    template <typename F>
     static void spliceElement(const VertexElement* elem, const HardwareVertexBufferPtr& srcBuf, uint8* pDst,
-                              uint8* pElemDst, uint32 newElemSize, void (*elemConvert)(uint8*, uint8*, int))
+                              uint8* pElemDst, uint32 newElemSize, const F& elemConvert)
     {
         auto vertexSize = srcBuf->getVertexSize();
         auto numVerts = srcBuf->getNumVertices();
@@ -313,6 +323,11 @@ namespace Ogre {
                 OgreAssert(srcType == VET_FLOAT3, "unsupported conversion");
                 spliceElement(elem, vbuf, pDst, pDst, newElemSize, float_to_half_3);
             }
+            else if(dstType == VET_HALF2)
+            {
+                OgreAssert(srcType == VET_FLOAT2, "unsupported conversion");
+                spliceElement(elem, vbuf, pDst, pDst, newElemSize, float_to_half_2);
+            }
             else if(dstType == VET_HALF4 || dstType == VET_SHORT4 || dstType == VET_USHORT4)
             {
                 // pad 16x3 formats to 16x4
@@ -330,6 +345,50 @@ namespace Ogre {
         updateVertexDeclaration(vertexDeclaration, elem, dstType, elem->getSource());
     }
     //-----------------------------------------------------------------------
+    void VertexData::quantisePositions(const AxisAlignedBox& bounds)
+    {
+        auto elem = vertexDeclaration->findElementBySemantic(VES_POSITION);
+
+        if(!elem)
+            return; // nothing to do
+
+        OgreAssert(elem->getType() == VET_FLOAT3, "only VET_FLOAT3 positions can be quantised");
+        OgreAssert(!bounds.isNull() && !bounds.isInfinite(), "finite bounds required");
+
+        // map the bounds to [-1, 1] on every axis, flat axes collapse to 0
+        Vector3 centre = bounds.getCenter(), halfSize = bounds.getHalfSize(), scale;
+        for (int i = 0; i < 3; i++)
+            scale[i] = halfSize[i] > 0 ? 32767 / halfSize[i] : 0;
+
+        auto quantise = [centre, scale](uint8* pDst, uint8* pSrc, int elemOffset)
+        {
+            float* pFloat = (float*)(pSrc + elemOffset);
+            int16 pShort[4];
+            for (int i = 0; i < 3; i++)
+            {
+                float q = Math::Clamp<float>(std::round((pFloat[i] - centre[i]) * scale[i]), -32767, 32767);
+                pShort[i] = int16(q);
+            }
+            pShort[3] = 32767;
+            memcpy(pDst + elemOffset, pShort, sizeof(pShort));
+        };
+
+        auto vbuf = vertexBufferBinding->getBuffer(elem->getSource());
+
+        size_t newElemSize = VertexElement::getTypeSize(VET_SHORT4_NORM);
+        size_t newVertexSize = vbuf->getVertexSize() - elem->getSize() + newElemSize;
+        auto newVBuf = vbuf->getManager()->createVertexBuffer(newVertexSize, vbuf->getNumVertices(), vbuf->getUsage(),
+                                                              vbuf->hasShadowBuffer());
+        {
+            HardwareBufferLockGuard dst(newVBuf, HardwareBuffer::HBL_DISCARD);
+            auto pDst = static_cast<uint8*>(dst.pData);
+            spliceElement(elem, vbuf, pDst, pDst, newElemSize, quantise);
+        }
+
+        vertexBufferBinding->setBinding(elem->getSource(), newVBuf);
+        updateVertexDeclaration(vertexDeclaration, elem, VET_SHORT4_NORM, elem->getSource());
+    }
+    //-----------------------------------------------------------------------
     void VertexData::prepareForShadowVolume(void)
     {
         /* NOTE
@@ -800,211 +859,24 @@ namespace Ogre {
     }
     //-----------------------------------------------------------------------
     //-----------------------------------------------------------------------
-    // Local Utility class for vertex cache optimizer
-    class Triangle
-    {
-    public:
-        enum EdgeMatchType {
-            AB, BC, CA, ANY, NONE
-        };
-
-        uint32 a, b, c;     
-
-        inline Triangle()
-        {
-        }
-
-        inline Triangle( uint32 ta, uint32 tb, uint32 tc ) 
-            : a( ta ), b( tb ), c( tc )
-        {
-        }
-
-        inline Triangle( uint32 t[3] )
-            : a( t[0] ), b( t[1] ), c( t[2] )
-        {
-        }
-
-        inline Triangle( const Triangle& t )
-            : a( t.a ), b( t.b ), c( t.c )
-        {
-        }
-
-        inline Triangle& operator=(const Triangle& rhs) {
-            a = rhs.a;
-            b = rhs.b;
-            c = rhs.c;
-            return *this;
-        }
-
-        inline bool sharesEdge(const Triangle& t) const
-        {
-            return( (a == t.a && b == t.c) ||
-                    (a == t.b && b == t.a) ||
-                    (a == t.c && b == t.b) ||
-                    (b == t.a && c == t.c) ||
-                    (b == t.b && c == t.a) ||
-                    (b == t.c && c == t.b) ||
-                    (c == t.a && a == t.c) ||
-                    (c == t.b && a == t.a) ||
-                    (c == t.c && a == t.b) );
-        }
-
-        inline bool sharesEdge(const uint32 ea, const uint32 eb, const Triangle& t) const
-        {
-            return( (ea == t.a && eb == t.c) ||
-                    (ea == t.b && eb == t.a) ||
-                    (ea == t.c && eb == t.b) ); 
-        }
-
-        inline bool sharesEdge(const EdgeMatchType edge, const Triangle& t) const
-        {
-            if (edge == AB)
-                return sharesEdge(a, b, t);
-            else if (edge == BC)
-                return sharesEdge(b, c, t);
-            else if (edge == CA)
-                return sharesEdge(c, a, t);
-            else
-                return (edge == ANY) == sharesEdge(t);
-        }
-
-        inline EdgeMatchType endoSharedEdge(const Triangle& t) const
-        {
-            if (sharesEdge(a, b, t)) return AB;
-            if (sharesEdge(b, c, t)) return BC;
-            if (sharesEdge(c, a, t)) return CA;
-            return NONE;
-        }
-
-        inline EdgeMatchType exoSharedEdge(const Triangle& t) const
-        {
-            return t.endoSharedEdge(*this);
-        }
-
-        inline void shiftClockwise()
-        {
-            uint32 t = a;
-            a = c;
-            c = b;
-            b = t;
-        }
-
-        inline void shiftCounterClockwise()
-        {
-            uint32 t = a;
-            a = b;
-            b = c;
-            c = t;
-        }
-    };
-    //-----------------------------------------------------------------------
-    //-----------------------------------------------------------------------
     void IndexData::optimiseVertexCacheTriList(void)
     {
         if (indexBuffer->isLocked()) return;
 
-        void *buffer = indexBuffer->lock(HardwareBuffer::HBL_NORMAL);
-
-        Triangle* triangles;
-
-        size_t nIndexes = indexCount;
-        size_t nTriangles = nIndexes / 3;
-        size_t i, j;
-        uint16 *source = 0;
-
-        if (indexBuffer->getType() == HardwareIndexBuffer::IT_16BIT)
-        {
-            triangles = OGRE_ALLOC_T(Triangle, nTriangles, MEMCATEGORY_GEOMETRY);
-            source = (uint16 *)buffer;
-            uint32 *dest = (uint32 *)triangles;
-            for (i = 0; i < nIndexes; ++i) dest[i] = source[i];
-        }
-        else
-            triangles = static_cast<Triangle*>(buffer);
-
-        // sort triangles based on shared edges
-        uint32 *destlist = OGRE_ALLOC_T(uint32, nTriangles, MEMCATEGORY_GEOMETRY);
-        unsigned char *visited = OGRE_ALLOC_T(unsigned char, nTriangles, MEMCATEGORY_GEOMETRY);
-
-        for (i = 0; i < nTriangles; ++i) visited[i] = 0;
-
-        uint32 start = 0, ti = 0, destcount = 0;
+        size_t indexSize = indexBuffer->getIndexSize();
+        HardwareBufferLockGuard indexLock(indexBuffer, indexStart * indexSize, indexCount * indexSize,
+                                          HardwareBuffer::HBL_NORMAL);
 
-        bool found = false;
-        for (i = 0; i < nTriangles; ++i)
+        if (indexBuffer->getType() == HardwareIndexBuffer::IT_32BIT)
         {
-            if (found)
-                found = false;
-            else
-            {
-                while (visited[start++]);
-                ti = start - 1;
-            }
-
-            destlist[destcount++] = ti;
-            visited[ti] = 1;
-
-            for (j = start; j < nTriangles; ++j)
-            {
-                if (visited[j]) continue;
-                
-                if (triangles[ti].sharesEdge(triangles[j]))
-                {
-                    found = true;
-                    ti = static_cast<uint32>(j);
-                    break;
-                }
-            }
-        }
-
-        if (indexBuffer->getType() == HardwareIndexBuffer::IT_16BIT)
-        {
-            // reorder the indexbuffer
-            j = 0;
-            for (i = 0; i < nTriangles; ++i)
-            {
-                Triangle *t = &triangles[destlist[i]];
-                if(source)
-                {
-                    source[j++] = (uint16)t->a;
-                    source[j++] = (uint16)t->b;
-                    source[j++] = (uint16)t->c;
-                }
-            }
-            OGRE_FREE(triangles, MEMCATEGORY_GEOMETRY);
-        }
-        else
-        {
-            uint32 *reflist = OGRE_ALLOC_T(uint32, nTriangles, MEMCATEGORY_GEOMETRY);
-
-            // fill the referencebuffer
-            for (i = 0; i < nTriangles; ++i)
-                reflist[destlist[i]] = static_cast<uint32>(i);
-            
-            // reorder the indexbuffer
-            for (i = 0; i < nTriangles; ++i)
-            {
-                j = destlist[i];
-                if (i == j) continue; // do not move triangle
-
-                // swap triangles
-
-                Triangle t = triangles[i];
-                triangles[i] = triangles[j];
-                triangles[j] = t;
-
-                // change reference
-                destlist[reflist[i]] = static_cast<uint32>(j);
-                // destlist[i] = i; // not needed, it will not be used
-            }
-
-            OGRE_FREE(reflist, MEMCATEGORY_GEOMETRY);
+            MeshOptimiser::optimiseVertexCache(static_cast<uint32*>(indexLock.pData), indexCount);
+            return;
         }
 
-        OGRE_FREE(destlist, MEMCATEGORY_GEOMETRY);
-        OGRE_FREE(visited, MEMCATEGORY_GEOMETRY);
-                    
-        indexBuffer->unlock();
+        uint16* source = static_cast<uint16*>(indexLock.pData);
+        std::vector<uint32> indexes(source, source + indexCount);
+        MeshOptimiser::optimiseVertexCache(indexes.data(), indexCount);
+        std::copy(indexes.begin(), indexes.end(), source);
     }
     //-----------------------------------------------------------------------
     //-----------------------------------------------------------------------
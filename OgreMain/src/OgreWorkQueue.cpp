@@ -28,6 +28,8 @@ THE SOFTWARE.
 #include "OgreStableHeaders.h"
 #include "OgreWorkQueue.h"
 #include "OgreTimer.h"
+#include "OgreProfileTrace.h"
+#include "OgreEngineStatistics.h"
 
 namespace Ogre {
     void WorkQueue::processMainThreadTasks()
@@ -37,6 +39,75 @@ namespace Ogre {
         OGRE_IGNORE_DEPRECATED_END
     }
     //---------------------------------------------------------------------
+    void WorkQueue::parallelFor(size_t begin, size_t end, const std::function<void(size_t, size_t)>& fn,
+                                size_t grainSize)
+    {
+        if (begin >= end)
+            return;
+
+#if OGRE_THREAD_SUPPORT
+        grainSize = std::max<size_t>(grainSize, 1);
+        size_t numChunks = (end - begin + grainSize - 1) / grainSize;
+        size_t numHelpers = std::min(getWorkerThreadCount(), numChunks - 1);
+        if (numHelpers > 0)
+        {
+            // shared with the helper tasks, which may outlive this call if they are
+            // scheduled late. They only touch fn while a chunk is left to be claimed.
+            struct ParallelForState
+            {
+                std::atomic<size_t> nextChunk{0};
+                std::atomic<size_t> chunksDone{0};
+                std::exception_ptr error;
+                OGRE_WQ_MUTEX(mutex);
+                OGRE_WQ_THREAD_SYNCHRONISER(done);
+            };
+            auto state = std::make_shared<ParallelForState>();
+            const auto* func = &fn;
+
+            auto processChunks = [state, func, begin, end, grainSize, numChunks]()
+            {
+                size_t chunk;
+                while ((chunk = state->nextChunk.fetch_add(1)) < numChunks)
+                {
+                    size_t first = begin + chunk * grainSize;
+                    try
+                    {
+                        (*func)(first, std::min(first + grainSize, end));
+                    }
+                    catch (...)
+                    {
+                        OGRE_WQ_LOCK_MUTEX(state->mutex);
+                        if (!state->error)
+                            state->error = std::current_exception();
+                    }
+
+                    if (state->chunksDone.fetch_add(1) + 1 == numChunks)
+                    {
+                        OGRE_WQ_LOCK_MUTEX(state->mutex);
+                        OGRE_THREAD_NOTIFY_ALL(state->done);
+                    }
+                }
+            };
+
+            for (size_t i = 0; i < numHelpers; ++i)
+                addTask(processChunks);
+
+            processChunks();
+
+            {
+                OGRE_WQ_LOCK_MUTEX_NAMED(state->mutex, lock);
+                while (state->chunksDone.load() < numChunks)
+                    OGRE_THREAD_WAIT(state->done, state->mutex, lock);
+            }
+
+            if (state->error)
+                std::rethrow_exception(state->error);
+            return;
+        }
+#endif
+        fn(begin, end);
+    }
+    //---------------------------------------------------------------------
     WorkQueue::Request::Request(uint16 channel, uint16 rtype, const Any& rData, uint8 retry, RequestID rid)
         : mChannel(channel), mType(rtype), mData(rData), mRetryCount(retry), mID(rid), mAborted(false)
     {
@@ -107,6 +178,16 @@ namespace Ogre {
             return;
 
 #if OGRE_THREAD_SUPPORT
+        if (EngineStatistics::isEnabled())
+        {
+            // measure how long the task waits for a worker
+            uint64 queued = EngineStatistics::getMicroseconds();
+            task = [task, queued]() {
+                EngineStatistics::add(EngineStatistics::SC_WORKQUEUE_LATENCY,
+                                      EngineStatistics::getMicroseconds() - queued);
+                task();
+            };
+        }
         mTasks.push_back(task);
         notifyWorkers();
 #else
@@ -154,6 +235,8 @@ namespace Ogre {
             task = std::move(mTasks.front());
             mTasks.pop_front();
         }
+        OgreTraceScope("WorkQueue::task");
+        EngineStatistics::add(EngineStatistics::SC_WORKQUEUE_TASKS);
         task();
     }
     //---------------------------------------------------------------------
@@ -173,7 +256,10 @@ namespace Ogre {
                 task = std::move(mMainThreadTasks.front());
                 mMainThreadTasks.pop_front();
             }
-            task();
+            {
+                OgreTraceScope("WorkQueue::mainThreadTask");
+                task();
+            }
 
             // time limit
             if (mResposeTimeLimitMS)
@@ -40,6 +40,8 @@ THE SOFTWARE.
 #include <OgrePlugin.h>
 #include <OgreAssimpExports.h>
 
+#include <functional>
+
 struct aiScene;
 struct aiNode;
 struct aiBone;
@@ -75,7 +77,10 @@ public:
         LP_CUT_ANIMATION_WHERE_NO_FURTHER_CHANGE = 1 << 0,
 
         // Quiet mode - don't output anything
-        LP_QUIET_MODE = 1 << 1
+        LP_QUIET_MODE = 1 << 1,
+
+        // Convert the meshes and the animation tracks on the WorkQueue
+        LP_PARALLEL = 1 << 2
     };
 
     struct Options
@@ -99,21 +104,32 @@ public:
               const Options& options = Options());
 
 private:
+    struct SubMeshJob;
+    struct TrackJob;
+
     bool _load(const char* name, Assimp::Importer& importer, Mesh* mesh, SkeletonPtr& skeletonPtr,
                const Options& options);
     bool createSubMesh(const String& name, int index, const aiNode* pNode, const aiMesh* mesh,
-                       const MaterialPtr& matptr, Mesh* mMesh, AxisAlignedBox& mAAB);
+                       const MaterialPtr& matptr, Mesh* mMesh, std::vector<SubMeshJob>& jobs);
+    /// Fills the vertex and index data of a submesh, from any thread
+    static void convertSubMesh(SubMeshJob& job);
     void grabNodeNamesFromNode(const aiScene* mScene, const aiNode* pNode);
     void grabBoneNamesFromNode(const aiScene* mScene, const aiNode* pNode);
     void computeNodesDerivedTransform(const aiScene* mScene, const aiNode* pNode,
                                       const aiMatrix4x4& accTransform);
     void createBonesFromNode(const aiScene* mScene, const aiNode* pNode);
     void createBoneHiearchy(const aiScene* mScene, const aiNode* pNode);
-    AxisAlignedBox loadDataFromNode(const aiScene* mScene, const aiNode* pNode, Mesh* mesh);
+    void loadDataFromNode(const aiScene* mScene, const aiNode* pNode, Mesh* mesh,
+                          std::vector<SubMeshJob>& jobs);
     void markAllChildNodesAsNeeded(const aiNode* pNode);
     void flagNodeAsNeeded(const char* name);
     bool isNodeNeeded(const char* name);
-    void parseAnimation(const aiScene* mScene, int index, aiAnimation* anim);
+    void parseAnimation(const aiScene* mScene, int index, aiAnimation* anim,
+                        std::vector<TrackJob>& tracks);
+    /// Computes the keyframes of a track, from any thread
+    static void convertTrack(TrackJob& track);
+    /// Calls fn for each index in [0, count), on the WorkQueue in parallel mode
+    void forEach(size_t count, const std::function<void(size_t)>& fn);
     typedef std::map<String, bool> boneMapType;
     boneMapType boneMap;
     // aiNode* mSkeletonRootNode;
@@ -135,7 +151,7 @@ private:
     static int msBoneCount;
 
     bool mQuietMode;
-    Real mTicksPerSecond;
+    bool mParallel;
     Real mAnimationSpeedModifier;
 };
 
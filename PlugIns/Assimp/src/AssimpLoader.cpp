@@ -47,6 +47,7 @@ THE SOFTWARE.
 #include <Ogre.h>
 
 #include <OgreCodec.h>
+#include <OgreWorkQueue.h>
 
 #ifdef OGRE_BUILD_COMPONENT_RTSHADERSYSTEM
 #include <OgreShaderGenerator.h>
@@ -331,6 +332,42 @@ String ReplaceSpaces(const String& s)
 }
 } // namespace
 
+/// Submesh created on the main thread, whose buffers are converted by convertSubMesh
+struct AssimpLoader::SubMeshJob
+{
+    const aiMesh* mesh;
+    SubMesh* submesh;
+    Affine3 transform;
+    /// Handle of the Ogre bone of each aiBone of the mesh
+    std::vector<unsigned short> boneHandles;
+
+    /// Converted data, copied to the hardware buffers on the main thread
+    std::vector<float> vertices;
+    std::vector<uchar> indices;
+    AxisAlignedBox aabb;
+};
+
+/// Track created on the main thread, whose keyframes are computed by convertTrack
+struct AssimpLoader::TrackJob
+{
+    aiNodeAnim* channel;
+    NodeAnimationTrack* track;
+    Affine3 defBonePoseInv;
+    Vector3 bonePosition;
+    bool isRootBone;
+    Real ticksPerSecond;
+    Real cutTime;
+
+    struct Key
+    {
+        Real time;
+        Vector3 translate;
+        Quaternion rotation;
+        Vector3 scale;
+    };
+    std::vector<Key> keys;
+};
+
 int AssimpLoader::msBoneCount = 0;
 
 AssimpLoader::AssimpLoader()
@@ -384,6 +421,8 @@ bool AssimpLoader::_load(const char* name, Assimp::Importer& importer, Mesh* mes
             StringConverter::parse(strOpts["postProcessSteps"], postProcessSteps);
         if(strOpts.find("cutAnimation") != strOpts.end())
             mLoaderParams |= LP_CUT_ANIMATION_WHERE_NO_FURTHER_CHANGE;
+        if(strOpts.find("parallel") != strOpts.end())
+            mLoaderParams |= LP_PARALLEL;
     }
 
     uint32 flags = aiProcessPreset_TargetRealtime_Fast | aiProcess_TransformUVCoords | aiProcess_FlipUVs;
@@ -407,6 +446,7 @@ bool AssimpLoader::_load(const char* name, Assimp::Importer& importer, Mesh* mes
     }
 
     mQuietMode = mLoaderParams & LP_QUIET_MODE;
+    mParallel = (mLoaderParams & LP_PARALLEL) && Root::getSingletonPtr();
     mNodeDerivedTransformByName.clear();
 
     String basename, extension;
@@ -428,10 +468,27 @@ bool AssimpLoader::_load(const char* name, Assimp::Importer& importer, Mesh* mes
 
         if (scene->HasAnimations())
         {
+            std::vector<TrackJob> tracks;
             for (unsigned int i = 0; i < scene->mNumAnimations; ++i)
             {
-                parseAnimation(scene, i, scene->mAnimations[i]);
+                parseAnimation(scene, i, scene->mAnimations[i], tracks);
             }
+
+            forEach(tracks.size(), [&tracks](size_t i) { convertTrack(tracks[i]); });
+
+            // creating keyframes touches the parent animation, so do not do it concurrently
+            for (const auto& t : tracks)
+            {
+                for (const auto& key : t.keys)
+                {
+                    TransformKeyFrame* keyframe = t.track->createNodeKeyFrame(key.time);
+                    keyframe->setTranslate(key.translate);
+                    keyframe->setRotation(key.rotation);
+                    keyframe->setScale(key.scale);
+                }
+            }
+
+            mSkeleton->optimiseAllAnimations();
         }
     }
 
@@ -466,7 +523,27 @@ bool AssimpLoader::_load(const char* name, Assimp::Importer& importer, Mesh* mes
         TextureManager::getSingleton().loadImage(texname, mesh->getGroup(), img);
     }
 
-    auto aabb = loadDataFromNode(scene, scene->mRootNode, mesh);
+    std::vector<SubMeshJob> subMeshes;
+    loadDataFromNode(scene, scene->mRootNode, mesh, subMeshes);
+
+    forEach(subMeshes.size(), [&subMeshes](size_t i) { convertSubMesh(subMeshes[i]); });
+
+    AxisAlignedBox aabb;
+    for (auto& job : subMeshes)
+    {
+        // one bulk copy per buffer, as the render system may only be used from this thread
+        auto vbuffer = job.submesh->vertexData->vertexBufferBinding->getBuffer(0);
+        vbuffer->writeData(0, vbuffer->getSizeInBytes(), job.vertices.data(), true);
+        std::vector<float>().swap(job.vertices);
+
+        if (auto ibuffer = job.submesh->indexData->indexBuffer)
+        {
+            ibuffer->writeData(0, ibuffer->getSizeInBytes(), job.indices.data(), true);
+            std::vector<uchar>().swap(job.indices);
+        }
+
+        aabb.merge(job.aabb);
+    }
     // We must indicate the bounding box
     mesh->_setBounds(aabb);
     mesh->_setBoundingSphereRadius((aabb.getMaximum() - aabb.getMinimum()).length() / 2);
@@ -511,7 +588,8 @@ bool AssimpLoader::_load(const char* name, Assimp::Importer& importer, Mesh* mes
     return true;
 }
 
-void AssimpLoader::parseAnimation(const aiScene* mScene, int index, aiAnimation* anim)
+void AssimpLoader::parseAnimation(const aiScene* mScene, int index, aiAnimation* anim,
+                                  std::vector<TrackJob>& tracks)
 {
     // DefBonePose a matrix that represents the local bone transform (can build from Ogre bone components)
     // PoseToKey a matrix representing the keyframe translation
@@ -549,8 +627,8 @@ void AssimpLoader::parseAnimation(const aiScene* mScene, int index, aiAnimation*
                                               StringConverter::toString(anim->mNumChannels));
     }
     Animation* animation;
-    mTicksPerSecond = (Real)((0 == anim->mTicksPerSecond) ? 24 : anim->mTicksPerSecond);
-    mTicksPerSecond *= mAnimationSpeedModifier;
+    Real ticksPerSecond = (Real)((0 == anim->mTicksPerSecond) ? 24 : anim->mTicksPerSecond);
+    ticksPerSecond *= mAnimationSpeedModifier;
 
     Real cutTime = 0.0;
     if (mLoaderParams & LP_CUT_ANIMATION_WHERE_NO_FURTHER_CHANGE)
@@ -568,7 +646,7 @@ void AssimpLoader::parseAnimation(const aiScene* mScene, int index, aiAnimation*
                 if (node_anim->mPositionKeys[j] != node_anim->mPositionKeys[j - 1])
                 {
                     timePos = (Real)node_anim->mPositionKeys[j].mTime;
-                    timePos /= mTicksPerSecond;
+                    timePos /= ticksPerSecond;
                 }
             }
 
@@ -577,7 +655,7 @@ void AssimpLoader::parseAnimation(const aiScene* mScene, int index, aiAnimation*
                 if (node_anim->mRotationKeys[j] != node_anim->mRotationKeys[j - 1])
                 {
                     timeRot = (Real)node_anim->mRotationKeys[j].mTime;
-                    timeRot /= mTicksPerSecond;
+                    timeRot /= ticksPerSecond;
                 }
             }
 
@@ -596,7 +674,7 @@ void AssimpLoader::parseAnimation(const aiScene* mScene, int index, aiAnimation*
     else
     {
         cutTime = Math::POS_INFINITY;
-        animation = mSkeleton->createAnimation(String(animName), Real(anim->mDuration / mTicksPerSecond));
+        animation = mSkeleton->createAnimation(String(animName), Real(anim->mDuration / ticksPerSecond));
     }
 
     animation->setInterpolationMode(Animation::IM_LINEAR); // FIXME: Is this always true?
@@ -606,21 +684,15 @@ void AssimpLoader::parseAnimation(const aiScene* mScene, int index, aiAnimation*
         LogManager::getSingleton().logMessage("Cut Time " + StringConverter::toString(cutTime));
     }
 
+    const String& rootBoneName = mSkeleton->getRootBones()[0]->getName();
+
     for (int i = 0; i < (int)anim->mNumChannels; i++)
     {
-        TransformKeyFrame* keyframe;
-
         aiNodeAnim* node_anim = anim->mChannels[i];
         if (!mQuietMode)
         {
             LogManager::getSingleton().logMessage("Channel " + StringConverter::toString(i));
             LogManager::getSingleton().logMessage("affecting node: " + String(node_anim->mNodeName.data));
-            // LogManager::getSingleton().logMessage("position keys: " +
-            // StringConverter::toString(node_anim->mNumPositionKeys));
-            // LogManager::getSingleton().logMessage("rotation keys: " +
-            // StringConverter::toString(node_anim->mNumRotationKeys));
-            // LogManager::getSingleton().logMessage("scaling keys: " +
-            // StringConverter::toString(node_anim->mNumScalingKeys));
         }
 
         String boneName = String(node_anim->mNodeName.data);
@@ -628,94 +700,96 @@ void AssimpLoader::parseAnimation(const aiScene* mScene, int index, aiAnimation*
         if (mSkeleton->hasBone(boneName))
         {
             Bone* bone = mSkeleton->getBone(boneName);
-            Affine3 defBonePoseInv;
-            defBonePoseInv.makeInverseTransform(bone->getPosition(), bone->getScale(),
-                                                bone->getOrientation());
 
-            NodeAnimationTrack* track = animation->createNodeTrack(bone->getHandle(), bone);
-
-            // Ogre needs translate rotate and scale for each keyframe in the track
-            KeyframesMap keyframes;
+            TrackJob track;
+            track.channel = node_anim;
+            track.track = animation->createNodeTrack(bone->getHandle(), bone);
+            track.defBonePoseInv.makeInverseTransform(bone->getPosition(), bone->getScale(),
+                                                      bone->getOrientation());
+            track.bonePosition = bone->getPosition();
+            track.isRootBone = rootBoneName == boneName;
+            track.ticksPerSecond = ticksPerSecond;
+            track.cutTime = cutTime;
+            tracks.push_back(std::move(track));
+        }
+    }
+}
 
-            for (unsigned int j = 0; j < node_anim->mNumPositionKeys; j++)
-            {
-                keyframes[(Real)node_anim->mPositionKeys[j].mTime / mTicksPerSecond] =
-                    KeyframeData(&(node_anim->mPositionKeys[j]), NULL, NULL);
-            }
+void AssimpLoader::convertTrack(TrackJob& track)
+{
+    aiNodeAnim* node_anim = track.channel;
+    Real ticksPerSecond = track.ticksPerSecond;
 
-            for (unsigned int j = 0; j < node_anim->mNumRotationKeys; j++)
-            {
-                KeyframesMap::iterator it =
-                    keyframes.find((Real)node_anim->mRotationKeys[j].mTime / mTicksPerSecond);
-                if (it != keyframes.end())
-                {
-                    std::get<1>(it->second) = &(node_anim->mRotationKeys[j]);
-                }
-                else
-                {
-                    keyframes[(Real)node_anim->mRotationKeys[j].mTime / mTicksPerSecond] =
-                        KeyframeData(NULL, &(node_anim->mRotationKeys[j]), NULL);
-                }
-            }
+    // Ogre needs translate rotate and scale for each keyframe in the track
+    KeyframesMap keyframes;
 
-            for (unsigned int j = 0; j < node_anim->mNumScalingKeys; j++)
-            {
-                KeyframesMap::iterator it =
-                    keyframes.find((Real)node_anim->mScalingKeys[j].mTime / mTicksPerSecond);
-                if (it != keyframes.end())
-                {
-                    std::get<2>(it->second) = &(node_anim->mScalingKeys[j]);
-                }
-                else
-                {
-                    keyframes[(Real)node_anim->mRotationKeys[j].mTime / mTicksPerSecond] =
-                        KeyframeData(NULL, NULL, &(node_anim->mScalingKeys[j]));
-                }
-            }
+    for (unsigned int j = 0; j < node_anim->mNumPositionKeys; j++)
+    {
+        keyframes[(Real)node_anim->mPositionKeys[j].mTime / ticksPerSecond] =
+            KeyframeData(&(node_anim->mPositionKeys[j]), NULL, NULL);
+    }
 
-            KeyframesMap::iterator it = keyframes.begin();
-            KeyframesMap::iterator it_end = keyframes.end();
-            for (; it != it_end; ++it)
-            {
-                if (it->first < cutTime) // or should it be <=
-                {
-                    aiVector3D aiTrans = getTranslate(node_anim, keyframes, it, mTicksPerSecond);
+    for (unsigned int j = 0; j < node_anim->mNumRotationKeys; j++)
+    {
+        KeyframesMap::iterator it = keyframes.find((Real)node_anim->mRotationKeys[j].mTime / ticksPerSecond);
+        if (it != keyframes.end())
+        {
+            std::get<1>(it->second) = &(node_anim->mRotationKeys[j]);
+        }
+        else
+        {
+            keyframes[(Real)node_anim->mRotationKeys[j].mTime / ticksPerSecond] =
+                KeyframeData(NULL, &(node_anim->mRotationKeys[j]), NULL);
+        }
+    }
 
-                    Vector3 trans(aiTrans.x, aiTrans.y, aiTrans.z);
+    for (unsigned int j = 0; j < node_anim->mNumScalingKeys; j++)
+    {
+        KeyframesMap::iterator it = keyframes.find((Real)node_anim->mScalingKeys[j].mTime / ticksPerSecond);
+        if (it != keyframes.end())
+        {
+            std::get<2>(it->second) = &(node_anim->mScalingKeys[j]);
+        }
+        else
+        {
+            keyframes[(Real)node_anim->mScalingKeys[j].mTime / ticksPerSecond] =
+                KeyframeData(NULL, NULL, &(node_anim->mScalingKeys[j]));
+        }
+    }
 
-                    aiQuaternion aiRot = getRotate(node_anim, keyframes, it, mTicksPerSecond);
-                    Quaternion rot(aiRot.w, aiRot.x, aiRot.y, aiRot.z);
+    KeyframesMap::iterator it = keyframes.begin();
+    KeyframesMap::iterator it_end = keyframes.end();
+    for (; it != it_end; ++it)
+    {
+        if (it->first < track.cutTime) // or should it be <=
+        {
+            aiVector3D aiTrans = getTranslate(node_anim, keyframes, it, ticksPerSecond);
 
-                    aiVector3D aiScale = getScale(node_anim, keyframes, it, mTicksPerSecond);
-                    Vector3 scale(aiScale.x, aiScale.y, aiScale.z);
+            Vector3 trans(aiTrans.x, aiTrans.y, aiTrans.z);
 
-                    Vector3 transCopy = trans;
+            aiQuaternion aiRot = getRotate(node_anim, keyframes, it, ticksPerSecond);
+            Quaternion rot(aiRot.w, aiRot.x, aiRot.y, aiRot.z);
 
-                    Affine3 fullTransform;
-                    fullTransform.makeTransform(trans, scale, rot);
+            aiVector3D aiScale = getScale(node_anim, keyframes, it, ticksPerSecond);
+            Vector3 scale(aiScale.x, aiScale.y, aiScale.z);
 
-                    Affine3 poseTokey = defBonePoseInv * fullTransform;
-                    poseTokey.decomposition(trans, scale, rot);
+            Vector3 transCopy = trans;
 
-                    keyframe = track->createNodeKeyFrame(Real(it->first));
+            Affine3 fullTransform;
+            fullTransform.makeTransform(trans, scale, rot);
 
-                    // weirdness with the root bone, But this seems to work
-                    if (mSkeleton->getRootBones()[0]->getName() == boneName)
-                    {
-                        trans = transCopy - bone->getPosition();
-                    }
+            Affine3 poseTokey = track.defBonePoseInv * fullTransform;
+            poseTokey.decomposition(trans, scale, rot);
 
-                    keyframe->setTranslate(trans);
-                    keyframe->setRotation(rot);
-                    keyframe->setScale(scale);
-                }
+            // weirdness with the root bone, But this seems to work
+            if (track.isRootBone)
+            {
+                trans = transCopy - track.bonePosition;
             }
 
-        } // if bone exists
-
-    } // loop through channels
-
-    mSkeleton->optimiseAllAnimations();
+            track.keys.push_back({Real(it->first), trans, rot, scale});
+        }
+    }
 }
 
 void AssimpLoader::markAllChildNodesAsNeeded(const aiNode* pNode)
@@ -1101,7 +1175,7 @@ static MaterialPtr createMaterial(const aiMaterial* mat, const Ogre::String &gro
 }
 
 bool AssimpLoader::createSubMesh(const String& name, int index, const aiNode* pNode, const aiMesh* mesh,
-                                 const MaterialPtr& matptr, Mesh* mMesh, AxisAlignedBox& mAAB)
+                                 const MaterialPtr& matptr, Mesh* mMesh, std::vector<SubMeshJob>& jobs)
 {
     // if animated all submeshes must have bone weights
     if (mBonesByName.size() && !mesh->HasBones())
@@ -1119,7 +1193,6 @@ bool AssimpLoader::createSubMesh(const String& name, int index, const aiNode* pN
     SubMesh* submesh = mMesh->createSubMesh(name + StringConverter::toString(index));
 
     // prime pointers to vertex related data
-    aiVector3D* vec = mesh->mVertices;
     aiVector3D* norm = mesh->mNormals;
     aiVector3D* uv = mesh->mTextureCoords[0];
     aiVector3D* tang = mesh->mTangents;
@@ -1203,151 +1276,157 @@ bool AssimpLoader::createSubMesh(const String& name, int index, const aiNode* pN
         submesh->vertexData->vertexCount,   // == nbVertices
         HardwareBuffer::HBU_STATIC_WRITE_ONLY);
 
-    Affine3 aiM = mNodeDerivedTransformByName.find(pNode->mName.data)->second;
+    submesh->vertexData->vertexBufferBinding->setBinding(source, vbuffer);
 
-    Matrix3 normalMatrix = aiM.linear().inverse().transpose();
+    SubMeshJob job;
+    job.mesh = mesh;
+    job.submesh = submesh;
+    job.transform = mNodeDerivedTransformByName.find(pNode->mName.data)->second;
 
-    // Now we get access to the buffer to fill it.  During so we record the bounding box.
-    float* vdata = static_cast<float*>(vbuffer->lock(HardwareBuffer::HBL_DISCARD));
-    for (size_t i = 0; i < mesh->mNumVertices; ++i)
+    // resolve the bones here, as the skeleton is not safe to search from several threads
+    for (uint32 i = 0; i < mesh->mNumBones; i++)
     {
-        // Position
-        Vector3 vect(vec->x, vec->y, vec->z);
-        vect = aiM * vect;
+        aiBone* pAIBone = mesh->mBones[i];
+        job.boneHandles.push_back(pAIBone ? mSkeleton->getBone(pAIBone->mName.data)->getHandle() : 0);
+    }
 
-        /*
-        if(NULL != mSkeletonRootNode)
+    if (mesh->mNumFaces > 0)
+    {
+        if (!mQuietMode)
         {
-            vect *= mSkeletonRootNode->mTransformation;
+            LogManager::getSingleton().logMessage(StringConverter::toString(mesh->mNumFaces) + " faces");
         }
-        */
 
-        *vdata++ = vect.x;
-        *vdata++ = vect.y;
-        *vdata++ = vect.z;
-        mAAB.merge(vect);
-        vec++;
+        int faceSz = mesh->mPrimitiveTypes == aiPrimitiveType_LINE ? 2 : 3;
 
-        // Normal
-        if (norm)
-        {
-            vect = normalMatrix * Vector3(norm->x, norm->y, norm->z);
-            vect.normalise();
+        // Creates the index data
+        submesh->indexData->indexStart = 0;
+        submesh->indexData->indexCount = mesh->mNumFaces * faceSz;
+        submesh->indexData->indexBuffer = HardwareBufferManager::getSingleton().createIndexBuffer(
+            mesh->mNumVertices >= 65536 ? HardwareIndexBuffer::IT_32BIT : HardwareIndexBuffer::IT_16BIT,
+            submesh->indexData->indexCount, HardwareBuffer::HBU_STATIC_WRITE_ONLY);
+    }
 
-            *vdata++ = vect.x;
-            *vdata++ = vect.y;
-            *vdata++ = vect.z;
-            norm++;
-        }
+    jobs.push_back(std::move(job));
+    return true;
+}
 
-        // uvs
-        if (uv)
-        {
-            *vdata++ = uv->x;
-            *vdata++ = uv->y;
-            uv++;
-        }
+template <typename T> static void copyFaceIndices(const aiMesh* mesh, int faceSz, T* indexData)
+{
+    const aiFace* faces = mesh->mFaces;
+    for (size_t i = 0; i < mesh->mNumFaces; ++i)
+    {
+        for (int j = 0; j < faceSz; j++)
+            *indexData++ = faces->mIndices[j];
 
-        if(tang)
-        {
-            *vdata++ = tang->x;
-            *vdata++ = tang->y;
-            *vdata++ = tang->z;
-            tang++;
-        }
+        faces++;
+    }
+}
 
-        if (col)
+void AssimpLoader::convertSubMesh(SubMeshJob& job)
+{
+    const aiMesh* mesh = job.mesh;
+    SubMesh* submesh = job.submesh;
+    const VertexDeclaration* declaration = submesh->vertexData->vertexDeclaration;
+    size_t numVertices = mesh->mNumVertices;
+
+    // the buffer is written one attribute at a time, everything is float sized
+    size_t stride = declaration->getVertexSize(0) / sizeof(float);
+    job.vertices.resize(numVertices * stride);
+
+    const Affine3& aiM = job.transform;
+    Vector3 minimum(Math::POS_INFINITY), maximum(Math::NEG_INFINITY);
+    float* vdata = job.vertices.data();
+    for (size_t i = 0; i < numVertices; ++i, vdata += stride)
+    {
+        const aiVector3D& vec = mesh->mVertices[i];
+        Vector3 vect = aiM * Vector3(vec.x, vec.y, vec.z);
+        memcpy(vdata, vect.ptr(), sizeof(float) * 3);
+        minimum.makeFloor(vect);
+        maximum.makeCeil(vect);
+    }
+    if (numVertices > 0)
+        job.aabb.setExtents(minimum, maximum);
+
+    if (auto elem = declaration->findElementBySemantic(VES_NORMAL))
+    {
+        Matrix3 normalMatrix = aiM.linear().inverse().transpose();
+        vdata = job.vertices.data() + elem->getOffset() / sizeof(float);
+        for (size_t i = 0; i < numVertices; ++i, vdata += stride)
         {
-            PixelUtil::packColour(col->r, col->g, col->b, col->a, PF_BYTE_RGBA, vdata++);
-            col++;
+            const aiVector3D& norm = mesh->mNormals[i];
+            Vector3 vect = normalMatrix * Vector3(norm.x, norm.y, norm.z);
+            vect.normalise();
+            memcpy(vdata, vect.ptr(), sizeof(float) * 3);
         }
     }
 
-    vbuffer->unlock();
-    submesh->vertexData->vertexBufferBinding->setBinding(source, vbuffer);
-
-    // set bone weigths
-    if (mesh->HasBones())
+    if (auto elem = declaration->findElementBySemantic(VES_TEXTURE_COORDINATES))
     {
-        for (uint32 i = 0; i < mesh->mNumBones; i++)
+        vdata = job.vertices.data() + elem->getOffset() / sizeof(float);
+        for (size_t i = 0; i < numVertices; ++i, vdata += stride)
         {
-            aiBone* pAIBone = mesh->mBones[i];
-            if (NULL != pAIBone)
-            {
-                String bname = pAIBone->mName.data;
-                for (uint32 weightIdx = 0; weightIdx < pAIBone->mNumWeights; weightIdx++)
-                {
-                    aiVertexWeight aiWeight = pAIBone->mWeights[weightIdx];
-
-                    VertexBoneAssignment vba;
-                    vba.vertexIndex = aiWeight.mVertexId;
-                    vba.boneIndex = mSkeleton->getBone(bname)->getHandle();
-                    vba.weight = aiWeight.mWeight;
-
-                    submesh->addBoneAssignment(vba);
-                }
-            }
+            vdata[0] = mesh->mTextureCoords[0][i].x;
+            vdata[1] = mesh->mTextureCoords[0][i].y;
         }
-    } // if mesh has bones
-
-    if(mesh->mNumFaces == 0)
-        return true;
+    }
 
-    if (!mQuietMode)
+    if (auto elem = declaration->findElementBySemantic(VES_TANGENT))
     {
-        LogManager::getSingleton().logMessage(StringConverter::toString(mesh->mNumFaces) + " faces");
+        vdata = job.vertices.data() + elem->getOffset() / sizeof(float);
+        for (size_t i = 0; i < numVertices; ++i, vdata += stride)
+        {
+            vdata[0] = mesh->mTangents[i].x;
+            vdata[1] = mesh->mTangents[i].y;
+            vdata[2] = mesh->mTangents[i].z;
+        }
     }
 
-    aiFace* faces = mesh->mFaces;
-    int faceSz = mesh->mPrimitiveTypes == aiPrimitiveType_LINE ? 2 : 3;
-
-    // Creates the index data
-    submesh->indexData->indexStart = 0;
-    submesh->indexData->indexCount = mesh->mNumFaces * faceSz;
-
-    if (mesh->mNumVertices >= 65536) // 32 bit index buffer
+    if (auto elem = declaration->findElementBySemantic(VES_DIFFUSE))
     {
-        submesh->indexData->indexBuffer = HardwareBufferManager::getSingleton().createIndexBuffer(
-            HardwareIndexBuffer::IT_32BIT, submesh->indexData->indexCount,
-            HardwareBuffer::HBU_STATIC_WRITE_ONLY);
-
-        uint32* indexData =
-            static_cast<uint32*>(submesh->indexData->indexBuffer->lock(HardwareBuffer::HBL_DISCARD));
-
-        for (size_t i = 0; i < mesh->mNumFaces; ++i)
+        vdata = job.vertices.data() + elem->getOffset() / sizeof(float);
+        for (size_t i = 0; i < numVertices; ++i, vdata += stride)
         {
-            for(int j = 0; j < faceSz; j++)
-                *indexData++ = faces->mIndices[j];
-
-            faces++;
+            const aiColor4D& col = mesh->mColors[0][i];
+            PixelUtil::packColour(col.r, col.g, col.b, col.a, PF_BYTE_RGBA, vdata);
         }
     }
-    else // 16 bit index buffer
-    {
-        submesh->indexData->indexBuffer = HardwareBufferManager::getSingleton().createIndexBuffer(
-            HardwareIndexBuffer::IT_16BIT, submesh->indexData->indexCount,
-            HardwareBuffer::HBU_STATIC_WRITE_ONLY);
-
-        uint16* indexData =
-            static_cast<uint16*>(submesh->indexData->indexBuffer->lock(HardwareBuffer::HBL_DISCARD));
 
-        for (size_t i = 0; i < mesh->mNumFaces; ++i)
+    // set bone weigths
+    for (uint32 i = 0; i < mesh->mNumBones; i++)
+    {
+        aiBone* pAIBone = mesh->mBones[i];
+        if (NULL != pAIBone)
         {
-            for(int j = 0; j < faceSz; j++)
-                *indexData++ = faces->mIndices[j];
+            for (uint32 weightIdx = 0; weightIdx < pAIBone->mNumWeights; weightIdx++)
+            {
+                aiVertexWeight aiWeight = pAIBone->mWeights[weightIdx];
+
+                VertexBoneAssignment vba;
+                vba.vertexIndex = aiWeight.mVertexId;
+                vba.boneIndex = job.boneHandles[i];
+                vba.weight = aiWeight.mWeight;
 
-            faces++;
+                submesh->addBoneAssignment(vba);
+            }
         }
     }
 
-    submesh->indexData->indexBuffer->unlock();
+    const auto& ibuffer = submesh->indexData->indexBuffer;
+    if (!ibuffer)
+        return;
 
-    return true;
+    int faceSz = mesh->mPrimitiveTypes == aiPrimitiveType_LINE ? 2 : 3;
+    job.indices.resize(ibuffer->getSizeInBytes());
+    if (ibuffer->getType() == HardwareIndexBuffer::IT_32BIT)
+        copyFaceIndices(mesh, faceSz, reinterpret_cast<uint32*>(job.indices.data()));
+    else
+        copyFaceIndices(mesh, faceSz, reinterpret_cast<uint16*>(job.indices.data()));
 }
 
-AxisAlignedBox AssimpLoader::loadDataFromNode(const aiScene* mScene, const aiNode* pNode, Mesh* mesh)
+void AssimpLoader::loadDataFromNode(const aiScene* mScene, const aiNode* pNode, Mesh* mesh,
+                                    std::vector<SubMeshJob>& jobs)
 {
-    AxisAlignedBox aabb;
     if (pNode->mNumMeshes > 0)
     {
         for (unsigned int idx = 0; idx < pNode->mNumMeshes; ++idx)
@@ -1362,7 +1441,7 @@ AxisAlignedBox AssimpLoader::loadDataFromNode(const aiScene* mScene, const aiNod
             // Create a material instance for the mesh.
             const aiMaterial* pAIMaterial = mScene->mMaterials[pAIMesh->mMaterialIndex];
             MaterialPtr matptr = createMaterial(pAIMaterial, mesh->getGroup(), mesh->getName(), mScene, !mQuietMode);
-            createSubMesh(pNode->mName.data, idx, pNode, pAIMesh, matptr, mesh, aabb);
+            createSubMesh(pNode->mName.data, idx, pNode, pAIMesh, matptr, mesh, jobs);
         }
     }
 
@@ -1370,10 +1449,23 @@ AxisAlignedBox AssimpLoader::loadDataFromNode(const aiScene* mScene, const aiNod
     for (unsigned int childIdx = 0; childIdx < pNode->mNumChildren; childIdx++)
     {
         const aiNode* pChildNode = pNode->mChildren[childIdx];
-        aabb.merge(loadDataFromNode(mScene, pChildNode, mesh));
+        loadDataFromNode(mScene, pChildNode, mesh, jobs);
+    }
+}
+
+void AssimpLoader::forEach(size_t count, const std::function<void(size_t)>& fn)
+{
+    if (!mParallel)
+    {
+        for (size_t i = 0; i < count; ++i)
+            fn(i);
+        return;
     }
 
-    return aabb;
+    Root::getSingleton().getWorkQueue()->parallelFor(0, count, [&fn](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i)
+            fn(i);
+    });
 }
 
 static std::vector<std::unique_ptr<Codec> > registeredCodecs;
@@ -26,7 +26,8 @@ class SceneNode;
 */
 /** \defgroup DotSceneCodec DotSceneCodec
  *
- * %Codec for loading and saving the SceneNode hierarchy in .scene files.
+ * %Codecs for loading and saving the SceneNode hierarchy in .scene files, and in the binary
+ * .bscene files.
  * @{
  */
 class _OgreDotScenePluginExport DotSceneLoader
@@ -39,9 +40,37 @@ public:
 
     void exportScene(SceneNode* rootNode, const String& outFileName);
 
+    /** Loads a binary .bscene file, as written by exportBinaryScene or convertToBinary.
+
+        It holds the nodes with their entities, lights, cameras and user data, in flat tables
+        which are read without parsing. The meshes and materials of the entities are prepared
+        on the WorkQueue while the tables are read, then the nodes are created in bulk.
+    */
+    void loadBinary(const DataStreamPtr& stream, const String& groupName, SceneNode* rootNode);
+
+    /// Saves the SceneNode hierarchy in the binary .bscene format
+    void exportBinaryScene(SceneNode* rootNode, const String& outFileName);
+
+    /** Converts a .scene file to the binary .bscene format.
+
+        The nodes with their entities, lights, cameras and user data are converted; the
+        environment, terrain, animations and the other elements are skipped with a warning.
+    @return false, with an error in the log, if the .scene file could not be parsed
+    */
+    static bool convertToBinary(const DataStreamPtr& xmlStream, const DataStreamPtr& binaryStream);
+
     const Ogre::ColourValue& getBackgroundColour() { return mBackgroundColour; }
 
 protected:
+    /** Prepares the meshes and materials on the WorkQueue, then loads the meshes, so the entities
+        are created without waiting on the files.
+    */
+    void prefetchResources(const std::set<String>& meshes, const std::set<String>& materials);
+    /// Creates the entity and attaches it, or adds it to its StaticGeometry. NULL on failure.
+    MovableObject* createEntity(const String& name, const String& meshFile, const String& material,
+                                const String& staticGeometry, const String& instanceManager, bool castShadows,
+                                bool visible, SceneNode* pParent);
+
     void writeNode(pugi::xml_node& parentXML, const SceneNode* node);
     void processScene(pugi::xml_node& XMLRoot);
 
@@ -90,6 +119,7 @@ class _OgreDotScenePluginExport DotScenePlugin : public Plugin
     void uninstall() override {}
 private:
     Codec* mCodec;
+    Codec* mBinaryCodec;
 };
 /** @} */
 /** @} */
@@ -1,6 +1,8 @@
 #include <Ogre.h>
 #include <OgreDotSceneLoader.h>
 #include <OgreComponents.h>
+#include <OgreResourceBackgroundQueue.h>
+#include <OgreStreamSerialiser.h>
 
 #ifdef OGRE_BUILD_COMPONENT_TERRAIN
 #include <OgreTerrain.h>
@@ -109,6 +111,649 @@ ColourValue parseColour(pugi::xml_node& XMLNode)
                        XMLNode.attribute("a") != NULL ? StringConverter::parseReal(XMLNode.attribute("a").value()) : 1);
 }
 
+Any parseUserAny(const String& type, const String& data)
+{
+    if (type == "bool")
+        return StringConverter::parseBool(data);
+    else if (type == "float")
+        return StringConverter::parseReal(data);
+    else if (type == "int")
+        return StringConverter::parseInt(data);
+    else
+        return data;
+}
+
+void collectResources(const pugi::xml_node& XMLNode, std::set<String>& meshes, std::set<String>& materials)
+{
+    for (auto pElement : XMLNode.children("entity"))
+    {
+        String meshFile = getAttrib(pElement, "meshFile");
+        if (!meshFile.empty())
+            meshes.insert(meshFile);
+        String material = getAttrib(pElement, "material");
+        if (!material.empty())
+            materials.insert(material);
+    }
+
+    for (auto pElement : XMLNode.children("node"))
+        collectResources(pElement, meshes, materials);
+}
+
+const uint32 BSCENE_CHUNK_ID = StreamSerialiser::makeIdentifier("BSCN");
+const uint16 BSCENE_CHUNK_VERSION = 1;
+/// Parent of the nodes attached to the root node
+const uint32 NO_PARENT = ~uint32(0);
+
+enum BinaryFlags
+{
+    BF_VISIBLE = 1,
+    BF_CAST_SHADOWS = 2,
+    // lights
+    BF_SPOTLIGHT_RANGE = 4,
+    BF_ATTENUATION = 8,
+    BF_SOURCE_SIZE = 16,
+    // cameras
+    BF_CLIPPING = 4
+};
+
+enum PropertyOwner
+{
+    PO_ROOT,
+    PO_NODE,
+    PO_ENTITY,
+    PO_LIGHT,
+    PO_CAMERA
+};
+
+/** Contents of a .bscene file.
+
+    The objects refer to their node, and the nodes to their parent, by index, with the parents
+    coming first. The strings are shared in a table, index 0 being the empty string.
+*/
+struct BinaryScene
+{
+    struct NodeDef
+    {
+        uint32 parent, name;
+        Vector3 position;
+        Quaternion orientation;
+        Vector3 scale;
+    };
+    struct EntityDef
+    {
+        uint32 node, name, meshFile, material, staticGeometry, instanceManager;
+        uint8 flags;
+    };
+    struct LightDef
+    {
+        uint32 node, name;
+        uint8 type, flags;
+        ColourValue diffuse, specular;
+        Real powerScale;
+        /// inner, outer angles in radians and falloff
+        Vector3 spotlightRange;
+        /// range, constant, linear and quadratic
+        Vector4 attenuation;
+        Vector2 sourceSize;
+    };
+    struct CameraDef
+    {
+        uint32 node, name;
+        uint8 projectionType, flags;
+        Real aspectRatio, nearDist, farDist;
+    };
+    struct PropertyDef
+    {
+        uint8 ownerType;
+        uint32 owner, name, type, data;
+    };
+
+    StringVector strings;
+    std::vector<NodeDef> nodes;
+    std::vector<EntityDef> entities;
+    std::vector<LightDef> lights;
+    std::vector<CameraDef> cameras;
+    std::vector<PropertyDef> properties;
+
+    /// Transform of the root node, the <nodes> element of the .scene file
+    bool hasRootTransform;
+    Vector3 rootPosition;
+    Quaternion rootOrientation;
+    Vector3 rootScale;
+
+    BinaryScene()
+        : hasRootTransform(false), rootPosition(Vector3::ZERO), rootOrientation(Quaternion::IDENTITY),
+          rootScale(Vector3::UNIT_SCALE)
+    {
+        addString(BLANKSTRING);
+    }
+
+    uint32 addString(const String& str)
+    {
+        auto it = mStringIndices.emplace(str, uint32(strings.size()));
+        if (it.second)
+            strings.push_back(str);
+        return it.first->second;
+    }
+
+    void addXMLScene(const pugi::xml_node& XMLRoot);
+    void addSceneNode(const SceneNode* n, uint32 parent);
+
+    void write(const DataStreamPtr& stream) const;
+    /// @return false, with an error in the log, if the stream is not a valid .bscene
+    bool read(const DataStreamPtr& stream);
+
+private:
+    std::map<String, uint32> mStringIndices;
+    std::set<String> mSkipped;
+
+    void addXMLNode(const pugi::xml_node& XMLNode, uint32 parent);
+    void addXMLEntity(const pugi::xml_node& XMLNode, uint32 node);
+    void addXMLLight(const pugi::xml_node& XMLNode, uint32 node);
+    void addXMLCamera(const pugi::xml_node& XMLNode, uint32 node);
+    void addXMLUserData(const pugi::xml_node& XMLNode, uint8 ownerType, uint32 owner);
+    void skip(const String& what)
+    {
+        if (mSkipped.insert(what).second)
+            LogManager::getSingleton().logWarning("DotSceneLoader - binary scenes do not hold " + what + ", skipped");
+    }
+    bool isValid() const;
+};
+
+void BinaryScene::addXMLScene(const pugi::xml_node& XMLRoot)
+{
+    for (auto pElement : XMLRoot.children())
+    {
+        if (pElement.type() != pugi::node_element)
+            continue;
+
+        String type = pElement.name();
+        if (type == "userData")
+        {
+            addXMLUserData(pElement, PO_ROOT, 0);
+        }
+        else if (type != "nodes")
+        {
+            skip("<" + type + ">");
+            continue;
+        }
+
+        for (auto pNode : pElement.children())
+        {
+            if (pNode.type() != pugi::node_element)
+                continue;
+
+            String nodeType = pNode.name();
+            if (nodeType == "node")
+                addXMLNode(pNode, NO_PARENT);
+            else if (nodeType == "position")
+                rootPosition = parseVector3(pNode);
+            else if (nodeType == "rotation")
+                rootOrientation = parseQuaternion(pNode);
+            else if (nodeType == "scale")
+                rootScale = parseVector3(pNode);
+            else
+                skip("<" + nodeType + ">");
+
+            hasRootTransform = hasRootTransform || nodeType != "node";
+        }
+    }
+}
+
+void BinaryScene::addXMLNode(const pugi::xml_node& XMLNode, uint32 parent)
+{
+    NodeDef node = {parent, addString(getAttrib(XMLNode, "name")), Vector3::ZERO, Quaternion::IDENTITY,
+                    Vector3::UNIT_SCALE};
+    if (auto pElement = XMLNode.child("position"))
+        node.position = parseVector3(pElement);
+    if (auto pElement = XMLNode.child("rotation"))
+        node.orientation = parseQuaternion(pElement);
+    if (auto pElement = XMLNode.child("scale"))
+        node.scale = parseVector3(pElement);
+
+    uint32 index = uint32(nodes.size());
+    nodes.push_back(node);
+
+    for (auto pElement : XMLNode.children())
+    {
+        if (pElement.type() != pugi::node_element)
+            continue;
+
+        String type = pElement.name();
+        if (type == "node")
+            addXMLNode(pElement, index);
+        else if (type == "entity")
+            addXMLEntity(pElement, index);
+        else if (type == "light")
+            addXMLLight(pElement, index);
+        else if (type == "camera")
+            addXMLCamera(pElement, index);
+        else if (type == "userData")
+            addXMLUserData(pElement, PO_NODE, index);
+        else if (type != "position" && type != "rotation" && type != "scale")
+            skip("<" + type + ">");
+    }
+}
+
+void BinaryScene::addXMLEntity(const pugi::xml_node& XMLNode, uint32 node)
+{
+    uint8 flags = 0;
+    if (getAttribBool(XMLNode, "visible", true))
+        flags |= BF_VISIBLE;
+    if (getAttribBool(XMLNode, "castShadows", true))
+        flags |= BF_CAST_SHADOWS;
+
+    EntityDef entity = {node,
+                        addString(getAttrib(XMLNode, "name")),
+                        addString(getAttrib(XMLNode, "meshFile")),
+                        addString(getAttrib(XMLNode, "material")),
+                        addString(getAttrib(XMLNode, "static")),
+                        addString(getAttrib(XMLNode, "instanced")),
+                        flags};
+    entities.push_back(entity);
+
+    if (auto pElement = XMLNode.child("userData"))
+        addXMLUserData(pElement, PO_ENTITY, uint32(entities.size() - 1));
+}
+
+void BinaryScene::addXMLLight(const pugi::xml_node& XMLNode, uint32 node)
+{
+    LightDef light;
+    light.node = node;
+    light.name = addString(getAttrib(XMLNode, "name"));
+
+    String type = getAttrib(XMLNode, "type");
+    light.type = Light::LT_POINT;
+    if (type == "directional")
+        light.type = Light::LT_DIRECTIONAL;
+    else if (type == "spot")
+        light.type = Light::LT_SPOTLIGHT;
+    else if (type == "rect")
+        light.type = Light::LT_RECTLIGHT;
+
+    light.flags = 0;
+    if (getAttribBool(XMLNode, "visible", true))
+        light.flags |= BF_VISIBLE;
+    if (getAttribBool(XMLNode, "castShadows", true))
+        light.flags |= BF_CAST_SHADOWS;
+    light.powerScale = getAttribReal(XMLNode, "powerScale", 1.0);
+
+    light.diffuse = ColourValue::White;
+    if (auto pElement = XMLNode.child("colourDiffuse"))
+        light.diffuse = parseColour(pElement);
+    light.specular = ColourValue::Black;
+    if (auto pElement = XMLNode.child("colourSpecular"))
+        light.specular = parseColour(pElement);
+
+    light.spotlightRange = Vector3::ZERO;
+    light.attenuation = Vector4::ZERO;
+    light.sourceSize = Vector2::ZERO;
+    if (type != "directional")
+    {
+        if (auto pElement = XMLNode.child("lightRange"))
+        {
+            light.flags |= BF_SPOTLIGHT_RANGE;
+            light.spotlightRange = Vector3(getAttribReal(pElement, "inner"), getAttribReal(pElement, "outer"),
+                                           getAttribReal(pElement, "falloff", 1.0));
+        }
+        if (auto pElement = XMLNode.child("lightAttenuation"))
+        {
+            light.flags |= BF_ATTENUATION;
+            light.attenuation = Vector4(getAttribReal(pElement, "range"), getAttribReal(pElement, "constant"),
+                                        getAttribReal(pElement, "linear"), getAttribReal(pElement, "quadratic"));
+        }
+    }
+    if (type == "rect")
+    {
+        if (auto pElement = XMLNode.child("lightSourceSize"))
+        {
+            light.flags |= BF_SOURCE_SIZE;
+            light.sourceSize = Vector2(getAttribReal(pElement, "width"), getAttribReal(pElement, "height"));
+        }
+    }
+    lights.push_back(light);
+
+    if (auto pElement = XMLNode.child("userData"))
+        addXMLUserData(pElement, PO_LIGHT, uint32(lights.size() - 1));
+}
+
+void BinaryScene::addXMLCamera(const pugi::xml_node& XMLNode, uint32 node)
+{
+    CameraDef camera;
+    camera.node = node;
+    camera.name = addString(getAttrib(XMLNode, "name"));
+    camera.aspectRatio = getAttribReal(XMLNode, "aspectRatio", 1.3333);
+    camera.projectionType =
+        getAttrib(XMLNode, "projectionType") == "orthographic" ? PT_ORTHOGRAPHIC : PT_PERSPECTIVE;
+
+    camera.flags = 0;
+    camera.nearDist = 0;
+    camera.farDist = 0;
+    if (auto pElement = XMLNode.child("clipping"))
+    {
+        camera.flags |= BF_CLIPPING;
+        camera.nearDist = getAttribReal(pElement, "near");
+        camera.farDist = getAttribReal(pElement, "far");
+    }
+    cameras.push_back(camera);
+
+    if (auto pElement = XMLNode.child("userData"))
+        addXMLUserData(pElement, PO_CAMERA, uint32(cameras.size() - 1));
+}
+
+void BinaryScene::addXMLUserData(const pugi::xml_node& XMLNode, uint8 ownerType, uint32 owner)
+{
+    for (auto pElement : XMLNode.children("property"))
+    {
+        PropertyDef property = {ownerType, owner, addString(getAttrib(pElement, "name")),
+                                addString(getAttrib(pElement, "type")), addString(getAttrib(pElement, "data"))};
+        properties.push_back(property);
+    }
+}
+
+void BinaryScene::addSceneNode(const SceneNode* n, uint32 parent)
+{
+    NodeDef node = {parent, addString(n->getName()), n->getPosition(), n->getOrientation(), n->getScale()};
+    uint32 index = uint32(nodes.size());
+    nodes.push_back(node);
+
+    for (auto mo : n->getAttachedObjects())
+    {
+        if (auto c = dynamic_cast<Camera*>(mo))
+        {
+            CameraDef camera = {index, addString(c->getName()), uint8(c->getProjectionType()), BF_CLIPPING,
+                                c->getAspectRatio(), c->getNearClipDistance(), c->getFarClipDistance()};
+            cameras.push_back(camera);
+            continue;
+        }
+
+        if (auto l = dynamic_cast<Light*>(mo))
+        {
+            LightDef light;
+            light.node = index;
+            light.name = addString(l->getName());
+            light.type = uint8(l->getType());
+            light.flags = 0;
+            if (l->isVisible())
+                light.flags |= BF_VISIBLE;
+            if (l->getCastShadows())
+                light.flags |= BF_CAST_SHADOWS;
+            light.diffuse = l->getDiffuseColour();
+            light.specular = l->getSpecularColour();
+            light.powerScale = l->getPowerScale();
+            light.spotlightRange = Vector3(l->getSpotlightInnerAngle().valueRadians(),
+                                           l->getSpotlightOuterAngle().valueRadians(), l->getSpotlightFalloff());
+            light.attenuation = Vector4(l->getAttenuationRange(), l->getAttenuationConstant(),
+                                        l->getAttenuationLinear(), l->getAttenuationQuadric());
+            light.sourceSize = Vector2(l->getSourceSize().x, l->getSourceSize().y);
+            if (l->getType() != Light::LT_DIRECTIONAL)
+                light.flags |= BF_SPOTLIGHT_RANGE | BF_ATTENUATION;
+            if (l->getType() == Light::LT_RECTLIGHT)
+                light.flags |= BF_SOURCE_SIZE;
+            lights.push_back(light);
+            continue;
+        }
+
+        if (auto e = dynamic_cast<Entity*>(mo))
+        {
+            uint8 flags = 0;
+            if (e->isVisible())
+                flags |= BF_VISIBLE;
+            if (e->getCastShadows())
+                flags |= BF_CAST_SHADOWS;
+
+            // Heuristic: assume first submesh is representative
+            uint32 material = 0;
+            auto sub0mat = e->getSubEntity(0)->getMaterial();
+            if (sub0mat != e->getMesh()->getSubMesh(0)->getMaterial())
+                material = addString(sub0mat->getName());
+
+            EntityDef entity = {index, addString(e->getName()), addString(e->getMesh()->getName()), material, 0, 0,
+                                flags};
+            entities.push_back(entity);
+            continue;
+        }
+
+        skip("objects of type " + mo->getMovableType());
+    }
+
+    for (auto c : n->getChildren())
+        addSceneNode(static_cast<SceneNode*>(c), index);
+}
+
+void BinaryScene::write(const DataStreamPtr& stream) const
+{
+    StreamSerialiser serialiser(stream);
+    serialiser.writeChunkBegin(BSCENE_CHUNK_ID, BSCENE_CHUNK_VERSION);
+
+    uint32 count = uint32(strings.size());
+    serialiser.write(&count);
+    for (const auto& str : strings)
+        serialiser.write(&str);
+
+    serialiser.write(&hasRootTransform);
+    serialiser.write(&rootPosition);
+    serialiser.write(&rootOrientation);
+    serialiser.write(&rootScale);
+
+    count = uint32(nodes.size());
+    serialiser.write(&count);
+    for (const auto& node : nodes)
+    {
+        serialiser.write(&node.parent);
+        serialiser.write(&node.name);
+        serialiser.write(&node.position);
+        serialiser.write(&node.orientation);
+        serialiser.write(&node.scale);
+    }
+
+    count = uint32(entities.size());
+    serialiser.write(&count);
+    for (const auto& entity : entities)
+    {
+        serialiser.write(&entity.node);
+        serialiser.write(&entity.name);
+        serialiser.write(&entity.meshFile);
+        serialiser.write(&entity.material);
+        serialiser.write(&entity.staticGeometry);
+        serialiser.write(&entity.instanceManager);
+        serialiser.write(&entity.flags);
+    }
+
+    count = uint32(lights.size());
+    serialiser.write(&count);
+    for (const auto& light : lights)
+    {
+        serialiser.write(&light.node);
+        serialiser.write(&light.name);
+        serialiser.write(&light.type);
+        serialiser.write(&light.flags);
+        serialiser.write(light.diffuse.ptr(), 4);
+        serialiser.write(light.specular.ptr(), 4);
+        serialiser.write(&light.powerScale);
+        serialiser.write(&light.spotlightRange);
+        serialiser.write(&light.attenuation);
+        serialiser.write(&light.sourceSize);
+    }
+
+    count = uint32(cameras.size());
+    serialiser.write(&count);
+    for (const auto& camera : cameras)
+    {
+        serialiser.write(&camera.node);
+        serialiser.write(&camera.name);
+        serialiser.write(&camera.projectionType);
+        serialiser.write(&camera.flags);
+        serialiser.write(&camera.aspectRatio);
+        serialiser.write(&camera.nearDist);
+        serialiser.write(&camera.farDist);
+    }
+
+    count = uint32(properties.size());
+    serialiser.write(&count);
+    for (const auto& property : properties)
+    {
+        serialiser.write(&property.ownerType);
+        serialiser.write(&property.owner);
+        serialiser.write(&property.name);
+        serialiser.write(&property.type);
+        serialiser.write(&property.data);
+    }
+
+    serialiser.writeChunkEnd(BSCENE_CHUNK_ID);
+}
+
+/// Reads the size of a table, which can not have more records than bytes left in the stream
+bool readCount(StreamSerialiser& serialiser, const DataStreamPtr& stream, uint32& count)
+{
+    serialiser.read(&count);
+    return count <= stream->size() - stream->tell();
+}
+
+bool BinaryScene::read(const DataStreamPtr& stream)
+{
+    StreamSerialiser serialiser(stream);
+    const StreamSerialiser::Chunk* chunk;
+    try
+    {
+        chunk = serialiser.readChunkBegin();
+    }
+    catch (const Exception& e)
+    {
+        LogManager::getSingleton().logError("DotSceneLoader - " + e.getDescription());
+        return false;
+    }
+
+    if (chunk->id != BSCENE_CHUNK_ID || chunk->version != BSCENE_CHUNK_VERSION)
+    {
+        LogManager::getSingleton().logError("DotSceneLoader - Invalid .bscene file " + stream->getName());
+        return false;
+    }
+
+    uint32 count;
+    bool valid = readCount(serialiser, stream, count);
+    strings.resize(valid ? count : 0);
+    for (auto& str : strings)
+        serialiser.read(&str);
+
+    serialiser.read(&hasRootTransform);
+    serialiser.read(&rootPosition);
+    serialiser.read(&rootOrientation);
+    serialiser.read(&rootScale);
+
+    valid = valid && readCount(serialiser, stream, count);
+    nodes.resize(valid ? count : 0);
+    for (auto& node : nodes)
+    {
+        serialiser.read(&node.parent);
+        serialiser.read(&node.name);
+        serialiser.read(&node.position);
+        serialiser.read(&node.orientation);
+        serialiser.read(&node.scale);
+    }
+
+    valid = valid && readCount(serialiser, stream, count);
+    entities.resize(valid ? count : 0);
+    for (auto& entity : entities)
+    {
+        serialiser.read(&entity.node);
+        serialiser.read(&entity.name);
+        serialiser.read(&entity.meshFile);
+        serialiser.read(&entity.material);
+        serialiser.read(&entity.staticGeometry);
+        serialiser.read(&entity.instanceManager);
+        serialiser.read(&entity.flags);
+    }
+
+    valid = valid && readCount(serialiser, stream, count);
+    lights.resize(valid ? count : 0);
+    for (auto& light : lights)
+    {
+        serialiser.read(&light.node);
+        serialiser.read(&light.name);
+        serialiser.read(&light.type);
+        serialiser.read(&light.flags);
+        serialiser.read(light.diffuse.ptr(), 4);
+        serialiser.read(light.specular.ptr(), 4);
+        serialiser.read(&light.powerScale);
+        serialiser.read(&light.spotlightRange);
+        serialiser.read(&light.attenuation);
+        serialiser.read(&light.sourceSize);
+    }
+
+    valid = valid && readCount(serialiser, stream, count);
+    cameras.resize(valid ? count : 0);
+    for (auto& camera : cameras)
+    {
+        serialiser.read(&camera.node);
+        serialiser.read(&camera.name);
+        serialiser.read(&camera.projectionType);
+        serialiser.read(&camera.flags);
+        serialiser.read(&camera.aspectRatio);
+        serialiser.read(&camera.nearDist);
+        serialiser.read(&camera.farDist);
+    }
+
+    valid = valid && readCount(serialiser, stream, count);
+    properties.resize(valid ? count : 0);
+    for (auto& property : properties)
+    {
+        serialiser.read(&property.ownerType);
+        serialiser.read(&property.owner);
+        serialiser.read(&property.name);
+        serialiser.read(&property.type);
+        serialiser.read(&property.data);
+    }
+
+    if (!valid || !isValid())
+    {
+        LogManager::getSingleton().logError("DotSceneLoader - Corrupted .bscene file " + stream->getName());
+        return false;
+    }
+
+    serialiser.readChunkEnd(BSCENE_CHUNK_ID);
+    return true;
+}
+
+bool BinaryScene::isValid() const
+{
+    uint32 numStrings = uint32(strings.size());
+    if (!numStrings || !strings[0].empty())
+        return false;
+
+    for (size_t i = 0; i < nodes.size(); ++i)
+    {
+        if ((nodes[i].parent != NO_PARENT && nodes[i].parent >= i) || nodes[i].name >= numStrings)
+            return false;
+    }
+    for (const auto& entity : entities)
+    {
+        if (entity.node >= nodes.size() || entity.name >= numStrings || entity.meshFile >= numStrings ||
+            entity.material >= numStrings || entity.staticGeometry >= numStrings ||
+            entity.instanceManager >= numStrings)
+            return false;
+    }
+    for (const auto& light : lights)
+    {
+        if (light.node >= nodes.size() || light.name >= numStrings || light.type > Light::LT_RECTLIGHT)
+            return false;
+    }
+    for (const auto& camera : cameras)
+    {
+        if (camera.node >= nodes.size() || camera.name >= numStrings || camera.projectionType > PT_PERSPECTIVE)
+            return false;
+    }
+
+    const size_t numOwners[] = {1, nodes.size(), entities.size(), lights.size(), cameras.size()};
+    for (const auto& property : properties)
+    {
+        if (property.ownerType > PO_CAMERA || property.owner >= numOwners[property.ownerType] ||
+            property.name >= numStrings || property.type >= numStrings || property.data >= numStrings)
+            return false;
+    }
+    return true;
+}
+
 struct DotSceneCodec : public Codec
 {
     String magicNumberToFileExt(const char* magicNumberPtr, size_t maxbytes) const override { return ""; }
@@ -128,6 +773,24 @@ struct DotSceneCodec : public Codec
     }
 };
 
+struct DotSceneBinaryCodec : public Codec
+{
+    String magicNumberToFileExt(const char* magicNumberPtr, size_t maxbytes) const override { return ""; }
+    String getType() const override { return "bscene"; }
+    void decode(const DataStreamPtr& stream, const Any& output) const override
+    {
+        DotSceneLoader loader;
+        loader.loadBinary(stream, ResourceGroupManager::getSingleton().getWorldResourceGroupName(),
+                          any_cast<SceneNode*>(output));
+    }
+
+    void encodeToFile(const Any& input, const String& outFileName) const override
+    {
+        DotSceneLoader loader;
+        loader.exportBinaryScene(any_cast<SceneNode*>(input), outFileName);
+    }
+};
+
 } // namespace
 
 DotSceneLoader::DotSceneLoader() : mSceneMgr(0), mBackgroundColour(ColourValue::Black) {}
@@ -161,10 +824,237 @@ void DotSceneLoader::load(DataStreamPtr& stream, const String& groupName, SceneN
     // figure out where to attach any nodes we create
     mAttachNode = rootNode;
 
+    // Load the meshes and materials of the entities in the background
+    std::set<String> meshes, materials;
+    if (auto pElement = XMLRoot.child("nodes"))
+        collectResources(pElement, meshes, materials);
+    prefetchResources(meshes, materials);
+
     // Process the scene
     processScene(XMLRoot);
 }
 
+void DotSceneLoader::loadBinary(const DataStreamPtr& stream, const String& groupName, SceneNode* rootNode)
+{
+    m_sGroupName = groupName;
+    mSceneMgr = rootNode->getCreator();
+    mAttachNode = rootNode;
+
+    BinaryScene scene;
+    if (!scene.read(stream))
+        return;
+
+    LogManager::getSingleton().logMessage(StringUtil::format(
+        "[DotSceneLoader] Loading binary scene with %zu nodes and %zu entities", scene.nodes.size(),
+        scene.entities.size()));
+
+    // Load the meshes and materials of the entities in the background
+    std::set<String> meshes, materials;
+    for (const auto& def : scene.entities)
+    {
+        if (def.meshFile)
+            meshes.insert(scene.strings[def.meshFile]);
+        if (def.material)
+            materials.insert(scene.strings[def.material]);
+    }
+    prefetchResources(meshes, materials);
+
+    // Create the whole hierarchy first, the parents come before their children
+    std::vector<SceneNode*> nodes(scene.nodes.size());
+    for (size_t i = 0; i < nodes.size(); ++i)
+    {
+        const auto& def = scene.nodes[i];
+        SceneNode* pParent = def.parent == NO_PARENT ? mAttachNode : nodes[def.parent];
+        if (def.name)
+            nodes[i] = pParent->createChildSceneNode(scene.strings[def.name], def.position, def.orientation);
+        else
+            nodes[i] = pParent->createChildSceneNode(def.position, def.orientation);
+        nodes[i]->setScale(def.scale);
+        nodes[i]->setInitialState();
+    }
+
+    std::vector<MovableObject*> entities(scene.entities.size());
+    for (size_t i = 0; i < entities.size(); ++i)
+    {
+        const auto& def = scene.entities[i];
+        entities[i] = createEntity(scene.strings[def.name], scene.strings[def.meshFile], scene.strings[def.material],
+                                   scene.strings[def.staticGeometry], scene.strings[def.instanceManager],
+                                   (def.flags & BF_CAST_SHADOWS) != 0, (def.flags & BF_VISIBLE) != 0, nodes[def.node]);
+    }
+
+    std::vector<Light*> lights(scene.lights.size());
+    for (size_t i = 0; i < lights.size(); ++i)
+    {
+        const auto& def = scene.lights[i];
+        Light* pLight = mSceneMgr->createLight(scene.strings[def.name]);
+        nodes[def.node]->attachObject(pLight);
+
+        pLight->setType(Light::LightTypes(def.type));
+        pLight->setVisible((def.flags & BF_VISIBLE) != 0);
+        pLight->setCastShadows((def.flags & BF_CAST_SHADOWS) != 0);
+        pLight->setPowerScale(def.powerScale);
+        pLight->setDiffuseColour(def.diffuse);
+        pLight->setSpecularColour(def.specular);
+        if (def.flags & BF_SPOTLIGHT_RANGE)
+            pLight->setSpotlightRange(Radian(def.spotlightRange.x), Radian(def.spotlightRange.y),
+                                      def.spotlightRange.z);
+        if (def.flags & BF_ATTENUATION)
+            pLight->setAttenuation(def.attenuation.x, def.attenuation.y, def.attenuation.z, def.attenuation.w);
+        if (def.flags & BF_SOURCE_SIZE)
+            pLight->setSourceSize(def.sourceSize.x, def.sourceSize.y);
+        lights[i] = pLight;
+    }
+
+    std::vector<Camera*> cameras(scene.cameras.size());
+    for (size_t i = 0; i < cameras.size(); ++i)
+    {
+        const auto& def = scene.cameras[i];
+        Camera* pCamera = mSceneMgr->createCamera(scene.strings[def.name]);
+        nodes[def.node]->attachObject(pCamera);
+
+        pCamera->setAspectRatio(def.aspectRatio);
+        pCamera->setProjectionType(ProjectionType(def.projectionType));
+        if (def.flags & BF_CLIPPING)
+        {
+            pCamera->setNearClipDistance(def.nearDist);
+            pCamera->setFarClipDistance(def.farDist);
+        }
+        cameras[i] = pCamera;
+    }
+
+    for (const auto& def : scene.properties)
+    {
+        UserObjectBindings* userData = NULL;
+        switch (def.ownerType)
+        {
+        case PO_ROOT:
+            userData = &mAttachNode->getUserObjectBindings();
+            break;
+        case PO_NODE:
+            userData = &nodes[def.owner]->getUserObjectBindings();
+            break;
+        case PO_ENTITY:
+            // NULL if the entity could not be created
+            if (entities[def.owner])
+                userData = &entities[def.owner]->getUserObjectBindings();
+            break;
+        case PO_LIGHT:
+            userData = &lights[def.owner]->getUserObjectBindings();
+            break;
+        case PO_CAMERA:
+            userData = &static_cast<MovableObject*>(cameras[def.owner])->getUserObjectBindings();
+            break;
+        }
+
+        if (userData)
+            userData->setUserAny(scene.strings[def.name], parseUserAny(scene.strings[def.type], scene.strings[def.data]));
+    }
+
+    // Like the <nodes> element, transforms the root node once its children were added
+    if (scene.hasRootTransform)
+    {
+        mAttachNode->setPosition(scene.rootPosition);
+        mAttachNode->setOrientation(scene.rootOrientation);
+        mAttachNode->setScale(scene.rootScale);
+        mAttachNode->setInitialState();
+    }
+}
+
+void DotSceneLoader::prefetchResources(const std::set<String>& meshes, const std::set<String>& materials)
+{
+    // The worker threads prepare the resources, that is read their files, while this thread
+    // loads them in turn. It does not wait for the queue, so it never stalls if nobody runs it.
+    auto queue = ResourceBackgroundQueue::getSingletonPtr();
+    bool inBackground = queue && Root::getSingleton().getWorkQueue()->getRequestsAccepted();
+
+    size_t numMaterials = 0;
+    auto prepareMaterial = [&](const String& name)
+    {
+        auto material = MaterialManager::getSingleton().getByName(name, m_sGroupName);
+        if (!material || material->isPrepared() || material->isLoaded())
+            return;
+        if (inBackground)
+            queue->prepare(material);
+        numMaterials++;
+    };
+
+    std::vector<MeshPtr> pendingMeshes;
+    for (const auto& name : meshes)
+    {
+        auto mesh = static_pointer_cast<Mesh>(MeshManager::getSingleton().createOrRetrieve(name, m_sGroupName).first);
+        if (mesh->isLoaded())
+            continue;
+        if (inBackground && !mesh->isPrepared())
+            queue->prepare(mesh);
+        pendingMeshes.push_back(mesh);
+    }
+
+    for (const auto& name : materials)
+        prepareMaterial(name);
+
+    // Waits only for the meshes a worker is preparing, and reads the others
+    std::set<String> subMeshMaterials;
+    for (const auto& mesh : pendingMeshes)
+    {
+        try
+        {
+            mesh->load();
+        }
+        catch (const Exception&)
+        {
+            // reported when creating the entity
+            continue;
+        }
+
+        for (auto sm : mesh->getSubMeshes())
+        {
+            if (!materials.count(sm->getMaterialName()))
+                subMeshMaterials.insert(sm->getMaterialName());
+        }
+    }
+
+    for (const auto& name : subMeshMaterials)
+        prepareMaterial(name);
+
+    LogManager::getSingleton().logMessage(
+        StringUtil::format("[DotSceneLoader] Prefetched %zu meshes and %zu materials", pendingMeshes.size(),
+                           numMaterials),
+        LML_TRIVIAL);
+}
+
+void DotSceneLoader::exportBinaryScene(SceneNode* rootNode, const String& outFileName)
+{
+    BinaryScene scene;
+    for (auto c : rootNode->getChildren())
+        scene.addSceneNode(static_cast<SceneNode*>(c), NO_PARENT);
+
+    scene.write(Root::createFileStream(outFileName, RGN_DEFAULT, true));
+}
+
+bool DotSceneLoader::convertToBinary(const DataStreamPtr& xmlStream, const DataStreamPtr& binaryStream)
+{
+    pugi::xml_document XMLDoc; // character type defaults to char
+
+    auto result = XMLDoc.load_buffer(xmlStream->getAsString().c_str(), xmlStream->size());
+    if (!result)
+    {
+        LogManager::getSingleton().logError("DotSceneLoader - " + String(result.description()));
+        return false;
+    }
+
+    auto XMLRoot = XMLDoc.child("scene");
+    if (!XMLRoot.attribute("formatVersion"))
+    {
+        LogManager::getSingleton().logError("DotSceneLoader - Invalid .scene File. Missing <scene formatVersion='x.y' >");
+        return false;
+    }
+
+    BinaryScene scene;
+    scene.addXMLScene(XMLRoot);
+    scene.write(binaryStream);
+    return true;
+}
+
 void DotSceneLoader::processScene(pugi::xml_node& XMLRoot)
 {
     // Process the scene parameters
@@ -620,60 +1510,72 @@ void DotSceneLoader::processEntity(pugi::xml_node& XMLNode, SceneNode* pParent)
     bool castShadows = getAttribBool(XMLNode, "castShadows", true);
     bool visible = getAttribBool(XMLNode, "visible", true);
 
+    MovableObject* pEntity =
+        createEntity(name, meshFile, material, staticGeometry, instancedManager, castShadows, visible, pParent);
+    if (!pEntity)
+        return;
+
+    // Process userDataReference (?)
+    if (auto pElement = XMLNode.child("userData"))
+        processUserData(pElement, pEntity->getUserObjectBindings());
+}
+
+MovableObject* DotSceneLoader::createEntity(const String& name, const String& meshFile, const String& material,
+                                            const String& staticGeometry, const String& instancedManager,
+                                            bool castShadows, bool visible, SceneNode* pParent)
+{
     // Create the entity
-	MovableObject* pEntity = 0;
+    MovableObject* pEntity = 0;
 
     try
     {
-		// If the Entity is instanced then the creation path is different
-		if (!instancedManager.empty())
-		{
-			LogManager::getSingleton().logMessage("[DotSceneLoader] Adding entity: " + name + " to Instance Manager: " + instancedManager, LML_TRIVIAL);
-
-			// Load the Mesh to get the material name of the first submesh
-			Ogre::MeshPtr mesh = MeshManager::getSingletonPtr()->load(meshFile, m_sGroupName);
-
-			// Get the material name of the entity
-			if(!material.empty())
-				pEntity = mSceneMgr->createInstancedEntity(material, instancedManager);
-			else
-				pEntity = mSceneMgr->createInstancedEntity(mesh->getSubMesh(0)->getMaterialName(), instancedManager);
-
-			pParent->attachObject(static_cast<InstancedEntity*>(pEntity));
-		}
-		else
-		{
-			pEntity = mSceneMgr->createEntity(name, meshFile, m_sGroupName);
-
-			static_cast<Entity*>(pEntity)->setCastShadows(castShadows);
-			static_cast<Entity*>(pEntity)->setVisible(visible);
-
-			if (!material.empty())
-				static_cast<Entity*>(pEntity)->setMaterialName(material);
-
-			// If the Entity belongs to a Static Geometry group then it doesn't get attached to a node
-			// * TODO * : Clean up nodes without attached entities or children nodes? (should be done afterwards if the hierarchy is being processed)
-			if (!staticGeometry.empty())
-			{
-				LogManager::getSingleton().logMessage("[DotSceneLoader] Adding entity: " + name + " to Static Group: " + staticGeometry, LML_TRIVIAL);
-				mSceneMgr->getStaticGeometry(staticGeometry)->addEntity(static_cast<Entity*>(pEntity), pParent->_getDerivedPosition(), pParent->_getDerivedOrientation(), pParent->_getDerivedScale());
-			}
-			else
-			{
-				LogManager::getSingleton().logMessage("[DotSceneLoader] pParent->attachObject(): " + name, LML_TRIVIAL);
-				pParent->attachObject(static_cast<Entity*>(pEntity));
-			}
-		}
+        // If the Entity is instanced then the creation path is different
+        if (!instancedManager.empty())
+        {
+            LogManager::getSingleton().logMessage("[DotSceneLoader] Adding entity: " + name + " to Instance Manager: " + instancedManager, LML_TRIVIAL);
+
+            // Load the Mesh to get the material name of the first submesh
+            Ogre::MeshPtr mesh = MeshManager::getSingletonPtr()->load(meshFile, m_sGroupName);
+
+            // Get the material name of the entity
+            if(!material.empty())
+                pEntity = mSceneMgr->createInstancedEntity(material, instancedManager);
+            else
+                pEntity = mSceneMgr->createInstancedEntity(mesh->getSubMesh(0)->getMaterialName(), instancedManager);
+
+            pParent->attachObject(static_cast<InstancedEntity*>(pEntity));
+        }
+        else
+        {
+            pEntity = mSceneMgr->createEntity(name, meshFile, m_sGroupName);
+
+            static_cast<Entity*>(pEntity)->setCastShadows(castShadows);
+            static_cast<Entity*>(pEntity)->setVisible(visible);
+
+            if (!material.empty())
+                static_cast<Entity*>(pEntity)->setMaterialName(material);
+
+            // If the Entity belongs to a Static Geometry group then it doesn't get attached to a node
+            // * TODO * : Clean up nodes without attached entities or children nodes? (should be done afterwards if the hierarchy is being processed)
+            if (!staticGeometry.empty())
+            {
+                LogManager::getSingleton().logMessage("[DotSceneLoader] Adding entity: " + name + " to Static Group: " + staticGeometry, LML_TRIVIAL);
+                mSceneMgr->getStaticGeometry(staticGeometry)->addEntity(static_cast<Entity*>(pEntity), pParent->_getDerivedPosition(), pParent->_getDerivedOrientation(), pParent->_getDerivedScale());
+            }
+            else
+            {
+                LogManager::getSingleton().logMessage("[DotSceneLoader] pParent->attachObject(): " + name, LML_TRIVIAL);
+                pParent->attachObject(static_cast<Entity*>(pEntity));
+            }
+        }
     }
     catch (const Exception& e)
     {
         LogManager::getSingleton().logError("DotSceneLoader - " + e.getDescription());
-        return;
+        return 0;
     }
 
-    // Process userDataReference (?)
-    if (auto pElement = XMLNode.child("userData"))
-        processUserData(pElement, pEntity->getUserObjectBindings());
+    return pEntity;
 }
 
 void DotSceneLoader::processParticleSystem(pugi::xml_node& XMLNode, SceneNode* pParent)
@@ -873,17 +1775,7 @@ void DotSceneLoader::processUserData(pugi::xml_node& XMLNode, UserObjectBindings
         String type = getAttrib(pElement, "type");
         String data = getAttrib(pElement, "data");
 
-        Any value;
-        if (type == "bool")
-            value = StringConverter::parseBool(data);
-        else if (type == "float")
-            value = StringConverter::parseReal(data);
-        else if (type == "int")
-            value = StringConverter::parseInt(data);
-        else
-            value = data;
-
-        userData.setUserAny(name, value);
+        userData.setUserAny(name, parseUserAny(type, data));
     }
 }
 
@@ -1128,9 +2020,13 @@ const Ogre::String& DotScenePlugin::getName() const {
 void DotScenePlugin::initialise() {
     mCodec = new DotSceneCodec();
     Codec::registerCodec(mCodec);
+    mBinaryCodec = new DotSceneBinaryCodec();
+    Codec::registerCodec(mBinaryCodec);
 }
 
 void DotScenePlugin::shutdown() {
+    Codec::unregisterCodec(mBinaryCodec);
+    delete mBinaryCodec;
     Codec::unregisterCodec(mCodec);
     delete mCodec;
 }
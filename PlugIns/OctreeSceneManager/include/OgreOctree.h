@@ -74,8 +74,18 @@ public:
     void _addNode( OctreeNode * );
 
     /** Removes an Octree scene node to this octree level.
+
+    @param keepOrder if false, the last node takes the place of the removed one, which
+        takes constant time
     */
-    void _removeNode( OctreeNode * );
+    void _removeNode( OctreeNode *, bool keepOrder = true );
+
+    /** Moves an Octree scene node from this octree level to another one.
+
+    The last node takes the place of the moved one, and only the counts of the octrees
+    up to the first common parent are updated.
+    */
+    void _moveNode( OctreeNode *, Octree *target );
 
     /** Returns the number of scene nodes attached to this octree
     */
@@ -84,6 +94,13 @@ public:
         return mNumNodes;
     };
 
+    /** Returns the parent of this octree, null for the root
+    */
+    Octree * getParent() const
+    {
+        return mParent;
+    }
+
     /** The bounding box of the octree
 
     This is used for octant index determination and rendering, but not culling
@@ -99,6 +116,10 @@ public:
     */
     Vector3 mHalfSize;
 
+    /** Depth of this octree, 0 for the root
+    */
+    int mDepth;
+
     /** 3D array of children of this octree.
 
     Children are dynamically created as needed when nodes are inserted in the Octree.
@@ -92,6 +92,20 @@ public:
         mOctant = o;
     };
 
+    /** Returns the index of this OctreeNode in the node list of its Octree
+    */
+    size_t _getOctantIndex() const
+    {
+        return mOctantIndex;
+    }
+
+    /** Sets the index of this OctreeNode in the node list of its Octree
+    */
+    void _setOctantIndex( size_t index )
+    {
+        mOctantIndex = index;
+    }
+
     /** Determines if the center of this node is within the given box
     */
     bool _isIn( AxisAlignedBox &box );
@@ -136,6 +150,8 @@ protected:
 
     ///Octree this node is attached to.
     Octree *mOctant;
+    ///Index of this node in the node list of mOctant.
+    size_t mOctantIndex;
 
     /// Preallocated corners for rendering
     Real mCorners[ 24 ];
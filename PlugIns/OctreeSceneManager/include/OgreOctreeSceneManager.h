@@ -124,6 +124,9 @@ public:
     /** Adds the Octree Node, starting at the given octree, and recursing at max to the specified depth.
     */
     void _addOctreeNode( OctreeNode *, Octree *octree, int depth = 0 );
+    /** Returns the given child of the octree, creating it if needed.
+    */
+    Octree * _getChildOctant( Octree *octree, int x, int y, int z );
 
     /** Recurses the octree, adding any nodes intersecting with the box into the given list.
     It ignores the exclude scene node.
@@ -160,6 +163,9 @@ public:
         "Size", AxisAlignedBox *;
         "Depth", int *;
         "ShowOctree", bool *;
+        "Loose", bool *: keeps the moving nodes in their octant while they fit in its
+        culling bounds, and moves the others from their octant up only as far as needed,
+        rather than from the root. Much cheaper when many nodes move.
     */
 
     bool setOption( const String &, const void * ) override;
@@ -182,6 +188,9 @@ public:
 
 protected:
 
+    /** Moves the given OctreeNode, which is in an octant, in "Loose" mode.
+    */
+    void _updateLooseOctreeNode( OctreeNode * );
 
     Octree::NodeList mVisible;
 
@@ -202,6 +211,9 @@ protected:
     /// Boxes visibility flag
     bool mShowBoxes;
 
+    /// Whether the nodes are updated as in a loose octree, see setOption
+    bool mLoose;
+
     Real mCorners[ 24 ];
     static unsigned long mColors[ 8 ];
     static unsigned short mIndexes[ 24 ];
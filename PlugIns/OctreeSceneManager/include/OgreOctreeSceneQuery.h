@@ -42,6 +42,8 @@ email                : janders@users.sf.net
 
 namespace Ogre
 {
+class Octree;
+
 /** \addtogroup Plugins Plugins
 *  @{
 */
@@ -67,6 +69,12 @@ public:
     ~OctreeRaySceneQuery();
 
     void execute(RaySceneQueryListener* listener) override;
+    void executeBatch(const Ray* rays, size_t count, RaySceneQueryResultEntry* results,
+                      bool parallel = false) override;
+
+private:
+    /// Casts the packet through the octant and its children
+    void castPacket(RayPacket& packet, Octree* octant, RaySceneQueryResultEntry* results) const;
 };
 /** Octree implementation of SphereSceneQuery. */
 class _OgreOctreePluginExport OctreeSphereSceneQuery : public DefaultSphereSceneQuery
@@ -100,6 +100,7 @@ Octree::Octree( Octree * parent )
 
     mParent = parent;
     mNumNodes = 0;
+    mDepth = parent ? parent -> mDepth + 1 : 0;
 }
 
 Octree::~Octree()
@@ -125,6 +126,7 @@ Octree::~Octree()
 
 void Octree::_addNode( OctreeNode * n )
 {
+    n -> _setOctantIndex( mNodes.size() );
     mNodes.push_back( n );
     n -> setOctant( this );
 
@@ -133,15 +135,59 @@ void Octree::_addNode( OctreeNode * n )
 
 }
 
-void Octree::_removeNode( OctreeNode * n )
+void Octree::_removeNode( OctreeNode * n, bool keepOrder )
 {
-    mNodes.erase( std::find( mNodes.begin(), mNodes.end(), n ) );
+    size_t index = n -> _getOctantIndex();
+
+    if ( keepOrder )
+    {
+        mNodes.erase( mNodes.begin() + index );
+
+        for ( size_t i = index; i < mNodes.size(); i++ )
+            mNodes[ i ] -> _setOctantIndex( i );
+    }
+    else
+    {
+        mNodes[ index ] = mNodes.back();
+        mNodes[ index ] -> _setOctantIndex( index );
+        mNodes.pop_back();
+    }
+
     n -> setOctant( 0 );
 
     //update total counts.
     _unref();
 }
 
+void Octree::_moveNode( OctreeNode * n, Octree * target )
+{
+    size_t index = n -> _getOctantIndex();
+    mNodes[ index ] = mNodes.back();
+    mNodes[ index ] -> _setOctantIndex( index );
+    mNodes.pop_back();
+
+    n -> _setOctantIndex( target -> mNodes.size() );
+    target -> mNodes.push_back( n );
+    n -> setOctant( target );
+
+    //update the counts up to the first common parent.
+    Octree * from = this;
+
+    while ( from != target )
+    {
+        if ( from -> mDepth >= target -> mDepth )
+        {
+            from -> mNumNodes--;
+            from = from -> mParent;
+        }
+        else
+        {
+            target -> mNumNodes++;
+            target = target -> mParent;
+        }
+    }
+}
+
 void Octree::_getCullBounds( AxisAlignedBox *b ) const
 {
     b -> setExtents( mBox.getMinimum() - mHalfSize, mBox.getMaximum() + mHalfSize );
@@ -277,6 +277,7 @@ OctreeSceneManager::OctreeSceneManager(const String& name) : SceneManager(name)
     AxisAlignedBox b( -10000, -10000, -10000, 10000, 10000, 10000 );
     int depth = 8; 
     mOctree = 0;
+    mLoose = false;
     init( b, depth );
 }
 
@@ -284,6 +285,7 @@ OctreeSceneManager::OctreeSceneManager(const String& name, AxisAlignedBox &box,
 : SceneManager(name)
 {
     mOctree = 0;
+    mLoose = false;
     init( box, max_depth );
 }
 
@@ -381,6 +383,7 @@ bool OctreeSceneManager::getOptionKeys( StringVector & refKeys )
     refKeys.push_back( "Size" );
     refKeys.push_back( "ShowOctree" );
     refKeys.push_back( "Depth" );
+    refKeys.push_back( "Loose" );
 
     return true;
 }
@@ -407,6 +410,12 @@ void OctreeSceneManager::_updateOctreeNode( OctreeNode * onode )
         return ;
     }
 
+    if ( mLoose )
+    {
+        _updateLooseOctreeNode( onode );
+        return ;
+    }
+
     if ( ! onode -> _isIn( onode -> getOctant() -> mBox ) )
     {
         _removeOctreeNode( onode );
@@ -419,6 +428,43 @@ void OctreeSceneManager::_updateOctreeNode( OctreeNode * onode )
     }
 }
 
+void OctreeSceneManager::_updateLooseOctreeNode( OctreeNode * onode )
+{
+    const AxisAlignedBox& box = onode -> _getWorldAABB();
+    Octree * octant = onode -> getOctant();
+
+    //stay while within the culling bounds, unless small enough for a child.
+    AxisAlignedBox bounds;
+    octant -> _getCullBounds( &bounds );
+    if ( bounds.contains( box ) && ( octant -> mDepth >= mMaxDepth || ! octant -> _isTwiceSize( box ) ) )
+        return ;
+
+    //if outside the octree, force into the root node.
+    Octree * target = mOctree;
+
+    if ( onode -> _isIn( mOctree -> mBox ) )
+    {
+        //otherwise climb up to the first octant holding the center where the node fits,
+        target = octant;
+        while ( target != mOctree &&
+                ! ( target -> getParent() -> _isTwiceSize( box ) && target -> mBox.contains( box.getCenter() ) ) )
+        {
+            target = target -> getParent();
+        }
+
+        //and go down from there as _addOctreeNode does.
+        while ( target -> mDepth < mMaxDepth && target -> _isTwiceSize( box ) )
+        {
+            int x, y, z;
+            target -> _getChildIndexes( box, &x, &y, &z );
+            target = _getChildOctant( target, x, y, z );
+        }
+    }
+
+    if ( target != octant )
+        octant -> _moveNode( onode, target );
+}
+
 /** Only removes the node from the octree.  It leaves the octree, even if it's empty.
 */
 void OctreeSceneManager::_removeOctreeNode( OctreeNode * n )
@@ -431,7 +477,7 @@ void OctreeSceneManager::_removeOctreeNode( OctreeNode * n )
 
     if ( oct )
     {
-        oct -> _removeNode( n );
+        oct -> _removeNode( n, !mLoose );
     }
 
     n->setOctant(0);
@@ -455,61 +501,67 @@ void OctreeSceneManager::_addOctreeNode( OctreeNode * n, Octree *octant, int dep
         int x, y, z;
         octant -> _getChildIndexes( bx, &x, &y, &z );
 
-        if ( octant -> mChildren[ x ][ y ][ z ] == 0 )
-        {
-            octant -> mChildren[ x ][ y ][ z ] = OGRE_NEW Octree( octant );
-            const Vector3& octantMin = octant -> mBox.getMinimum();
-            const Vector3& octantMax = octant -> mBox.getMaximum();
-            Vector3 min, max;
+        _addOctreeNode( n, _getChildOctant( octant, x, y, z ), ++depth );
 
-            if ( x == 0 )
-            {
-                min.x = octantMin.x;
-                max.x = ( octantMin.x + octantMax.x ) / 2;
-            }
+    }
 
-            else
-            {
-                min.x = ( octantMin.x + octantMax.x ) / 2;
-                max.x = octantMax.x;
-            }
+    else
+    {
+        octant -> _addNode( n );
+    }
+}
 
-            if ( y == 0 )
-            {
-                min.y = octantMin.y;
-                max.y = ( octantMin.y + octantMax.y ) / 2;
-            }
 
-            else
-            {
-                min.y = ( octantMin.y + octantMax.y ) / 2;
-                max.y = octantMax.y;
-            }
+Octree * OctreeSceneManager::_getChildOctant( Octree * octant, int x, int y, int z )
+{
+    if ( octant -> mChildren[ x ][ y ][ z ] == 0 )
+    {
+        octant -> mChildren[ x ][ y ][ z ] = OGRE_NEW Octree( octant );
+        const Vector3& octantMin = octant -> mBox.getMinimum();
+        const Vector3& octantMax = octant -> mBox.getMaximum();
+        Vector3 min, max;
 
-            if ( z == 0 )
-            {
-                min.z = octantMin.z;
-                max.z = ( octantMin.z + octantMax.z ) / 2;
-            }
+        if ( x == 0 )
+        {
+            min.x = octantMin.x;
+            max.x = ( octantMin.x + octantMax.x ) / 2;
+        }
 
-            else
-            {
-                min.z = ( octantMin.z + octantMax.z ) / 2;
-                max.z = octantMax.z;
-            }
+        else
+        {
+            min.x = ( octantMin.x + octantMax.x ) / 2;
+            max.x = octantMax.x;
+        }
 
-            octant -> mChildren[ x ][ y ][ z ] -> mBox.setExtents( min, max );
-            octant -> mChildren[ x ][ y ][ z ] -> mHalfSize = ( max - min ) / 2;
+        if ( y == 0 )
+        {
+            min.y = octantMin.y;
+            max.y = ( octantMin.y + octantMax.y ) / 2;
         }
 
-        _addOctreeNode( n, octant -> mChildren[ x ][ y ][ z ], ++depth );
+        else
+        {
+            min.y = ( octantMin.y + octantMax.y ) / 2;
+            max.y = octantMax.y;
+        }
 
-    }
+        if ( z == 0 )
+        {
+            min.z = octantMin.z;
+            max.z = ( octantMin.z + octantMax.z ) / 2;
+        }
 
-    else
-    {
-        octant -> _addNode( n );
+        else
+        {
+            min.z = ( octantMin.z + octantMax.z ) / 2;
+            max.z = octantMax.z;
+        }
+
+        octant -> mChildren[ x ][ y ][ z ] -> mBox.setExtents( min, max );
+        octant -> mChildren[ x ][ y ][ z ] -> mHalfSize = ( max - min ) / 2;
     }
+
+    return octant -> mChildren[ x ][ y ][ z ];
 }
 
 
@@ -1015,6 +1067,12 @@ bool OctreeSceneManager::setOption( const String & key, const void * val )
         return true;
     }
 
+    else if ( key == "Loose" )
+    {
+        mLoose = * static_cast < const bool * > ( val );
+        return true;
+    }
+
 
     return SceneManager::setOption( key, val );
 
@@ -1043,6 +1101,12 @@ bool OctreeSceneManager::getOption( const String & key, void *val )
         return true;
     }
 
+    else if ( key == "Loose" )
+    {
+        * static_cast < bool * > ( val ) = mLoose;
+        return true;
+    }
+
 
     return SceneManager::getOption( key, val );
 
@@ -41,6 +41,9 @@ email                : janders@users.sf.net
 #include "OgreSceneNode.h"
 #include "OgreOctreeSceneManager.h"
 #include "OgreEntity.h"
+#include "OgreOctree.h"
+#include "OgreOctreeNode.h"
+#include "OgreRayPacket.h"
 
 namespace Ogre
 {
@@ -213,6 +216,54 @@ void OctreeRaySceneQuery::execute(RaySceneQueryListener* listener)
     }
 
 }
+//---------------------------------------------------------------------
+void OctreeRaySceneQuery::executeBatch(const Ray* rays, size_t count, RaySceneQueryResultEntry* results,
+                                       bool parallel)
+{
+    Octree* octree = static_cast<OctreeSceneManager*>(mParentSceneMgr)->mOctree;
+    castPackets(rays, count, results, parallel,
+                [this, octree](RayPacket& packet, RaySceneQueryResultEntry* hits)
+                { castPacket(packet, octree, hits); });
+}
+//---------------------------------------------------------------------
+void OctreeRaySceneQuery::castPacket(RayPacket& packet, Octree* octant, RaySceneQueryResultEntry* results) const
+{
+    // Same traversal as execute, the octants behind the nearest hits being skipped
+    AxisAlignedBox bounds;
+    octant->_getCullBounds(&bounds);
+    if (!packet.intersects(bounds))
+        return;
+
+    for (auto node : octant->mNodes)
+    {
+        uint32 nodeRays = packet.intersects(node->_getWorldAABB());
+        if (!nodeRays)
+            continue;
+
+        for (auto m : node->getAttachedObjects())
+        {
+            if (!(m->getQueryFlags() & mQueryMask) || !(m->getTypeFlags() & mQueryTypeMask) || !m->isInScene())
+                continue;
+
+            uint32 rays = hitObject(packet, nodeRays, m, results);
+            // deal with attached objects, since they are not directly attached to nodes
+            if (rays && m->getMovableType() == MOT_ENTITY)
+            {
+                for (auto c : static_cast<Entity*>(m)->getAttachedObjects())
+                {
+                    if (c->getQueryFlags() & mQueryMask)
+                        hitObject(packet, rays, c, results);
+                }
+            }
+        }
+    }
+
+    for (int i = 0; i < 8; ++i)
+    {
+        if (Octree* child = octant->mChildren[i & 1][(i >> 1) & 1][i >> 2])
+            castPacket(packet, child, results);
+    }
+}
 
 
 //---------------------------------------------------------------------
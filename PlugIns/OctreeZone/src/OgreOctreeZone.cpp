@@ -599,6 +599,9 @@ namespace Ogre
         for (PortalList::iterator iter = mPortals.begin(); iter != mPortals.end(); ++iter)
         {
             Portal* portal = *iter;
+            // zones the PVS rules out are skipped before any frustum test
+            if (!mPCZSM->_isPotentiallyVisible(portal->getTargetZone()))
+                continue;
             if (camera->isVisible(portal))
             {
                 sortedPortalList.push_back(portal);
@@ -296,6 +296,52 @@ namespace Ogre
         /// @see SceneManager::prepareShadowTextures.
         void prepareShadowTextures(Camera* cam, Viewport* vp, const LightList* lightList = 0) override;
 
+        /** Precomputes which zones may be seen from each zone, so the walk of the zones
+            skips the portals leading to the others before any frustum test.
+        @remarks
+            A zone is in the potentially visible set (PVS) of another one if some line
+            goes from a portal of the first one through a chain of portals into it. The
+            test is done with the planes of the quad portals, so it is conservative: it
+            keeps some zones which are actually hidden, but never drops a visible one.
+            AABB and sphere portals let everything through, anti portals are ignored and
+            disabled portals count as enabled.
+        @par
+            The zones are baked in parallel on the WorkQueue. The PVS relies on the
+            current layout of the portals, so it is meant for scenes whose portals do
+            not move; bake or load it again after changing them. Zones created later are
+            potentially visible from every zone and see every zone.
+        @note
+            Shadow cameras of directional lights do not use the PVS, since the casters
+            of the visible shadows may be in zones hidden from the camera.
+        */
+        void bakePVS(void);
+        /// Discards the potentially visible set, see bakePVS
+        void clearPVS(void);
+        /// Whether a potentially visible set was baked or loaded
+        bool hasPVS(void) const { return mHasPVS; }
+        /** Saves the potentially visible set to a binary file, usually next to the
+            files of the zones.
+        @param filename the file to write, in the default resource group if it has no path
+        */
+        void savePVS(const String& filename) const;
+        /// @overload
+        void savePVS(const DataStreamPtr& stream) const;
+        /** Loads a potentially visible set saved by savePVS.
+        @return false, with a warning in the log, if the data is not a PVS of the
+            current zones and portals. The current PVS is kept then.
+        */
+        bool loadPVS(const DataStreamPtr& stream);
+        /** @overload
+            The file is looked for like Root::openFileStream does.
+        */
+        bool loadPVS(const String& filename);
+
+        /// Whether the zone may be seen by the camera whose zones are being walked
+        bool _isPotentiallyVisible(const PCZone* zone) const
+        {
+            return !mPVSZone || !zone || mPVSZone->isPotentiallyVisible(zone);
+        }
+
     protected:
         /// Type of default zone to be used
         String mDefaultZoneTypeName;
@@ -333,6 +379,13 @@ namespace Ogre
         /// The zone of the active camera (for shadow texture casting use);
         PCZone* mActiveCameraZone;
 
+        /// Whether the zones have a potentially visible set
+        bool mHasPVS;
+        /// Zone whose PVS prunes the current walk of the zones, null for none
+        PCZone* mPVSZone;
+        /// Shadow camera of the last directional light, which does not use the PVS
+        Camera* mDirectionalShadowCamera;
+
         /** Internal method for locating a list of lights which could be affecting the frustum. 
 
             Custom scene managers are encouraged to override this method to make use of their
@@ -244,12 +244,27 @@ namespace Ogre
         /** Get & set the user data */
         void * getUserData(void) {return mUserData;}
         void setUserData(void * userData) {mUserData = userData;}
+        /** Whether the zone may be seen from this one, according to the potentially
+            visible set baked by PCZSceneManager::bakePVS.
+        @remarks
+            Zones which were not baked, like those created since, are always potentially
+            visible. So are all the zones when there is no PVS.
+        */
+        bool isPotentiallyVisible(const PCZone* zone) const
+        {
+            return zone->mPVSIndex >= mPotentiallyVisibleZones.size() ||
+                   mPotentiallyVisibleZones[zone->mPVSIndex];
+        }
         /** List of Portals which this zone contains (each portal leads to another zone)
         */
         PortalList mPortals;
         AntiPortalList mAntiPortals;
         /// Pointer to the pcz scene manager that created this zone
         PCZSceneManager * mPCZSM;
+        /// Index of the zone in the potentially visible set, or ~0 if it was not baked
+        size_t mPVSIndex;
+        /// Zones potentially visible from this one, by PVS index, empty without a PVS
+        std::vector<bool> mPotentiallyVisibleZones;
 
     protected:
         /** Binary predicate for portal <-> camera distance sorting. */
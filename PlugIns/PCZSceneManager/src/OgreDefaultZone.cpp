@@ -584,6 +584,9 @@ namespace Ogre
         }
         for (auto portal : mPortals)
         {
+            // zones the PVS rules out are skipped before any frustum test
+            if (!mPCZSM->_isPotentiallyVisible(portal->getTargetZone()))
+                continue;
             if (camera->isVisible(portal))
             {
                 sortedPortalList.push_back(portal);
@@ -43,9 +43,161 @@ email                : ericc@xenopi.com
 #include "OgrePortal.h"
 #include "OgreLogManager.h"
 #include "OgreRoot.h"
+#include "OgreStreamSerialiser.h"
+#include "OgreWorkQueue.h"
 
 namespace Ogre
 {
+    namespace
+    {
+        uint32 PVS_CHUNK_ID = StreamSerialiser::makeIdentifier("PCZV"); // PCZ potentially visible set
+        uint16 PVS_CHUNK_VERSION = 1;
+
+        /// Portal chains followed from a zone during the bake before flooding instead
+        const size_t PVS_BAKE_BUDGET = 1 << 20;
+
+        /// World values of a portal leading to another zone, for the PVS bake
+        struct PVSPortal
+        {
+            /// PVS index of the target zone
+            size_t target;
+            /// Index of the portal leading back from the target zone, ~0 if unknown
+            size_t twin;
+            /// Only quad portals have a plane, the others are bounded by their sphere
+            bool quad;
+            /// Points into the zone of the portal
+            Plane plane;
+            Vector3 corners[4];
+            Sphere sphere;
+        };
+
+        /// Whether some point of the portal is strictly on the given side of the plane
+        bool hasPointOnSide(const PVSPortal& portal, const Plane& plane, Real side)
+        {
+            if (!portal.quad)
+                return side * plane.getDistance(portal.sphere.getCenter()) > -portal.sphere.getRadius();
+            for (const Vector3& corner : portal.corners)
+            {
+                if (side * plane.getDistance(corner) > 0)
+                    return true;
+            }
+            return false;
+        }
+
+        /** Whether a line may go through the portals of the chain and then through the
+            given one. The line enters each quad portal from the front and leaves it behind,
+            so the later portals need a point behind it and the earlier ones a point in front.
+        */
+        bool canSeeThrough(const std::vector<PVSPortal>& portals, const std::vector<size_t>& chain,
+                           const PVSPortal& portal)
+        {
+            for (size_t i : chain)
+            {
+                const PVSPortal& previous = portals[i];
+                if (previous.quad && !hasPointOnSide(portal, previous.plane, -1))
+                    return false;
+                if (portal.quad && !hasPointOnSide(previous, portal.plane, 1))
+                    return false;
+            }
+            return true;
+        }
+
+        /// Marks the zones a line from the source zone may reach through the portals
+        void bakeZonePVS(const std::vector<PVSPortal>& portals,
+                         const std::vector<std::vector<size_t> >& zonePortals,
+                         size_t source, std::vector<bool>& visible)
+        {
+            visible.assign(zonePortals.size(), false);
+            visible[source] = true;
+
+            // depth first walk of the portal chains, with the next portal to try per level
+            std::vector<size_t> chain, next;
+            size_t budget = PVS_BAKE_BUDGET;
+            for (size_t first : zonePortals[source])
+            {
+                visible[portals[first].target] = true;
+                chain.assign(1, first);
+                next.assign(1, 0);
+                while (!chain.empty())
+                {
+                    const PVSPortal& last = portals[chain.back()];
+                    const std::vector<size_t>& candidates = zonePortals[last.target];
+                    if (next.back() == candidates.size())
+                    {
+                        chain.pop_back();
+                        next.pop_back();
+                        continue;
+                    }
+                    size_t i = candidates[next.back()++];
+                    if (i == last.twin || std::find(chain.begin(), chain.end(), i) != chain.end() ||
+                        !canSeeThrough(portals, chain, portals[i]))
+                        continue;
+
+                    if (--budget == 0)
+                    {
+                        // too many chains, fall back to every zone connected to the source
+                        std::vector<bool> reached(zonePortals.size(), false);
+                        std::vector<size_t> open(1, source);
+                        reached[source] = true;
+                        while (!open.empty())
+                        {
+                            size_t zone = open.back();
+                            open.pop_back();
+                            visible[zone] = true;
+                            for (size_t j : zonePortals[zone])
+                            {
+                                if (!reached[portals[j].target])
+                                {
+                                    reached[portals[j].target] = true;
+                                    open.push_back(portals[j].target);
+                                }
+                            }
+                        }
+                        return;
+                    }
+
+                    visible[portals[i].target] = true;
+                    chain.push_back(i);
+                    next.push_back(0);
+                }
+            }
+        }
+
+        void updatePortals(const ZoneMap& zones)
+        {
+            for (const auto& z : zones)
+            {
+                for (const Portal* portal : z.second->mPortals)
+                    portal->updateDerivedValues();
+            }
+        }
+
+        /** Hash of the names of the zones and of the layout of their portals, which
+            rejects a PVS saved for another scene. The portals must be up to date.
+        */
+        uint32 calcPVSHash(const ZoneMap& zones)
+        {
+            uint32 hash = HashCombine(0, uint32(zones.size()));
+            for (const auto& z : zones)
+            {
+                hash = FastHash(z.first.c_str(), z.first.size(), hash);
+                for (Portal* portal : z.second->mPortals)
+                {
+                    PCZone* target = portal->getTargetZone();
+                    if (!target)
+                        continue;
+                    hash = FastHash(target->getName().c_str(), target->getName().size(), hash);
+                    hash = HashCombine(hash, portal->getType());
+                    int numCorners = portal->getType() == PortalBase::PORTAL_TYPE_QUAD ? 4 : 2;
+                    for (int i = 0; i < numCorners; ++i)
+                        hash = HashCombine(hash, portal->getDerivedCorner(i));
+                    hash = HashCombine(hash, portal->getDerivedRadius());
+                }
+            }
+            return hash;
+        }
+    }
+
     PCZSceneManager::PCZSceneManager(const String& name) :
     SceneManager(name),
     mDefaultZoneTypeName("ZoneType_Default"),
@@ -54,7 +206,10 @@ namespace Ogre
     mDefaultZone(0),
     mShowPortals(false),
     mZoneFactoryManager(0),
-    mActiveCameraZone(0)
+    mActiveCameraZone(0),
+    mHasPVS(false),
+    mPVSZone(0),
+    mDirectionalShadowCamera(0)
     {
         addShadowTextureListener(this);
     }
@@ -128,6 +283,8 @@ namespace Ogre
             OGRE_DELETE j->second;
         }
         mZones.clear();
+        mHasPVS = false;
+        mPVSZone = 0;
 
         mFrameCount = 0;
 
@@ -967,6 +1124,9 @@ namespace Ogre
     {
         PCZSceneNode* camNode = (PCZSceneNode*)camera->getParentSceneNode();
 
+        // the casters of directional lights may be in zones the camera can not see
+        mDirectionalShadowCamera = light->getType() == Light::LT_DIRECTIONAL ? camera : 0;
+
         if (light->getType() == Light::LT_DIRECTIONAL)
         {
             if (camNode->getHomeZone() != mActiveCameraZone)
@@ -1086,6 +1246,9 @@ namespace Ogre
         // get the home zone of the camera
         PCZone* cameraHomeZone = ((PCZSceneNode*)(cam->getParentSceneNode()))->getHomeZone();
 
+        // prune the walk with the potentially visible set of the camera zone
+        mPVSZone = (mHasPVS && cam != mDirectionalShadowCamera) ? cameraHomeZone : 0;
+
         // walk the zones, starting from the camera home zone,
         // adding all visible scene nodes to the mVisibles list
         cameraHomeZone->setLastVisibleFrame(mFrameCount);
@@ -1324,6 +1487,201 @@ namespace Ogre
         mActiveCameraZone = ((PCZSceneNode*)cam->getParentSceneNode())->getHomeZone();
         SceneManager::prepareShadowTextures(cam, vp);
     }
+    //---------------------------------------------------------------------
+    void PCZSceneManager::bakePVS(void)
+    {
+        updatePortals(mZones);
+
+        // index the zones, and snapshot the portals leading to another zone
+        std::vector<PCZone*> zones;
+        std::map<const Portal*, size_t> portalIndices;
+        std::vector<PVSPortal> portals;
+        std::vector<std::vector<size_t> > zonePortals(mZones.size());
+        for (const auto& z : mZones)
+        {
+            z.second->mPVSIndex = zones.size();
+            zones.push_back(z.second);
+        }
+        for (PCZone* zone : zones)
+        {
+            for (Portal* portal : zone->mPortals)
+            {
+                PCZone* target = portal->getTargetZone();
+                if (!target || target->mPVSIndex >= zones.size())
+                    continue;
+
+                PVSPortal p;
+                p.target = target->mPVSIndex;
+                p.twin = ~size_t(0);
+                p.quad = portal->getType() == PortalBase::PORTAL_TYPE_QUAD;
+                if (p.quad)
+                {
+                    p.plane = portal->getDerivedPlane();
+                    for (int i = 0; i < 4; ++i)
+                        p.corners[i] = portal->getDerivedCorner(i);
+                }
+                p.sphere = Sphere(portal->getDerivedCP(), portal->getDerivedRadius());
+
+                portalIndices[portal] = portals.size();
+                zonePortals[zone->mPVSIndex].push_back(portals.size());
+                portals.push_back(p);
+            }
+        }
+        for (const auto& entry : portalIndices)
+        {
+            auto twin = portalIndices.find(const_cast<Portal*>(entry.first)->getTargetPortal());
+            if (twin != portalIndices.end())
+                portals[entry.second].twin = twin->second;
+        }
+
+        Root::getSingleton().getWorkQueue()->parallelFor(0, zones.size(),
+            [&](size_t first, size_t last)
+            {
+                for (size_t i = first; i < last; ++i)
+                    bakeZonePVS(portals, zonePortals, i, zones[i]->mPotentiallyVisibleZones);
+            });
+        mHasPVS = true;
+    }
+    //---------------------------------------------------------------------
+    void PCZSceneManager::clearPVS(void)
+    {
+        for (const auto& z : mZones)
+        {
+            z.second->mPVSIndex = ~size_t(0);
+            z.second->mPotentiallyVisibleZones.clear();
+        }
+        mHasPVS = false;
+        mPVSZone = 0;
+    }
+    //---------------------------------------------------------------------
+    void PCZSceneManager::savePVS(const String& filename) const
+    {
+        savePVS(Root::createFileStream(filename, RGN_DEFAULT, true));
+    }
+    //---------------------------------------------------------------------
+    void PCZSceneManager::savePVS(const DataStreamPtr& stream) const
+    {
+        if (!mHasPVS)
+        {
+            OGRE_EXCEPT(Exception::ERR_INVALID_STATE,
+                "There is no potentially visible set to save",
+                "PCZSceneManager::savePVS");
+        }
+        if (!stream->isWriteable())
+        {
+            OGRE_EXCEPT(Exception::ERR_CANNOT_WRITE_TO_FILE,
+                "Unable to write to stream " + stream->getName(),
+                "PCZSceneManager::savePVS");
+        }
+
+        updatePortals(mZones);
+
+        StreamSerialiser serialiser(stream);
+        serialiser.writeChunkBegin(PVS_CHUNK_ID, PVS_CHUNK_VERSION);
+
+        uint32 hash = calcPVSHash(mZones);
+        uint32 zoneCount = static_cast<uint32>(mZones.size());
+        serialiser.write(&hash);
+        serialiser.write(&zoneCount);
+
+        // the indices of the visible zones of each zone, in the order of the zone map
+        std::vector<uint32> indices;
+        for (const auto& z : mZones)
+        {
+            indices.clear();
+            uint32 index = 0;
+            for (const auto& other : mZones)
+            {
+                if (z.second->isPotentiallyVisible(other.second))
+                    indices.push_back(index);
+                ++index;
+            }
+            uint32 count = static_cast<uint32>(indices.size());
+            serialiser.write(&count);
+            serialiser.write(indices.data(), indices.size());
+        }
+
+        serialiser.writeChunkEnd(PVS_CHUNK_ID);
+    }
+    //---------------------------------------------------------------------
+    bool PCZSceneManager::loadPVS(const String& filename)
+    {
+        return loadPVS(Root::openFileStream(filename, RGN_DEFAULT));
+    }
+    //---------------------------------------------------------------------
+    bool PCZSceneManager::loadPVS(const DataStreamPtr& stream)
+    {
+        StreamSerialiser serialiser(stream);
+        const StreamSerialiser::Chunk* chunk;
+
+        try
+        {
+            chunk = serialiser.readChunkBegin();
+        }
+        catch (const InvalidStateException& e)
+        {
+            LogManager::getSingleton().logWarning("Could not load potentially visible set: " +
+                                                  e.getDescription());
+            return false;
+        }
+
+        if (chunk->id != PVS_CHUNK_ID || chunk->version != PVS_CHUNK_VERSION)
+        {
+            LogManager::getSingleton().logWarning("Invalid potentially visible set " + stream->getName());
+            serialiser.readChunkEnd(chunk->id);
+            return false;
+        }
+
+        updatePortals(mZones);
+
+        uint32 hash = 0, zoneCount = 0;
+        serialiser.read(&hash);
+        serialiser.read(&zoneCount);
+        if (hash != calcPVSHash(mZones) || zoneCount != mZones.size())
+        {
+            LogManager::getSingleton().logWarning("Potentially visible set " + stream->getName() +
+                                                  " does not match the zones and portals of the scene");
+            serialiser.readChunkEnd(PVS_CHUNK_ID);
+            return false;
+        }
+
+        std::vector<std::vector<bool> > visible(zoneCount, std::vector<bool>(zoneCount, false));
+        std::vector<uint32> indices;
+        for (uint32 i = 0; i < zoneCount; ++i)
+        {
+            uint32 count = 0;
+            serialiser.read(&count);
+            bool valid = count <= zoneCount;
+            if (valid)
+            {
+                indices.resize(count);
+                serialiser.read(indices.data(), count);
+            }
+            for (size_t j = 0; valid && j < indices.size(); ++j)
+            {
+                valid = indices[j] < zoneCount;
+                if (valid)
+                    visible[i][indices[j]] = true;
+            }
+            if (!valid)
+            {
+                LogManager::getSingleton().logWarning("Corrupted potentially visible set " +
+                                                      stream->getName());
+                serialiser.readChunkEnd(PVS_CHUNK_ID);
+                return false;
+            }
+        }
+        serialiser.readChunkEnd(PVS_CHUNK_ID);
+
+        size_t i = 0;
+        for (const auto& z : mZones)
+        {
+            z.second->mPVSIndex = i;
+            z.second->mPotentiallyVisibleZones.swap(visible[i++]);
+        }
+        mHasPVS = true;
+        return true;
+    }
 
     //-----------------------------------------------------------------------
     const String PCZSceneManagerFactory::FACTORY_TYPE_NAME = "PCZSceneManager";
@@ -49,6 +49,7 @@ namespace Ogre
         mEnclosureNode = 0;
         mPCZSM = creator;
         mHasSky = false;
+        mPVSIndex = ~size_t(0);
     }
 
     PCZone::~PCZone()
@@ -42,17 +42,9 @@ namespace Ogre {
         // Adjust format if required.
         mFormat = TextureManager::getSingleton().getNativeFormat(mTextureType, mFormat, mUsage);
 
-        mNumMipmaps = mNumRequestedMipmaps = 0;
-
+        // mipmaps are generated on the CPU by Texture::_loadImages
         mBuffer.create(mFormat, mWidth, mHeight, mDepth, getNumFaces(), mNumMipmaps);
 
         createSurfaceList();
-
-        // Generate mipmaps after all texture levels have been loaded
-        // This is required for compressed formats such as DXT
-        if (mUsage & TU_AUTOMIPMAP)
-        {
-
-        }
     }
 }
@@ -0,0 +1,394 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include <gtest/gtest.h>
+#include "RootWithoutRenderSystemFixture.h"
+#include "OgreImage.h"
+#include "OgreWorkQueue.h"
+#include "OgreConfigFile.h"
+#include "OgreSTBICodec.h"
+
+#include <chrono>
+#include <iomanip>
+
+using namespace Ogre;
+
+namespace
+{
+// reference decoders, written independently of the encoder
+uint8 clampByte(int v) { return uint8(std::min(std::max(v, 0), 255)); }
+
+void decodeColourBlock(const uint8* b, bool dxt1, uint8 (*out)[4])
+{
+    uint16 c0 = uint16(b[0] | (b[1] << 8)), c1 = uint16(b[2] | (b[3] << 8));
+    int pal[4][4];
+    for (int k = 0; k < 2; k++)
+    {
+        uint16 c = k ? c1 : c0;
+        int r = c >> 11, g = (c >> 5) & 63, bl = c & 31;
+        pal[k][0] = (r << 3) | (r >> 2);
+        pal[k][1] = (g << 2) | (g >> 4);
+        pal[k][2] = (bl << 3) | (bl >> 2);
+        pal[k][3] = 255;
+    }
+    for (int c = 0; c < 3; c++)
+    {
+        if (!dxt1 || c0 > c1)
+        {
+            pal[2][c] = (2 * pal[0][c] + pal[1][c]) / 3;
+            pal[3][c] = (pal[0][c] + 2 * pal[1][c]) / 3;
+        }
+        else
+        {
+            pal[2][c] = (pal[0][c] + pal[1][c]) / 2;
+            pal[3][c] = 0;
+        }
+    }
+    pal[2][3] = 255;
+    pal[3][3] = (!dxt1 || c0 > c1) ? 255 : 0;
+    for (int i = 0; i < 16; i++)
+        for (int c = 0; c < 4; c++)
+            out[i][c] = uint8(pal[(b[4 + i / 4] >> (2 * (i % 4))) & 3][c]);
+}
+
+void decodeAlphaBlock(const uint8* b, uint8 (*out)[4], int channel)
+{
+    int a0 = b[0], a1 = b[1], pal[8] = {a0, a1};
+    if (a0 > a1)
+        for (int k = 2; k < 8; k++)
+            pal[k] = ((8 - k) * a0 + (k - 1) * a1) / 7;
+    else
+    {
+        for (int k = 2; k < 6; k++)
+            pal[k] = ((6 - k) * a0 + (k - 1) * a1) / 5;
+        pal[6] = 0;
+        pal[7] = 255;
+    }
+    uint64 bits = 0;
+    for (int i = 0; i < 6; i++)
+        bits |= uint64(b[2 + i]) << (8 * i);
+    for (int i = 0; i < 16; i++)
+        out[i][channel] = uint8(pal[(bits >> (3 * i)) & 7]);
+}
+
+void decodeBC7Block(const uint8* b, uint8 (*out)[4])
+{
+    int pos = 0;
+    auto read = [&](int bits) {
+        int v = 0;
+        for (int i = 0; i < bits; i++, pos++)
+            v |= ((b[pos / 8] >> (pos % 8)) & 1) << i;
+        return v;
+    };
+    ASSERT_EQ(read(7), 1 << 6); // mode 6
+    int e[2][4];
+    for (int c = 0; c < 4; c++)
+    {
+        e[0][c] = read(7);
+        e[1][c] = read(7);
+    }
+    int p0 = read(1), p1 = read(1);
+    const int weights[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+    for (int i = 0; i < 16; i++)
+    {
+        int w = weights[read(i == 0 ? 3 : 4)];
+        for (int c = 0; c < 4; c++)
+            out[i][c] = uint8(((64 - w) * ((e[0][c] << 1) | p0) + w * ((e[1][c] << 1) | p1) + 32) >> 6);
+    }
+}
+
+void decodeETCBlock(const uint8* b, uint8 (*out)[4])
+{
+    static const int mods[8][4] = {{2, 8, -2, -8},     {5, 17, -5, -17},   {9, 29, -9, -29},     {13, 42, -13, -42},
+                                   {18, 60, -18, -60}, {24, 80, -24, -80}, {33, 106, -33, -106}, {47, 183, -47, -183}};
+    uint32 high = uint32(b[0] << 24 | b[1] << 16 | b[2] << 8 | b[3]);
+    uint32 low = uint32(b[4] << 24 | b[5] << 16 | b[6] << 8 | b[7]);
+    bool diff = (high >> 1) & 1, flip = high & 1;
+    int base[2][3];
+    for (int c = 0; c < 3; c++)
+    {
+        int shift = 24 - 8 * c;
+        if (diff)
+        {
+            int q0 = (high >> (shift + 3)) & 31;
+            int d = (high >> shift) & 7;
+            int q1 = q0 + (d >= 4 ? d - 8 : d);
+            ASSERT_TRUE(q1 >= 0 && q1 <= 31); // otherwise an ETC2 only mode
+            base[0][c] = (q0 << 3) | (q0 >> 2);
+            base[1][c] = (q1 << 3) | (q1 >> 2);
+        }
+        else
+        {
+            base[0][c] = ((high >> (shift + 4)) & 15) * 17;
+            base[1][c] = ((high >> shift) & 15) * 17;
+        }
+    }
+    int tables[2] = {int(high >> 5) & 7, int(high >> 2) & 7};
+    for (int x = 0; x < 4; x++)
+    {
+        for (int y = 0; y < 4; y++)
+        {
+            int i = x * 4 + y;
+            int idx = (((low >> (16 + i)) & 1) << 1) | ((low >> i) & 1);
+            int sub = flip ? y / 2 : x / 2;
+            for (int c = 0; c < 3; c++)
+                out[y * 4 + x][c] = clampByte(base[sub][c] + mods[tables[sub]][idx]);
+        }
+    }
+}
+
+void decodeEACBlock(const uint8* b, uint8 (*out)[4])
+{
+    static const int mods[16][8] = {
+        {-3, -6, -9, -15, 2, 5, 8, 14}, {-3, -7, -10, -13, 2, 6, 9, 12}, {-2, -5, -8, -13, 1, 4, 7, 12},
+        {-2, -4, -6, -13, 1, 3, 5, 12}, {-3, -6, -8, -12, 2, 5, 7, 11},  {-3, -7, -9, -11, 2, 6, 8, 10},
+        {-4, -7, -8, -11, 3, 6, 7, 10}, {-3, -5, -8, -11, 2, 4, 7, 10},  {-2, -6, -8, -10, 1, 5, 7, 9},
+        {-2, -5, -8, -10, 1, 4, 7, 9},  {-2, -4, -8, -10, 1, 3, 7, 9},   {-2, -5, -7, -10, 1, 4, 6, 9},
+        {-3, -4, -7, -10, 2, 3, 6, 9},  {-1, -2, -3, -10, 0, 1, 2, 9},   {-4, -6, -8, -9, 3, 5, 7, 8},
+        {-3, -5, -7, -9, 2, 4, 6, 8}};
+    uint64 bits = 0;
+    for (int i = 0; i < 8; i++)
+        bits = bits << 8 | b[i];
+    int base = int(bits >> 56), mul = int(bits >> 52) & 15, table = int(bits >> 48) & 15;
+    for (int i = 0; i < 16; i++)
+        out[(i % 4) * 4 + i / 4][3] = clampByte(base + mods[table][(bits >> (45 - 3 * i)) & 7] * mul);
+}
+
+/// decode the top level of img to PF_BYTE_RGBA
+std::vector<uint8> decode(const Image& img)
+{
+    uint32 w = img.getWidth(), h = img.getHeight();
+    uint32 blocksX = (w + 3) / 4;
+    size_t blockSize = PixelUtil::getMemorySize(4, 4, 1, img.getFormat());
+    std::vector<uint8> rgba(w * h * 4, 0);
+    for (uint32 by = 0; by < (h + 3) / 4; by++)
+    {
+        for (uint32 bx = 0; bx < blocksX; bx++)
+        {
+            const uint8* b = img.getData() + (by * blocksX + bx) * blockSize;
+            uint8 px[16][4] = {};
+            switch (img.getFormat())
+            {
+            case PF_DXT1: decodeColourBlock(b, true, px); break;
+            case PF_DXT5: decodeColourBlock(b + 8, false, px); decodeAlphaBlock(b, px, 3); break;
+            case PF_BC4_UNORM: decodeAlphaBlock(b, px, 0); break;
+            case PF_BC5_UNORM: decodeAlphaBlock(b, px, 0); decodeAlphaBlock(b + 8, px, 1); break;
+            case PF_BC7_UNORM: decodeBC7Block(b, px); break;
+            case PF_ETC2_RGB8: decodeETCBlock(b, px); break;
+            case PF_ETC2_RGBA8: decodeEACBlock(b, px); decodeETCBlock(b + 8, px); break;
+            default: break;
+            }
+            for (uint32 i = 0; i < 16; i++)
+            {
+                uint32 x = bx * 4 + i % 4, y = by * 4 + i / 4;
+                if (x < w && y < h)
+                    memcpy(&rgba[(y * w + x) * 4], px[i], 4);
+            }
+        }
+    }
+    return rgba;
+}
+
+int getNumChannels(PixelFormat format)
+{
+    switch (format)
+    {
+    case PF_BC4_UNORM: return 1;
+    case PF_BC5_UNORM: return 2;
+    case PF_DXT1:
+    case PF_ETC2_RGB8: return 3;
+    default: return 4;
+    }
+}
+
+/// peak signal to noise ratio of the channels the format stores
+double getPSNR(const Image& ref, const Image& compressed)
+{
+    auto decoded = decode(compressed);
+    int channels = getNumChannels(compressed.getFormat());
+    double sum = 0;
+    for (size_t i = 0; i < decoded.size(); i++)
+    {
+        if (int(i % 4) >= channels)
+            continue;
+        double d = double(decoded[i]) - ref.getData()[i];
+        sum += d * d;
+    }
+    double mse = sum / (decoded.size() / 4 * channels);
+    return mse == 0 ? 99 : 10 * std::log10(255.0 * 255.0 / mse);
+}
+
+Image createTestImage(uint32 width, uint32 height)
+{
+    Image img(PF_BYTE_RGBA, width, height);
+    srand(0);
+    for (uint32 y = 0; y < height; y++)
+    {
+        for (uint32 x = 0; x < width; x++)
+        {
+            uint8* p = img.getData(x, y);
+            // gradients with a bit of noise and a hard edge
+            p[0] = clampByte(x * 255 / width + rand() % 9 - 4);
+            p[1] = clampByte(y * 255 / height + rand() % 9 - 4);
+            p[2] = x > width / 2 ? 200 : 40;
+            p[3] = clampByte(255 - int(x + y) * 255 / int(width + height));
+        }
+    }
+    return img;
+}
+
+const PixelFormat FORMATS[] = {PF_DXT1,        PF_DXT5,      PF_BC4_UNORM,  PF_BC5_UNORM,
+                               PF_BC7_UNORM,   PF_ETC2_RGB8, PF_ETC2_RGBA8};
+} // namespace
+
+typedef RootWithoutRenderSystemFixture BlockCompression;
+TEST_F(BlockCompression, Quality)
+{
+    // odd size to have partial blocks
+    Image ref = createTestImage(66, 62);
+    Image opaque = ref;
+    for (uint32 i = 0; i < 66 * 62; i++)
+        opaque.getData()[i * 4 + 3] = 255;
+    for (auto format : FORMATS)
+    {
+        double psnr[3];
+        for (int q = 0; q < 3; q++)
+        {
+            // DXT1 would encode the translucent pixels as transparent black
+            Image img = getNumChannels(format) == 3 ? opaque : ref;
+            img.compress(format, Image::CompressionQuality(q));
+            ASSERT_EQ(img.getFormat(), format);
+            ASSERT_EQ(img.getSize(), PixelUtil::getMemorySize(66, 62, 1, format));
+            psnr[q] = getPSNR(ref, img);
+        }
+        EXPECT_GT(psnr[Image::COMPRESS_FAST], 28) << PixelUtil::getFormatName(format);
+        EXPECT_GE(psnr[Image::COMPRESS_NORMAL], psnr[Image::COMPRESS_FAST] - 0.1) << PixelUtil::getFormatName(format);
+        EXPECT_GE(psnr[Image::COMPRESS_BEST], psnr[Image::COMPRESS_NORMAL] - 0.1) << PixelUtil::getFormatName(format);
+    }
+
+    // constant blocks are nearly exact
+    Image flat(PF_BYTE_RGBA, 8, 8);
+    for (uint32 i = 0; i < 64; i++)
+        memcpy(flat.getData() + i * 4, "\x40\x80\xC0\xFF", 4);
+    for (auto format : {PF_BC4_UNORM, PF_BC5_UNORM, PF_BC7_UNORM, PF_ETC2_RGBA8})
+    {
+        Image img = flat;
+        img.compress(format);
+        EXPECT_GT(getPSNR(flat, img), 38) << PixelUtil::getFormatName(format);
+    }
+
+    // punch through alpha
+    Image holes = opaque;
+    for (uint32 i = 0; i < 66 * 62; i += 3)
+        holes.getData()[i * 4 + 3] = 0;
+    holes.compress(PF_DXT1);
+    auto decoded = decode(holes);
+    for (uint32 i = 0; i < 66 * 62; i++)
+        EXPECT_EQ(decoded[i * 4 + 3], i % 3 ? 255 : 0);
+}
+
+TEST_F(BlockCompression, Codecs)
+{
+    Image ref = createTestImage(64, 64);
+    ref.generateMipmaps();
+
+    // bulkPixelConversion encodes as well
+    Image img = ref;
+    img.compress(PF_DXT5);
+    std::vector<uint8> blocks(PixelUtil::getMemorySize(64, 64, 1, PF_DXT5));
+    PixelUtil::bulkPixelConversion(ref.getPixelBox(), PixelBox(64, 64, 1, PF_DXT5, blocks.data()));
+    EXPECT_TRUE(!memcmp(blocks.data(), img.getData(), blocks.size()));
+
+    // without a RenderSystem, DXT is decompressed on load
+    Image loaded;
+    loaded.load(img.encode("dds"), "dds");
+    EXPECT_EQ(loaded.getFormat(), PF_BYTE_RGBA);
+    EXPECT_EQ(loaded.getNumMipmaps(), ref.getNumMipmaps());
+    auto decoded = decode(img);
+    for (size_t i = 0; i < decoded.size(); i++)
+        ASSERT_NEAR(loaded.getData()[i], decoded[i], 3);
+
+    // BC7 needs the extended header
+    img = ref;
+    img.compress(PF_BC7_UNORM, Image::COMPRESS_FAST);
+    auto stream = img.encode("dds");
+    EXPECT_EQ(stream->size(), 4 + 124 + 20 + img.getSize());
+    uint32 header[37];
+    stream->read(header, sizeof(header));
+    EXPECT_TRUE(!memcmp(&header[21], "DX10", 4));
+    EXPECT_EQ(header[32], 98u); // DXGI_FORMAT_BC7_UNORM
+
+    // KTX keeps the blocks
+    img = ref;
+    img.compress(PF_ETC2_RGBA8);
+    loaded.load(img.encode("ktx"), "ktx");
+    EXPECT_EQ(loaded.getFormat(), PF_ETC2_RGBA8);
+    EXPECT_EQ(loaded.getNumMipmaps(), ref.getNumMipmaps());
+    ASSERT_EQ(loaded.getSize(), img.getSize());
+    EXPECT_TRUE(!memcmp(loaded.getData(), img.getData(), img.getSize()));
+}
+
+typedef RootWithoutRenderSystemFixture BlockCompressionBenchmark;
+TEST_F(BlockCompressionBenchmark, MediaTextures)
+{
+    ConfigFile cf;
+    cf.load(FileSystemLayer(OGRE_VERSION_NAME).getConfigFilePath("resources.cfg"));
+    if (!cf.getSettingsBySection().count("General"))
+        GTEST_SKIP() << "sample media not configured";
+    auto& rgm = ResourceGroupManager::getSingleton();
+    rgm.addResourceLocation(cf.getSettings("General").begin()->second + "/../materials/textures", "FileSystem",
+                            "BlockCompression");
+    rgm.initialiseResourceGroup("BlockCompression");
+
+    mRoot->getWorkQueue()->startup();
+    STBIImageCodec::startup();
+
+    for (auto name : {"BeachStones.jpg", "rockwall.tga", "terr_rock6.jpg", "ogrelogo.png"})
+    {
+        Image src;
+        src.load(name, "BlockCompression");
+        Image ref(PF_BYTE_RGBA, src.getWidth(), src.getHeight());
+        PixelUtil::bulkPixelConversion(src.getPixelBox(), ref.getPixelBox());
+        double mpix = ref.getWidth() * ref.getHeight() / 1e6;
+
+        for (auto format : {PF_DXT1, PF_DXT5, PF_BC7_UNORM, PF_ETC2_RGB8})
+        {
+            std::cout << std::setw(16) << name << std::setw(16) << PixelUtil::getFormatName(format);
+            for (int q = 0; q < 3; q++)
+            {
+                Image img = ref;
+                auto start = std::chrono::steady_clock::now();
+                img.compress(format, Image::CompressionQuality(q));
+                std::chrono::duration<double> time = std::chrono::steady_clock::now() - start;
+                std::cout << std::fixed << std::setprecision(2) << std::setw(9) << mpix / time.count()
+                          << " MPix/s " << std::setw(6) << getPSNR(ref, img) << " dB";
+            }
+            std::cout << std::endl;
+        }
+    }
+    STBIImageCodec::shutdown();
+}
@@ -29,6 +29,8 @@ THE SOFTWARE.
 #include "OgreDefaultHardwareBufferManager.h"
 #include "OgreVertexIndexData.h"
 #include "OgreEdgeListBuilder.h"
+#include <chrono>
+#include <iostream>
 
 
 // Register the test suite
@@ -283,3 +285,84 @@ TEST_F(EdgeBuilderTests,MultiIndexBufMultiVertexBuf)
     delete edgeData;
 }
 //--------------------------------------------------------------------------
+TEST_F(EdgeBuilderTests,LargeMesh)
+{
+    /* This tests a large torus, with the vertices duplicated along the seams. These have
+    to be welded to get a closed mesh. Also reports the time taken to build the edge list.
+    */
+    const uint32 segments = 512, rings = 256;
+    VertexData vd;
+    IndexData id;
+
+    vd.vertexCount = (segments + 1) * (rings + 1);
+    vd.vertexStart = 0;
+    vd.vertexDeclaration = HardwareBufferManager::getSingleton().createVertexDeclaration();
+    vd.vertexDeclaration->addElement(0, 0, VET_FLOAT3, VES_POSITION);
+    HardwareVertexBufferSharedPtr vbuf = HardwareBufferManager::getSingleton().createVertexBuffer(
+        sizeof(float) * 3, vd.vertexCount, HardwareBuffer::HBU_STATIC, true);
+    vd.vertexBufferBinding->setBinding(0, vbuf);
+    float* pFloat = static_cast<float*>(vbuf->lock(HardwareBuffer::HBL_DISCARD));
+    for (uint32 r = 0; r <= rings; ++r)
+    {
+        for (uint32 s = 0; s <= segments; ++s)
+        {
+            // the last row and column repeat the positions of the first ones
+            float u = Math::TWO_PI * (s % segments) / segments;
+            float v = Math::TWO_PI * (r % rings) / rings;
+            *pFloat++ = (2 + std::cos(v)) * std::cos(u);
+            *pFloat++ = std::sin(v);
+            *pFloat++ = (2 + std::cos(v)) * std::sin(u);
+        }
+    }
+    vbuf->unlock();
+
+    id.indexCount = segments * rings * 6;
+    id.indexStart = 0;
+    id.indexBuffer = HardwareBufferManager::getSingleton().createIndexBuffer(
+        HardwareIndexBuffer::IT_32BIT, id.indexCount, HardwareBuffer::HBU_STATIC, true);
+    uint32* pIdx = static_cast<uint32*>(id.indexBuffer->lock(HardwareBuffer::HBL_DISCARD));
+    for (uint32 r = 0; r < rings; ++r)
+    {
+        for (uint32 s = 0; s < segments; ++s)
+        {
+            uint32 a = r * (segments + 1) + s;
+            uint32 c = a + segments + 1;
+            *pIdx++ = a; *pIdx++ = c; *pIdx++ = a + 1;
+            *pIdx++ = a + 1; *pIdx++ = c; *pIdx++ = c + 1;
+        }
+    }
+    id.indexBuffer->unlock();
+
+    auto start = std::chrono::steady_clock::now();
+    EdgeListBuilder edgeBuilder;
+    edgeBuilder.addVertexData(&vd);
+    edgeBuilder.addIndexData(&id);
+    EdgeData* edgeData = edgeBuilder.build();
+    std::chrono::duration<double, std::milli> time = std::chrono::steady_clock::now() - start;
+
+    size_t numTriangles = segments * rings * 2;
+    EXPECT_EQ(edgeData->triangles.size(), numTriangles);
+    ASSERT_EQ(edgeData->edgeGroups.size(), 1u);
+    const EdgeData::EdgeList& edges = edgeData->edgeGroups[0].edges;
+    EXPECT_EQ(edges.size(), numTriangles * 3 / 2);
+    EXPECT_TRUE(edgeData->isClosed);
+
+    // the second triangle of every edge must run along it in the opposite direction
+    size_t mismatches = 0;
+    for (const auto& e : edges)
+    {
+        const EdgeData::Triangle& t = edgeData->triangles[e.triIndex[1]];
+        bool found = !e.degenerate && e.triIndex[0] != e.triIndex[1];
+        bool reversed = false;
+        for (int i = 0; i < 3; ++i)
+            reversed |= t.sharedVertIndex[i] == e.sharedVertIndex[1] &&
+                        t.sharedVertIndex[(i + 1) % 3] == e.sharedVertIndex[0];
+        mismatches += !(found && reversed);
+    }
+    EXPECT_EQ(mismatches, 0u);
+
+    std::cout << numTriangles << " triangles: " << time.count() << " ms" << std::endl;
+
+    delete edgeData;
+}
+//--------------------------------------------------------------------------
@@ -47,6 +47,7 @@ THE SOFTWARE.
 #include "OgreSkeletonInstance.h"
 #include "OgreCompositorManager.h"
 #include "OgreTextureManager.h"
+#include "OgreImageCodec.h"
 #include "OgreFileSystem.h"
 #include "OgreArchiveManager.h"
 
@@ -56,8 +57,23 @@ THE SOFTWARE.
 
 #include "OgreBillboardSet.h"
 #include "OgreBillboard.h"
+#include "OgreManualObject.h"
+#include "OgreStaticGeometry.h"
+#include "OgreStaticGeometrySerializer.h"
+#include "OgreWorkQueue.h"
+#include "OgreTangentSpaceCalc.h"
+#include "OgreMeshOptimiser.h"
+#include "OgreMeshSerializer.h"
+#include "OgreBitwise.h"
+#include "OgreSubMesh.h"
+#include "OgreBoundingVolumeHierarchy.h"
+#include "OgreProfileTrace.h"
+#include "OgreEngineStatistics.h"
 
 #include <random>
+#include <array>
+#include <chrono>
+#include <thread>
 using std::minstd_rand;
 
 using namespace Ogre;
@@ -277,6 +293,414 @@ TEST_F(SceneQueryTest, Ray) {
     ASSERT_EQ("397", results[1].movable->getName());
 }
 
+struct SceneQueryBVHTest : public RootWithoutRenderSystemFixture
+{
+    SceneManager* mSceneMgr;
+    Camera* mCamera;
+    std::vector<SceneNode*> mNodes;
+    minstd_rand mRng;
+
+    void SetUp() override
+    {
+        RootWithoutRenderSystemFixture::SetUp();
+
+        mSceneMgr = mRoot->createSceneManager();
+        mCamera = mSceneMgr->createCamera("Camera");
+        mSceneMgr->getRootSceneNode()->attachObject(mCamera);
+    }
+
+    Vector3 randomVector(Real range)
+    {
+        std::uniform_real_distribution<Real> dist(-range, range);
+        return Vector3(dist(mRng), dist(mRng), dist(mRng));
+    }
+
+    /// ManualObjects and BillboardSets, so the results span two movable types
+    void createObjects(size_t count, Real range)
+    {
+        std::uniform_real_distribution<Real> size(1, range / 50);
+        for (size_t i = 0; i < count; ++i)
+        {
+            SceneNode* node = mSceneMgr->getRootSceneNode()->createChildSceneNode(randomVector(range));
+            Vector3 halfSize(size(mRng), size(mRng), size(mRng));
+            AxisAlignedBox box(-halfSize, halfSize);
+            String name = StringConverter::toString(mNodes.size());
+            if (i % 4 == 0)
+            {
+                BillboardSet* bbs = mSceneMgr->createBillboardSet(name);
+                bbs->setBounds(box, halfSize.length());
+                node->attachObject(bbs);
+            }
+            else
+            {
+                ManualObject* mo = mSceneMgr->createManualObject(name);
+                mo->setBoundingBox(box);
+                node->attachObject(mo);
+            }
+            mNodes.push_back(node);
+        }
+    }
+
+    void moveObjects(size_t count, Real range)
+    {
+        for (size_t i = 0; i < count; ++i)
+            mNodes[mRng() % mNodes.size()]->setPosition(randomVector(range));
+    }
+
+    /// Objects in the order the default queries searched the scene before using the hierarchy,
+    /// the queries taking every type
+    std::vector<MovableObject*> getSceneObjects()
+    {
+        std::vector<MovableObject*> objects;
+        for (const auto& f : mRoot->getMovableObjectFactories())
+            for (const auto& m : mSceneMgr->getMovableObjects(f.first))
+                if (m.second->isInScene())
+                    objects.push_back(m.second);
+        return objects;
+    }
+
+    /// Nearest hit of each ray, executing the query once per ray
+    static std::vector<RaySceneQueryResultEntry> castRays(RaySceneQuery* query, const std::vector<Ray>& rays)
+    {
+        std::vector<RaySceneQueryResultEntry> nearest(rays.size());
+        for (size_t i = 0; i < rays.size(); ++i)
+        {
+            query->setRay(rays[i]);
+            nearest[i] = {0, NULL, NULL};
+            for (const auto& r : query->execute())
+            {
+                if (!nearest[i].movable || r.distance < nearest[i].distance)
+                    nearest[i] = r;
+            }
+        }
+        return nearest;
+    }
+
+    static void expectSameHits(const std::vector<RaySceneQueryResultEntry>& hits,
+                               const std::vector<RaySceneQueryResultEntry>& expected)
+    {
+        ASSERT_EQ(hits.size(), expected.size());
+        for (size_t i = 0; i < hits.size(); ++i)
+        {
+            EXPECT_EQ(hits[i].movable, expected[i].movable) << "ray " << i;
+            if (expected[i].movable)
+            {
+                EXPECT_EQ(hits[i].distance, expected[i].distance) << "ray " << i;
+            }
+        }
+    }
+
+    void checkQueries(Real range)
+    {
+        std::vector<MovableObject*> objects = getSceneObjects();
+        std::uniform_real_distribution<Real> size(range / 100, range / 4);
+        for (int i = 0; i < 10; ++i)
+        {
+            Ray ray(randomVector(range), randomVector(1).normalisedCopy());
+            std::vector<std::pair<MovableObject*, Real>> expectedHits, hits;
+            for (auto m : objects)
+            {
+                auto hit = ray.intersects(m->getWorldBoundingBox());
+                if (hit.first)
+                    expectedHits.emplace_back(m, hit.second);
+            }
+            RaySceneQuery* rayQuery = mSceneMgr->createRayQuery(ray);
+            rayQuery->setQueryTypeMask(0xFFFFFFFF);
+            for (const auto& r : rayQuery->execute())
+                hits.emplace_back(r.movable, r.distance);
+            EXPECT_EQ(hits, expectedHits);
+            mSceneMgr->destroyQuery(rayQuery);
+
+            Sphere sphere(randomVector(range), size(mRng));
+            std::vector<MovableObject*> expected, found;
+            for (auto m : objects)
+                if (sphere.intersects(m->getWorldBoundingSphere()))
+                    expected.push_back(m);
+            SphereSceneQuery* sphereQuery = mSceneMgr->createSphereQuery(sphere);
+            sphereQuery->setQueryTypeMask(0xFFFFFFFF);
+            const auto& sphereResult = sphereQuery->execute().movables;
+            found.assign(sphereResult.begin(), sphereResult.end());
+            EXPECT_EQ(found, expected);
+            mSceneMgr->destroyQuery(sphereQuery);
+
+            Vector3 halfSize(size(mRng), size(mRng), size(mRng));
+            Vector3 centre = randomVector(range);
+            AxisAlignedBox box(centre - halfSize, centre + halfSize);
+            expected.clear();
+            for (auto m : objects)
+                if (box.intersects(m->getWorldBoundingBox()))
+                    expected.push_back(m);
+            AxisAlignedBoxSceneQuery* boxQuery = mSceneMgr->createAABBQuery(box);
+            boxQuery->setQueryTypeMask(0xFFFFFFFF);
+            const auto& boxResult = boxQuery->execute().movables;
+            found.assign(boxResult.begin(), boxResult.end());
+            EXPECT_EQ(found, expected);
+            mSceneMgr->destroyQuery(boxQuery);
+
+            // the box cut by a diagonal plane, the normals pointing inside
+            PlaneBoundedVolume volume;
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                Vector3 normal = Vector3::ZERO;
+                normal[axis] = 1;
+                volume.planes.emplace_back(normal, box.getMinimum());
+                volume.planes.emplace_back(-normal, box.getMaximum());
+            }
+            volume.planes.emplace_back(Vector3(1, 1, 1).normalisedCopy(), centre);
+            PlaneBoundedVolumeList volumes(1, volume);
+            expected.clear();
+            for (auto m : objects)
+                if (volume.intersects(m->getWorldBoundingBox()))
+                    expected.push_back(m);
+            PlaneBoundedVolumeListSceneQuery* volumeQuery = mSceneMgr->createPlaneBoundedVolumeQuery(volumes);
+            volumeQuery->setQueryTypeMask(0xFFFFFFFF);
+            const auto& volumeResult = volumeQuery->execute().movables;
+            found.assign(volumeResult.begin(), volumeResult.end());
+            EXPECT_EQ(found, expected);
+            mSceneMgr->destroyQuery(volumeQuery);
+        }
+
+        std::vector<std::pair<MovableObject*, MovableObject*>> expectedPairs, pairs;
+        for (size_t a = 0; a < objects.size(); ++a)
+            for (size_t b = a + 1; b < objects.size(); ++b)
+                if (objects[a]->getWorldBoundingBox().intersects(objects[b]->getWorldBoundingBox()))
+                    expectedPairs.emplace_back(objects[a], objects[b]);
+        IntersectionSceneQuery* intersectionQuery = mSceneMgr->createIntersectionQuery();
+        intersectionQuery->setQueryTypeMask(0xFFFFFFFF);
+        const auto& pairResult = intersectionQuery->execute().movables2movables;
+        pairs.assign(pairResult.begin(), pairResult.end());
+        EXPECT_EQ(pairs, expectedPairs);
+        mSceneMgr->destroyQuery(intersectionQuery);
+    }
+};
+
+TEST_F(SceneQueryBVHTest, MatchesBruteForce)
+{
+    // rebuild right away, rather than waiting for a queue which is not started
+    mRoot->getWorkQueue()->setRequestsAccepted(false);
+
+    createObjects(1000, 1000);
+    ManualObject* infinite = mSceneMgr->createManualObject("infinite");
+    infinite->setBoundingBox(AxisAlignedBox::BOX_INFINITE);
+    mSceneMgr->getRootSceneNode()->attachObject(infinite);
+    mSceneMgr->_updateSceneGraph(mCamera);
+    checkQueries(1000);
+
+    BoundingVolumeHierarchy* bvh = mSceneMgr->_getSceneQueryBVH();
+    EXPECT_EQ(bvh->getObjectCount(), 1001u);
+
+    // refit
+    moveObjects(100, 1000);
+    mSceneMgr->_updateSceneGraph(mCamera);
+    checkQueries(1000);
+
+    // removals
+    for (int i = 0; i < 10; ++i)
+        mNodes[i]->detachAllObjects();
+    mSceneMgr->destroyManualObject("1");
+    mSceneMgr->destroyBillboardSet("12");
+    MovableObject* extracted = mSceneMgr->getManualObject("13");
+    mSceneMgr->extractMovableObject(extracted);
+    mSceneMgr->_updateSceneGraph(mCamera);
+    checkQueries(1000);
+    EXPECT_EQ(bvh->getObjectCount(), 989u);
+
+    // insertions
+    mNodes[0]->attachObject(mSceneMgr->getBillboardSet("0"));
+    mSceneMgr->injectMovableObject(extracted);
+    createObjects(100, 1000);
+    mSceneMgr->_updateSceneGraph(mCamera);
+    checkQueries(1000);
+    EXPECT_EQ(bvh->getObjectCount(), 1091u);
+
+    // the tree gets rebuilt once objects moved all over the scene
+    bvh->rebuild();
+    Real cost = bvh->getCost();
+    for (int i = 0; i < 5; ++i)
+    {
+        moveObjects(mNodes.size(), 1000);
+        mSceneMgr->_updateSceneGraph(mCamera);
+        checkQueries(1000);
+    }
+    EXPECT_LT(bvh->getCost(), cost * 1.5f);
+}
+
+TEST_F(SceneQueryBVHTest, BackgroundRebuild)
+{
+    createObjects(1000, 1000);
+    mSceneMgr->_updateSceneGraph(mCamera);
+    BoundingVolumeHierarchy* bvh = mSceneMgr->_getSceneQueryBVH();
+
+    WorkQueue* wq = mRoot->getWorkQueue();
+    wq->startup();
+    moveObjects(mNodes.size(), 1000);
+    mSceneMgr->_updateSceneGraph(mCamera);
+    EXPECT_TRUE(bvh->isRebuilding());
+    Real cost = bvh->getCost();
+    checkQueries(1000);
+
+    // the changes made while building are applied to the new tree
+    moveObjects(100, 1000);
+    mNodes[2]->detachAllObjects();
+    mSceneMgr->destroyManualObject("3");
+    createObjects(10, 1000);
+    mSceneMgr->_updateSceneGraph(mCamera);
+    while (bvh->isRebuilding())
+        wq->processMainThreadTasks();
+    EXPECT_EQ(bvh->getObjectCount(), 1008u);
+    EXPECT_LT(bvh->getCost(), cost / 2);
+    checkQueries(1000);
+}
+
+TEST_F(SceneQueryBVHTest, RayBatch)
+{
+    createObjects(1000, 1000);
+    // same bounds, so the name decides
+    SceneNode* node = mSceneMgr->getRootSceneNode()->createChildSceneNode(Vector3(2000, 0, 0));
+    for (auto name : {"b", "a"})
+    {
+        ManualObject* mo = mSceneMgr->createManualObject(name);
+        mo->setBoundingBox(AxisAlignedBox(-Vector3::UNIT_SCALE, Vector3::UNIT_SCALE));
+        node->attachObject(mo);
+    }
+    mSceneMgr->_updateSceneGraph(mCamera);
+
+    std::vector<Ray> rays;
+    for (int i = 0; i < 1001; ++i)
+        rays.emplace_back(randomVector(1000), randomVector(1).normalisedCopy());
+    rays.emplace_back(Vector3(1990, 0, 0), Vector3::UNIT_X);
+
+    RaySceneQuery* rayQuery = mSceneMgr->createRayQuery(Ray());
+    rayQuery->setQueryTypeMask(0xFFFFFFFF);
+    std::vector<RaySceneQueryResultEntry> expected = castRays(rayQuery, rays);
+    EXPECT_EQ(expected.back().movable, mSceneMgr->getManualObject("a"));
+    // some rays hit something, the others not
+    EXPECT_NE(std::count_if(expected.begin(), expected.end(), [](const RaySceneQueryResultEntry& e) { return e.movable; }), 0);
+    EXPECT_NE(std::count_if(expected.begin(), expected.end(), [](const RaySceneQueryResultEntry& e) { return !e.movable; }), 0);
+
+    std::vector<RaySceneQueryResultEntry> hits(rays.size());
+    rayQuery->executeBatch(rays.data(), rays.size(), hits.data());
+    expectSameHits(hits, expected);
+
+    // generic version, one ray at a time
+    hits.assign(rays.size(), {1, NULL, NULL});
+    rayQuery->RaySceneQuery::executeBatch(rays.data(), rays.size(), hits.data());
+    expectSameHits(hits, expected);
+
+    mRoot->getWorkQueue()->startup();
+    hits.assign(rays.size(), {1, NULL, NULL});
+    rayQuery->executeBatch(rays.data(), rays.size(), hits.data(), true);
+    expectSameHits(hits, expected);
+
+    // the masks apply
+    rayQuery->setQueryTypeMask(SceneManager::FX_TYPE_MASK);
+    expected = castRays(rayQuery, rays);
+    rayQuery->executeBatch(rays.data(), rays.size(), hits.data(), true);
+    expectSameHits(hits, expected);
+    mSceneMgr->destroyQuery(rayQuery);
+}
+
+TEST_F(SceneQueryBVHTest, Benchmark)
+{
+    const size_t numObjects = 100000;
+    const Real range = 10000;
+    createObjects(numObjects, range);
+    mSceneMgr->_updateSceneGraph(mCamera);
+    std::vector<MovableObject*> objects = getSceneObjects();
+
+    auto start = std::chrono::steady_clock::now();
+    BoundingVolumeHierarchy* bvh = mSceneMgr->_getSceneQueryBVH();
+    std::chrono::duration<double, std::milli> buildTime = std::chrono::steady_clock::now() - start;
+    EXPECT_EQ(bvh->getObjectCount(), numObjects);
+
+    std::vector<Ray> rays;
+    for (int i = 0; i < 100; ++i)
+        rays.emplace_back(randomVector(range), randomVector(1).normalisedCopy());
+
+    start = std::chrono::steady_clock::now();
+    size_t hits = 0;
+    RaySceneQuery* rayQuery = mSceneMgr->createRayQuery(rays[0]);
+    rayQuery->setQueryTypeMask(0xFFFFFFFF);
+    for (const auto& ray : rays)
+    {
+        rayQuery->setRay(ray);
+        hits += rayQuery->execute().size();
+    }
+    std::chrono::duration<double, std::milli> rayTime = std::chrono::steady_clock::now() - start;
+    mSceneMgr->destroyQuery(rayQuery);
+
+    // what the default query did before
+    start = std::chrono::steady_clock::now();
+    size_t expectedHits = 0;
+    for (const auto& ray : rays)
+        for (auto m : objects)
+            expectedHits += ray.intersects(m->getWorldBoundingBox()).first;
+    std::chrono::duration<double, std::milli> bruteForceTime = std::chrono::steady_clock::now() - start;
+    EXPECT_EQ(hits, expectedHits);
+
+    start = std::chrono::steady_clock::now();
+    size_t found = 0;
+    SphereSceneQuery* sphereQuery = mSceneMgr->createSphereQuery(Sphere());
+    sphereQuery->setQueryTypeMask(0xFFFFFFFF);
+    for (int i = 0; i < 100; ++i)
+    {
+        sphereQuery->setSphere(Sphere(randomVector(range), range / 20));
+        found += sphereQuery->execute().movables.size();
+    }
+    std::chrono::duration<double, std::milli> sphereTime = std::chrono::steady_clock::now() - start;
+    mSceneMgr->destroyQuery(sphereQuery);
+
+    start = std::chrono::steady_clock::now();
+    IntersectionSceneQuery* intersectionQuery = mSceneMgr->createIntersectionQuery();
+    intersectionQuery->setQueryTypeMask(0xFFFFFFFF);
+    size_t pairs = intersectionQuery->execute().movables2movables.size();
+    std::chrono::duration<double, std::milli> intersectionTime = std::chrono::steady_clock::now() - start;
+    mSceneMgr->destroyQuery(intersectionQuery);
+
+    moveObjects(numObjects / 10, range);
+    start = std::chrono::steady_clock::now();
+    mSceneMgr->_updateSceneGraph(mCamera);
+    std::chrono::duration<double, std::milli> refitTime = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    bvh->rebuild();
+    std::chrono::duration<double, std::milli> rebuildTime = std::chrono::steady_clock::now() - start;
+
+    std::cout << numObjects << " objects: build " << buildTime.count() << " ms, rebuild " << rebuildTime.count()
+              << " ms, update with 10% moved " << refitTime.count() << " ms" << std::endl;
+    std::cout << "100 rays: " << rayTime.count() << " ms (" << bruteForceTime.count() << " ms brute force), "
+              << hits << " hits" << std::endl;
+    std::cout << "100 spheres: " << sphereTime.count() << " ms, " << found << " found" << std::endl;
+    std::cout << "intersection: " << intersectionTime.count() << " ms, " << pairs << " pairs" << std::endl;
+
+    // nearest hits of many rays, one query per ray against batches
+    rays.clear();
+    for (int i = 0; i < 20000; ++i)
+        rays.emplace_back(randomVector(range), randomVector(1).normalisedCopy());
+    rayQuery = mSceneMgr->createRayQuery(Ray());
+    rayQuery->setQueryTypeMask(0xFFFFFFFF);
+
+    start = std::chrono::steady_clock::now();
+    std::vector<RaySceneQueryResultEntry> expected = castRays(rayQuery, rays);
+    std::chrono::duration<double, std::milli> singleTime = std::chrono::steady_clock::now() - start;
+
+    std::vector<RaySceneQueryResultEntry> nearest(rays.size());
+    start = std::chrono::steady_clock::now();
+    rayQuery->executeBatch(rays.data(), rays.size(), nearest.data());
+    std::chrono::duration<double, std::milli> batchTime = std::chrono::steady_clock::now() - start;
+    expectSameHits(nearest, expected);
+
+    mRoot->getWorkQueue()->startup();
+    start = std::chrono::steady_clock::now();
+    rayQuery->executeBatch(rays.data(), rays.size(), nearest.data(), true);
+    std::chrono::duration<double, std::milli> parallelTime = std::chrono::steady_clock::now() - start;
+    expectSameHits(nearest, expected);
+    mSceneMgr->destroyQuery(rayQuery);
+
+    std::cout << "20000 nearest hits: " << singleTime.count() << " ms one by one, " << batchTime.count()
+              << " ms batched, " << parallelTime.count() << " ms in parallel" << std::endl;
+}
+
 TEST(MaterialSerializer, Basic)
 {
     Root root;
@@ -358,6 +782,73 @@ TEST(Image, Resize)
     ASSERT_TRUE(!memcmp(img.getData(), ref.getData(), ref.getSize()));
 }
 
+TEST(Image, GenerateMipmaps)
+{
+    Image img(PF_BYTE_RGBA, 8, 4);
+    for (uint32 y = 0; y < 4; y++)
+        for (uint32 x = 0; x < 8; x++)
+            img.setColourAt(ColourValue(x % 2 ? 1.0f : 0.0f, y % 2 ? 1.0f : 0.0f, 0.5f, 1), x, y, 0);
+
+    Image mips = img;
+    mips.generateMipmaps();
+    ASSERT_EQ(mips.getNumMipmaps(), 3u);
+    EXPECT_EQ(mips.getPixelBox(0, 3).getWidth(), 1u);
+    EXPECT_EQ(mips.getPixelBox(0, 3).getHeight(), 1u);
+    // top level is preserved
+    EXPECT_TRUE(!memcmp(mips.getData(), img.getData(), img.getSize()));
+
+    // box filter averages the 2x2 blocks
+    ColourValue c;
+    PixelUtil::unpackColour(&c, PF_BYTE_RGBA, mips.getPixelBox(0, 1).data);
+    EXPECT_NEAR(c.r, 0.5f, 1 / 255.0f);
+    EXPECT_NEAR(c.g, 0.5f, 1 / 255.0f);
+    EXPECT_NEAR(c.b, 0.5f, 1 / 255.0f);
+
+    // filtering in linear space makes the average brighter
+    Image srgb = img;
+    srgb.generateMipmaps(true);
+    PixelUtil::unpackColour(&c, PF_BYTE_RGBA, srgb.getPixelBox(0, 1).data);
+    EXPECT_NEAR(c.r, 0.735f, 2 / 255.0f);
+    EXPECT_NEAR(c.b, 0.5f, 1 / 255.0f);
+    EXPECT_NEAR(c.a, 1.0f, 1 / 255.0f);
+
+    // the sinc filters keep a constant image constant
+    for (auto filter : {Image::FILTER_KAISER, Image::FILTER_LANCZOS})
+    {
+        Image flat(PF_FLOAT32_RGBA, 16, 16);
+        for (uint32 y = 0; y < 16; y++)
+            for (uint32 x = 0; x < 16; x++)
+                flat.setColourAt(ColourValue(0.25f, 0.5f, 0.75f, 1), x, y, 0);
+        flat.generateMipmaps(false, filter);
+        ASSERT_EQ(flat.getNumMipmaps(), 4u);
+        for (uint32 mip = 1; mip <= 4; mip++)
+        {
+            const float* p = (const float*)flat.getPixelBox(0, mip).data;
+            EXPECT_NEAR(p[0], 0.25f, 1e-5f);
+            EXPECT_NEAR(p[1], 0.5f, 1e-5f);
+            EXPECT_NEAR(p[2], 0.75f, 1e-5f);
+        }
+    }
+}
+
+TEST(Image, ScaleFilters)
+{
+    // horizontal ramp
+    Image img(PF_FLOAT32_R, 64, 2);
+    for (uint32 y = 0; y < 2; y++)
+        for (uint32 x = 0; x < 64; x++)
+            img.setColourAt(ColourValue(x / 63.0f, 0, 0), x, y, 0);
+
+    for (auto filter : {Image::FILTER_BOX, Image::FILTER_KAISER, Image::FILTER_LANCZOS})
+    {
+        Image dst(PF_BYTE_RGBA, 16, 2);
+        Image::scale(img.getPixelBox(), dst.getPixelBox(), filter);
+        // the ramp is preserved away from the borders
+        for (uint32 x = 3; x < 13; x++)
+            EXPECT_NEAR(dst.getColourAt(x, 1, 0).r, (x * 4 + 1.5f) / 63.0f, 1 / 255.0f);
+    }
+}
+
 
 TEST(Image, Combine)
 {
@@ -425,6 +916,70 @@ TEST(Image, Compressed)
 #endif
 }
 
+namespace
+{
+/// reassembles the levels from the bands
+struct BandCollector : public ImageCodec::BandListener
+{
+    Image img;
+    uint32 bands = 0;
+    bool imageHeaderDecoded(uint32 width, uint32 height, PixelFormat format, uint32 numMipmaps) override
+    {
+        img.create(format, width, height, 1, 1, numMipmaps);
+        return true;
+    }
+    void bandDecoded(uint32 mip, uint32 top, const PixelBox& band) override
+    {
+        PixelBox level = img.getPixelBox(0, mip);
+        size_t offset = PixelUtil::getMemorySize(level.getWidth(), top, 1, level.format);
+        ASSERT_LE(offset + band.getConsecutiveSize(), level.getConsecutiveSize());
+        memcpy(level.data + offset, band.data, band.getConsecutiveSize());
+        bands++;
+    }
+};
+} // namespace
+
+TEST(ImageCodec, DecodeBands)
+{
+    Root root;
+
+    Image ref(PF_BYTE_RGBA, 64, 64);
+    for (uint32 i = 0; i < ref.getSize(); i++)
+        ref.getData()[i] = uint8(i * 7);
+    ref.generateMipmaps();
+
+#if OGRE_NO_DDS_CODEC == 0
+    {
+        BandCollector collector;
+        auto codec = static_cast<ImageCodec*>(Codec::getCodec("dds"));
+        ASSERT_TRUE(codec->decodeBands(ref.encode("dds"), &collector, 1024));
+        // 4 rows per band in the top level, 8 rows in the next and the rest at once
+        EXPECT_EQ(collector.bands, 16u + 4 + 5);
+        ASSERT_EQ(collector.img.getSize(), ref.getSize());
+        EXPECT_TRUE(!memcmp(collector.img.getData(), ref.getData(), ref.getSize()));
+    }
+#endif
+
+#if OGRE_NO_ETC_CODEC == 0
+    {
+        Image img = ref;
+        img.compress(PF_ETC2_RGBA8);
+        BandCollector collector;
+        auto codec = static_cast<ImageCodec*>(Codec::getCodec("ktx"));
+        ASSERT_TRUE(codec->decodeBands(img.encode("ktx"), &collector, 1024));
+        // 4 rows of blocks per band in the top level and the rest at once
+        EXPECT_EQ(collector.bands, 4u + 6);
+        ASSERT_EQ(collector.img.getSize(), img.getSize());
+        EXPECT_TRUE(!memcmp(collector.img.getData(), img.getData(), img.getSize()));
+
+        // not supported by pkm
+        BandCollector unused;
+        codec = static_cast<ImageCodec*>(Codec::getCodec("pkm"));
+        EXPECT_FALSE(codec->decodeBands(img.encode("ktx"), &unused, 1024));
+    }
+#endif
+}
+
 struct UsePreviousResourceLoadingListener : public ResourceLoadingListener
 {
     bool resourceCollision(Resource *resource, ResourceManager *resourceManager) override { return false; }
@@ -695,4 +1250,721 @@ TEST(Billboard, TextureCoords)
             bb->setTexcoordIndex((ysegs - y - 1)*xsegs + x);
         }
     }
-}
\ No newline at end of file
+}
+TEST(WorkQueue, parallelFor)
+{
+    Root root("");
+    WorkQueue* wq = root.getWorkQueue();
+    wq->startup();
+
+    std::vector<int> visited(1000);
+    wq->parallelFor(0, visited.size(),
+                    [&visited](size_t first, size_t last)
+                    {
+                        for (size_t i = first; i < last; ++i)
+                            visited[i]++;
+                    },
+                    7);
+    EXPECT_EQ(std::count(visited.begin(), visited.end(), 1), 1000);
+
+    EXPECT_THROW(wq->parallelFor(0, 10, [](size_t, size_t) { OGRE_EXCEPT(Exception::ERR_INTERNAL_ERROR, "fail"); }),
+                 InternalErrorException);
+}
+
+static size_t countOccurrences(const String& str, const String& pattern)
+{
+    size_t n = 0;
+    for (size_t pos = str.find(pattern); pos != String::npos; pos = str.find(pattern, pos + 1))
+        n++;
+    return n;
+}
+
+static String traceThreadOf(const String& trace, const String& name)
+{
+    size_t pos = trace.find("\"tid\":", trace.find("\"name\":\"" + name + "\""));
+    return trace.substr(pos, trace.find(',', pos) - pos);
+}
+
+TEST(ProfileTrace, ChromeTrace)
+{
+    ProfileTrace::clear();
+    {
+        OgreTraceScope("disabled");
+    }
+
+    ProfileTrace::setEnabled(true);
+    ProfileTrace::setThreadName("Test \"main\"");
+    {
+        OgreTraceScope("outer");
+        for (int i = 0; i < 2; i++)
+        {
+            OgreTraceScope("inner");
+        }
+    }
+    // the begin of this one is not recorded
+    ProfileTrace::end(ProfileTrace::intern("orphan"));
+
+    std::thread worker([]() {
+        ProfileTrace::setThreadName("worker");
+        OgreTraceScope("work");
+    });
+    worker.join();
+    ProfileTrace::setEnabled(false);
+
+    std::ostringstream os;
+    ProfileTrace::writeChromeTrace(os);
+    String trace = os.str();
+    ProfileTrace::clear();
+
+    EXPECT_EQ(trace.find("{\"traceEvents\":["), 0u);
+    EXPECT_EQ(countOccurrences(trace, "\"name\":\"outer\""), 1u);
+    EXPECT_EQ(countOccurrences(trace, "\"name\":\"inner\""), 2u);
+    EXPECT_EQ(countOccurrences(trace, "\"name\":\"work\""), 1u);
+    EXPECT_EQ(countOccurrences(trace, "disabled"), 0u);
+    EXPECT_EQ(countOccurrences(trace, "orphan"), 0u);
+    EXPECT_EQ(countOccurrences(trace, "\"name\":\"Test \\\"main\\\"\""), 1u);
+
+    EXPECT_EQ(traceThreadOf(trace, "outer"), traceThreadOf(trace, "inner"));
+    EXPECT_EQ(traceThreadOf(trace, "outer"), traceThreadOf(trace, "Test \\\"main\\\""));
+    EXPECT_EQ(traceThreadOf(trace, "work"), traceThreadOf(trace, "worker"));
+    EXPECT_NE(traceThreadOf(trace, "outer"), traceThreadOf(trace, "work"));
+}
+
+TEST(ProfileTrace, RingBuffer)
+{
+    ProfileTrace::setThreadBufferSize(16);
+    ProfileTrace::setEnabled(true);
+    std::thread worker([]() {
+        for (int i = 0; i < 100; i++)
+        {
+            OgreTraceScope("loop");
+        }
+    });
+    worker.join();
+    ProfileTrace::setEnabled(false);
+    ProfileTrace::setThreadBufferSize(65536);
+
+    std::ostringstream os;
+    ProfileTrace::writeChromeTrace(os);
+    ProfileTrace::clear();
+
+    // the oldest slot may be half overwritten, which leaves its end event without begin
+    EXPECT_EQ(countOccurrences(os.str(), "\"name\":\"loop\""), 7u);
+}
+
+TEST(EngineStatistics, Counters)
+{
+    typedef EngineStatistics ES;
+    ES::reset();
+    ES::CounterId custom = ES::registerCounter("custom");
+    EXPECT_EQ(ES::registerCounter("custom"), custom);
+    EXPECT_GE(custom, uint32(ES::SC_BUILTIN_COUNT));
+    EXPECT_EQ(ES::getCounterName(custom), "custom");
+    EXPECT_EQ(ES::getCounterName(ES::SC_SET_PASS), "set_pass");
+
+    ES::add(custom, 5);
+    ES::setEnabled(true);
+    ES::add(custom, 2);
+    std::thread worker([custom]() { ES::add(custom, 3); });
+    worker.join();
+    ES::_sampleFrame(1);
+
+    ES::add(custom);
+    ES::_sampleFrame(2);
+    ES::setEnabled(false);
+    ES::add(custom, 100);
+    ES::_sampleFrame(3);
+
+    EXPECT_EQ(ES::getFrameValue(custom), 1u);
+    EXPECT_EQ(ES::getTotalValue(custom), 6u);
+
+    ES::SampleList history = ES::getHistory();
+    ASSERT_EQ(history.size(), 2u);
+    EXPECT_EQ(history[0].frame, 1u);
+    EXPECT_EQ(history[0].values[custom], 5u);
+    EXPECT_EQ(history[1].values[custom], 1u);
+
+    std::ostringstream csv;
+    ES::writeCSV(csv);
+    StringVector lines = StringUtil::split(csv.str(), "\n");
+    ASSERT_EQ(lines.size(), 3u);
+    EXPECT_EQ(lines[0].find("frame,duration_us,visible_objects,"), 0u);
+    EXPECT_EQ(StringUtil::split(lines[0], ",")[custom + 2], "custom");
+    EXPECT_EQ(StringUtil::split(lines[1], ",")[custom + 2], "5");
+
+    std::ostringstream json;
+    ES::writeJSON(json);
+    EXPECT_EQ(countOccurrences(json.str(), "\"custom\":6"), 1u);
+    EXPECT_EQ(countOccurrences(json.str(), "\"custom\":5"), 1u);
+    EXPECT_EQ(countOccurrences(json.str(), "\"frame\":"), 2u);
+
+    ES::setHistorySize(1);
+    EXPECT_EQ(ES::getHistory().size(), 1u);
+    ES::setHistorySize(300);
+    ES::reset();
+    EXPECT_EQ(ES::getTotalValue(custom), 0u);
+    EXPECT_TRUE(ES::getHistory().empty());
+}
+
+struct SortKeyRenderable : public Renderable
+{
+    MaterialPtr material;
+    Real depth;
+
+    SortKeyRenderable(const MaterialPtr& mat, Real d) : material(mat), depth(d) {}
+    const MaterialPtr& getMaterial(void) const override { return material; }
+    void getRenderOperation(RenderOperation& op) override { op.vertexData = NULL; }
+    void getWorldTransforms(Matrix4* xform) const override { *xform = Matrix4::IDENTITY; }
+    Real getSquaredViewDepth(const Camera*) const override { return depth; }
+    const LightList& getLights(void) const override
+    {
+        static LightList lights;
+        return lights;
+    }
+};
+
+struct RecordingVisitor : public QueuedRenderableVisitor
+{
+    std::vector<std::pair<const Pass*, RenderableList>> groups;
+
+    void visit(RenderablePass* rp) override { groups.emplace_back(rp->pass, RenderableList(1, rp->renderable)); }
+    void visit(const Pass* p, RenderableList& rs) override { groups.emplace_back(p, rs); }
+};
+
+typedef RootWithoutRenderSystemFixture SortKeyTests;
+TEST_F(SortKeyTests, SinglePass)
+{
+    MaterialPtr mat = MaterialManager::getSingleton().create("sortKey", RGN_DEFAULT);
+    Pass* pass = mat->getTechnique(0)->getPass(0);
+
+    // enough renderables for the radix sort, at depths the keys do not quantise together
+    std::vector<SortKeyRenderable> rends;
+    for (int i = 0; i < 3000; i++)
+        rends.emplace_back(mat, Real(uint32(1) << ((i * 7) % 24)));
+
+    QueuedRenderableCollection collection;
+    collection.addOrganisationMode(QueuedRenderableCollection::OM_SORT_KEY);
+    for (auto& r : rends)
+        collection.addRenderable(pass, &r);
+    collection.sort(NULL);
+
+    // the SceneManager asks for pass groups, which falls back to the sort keys
+    RecordingVisitor visitor;
+    collection.acceptVisitor(&visitor, QueuedRenderableCollection::OM_PASS_GROUP);
+
+    ASSERT_EQ(visitor.groups.size(), 1u);
+    const RenderableList& group = visitor.groups[0].second;
+    ASSERT_EQ(group.size(), rends.size());
+    for (size_t i = 1; i < group.size(); i++)
+        EXPECT_LE(group[i - 1]->getSquaredViewDepth(NULL), group[i]->getSquaredViewDepth(NULL));
+}
+
+TEST_F(SortKeyTests, PassOrder)
+{
+    MaterialPtr matA = MaterialManager::getSingleton().create("sortKeyA", RGN_DEFAULT);
+    MaterialPtr matB = MaterialManager::getSingleton().create("sortKeyB", RGN_DEFAULT);
+    matB->getTechnique(0)->createPass();
+
+    std::vector<SortKeyRenderable> rends;
+    for (int i = 0; i < 20; i++)
+        rends.emplace_back(i % 2 ? matA : matB, Real(20 - i));
+
+    QueuedRenderableCollection collection;
+    collection.addOrganisationMode(QueuedRenderableCollection::OM_SORT_KEY);
+    for (auto& r : rends)
+    {
+        for (auto* p : r.getMaterial()->getTechnique(0)->getPasses())
+            collection.addRenderable(p, &r);
+    }
+    collection.sort(NULL);
+
+    RecordingVisitor visitor;
+    collection.acceptVisitor(&visitor, QueuedRenderableCollection::OM_SORT_KEY);
+
+    // the second passes come after all the first ones, each run is front to back
+    size_t visited = 0;
+    ushort lastIndex = 0;
+    for (const auto& g : visitor.groups)
+    {
+        EXPECT_GE(g.first->getIndex(), lastIndex);
+        lastIndex = g.first->getIndex();
+        for (size_t i = 1; i < g.second.size(); i++)
+            EXPECT_LE(g.second[i - 1]->getSquaredViewDepth(NULL), g.second[i]->getSquaredViewDepth(NULL));
+        visited += g.second.size();
+    }
+    EXPECT_EQ(visited, 30u);
+    EXPECT_EQ(visitor.groups.back().first, matB->getTechnique(0)->getPass(1));
+}
+
+typedef RootWithoutRenderSystemFixture BillboardSetTests;
+TEST_F(BillboardSetTests, injectBillboards)
+{
+    SceneManager* sm = mRoot->createSceneManager();
+    Camera* cam = sm->createCamera("cam");
+    sm->getRootSceneNode()->createChildSceneNode(Vector3(10, 20, 100))->attachObject(cam);
+    SceneNode* node = sm->getRootSceneNode()->createChildSceneNode();
+
+    std::vector<Billboard> billboards(5);
+    for (size_t i = 0; i < billboards.size(); i++)
+    {
+        billboards[i].mPosition = Vector3(i, 2 * i, -3.0f * i);
+        billboards[i].mDirection = Vector3(1, i, 0).normalisedCopy();
+        billboards[i].mColour = i;
+    }
+    billboards[1].setDimensions(3, 4);
+    billboards[2].setRotation(Degree(30));
+
+    for (auto type : {BBT_POINT, BBT_ORIENTED_COMMON, BBT_ORIENTED_SELF, BBT_PERPENDICULAR_COMMON,
+                      BBT_PERPENDICULAR_SELF})
+    {
+        for (bool accurateFacing : {false, true})
+        {
+            std::vector<float> vertices[2];
+            for (int batched = 0; batched < 2; batched++)
+            {
+                BillboardSet bbs("bbs", billboards.size(), true);
+                bbs.setBillboardType(type);
+                bbs.setUseAccurateFacing(accurateFacing);
+                node->attachObject(&bbs);
+                bbs._notifyCurrentCamera(cam);
+
+                bbs.beginBillboards(billboards.size());
+                if (batched)
+                    bbs.injectBillboards(billboards.data(), billboards.size());
+                else
+                    for (const auto& bb : billboards)
+                        bbs.injectBillboard(bb);
+                bbs.endBillboards();
+
+                RenderOperation op;
+                bbs.getRenderOperation(op);
+                auto buf = op.vertexData->vertexBufferBinding->getBuffer(0);
+                vertices[batched].resize(buf->getSizeInBytes() / sizeof(float));
+                buf->readData(0, buf->getSizeInBytes(), vertices[batched].data());
+                node->detachObject(&bbs);
+            }
+            EXPECT_EQ(vertices[0], vertices[1]) << "type " << type << " accurate facing " << accurateFacing;
+        }
+    }
+}
+
+struct StaticGeometryProgress : public StaticGeometry::Listener
+{
+    std::atomic<size_t> prepared{0};
+    size_t finished = 0;
+    void regionPrepared(StaticGeometry*, size_t, size_t) override { prepared++; }
+    void buildFinished(StaticGeometry*) override { finished++; }
+};
+
+static std::vector<float> getStaticGeometryVertices(StaticGeometry* geom)
+{
+    std::vector<float> ret;
+    for (const auto& r : geom->getRegions())
+    {
+        for (auto lod : r.second->getLODBuckets())
+        {
+            for (const auto& mat : lod->getMaterialBuckets())
+            {
+                for (auto bucket : mat.second->getGeometryList())
+                {
+                    auto buf = bucket->getVertexData()->vertexBufferBinding->getBuffer(0);
+                    size_t offset = ret.size();
+                    ret.resize(offset + buf->getSizeInBytes() / sizeof(float));
+                    buf->readData(0, buf->getSizeInBytes(), ret.data() + offset);
+                }
+            }
+        }
+    }
+    return ret;
+}
+
+static StaticGeometry* createStaticGeometry(SceneManager* sceneMgr)
+{
+    ManualObject mo("quad");
+    mo.begin("BaseWhite");
+    mo.position(0, 0, 0);
+    mo.normal(0, 0, 1);
+    mo.position(1, 0, 0);
+    mo.normal(0, 0, 1);
+    mo.position(1, 1, 0);
+    mo.normal(0, 0, 1);
+    mo.position(0, 1, 0);
+    mo.normal(0, 0, 1);
+    mo.quad(0, 1, 2, 3);
+    mo.end();
+    mo.convertToMesh("quad.mesh");
+    Entity* ent = sceneMgr->createEntity("quad.mesh");
+
+    StaticGeometry* geom = sceneMgr->createStaticGeometry("static");
+    geom->setRegionDimensions(Vector3(10));
+    for (int i = 0; i < 50; i++)
+        geom->addEntity(ent, Vector3(i * 3, i % 7, 0), Quaternion(Degree(i), Vector3::UNIT_Y), Vector3(1, 2, 1));
+    return geom;
+}
+
+TEST_F(SceneNodeTest, StaticGeometryBuild)
+{
+    StaticGeometry* geom = createStaticGeometry(mSceneMgr);
+
+    StaticGeometryProgress progress;
+    geom->setListener(&progress);
+
+    geom->build();
+    auto numRegions = geom->getRegions().size();
+    EXPECT_GT(numRegions, 1u);
+    EXPECT_EQ(progress.prepared, numRegions);
+    EXPECT_EQ(progress.finished, 1u);
+    auto reference = getStaticGeometryVertices(geom);
+    EXPECT_FALSE(reference.empty());
+
+    geom->setParallelBuild(true);
+    geom->build();
+    EXPECT_EQ(getStaticGeometryVertices(geom), reference);
+
+    WorkQueue* wq = mRoot->getWorkQueue();
+    wq->startup();
+    geom->buildInBackground();
+    EXPECT_TRUE(geom->isBuilding());
+    while (geom->isBuilding())
+        wq->processMainThreadTasks();
+    EXPECT_EQ(progress.prepared, 3 * numRegions);
+    EXPECT_EQ(progress.finished, 3u);
+    EXPECT_EQ(getStaticGeometryVertices(geom), reference);
+
+    // cancelling a background build
+    geom->buildInBackground();
+    geom->destroy();
+    EXPECT_FALSE(geom->isBuilding());
+    EXPECT_TRUE(geom->getRegions().empty());
+    wq->processMainThreadTasks();
+    EXPECT_EQ(progress.finished, 3u);
+}
+
+TEST_F(SceneNodeTest, StaticGeometrySerializer)
+{
+    StaticGeometry* geom = createStaticGeometry(mSceneMgr);
+    geom->build();
+    auto numRegions = geom->getRegions().size();
+    auto reference = getStaticGeometryVertices(geom);
+
+    StaticGeometrySerializer serializer;
+    auto buffer = std::make_shared<MemoryDataStream>(1 << 20);
+    serializer.exportStaticGeometry(geom, buffer);
+    auto stream = std::make_shared<MemoryDataStream>(buffer->getPtr(), buffer->tell());
+
+    StaticGeometry* loaded = mSceneMgr->createStaticGeometry("loaded");
+    serializer.importStaticGeometry(stream, loaded);
+    EXPECT_EQ(loaded->getRegionDimensions(), geom->getRegionDimensions());
+    EXPECT_EQ(loaded->getRegions().size(), numRegions);
+    EXPECT_EQ(getStaticGeometryVertices(loaded), reference);
+
+    // only the region headers are read, the geometry follows once a camera needs it
+    stream->seek(0);
+    serializer.importStaticGeometry(stream, loaded, true);
+    EXPECT_EQ(loaded->getRegions().size(), numRegions);
+    EXPECT_TRUE(getStaticGeometryVertices(loaded).empty());
+
+    Camera* cam = mSceneMgr->createCamera("cam");
+    WorkQueue* wq = mRoot->getWorkQueue();
+    wq->startup();
+    for (const auto& r : loaded->getRegions())
+    {
+        EXPECT_TRUE(r.second->isStreamed());
+        EXPECT_FALSE(r.second->isLoaded());
+        r.second->_notifyCurrentCamera(cam);
+    }
+
+    auto allLoaded = [loaded]()
+    {
+        for (const auto& r : loaded->getRegions())
+            if (!r.second->isLoaded())
+                return false;
+        return true;
+    };
+    while (!allLoaded())
+        wq->processMainThreadTasks();
+    EXPECT_EQ(getStaticGeometryVertices(loaded), reference);
+}
+
+typedef RootWithoutRenderSystemFixture TangentSpaceCalcTests;
+TEST_F(TangentSpaceCalcTests, MirroredSplits)
+{
+    // two triangles sharing the edge 0-2, with the texture mirrored along it
+    const float vertices[] = {
+        // position, normal, uv
+        0, 0, 0,  0, 0, 1,  0, 0,
+        1, 0, 0,  0, 0, 1,  1, 0,
+        0, 1, 0,  0, 0, 1,  0, 1,
+        -1, 0, 0, 0, 0, 1,  1, 0};
+    const uint16 indexes[] = {0, 1, 2, 0, 2, 3};
+
+    for (bool split : {false, true})
+    {
+        VertexData vd;
+        vd.vertexCount = 4;
+        vd.vertexDeclaration->addElement(0, 0, VET_FLOAT3, VES_POSITION);
+        vd.vertexDeclaration->addElement(0, 12, VET_FLOAT3, VES_NORMAL);
+        vd.vertexDeclaration->addElement(0, 24, VET_FLOAT2, VES_TEXTURE_COORDINATES);
+        auto vbuf = HardwareBufferManager::getSingleton().createVertexBuffer(32, 4, HBU_CPU_ONLY);
+        vbuf->writeData(0, sizeof(vertices), vertices);
+        vd.vertexBufferBinding->setBinding(0, vbuf);
+
+        IndexData id;
+        id.indexCount = 6;
+        id.indexBuffer =
+            HardwareBufferManager::getSingleton().createIndexBuffer(HardwareIndexBuffer::IT_16BIT, 6, HBU_CPU_ONLY);
+        id.indexBuffer->writeData(0, sizeof(indexes), indexes);
+
+        TangentSpaceCalc calc;
+        calc.setSplitMirrored(split);
+        calc.setStoreParityInW(true);
+        calc.setVertexData(&vd);
+        calc.addIndexData(&id);
+        TangentSpaceCalc::Result res = calc.build();
+
+        // the second triangle gets its own copies of the shared vertices
+        EXPECT_EQ(res.vertexSplits.size(), split ? 2u : 0u);
+        EXPECT_EQ(res.indexesRemapped.size(), split ? 2u : 0u);
+        ASSERT_EQ(vd.vertexCount, split ? 6u : 4u);
+        if (!split)
+            continue;
+
+        uint16 newIndexes[6];
+        id.indexBuffer->readData(0, sizeof(newIndexes), newIndexes);
+        EXPECT_EQ(std::vector<uint16>(newIndexes, newIndexes + 6), std::vector<uint16>({0, 1, 2, 4, 5, 3}));
+
+        const VertexElement* elem = vd.vertexDeclaration->findElementBySemantic(VES_TANGENT);
+        auto tbuf = vd.vertexBufferBinding->getBuffer(elem->getSource());
+        for (int i = 0; i < 6; ++i)
+        {
+            // +X with parity -1 for the first triangle, mirrored for the second one
+            float tangent[4];
+            tbuf->readData(newIndexes[i] * tbuf->getVertexSize() + elem->getOffset(), sizeof(tangent), tangent);
+            float dir = i < 3 ? 1 : -1;
+            EXPECT_FLOAT_EQ(tangent[0], dir);
+            EXPECT_FLOAT_EQ(tangent[1], 0);
+            EXPECT_FLOAT_EQ(tangent[3], -dir);
+        }
+    }
+}
+
+typedef RootWithoutRenderSystemFixture MeshOptimiserTests;
+TEST_F(MeshOptimiserTests, ShuffledGrid)
+{
+    // a grid with the triangles in random order, the position encodes the original vertex index
+    const uint32 N = 64;
+    std::vector<float> positions;
+    for (uint32 y = 0; y < N; ++y)
+        for (uint32 x = 0; x < N; ++x)
+            positions.insert(positions.end(), {float(x), float(y), 0});
+
+    std::vector<std::array<uint32, 3>> triangles;
+    for (uint32 y = 0; y + 1 < N; ++y)
+    {
+        for (uint32 x = 0; x + 1 < N; ++x)
+        {
+            uint32 i = y * N + x;
+            triangles.push_back({i, i + 1, i + N});
+            triangles.push_back({i + 1, i + N + 1, i + N});
+        }
+    }
+    std::shuffle(triangles.begin(), triangles.end(), std::mt19937(42));
+
+    auto createIndexData = [](const std::array<uint32, 3>* tris, size_t count) {
+        auto id = new IndexData();
+        id->indexCount = count * 3;
+        id->indexBuffer = HardwareBufferManager::getSingleton().createIndexBuffer(
+            HardwareIndexBuffer::IT_16BIT, id->indexCount, HBU_CPU_ONLY);
+        std::vector<uint16> indexes;
+        for (size_t t = 0; t < count; ++t)
+            indexes.insert(indexes.end(), tris[t].begin(), tris[t].end());
+        id->indexBuffer->writeData(0, id->indexBuffer->getSizeInBytes(), indexes.data());
+        return id;
+    };
+
+    MeshPtr mesh = MeshManager::getSingleton().createManual("grid", RGN_DEFAULT);
+    mesh->sharedVertexData = new VertexData();
+    mesh->sharedVertexData->vertexCount = N * N;
+    mesh->sharedVertexData->vertexDeclaration->addElement(0, 0, VET_FLOAT3, VES_POSITION);
+    auto vbuf = HardwareBufferManager::getSingleton().createVertexBuffer(12, N * N, HBU_CPU_ONLY);
+    vbuf->writeData(0, vbuf->getSizeInBytes(), positions.data());
+    mesh->sharedVertexData->vertexBufferBinding->setBinding(0, vbuf);
+
+    SubMesh* sm = mesh->createSubMesh();
+    sm->useSharedVertices = true;
+    delete sm->indexData;
+    sm->indexData = createIndexData(triangles.data(), triangles.size());
+    // a LOD level using half of the triangles
+    sm->mLodFaceList.push_back(createIndexData(triangles.data(), triangles.size() / 2));
+
+    for (uint32 v = 0; v < N * N; v += 7)
+    {
+        VertexBoneAssignment vba = {v, ushort(v % 4), 1.0f};
+        mesh->addBoneAssignment(vba);
+    }
+
+    // the triangles, as the original vertex indexes, with the smallest one first
+    auto getTriangles = [&](const IndexData* id) {
+        std::vector<uint16> indexes(id->indexCount);
+        id->indexBuffer->readData(0, id->indexBuffer->getSizeInBytes(), indexes.data());
+        std::vector<std::array<uint32, 3>> ret;
+        for (size_t i = 0; i < indexes.size(); i += 3)
+        {
+            std::array<uint32, 3> tri;
+            for (int k = 0; k < 3; ++k)
+            {
+                float pos[3];
+                vbuf->readData(indexes[i + k] * 12, 12, pos);
+                tri[k] = uint32(pos[1]) * N + uint32(pos[0]);
+            }
+            std::rotate(tri.begin(), std::min_element(tri.begin(), tri.end()), tri.end());
+            ret.push_back(tri);
+        }
+        std::sort(ret.begin(), ret.end());
+        return ret;
+    };
+    auto trianglesBefore = getTriangles(sm->indexData);
+    auto lodTrianglesBefore = getTriangles(sm->mLodFaceList[0]);
+
+    MeshOptimiser optimiser;
+    auto before = optimiser.analyse(mesh.get());
+    optimiser.optimise(mesh.get());
+    auto after = optimiser.analyse(mesh.get());
+    std::cout << "ACMR " << before.getACMR() << " -> " << after.getACMR() << ", ATVR " << before.getATVR()
+              << " -> " << after.getATVR() << std::endl;
+
+    EXPECT_EQ(before.triangles, after.triangles);
+    EXPECT_EQ(before.vertices, after.vertices);
+    EXPECT_GT(before.getACMR(), 2.0f);
+    EXPECT_LT(after.getACMR(), 0.9f);
+
+    // same triangles, same winding
+    EXPECT_EQ(getTriangles(sm->indexData), trianglesBefore);
+    EXPECT_EQ(getTriangles(sm->mLodFaceList[0]), lodTrianglesBefore);
+
+    // vertices in order of first use
+    std::vector<uint16> indexes(sm->indexData->indexCount);
+    sm->indexData->indexBuffer->readData(0, sm->indexData->indexBuffer->getSizeInBytes(), indexes.data());
+    uint32 nextVertex = 0;
+    for (uint16 i : indexes)
+    {
+        ASSERT_LE(i, nextVertex);
+        if (i == nextVertex)
+            nextVertex++;
+    }
+
+    // bone assignments follow their vertices
+    EXPECT_EQ(mesh->getBoneAssignments().size(), size_t((N * N + 6) / 7));
+    for (const auto& a : mesh->getBoneAssignments())
+    {
+        float pos[3];
+        vbuf->readData(a.second.vertexIndex * 12, 12, pos);
+        uint32 original = uint32(pos[1]) * N + uint32(pos[0]);
+        EXPECT_EQ(original % 7, 0u);
+        EXPECT_EQ(a.second.boneIndex, original % 4);
+    }
+}
+
+typedef RootWithoutRenderSystemFixture MeshQuantisationTests;
+TEST_F(MeshQuantisationTests, SerializeRoundTrip)
+{
+    MeshPtr mesh = MeshManager::getSingleton().createPlane("plane", RGN_DEFAULT, Plane(Vector3::UNIT_Z, 0), 100,
+                                                           50, 4, 4, true, 1, 2, 3);
+    VertexData* vdata = mesh->sharedVertexData;
+    ASSERT_TRUE(vdata);
+    auto vbuf = vdata->vertexBufferBinding->getBuffer(0);
+    std::vector<float> original(vbuf->getSizeInBytes() / sizeof(float));
+    vbuf->readData(0, vbuf->getSizeInBytes(), original.data());
+    size_t floatSize = vbuf->getSizeInBytes();
+
+    vdata->convertVertexElement(VES_TEXTURE_COORDINATES, VET_HALF2);
+    vdata->convertVertexElement(VES_NORMAL, VET_INT_10_10_10_2_NORM);
+    mesh->_quantisePositions();
+    EXPECT_EQ(mesh->getQuantisationBounds(), AxisAlignedBox(-50, -25, 0, 50, 25, 0));
+
+    MeshSerializer serializer;
+    auto buffer = std::make_shared<MemoryDataStream>(1 << 16);
+    serializer.exportMesh(mesh.get(), buffer);
+    auto stream = std::make_shared<MemoryDataStream>(buffer->getPtr(), buffer->tell());
+
+    MeshPtr loaded = MeshManager::getSingleton().createManual("loaded", RGN_DEFAULT);
+    serializer.importMesh(stream, loaded.get());
+    EXPECT_EQ(loaded->getQuantisationBounds(), mesh->getQuantisationBounds());
+
+    vdata = loaded->sharedVertexData;
+    auto decl = vdata->vertexDeclaration;
+    EXPECT_EQ(decl->findElementBySemantic(VES_POSITION)->getType(), VET_SHORT4_NORM);
+    // unpacked again, as there is no render system to support it
+    EXPECT_EQ(decl->findElementBySemantic(VES_NORMAL)->getType(), VET_FLOAT3);
+    EXPECT_EQ(decl->findElementBySemantic(VES_TEXTURE_COORDINATES)->getType(), VET_HALF2);
+
+    // 8 + 12 + 4 instead of 12 + 12 + 8 bytes
+    vbuf = vdata->vertexBufferBinding->getBuffer(0);
+    EXPECT_EQ(vbuf->getSizeInBytes() * 4, floatSize * 3);
+
+    std::vector<uint8> data(vbuf->getSizeInBytes());
+    vbuf->readData(0, vbuf->getSizeInBytes(), data.data());
+    const AxisAlignedBox& bounds = loaded->getQuantisationBounds();
+    for (size_t v = 0; v < vdata->vertexCount; ++v)
+    {
+        const float* ref = &original[v * 8];
+        const uint8* vertex = &data[v * vbuf->getVertexSize()];
+
+        int16 q[4];
+        memcpy(q, vertex + decl->findElementBySemantic(VES_POSITION)->getOffset(), sizeof(q));
+        Vector3 pos = bounds.getCenter() + bounds.getHalfSize() * Vector3(q[0], q[1], q[2]) / 32767;
+        EXPECT_EQ(q[3], 32767);
+        EXPECT_NEAR(pos.x, ref[0], 50.0f / 32767);
+        EXPECT_NEAR(pos.y, ref[1], 25.0f / 32767);
+        EXPECT_EQ(pos.z, ref[2]);
+
+        float n[3];
+        memcpy(n, vertex + decl->findElementBySemantic(VES_NORMAL)->getOffset(), sizeof(n));
+        EXPECT_EQ(Vector3(n), Vector3(ref + 3));
+
+        uint16 uv[2];
+        memcpy(uv, vertex + decl->findElementBySemantic(VES_TEXTURE_COORDINATES)->getOffset(), sizeof(uv));
+        EXPECT_NEAR(Bitwise::halfToFloat(uv[0]), ref[6], 1e-3f);
+        EXPECT_NEAR(Bitwise::halfToFloat(uv[1]), ref[7], 1e-3f);
+    }
+}
+
+typedef RootWithoutRenderSystemFixture MeshCompressionTests;
+TEST_F(MeshCompressionTests, SerializeRoundTrip)
+{
+    MeshPtr mesh = MeshManager::getSingleton().createPlane("plane", RGN_DEFAULT, Plane(Vector3::UNIT_Z, 0), 100,
+                                                           50, 63, 63, true, 1, 2, 3);
+    MeshSerializer serializer;
+    auto plain = std::make_shared<MemoryDataStream>(1 << 20);
+    serializer.exportMesh(mesh.get(), plain);
+
+    serializer.setCompressGeometry(true);
+    auto buffer = std::make_shared<MemoryDataStream>(1 << 20);
+    serializer.exportMesh(mesh.get(), buffer);
+    std::cout << "compressed " << plain->tell() << " to " << buffer->tell() << " bytes" << std::endl;
+    EXPECT_LT(buffer->tell(), plain->tell() / 2);
+
+    auto stream = std::make_shared<MemoryDataStream>(buffer->getPtr(), buffer->tell());
+    MeshPtr loaded = MeshManager::getSingleton().createManual("loaded", RGN_DEFAULT);
+    serializer.importMesh(stream, loaded.get());
+
+    auto vbuf = mesh->sharedVertexData->vertexBufferBinding->getBuffer(0);
+    auto loadedVbuf = loaded->sharedVertexData->vertexBufferBinding->getBuffer(0);
+    ASSERT_EQ(loadedVbuf->getSizeInBytes(), vbuf->getSizeInBytes());
+    std::vector<uint8> expected(vbuf->getSizeInBytes()), actual(vbuf->getSizeInBytes());
+    vbuf->readData(0, expected.size(), expected.data());
+    loadedVbuf->readData(0, actual.size(), actual.data());
+    EXPECT_EQ(actual, expected);
+
+    auto ibuf = mesh->getSubMesh(0)->indexData->indexBuffer;
+    auto loadedIbuf = loaded->getSubMesh(0)->indexData->indexBuffer;
+    ASSERT_TRUE(loadedIbuf);
+    EXPECT_EQ(loaded->getSubMesh(0)->indexData->indexCount, mesh->getSubMesh(0)->indexData->indexCount);
+    ASSERT_EQ(loadedIbuf->getType(), ibuf->getType());
+    ASSERT_EQ(loadedIbuf->getSizeInBytes(), ibuf->getSizeInBytes());
+    expected.resize(ibuf->getSizeInBytes());
+    actual.resize(ibuf->getSizeInBytes());
+    ibuf->readData(0, expected.size(), expected.data());
+    loadedIbuf->readData(0, actual.size(), actual.data());
+    EXPECT_EQ(actual, expected);
+}
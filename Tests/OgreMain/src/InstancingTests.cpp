@@ -29,8 +29,11 @@ THE SOFTWARE.
 #include "Ogre.h"
 #include "OgreInstancedEntity.h"
 #include "OgreInstanceBatchShader.h"
+#include "OgreOptimisedUtil.h"
 #include "RootWithoutRenderSystemFixture.h"
 
+#include <random>
+
 using namespace Ogre;
 
 typedef RootWithoutRenderSystemFixture Instancing;
@@ -55,3 +58,38 @@ TEST_F(Instancing, Bounds) {
 
 
 
+
+TEST_F(Instancing, SphereVisibility) {
+    Frustum frustum;
+    frustum.setNearClipDistance(1);
+    frustum.setFarClipDistance(100);
+
+    Vector4 planes[6];
+    for (int i = 0; i < 6; i++)
+    {
+        const Plane& plane = frustum.getFrustumPlane(i);
+        planes[i] = Vector4(plane.normal, plane.d);
+    }
+
+    // not a multiple of 4, to cover the remainder
+    const size_t numSpheres = 103;
+    OGRE_SIMD_ALIGNED_DECL(Vector4, spheres[numSpheres]);
+    char visibilities[numSpheres];
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> pos(-150, 150), radius(0, 20);
+    for (auto& s : spheres)
+        s = Vector4(pos(rng), pos(rng), pos(rng), radius(rng));
+
+    OptimisedUtil::getImplementation()->calculateSphereVisibility(planes, 6, spheres, visibilities, numSpheres);
+
+    size_t numVisible = 0;
+    for (size_t i = 0; i < numSpheres; i++)
+    {
+        bool expected = frustum.isVisible(Sphere(spheres[i].xyz(), spheres[i].w));
+        EXPECT_EQ(bool(visibilities[i]), expected) << "sphere " << i;
+        numVisible += expected;
+    }
+    EXPECT_GT(numVisible, 0u);
+    EXPECT_LT(numVisible, numSpheres);
+}
@@ -0,0 +1,262 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include <gtest/gtest.h>
+#include "OgreOptimisedUtil.h"
+#include "OgreMatrix4.h"
+
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <random>
+
+using namespace Ogre;
+
+namespace
+{
+// Random input shared by the tests and the benchmark, laid out as the engine
+// uses it: packed positions and normals, four weights per vertex
+struct OptimisedUtilData
+{
+    size_t numVertices;
+    std::vector<float> positions, normals, weights, morphSrc1, morphSrc2;
+    std::vector<unsigned char> indices;
+    aligned_vector<Affine3> matrices;
+    std::vector<const Affine3*> matrixPtrs;
+    std::vector<EdgeData::Triangle> triangles;
+    aligned_vector<Vector4> faceNormals, spheres;
+    Vector4 planes[6];
+
+    OptimisedUtilData(size_t vertices, size_t numBones = 60) : numVertices(vertices)
+    {
+        std::mt19937 rng(42);
+        std::uniform_real_distribution<float> pos(-100, 100), unit(-1, 1), weight(0, 1);
+        auto randomNormal = [&]() { return Vector3(unit(rng), unit(rng), unit(rng) + 2).normalisedCopy(); };
+
+        for (size_t i = 0; i < numVertices; ++i)
+        {
+            Vector3 n = randomNormal();
+            Vector3 p(pos(rng), pos(rng), pos(rng));
+            positions.insert(positions.end(), {p.x, p.y, p.z});
+            normals.insert(normals.end(), {n.x, n.y, n.z});
+
+            // morph targets, positions interleaved with normals
+            Vector3 n2 = randomNormal();
+            morphSrc1.insert(morphSrc1.end(), {p.x, p.y, p.z, n.x, n.y, n.z});
+            morphSrc2.insert(morphSrc2.end(), {p.x + unit(rng), p.y + unit(rng), p.z + unit(rng), n2.x, n2.y, n2.z});
+
+            float w[4], sum = 0;
+            for (float& v : w)
+                sum += (v = weight(rng));
+            for (float& v : w)
+            {
+                weights.push_back(v / sum);
+                indices.push_back(rng() % numBones);
+            }
+        }
+
+        for (size_t i = 0; i < numBones; ++i)
+        {
+            Quaternion q(Radian(pos(rng)), randomNormal());
+            matrices.push_back(Affine3(Vector3(pos(rng), pos(rng), pos(rng)), q));
+        }
+        for (const auto& m : matrices)
+            matrixPtrs.push_back(&m);
+
+        triangles.resize(numVertices);
+        for (auto& t : triangles)
+            for (auto& i : t.vertIndex)
+                i = rng() % numVertices;
+
+        for (size_t i = 0; i < numVertices; ++i)
+        {
+            Vector3 n = randomNormal();
+            faceNormals.push_back(Vector4(n.x, n.y, n.z, pos(rng)));
+            spheres.push_back(Vector4(pos(rng), pos(rng), pos(rng), weight(rng) * 20));
+        }
+
+        for (auto& p : planes)
+        {
+            Vector3 n = randomNormal();
+            p = Vector4(n.x, n.y, n.z, pos(rng) * 0.5f);
+        }
+    }
+};
+
+// tolerance relative to the value, or to the magnitude of the data for values close to zero
+void expectNear(const float* expected, const float* actual, size_t count, float tolerance, const char* what,
+                float magnitude = 1)
+{
+    for (size_t i = 0; i < count; ++i)
+        ASSERT_NEAR(expected[i], actual[i], tolerance * std::max(magnitude, std::abs(expected[i])))
+            << what << " element " << i;
+}
+}
+
+//--------------------------------------------------------------------------
+TEST(OptimisedUtil, MatchesGeneral)
+{
+    // not a multiple of 8, to cover the remainders
+    OptimisedUtilData data(1003);
+    const size_t n = data.numVertices;
+
+    OptimisedUtil::NamedImplementationList impls = OptimisedUtil::getSupportedImplementations();
+    ASSERT_FALSE(impls.empty());
+    OptimisedUtil* general = impls[0].second;
+
+    std::vector<float> expected(n * 6), actual(n * 6), expectedNorm(n * 3), actualNorm(n * 3);
+    aligned_vector<Vector4> expectedVec(n), actualVec(n);
+    std::vector<char> expectedFlags(n), actualFlags(n);
+    aligned_vector<Affine3> expectedMat(data.matrices.size()), actualMat(data.matrices.size());
+
+    for (const auto& impl : impls)
+    {
+        SCOPED_TRACE(impl.first);
+        OptimisedUtil* util = impl.second;
+
+        const float* srcNormals[] = {NULL, data.normals.data()};
+        for (const float* srcNorm : srcNormals)
+        {
+            general->softwareVertexSkinning(data.positions.data(), expected.data(), srcNorm, expectedNorm.data(),
+                                            data.weights.data(), data.indices.data(), data.matrixPtrs.data(),
+                                            12, 12, 12, 12, 16, 4, 4, n);
+            util->softwareVertexSkinning(data.positions.data(), actual.data(), srcNorm, actualNorm.data(),
+                                         data.weights.data(), data.indices.data(), data.matrixPtrs.data(),
+                                         12, 12, 12, 12, 16, 4, 4, n);
+            expectNear(expected.data(), actual.data(), n * 3, 1e-5f, "skinned position");
+            if (srcNorm)
+                expectNear(expectedNorm.data(), actualNorm.data(), n * 3, 1e-3f, "skinned normal");
+        }
+
+        general->softwareVertexMorph(0.3f, data.positions.data(), data.normals.data(), expected.data(), 12, 12, 12, n, false);
+        util->softwareVertexMorph(0.3f, data.positions.data(), data.normals.data(), actual.data(), 12, 12, 12, n, false);
+        expectNear(expected.data(), actual.data(), n * 3, 1e-5f, "morphed position");
+
+        general->softwareVertexMorph(0.7f, data.morphSrc1.data(), data.morphSrc2.data(), expected.data(), 24, 24, 24, n, true);
+        util->softwareVertexMorph(0.7f, data.morphSrc1.data(), data.morphSrc2.data(), actual.data(), 24, 24, 24, n, true);
+        expectNear(expected.data(), actual.data(), n * 6, 1e-4f, "morphed position and normal");
+
+        general->concatenateAffineMatrices(data.matrices[0], data.matrices.data(), expectedMat.data(), data.matrices.size() - 1);
+        util->concatenateAffineMatrices(data.matrices[0], data.matrices.data(), actualMat.data(), data.matrices.size() - 1);
+        for (size_t i = 0; i + 1 < data.matrices.size(); ++i)
+            expectNear(expectedMat[i][0], actualMat[i][0], 12, 1e-5f, "concatenated matrix");
+
+        general->calculateFaceNormals(data.positions.data(), data.triangles.data(), expectedVec.data(), n);
+        util->calculateFaceNormals(data.positions.data(), data.triangles.data(), actualVec.data(), n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            // the rounding errors scale with the edges, not with the result, as
+            // nearly degenerate triangles cancel out
+            const uint32* v = data.triangles[i].vertIndex;
+            Vector3 v1(&data.positions[v[0] * 3]), v2(&data.positions[v[1] * 3]), v3(&data.positions[v[2] * 3]);
+            Real scale = (v2 - v1).length() * (v3 - v1).length();
+            ASSERT_LE((expectedVec[i].xyz() - actualVec[i].xyz()).length(), 1e-5f * scale) << "face normal " << i;
+            ASSERT_NEAR(expectedVec[i].w, actualVec[i].w, 1e-5f * scale * v1.length()) << "face normal " << i;
+        }
+
+        for (const Vector4& light : {Vector4(10, 20, -30, 1), Vector4(1, -1, 0.5, 0)})
+        {
+            general->calculateLightFacing(light, data.faceNormals.data(), expectedFlags.data(), n);
+            util->calculateLightFacing(light, data.faceNormals.data(), actualFlags.data(), n);
+            EXPECT_EQ(expectedFlags, actualFlags);
+
+            // the SSE version uses the approximated reciprocal square root
+            general->extrudeVertices(light, 1000, data.positions.data(), expected.data(), n);
+            util->extrudeVertices(light, 1000, data.positions.data(), actual.data(), n);
+            expectNear(expected.data(), actual.data(), n * 3, 1e-3f, "extruded vertex", 1000);
+        }
+
+        general->calculateSphereVisibility(data.planes, 6, data.spheres.data(), expectedFlags.data(), n);
+        util->calculateSphereVisibility(data.planes, 6, data.spheres.data(), actualFlags.data(), n);
+        EXPECT_EQ(expectedFlags, actualFlags);
+    }
+}
+//--------------------------------------------------------------------------
+TEST(OptimisedUtilBenchmark, EntryPoints)
+{
+    // roughly a detailed character, and its shadow volume
+    OptimisedUtilData data(50000);
+    const size_t n = data.numVertices;
+    const int iterations = 20;
+
+    std::vector<float> dstPos(n * 6), dstNorm(n * 3);
+    aligned_vector<Vector4> dstVec(n);
+    std::vector<char> dstFlags(n);
+    aligned_vector<Affine3> dstMat(data.matrices.size());
+
+    for (const auto& impl : OptimisedUtil::getSupportedImplementations())
+    {
+        OptimisedUtil* util = impl.second;
+        std::cout << impl.first << std::endl;
+
+        auto measure = [&](const char* name, const std::function<void()>& fn) {
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < iterations; i++)
+                fn();
+            std::chrono::duration<double, std::micro> time = std::chrono::steady_clock::now() - start;
+            std::cout << "  " << std::left << std::setw(32) << name << std::right << std::fixed
+                      << std::setprecision(1) << std::setw(10) << time.count() / iterations << " us" << std::endl;
+        };
+
+        measure("softwareVertexSkinning", [&]() {
+            util->softwareVertexSkinning(data.positions.data(), dstPos.data(), data.normals.data(), dstNorm.data(),
+                                         data.weights.data(), data.indices.data(), data.matrixPtrs.data(),
+                                         12, 12, 12, 12, 16, 4, 4, n);
+        });
+        measure("softwareVertexSkinning pos only", [&]() {
+            util->softwareVertexSkinning(data.positions.data(), dstPos.data(), NULL, NULL,
+                                         data.weights.data(), data.indices.data(), data.matrixPtrs.data(),
+                                         12, 12, 12, 12, 16, 4, 4, n);
+        });
+        measure("softwareVertexMorph", [&]() {
+            util->softwareVertexMorph(0.3f, data.positions.data(), data.normals.data(), dstPos.data(), 12, 12, 12, n, false);
+        });
+        measure("softwareVertexMorph normals", [&]() {
+            util->softwareVertexMorph(0.3f, data.morphSrc1.data(), data.morphSrc2.data(), dstPos.data(), 24, 24, 24, n, true);
+        });
+        measure("concatenateAffineMatrices", [&]() {
+            for (int i = 0; i < 100; i++)
+                util->concatenateAffineMatrices(data.matrices[0], data.matrices.data(), dstMat.data(), data.matrices.size());
+        });
+        measure("calculateFaceNormals", [&]() {
+            util->calculateFaceNormals(data.positions.data(), data.triangles.data(), dstVec.data(), n);
+        });
+        measure("calculateLightFacing", [&]() {
+            util->calculateLightFacing(Vector4(10, 20, -30, 1), data.faceNormals.data(), dstFlags.data(), n);
+        });
+        measure("extrudeVertices directional", [&]() {
+            util->extrudeVertices(Vector4(1, -1, 0.5, 0), 1000, data.positions.data(), dstPos.data(), n);
+        });
+        measure("extrudeVertices point", [&]() {
+            util->extrudeVertices(Vector4(10, 20, -30, 1), 1000, data.positions.data(), dstPos.data(), n);
+        });
+        measure("calculateSphereVisibility", [&]() {
+            util->calculateSphereVisibility(data.planes, 6, data.spheres.data(), dstFlags.data(), n);
+        });
+    }
+}
@@ -26,8 +26,11 @@ THE SOFTWARE.
 -----------------------------------------------------------------------------
 */
 #include "PixelFormatTests.h"
+#include "RootWithoutRenderSystemFixture.h"
+#include "OgreWorkQueue.h"
 #include <cstdlib>
 #include <iomanip>
+#include <chrono>
 
 
 // Register the test suite
@@ -233,6 +236,62 @@ TEST_F(PixelFormatTests,BulkConversion)
     testCase(PF_X8B8G8R8, PF_A8B8G8R8);
     testCase(PF_X8B8G8R8, PF_B8G8R8A8);
     testCase(PF_X8B8G8R8, PF_R8G8B8A8);
+
+    testCase(PF_FLOAT16_R, PF_FLOAT32_R);
+    testCase(PF_FLOAT16_GR, PF_FLOAT32_GR);
+    testCase(PF_FLOAT16_RGB, PF_FLOAT32_RGB);
+    testCase(PF_FLOAT16_RGBA, PF_FLOAT32_RGBA);
+    testCase(PF_FLOAT32_R, PF_FLOAT16_R);
+    testCase(PF_FLOAT32_GR, PF_FLOAT16_GR);
+    testCase(PF_FLOAT32_RGB, PF_FLOAT16_RGB);
+    testCase(PF_FLOAT32_RGBA, PF_FLOAT16_RGBA);
+}
+//--------------------------------------------------------------------------
+typedef RootWithoutRenderSystemFixture PixelConversionBenchmark;
+TEST_F(PixelConversionBenchmark, BulkConversion)
+{
+    // large enough to be split across the worker threads
+    const uint32 width = 1024, height = 1024;
+    const int iterations = 5;
+    mRoot->getWorkQueue()->startup();
+
+    std::vector<uint8> srcData(width * height * 16);
+    srand(0);
+    for(auto& b : srcData)
+        b = (uint8)rand();
+
+    const PixelFormat pairs[][2] = {
+        {PF_A8R8G8B8, PF_A8B8G8R8}, {PF_B8G8R8A8, PF_R8G8B8A8}, {PF_X8R8G8B8, PF_R8G8B8A8},
+        {PF_BYTE_RGB, PF_BYTE_RGBA}, {PF_BYTE_BGR, PF_BYTE_BGRA}, {PF_L8, PF_BYTE_RGBA},
+        {PF_BYTE_RGBA, PF_L8}, {PF_L8, PF_L16}, {PF_L16, PF_L8},
+        {PF_FLOAT16_RGBA, PF_FLOAT32_RGBA}, {PF_FLOAT32_RGBA, PF_FLOAT16_RGBA},
+        {PF_FLOAT32_RGBA, PF_BYTE_RGBA}};
+
+    for(const auto& pair : pairs)
+    {
+        PixelBox src(width, height, 1, pair[0], srcData.data());
+        std::vector<uint8> dst(PixelUtil::getMemorySize(width, height, 1, pair[1]));
+        std::vector<uint8> ref(dst.size());
+
+        auto start = std::chrono::steady_clock::now();
+        naiveBulkPixelConversion(src, PixelBox(width, height, 1, pair[1], ref.data()));
+        std::chrono::duration<double> naiveTime = std::chrono::steady_clock::now() - start;
+
+        start = std::chrono::steady_clock::now();
+        for(int i = 0; i < iterations; i++)
+            PixelUtil::bulkPixelConversion(src, PixelBox(width, height, 1, pair[1], dst.data()));
+        std::chrono::duration<double> bulkTime = std::chrono::steady_clock::now() - start;
+
+        EXPECT_TRUE(dst == ref) << PixelUtil::getFormatName(pair[0]) << "->" << PixelUtil::getFormatName(pair[1]);
+
+        // bytes read and written
+        double bytes = double(src.getConsecutiveSize() + dst.size());
+        std::cout << std::setw(16) << PixelUtil::getFormatName(pair[0]) << " -> " << std::setw(16)
+                  << PixelUtil::getFormatName(pair[1]) << std::fixed << std::setprecision(2)
+                  << "  naive " << std::setw(7) << bytes / naiveTime.count() / 1e9 << " GB/s"
+                  << "  bulk " << std::setw(7) << bytes * iterations / bulkTime.count() / 1e9 << " GB/s"
+                  << std::endl;
+    }
 }
 //--------------------------------------------------------------------------
 
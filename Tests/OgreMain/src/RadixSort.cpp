@@ -205,3 +205,34 @@ TEST_F(RadixSortTests,IntVector)
 //--------------------------------------------------------------------------
 
 
+TEST_F(RadixSortTests,Uint64VectorStable)
+{
+    // packed keys sharing most of their bytes, equal ones must keep their order
+    typedef std::pair<uint64, int> Item;
+    struct KeySortFunctor
+    {
+        uint64 operator()(const Item& p) const
+        {
+            return p.first;
+        }
+    };
+    std::vector<Item> container;
+    RadixSort<std::vector<Item>, Item, uint64> sorter;
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        uint64 high = (uint64)Math::RangeRandom(0, 16);
+        uint64 mid = (uint64)Math::RangeRandom(0, 256);
+        container.push_back(Item((high << 60) | (mid << 20), i));
+    }
+
+    sorter.sort(container, KeySortFunctor());
+
+    for (size_t i = 1; i < container.size(); ++i)
+    {
+        EXPECT_LE(container[i - 1].first, container[i].first);
+        if (container[i - 1].first == container[i].first)
+            EXPECT_LT(container[i - 1].second, container[i].second);
+    }
+}
+//--------------------------------------------------------------------------
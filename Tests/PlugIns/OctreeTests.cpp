@@ -0,0 +1,265 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include <gtest/gtest.h>
+
+#include "OgreRoot.h"
+#include "OgreManualObject.h"
+#include "OgreOctreeSceneManager.h"
+#include "OgreOctreeNode.h"
+#include "RootWithoutRenderSystemFixture.h"
+
+#include <random>
+#include <chrono>
+#include <set>
+
+using namespace Ogre;
+
+struct OctreeTest : public RootWithoutRenderSystemFixture
+{
+    OctreeSceneManager* mSceneMgr;
+    std::vector<OctreeNode*> mNodes;
+    std::vector<Vector3> mVelocities;
+    std::minstd_rand mRng;
+
+    void SetUp() override
+    {
+        RootWithoutRenderSystemFixture::SetUp();
+        mSceneMgr = OGRE_NEW OctreeSceneManager("Octree");
+    }
+
+    void TearDown() override
+    {
+        OGRE_DELETE mSceneMgr;
+        RootWithoutRenderSystemFixture::TearDown();
+    }
+
+    Vector3 randomVector(Real range)
+    {
+        std::uniform_real_distribution<Real> dist(-range, range);
+        return Vector3(dist(mRng), dist(mRng), dist(mRng));
+    }
+
+    void createNodes(size_t count, Real range, Real maxSize)
+    {
+        std::uniform_real_distribution<Real> size(1, maxSize);
+        for (size_t i = 0; i < count; ++i)
+        {
+            SceneNode* node = mSceneMgr->getRootSceneNode()->createChildSceneNode(randomVector(range));
+            Vector3 halfSize(size(mRng), size(mRng), size(mRng));
+            ManualObject* mo = mSceneMgr->createManualObject();
+            mo->setBoundingBox(AxisAlignedBox(-halfSize, halfSize));
+            node->attachObject(mo);
+            mNodes.push_back(static_cast<OctreeNode*>(node));
+            mVelocities.push_back(randomVector(range / 100));
+        }
+        update();
+    }
+
+    /// Moves the nodes along their velocities, bouncing off the given range
+    void moveNodes(Real range)
+    {
+        for (size_t i = 0; i < mNodes.size(); ++i)
+        {
+            Vector3 pos = mNodes[i]->getPosition() + mVelocities[i];
+            for (int j = 0; j < 3; ++j)
+            {
+                if (std::abs(pos[j]) > range)
+                    mVelocities[i][j] = -mVelocities[i][j];
+            }
+            mNodes[i]->setPosition(pos);
+        }
+    }
+
+    void update() { mSceneMgr->getRootSceneNode()->_update(true, false); }
+
+    /// Every node is in the node list of its octant, within its culling bounds unless
+    /// forced into the root one
+    void checkOctants()
+    {
+        AxisAlignedBox size;
+        mSceneMgr->getOption("Size", &size);
+        for (auto node : mNodes)
+        {
+            Octree* octant = node->getOctant();
+            ASSERT_TRUE(octant);
+            ASSERT_LT(node->_getOctantIndex(), octant->mNodes.size());
+            EXPECT_EQ(octant->mNodes[node->_getOctantIndex()], node);
+
+            // Octree::_getCullBounds, which the plugin does not export
+            AxisAlignedBox bounds(octant->mBox.getMinimum() - octant->mHalfSize,
+                                  octant->mBox.getMaximum() + octant->mHalfSize);
+            if (octant->getParent() || size.contains(node->_getWorldAABB().getCenter()))
+            {
+                EXPECT_TRUE(bounds.contains(node->_getWorldAABB()));
+            }
+        }
+
+        if (!mNodes.empty())
+        {
+            Octree* root = mNodes[0]->getOctant();
+            while (root->getParent())
+                root = root->getParent();
+            EXPECT_EQ(countNodes(root), mNodes.size());
+        }
+    }
+
+    /// Checks the node count of the octant and its children
+    static size_t countNodes(Octree* octant)
+    {
+        size_t count = octant->mNodes.size();
+        for (int i = 0; i < 8; i++)
+        {
+            if (Octree* child = octant->mChildren[i & 1][(i >> 1) & 1][i >> 2])
+                count += countNodes(child);
+        }
+        EXPECT_EQ(octant->numNodes(), int(count));
+        return count;
+    }
+
+    void checkQueries(Real range)
+    {
+        std::uniform_real_distribution<Real> size(range / 100, range / 4);
+        for (int i = 0; i < 10; ++i)
+        {
+            Vector3 halfSize(size(mRng), size(mRng), size(mRng));
+            Vector3 centre = randomVector(range);
+            AxisAlignedBox box(centre - halfSize, centre + halfSize);
+
+            std::list<SceneNode*> found;
+            mSceneMgr->findNodesIn(box, found);
+            std::set<SceneNode*> result(found.begin(), found.end());
+            EXPECT_EQ(result.size(), found.size());
+
+            std::set<SceneNode*> expected;
+            for (auto node : mNodes)
+            {
+                if (box.intersects(node->_getWorldAABB()))
+                    expected.insert(node);
+            }
+            EXPECT_EQ(result, expected);
+        }
+    }
+};
+
+TEST_F(OctreeTest, LooseUpdates)
+{
+    bool loose = true;
+    ASSERT_TRUE(mSceneMgr->setOption("Loose", &loose));
+    loose = false;
+    ASSERT_TRUE(mSceneMgr->getOption("Loose", &loose));
+    EXPECT_TRUE(loose);
+
+    createNodes(2000, 8000, 1000);
+    // Some nodes outside of the octree, forced into the root octant
+    for (int i = 0; i < 10; i++)
+    {
+        SceneNode* node = mSceneMgr->getRootSceneNode()->createChildSceneNode(Vector3(12000, 0, 0));
+        ManualObject* mo = mSceneMgr->createManualObject();
+        mo->setBoundingBox(AxisAlignedBox(-Vector3::UNIT_SCALE, Vector3::UNIT_SCALE));
+        node->attachObject(mo);
+        mNodes.push_back(static_cast<OctreeNode*>(node));
+        mVelocities.push_back(Vector3(-400, 0, 0));
+    }
+    update();
+    checkOctants();
+    checkQueries(8000);
+
+    std::uniform_real_distribution<Real> scale(0.5, 2);
+    for (int frame = 0; frame < 50; frame++)
+    {
+        moveNodes(12000);
+        // Growing and shrinking nodes move up and down the octree
+        for (size_t i = 0; i < mNodes.size(); i += 10)
+            mNodes[i]->setScale(Vector3(scale(mRng)));
+        update();
+        checkOctants();
+    }
+    checkQueries(8000);
+
+    std::vector<OctreeNode*> nodes;
+    for (size_t i = 0; i < mNodes.size(); i++)
+    {
+        if (i % 2)
+            nodes.push_back(mNodes[i]);
+        else
+            static_cast<SceneManager*>(mSceneMgr)->destroySceneNode(mNodes[i]);
+    }
+    mNodes.swap(nodes);
+    checkOctants();
+    checkQueries(8000);
+}
+
+TEST_F(OctreeTest, Benchmark)
+{
+    typedef std::chrono::high_resolution_clock clock;
+    const size_t count = 10000;
+    const int frames = 50;
+
+    // Small nodes spread over the leaves, then large ones crowding a few octants
+    for (Real maxSize : {100, 1000})
+    {
+        mSceneMgr->clearScene();
+        mNodes.clear();
+        mVelocities.clear();
+        createNodes(count, 8000, maxSize);
+
+        std::vector<Vector3> positions;
+        for (auto node : mNodes)
+            positions.push_back(node->getPosition());
+        std::vector<Vector3> velocities = mVelocities;
+
+        // Both modes move the same nodes, twice in turns so neither gets a warmer cache
+        double times[2] = {DBL_MAX, DBL_MAX};
+        for (int i = 0; i < 4; i++)
+        {
+            bool loose = i % 2;
+            mSceneMgr->setOption("Loose", &loose);
+            for (size_t j = 0; j < mNodes.size(); j++)
+                mNodes[j]->setPosition(positions[j]);
+            mVelocities = velocities;
+            AxisAlignedBox size;
+            mSceneMgr->getOption("Size", &size);
+            mSceneMgr->setOption("Size", &size);
+            update();
+
+            auto start = clock::now();
+            for (int frame = 0; frame < frames; frame++)
+            {
+                moveNodes(8000);
+                update();
+            }
+            times[loose] = std::min(times[loose],
+                std::chrono::duration<double, std::milli>(clock::now() - start).count() / frames);
+            checkOctants();
+            checkQueries(8000);
+        }
+
+        std::cout << count << " moving nodes up to " << maxSize << " units, update per frame: " << times[0]
+                  << " ms, " << times[1] << " ms loose" << std::endl;
+    }
+}
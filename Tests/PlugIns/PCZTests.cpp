@@ -0,0 +1,227 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include <gtest/gtest.h>
+
+#include "OgreRoot.h"
+#include "OgreCamera.h"
+#include "OgrePCZSceneManager.h"
+#include "OgrePCZSceneNode.h"
+#include "OgrePCZCamera.h"
+#include "OgrePCZoneFactory.h"
+#include "OgrePortal.h"
+#include "RootWithoutRenderSystemFixture.h"
+
+#include <set>
+
+using namespace Ogre;
+
+struct PCZTest : public RootWithoutRenderSystemFixture
+{
+    PCZoneFactoryManager* mZoneFactoryManager;
+    PortalFactory mPortalFactory;
+    PCZSceneManager* mSceneMgr;
+    std::map<String, PCZone*> mZones;
+    std::map<String, Portal*> mPortals;
+
+    void SetUp() override
+    {
+        RootWithoutRenderSystemFixture::SetUp();
+        mZoneFactoryManager = OGRE_NEW PCZoneFactoryManager();
+        mRoot->addMovableObjectFactory(&mPortalFactory);
+        PortalFactory::FACTORY_TYPE_FLAG = mPortalFactory.getTypeFlags();
+        mSceneMgr = OGRE_NEW PCZSceneManager("PCZ");
+        mSceneMgr->init("ZoneType_Default");
+    }
+
+    void TearDown() override
+    {
+        OGRE_DELETE mSceneMgr;
+        mRoot->removeMovableObjectFactory(&mPortalFactory);
+        OGRE_DELETE mZoneFactoryManager;
+        RootWithoutRenderSystemFixture::TearDown();
+    }
+
+    PCZone* zone(const String& name)
+    {
+        PCZone*& zone = mZones[name];
+        if (!zone)
+            zone = mSceneMgr->createZone("ZoneType_Default", name);
+        return zone;
+    }
+
+    Portal* createPortal(PCZone* zone, const String& name, const Vector3& centre, const Vector3& normal)
+    {
+        // square door of 6 units, facing the normal
+        Vector3 u = normal.perpendicular() * 3;
+        Vector3 v = normal.crossProduct(u);
+        Vector3 corners[4] = {centre - u - v, centre + u - v, centre + u + v, centre - u + v};
+        Portal* portal = mSceneMgr->createPortal(name);
+        portal->setCorners(corners);
+        portal->setNode(mSceneMgr->getRootSceneNode());
+        zone->_addPortal(portal);
+        mPortals[name] = portal;
+        return portal;
+    }
+
+    /// Connects the zones with a pair of portals, the normal pointing into the first zone
+    void connect(const String& from, const String& to, const Vector3& centre, const Vector3& normal)
+    {
+        Portal* forward = createPortal(zone(from), from + "_" + to, centre, normal);
+        Portal* backward = createPortal(zone(to), to + "_" + from, centre, -normal);
+        forward->setTargetZone(zone(to));
+        forward->setTargetPortal(backward);
+        backward->setTargetZone(zone(from));
+        backward->setTargetPortal(forward);
+    }
+
+    /** Rooms of 10 units, in the XZ plane:
+        @verbatim
+        D < C
+            ^
+        A > B > E > F
+        @endverbatim
+        D is behind the door from A to B, and A behind the door from D to C.
+    */
+    void createRooms()
+    {
+        connect("A", "B", Vector3(10, 5, 5), Vector3::NEGATIVE_UNIT_X);
+        connect("B", "C", Vector3(15, 5, 10), Vector3::NEGATIVE_UNIT_Z);
+        connect("C", "D", Vector3(10, 5, 15), Vector3::UNIT_X);
+        connect("B", "E", Vector3(20, 5, 5), Vector3::NEGATIVE_UNIT_X);
+        connect("E", "F", Vector3(30, 5, 5), Vector3::NEGATIVE_UNIT_X);
+    }
+
+    std::set<String> potentiallyVisible(const String& from)
+    {
+        std::set<String> names;
+        for (const auto& z : mZones)
+        {
+            if (zone(from)->isPotentiallyVisible(z.second))
+                names.insert(z.first);
+        }
+        return names;
+    }
+
+    /// Zones the walk of the camera reaches from the given position
+    std::set<String> walkZones(const String& cameraName, const String& from, const Vector3& position,
+                               const Vector3& direction)
+    {
+        Camera* camera = mSceneMgr->createCamera(cameraName);
+        PCZSceneNode* node = static_cast<PCZSceneNode*>(mSceneMgr->getRootSceneNode()->createChildSceneNode(position));
+        node->setDirection(direction, Node::TS_WORLD);
+        node->attachObject(camera);
+        mSceneMgr->addPCZSceneNode(node, zone(from));
+
+        VisibleObjectsBoundsInfo bounds;
+        mSceneMgr->_findVisibleObjects(camera, &bounds, false);
+
+        std::set<String> names;
+        for (const auto& z : mZones)
+        {
+            if (z.second->getLastVisibleFromCamera() == static_cast<PCZCamera*>(camera))
+                names.insert(z.first);
+        }
+        return names;
+    }
+};
+
+TEST_F(PCZTest, BakePVS)
+{
+    createRooms();
+    EXPECT_FALSE(mSceneMgr->hasPVS());
+    EXPECT_TRUE(zone("A")->isPotentiallyVisible(zone("D")));
+
+    mSceneMgr->bakePVS();
+    EXPECT_TRUE(mSceneMgr->hasPVS());
+
+    EXPECT_EQ(potentiallyVisible("A"), std::set<String>({"A", "B", "C", "E", "F"}));
+    EXPECT_EQ(potentiallyVisible("B"), std::set<String>({"A", "B", "C", "D", "E", "F"}));
+    EXPECT_EQ(potentiallyVisible("D"), std::set<String>({"B", "C", "D", "E", "F"}));
+    EXPECT_EQ(potentiallyVisible("F"), std::set<String>({"A", "B", "C", "D", "E", "F"}));
+
+    // zones created after the bake are visible from everywhere
+    PCZone* added = zone("G");
+    EXPECT_TRUE(zone("A")->isPotentiallyVisible(added));
+    EXPECT_TRUE(added->isPotentiallyVisible(zone("A")));
+
+    mSceneMgr->clearPVS();
+    EXPECT_FALSE(mSceneMgr->hasPVS());
+    EXPECT_TRUE(zone("A")->isPotentiallyVisible(zone("D")));
+}
+
+TEST_F(PCZTest, SaveLoadPVS)
+{
+    createRooms();
+    mSceneMgr->bakePVS();
+    std::map<String, std::set<String> > baked;
+    for (const auto& z : mZones)
+        baked[z.first] = potentiallyVisible(z.first);
+
+    auto stream = std::make_shared<MemoryDataStream>(4096);
+    mSceneMgr->savePVS(stream);
+    size_t size = stream->tell();
+
+    mSceneMgr->clearPVS();
+    stream->seek(0);
+    EXPECT_TRUE(mSceneMgr->loadPVS(stream));
+    EXPECT_TRUE(mSceneMgr->hasPVS());
+    EXPECT_EQ(stream->tell(), size);
+    for (const auto& z : mZones)
+        EXPECT_EQ(potentiallyVisible(z.first), baked[z.first]);
+
+    // the PVS of other portals is rejected
+    mSceneMgr->clearPVS();
+    Portal* portal = mPortals["A_B"];
+    Vector3 corners[4];
+    for (int i = 0; i < 4; ++i)
+        corners[i] = portal->getCorner(i) + Vector3(0, 1, 0);
+    portal->setCorners(corners);
+    stream->seek(0);
+    EXPECT_FALSE(mSceneMgr->loadPVS(stream));
+    EXPECT_FALSE(mSceneMgr->hasPVS());
+
+    // so is anything else
+    auto garbage = std::make_shared<MemoryDataStream>(64);
+    memset(garbage->getPtr(), 0, 64);
+    EXPECT_FALSE(mSceneMgr->loadPVS(garbage));
+}
+
+TEST_F(PCZTest, WalkWithPVS)
+{
+    createRooms();
+
+    // the PVS only skips zones the portal frustums would cull
+    std::set<String> fromA = walkZones("A0", "A", Vector3(2, 5, 5), Vector3::UNIT_X);
+    std::set<String> fromC = walkZones("C0", "C", Vector3(15, 5, 18), Vector3::NEGATIVE_UNIT_Z);
+    EXPECT_EQ(fromA.count("F"), 1u);
+    EXPECT_EQ(fromC.count("B"), 1u);
+
+    mSceneMgr->bakePVS();
+    EXPECT_EQ(walkZones("A1", "A", Vector3(2, 5, 5), Vector3::UNIT_X), fromA);
+    EXPECT_EQ(walkZones("C1", "C", Vector3(15, 5, 18), Vector3::NEGATIVE_UNIT_Z), fromC);
+}
@@ -65,6 +65,7 @@ Available options:
                       longer time frame than the animation actually plays
 -max_edge_angle deg = When normals are generated, max angle between
                       two faces to smooth over
+-parallel           = Convert the meshes and animations on all cores
 sourcefile          = name of file to convert
 destination         = optional name of directory to write to. If you don't
                       specify this the converter will use the same
@@ -97,6 +98,7 @@ AssOptions parseArgs(int numArgs, char** args)
 
     unOpt["-q"] = false;
     unOpt["-3ds_ani_fix"] = false;
+    unOpt["-parallel"] = false;
     binOpt["-log"] = opts.logFile;
     binOpt["-aniName"] = "";
     binOpt["-aniSpeedMod"] = "1.0";
@@ -112,6 +114,10 @@ AssOptions parseArgs(int numArgs, char** args)
     {
         opts.options["cutAnimation"] = "true";
     }
+    if (unOpt["-parallel"])
+    {
+        opts.options["parallel"] = "true";
+    }
 
     opts.options["postProcessSteps"] = std::to_string(aiProcessPreset_TargetRealtime_Quality);
     opts.logFile = binOpt["-log"];
@@ -212,9 +218,15 @@ int main(int numargs, char** args)
 
         auto codec = Codec::getCodec(ext);
 
+        // there is no window to start the WorkQueue for us
+        if (opts.options.count("parallel"))
+            root.getWorkQueue()->startup();
+
         MeshPtr mesh = MeshManager::getSingleton().createManual(basename + "." + ext, RGN_DEFAULT);
         mesh->getUserObjectBindings().setUserAny("_AssimpLoaderOptions", opts.options);
+        Timer timer;
         codec->decode(Root::openFileStream(opts.source), mesh.get());
+        LogManager::getSingleton().stream() << "Imported " << opts.source << " in " << timer.getMilliseconds() << " ms";
 
         if (!opts.dest.empty())
         {
@@ -0,0 +1,80 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include <iostream>
+
+#include "Ogre.h"
+#include "OgreDotSceneLoader.h"
+
+using namespace Ogre;
+
+namespace
+{
+void help(void)
+{
+    std::cout <<
+R"HELP(Usage: OgreDotSceneConverter [-q] sourcefile.scene destfile.bscene
+
+  Converts .scene files to the binary .bscene format of the DotScene plugin
+
+Available options:
+-q                  = Quiet mode, less output
+)HELP";
+}
+} // namespace
+
+int main(int numargs, char** args)
+{
+    UnaryOptionList unOpt;
+    BinaryOptionList binOpt;
+    unOpt["-q"] = false;
+    int startIndex = findCommandLineOpts(numargs, args, unOpt, binOpt);
+
+    if (numargs != startIndex + 2)
+    {
+        help();
+        return -1;
+    }
+
+    LogManager logMgr;
+    logMgr.createLog("OgreDotSceneConverter.log", true, !unOpt["-q"]);
+
+    try
+    {
+        DataStreamPtr source = Root::openFileStream(args[startIndex]);
+        DataStreamPtr dest = Root::createFileStream(args[startIndex + 1], RGN_DEFAULT, true);
+        if (!DotSceneLoader::convertToBinary(source, dest))
+            return 1;
+    }
+    catch (const Exception& e)
+    {
+        logMgr.logError(e.getDescription());
+        return 1;
+    }
+
+    return 0;
+}
@@ -28,6 +28,7 @@ THE SOFTWARE.
 
 #include "Ogre.h"
 #include "OgreDefaultHardwareBufferManager.h"
+#include "OgreMeshOptimiser.h"
 #include "OgreMeshLodGenerator.h"
 #include "OgreDistanceLodStrategy.h"
 #include "OgreLodStrategyManager.h"
@@ -60,6 +61,11 @@ R"HELP(Usage: OgreMeshUpgrader [opts] sourcefile [destfile]
 -v             = Display version information
 -pack          = Pack normals and tangents as int_10_10_10_2
 -optvtxcache   = Reorder the indexes to optimise vertex cache utilisation
+-optoverdraw   = Sort the triangle clusters to reduce overdraw
+-optvtxfetch   = Reorder the vertices to optimise vertex fetch locality
+-quantise      = Store UVs as half2, normals and tangents as int_10_10_10_2
+                 and positions as short4 relative to the bounds (static meshes)
+-compress      = Compress the vertex and index buffers (latest version only)
 -autogen       = Generate autoconfigured LOD. No LOD options needed
 -l lodlevels   = number of LOD levels
 -d loddist     = distance increment to reduce LOD
@@ -92,6 +98,10 @@ struct UpgradeOptions {
     bool lodAutoconfigure;
     bool packNormalsTangents;
     bool optimiseVertexCache;
+    bool optimiseOverdraw;
+    bool optimiseVertexFetch;
+    bool quantise;
+    bool compress;
     unsigned short numLods;
     Real lodDist;
     Real lodPercent;
@@ -135,6 +145,10 @@ UpgradeOptions parseOpts(UnaryOptionList& unOpts, BinaryOptionList& binOpts)
     opts.dontReorganise = unOpts["-r"];
     opts.packNormalsTangents = unOpts["-pack"];
     opts.optimiseVertexCache = unOpts["-optvtxcache"];
+    opts.optimiseOverdraw = unOpts["-optoverdraw"];
+    opts.optimiseVertexFetch = unOpts["-optvtxfetch"];
+    opts.quantise = unOpts["-quantise"];
+    opts.compress = unOpts["-compress"];
 
     // Unary options (true/false options that don't take a parameter)
     if (unOpts["-b"]) {
@@ -240,6 +254,67 @@ void reorganiseVertexBuffers(const UpgradeOptions& opts, Mesh& mesh)
     }
 }
 
+void quantiseVertexElements(VertexData* vdata, bool isStatic)
+{
+    // copy, as the conversions modify the declaration
+    auto elems = vdata->vertexDeclaration->getElements();
+    for (const auto& e : elems)
+    {
+        VertexElementSemantic sem = e.getSemantic();
+        VertexElementType type = e.getType();
+        if (sem == VES_TEXTURE_COORDINATES && type == VET_FLOAT2)
+            vdata->convertVertexElement(sem, VET_HALF2, e.getIndex());
+        // software skinning and morphing need float normals
+        else if (isStatic && ((sem == VES_NORMAL && type == VET_FLOAT3) ||
+                              (sem == VES_TANGENT && (type == VET_FLOAT3 || type == VET_FLOAT4))))
+            vdata->convertVertexElement(sem, VET_INT_10_10_10_2_NORM, e.getIndex());
+    }
+}
+
+size_t getVertexBufferSize(const VertexData* vdata)
+{
+    size_t size = 0;
+    for (const auto& b : vdata->vertexBufferBinding->getBindings())
+        size += b.second->getSizeInBytes();
+    return size;
+}
+
+void quantise(Mesh* mesh)
+{
+    auto logMgr = LogManager::getSingletonPtr();
+    mesh->_determineAnimationTypes();
+    bool isStatic = !mesh->hasSkeleton() && !mesh->hasVertexAnimation() && mesh->getPoseList().empty();
+
+    size_t before = 0, after = 0;
+    if (mesh->sharedVertexData)
+    {
+        before += getVertexBufferSize(mesh->sharedVertexData);
+        quantiseVertexElements(mesh->sharedVertexData, isStatic);
+    }
+    for (auto sm : mesh->getSubMeshes())
+    {
+        if (sm->useSharedVertices)
+            continue;
+        before += getVertexBufferSize(sm->vertexData);
+        quantiseVertexElements(sm->vertexData, isStatic);
+    }
+
+    if (isStatic)
+        mesh->_quantisePositions();
+    else
+        logMgr->logWarning("animated mesh, only UVs are quantised");
+
+    if (mesh->sharedVertexData)
+        after += getVertexBufferSize(mesh->sharedVertexData);
+    for (auto sm : mesh->getSubMeshes())
+    {
+        if (!sm->useSharedVertices)
+            after += getVertexBufferSize(sm->vertexData);
+    }
+
+    logMgr->logMessage(StringUtil::format("Vertex data: %zu -> %zu bytes", before, after));
+}
+
 void recalcBounds(const VertexData* vdata, AxisAlignedBox& aabb, Real& radius)
 {
     const VertexElement* posElem =
@@ -461,6 +536,10 @@ int main(int numargs, char** args)
         unOptList["-pack"] = false;
         unOptList["-b"] = false;
         unOptList["-optvtxcache"] = false;
+        unOptList["-optoverdraw"] = false;
+        unOptList["-optvtxfetch"] = false;
+        unOptList["-quantise"] = false;
+        unOptList["-compress"] = false;
         unOptList["-v"] = false;
         binOptList["-l"] = "";
         binOptList["-d"] = "";
@@ -581,27 +660,33 @@ int main(int numargs, char** args)
             recalcBounds(mesh);
         }
 
-        if(opts.optimiseVertexCache)
+        if (opts.optimiseVertexCache || opts.optimiseOverdraw || opts.optimiseVertexFetch)
         {
-            logMgr.logMessage("Vertex cache optimization...");
-            VertexCacheProfiler vcp;
-            VertexCacheProfiler vcpnew;
-
-            for (auto s : mesh->getSubMeshes())
-            {
-                if(!s->indexData->indexBuffer)
-                    continue;
-                vcp.profile(s->indexData->indexBuffer);
-                s->indexData->optimiseVertexCacheTriList();
-                vcpnew.profile(s->indexData->indexBuffer);
-                vcp.flush();
-                vcpnew.flush();
-            }
+            logMgr.logMessage("Mesh optimisation...");
+            MeshOptimiser optimiser;
+            optimiser.setOptimiseVertexCache(opts.optimiseVertexCache);
+            if (!opts.optimiseOverdraw)
+                optimiser.setOverdrawThreshold(0);
+            optimiser.setOptimiseVertexFetch(opts.optimiseVertexFetch);
+
+            auto before = optimiser.analyse(mesh);
+            optimiser.optimise(mesh);
+            auto after = optimiser.analyse(mesh);
+
+            logMgr.logMessage(StringUtil::format("Mesh optimisation: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f",
+                                                 before.getACMR(), after.getACMR(), before.getATVR(),
+                                                 after.getATVR()));
+        }
 
-            logMgr.logMessage(StringUtil::format("Vertex cache optimization: ACMR change %.2f -> %.2f",
-                                                 vcp.getAvgCacheMissRatio(), vcpnew.getAvgCacheMissRatio()));
+        // last, as the other stages need float positions
+        if (opts.quantise)
+        {
+            logMgr.logMessage("Quantising vertex data...");
+            quantise(mesh);
+            logMgr.logMessage("Quantising vertex data... success");
         }
 
+        meshSerializer.setCompressGeometry(opts.compress);
         meshSerializer.exportMesh(mesh, dest, opts.targetVersion, opts.endian);
 
         logMgr.setDefaultLog(NULL); // swallow shutdown messages